@@ -139,6 +139,36 @@ if float(Modulemd._version) >= 2:
                             module, stream
                         )
 
+            if hasattr(Modulemd.ModuleIndex, "get_stream_table"):
+
+                def get_stream_table(self, query=None):
+                    return (
+                        super(ModuleIndex, self)
+                        .get_stream_table(query)
+                        .unpack()
+                    )
+
+                def get_rpm_artifacts_table(self, query=None):
+                    return (
+                        super(ModuleIndex, self)
+                        .get_rpm_artifacts_table(query)
+                        .unpack()
+                    )
+
+                def get_rpm_artifact_map(self, query=None):
+                    return (
+                        super(ModuleIndex, self)
+                        .get_rpm_artifact_map(query)
+                        .unpack()
+                    )
+
+                def get_dependencies_table(self, query=None):
+                    return (
+                        super(ModuleIndex, self)
+                        .get_dependencies_table(query)
+                        .unpack()
+                    )
+
         ModuleIndex = override(ModuleIndex)
         __all__.append(ModuleIndex)
 
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# This file is part of libmodulemd
+# Copyright (C) 2020 Red Hat, Inc.
+#
+# Fedora-License-Identifier: MIT
+# SPDX-2.0-License-Identifier: MIT
+# SPDX-3.0-License-Identifier: MIT
+#
+# This program is free software.
+# For more information on the license, see COPYING.
+# For more information on free software, see
+# <https://www.gnu.org/philosophy/free-sw.en.html>.
+
+"""Compare reading stream data per object and with the bulk accessors.
+
+Usage: bulk_access.py [--repeat N] FILE...
+
+Each FILE is loaded into a module index, for example the modules.yaml of a
+repository. The NSVCAs, rpm artifacts and dependencies of every stream are
+then collected once by calling the getters of each stream object and once
+with the bulk accessors of the index. The best time of N runs is reported
+for each.
+"""
+
+import argparse
+import sys
+import time
+
+import gi
+
+gi.require_version("Modulemd", "2.0")
+from gi.repository import Modulemd  # noqa: E402
+
+
+def best_time(repeat, fn):
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        elapsed = time.perf_counter() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+
+def per_object_streams(idx):
+    return [
+        (
+            s.props.module_name,
+            s.props.stream_name,
+            s.props.version,
+            s.props.context or "",
+            s.props.arch or "",
+        )
+        for s in idx.search_streams_by_nsvca_glob(None)
+    ]
+
+
+def per_object_artifacts(idx):
+    return [
+        (s.get_NSVCA(), s.get_rpm_artifacts())
+        for s in idx.search_streams_by_nsvca_glob(None)
+    ]
+
+
+def per_object_artifact_map(idx):
+    artifact_map = {}
+    for s in idx.search_streams_by_nsvca_glob(None):
+        nsvca = s.get_NSVCA()
+        for nevra in s.get_rpm_artifacts():
+            artifact_map.setdefault(nevra, []).append(nsvca)
+    return artifact_map
+
+
+def per_object_dependencies(idx):
+    rows = []
+    for s in idx.search_streams_by_nsvca_glob(None):
+        if not isinstance(s, Modulemd.ModuleStreamV2):
+            continue
+        nsvca = s.get_NSVCA()
+        for i, deps in enumerate(s.get_dependencies()):
+            for module in deps.get_buildtime_modules():
+                rows.append(
+                    (
+                        nsvca,
+                        i,
+                        False,
+                        module,
+                        deps.get_buildtime_streams(module),
+                    )
+                )
+            for module in deps.get_runtime_modules():
+                rows.append(
+                    (nsvca, i, True, module, deps.get_runtime_streams(module))
+                )
+    return rows
+
+
+def benchmark(fname, repeat):
+    idx = Modulemd.ModuleIndex.new()
+    ret, failures = idx.update_from_file(fname, False)
+    if not ret:
+        raise RuntimeError("{} documents failed to load".format(len(failures)))
+
+    cases = (
+        ("streams", per_object_streams, idx.get_stream_table),
+        ("artifacts", per_object_artifacts, idx.get_rpm_artifacts_table),
+        ("artifact map", per_object_artifact_map, idx.get_rpm_artifact_map),
+        ("dependencies", per_object_dependencies, idx.get_dependencies_table),
+    )
+
+    print("{}: {} streams".format(fname, len(idx.get_stream_table())))
+    print(
+        "  {:<14} {:>14} {:>10} {:>8}".format(
+            "data", "per object (s)", "bulk (s)", "speedup"
+        )
+    )
+    for name, per_object, bulk in cases:
+        per_object_time = best_time(repeat, lambda: per_object(idx))
+        bulk_time = best_time(repeat, bulk)
+        print(
+            "  {:<14} {:>14.4f} {:>10.4f} {:>7.1f}x".format(
+                name,
+                per_object_time,
+                bulk_time,
+                per_object_time / bulk_time,
+            )
+        )
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare per-object and bulk access to module streams."
+    )
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=5,
+        help="number of runs to take the best time of (default: 5)",
+    )
+    parser.add_argument("files", metavar="FILE", nargs="+")
+    args = parser.parse_args()
+
+    for fname in args.files:
+        benchmark(fname, args.repeat)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# This file is part of libmodulemd
+# Copyright (C) 2020 Red Hat, Inc.
+#
+# Fedora-License-Identifier: MIT
+# SPDX-2.0-License-Identifier: MIT
+# SPDX-3.0-License-Identifier: MIT
+#
+# This program is free software.
+# For more information on the license, see COPYING.
+# For more information on free software, see
+# <https://www.gnu.org/philosophy/free-sw.en.html>.
+
+"""Compare loading compressed metadata with two builds of libmodulemd.
+
+Usage: decompression.py [--repeat N] --build NAME=DIR... FILE...
+       decompression.py --make-input SOURCE --size MB FILE
+
+Each FILE is loaded into a module index by every build, each in a fresh
+process, and the best wall-clock and CPU time of N runs is reported. The
+builds are meson build directories, for example one configured with
+-Dzstd=enabled, which decompresses on the native reader thread, and one with
+-Dzstd=disabled -Drpmio=enabled, which goes through rpmio:
+
+  decompression.py --build native=build-zstd --build rpmio=build-rpmio \\
+      modules.yaml.zst
+
+Each FILE is also decompressed by the matching command line tool, with the
+output discarded. That time is the most that overlapping decompression with
+parsing can save over decompressing on the parsing thread, as rpmio does.
+
+Large repository metadata is not always at hand, so --make-input writes a
+Zstandard-compressed FILE of about MB megabytes of uncompressed YAML. It
+repeats the documents of SOURCE with the module names made unique for each
+copy. The zstd command line tool is used to compress it.
+"""
+
+import argparse
+import json
+import os
+import re
+import resource
+import subprocess
+import sys
+import time
+
+
+def measure(fname, repeat):
+    import gi
+
+    gi.require_version("Modulemd", "2.0")
+    from gi.repository import Modulemd
+
+    best_wall = best_cpu = None
+    for _ in range(repeat):
+        start_cpu = resource.getrusage(resource.RUSAGE_SELF)
+        start = time.perf_counter()
+
+        idx = Modulemd.ModuleIndex.new()
+        ret, failures = idx.update_from_file(fname, False)
+        if not ret:
+            raise RuntimeError(
+                "{} documents failed to load".format(len(failures))
+            )
+
+        wall = time.perf_counter() - start
+        end_cpu = resource.getrusage(resource.RUSAGE_SELF)
+        cpu = (end_cpu.ru_utime - start_cpu.ru_utime) + (
+            end_cpu.ru_stime - start_cpu.ru_stime
+        )
+        streams = len(idx.search_streams_by_nsvca_glob(None))
+        del idx
+
+        if best_wall is None or wall < best_wall:
+            best_wall = wall
+        if best_cpu is None or cpu < best_cpu:
+            best_cpu = cpu
+
+    return {"streams": streams, "wall": best_wall, "cpu": best_cpu}
+
+
+DECOMPRESSORS = {
+    ".gz": "gzip",
+    ".bz2": "bzip2",
+    ".xz": "xz",
+    ".zst": "zstd",
+}
+
+
+def decompress_time(fname, repeat):
+    """Return the best wall-clock time of decompressing fname with the
+    command line tool, or None if fname is not compressed."""
+    tool = DECOMPRESSORS.get(os.path.splitext(fname)[1])
+    if tool is None:
+        return None
+
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        subprocess.check_call(
+            [tool, "-d", "-c", fname], stdout=subprocess.DEVNULL
+        )
+        elapsed = time.perf_counter() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+
+def run(build, fname, repeat):
+    libdir = os.path.join(os.path.abspath(build), "modulemd")
+    env = dict(os.environ)
+    for var in ("GI_TYPELIB_PATH", "LD_LIBRARY_PATH"):
+        env[var] = os.pathsep.join(filter(None, (libdir, env.get(var))))
+
+    output = subprocess.check_output(
+        [
+            sys.executable,
+            __file__,
+            "--measure",
+            "--repeat",
+            str(repeat),
+            fname,
+        ],
+        env=env,
+    )
+    return json.loads(output)
+
+
+def make_input(source, size_mb, fname):
+    with open(source, "r") as f:
+        yaml = f.read()
+    if not yaml.endswith("\n"):
+        yaml += "\n"
+
+    # Module names appear as the name of streams and as the module of
+    # defaults, translations and obsoletes, at the indentation of the keys
+    # of the data mapping.
+    match = re.search(r"^data:\n(?:\s*#.*\n|\s*\n)*( +)\S", yaml, re.MULTILINE)
+    if not match:
+        raise RuntimeError("{} has no data mapping".format(source))
+    name_re = re.compile(
+        r"^({}(?:name|module): )".format(match.group(1)), re.MULTILINE
+    )
+
+    target = size_mb * 1024 * 1024
+    written = 0
+    with open(fname, "wb") as out:
+        compressor = subprocess.Popen(
+            ["zstd", "-q", "-c"], stdin=subprocess.PIPE, stdout=out
+        )
+        copy = 0
+        while written < target:
+            data = name_re.sub(r"\g<1>copy{}-".format(copy), yaml).encode()
+            compressor.stdin.write(data)
+            written += len(data)
+            copy += 1
+        compressor.stdin.close()
+        if compressor.wait() != 0:
+            raise RuntimeError("zstd failed")
+
+    print(
+        "{}: {} copies of {}, {:.1f} MB uncompressed, "
+        "{:.1f} MB compressed".format(
+            fname,
+            copy,
+            source,
+            written / 1024 / 1024,
+            os.path.getsize(fname) / 1024 / 1024,
+        )
+    )
+
+
+def parse_build(value):
+    name, sep, path = value.partition("=")
+    if not sep or not name or not path:
+        raise argparse.ArgumentTypeError("expected NAME=DIR")
+    return name, path
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare loading compressed metadata with two builds."
+    )
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=5,
+        help="number of runs to take the best time of (default: 5)",
+    )
+    parser.add_argument(
+        "--build",
+        action="append",
+        type=parse_build,
+        default=[],
+        metavar="NAME=DIR",
+        help="meson build directory of libmodulemd to load FILE with",
+    )
+    parser.add_argument(
+        "--make-input",
+        metavar="SOURCE",
+        help="write a compressed FILE made from the YAML file SOURCE",
+    )
+    parser.add_argument(
+        "--size",
+        type=int,
+        default=100,
+        metavar="MB",
+        help="uncompressed size of the file written by --make-input "
+        "(default: 100)",
+    )
+    parser.add_argument(
+        "--measure", action="store_true", help=argparse.SUPPRESS
+    )
+    parser.add_argument("files", metavar="FILE", nargs="+")
+    args = parser.parse_args()
+
+    if args.measure:
+        print(json.dumps(measure(args.files[0], args.repeat)))
+        return 0
+
+    if args.make_input:
+        make_input(args.make_input, args.size, args.files[0])
+        return 0
+
+    if not args.build:
+        parser.error("at least one --build is required")
+
+    for fname in args.files:
+        print(
+            "{}: {:.1f} MB".format(fname, os.path.getsize(fname) / 1024 / 1024)
+        )
+        print(
+            "  {:<20} {:>8} {:>10} {:>10}".format(
+                "build", "streams", "wall (s)", "CPU (s)"
+            )
+        )
+        for name, build in args.build:
+            result = run(build, fname, args.repeat)
+            print(
+                "  {:<20} {:>8} {:>10.3f} {:>10.3f}".format(
+                    name, result["streams"], result["wall"], result["cpu"]
+                )
+            )
+        decompress = decompress_time(fname, args.repeat)
+        if decompress is not None:
+            print(
+                "  {:<20} {:>8} {:>10.3f}".format(
+                    "decompress only", "", decompress
+                )
+            )
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# This file is part of libmodulemd
+# Copyright (C) 2020 Red Hat, Inc.
+#
+# Fedora-License-Identifier: MIT
+# SPDX-2.0-License-Identifier: MIT
+# SPDX-3.0-License-Identifier: MIT
+#
+# This program is free software.
+# For more information on the license, see COPYING.
+# For more information on free software, see
+# <https://www.gnu.org/philosophy/free-sw.en.html>.
+
+"""Compare loading and dumping a module index as YAML, JSON and CBOR.
+
+Usage: formats.py [--repeat N] FILE...
+
+Each FILE is read as YAML, for example the modules.yaml of a repository.
+The best time of N runs is reported for each format, together with the
+size of the serialized index.
+"""
+
+import argparse
+import sys
+import time
+
+import gi
+
+gi.require_version("Modulemd", "2.0")
+from gi.repository import Modulemd  # noqa: E402
+
+
+def best_time(repeat, fn):
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        elapsed = time.perf_counter() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+
+def load(update, data):
+    idx = Modulemd.ModuleIndex.new()
+    ret, failures = update(idx, data, False)
+    if not ret:
+        raise RuntimeError("{} documents failed to load".format(len(failures)))
+    return idx
+
+
+def benchmark(fname, repeat):
+    with open(fname, "r") as f:
+        yaml = f.read()
+
+    idx = load(Modulemd.ModuleIndex.update_from_string, yaml)
+
+    formats = (
+        (
+            "YAML",
+            Modulemd.ModuleIndex.dump_to_string,
+            Modulemd.ModuleIndex.update_from_string,
+            lambda data: len(data.encode()),
+        ),
+        (
+            "JSON",
+            Modulemd.ModuleIndex.dump_to_json,
+            Modulemd.ModuleIndex.update_from_json,
+            lambda data: len(data.encode()),
+        ),
+        (
+            "CBOR",
+            Modulemd.ModuleIndex.dump_to_cbor,
+            Modulemd.ModuleIndex.update_from_cbor,
+            lambda data: data.get_size(),
+        ),
+    )
+
+    print(fname)
+    print(
+        "  {:<6} {:>12} {:>10} {:>10}".format(
+            "format", "size (B)", "load (s)", "dump (s)"
+        )
+    )
+    for name, dump, update, size in formats:
+        data = dump(idx)
+        load_time = best_time(repeat, lambda: load(update, data))
+        dump_time = best_time(repeat, lambda: dump(idx))
+        print(
+            "  {:<6} {:>12} {:>10.4f} {:>10.4f}".format(
+                name, size(data), load_time, dump_time
+            )
+        )
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare the YAML, JSON and CBOR module index formats."
+    )
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=5,
+        help="number of runs to take the best time of (default: 5)",
+    )
+    parser.add_argument("files", metavar="FILE", nargs="+")
+    args = parser.parse_args()
+
+    for fname in args.files:
+        benchmark(fname, args.repeat)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
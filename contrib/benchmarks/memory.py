@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# This file is part of libmodulemd
+# Copyright (C) 2020 Red Hat, Inc.
+#
+# Fedora-License-Identifier: MIT
+# SPDX-2.0-License-Identifier: MIT
+# SPDX-3.0-License-Identifier: MIT
+#
+# This program is free software.
+# For more information on the license, see COPYING.
+# For more information on free software, see
+# <https://www.gnu.org/philosophy/free-sw.en.html>.
+
+"""Report the memory held by a loaded module index.
+
+Usage: memory.py [--build DIR]... FILE...
+
+Each FILE is loaded into a module index in a fresh process, for example the
+modules.yaml of a repository. The growth of the resident set size caused by
+the load and the total reported by ModuleIndex.get_memory_usage() are
+printed.
+
+Every --build option names a meson build directory of libmodulemd, whose
+library and typelib are used instead of the installed ones. Passing the
+build directories of two revisions compares them, for example before and
+after a change to how strings are stored.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+
+def rss_kib():
+    with open("/proc/self/status") as status:
+        for line in status:
+            if line.startswith("VmRSS:"):
+                return int(line.split()[1])
+    raise RuntimeError("VmRSS is not available")
+
+
+def measure(fname):
+    import gi
+
+    gi.require_version("Modulemd", "2.0")
+    from gi.repository import Modulemd
+
+    before = rss_kib()
+    idx = Modulemd.ModuleIndex.new()
+    ret, failures = idx.update_from_file(fname, False)
+    if not ret:
+        raise RuntimeError("{} documents failed to load".format(len(failures)))
+    after = rss_kib()
+
+    return {
+        "streams": len(idx.search_streams_by_nsvca_glob(None)),
+        "rss": after - before,
+        "usage": idx.get_memory_usage().get_total() // 1024,
+    }
+
+
+def run(build, fname):
+    env = dict(os.environ)
+    if build:
+        libdir = os.path.join(os.path.abspath(build), "modulemd")
+        for var in ("GI_TYPELIB_PATH", "LD_LIBRARY_PATH"):
+            env[var] = os.pathsep.join(filter(None, (libdir, env.get(var))))
+
+    output = subprocess.check_output(
+        [sys.executable, __file__, "--measure", fname], env=env
+    )
+    return json.loads(output)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Report the memory held by a loaded module index."
+    )
+    parser.add_argument(
+        "--build",
+        action="append",
+        metavar="DIR",
+        help="meson build directory to load libmodulemd from "
+        "(default: the installed library)",
+    )
+    parser.add_argument(
+        "--measure", action="store_true", help=argparse.SUPPRESS
+    )
+    parser.add_argument("files", metavar="FILE", nargs="+")
+    args = parser.parse_args()
+
+    if args.measure:
+        print(json.dumps(measure(args.files[0])))
+        return 0
+
+    builds = args.build or [None]
+    for fname in args.files:
+        print(fname)
+        print(
+            "  {:<30} {:>8} {:>14} {:>14}".format(
+                "build", "streams", "RSS (KiB)", "usage (KiB)"
+            )
+        )
+        for build in builds:
+            result = run(build, fname)
+            print(
+                "  {:<30} {:>8} {:>14} {:>14}".format(
+                    build or "installed",
+                    result["streams"],
+                    result["rss"],
+                    result["usage"],
+                )
+            )
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# This file is part of libmodulemd
+# Copyright (C) 2020 Red Hat, Inc.
+#
+# Fedora-License-Identifier: MIT
+# SPDX-2.0-License-Identifier: MIT
+# SPDX-3.0-License-Identifier: MIT
+#
+# This program is free software.
+# For more information on the license, see COPYING.
+# For more information on free software, see
+# <https://www.gnu.org/philosophy/free-sw.en.html>.
+
+"""Compare the serial and parallel paths of dumping a module index to YAML.
+
+Usage: parallel_dump.py [--repeat N] FILE...
+
+Each FILE is loaded into a module index, for example the modules.yaml of a
+repository, and dumped to a string. Indexes with enough modules are dumped
+by one worker thread per processor that the process may run on, so the
+serial path is timed with the process pinned to a single processor and the
+parallel path with all of them. The best time of N runs is reported for
+each, and the two outputs are checked to be identical.
+
+The processor time of one parallel dump is also split between the calling
+thread, which writes the rendered modules out in order, and the workers.
+The calling thread's share is the part that does not scale with more
+processors, so it bounds the speedup on machines with more processors
+than the one the benchmark runs on.
+"""
+
+import argparse
+import os
+import resource
+import sys
+import time
+
+import gi
+
+gi.require_version("Modulemd", "2.0")
+from gi.repository import Modulemd  # noqa: E402
+
+
+def best_time(repeat, fn):
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        elapsed = time.perf_counter() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+
+def cpu_time(who):
+    usage = resource.getrusage(who)
+    return usage.ru_utime + usage.ru_stime
+
+
+def cpu_split(idx):
+    """Return the processor time of one dump of idx spent by the calling
+    thread and by all other threads."""
+    caller = cpu_time(resource.RUSAGE_THREAD)
+    process = cpu_time(resource.RUSAGE_SELF)
+    idx.dump_to_string()
+    caller = cpu_time(resource.RUSAGE_THREAD) - caller
+    process = cpu_time(resource.RUSAGE_SELF) - process
+    return caller, process - caller
+
+
+def timed_dump(idx, repeat, cpus):
+    """Dump idx while the process may only run on cpus."""
+    saved = os.sched_getaffinity(0)
+    os.sched_setaffinity(0, cpus)
+    try:
+        output = idx.dump_to_string()
+        return output, best_time(repeat, idx.dump_to_string)
+    finally:
+        os.sched_setaffinity(0, saved)
+
+
+def benchmark(fname, repeat):
+    idx = Modulemd.ModuleIndex.new()
+    ret, failures = idx.update_from_file(fname, False)
+    if not ret:
+        raise RuntimeError("{} documents failed to load".format(len(failures)))
+
+    cpus = os.sched_getaffinity(0)
+    serial, serial_time = timed_dump(idx, repeat, {min(cpus)})
+    parallel, parallel_time = timed_dump(idx, repeat, cpus)
+    if serial != parallel:
+        raise RuntimeError("The serial and parallel dumps differ")
+    caller_cpu, worker_cpu = cpu_split(idx)
+
+    print(
+        "{}: {} modules, {} processors".format(
+            fname, len(idx.get_module_names()), len(cpus)
+        )
+    )
+    print(
+        "  {:>10} {:>12} {:>8}".format(
+            "serial (s)", "parallel (s)", "speedup"
+        )
+    )
+    print(
+        "  {:>10.4f} {:>12.4f} {:>7.1f}x".format(
+            serial_time, parallel_time, serial_time / parallel_time
+        )
+    )
+    print(
+        "  processor time of a parallel dump: {:.4f} s calling thread, "
+        "{:.4f} s workers".format(caller_cpu, worker_cpu)
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare serial and parallel dumps of a module index."
+    )
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=5,
+        help="number of runs to take the best time of (default: 5)",
+    )
+    parser.add_argument("files", metavar="FILE", nargs="+")
+    args = parser.parse_args()
+
+    for fname in args.files:
+        benchmark(fname, args.repeat)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# This file is part of libmodulemd
+# Copyright (C) 2020 Red Hat, Inc.
+#
+# Fedora-License-Identifier: MIT
+# SPDX-2.0-License-Identifier: MIT
+# SPDX-3.0-License-Identifier: MIT
+#
+# This program is free software.
+# For more information on the license, see COPYING.
+# For more information on free software, see
+# <https://www.gnu.org/philosophy/free-sw.en.html>.
+
+"""Time parsing module streams into a module index.
+
+Usage: parse_streams.py [--repeat N] [--copies N] [--build DIR]... [FILE]
+
+The stream documents of FILE, by default the v2 stream specification, are
+repeated N times with the module names made unique for each copy. The
+resulting string is parsed into a module index in a fresh process and the
+best time of the runs is reported, in total and per stream.
+
+Every --build option names a meson build directory of libmodulemd, whose
+library and typelib are used instead of the installed ones. Passing the
+build directories of two revisions compares them, for example before and
+after a change to how the parser fills in the stream objects.
+
+To see where the time goes within a build, run the hidden measuring mode
+under perf and look at modulemd_module_stream_v2_parse_yaml() and its
+callees:
+
+  GI_TYPELIB_PATH=build/modulemd LD_LIBRARY_PATH=build/modulemd \\
+      perf record -g parse_streams.py --measure
+  perf report --children --symbol-filter=modulemd_module_stream_v2
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+SPEC = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)),
+    "..",
+    "..",
+    "yaml_specs",
+    "modulemd_stream_v2.yaml",
+)
+
+
+def make_yaml(fname, copies):
+    with open(fname, "r") as f:
+        yaml = f.read()
+    if not yaml.endswith("\n"):
+        yaml += "\n"
+    # The specifications are single documents without a start marker, which
+    # the copies need to be told apart.
+    if not re.search(r"^---", yaml, re.MULTILINE):
+        yaml = "---\n" + yaml
+
+    # The module name is the name key of the data mapping.
+    match = re.search(r"^data:\n(?:\s*#.*\n|\s*\n)*( +)\S", yaml, re.MULTILINE)
+    if not match:
+        raise RuntimeError("{} has no data mapping".format(fname))
+    name_re = re.compile(r"^({}name: )".format(match.group(1)), re.MULTILINE)
+
+    return "".join(
+        name_re.sub(r"\g<1>copy{}-".format(copy), yaml)
+        for copy in range(copies)
+    )
+
+
+def measure(fname, copies, repeat):
+    import gi
+
+    gi.require_version("Modulemd", "2.0")
+    from gi.repository import Modulemd
+
+    yaml = make_yaml(fname, copies)
+
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+
+        idx = Modulemd.ModuleIndex.new()
+        ret, failures = idx.update_from_string(yaml, False)
+        if not ret:
+            raise RuntimeError(
+                "{} documents failed to load".format(len(failures))
+            )
+
+        elapsed = time.perf_counter() - start
+        streams = len(idx.search_streams_by_nsvca_glob(None))
+        del idx
+
+        if best is None or elapsed < best:
+            best = elapsed
+
+    return {"streams": streams, "time": best}
+
+
+def run(build, fname, copies, repeat):
+    env = dict(os.environ)
+    if build:
+        libdir = os.path.join(os.path.abspath(build), "modulemd")
+        for var in ("GI_TYPELIB_PATH", "LD_LIBRARY_PATH"):
+            env[var] = os.pathsep.join(filter(None, (libdir, env.get(var))))
+
+    output = subprocess.check_output(
+        [
+            sys.executable,
+            __file__,
+            "--measure",
+            "--copies",
+            str(copies),
+            "--repeat",
+            str(repeat),
+            fname,
+        ],
+        env=env,
+    )
+    return json.loads(output)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Time parsing module streams into a module index."
+    )
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=5,
+        help="number of runs to take the best time of (default: 5)",
+    )
+    parser.add_argument(
+        "--copies",
+        type=int,
+        default=2000,
+        help="number of copies of the streams of FILE to parse "
+        "(default: 2000)",
+    )
+    parser.add_argument(
+        "--build",
+        action="append",
+        metavar="DIR",
+        help="meson build directory to load libmodulemd from "
+        "(default: the installed library)",
+    )
+    parser.add_argument(
+        "--measure", action="store_true", help=argparse.SUPPRESS
+    )
+    parser.add_argument("file", metavar="FILE", nargs="?", default=SPEC)
+    args = parser.parse_args()
+
+    if args.measure:
+        result = measure(args.file, args.copies, args.repeat)
+        print(json.dumps(result))
+        return 0
+
+    builds = args.build or [None]
+    print("{}: {} copies".format(args.file, args.copies))
+    print(
+        "  {:<30} {:>8} {:>10} {:>14}".format(
+            "build", "streams", "time (s)", "per stream (us)"
+        )
+    )
+    for build in builds:
+        result = run(build, args.file, args.copies, args.repeat)
+        print(
+            "  {:<30} {:>8} {:>10.3f} {:>14.1f}".format(
+                build or "installed",
+                result["streams"],
+                result["time"],
+                result["time"] / result["streams"] * 1e6,
+            )
+        )
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -29,11 +29,16 @@ BuildRequires:  pkgconfig
 BuildRequires:  gcc
 BuildRequires:  gcc-c++
 BuildRequires:  pkgconfig(gobject-2.0)
+BuildRequires:  pkgconfig(gio-2.0)
 BuildRequires:  pkgconfig(gobject-introspection-1.0)
 BuildRequires:  pkgconfig(yaml-0.1)
 BuildRequires:  pkgconfig(gtk-doc)
 BuildRequires:  glib2-doc
 BuildRequires:  rpm-devel
+BuildRequires:  pkgconfig(zlib)
+BuildRequires:  bzip2-devel
+BuildRequires:  pkgconfig(liblzma)
+BuildRequires:  pkgconfig(libzstd)
 %if %{build_python2}
 BuildRequires:  python2-devel
 BuildRequires:  python-gobject-base
@@ -0,0 +1,144 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-document-reader
+ * @title: Modulemd.DocumentReader
+ * @stability: stable
+ * @short_description: Reads the subdocuments of a YAML stream one at a time.
+ *
+ * A #ModulemdDocumentReader parses a modulemd YAML stream one subdocument at
+ * a time and returns each one as soon as it has been read, instead of
+ * collecting everything into a #ModulemdModuleIndex. Together with
+ * #ModulemdDocumentWriter this allows filtering or rewriting very large
+ * repodata files while only ever holding one subdocument in memory.
+ *
+ * |[<!-- language="C" -->
+ * g_autoptr (ModulemdDocumentReader) reader = NULL;
+ * g_autoptr (ModulemdDocumentWriter) writer = NULL;
+ * g_autoptr (GObject) object = NULL;
+ *
+ * reader = modulemd_document_reader_new_for_file ("modules.yaml", TRUE, error);
+ * writer = modulemd_document_writer_new_for_file ("filtered.yaml", error);
+ *
+ * while ((object = modulemd_document_reader_next (reader, error)))
+ *   {
+ *     if (MODULEMD_IS_MODULE_STREAM_V2 (object))
+ *       modulemd_module_stream_v2_clear_xmd (MODULEMD_MODULE_STREAM_V2 (object));
+ *
+ *     if (!MODULEMD_IS_SUBDOCUMENT_INFO (object) &&
+ *         !modulemd_document_writer_write (writer, object, error))
+ *       break;
+ *
+ *     g_clear_object (&object);
+ *   }
+ * ]|
+ *
+ * Streams are returned with the metadata version they were written in;
+ * unlike #ModulemdModuleIndex, the reader never upgrades them.
+ */
+
+#define MODULEMD_TYPE_DOCUMENT_READER (modulemd_document_reader_get_type ())
+
+G_DECLARE_FINAL_TYPE (ModulemdDocumentReader,
+                      modulemd_document_reader,
+                      MODULEMD,
+                      DOCUMENT_READER,
+                      GObject)
+
+
+/**
+ * modulemd_document_reader_new_for_file:
+ * @yaml_file: (in): The name of a YAML file containing module metadata. It
+ * may be compressed with any format for which libmodulemd was built with a
+ * native decompression library; the compression is detected from its
+ * content.
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ * @error: (out): A #GError containing the reason the file could not be
+ * opened.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdDocumentReader for
+ * @yaml_file. NULL and sets @error if the file could not be opened or is
+ * compressed in a format that cannot be decompressed natively.
+ *
+ * Since: 2.16
+ */
+ModulemdDocumentReader *
+modulemd_document_reader_new_for_file (const gchar *yaml_file,
+                                       gboolean strict,
+                                       GError **error);
+
+
+/**
+ * modulemd_document_reader_new_for_string:
+ * @yaml_string: (in): A YAML string containing module metadata. It is
+ * copied.
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdDocumentReader for
+ * @yaml_string.
+ *
+ * Since: 2.16
+ */
+ModulemdDocumentReader *
+modulemd_document_reader_new_for_string (const gchar *yaml_string,
+                                         gboolean strict);
+
+
+/**
+ * modulemd_document_reader_next:
+ * @self: (in): This #ModulemdDocumentReader object.
+ * @error: (out): A #GError containing the reason reading stopped, if it did
+ * not stop at the end of the YAML stream.
+ *
+ * Reads the next subdocument of the YAML stream.
+ *
+ * A subdocument that cannot be parsed or fails validation does not stop the
+ * reader. It is returned as a #ModulemdSubdocumentInfo whose
+ * modulemd_subdocument_info_get_gerror() describes the problem, in the same
+ * way that modulemd_module_index_update_from_file() reports failures.
+ *
+ * Returns: (transfer full) (nullable): The next subdocument as a
+ * #ModulemdModuleStream, #ModulemdDefaults, #ModulemdTranslation,
+ * #ModulemdObsoletes or, if it was invalid, #ModulemdSubdocumentInfo. NULL at
+ * the end of the YAML stream, or if the YAML stream itself is malformed or
+ * could not be read, in which case @error is set. Every call after NULL was
+ * returned returns NULL again.
+ *
+ * Since: 2.16
+ */
+GObject *
+modulemd_document_reader_next (ModulemdDocumentReader *self, GError **error);
+
+
+/**
+ * modulemd_document_reader_get_documents_read:
+ * @self: (in): This #ModulemdDocumentReader object.
+ *
+ * Returns: The number of subdocuments returned by
+ * modulemd_document_reader_next() so far, including invalid ones.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_document_reader_get_documents_read (ModulemdDocumentReader *self);
+
+G_END_DECLS
@@ -0,0 +1,161 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-module-index.h"
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-document-writer
+ * @title: Modulemd.DocumentWriter
+ * @stability: stable
+ * @short_description: Writes subdocuments to a YAML stream as they arrive.
+ *
+ * A #ModulemdDocumentWriter emits module metadata objects to a YAML stream
+ * one subdocument at a time. Each subdocument is written out as soon as it is
+ * complete, so memory use does not grow with the number of objects written.
+ * It is the counterpart of #ModulemdDocumentReader.
+ *
+ * Unlike modulemd_module_index_dump_to_string(), objects are written in the
+ * order they are passed in rather than sorted, and nothing prevents writing
+ * the same stream twice.
+ */
+
+#define MODULEMD_TYPE_DOCUMENT_WRITER (modulemd_document_writer_get_type ())
+
+G_DECLARE_FINAL_TYPE (ModulemdDocumentWriter,
+                      modulemd_document_writer,
+                      MODULEMD,
+                      DOCUMENT_WRITER,
+                      GObject)
+
+
+/**
+ * modulemd_document_writer_new_for_file:
+ * @yaml_file: (in): The name of the file to write. It is created or
+ * truncated.
+ * @error: (out): A #GError containing the reason the file could not be
+ * opened.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdDocumentWriter that
+ * writes to @yaml_file. NULL and sets @error if the file could not be opened.
+ *
+ * Since: 2.16
+ */
+ModulemdDocumentWriter *
+modulemd_document_writer_new_for_file (const gchar *yaml_file, GError **error);
+
+
+/**
+ * modulemd_document_writer_new_for_string:
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdDocumentWriter that
+ * collects its output in memory. Retrieve it with
+ * modulemd_document_writer_get_string() after
+ * modulemd_document_writer_close().
+ *
+ * Since: 2.16
+ */
+ModulemdDocumentWriter *
+modulemd_document_writer_new_for_string (void);
+
+
+/**
+ * modulemd_document_writer_new_for_custom: (skip)
+ * @custom_write_fn: (in): A #ModulemdWriteHandler.
+ * @custom_pvt_data: (inout): The private data needed by the
+ * #ModulemdWriteHandler.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdDocumentWriter that
+ * passes its output to @custom_write_fn.
+ *
+ * Since: 2.16
+ */
+ModulemdDocumentWriter *
+modulemd_document_writer_new_for_custom (ModulemdWriteHandler custom_write_fn,
+                                         void *custom_pvt_data);
+
+
+/**
+ * modulemd_document_writer_write:
+ * @self: (in): This #ModulemdDocumentWriter object.
+ * @object: (in): A #ModulemdModuleStream, #ModulemdDefaults,
+ * #ModulemdTranslation or #ModulemdObsoletes to write.
+ * @error: (out): A #GError containing the reason the object could not be
+ * written.
+ *
+ * Validates @object and writes it as the next subdocument of the YAML
+ * stream. The object is not referenced after this function returns.
+ *
+ * Returns: TRUE if @object was written. FALSE and sets @error if it is not
+ * valid, is of an unsupported type or could not be written. A failure to
+ * validate does not affect the output; after a write error, the writer can
+ * only be closed.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_document_writer_write (ModulemdDocumentWriter *self,
+                                GObject *object,
+                                GError **error);
+
+
+/**
+ * modulemd_document_writer_close:
+ * @self: (in): This #ModulemdDocumentWriter object.
+ * @error: (out): A #GError containing the reason the stream could not be
+ * completed.
+ *
+ * Ends the YAML stream and flushes all output. For writers created with
+ * modulemd_document_writer_new_for_file(), the file is closed as well.
+ * Nothing can be written after this. Closing a writer again does nothing.
+ *
+ * Returns: TRUE if the YAML stream was completed successfully. FALSE and
+ * sets @error otherwise.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_document_writer_close (ModulemdDocumentWriter *self, GError **error);
+
+
+/**
+ * modulemd_document_writer_get_string:
+ * @self: (in): This #ModulemdDocumentWriter object.
+ *
+ * Returns: (transfer none) (nullable): The YAML output of a writer created
+ * with modulemd_document_writer_new_for_string() that has been closed. NULL
+ * for other writers or before modulemd_document_writer_close() succeeded.
+ *
+ * Since: 2.16
+ */
+const gchar *
+modulemd_document_writer_get_string (ModulemdDocumentWriter *self);
+
+
+/**
+ * modulemd_document_writer_get_documents_written:
+ * @self: (in): This #ModulemdDocumentWriter object.
+ *
+ * Returns: The number of subdocuments successfully written so far.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_document_writer_get_documents_written (ModulemdDocumentWriter *self);
+
+G_END_DECLS
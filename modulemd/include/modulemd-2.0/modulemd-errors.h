@@ -66,6 +66,8 @@ modulemd_error_quark (void);
  * library.
  * @MMD_ERROR_MISSING_REQUIRED: The object is missing some data necessary
  * for proper operation.
+ * @MMD_ERROR_FROZEN: The object has been frozen and cannot be modified.
+ * Since: 2.16
  *
  * Since: 2.9
  */
@@ -78,7 +80,8 @@ typedef enum
   MMD_ERROR_TOO_MANY_MATCHES,
   MMD_ERROR_MAGIC,
   MMD_ERROR_NOT_IMPLEMENTED,
-  MMD_ERROR_MISSING_REQUIRED
+  MMD_ERROR_MISSING_REQUIRED,
+  MMD_ERROR_FROZEN
 } ModulemdError;
 
 
@@ -0,0 +1,154 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-memory-usage
+ * @title: Modulemd.MemoryUsage
+ * @stability: stable
+ * @short_description: An estimate of the memory used by a
+ * #ModulemdModuleIndex.
+ *
+ * A #ModulemdMemoryUsage is returned by
+ * modulemd_module_index_get_memory_usage(). It breaks the memory held by an
+ * index down by module and by #ModulemdMemoryCategoryEnum.
+ *
+ * The numbers are estimates computed from the sizes of the structures and
+ * strings that the index references. They do not include the bookkeeping
+ * overhead of the memory allocator, and the sizes of #GHashTable and
+ * #GPtrArray storage are derived from their number of entries the same way
+ * GLib sizes them. Objects and strings shared between several places are
+ * counted once, in the place that owns them. Identifiers such as module,
+ * stream and package names are shared by every object of the index that uses
+ * them, and are counted in the first module that references them.
+ */
+
+/**
+ * ModulemdMemoryCategoryEnum:
+ * @MD_MEMORY_CATEGORY_STRINGS: Strings, such as names, descriptions and the
+ * entries of string sets.
+ * @MD_MEMORY_CATEGORY_CONTAINERS: The storage of hash tables and pointer
+ * arrays, not counting the entries they point to.
+ * @MD_MEMORY_CATEGORY_OBJECTS: The instance structures of GObjects and other
+ * fixed-size structures, including the scalar fields stored in them.
+ * @MD_MEMORY_CATEGORY_XMD: The #GVariant values of the `xmd` field of module
+ * streams.
+ * @MD_MEMORY_CATEGORY_ARTIFACTS: Everything used by the `artifacts` section of
+ * module streams, including its strings, containers and objects.
+ * @MD_MEMORY_CATEGORY_TRANSLATIONS: Everything used by #ModulemdTranslation
+ * objects, including their strings, containers and entries.
+ *
+ * The categories that #ModulemdMemoryUsage breaks memory down into. Each byte
+ * is counted in exactly one category.
+ *
+ * Since: 2.16
+ */
+typedef enum
+{
+  MD_MEMORY_CATEGORY_STRINGS,
+  MD_MEMORY_CATEGORY_CONTAINERS,
+  MD_MEMORY_CATEGORY_OBJECTS,
+  MD_MEMORY_CATEGORY_XMD,
+  MD_MEMORY_CATEGORY_ARTIFACTS,
+  MD_MEMORY_CATEGORY_TRANSLATIONS
+} ModulemdMemoryCategoryEnum;
+
+
+#define MODULEMD_TYPE_MEMORY_USAGE (modulemd_memory_usage_get_type ())
+
+G_DECLARE_FINAL_TYPE (
+  ModulemdMemoryUsage, modulemd_memory_usage, MODULEMD, MEMORY_USAGE, GObject)
+
+
+/**
+ * modulemd_memory_usage_get_total:
+ * @self: This #ModulemdMemoryUsage object.
+ *
+ * Returns: The estimated number of bytes used by the index, in all modules
+ * and categories.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_memory_usage_get_total (ModulemdMemoryUsage *self);
+
+
+/**
+ * modulemd_memory_usage_get_category:
+ * @self: This #ModulemdMemoryUsage object.
+ * @category: (in): A #ModulemdMemoryCategoryEnum.
+ *
+ * Returns: The estimated number of bytes used by the index in @category,
+ * across all modules.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_memory_usage_get_category (ModulemdMemoryUsage *self,
+                                    ModulemdMemoryCategoryEnum category);
+
+
+/**
+ * modulemd_memory_usage_get_module_names_as_strv: (rename-to modulemd_memory_usage_get_module_names)
+ * @self: This #ModulemdMemoryUsage object.
+ *
+ * Returns: (transfer full): An ordered #GStrv list of the names of the
+ * modules that memory usage was recorded for.
+ *
+ * Since: 2.16
+ */
+GStrv
+modulemd_memory_usage_get_module_names_as_strv (ModulemdMemoryUsage *self);
+
+
+/**
+ * modulemd_memory_usage_get_module_total:
+ * @self: This #ModulemdMemoryUsage object.
+ * @module_name: (in) (nullable): The name of a module, or NULL for the
+ * memory used by the index itself rather than by any of its modules, such as
+ * its lookup tables and caches.
+ *
+ * Returns: The estimated number of bytes used by @module_name in all
+ * categories, or 0 if @module_name is not in the index.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_memory_usage_get_module_total (ModulemdMemoryUsage *self,
+                                        const gchar *module_name);
+
+
+/**
+ * modulemd_memory_usage_get_module_category:
+ * @self: This #ModulemdMemoryUsage object.
+ * @module_name: (in) (nullable): The name of a module, or NULL for the
+ * memory used by the index itself.
+ * @category: (in): A #ModulemdMemoryCategoryEnum.
+ *
+ * Returns: The estimated number of bytes used by @module_name in @category,
+ * or 0 if @module_name is not in the index.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_memory_usage_get_module_category (
+  ModulemdMemoryUsage *self,
+  const gchar *module_name,
+  ModulemdMemoryCategoryEnum category);
+
+G_END_DECLS
@@ -0,0 +1,264 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-module-index.h"
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-module-index-diff
+ * @title: Modulemd.ModuleIndexDiff
+ * @stability: stable
+ * @short_description: The differences between two #ModulemdModuleIndex
+ * objects.
+ *
+ * A #ModulemdModuleIndexDiff is returned by modulemd_module_index_diff() and
+ * lists the module streams, defaults, obsoletes and translations that were
+ * added, removed or changed between an old and a new #ModulemdModuleIndex.
+ *
+ * Objects are matched between the two indexes by their identity:
+ * - Module streams by their NSVCA, as returned by
+ *   modulemd_module_stream_get_NSVCA_as_string().
+ * - Defaults by their module name.
+ * - Obsoletes by their module name, stream, context and modified time.
+ * - Translations by their module name and stream.
+ *
+ * A matched pair is changed if the two objects differ in any way that shows
+ * up in their YAML representation. This is decided by comparing digests of
+ * their content. The digest of a module stream is kept until the stream is
+ * modified, and those of the other objects of a frozen index (see
+ * modulemd_module_index_freeze()) are kept in the index, so comparing many
+ * composes against the same snapshot only computes them once.
+ *
+ * The arrays returned by a #ModulemdModuleIndexDiff contain the objects of
+ * the indexes themselves, not copies. They must be treated as read-only.
+ * Within each array, objects are grouped by module in alphabetical order.
+ */
+
+#define MODULEMD_TYPE_MODULE_INDEX_DIFF                                       \
+  (modulemd_module_index_diff_get_type ())
+
+G_DECLARE_FINAL_TYPE (ModulemdModuleIndexDiff,
+                      modulemd_module_index_diff,
+                      MODULEMD,
+                      MODULE_INDEX_DIFF,
+                      GObject)
+
+
+/**
+ * modulemd_module_index_diff:
+ * @old_index: (in): The #ModulemdModuleIndex to compare against.
+ * @new_index: (in): The #ModulemdModuleIndex to compare with @old_index.
+ * @error: (out): A #GError containing the reason the indexes could not be
+ * compared.
+ *
+ * Computes the changes that turn @old_index into @new_index. Neither index
+ * is modified, except that the content digests of their objects are
+ * remembered for later calls.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdModuleIndexDiff. NULL
+ * and sets @error if an object of either index could not be serialized.
+ *
+ * Since: 2.16
+ */
+ModulemdModuleIndexDiff *
+modulemd_module_index_diff (ModulemdModuleIndex *old_index,
+                            ModulemdModuleIndex *new_index,
+                            GError **error);
+
+
+/**
+ * modulemd_module_index_diff_is_empty:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: TRUE if the two indexes that were compared have the same content.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_diff_is_empty (ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_added_streams:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdModuleStream): The module
+ * streams of the new index whose NSVCA does not appear in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_added_streams (ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_removed_streams:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdModuleStream): The module
+ * streams of the old index whose NSVCA does not appear in the new index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_removed_streams (ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_changed_streams:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdModuleStream): The module
+ * streams of the new index whose content differs from the stream with the
+ * same NSVCA in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_changed_streams (ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_added_defaults:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdDefaults): The defaults of
+ * the new index for modules that have no defaults in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_added_defaults (ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_removed_defaults:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdDefaults): The defaults of
+ * the old index for modules that have no defaults in the new index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_removed_defaults (
+  ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_changed_defaults:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdDefaults): The defaults of
+ * the new index whose content differs from the defaults for the same module
+ * in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_changed_defaults (
+  ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_added_obsoletes:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdObsoletes): The obsoletes
+ * of the new index that do not appear in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_added_obsoletes (ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_removed_obsoletes:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdObsoletes): The obsoletes
+ * of the old index that do not appear in the new index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_removed_obsoletes (
+  ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_changed_obsoletes:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdObsoletes): The obsoletes
+ * of the new index whose content differs from the obsoletes with the same
+ * module name, stream, context and modified time in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_changed_obsoletes (
+  ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_added_translations:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdTranslation): The
+ * translations of the new index for module streams that have no translation
+ * in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_added_translations (
+  ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_removed_translations:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdTranslation): The
+ * translations of the old index for module streams that have no translation
+ * in the new index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_removed_translations (
+  ModulemdModuleIndexDiff *self);
+
+
+/**
+ * modulemd_module_index_diff_get_changed_translations:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ *
+ * Returns: (transfer none) (element-type ModulemdTranslation): The
+ * translations of the new index whose content differs from the translation
+ * for the same module stream in the old index.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_diff_get_changed_translations (
+  ModulemdModuleIndexDiff *self);
+
+G_END_DECLS
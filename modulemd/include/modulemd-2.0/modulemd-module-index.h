@@ -13,11 +13,14 @@
 
 #pragma once
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-module.h"
 #include "modulemd-module-stream.h"
+#include "modulemd-package-provider.h"
 #include "modulemd-subdocument-info.h"
 #include "modulemd-translation.h"
 #include "modulemd-obsoletes.h"
+#include <gio/gio.h>
 #include <glib-object.h>
 
 G_BEGIN_DECLS
@@ -65,6 +68,12 @@ G_BEGIN_DECLS
  *
  * See the #ModulemdModuleIndexMerger documentation for details on merging
  * #ModulemdModuleIndex objects from separate repositories together.
+ *
+ * A #ModulemdModuleIndex is not thread-safe in general: some of the functions
+ * that only read from it build caches or sort its contents on first use. An
+ * index that has been completely loaded can be made immutable with
+ * modulemd_module_index_freeze() and then queried from any number of threads
+ * without locking.
  */
 
 #define MODULEMD_TYPE_MODULE_INDEX (modulemd_module_index_get_type ())
@@ -130,6 +139,27 @@ typedef gint (*ModulemdWriteHandler) (void *data,
                                       size_t size);
 
 
+/**
+ * ModulemdModuleIndexProgressFunc:
+ * @bytes_processed: (in): The number of bytes of YAML read or written so far.
+ * For compressed input, this counts decompressed bytes.
+ * @documents_processed: (in): The number of YAML subdocuments read or written
+ * so far, including subdocuments that failed to parse.
+ * @user_data: (in): The data passed along with this function.
+ *
+ * Reports the progress of an asynchronous load or dump of a
+ * #ModulemdModuleIndex. It is called in the thread-default main context of
+ * the thread that started the operation. Reports may be coalesced, so not
+ * every subdocument necessarily results in a call, but the last call before
+ * the operation completes reflects everything that was processed.
+ *
+ * Since: 2.16
+ */
+typedef void (*ModulemdModuleIndexProgressFunc) (guint64 bytes_processed,
+                                                 guint64 documents_processed,
+                                                 gpointer user_data);
+
+
 /**
  * modulemd_module_index_new:
  *
@@ -161,6 +191,11 @@ modulemd_module_index_new (void);
  * %NULL (if you don't care) or a pointer to %NULL (if you want to know the
  * error). On output, it will become allocated only if an error occured.
  *
+ * The file may be compressed with gzip, bzip2, xz or Zstandard. Compressed
+ * files are decompressed on a separate thread while they are being parsed,
+ * using zlib, libbz2, liblzma or libzstd if libmodulemd was built with them
+ * and librpm's rpmio otherwise.
+ *
  * Returns: %TRUE if the update was successful. Returns %FALSE and sets
  * @failures appropriately if any of the YAML subdocuments were invalid or
  * sets @error if there was a fatal parse error.
@@ -209,6 +244,128 @@ modulemd_module_index_update_from_string (ModulemdModuleIndex *self,
                                           GError **error);
 
 
+/**
+ * modulemd_module_index_update_from_file_async:
+ * @self: This #ModulemdModuleIndex object.
+ * @yaml_file: (in): A name of a YAML file containing the module metadata and
+ * other related information such as default streams. It may be compressed in
+ * the same ways as for modulemd_module_index_update_from_file().
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ * @io_priority: (in): The I/O priority of the request, such as
+ * %G_PRIORITY_DEFAULT.
+ * @cancellable: (in) (nullable): A #GCancellable to stop the operation.
+ * @progress_callback: (in) (nullable) (scope notified)
+ * (closure progress_data) (destroy progress_data_free): A function to report
+ * the progress of the operation to.
+ * @progress_data: (in): Data to pass to @progress_callback.
+ * @progress_data_free: (in) (nullable): A function to free @progress_data
+ * once it is no longer needed.
+ * @callback: (in) (scope async) (closure user_data): A #GAsyncReadyCallback to
+ * call when the operation is complete.
+ * @user_data: (in): Data to pass to @callback.
+ *
+ * Asynchronously reads the YAML file on a worker thread. Call
+ * modulemd_module_index_update_from_file_finish() from @callback to get the
+ * result and to add the documents that were read to this index.
+ *
+ * The file is read into a separate index, with the same retain-source and
+ * force-validate settings as this one. This index is not modified until
+ * modulemd_module_index_update_from_file_finish() merges the documents into
+ * it, as modulemd_module_index_merge() does with @override set.
+ *
+ * Cancellation is checked after each YAML subdocument has been read. If the
+ * operation is cancelled or fails, this index is left unchanged.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_index_update_from_file_async (
+  ModulemdModuleIndex *self,
+  const gchar *yaml_file,
+  gboolean strict,
+  int io_priority,
+  GCancellable *cancellable,
+  ModulemdModuleIndexProgressFunc progress_callback,
+  gpointer progress_data,
+  GDestroyNotify progress_data_free,
+  GAsyncReadyCallback callback,
+  gpointer user_data);
+
+
+/**
+ * modulemd_module_index_update_from_file_finish:
+ * @self: This #ModulemdModuleIndex object.
+ * @result: (in): The #GAsyncResult passed to the #GAsyncReadyCallback of
+ * modulemd_module_index_update_from_file_async().
+ * @failures: (out) (optional) (element-type ModulemdSubdocumentInfo)
+ * (transfer container): On output, an array containing any subdocuments
+ * (pointers to #ModulemdSubdocumentInfo) from the YAML file that failed to
+ * parse. The caller is responsible for freeing the array.
+ * @error: (out): A #GError containing additional information if the operation
+ * failed in a way that prevents program continuation, including
+ * %G_IO_ERROR_CANCELLED if it was cancelled.
+ *
+ * Finishes an operation started with
+ * modulemd_module_index_update_from_file_async(). Unless that operation
+ * failed or was cancelled, the documents that were read are merged into
+ * @self.
+ *
+ * Returns: %TRUE if the update was successful. Returns %FALSE and sets
+ * @failures appropriately if any of the YAML subdocuments were invalid or
+ * sets @error if there was a fatal parse error or the operation was
+ * cancelled.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_update_from_file_finish (ModulemdModuleIndex *self,
+                                               GAsyncResult *result,
+                                               GPtrArray **failures,
+                                               GError **error);
+
+
+/**
+ * modulemd_module_index_update_from_bytes:
+ * @self: This #ModulemdModuleIndex object.
+ * @yaml_bytes: (in): A #GBytes containing YAML module metadata and other
+ * related information such as default streams. It may be compressed with
+ * gzip, bzip2, xz or Zstandard; the compression is detected from its content.
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ * @failures: (out) (element-type ModulemdSubdocumentInfo) (transfer container):
+ * On output, an array containing any subdocuments (pointers to
+ * #ModulemdSubdocumentInfo) from the YAML data that failed to parse. On
+ * input, it must be a non-%NULL pointer. If that pointer points to %NULL, this
+ * call will allocate a new array (regardless of any failures) with an element
+ * destructor set to g_object_unref(). Otherwise, the pointed array is reused
+ * without emptying before adding the failed subdocuments. The caller is
+ * responsible for freeing the array.
+ * @error: (out): A #GError containing additional information if this function
+ * fails in a way that prevents program continuation. On input, it must be
+ * %NULL (if you don't care) or a pointer to %NULL (if you want to know the
+ * error). On output, it will become allocated only if an error occured.
+ *
+ * Unlike modulemd_module_index_update_from_string(), the data does not need
+ * to be NUL-terminated and is never copied. Compressed data is decompressed
+ * in a streaming fashion while it is parsed. Decompression requires
+ * libmodulemd to be built with the matching compression library; rpmio is
+ * not used for in-memory data.
+ *
+ * Returns: %TRUE if the update was successful. Returns %FALSE and sets
+ * @failures appropriately if any of the YAML subdocuments were invalid or
+ * sets @error if there was a fatal parse or decompression error.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_update_from_bytes (ModulemdModuleIndex *self,
+                                         GBytes *yaml_bytes,
+                                         gboolean strict,
+                                         GPtrArray **failures,
+                                         GError **error);
+
+
 /**
  * modulemd_module_index_update_from_stream: (skip)
  * @self: This #ModulemdModuleIndex object.
@@ -278,6 +435,80 @@ modulemd_module_index_update_from_custom (ModulemdModuleIndex *self,
                                           GError **error);
 
 
+/**
+ * modulemd_module_index_update_from_json:
+ * @self: This #ModulemdModuleIndex object.
+ * @json_string: (in): A JSON array of documents, as written by
+ * modulemd_module_index_dump_to_json().
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ * @failures: (out) (element-type ModulemdSubdocumentInfo) (transfer container):
+ * On output, an array containing any documents (pointers to
+ * #ModulemdSubdocumentInfo) from the input that failed to parse. On input, it
+ * must be a non-%NULL pointer. If that pointer points to %NULL, this call will
+ * allocate a new array (regardless of any failures) with an element
+ * destructor set to g_object_unref(). Otherwise, the pointed array is reused
+ * without emptying before adding the failed documents. The caller is
+ * responsible for freeing the array.
+ * @error: (out): A #GError containing additional information if this function
+ * fails in a way that prevents program continuation. On input, it must be
+ * %NULL (if you don't care) or a pointer to %NULL (if you want to know the
+ * error). On output, it will become allocated only if an error occured.
+ *
+ * Each element of the array is an object holding the same `document`,
+ * `version` and `data` keys as a YAML subdocument and is read the same way.
+ *
+ * Returns: %TRUE if the update was successful. Returns %FALSE and sets
+ * @failures appropriately if any of the documents were invalid or sets
+ * @error if there was a fatal parse error.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_update_from_json (ModulemdModuleIndex *self,
+                                        const gchar *json_string,
+                                        gboolean strict,
+                                        GPtrArray **failures,
+                                        GError **error);
+
+
+/**
+ * modulemd_module_index_update_from_cbor:
+ * @self: This #ModulemdModuleIndex object.
+ * @cbor: (in): A CBOR array of documents, as written by
+ * modulemd_module_index_dump_to_cbor().
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ * @failures: (out) (element-type ModulemdSubdocumentInfo) (transfer container):
+ * On output, an array containing any documents (pointers to
+ * #ModulemdSubdocumentInfo) from the input that failed to parse. On input, it
+ * must be a non-%NULL pointer. If that pointer points to %NULL, this call will
+ * allocate a new array (regardless of any failures) with an element
+ * destructor set to g_object_unref(). Otherwise, the pointed array is reused
+ * without emptying before adding the failed documents. The caller is
+ * responsible for freeing the array.
+ * @error: (out): A #GError containing additional information if this function
+ * fails in a way that prevents program continuation. On input, it must be
+ * %NULL (if you don't care) or a pointer to %NULL (if you want to know the
+ * error). On output, it will become allocated only if an error occured.
+ *
+ * Reads the CBOR encoding of the documents read by
+ * modulemd_module_index_update_from_json(). CBOR tags are ignored.
+ *
+ * Returns: %TRUE if the update was successful. Returns %FALSE and sets
+ * @failures appropriately if any of the documents were invalid or sets
+ * @error if @cbor is not valid CBOR or there was a fatal parse error.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_update_from_cbor (ModulemdModuleIndex *self,
+                                        GBytes *cbor,
+                                        gboolean strict,
+                                        GPtrArray **failures,
+                                        GError **error);
+
+
 /**
  * modulemd_module_index_update_from_defaults_directory:
  * @self: This #ModulemdModuleIndex object.
@@ -323,6 +554,13 @@ modulemd_module_index_update_from_defaults_directory (
  * @error: (out): A #GError containing the reason the function failed, NULL if
  * the function succeeded.
  *
+ * Modules are emitted in alphabetical order. For large indexes, the
+ * subdocuments of each module are validated and rendered on a pool of worker
+ * threads and then written in that same order, so the output does not depend
+ * on whether threads were used. This also applies to
+ * modulemd_module_index_dump_to_stream() and
+ * modulemd_module_index_dump_to_custom().
+ *
  * Returns: (transfer full): A YAML representation of the index as a string. In
  * the event of an error, sets @error appropriately and returns NULL.
  *
@@ -372,6 +610,120 @@ modulemd_module_index_dump_to_custom (ModulemdModuleIndex *self,
                                       GError **error);
 
 
+/**
+ * modulemd_module_index_dump_to_json:
+ * @self: This #ModulemdModuleIndex object.
+ * @error: (out): A #GError containing the reason the function failed, NULL if
+ * the function succeeded.
+ *
+ * Writes the same documents as modulemd_module_index_dump_to_string(), in
+ * the same order, as a JSON array. Each document is an object with the keys
+ * of a YAML subdocument, such as `document`, `version` and `data`. Fields
+ * that hold integers or booleans, such as `version` and `buildorder`, are
+ * written as JSON numbers and booleans. Every other value is a JSON string,
+ * even if it looks like a number.
+ *
+ * Streams are always written from their current contents, even if @self
+ * retains the source of its streams.
+ *
+ * Returns: (transfer full): A JSON representation of the index as a string.
+ * In the event of an error, sets @error appropriately and returns NULL.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_module_index_dump_to_json (ModulemdModuleIndex *self,
+                                    GError **error);
+
+
+/**
+ * modulemd_module_index_dump_to_cbor:
+ * @self: This #ModulemdModuleIndex object.
+ * @error: (out): A #GError containing the reason the function failed, NULL if
+ * the function succeeded.
+ *
+ * Writes the documents of modulemd_module_index_dump_to_json() in the
+ * corresponding CBOR encoding, as described by RFC 8949. Arrays and maps use
+ * the indefinite-length encoding.
+ *
+ * Returns: (transfer full): A CBOR representation of the index. In the event
+ * of an error, sets @error appropriately and returns NULL.
+ *
+ * Since: 2.16
+ */
+GBytes *
+modulemd_module_index_dump_to_cbor (ModulemdModuleIndex *self,
+                                    GError **error);
+
+
+/**
+ * modulemd_module_index_dump_to_file_async:
+ * @self: This #ModulemdModuleIndex object.
+ * @yaml_file: (in): The name of the file to write the module metadata and
+ * other related information to.
+ * @io_priority: (in): The I/O priority of the request, such as
+ * %G_PRIORITY_DEFAULT.
+ * @cancellable: (in) (nullable): A #GCancellable to stop the operation.
+ * @progress_callback: (in) (nullable) (scope notified)
+ * (closure progress_data) (destroy progress_data_free): A function to report
+ * the progress of the operation to.
+ * @progress_data: (in): Data to pass to @progress_callback.
+ * @progress_data_free: (in) (nullable): A function to free @progress_data
+ * once it is no longer needed.
+ * @callback: (in) (scope async) (closure user_data): A #GAsyncReadyCallback to
+ * call when the operation is complete.
+ * @user_data: (in): Data to pass to @callback.
+ *
+ * Asynchronously writes this index to @yaml_file on a worker thread, in the
+ * same format as modulemd_module_index_dump_to_string(). Call
+ * modulemd_module_index_dump_to_file_finish() from @callback to get the
+ * result.
+ *
+ * The output is written to a temporary file in the same directory which
+ * replaces @yaml_file only once it is complete, so @yaml_file is left
+ * untouched if the operation fails or is cancelled. The permissions of an
+ * existing @yaml_file are kept, and so are its owner and group as far as the
+ * process is allowed to set them. Cancellation is checked between modules.
+ *
+ * The index must not be modified until @callback has been called.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_index_dump_to_file_async (
+  ModulemdModuleIndex *self,
+  const gchar *yaml_file,
+  int io_priority,
+  GCancellable *cancellable,
+  ModulemdModuleIndexProgressFunc progress_callback,
+  gpointer progress_data,
+  GDestroyNotify progress_data_free,
+  GAsyncReadyCallback callback,
+  gpointer user_data);
+
+
+/**
+ * modulemd_module_index_dump_to_file_finish:
+ * @self: This #ModulemdModuleIndex object.
+ * @result: (in): The #GAsyncResult passed to the #GAsyncReadyCallback of
+ * modulemd_module_index_dump_to_file_async().
+ * @error: (out): A #GError containing the reason the operation failed,
+ * including %G_IO_ERROR_CANCELLED if it was cancelled.
+ *
+ * Finishes an operation started with
+ * modulemd_module_index_dump_to_file_async().
+ *
+ * Returns: TRUE if written successfully, FALSE and sets @error appropriately
+ * in the event of an error.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_dump_to_file_finish (ModulemdModuleIndex *self,
+                                           GAsyncResult *result,
+                                           GError **error);
+
+
 /**
  * modulemd_module_index_get_module_names_as_strv: (rename-to modulemd_module_index_get_module_names)
  * @self: This #ModulemdModuleIndex object.
@@ -455,6 +807,30 @@ modulemd_module_index_search_streams_by_nsvca_glob (
   ModulemdModuleIndex *self, const gchar *nsvca_pattern);
 
 
+/**
+ * modulemd_module_index_search_streams_by_query:
+ * @self: This #ModulemdModuleIndex object.
+ * @query: (in): A #ModulemdStreamQuery describing the streams to retrieve.
+ *
+ * Search the index using a precompiled #ModulemdStreamQuery. The patterns of
+ * @query are prepared once, so reusing a query across many searches avoids
+ * reparsing them. If @query names a single module without wildcards, only
+ * that module is visited.
+ *
+ * Returns: (transfer container) (element-type ModulemdModuleStream): The list
+ * of stream objects matching @query. This function cannot fail, but it may
+ * return a zero-length list if no matches were found. The returned streams
+ * will be in a predictable order, sorted first by module name, then stream
+ * name, then by version (highest first), then by context and finally by
+ * architecture.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_search_streams_by_query (ModulemdModuleIndex *self,
+                                               ModulemdStreamQuery *query);
+
+
 /**
  * modulemd_module_index_search_rpms:
  * @self: This #ModulemdModuleIndex object.
@@ -480,6 +856,183 @@ modulemd_module_index_search_rpms (ModulemdModuleIndex *self,
                                    const gchar *nevra_pattern);
 
 
+/**
+ * modulemd_module_index_search_package_providers:
+ * @self: This #ModulemdModuleIndex object.
+ * @package_name: (not nullable): The exact name of a package, such as
+ * "python3-django".
+ * @sources: (in): The #ModulemdPackageSourceFlags to search. Pass
+ * %MD_PACKAGE_SOURCE_ALL to search all of them.
+ *
+ * Finds the module streams that provide @package_name, either by listing it
+ * in their `api.rpms`, in the `rpms` of one of their profiles, or by having
+ * an RPM component of that name. Unlike modulemd_module_index_search_rpms(),
+ * this matches package names rather than NEVRA patterns of rpm artifacts.
+ *
+ * The first search builds a map of every package name in the index, visiting
+ * each entry of each stream once; later searches are hash table lookups until
+ * a module stream is added to or removed from @self. The map is not updated
+ * if the retrieved streams or profiles are modified directly. This function
+ * may be called from several threads at once on a frozen index.
+ *
+ * Returns: (transfer full) (element-type ModulemdPackageProvider): One
+ * #ModulemdPackageProvider for each place @package_name was found in. A
+ * stream that lists @package_name in several places appears once for each
+ * of them. This function cannot fail, but it may return a zero-length list if
+ * no matches were found. The providers are sorted first by module name, then
+ * stream name, then by version (highest first), then by context and
+ * architecture, and then by source in the order of #ModulemdPackageSourceFlags
+ * and profile name.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_search_package_providers (
+  ModulemdModuleIndex *self,
+  const gchar *package_name,
+  ModulemdPackageSourceFlags sources);
+
+
+/**
+ * modulemd_module_index_foreach_stream:
+ * @self: This #ModulemdModuleIndex object.
+ * @query: (in) (nullable): A #ModulemdStreamQuery selecting the streams to
+ * visit. If NULL, all streams in the index are visited.
+ * @func: (in) (scope call) (closure user_data): The function to call for each
+ * matching stream.
+ * @user_data: (in): Data to pass to @func.
+ *
+ * Call @func for every stream in the index that matches @query, in the same
+ * order as modulemd_module_index_search_streams_by_query() would return them,
+ * without allocating any result arrays. The sorted orders of module names and
+ * of the streams within each module are cached on the index and reused until
+ * modules or streams are added or removed.
+ *
+ * @func must not add or remove modules or streams in @self.
+ *
+ * Returns: TRUE if every matching stream was visited, FALSE if @func stopped
+ * the iteration early.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_foreach_stream (ModulemdModuleIndex *self,
+                                      ModulemdStreamQuery *query,
+                                      ModulemdModuleStreamFunc func,
+                                      gpointer user_data);
+
+
+/**
+ * modulemd_module_index_foreach_stream_by_rpm:
+ * @self: This #ModulemdModuleIndex object.
+ * @nevra_pattern: (not nullable): A [glob](https://www.mankier.com/3/glob)
+ * pattern to match against the NEVRA strings of the rpm artifacts in the
+ * #ModulemdModuleStream objects in this module.
+ * @func: (in) (scope call) (closure user_data): The function to call for each
+ * matching stream.
+ * @user_data: (in): Data to pass to @func.
+ *
+ * Call @func for every stream in the index that includes an rpm artifact
+ * matching @nevra_pattern, without allocating a result array. Streams are
+ * visited sorted by module name, then stream name, then by version (highest
+ * first), then by context and finally by architecture.
+ *
+ * @func must not add or remove modules or streams in @self.
+ *
+ * Returns: TRUE if every matching stream was visited, FALSE if @func stopped
+ * the iteration early.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_foreach_stream_by_rpm (ModulemdModuleIndex *self,
+                                             const gchar *nevra_pattern,
+                                             ModulemdModuleStreamFunc func,
+                                             gpointer user_data);
+
+
+/**
+ * modulemd_module_index_get_stream_table:
+ * @self: This #ModulemdModuleIndex object.
+ * @query: (in) (nullable): A #ModulemdStreamQuery selecting the streams to
+ * include. If NULL, all streams in the index are included.
+ *
+ * Collects the identifying fields of many streams in a single call. This is
+ * much faster from language bindings than retrieving each stream and calling
+ * its getters.
+ *
+ * Returns: (transfer full): A #GVariant of type `a(sstss)` holding one
+ * (module name, stream name, version, context, architecture) tuple for each
+ * matching stream, in the order of
+ * modulemd_module_index_search_streams_by_query(). A context or architecture
+ * that is not set is an empty string.
+ *
+ * Since: 2.16
+ */
+GVariant *
+modulemd_module_index_get_stream_table (ModulemdModuleIndex *self,
+                                        ModulemdStreamQuery *query);
+
+
+/**
+ * modulemd_module_index_get_rpm_artifacts_table:
+ * @self: This #ModulemdModuleIndex object.
+ * @query: (in) (nullable): A #ModulemdStreamQuery selecting the streams to
+ * include. If NULL, all streams in the index are included.
+ *
+ * Returns: (transfer full): A #GVariant of type `a(sas)` holding one (NSVCA,
+ * rpm artifacts) tuple for each matching stream, in the order of
+ * modulemd_module_index_get_stream_table(). The NSVCA is the string returned
+ * by modulemd_module_stream_get_NSVCA_as_string() and the NEVRAs of the rpm
+ * artifacts are sorted.
+ *
+ * Since: 2.16
+ */
+GVariant *
+modulemd_module_index_get_rpm_artifacts_table (ModulemdModuleIndex *self,
+                                               ModulemdStreamQuery *query);
+
+
+/**
+ * modulemd_module_index_get_rpm_artifact_map:
+ * @self: This #ModulemdModuleIndex object.
+ * @query: (in) (nullable): A #ModulemdStreamQuery selecting the streams to
+ * include. If NULL, all streams in the index are included.
+ *
+ * Returns: (transfer full): A #GVariant of type `a{sas}` mapping the NEVRA of
+ * each rpm artifact of the matching streams to the NSVCAs of the streams that
+ * list it. The NEVRAs are sorted and the NSVCAs of each are in the order of
+ * modulemd_module_index_get_stream_table().
+ *
+ * Since: 2.16
+ */
+GVariant *
+modulemd_module_index_get_rpm_artifact_map (ModulemdModuleIndex *self,
+                                            ModulemdStreamQuery *query);
+
+
+/**
+ * modulemd_module_index_get_dependencies_table:
+ * @self: This #ModulemdModuleIndex object.
+ * @query: (in) (nullable): A #ModulemdStreamQuery selecting the streams to
+ * include. If NULL, all streams in the index are included.
+ *
+ * Returns: (transfer full): A #GVariant of type `a(subsas)` holding one
+ * (NSVCA, dependencies index, runtime, module name, streams) tuple for each
+ * module that a matching stream depends on. The dependencies index is the
+ * position of the #ModulemdDependencies object in the stream, and runtime is
+ * FALSE for build-time dependencies. The dependencies of
+ * #ModulemdModuleStreamV1 streams all have index 0 and a single stream. Rows
+ * are in the order of modulemd_module_index_get_stream_table(), then by
+ * dependencies index, build-time before run-time, and module name.
+ *
+ * Since: 2.16
+ */
+GVariant *
+modulemd_module_index_get_dependencies_table (ModulemdModuleIndex *self,
+                                              ModulemdStreamQuery *query);
+
+
 /**
  * modulemd_module_index_remove_module:
  * @self: This #ModulemdModuleIndex object.
@@ -587,6 +1140,37 @@ modulemd_module_index_get_default_streams_as_hash_table (
   ModulemdModuleIndex *self, const gchar *intent);
 
 
+/**
+ * modulemd_module_index_get_default_stream:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @module_name: (in): The name of the module whose default stream will be
+ * retrieved.
+ * @intent: (in) (nullable): The name of the system intent whose default stream
+ * will be retrieved. If left NULL or the specified intent has no separate
+ * default, it will return the generic default stream for this module.
+ * System intents are deprecated and this argument will be ignored in the
+ * future.
+ *
+ * Look up the default stream of a single module without copying the full
+ * table returned by modulemd_module_index_get_default_streams_as_hash_table().
+ * The mapping for each @intent is computed on first use and cached until
+ * defaults are next added to, removed from or upgraded in @self. Changes made
+ * directly to a #ModulemdDefaults object already owned by the index are not
+ * detected; re-add it with modulemd_module_index_add_defaults() instead.
+ *
+ * Returns: (transfer none) (nullable): The default stream for @module_name,
+ * or NULL if the module does not exist in the index or has no default stream.
+ * The returned string is owned by @self and is only valid until the defaults
+ * in the index next change.
+ *
+ * Since: 2.16
+ */
+const gchar *
+modulemd_module_index_get_default_stream (ModulemdModuleIndex *self,
+                                          const gchar *module_name,
+                                          const gchar *intent);
+
+
 /**
  * modulemd_module_index_add_translation:
  * @self: This #ModulemdModuleIndex object.
@@ -638,7 +1222,23 @@ modulemd_module_index_get_stream_mdversion (ModulemdModuleIndex *self);
  * not be upgraded in the event of an error.
  *
  * Upgrades all #ModulemdModuleStream objects in this index to @mdversion if
- * they are not already at that version.
+ * they are not already at that version. Large indexes are upgraded using one
+ * worker thread per available processor.
+ *
+ * Calling this on an empty index before loading metadata into it is a cheap
+ * way to tell the index which version the metadata will need. Streams of a
+ * lower version are then upgraded once as they are added, rather than the
+ * whole index being upgraded again when the first higher-version stream is
+ * read.
+ *
+ * modulemd_module_index_update_from_string(),
+ * modulemd_module_index_update_from_bytes() and
+ * modulemd_module_index_update_from_file() avoid the repeated upgrade
+ * automatically for uncompressed input, without raising the version of the
+ * index up front. They scan the input for `document` and `version` keys
+ * before parsing it, and hold back the lower-version streams until the rest
+ * of the input has been added. The index only reaches the higher version if
+ * a document that needs it was actually added.
  *
  * Since: 2.0
  */
@@ -686,4 +1286,259 @@ void
 modulemd_module_index_clear_xmds (ModulemdModuleIndex *self);
 
 
+/**
+ * modulemd_module_index_freeze:
+ * @self: This #ModulemdModuleIndex object.
+ *
+ * Makes the index and its modules immutable. All of the sorting and caching
+ * that queries would otherwise do lazily is done now, so no function that
+ * reads from @self modifies it afterwards and a frozen index may be queried
+ * from several threads at the same time without locking. Freezing must
+ * happen before @self is shared with other threads.
+ *
+ * Every attempt to modify a frozen index fails: functions that take a
+ * #GError set it to %MMD_ERROR_FROZEN, and the others, such as
+ * modulemd_module_index_remove_module(), emit a critical warning and do
+ * nothing. The same applies to the #ModulemdModule objects of the index and
+ * to the streams, defaults, translations and obsoletes it holds, including
+ * the components, profiles and other objects within them: their setters emit
+ * a critical warning and leave them unchanged. Copies of those objects are
+ * not frozen, so use the copy functions to modify them.
+ *
+ * A frozen index can still be dumped, and it can be merged into other indexes
+ * with #ModulemdModuleIndexMerger. There is no way to thaw an index; load or
+ * merge its contents into a new #ModulemdModuleIndex to modify them.
+ * Freezing an index that is already frozen does nothing.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_index_freeze (ModulemdModuleIndex *self);
+
+
+/**
+ * modulemd_module_index_is_frozen:
+ * @self: This #ModulemdModuleIndex object.
+ *
+ * Returns: TRUE if modulemd_module_index_freeze() has been called on @self.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_is_frozen (ModulemdModuleIndex *self);
+
+
+/**
+ * modulemd_module_index_set_force_validate:
+ * @self: This #ModulemdModuleIndex object.
+ * @force_validate: Whether the dump functions validate every module stream.
+ *
+ * The dump functions validate each module stream before writing it. By
+ * default, they skip the streams that have not been modified since they last
+ * passed validation, either when they were loaded by one of the
+ * modulemd_module_index_update_from_*() functions, when @self was frozen or
+ * during an earlier dump. A stream counts as modified when one of its
+ * setters is called, or one of the setters of an object stored in it, such
+ * as a component returned by one of its getters. When @force_validate is
+ * TRUE, every stream is validated on every dump.
+ *
+ * This cannot be changed once @self is frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_index_set_force_validate (ModulemdModuleIndex *self,
+                                          gboolean force_validate);
+
+
+/**
+ * modulemd_module_index_get_force_validate:
+ * @self: This #ModulemdModuleIndex object.
+ *
+ * Returns: The value set with modulemd_module_index_set_force_validate().
+ * FALSE by default.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_get_force_validate (ModulemdModuleIndex *self);
+
+
+/**
+ * modulemd_module_index_set_compact_on_load:
+ * @self: This #ModulemdModuleIndex object.
+ * @compact_on_load: Whether to compact the module streams as they are loaded.
+ *
+ * When @compact_on_load is TRUE, every module stream that the
+ * modulemd_module_index_update_from_*() functions add to @self is compacted
+ * as described for modulemd_module_index_compact() right after it is parsed,
+ * before the next document is read. This keeps the peak memory of a load
+ * down, since the duplicate sets are freed while the parser still needs
+ * memory for the documents that follow. Streams loaded by separate calls,
+ * such as from the files of each architecture, share with each other too.
+ *
+ * The canonical sets are kept by @self until @compact_on_load is set to
+ * FALSE again. Streams added with modulemd_module_index_add_module_stream()
+ * are not compacted.
+ *
+ * This cannot be changed once @self is frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_index_set_compact_on_load (ModulemdModuleIndex *self,
+                                           gboolean compact_on_load);
+
+
+/**
+ * modulemd_module_index_get_compact_on_load:
+ * @self: This #ModulemdModuleIndex object.
+ *
+ * Returns: The value set with modulemd_module_index_set_compact_on_load().
+ * FALSE by default.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_get_compact_on_load (ModulemdModuleIndex *self);
+
+
+/**
+ * modulemd_module_index_compact:
+ * @self: This #ModulemdModuleIndex object.
+ *
+ * Builds of one module stream for several architectures usually carry
+ * identical component buildafter and arch lists, buildopts whitelists,
+ * dependency tables and profile RPM lists. This makes the module streams of
+ * @self share a single instance of each of those lists that are identical,
+ * instead of owning separate copies. The components, buildopts, dependencies
+ * and profiles themselves stay separate objects.
+ *
+ * A shared list is copied the first time it is changed through any of the
+ * objects that hold it, so the streams of @self can still be modified freely
+ * and changing one of them never changes another. Copies of the streams,
+ * such as those made by modulemd_module_stream_copy() or when merging @self
+ * into another index, keep sharing the lists on the same terms.
+ *
+ * This must be done before @self is shared with other threads. It may be
+ * done before or after modulemd_module_index_freeze(). Streams in the v1
+ * format are not compacted. Calling this again without modifying @self does
+ * nothing. To compact the streams as they are loaded instead, which keeps
+ * the peak memory lower, see modulemd_module_index_set_compact_on_load().
+ *
+ * Returns: The number of lists that were replaced by an identical list of
+ * another stream.
+ *
+ * Since: 2.16
+ */
+guint
+modulemd_module_index_compact (ModulemdModuleIndex *self);
+
+
+/**
+ * modulemd_module_index_get_memory_usage:
+ * @self: This #ModulemdModuleIndex object.
+ *
+ * Estimates how much memory @self uses, by walking all of the objects, strings
+ * and tables it owns. Nothing is copied or serialized, so this is cheap enough
+ * to call on a large index. The lookup tables and caches that @self has built
+ * so far, such as those of modulemd_module_index_freeze(), are included as
+ * memory used by the index itself.
+ *
+ * This may be called on a frozen index from several threads at once.
+ *
+ * Returns: (transfer full): A #ModulemdMemoryUsage breaking the memory down by
+ * module and by #ModulemdMemoryCategoryEnum.
+ *
+ * Since: 2.16
+ */
+ModulemdMemoryUsage *
+modulemd_module_index_get_memory_usage (ModulemdModuleIndex *self);
+
+
+/**
+ * modulemd_module_index_get_digest:
+ * @self: This #ModulemdModuleIndex object.
+ * @error: (out): A #GError containing the reason the digest could not be
+ * computed.
+ *
+ * Computes a digest that identifies the content of @self. Two indexes with
+ * the same module streams, defaults, obsoletes and translations have the same
+ * digest, no matter in which order the documents were loaded.
+ *
+ * The digest of each module stream is remembered until the stream or one of
+ * the objects in it is modified, so later calls only serialize the streams
+ * that changed, along with the defaults, obsoletes and translations, which do
+ * not record their changes. Once @self is frozen with
+ * modulemd_module_index_freeze(), nothing can change and the digest of the
+ * whole index is remembered, so only the first call has to serialize it.
+ *
+ * Returns: (transfer full): The hexadecimal SHA-256 based digest of @self.
+ * NULL and sets @error if an object of @self could not be serialized.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_module_index_get_digest (ModulemdModuleIndex *self, GError **error);
+
+
+/**
+ * modulemd_module_index_dump_delta_to_string:
+ * @old_index: (in): The #ModulemdModuleIndex that the delta applies to.
+ * @new_index: (in): The #ModulemdModuleIndex that applying the delta
+ * produces.
+ * @error: (out): A #GError containing the reason the delta could not be
+ * written.
+ *
+ * Writes the changes that turn @old_index into @new_index as a YAML stream
+ * that can be passed to modulemd_module_index_apply_delta().
+ *
+ * The stream starts with a `modulemd-delta` document that holds the digests
+ * of both indexes, as returned by modulemd_module_index_get_digest(), and
+ * lists the module streams, defaults, obsoletes and translations to remove.
+ * It is followed by ordinary `modulemd`, `modulemd-defaults`,
+ * `modulemd-obsoletes` and `modulemd-translations` documents for every object
+ * that was added or changed.
+ *
+ * Returns: (transfer full): A YAML representation of the delta. NULL and sets
+ * @error if the indexes could not be compared or serialized.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_module_index_dump_delta_to_string (ModulemdModuleIndex *old_index,
+                                            ModulemdModuleIndex *new_index,
+                                            GError **error);
+
+
+/**
+ * modulemd_module_index_apply_delta:
+ * @self: This #ModulemdModuleIndex object.
+ * @yaml_string: (in): A delta written by
+ * modulemd_module_index_dump_delta_to_string().
+ * @error: (out): A #GError containing the reason the delta could not be
+ * applied.
+ *
+ * Updates @self in place with the changes described by @yaml_string. Only the
+ * #ModulemdModule objects of the modules that the delta mentions are
+ * replaced; all other modules of @self are left alone, so applying a small
+ * delta takes time in proportion to the size of the delta and of the modules
+ * it changes rather than to the size of @self.
+ *
+ * The delta is only applied if the digest of @self matches the base digest
+ * recorded in the delta and the result matches its result digest. Otherwise,
+ * or if any document of the delta is invalid, @self is not modified. Deltas
+ * that contain documents of a higher mdversion than @self are rejected with
+ * %MMD_ERROR_UPGRADE; upgrade @self first.
+ *
+ * Returns: TRUE if the delta was applied. FALSE and sets @error otherwise.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_index_apply_delta (ModulemdModuleIndex *self,
+                                   const gchar *yaml_string,
+                                   GError **error);
+
+
 G_END_DECLS
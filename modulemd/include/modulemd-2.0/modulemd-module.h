@@ -16,6 +16,7 @@
 #include "modulemd-defaults.h"
 #include "modulemd-deprecated.h"
 #include "modulemd-module-stream.h"
+#include "modulemd-stream-query.h"
 #include "modulemd-translation.h"
 #include "modulemd-obsoletes.h"
 #include <glib-object.h>
@@ -215,6 +216,75 @@ modulemd_module_search_streams_by_nsvca_glob (ModulemdModule *self,
                                               const gchar *nsvca_pattern);
 
 
+/**
+ * ModulemdModuleStreamFunc:
+ * @stream: (in) (transfer none): A #ModulemdModuleStream being visited.
+ * @user_data: (in) (closure): The data passed to the function that started
+ * the iteration.
+ *
+ * The prototype of the callback used to visit module streams without
+ * collecting them into an array first.
+ *
+ * Returns: TRUE to continue to the next matching stream, FALSE to stop the
+ * iteration.
+ *
+ * Since: 2.16
+ */
+typedef gboolean (*ModulemdModuleStreamFunc) (ModulemdModuleStream *stream,
+                                              gpointer user_data);
+
+
+/**
+ * modulemd_module_search_streams_by_query:
+ * @self: This #ModulemdModule object.
+ * @query: (in): A #ModulemdStreamQuery describing the streams to retrieve.
+ *
+ * Search this module using a precompiled #ModulemdStreamQuery. This is
+ * cheaper than modulemd_module_search_streams_by_glob() when the same
+ * patterns are applied to many modules.
+ *
+ * Returns: (transfer container) (element-type ModulemdModuleStream): The list
+ * of stream objects matching @query. This function cannot fail, but it may
+ * return a zero-length list if no matches were found. The returned streams
+ * will be in a predictable order, sorted first by module name, then stream
+ * name, then by version (highest first), then by context and finally by
+ * architecture.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_search_streams_by_query (ModulemdModule *self,
+                                         ModulemdStreamQuery *query);
+
+
+/**
+ * modulemd_module_foreach_stream:
+ * @self: This #ModulemdModule object.
+ * @query: (in) (nullable): A #ModulemdStreamQuery selecting the streams to
+ * visit. If NULL, all streams are visited.
+ * @func: (in) (scope call) (closure user_data): The function to call for each
+ * matching stream.
+ * @user_data: (in): Data to pass to @func.
+ *
+ * Call @func for every stream in this module that matches @query, in the same
+ * order as modulemd_module_search_streams_by_query() would return them, but
+ * without allocating a result array. The sorted order is computed once and
+ * reused until streams are added to or removed from @self.
+ *
+ * @func must not add streams to or remove streams from @self.
+ *
+ * Returns: TRUE if every matching stream was visited, FALSE if @func stopped
+ * the iteration early.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_foreach_stream (ModulemdModule *self,
+                                ModulemdStreamQuery *query,
+                                ModulemdModuleStreamFunc func,
+                                gpointer user_data);
+
+
 /**
  * modulemd_module_get_stream_by_NSVCA:
  * @self: This #ModulemdModule object.
@@ -255,7 +325,8 @@ modulemd_module_get_stream_by_NSVCA (ModulemdModule *self,
  * NULL, matches all architectures.
  *
  * Remove one or more #ModulemdModuleStream objects from this #ModulemdModule
- * that match the provided parameters.
+ * that match the provided parameters. This must not be called on a module of
+ * a frozen #ModulemdModuleIndex; see modulemd_module_index_freeze().
  *
  * Since: 2.3
  */
@@ -344,7 +415,8 @@ modulemd_module_get_newest_active_obsoletes (ModulemdModule *self,
  * Iterates through all #ModulemdModuleStream entries in this
  * #ModulemdModule and removes any XMD sections that are present. This is
  * generally done to trim down the metadata to only the portions that are
- * useful to the package manager.
+ * useful to the package manager. This must not be called on a module of a
+ * frozen #ModulemdModuleIndex; see modulemd_module_index_freeze().
  *
  * Since: 2.14
  */
@@ -0,0 +1,107 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-module-stream.h"
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-package-provider
+ * @title: Modulemd.PackageProvider
+ * @stability: stable
+ * @short_description: A module stream that provides a package, and where in
+ * the stream the package was found.
+ *
+ * #ModulemdPackageProvider objects are returned by
+ * modulemd_module_index_search_package_providers() to answer which module
+ * streams provide a package and how they provide it.
+ */
+
+/**
+ * ModulemdPackageSourceFlags:
+ * @MD_PACKAGE_SOURCE_RPM_API: The package is listed in the `api.rpms` of the
+ * stream.
+ * @MD_PACKAGE_SOURCE_PROFILE: The package is listed in the `rpms` of one of
+ * the profiles of the stream.
+ * @MD_PACKAGE_SOURCE_COMPONENT: The package is the name of one of the RPM
+ * components of the stream.
+ * @MD_PACKAGE_SOURCE_ALL: All of the above.
+ *
+ * The places in a module stream that a package name can be found in.
+ *
+ * Since: 2.16
+ */
+typedef enum
+{
+  MD_PACKAGE_SOURCE_RPM_API = 1 << 0,
+  MD_PACKAGE_SOURCE_PROFILE = 1 << 1,
+  MD_PACKAGE_SOURCE_COMPONENT = 1 << 2,
+
+  MD_PACKAGE_SOURCE_ALL = MD_PACKAGE_SOURCE_RPM_API |
+                          MD_PACKAGE_SOURCE_PROFILE |
+                          MD_PACKAGE_SOURCE_COMPONENT
+} ModulemdPackageSourceFlags;
+
+
+#define MODULEMD_TYPE_PACKAGE_PROVIDER (modulemd_package_provider_get_type ())
+
+G_DECLARE_FINAL_TYPE (ModulemdPackageProvider,
+                      modulemd_package_provider,
+                      MODULEMD,
+                      PACKAGE_PROVIDER,
+                      GObject)
+
+
+/**
+ * modulemd_package_provider_get_stream:
+ * @self: This #ModulemdPackageProvider object.
+ *
+ * Returns: (transfer none): The #ModulemdModuleStream that provides the
+ * package.
+ *
+ * Since: 2.16
+ */
+ModulemdModuleStream *
+modulemd_package_provider_get_stream (ModulemdPackageProvider *self);
+
+
+/**
+ * modulemd_package_provider_get_source:
+ * @self: This #ModulemdPackageProvider object.
+ *
+ * Returns: Exactly one of the #ModulemdPackageSourceFlags, telling where in
+ * the stream the package was found.
+ *
+ * Since: 2.16
+ */
+ModulemdPackageSourceFlags
+modulemd_package_provider_get_source (ModulemdPackageProvider *self);
+
+
+/**
+ * modulemd_package_provider_get_profile_name:
+ * @self: This #ModulemdPackageProvider object.
+ *
+ * Returns: (transfer none) (nullable): The name of the profile that lists the
+ * package if the source is %MD_PACKAGE_SOURCE_PROFILE, otherwise NULL.
+ *
+ * Since: 2.16
+ */
+const gchar *
+modulemd_package_provider_get_profile_name (ModulemdPackageProvider *self);
+
+G_END_DECLS
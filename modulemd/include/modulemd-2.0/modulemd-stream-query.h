@@ -0,0 +1,103 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-module-stream.h"
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-stream-query
+ * @title: Modulemd.StreamQuery
+ * @stability: stable
+ * @short_description: A precompiled set of patterns for searching module
+ * streams.
+ *
+ * A #ModulemdStreamQuery holds the glob patterns used to search for module
+ * streams in a form that is prepared once and can then be applied to any
+ * number of streams. Fields that contain no wildcards are matched by simple
+ * string comparison, fields ending in a single trailing `*` are matched by
+ * prefix comparison and numeric version patterns are matched without
+ * formatting the stream version as a string.
+ *
+ * A #ModulemdStreamQuery is immutable once created, so the same object may
+ * be shared between threads.
+ */
+
+#define MODULEMD_TYPE_STREAM_QUERY (modulemd_stream_query_get_type ())
+
+G_DECLARE_FINAL_TYPE (
+  ModulemdStreamQuery, modulemd_stream_query, MODULEMD, STREAM_QUERY, GObject)
+
+
+/**
+ * modulemd_stream_query_new:
+ * @module_name: (in) (nullable): The module name to match. This may be a glob
+ * pattern. If NULL, any module name matches.
+ * @stream_name: (in) (nullable): The stream name to match. This may be a glob
+ * pattern. If NULL, any stream name matches.
+ * @version: (in) (nullable): The stream version to match. This may be a glob
+ * pattern. If NULL, any version matches.
+ * @context: (in) (nullable): The context to match. This may be a glob pattern.
+ * If NULL, any context matches.
+ * @arch: (in) (nullable): The processor architecture to match. This may be a
+ * glob pattern. If NULL, any architecture matches.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdStreamQuery that
+ * matches module streams whose fields match all of the provided patterns.
+ * The patterns follow the same rules as
+ * modulemd_module_index_search_streams().
+ *
+ * Since: 2.16
+ */
+ModulemdStreamQuery *
+modulemd_stream_query_new (const gchar *module_name,
+                           const gchar *stream_name,
+                           const gchar *version,
+                           const gchar *context,
+                           const gchar *arch);
+
+
+/**
+ * modulemd_stream_query_new_from_nsvca_glob:
+ * @nsvca_pattern: (in) (nullable): A glob pattern matched against the
+ * NSVCA string of each module stream as returned by
+ * modulemd_module_stream_get_NSVCA_as_string(). If NULL, all streams match.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdStreamQuery that
+ * matches module streams the same way as
+ * modulemd_module_index_search_streams_by_nsvca_glob().
+ *
+ * Since: 2.16
+ */
+ModulemdStreamQuery *
+modulemd_stream_query_new_from_nsvca_glob (const gchar *nsvca_pattern);
+
+
+/**
+ * modulemd_stream_query_matches:
+ * @self: (in): This #ModulemdStreamQuery object.
+ * @stream: (in): A #ModulemdModuleStream to test.
+ *
+ * Returns: TRUE if @stream matches all of the patterns of this query.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_stream_query_matches (ModulemdStreamQuery *self,
+                               ModulemdModuleStream *stream);
+
+G_END_DECLS
@@ -23,17 +23,23 @@
 #include "modulemd-defaults.h"
 #include "modulemd-dependencies.h"
 #include "modulemd-deprecated.h"
+#include "modulemd-document-reader.h"
+#include "modulemd-document-writer.h"
 #include "modulemd-errors.h"
+#include "modulemd-memory-usage.h"
+#include "modulemd-module-index-diff.h"
 #include "modulemd-module-index-merger.h"
 #include "modulemd-module-index.h"
 #include "modulemd-module-stream-v1.h"
 #include "modulemd-module-stream-v2.h"
 #include "modulemd-module-stream.h"
 #include "modulemd-module.h"
+#include "modulemd-package-provider.h"
 #include "modulemd-packager-v3.h"
 #include "modulemd-profile.h"
 #include "modulemd-rpm-map-entry.h"
 #include "modulemd-service-level.h"
+#include "modulemd-stream-query.h"
 #include "modulemd-subdocument-info.h"
 #include "modulemd-translation-entry.h"
 #include "modulemd-translation.h"
@@ -17,6 +17,8 @@
 #include <yaml.h>
 
 #include "modulemd-buildopts.h"
+#include "modulemd-memory-usage.h"
+#include "private/modulemd-compactor.h"
 
 /**
  * SECTION: modulemd-buildopts-private
@@ -78,3 +80,60 @@ modulemd_buildopts_emit_yaml (ModulemdBuildopts *self,
 gint
 modulemd_buildopts_compare (ModulemdBuildopts *self_1,
                             ModulemdBuildopts *self_2);
+
+
+/**
+ * modulemd_buildopts_add_memory_usage:
+ * @self: (in): This #ModulemdBuildopts object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and everything it owns.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_buildopts_add_memory_usage (ModulemdBuildopts *self,
+                                     ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_buildopts_compact:
+ * @self: (in): This #ModulemdBuildopts object.
+ * @compactor: (in): The #ModulemdCompactor holding the canonical sets.
+ *
+ * Replaces the whitelist and the arches of @self with the canonical sets of
+ * @compactor that are equal to them. Each set is copied the next time it is
+ * modified.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_buildopts_compact (ModulemdBuildopts *self,
+                            ModulemdCompactor *compactor);
+
+
+/**
+ * modulemd_buildopts_get_generation:
+ * @self: (in): This #ModulemdBuildopts object.
+ *
+ * Returns: The value of modulemd_next_generation() recorded by the last
+ * setter called on @self, or 0 if none was called.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_buildopts_get_generation (ModulemdBuildopts *self);
+
+
+/**
+ * modulemd_buildopts_freeze:
+ * @self: (in): This #ModulemdBuildopts object.
+ *
+ * Makes every later setter called on @self emit a critical warning and
+ * return without changing it. Called when the stream that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_buildopts_freeze (ModulemdBuildopts *self);
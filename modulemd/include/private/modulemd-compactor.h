@@ -0,0 +1,120 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-compactor
+ * @title: Modulemd Compactor
+ * @stability: Private
+ * @short_description: Sharing of structurally identical data between
+ * module streams.
+ *
+ * Builds of one module stream for several architectures usually carry
+ * identical components, profiles, dependencies and buildopts. A
+ * #ModulemdCompactor keeps one canonical instance of each distinct set of
+ * strings and table of sets it is shown, so that the objects of every stream
+ * can reference it instead of owning an equal copy. It is used by
+ * modulemd_module_index_compact().
+ *
+ * The objects themselves are not shared, so each stream can still be
+ * modified on its own. An object that references a canonical set records
+ * that it is shared and copies it before its first modification.
+ */
+
+
+/**
+ * ModulemdCompactor:
+ *
+ * A content-hashed table of canonical string sets and tables of sets.
+ *
+ * Since: 2.16
+ */
+typedef struct _ModulemdCompactor ModulemdCompactor;
+
+
+/**
+ * modulemd_compactor_new:
+ *
+ * Returns: (transfer full): A newly-allocated, empty #ModulemdCompactor.
+ *
+ * Since: 2.16
+ */
+ModulemdCompactor *
+modulemd_compactor_new (void);
+
+
+/**
+ * modulemd_compactor_free:
+ * @self: (in): This #ModulemdCompactor.
+ *
+ * Frees @self and drops its references to the canonical sets and tables.
+ * They stay alive as long as an object references them.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_compactor_free (ModulemdCompactor *self);
+
+
+/**
+ * modulemd_compactor_share_set:
+ * @self: (in): This #ModulemdCompactor.
+ * @set: (inout): A reference to a #GHashTable set of strings created with
+ * modulemd_str_set_new().
+ *
+ * Replaces *@set with a reference to the canonical set equal to it. If there
+ * is none, *@set becomes the canonical instance of its value.
+ *
+ * Afterwards other objects may reference *@set, so the caller must copy it
+ * before modifying it.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_compactor_share_set (ModulemdCompactor *self, GHashTable **set);
+
+
+/**
+ * modulemd_compactor_share_table:
+ * @self: (in): This #ModulemdCompactor.
+ * @table: (inout): A reference to a #GHashTable mapping interned strings to
+ * #GHashTable sets of strings, such as the tables of #ModulemdDependencies.
+ *
+ * Like modulemd_compactor_share_set(), but for a table of sets.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_compactor_share_table (ModulemdCompactor *self, GHashTable **table);
+
+
+/**
+ * modulemd_compactor_get_n_shared:
+ * @self: (in): This #ModulemdCompactor.
+ *
+ * Returns: The number of sets and tables passed to @self that were equal to
+ * an earlier one, and were therefore replaced by its canonical instance.
+ *
+ * Since: 2.16
+ */
+guint
+modulemd_compactor_get_n_shared (ModulemdCompactor *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ModulemdCompactor, modulemd_compactor_free);
+
+G_END_DECLS
@@ -17,6 +17,8 @@
 #include <yaml.h>
 
 #include "modulemd-component.h"
+#include "modulemd-memory-usage.h"
+#include "private/modulemd-compactor.h"
 
 /**
  * SECTION: modulemd-component-private
@@ -132,3 +134,77 @@ modulemd_component_emit_yaml_build_common (ModulemdComponent *self,
  */
 gboolean
 modulemd_component_equals_wrapper (const void *a, const void *b);
+
+
+/**
+ * modulemd_component_add_memory_usage:
+ * @self: (in): This #ModulemdComponent object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by the #ModulemdComponent part of @self, including
+ * its private data. Subclasses call this from their own add_memory_usage()
+ * function.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_component_add_memory_usage (ModulemdComponent *self,
+                                     ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_component_compact:
+ * @self: (in): This #ModulemdComponent object.
+ * @compactor: (in): The #ModulemdCompactor holding the canonical sets.
+ *
+ * Replaces the buildafter set of @self with the canonical set of @compactor
+ * that is equal to it. The set is copied the next time it is modified.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_component_compact (ModulemdComponent *self,
+                            ModulemdCompactor *compactor);
+
+
+/**
+ * modulemd_component_will_change:
+ * @self: (in): This #ModulemdComponent object.
+ *
+ * Called by the setters of #ModulemdComponent and its subclasses before they
+ * modify @self.
+ *
+ * Returns: FALSE, with a critical warning, if @self is frozen and must not
+ * be changed. Otherwise TRUE, after recording a new generation for @self.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_component_will_change (ModulemdComponent *self);
+
+
+/**
+ * modulemd_component_get_generation:
+ * @self: (in): This #ModulemdComponent object.
+ *
+ * Returns: The value of modulemd_next_generation() recorded by the last
+ * setter called on @self, or 0 if none was called.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_component_get_generation (ModulemdComponent *self);
+
+
+/**
+ * modulemd_component_freeze:
+ * @self: (in): This #ModulemdComponent object.
+ *
+ * Makes every later setter called on @self emit a critical warning and
+ * return without changing it. Called when the stream that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_component_freeze (ModulemdComponent *self);
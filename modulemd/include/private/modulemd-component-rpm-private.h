@@ -17,6 +17,8 @@
 #include <yaml.h>
 
 #include "modulemd-component-rpm.h"
+#include "modulemd-memory-usage.h"
+#include "private/modulemd-compactor.h"
 
 /**
  * SECTION: modulemd-component-rpm-private
@@ -64,3 +66,33 @@ gboolean
 modulemd_component_rpm_emit_yaml (ModulemdComponentRpm *self,
                                   yaml_emitter_t *emitter,
                                   GError **error);
+
+
+/**
+ * modulemd_component_rpm_add_memory_usage:
+ * @self: (in): This #ModulemdComponentRpm object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and everything it owns.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_component_rpm_add_memory_usage (ModulemdComponentRpm *self,
+                                         ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_component_rpm_compact:
+ * @self: (in): This #ModulemdComponentRpm object.
+ * @compactor: (in): The #ModulemdCompactor holding the canonical sets.
+ *
+ * Replaces the sets of @self, including the buildafter set of its
+ * #ModulemdComponent part, with the canonical sets of @compactor that are
+ * equal to them. Each set is copied the next time it is modified.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_component_rpm_compact (ModulemdComponentRpm *self,
+                                ModulemdCompactor *compactor);
@@ -66,6 +66,24 @@ ModulemdCompressionTypeEnum
 modulemd_detect_compression (const gchar *filename, int fd, GError **error);
 
 
+/**
+ * modulemd_detect_compression_from_data:
+ * @buffer: (in) (array length=len): The beginning of the data to inspect.
+ * @len: (in): The number of bytes available in @buffer.
+ *
+ * Detects the compression type from the magic bytes at the start of
+ * @buffer. Six bytes are enough to recognize all supported formats.
+ *
+ * Returns: The #ModulemdCompressionTypeEnum detected from @buffer.
+ * #MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION if no known magic bytes were
+ * found.
+ *
+ * Since: 2.16
+ */
+ModulemdCompressionTypeEnum
+modulemd_detect_compression_from_data (const guint8 *buffer, gsize len);
+
+
 /**
  * modulemd_compression_suffix:
  * @comtype: (in): A #ModulemdCompressionTypeEnum.
@@ -111,3 +129,126 @@ compressed_stream_read_fn (void *data,
                            unsigned char *buffer,
                            size_t size,
                            size_t *size_read);
+
+
+/**
+ * ModulemdDecompressor:
+ *
+ * A #ModulemdDecompressor decompresses a compressed input with one of the
+ * natively supported compression libraries on a dedicated thread. The
+ * decompressed data is passed to the reading thread through a bounded ring
+ * of buffers, so decompression and YAML parsing run concurrently and memory
+ * use does not depend on the size of the input.
+ *
+ * Since: 2.16
+ */
+typedef struct _ModulemdDecompressor ModulemdDecompressor;
+
+
+/**
+ * modulemd_decompressor_supported:
+ * @comtype: (in): A #ModulemdCompressionTypeEnum.
+ *
+ * Returns: TRUE if libmodulemd was built with a native decompression backend
+ * for @comtype.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_decompressor_supported (ModulemdCompressionTypeEnum comtype);
+
+
+/**
+ * modulemd_decompressor_new_for_fd:
+ * @comtype: (in): The #ModulemdCompressionTypeEnum of the data in @fd.
+ * @fd: (in): An open file descriptor positioned at the start of the
+ * compressed data. It is not closed by the decompressor and must remain open
+ * until modulemd_decompressor_free() is called.
+ * @error: (out): A #GError containing the reason this function failed.
+ *
+ * Starts decompressing the content of @fd on a separate thread.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdDecompressor. NULL and
+ * sets @error to #MMD_ERROR_NOT_IMPLEMENTED if there is no native backend for
+ * @comtype or to another error if the backend could not be initialized.
+ *
+ * Since: 2.16
+ */
+ModulemdDecompressor *
+modulemd_decompressor_new_for_fd (ModulemdCompressionTypeEnum comtype,
+                                  int fd,
+                                  GError **error);
+
+
+/**
+ * modulemd_decompressor_new_for_bytes:
+ * @comtype: (in): The #ModulemdCompressionTypeEnum of the data in @bytes.
+ * @bytes: (in): The compressed data. A reference to it is kept until
+ * modulemd_decompressor_free() is called; the data is not copied.
+ * @error: (out): A #GError containing the reason this function failed.
+ *
+ * Starts decompressing @bytes on a separate thread.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdDecompressor. NULL and
+ * sets @error under the same conditions as
+ * modulemd_decompressor_new_for_fd().
+ *
+ * Since: 2.16
+ */
+ModulemdDecompressor *
+modulemd_decompressor_new_for_bytes (ModulemdCompressionTypeEnum comtype,
+                                     GBytes *bytes,
+                                     GError **error);
+
+
+/**
+ * modulemd_decompressor_read_fn:
+ * @data: (inout): A #ModulemdDecompressor.
+ * @buffer: (out): The buffer to write the decompressed data to.
+ * @size: (in): The size of the buffer.
+ * @size_read: (out): The actual number of bytes written to @buffer. Zero at
+ * the end of the data.
+ *
+ * A #ModulemdReadHandler that returns the output of a #ModulemdDecompressor.
+ * It fails if the compressed data is corrupted or truncated, the reason can
+ * be retrieved with modulemd_decompressor_close().
+ *
+ * Since: 2.16
+ */
+gint
+modulemd_decompressor_read_fn (void *data,
+                               unsigned char *buffer,
+                               size_t size,
+                               size_t *size_read);
+
+
+/**
+ * modulemd_decompressor_close:
+ * @self: (in): This #ModulemdDecompressor.
+ * @error: (out): A #GError containing the reason decompression failed.
+ *
+ * Stops decompression, discarding any data that has not been read yet, and
+ * waits for the decompression thread to finish.
+ *
+ * Returns: TRUE if no decompression error occurred. FALSE and sets @error
+ * appropriately otherwise.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_decompressor_close (ModulemdDecompressor *self, GError **error);
+
+
+/**
+ * modulemd_decompressor_free:
+ * @self: (in): This #ModulemdDecompressor.
+ *
+ * Closes @self if that was not done yet and frees it.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_decompressor_free (ModulemdDecompressor *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ModulemdDecompressor,
+                               modulemd_decompressor_free);
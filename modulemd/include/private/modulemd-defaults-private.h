@@ -15,6 +15,8 @@
 
 #include <glib-object.h>
 
+#include "modulemd-memory-usage.h"
+
 G_BEGIN_DECLS
 
 
@@ -66,4 +68,50 @@ modulemd_defaults_merge (ModulemdDefaults *from,
                          gboolean strict_default_streams,
                          GError **error);
 
+
+/**
+ * modulemd_defaults_add_memory_usage:
+ * @self: (in): This #ModulemdDefaults object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by the #ModulemdDefaults part of @self, including
+ * its private data. Subclasses call this from their own add_memory_usage()
+ * function.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_defaults_add_memory_usage (ModulemdDefaults *self,
+                                    ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_defaults_will_change:
+ * @self: (in): This #ModulemdDefaults object.
+ *
+ * Called by the setters of #ModulemdDefaults and its subclasses before they
+ * modify @self.
+ *
+ * Returns: FALSE, with a critical warning, if @self is frozen and must not
+ * be changed. Otherwise TRUE.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_defaults_will_change (ModulemdDefaults *self);
+
+
+/**
+ * modulemd_defaults_freeze:
+ * @self: (in): This #ModulemdDefaults object.
+ *
+ * Makes every later setter called on @self emit a critical warning and
+ * return without changing it. Called when the #ModulemdModule that owns
+ * @self is frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_defaults_freeze (ModulemdDefaults *self);
+
 G_END_DECLS
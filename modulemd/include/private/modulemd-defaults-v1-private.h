@@ -14,6 +14,7 @@
 #pragma once
 
 #include "modulemd-defaults-v1.h"
+#include "modulemd-memory-usage.h"
 #include "modulemd-subdocument-info.h"
 #include <glib-object.h>
 #include <yaml.h>
@@ -96,4 +97,32 @@ modulemd_defaults_v1_merge (ModulemdDefaultsV1 *from,
                             gboolean strict_default_streams,
                             GError **error);
 
+
+/**
+ * modulemd_defaults_v1_collect_intents:
+ * @self: (in): This #ModulemdDefaultsV1 object.
+ * @intents: (in) (out) (element-type utf8 utf8): A set to which the names of
+ * all system intents for which @self sets a default stream are added. The
+ * names are owned by @self.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_defaults_v1_collect_intents (ModulemdDefaultsV1 *self,
+                                      GHashTable *intents);
+
+
+/**
+ * modulemd_defaults_v1_add_memory_usage:
+ * @self: (in): This #ModulemdDefaultsV1 object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and all of its tables of defaults.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_defaults_v1_add_memory_usage (ModulemdDefaultsV1 *self,
+                                       ModulemdMemoryUsage *usage);
+
 G_END_DECLS
@@ -17,6 +17,8 @@
 #include <yaml.h>
 
 #include "modulemd-dependencies.h"
+#include "modulemd-memory-usage.h"
+#include "private/modulemd-compactor.h"
 
 /**
  * SECTION: modulemd-dependencies-private
@@ -120,3 +122,60 @@ modulemd_dependencies_buildrequires_module_and_stream (
   ModulemdDependencies *self,
   const gchar *module_name,
   const gchar *stream_name);
+
+
+/**
+ * modulemd_dependencies_add_memory_usage:
+ * @self: (in): This #ModulemdDependencies object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and its tables of dependencies.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_dependencies_add_memory_usage (ModulemdDependencies *self,
+                                        ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_dependencies_compact:
+ * @self: (in): This #ModulemdDependencies object.
+ * @compactor: (in): The #ModulemdCompactor holding the canonical tables.
+ *
+ * Replaces the buildtime and runtime tables of @self with the canonical
+ * tables of @compactor that are equal to them. Each table is copied the next
+ * time it is modified.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_dependencies_compact (ModulemdDependencies *self,
+                               ModulemdCompactor *compactor);
+
+
+/**
+ * modulemd_dependencies_get_generation:
+ * @self: (in): This #ModulemdDependencies object.
+ *
+ * Returns: The value of modulemd_next_generation() recorded by the last
+ * setter called on @self, or 0 if none was called.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_dependencies_get_generation (ModulemdDependencies *self);
+
+
+/**
+ * modulemd_dependencies_freeze:
+ * @self: (in): This #ModulemdDependencies object.
+ *
+ * Makes every later setter called on @self emit a critical warning and
+ * return without changing it. Called when the stream that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_dependencies_freeze (ModulemdDependencies *self);
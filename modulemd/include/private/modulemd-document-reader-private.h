@@ -0,0 +1,78 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-document-reader.h"
+#include "modulemd-subdocument-info.h"
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-document-reader-private
+ * @title: Modulemd.DocumentReader (Private)
+ * @stability: Private
+ * @short_description: #ModulemdDocumentReader methods that should be used
+ * only by internal consumers.
+ */
+
+
+/**
+ * modulemd_document_reader_parse_subdoc:
+ * @subdoc: (in): A #ModulemdSubdocumentInfo whose document type was read
+ * successfully.
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ * @autogen_id: (in): If non-zero, a module stream without a module name or
+ * stream name gets one generated from this identifier. This option should be
+ * used only for validation tools such as modulemd-validator.
+ * @error: (out): A #GError containing the reason the subdocument could not
+ * be parsed.
+ *
+ * Parses and validates the object described by @subdoc. This is shared by
+ * #ModulemdDocumentReader and #ModulemdModuleIndex so that both accept
+ * exactly the same documents.
+ *
+ * Returns: (transfer full): A validated #ModulemdModuleStream,
+ * #ModulemdDefaults, #ModulemdTranslation or #ModulemdObsoletes. NULL and
+ * sets @error appropriately if the subdocument is invalid or of a type that
+ * cannot appear in a module index, such as modulemd-packager.
+ *
+ * Since: 2.16
+ */
+GObject *
+modulemd_document_reader_parse_subdoc (ModulemdSubdocumentInfo *subdoc,
+                                       gboolean strict,
+                                       guint autogen_id,
+                                       GError **error);
+
+
+/**
+ * modulemd_document_reader_time_validation:
+ * @elapsed: (in) (nullable): Where to add the time, in microseconds, that
+ * modulemd_document_reader_parse_subdoc() spends validating the objects it
+ * has parsed on the calling thread, or NULL to stop timing it.
+ *
+ * Lets tools such as modulemd-validator tell the time spent parsing from the
+ * time spent validating, even when the documents are loaded into a
+ * #ModulemdModuleIndex. Only the calling thread is affected, so several
+ * threads can time their own loads at the same time.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_document_reader_time_validation (gint64 *elapsed);
+
+G_END_DECLS
@@ -0,0 +1,214 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <yaml.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-json
+ * @title: Modulemd JSON
+ * @stability: Private
+ * @short_description: JSON and CBOR output for the YAML emitters.
+ *
+ * All objects are written by emitting libyaml events through
+ * mmd_emitter_emit(). An emitter whose output is set with
+ * mmd_emitter_set_output_json() hands those events to a
+ * #modulemd_json_writer instead of libyaml, which writes each YAML node as
+ * the equivalent JSON value. Every YAML document becomes an element of a
+ * single top-level array.
+ *
+ * Scalars emitted with mmd_emitter_scalar_uint64(),
+ * mmd_emitter_scalar_int64() or mmd_emitter_scalar_boolean() are written as
+ * numbers or booleans. They are recognised by the tag of their event, as
+ * text such as a context of `8e000000` may look like a number without being
+ * one. Every other scalar, including every mapping key, is a string.
+ *
+ * CBOR output follows the same data model, as described by section 6.2 of
+ * RFC 8949, using indefinite-length arrays and maps so that it can be written
+ * in a single pass.
+ */
+
+
+/**
+ * ModulemdJsonFormatEnum:
+ * @MODULEMD_JSON_FORMAT_TEXT: UTF-8 encoded JSON text.
+ * @MODULEMD_JSON_FORMAT_CBOR: CBOR, as defined by RFC 8949.
+ *
+ * Since: 2.16
+ */
+typedef enum
+{
+  MODULEMD_JSON_FORMAT_TEXT,
+  MODULEMD_JSON_FORMAT_CBOR
+} ModulemdJsonFormatEnum;
+
+
+/**
+ * modulemd_json_writer:
+ *
+ * The output buffer and nesting state of a JSON or CBOR document that is
+ * being written.
+ *
+ * Since: 2.16
+ */
+typedef struct _modulemd_json_writer modulemd_json_writer;
+
+
+/**
+ * modulemd_json_writer_new:
+ * @format: (in): The #ModulemdJsonFormatEnum to write.
+ *
+ * Returns: (transfer full): A new #modulemd_json_writer with an empty output
+ * buffer.
+ *
+ * Since: 2.16
+ */
+modulemd_json_writer *
+modulemd_json_writer_new (ModulemdJsonFormatEnum format);
+
+
+/**
+ * modulemd_json_writer_free:
+ * @self: (in): This #modulemd_json_writer.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_json_writer_free (modulemd_json_writer *self);
+
+
+/**
+ * modulemd_json_writer_steal_string:
+ * @self: (in): This #modulemd_json_writer, which must write
+ * %MODULEMD_JSON_FORMAT_TEXT.
+ *
+ * Returns: (transfer full): The nul-terminated output written to @self.
+ * Nothing may be written to @self afterwards.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_json_writer_steal_string (modulemd_json_writer *self);
+
+
+/**
+ * modulemd_json_writer_steal_bytes:
+ * @self: (in): This #modulemd_json_writer.
+ *
+ * Returns: (transfer full): The output written to @self. Nothing may be
+ * written to @self afterwards.
+ *
+ * Since: 2.16
+ */
+GBytes *
+modulemd_json_writer_steal_bytes (modulemd_json_writer *self);
+
+
+/**
+ * mmd_emitter_set_output_json:
+ * @emitter: (inout): A libyaml emitter that has no output yet.
+ * @writer: (in): The #modulemd_json_writer that the events emitted through
+ * @emitter are written to. It must outlive @emitter.
+ *
+ * Since: 2.16
+ */
+void
+mmd_emitter_set_output_json (yaml_emitter_t *emitter,
+                             modulemd_json_writer *writer);
+
+
+/**
+ * mmd_emitter_is_json:
+ * @emitter: (in): A libyaml emitter.
+ *
+ * Code that writes to the output of an emitter directly, rather than through
+ * events, must check this first.
+ *
+ * Returns: TRUE if the output of @emitter was set with
+ * mmd_emitter_set_output_json().
+ *
+ * Since: 2.16
+ */
+gboolean
+mmd_emitter_is_json (yaml_emitter_t *emitter);
+
+
+/**
+ * mmd_json_emit:
+ * @emitter: (inout): A libyaml emitter for which mmd_emitter_is_json()
+ * returns TRUE.
+ * @event: (inout): The libyaml event to write. It is consumed and reset,
+ * whether or not this succeeds, like yaml_emitter_emit() does.
+ *
+ * Returns: 1 if @event was written. 0 if @event cannot be represented in
+ * JSON, such as an alias or a mapping key that is not a scalar, or does not
+ * belong at the current position.
+ *
+ * Since: 2.16
+ */
+int
+mmd_json_emit (yaml_emitter_t *emitter, yaml_event_t *event);
+
+
+/**
+ * modulemd_cbor_to_json:
+ * @data: (in) (array length=len): A CBOR data item.
+ * @len: (in): The length of @data in bytes.
+ * @error: (out): A #GError containing the reason @data could not be
+ * converted.
+ *
+ * Converts @data to JSON text, following section 6.1 of RFC 8949. Tags are
+ * ignored. Byte strings, map keys other than text strings, undefined and
+ * non-finite floating point values have no JSON equivalent and are rejected.
+ *
+ * Returns: (transfer full): The nul-terminated JSON text of @data, or NULL
+ * if @data is not a single well-formed CBOR data item that can be converted.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_cbor_to_json (const guint8 *data, gsize len, GError **error);
+
+
+
+/**
+ * modulemd_json_decode_surrogates:
+ * @json: (in): Nul-terminated JSON text.
+ * @decoded: (out) (transfer full): A copy of @json in which each `\u` escaped
+ * UTF-16 surrogate pair is replaced by the UTF-8 encoding of its character,
+ * or NULL if @json contains no such escapes.
+ * @error: (out): A #GError containing the reason @json could not be decoded.
+ *
+ * JSON is read with libyaml, which rejects escaped surrogates. JSON writers
+ * use them for every character outside the Basic Multilingual Plane, and
+ * some, such as Python's json.dumps(), escape all non-ASCII characters by
+ * default.
+ *
+ * Returns: TRUE on success. FALSE if @json contains a surrogate that is not
+ * part of a pair, which has no UTF-8 encoding.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_json_decode_surrogates (const gchar *json,
+                                 gchar **decoded,
+                                 GError **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (modulemd_json_writer,
+                               modulemd_json_writer_free);
+
+G_END_DECLS
@@ -0,0 +1,251 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-memory-usage.h"
+
+/**
+ * SECTION: modulemd-memory-usage-private
+ * @title: Modulemd.MemoryUsage (Private)
+ * @stability: Private
+ * @short_description: #ModulemdMemoryUsage methods that should be used only
+ * by internal consumers.
+ *
+ * Each object type of the library has an add_memory_usage() function that
+ * records the memory it owns with the functions below. Memory is recorded
+ * against the module set with modulemd_memory_usage_set_module() and in the
+ * category passed to modulemd_memory_usage_add(), unless a section has been
+ * pushed with modulemd_memory_usage_push_section(), in which case everything
+ * is recorded in the category of the innermost section.
+ */
+
+
+/**
+ * modulemd_memory_usage_new:
+ *
+ * Returns: (transfer full): A newly-allocated, empty #ModulemdMemoryUsage.
+ *
+ * Since: 2.16
+ */
+ModulemdMemoryUsage *
+modulemd_memory_usage_new (void);
+
+
+/**
+ * modulemd_memory_usage_set_module:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @module_name: (in) (nullable): The module that memory recorded from now on
+ * belongs to, or NULL for the index itself.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_set_module (ModulemdMemoryUsage *self,
+                                  const gchar *module_name);
+
+
+/**
+ * modulemd_memory_usage_push_section:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @category: (in): The #ModulemdMemoryCategoryEnum that all memory recorded
+ * until the matching modulemd_memory_usage_pop_section() is counted in.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_push_section (ModulemdMemoryUsage *self,
+                                    ModulemdMemoryCategoryEnum category);
+
+
+/**
+ * modulemd_memory_usage_pop_section:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ *
+ * Ends the innermost section started with
+ * modulemd_memory_usage_push_section().
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_pop_section (ModulemdMemoryUsage *self);
+
+
+/**
+ * modulemd_memory_usage_add:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @category: (in): The #ModulemdMemoryCategoryEnum that @size belongs to
+ * outside of a section.
+ * @size: (in): A number of bytes.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add (ModulemdMemoryUsage *self,
+                           ModulemdMemoryCategoryEnum category,
+                           gsize size);
+
+
+/**
+ * modulemd_memory_usage_add_string:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @str: (in) (nullable): A string owned by the object being measured.
+ *
+ * Records the size of @str, including its terminating nul byte.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_string (ModulemdMemoryUsage *self,
+                                  const gchar *str);
+
+
+/**
+ * modulemd_memory_usage_claim:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @data: (in) (nullable): An object or table that may be shared between
+ * several objects of the index.
+ *
+ * Objects that share @data call this before recording it, and only record it
+ * if this returns TRUE, so that it is counted once.
+ *
+ * Returns: TRUE the first time @data is passed to @self, FALSE afterwards and
+ * if @data is NULL.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_memory_usage_claim (ModulemdMemoryUsage *self, gconstpointer data);
+
+
+/**
+ * modulemd_memory_usage_add_interned_string:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @str: (in) (nullable): A string returned by modulemd_str_intern().
+ *
+ * Records the size of @str the first time it is seen by @self. Interned
+ * strings are shared by every object holding an equal value, so they are
+ * counted in the module that is measured first.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_interned_string (ModulemdMemoryUsage *self,
+                                           const gchar *str);
+
+
+/**
+ * modulemd_memory_usage_add_object:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @object: (in) (type GObject): A #GObject owned by the object being
+ * measured.
+ *
+ * Records the size of the instance structure of @object. GLib does not
+ * report the size of the private data of a class, so classes with private
+ * data add it themselves. The memory that the fields of @object point to is
+ * not included.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_object (ModulemdMemoryUsage *self,
+                                  gpointer object);
+
+
+/**
+ * modulemd_memory_usage_add_hash_table:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @table: (in) (nullable): A #GHashTable owned by the object being measured.
+ *
+ * Records the size of the storage of @table, but not of its keys or values.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_hash_table (ModulemdMemoryUsage *self,
+                                      GHashTable *table);
+
+
+/**
+ * modulemd_memory_usage_add_string_set:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @set: (in) (nullable): A #GHashTable set of strings.
+ *
+ * Records the storage of @set and its strings, which must have been interned
+ * with modulemd_str_intern().
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_string_set (ModulemdMemoryUsage *self,
+                                      GHashTable *set);
+
+
+/**
+ * modulemd_memory_usage_add_string_map:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @map: (in) (nullable): A #GHashTable of strings to strings.
+ *
+ * Records the storage of @map, its keys and its values.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_string_map (ModulemdMemoryUsage *self,
+                                      GHashTable *map);
+
+
+/**
+ * modulemd_memory_usage_add_nested_set:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @table: (in) (nullable): A #GHashTable of strings to #GHashTable sets of
+ * strings.
+ *
+ * Records the storage of @table, its keys and each of its sets.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_nested_set (ModulemdMemoryUsage *self,
+                                      GHashTable *table);
+
+
+/**
+ * modulemd_memory_usage_add_ptr_array:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @array: (in) (nullable): A #GPtrArray owned by the object being measured.
+ *
+ * Records the size of the storage of @array, but not of its elements.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_ptr_array (ModulemdMemoryUsage *self,
+                                     GPtrArray *array);
+
+
+/**
+ * modulemd_memory_usage_add_variant:
+ * @self: (in): This #ModulemdMemoryUsage object.
+ * @variant: (in) (nullable): A #GVariant owned by the object being measured.
+ *
+ * Records the size of @variant in %MD_MEMORY_CATEGORY_XMD, unless a section
+ * is active.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_memory_usage_add_variant (ModulemdMemoryUsage *self,
+                                   GVariant *variant);
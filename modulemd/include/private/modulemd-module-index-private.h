@@ -121,4 +121,50 @@ modulemd_module_index_merge (ModulemdModuleIndex *from,
                              gboolean strict_default_streams,
                              GError **error);
 
+
+/**
+ * modulemd_module_index_dup_digest:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @object: (in): A stream, defaults, translation or obsoletes object of
+ * @self.
+ *
+ * Returns: (transfer full) (nullable): The content digest of @object
+ * remembered by modulemd_module_index_get_object_digests(), or NULL if there
+ * is none. The digest of a stream is kept until the stream or an object
+ * stored in it is modified; those of other objects are only kept by frozen
+ * indexes. This function is thread-safe.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_module_index_dup_digest (ModulemdModuleIndex *self,
+                                  gpointer object);
+
+
+/**
+ * modulemd_module_index_get_object_digests:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @objects: (in) (element-type GObject): Stream, defaults, translation or
+ * obsoletes objects of @self.
+ * @error: (out): A #GError containing the reason a digest could not be
+ * computed.
+ *
+ * Computes the SHA-256 digest of the YAML representation of each of
+ * @objects. The emitter output is canonical, so two objects have the same
+ * digest exactly when they would be written out the same way. Large batches
+ * are computed in parallel. The digests are remembered as described for
+ * modulemd_module_index_dup_digest(), and later calls return them without
+ * computing them again. This function is thread-safe for frozen indexes.
+ *
+ * Returns: (transfer full) (element-type utf8): The hexadecimal digests
+ * in the same order as @objects. NULL and sets @error if an object could not
+ * be serialized.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_index_get_object_digests (ModulemdModuleIndex *self,
+                                          GPtrArray *objects,
+                                          GError **error);
+
 G_END_DECLS
@@ -16,6 +16,7 @@
 #include <glib-object.h>
 #include <yaml.h>
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-module.h"
 #include "modulemd-translation.h"
 #include "modulemd-obsoletes.h"
@@ -159,6 +160,38 @@ modulemd_module_add_stream (ModulemdModule *self,
                             GError **error);
 
 
+/**
+ * modulemd_module_get_sorted_streams:
+ * @self: This #ModulemdModule object.
+ *
+ * Returns: (transfer none) (element-type ModulemdModuleStream): The streams
+ * of @self sorted by stream name, version (highest first), context and
+ * architecture. The array is cached on @self and is only valid until the next
+ * time streams are added to or removed from it. It is sorted again when one
+ * of the streams has been modified since, unless @self is frozen.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_module_get_sorted_streams (ModulemdModule *self);
+
+
+/**
+ * modulemd_module_collect_streams_by_query:
+ * @self: This #ModulemdModule object.
+ * @query: (in): A #ModulemdStreamQuery describing the streams to retrieve.
+ * @matches: (in) (out) (element-type ModulemdModuleStream): An array to which
+ * every stream of @self that matches @query will be appended, in the order
+ * they are stored in @self.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_collect_streams_by_query (ModulemdModule *self,
+                                          ModulemdStreamQuery *query,
+                                          GPtrArray *matches);
+
+
 /**
  * modulemd_module_upgrade_streams:
  * @self: This #ModulemdModule object.
@@ -175,4 +208,47 @@ modulemd_module_upgrade_streams (ModulemdModule *self,
                                  ModulemdModuleStreamVersionEnum mdversion,
                                  GError **error);
 
+
+/**
+ * modulemd_module_freeze:
+ * @self: This #ModulemdModule object.
+ *
+ * Builds the sorted stream list of @self and freezes it along with its
+ * streams, defaults, translations and obsoletes. Afterwards no read function
+ * modifies any of them, so they can be queried from several threads at once,
+ * and every function that would modify them emits a critical warning and
+ * returns without doing so.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_freeze (ModulemdModule *self);
+
+
+/**
+ * modulemd_module_is_frozen:
+ * @self: This #ModulemdModule object.
+ *
+ * Returns: TRUE if modulemd_module_freeze() was called on @self.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_is_frozen (ModulemdModule *self);
+
+
+/**
+ * modulemd_module_add_memory_usage:
+ * @self: (in): This #ModulemdModule object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and all of the streams, defaults,
+ * translations and obsoletes it owns.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_add_memory_usage (ModulemdModule *self,
+                                  ModulemdMemoryUsage *usage);
+
 G_END_DECLS
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-module-index.h"
 #include "modulemd-module-stream.h"
 #include "modulemd-translation-entry.h"
@@ -56,6 +57,62 @@ void
 modulemd_module_stream_set_stream_name (ModulemdModuleStream *self,
                                         const gchar *stream_name);
 
+/**
+ * modulemd_module_stream_take_module_name:
+ * @self: (in): This #ModulemdModuleStream object.
+ * @module_name: (in) (transfer full) (nullable): The module name this object
+ * represents.
+ *
+ * Like modulemd_module_stream_set_module_name(), but takes ownership of
+ * @module_name and neither checks @self nor emits a notification. It is meant
+ * for parsers and copy functions filling in a stream that has not been
+ * returned to the caller yet.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_take_module_name (ModulemdModuleStream *self,
+                                         gchar *module_name);
+
+/**
+ * modulemd_module_stream_take_stream_name:
+ * @self: (in): This #ModulemdModuleStream object.
+ * @stream_name: (in) (transfer full) (nullable): The stream name this object
+ * represents.
+ *
+ * The stream name counterpart of modulemd_module_stream_take_module_name().
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_take_stream_name (ModulemdModuleStream *self,
+                                         gchar *stream_name);
+
+/**
+ * modulemd_module_stream_take_context:
+ * @self: (in): This #ModulemdModuleStream object.
+ * @context: (in) (transfer full) (nullable): The context of this stream.
+ *
+ * The context counterpart of modulemd_module_stream_take_module_name().
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_take_context (ModulemdModuleStream *self,
+                                     gchar *context);
+
+/**
+ * modulemd_module_stream_take_arch:
+ * @self: (in): This #ModulemdModuleStream object.
+ * @arch: (in) (transfer full) (nullable): The module artifact architecture.
+ *
+ * The architecture counterpart of modulemd_module_stream_take_module_name().
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_take_arch (ModulemdModuleStream *self, gchar *arch);
+
 /**
  * modulemd_module_stream_associate_translation:
  * @self: (in): This #ModulemdModuleStream object.
@@ -466,4 +523,154 @@ ModulemdModuleStream *
 modulemd_module_stream_upgrade_v1_to_v2 (ModulemdModuleStream *from);
 
 
+/**
+ * modulemd_module_stream_will_change:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Called by every function that modifies a stream before it does so.
+ *
+ * Returns: FALSE, with a critical warning, if @self is frozen and must not
+ * be modified. Otherwise records a new generation for @self, which also
+ * forgets that @self was validated, and returns TRUE.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_stream_will_change (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_freeze:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Makes @self and the objects stored in it, such as its components and
+ * profiles, immutable. Their setters emit a critical warning and do nothing
+ * afterwards, so that a frozen #ModulemdModuleIndex can be read by several
+ * threads at once. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_freeze (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_is_frozen:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Returns: TRUE if modulemd_module_stream_freeze() was called on @self.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_stream_is_frozen (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_get_own_generation:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Returns: The value of modulemd_next_generation() recorded by the last call
+ * of modulemd_module_stream_will_change() on @self. It does not change
+ * when only the objects stored in @self are modified, so it is cheaper to
+ * check than modulemd_module_stream_get_generation() for anything derived
+ * from the fields of @self alone, such as its NSVCA.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_module_stream_get_own_generation (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_get_generation:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Returns: The largest generation recorded by @self and the components,
+ * profiles and other objects stored in it. It grows whenever any of them is
+ * modified, so callers caching anything derived from @self can tell whether
+ * it changed since by comparing it against the value they cached it with.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_module_stream_get_generation (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_dup_digest:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Returns: (transfer full) (nullable): The content digest stored with
+ * modulemd_module_stream_set_digest(), or NULL if none was stored or @self
+ * or an object stored in it was modified since. This function is
+ * thread-safe.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_module_stream_dup_digest (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_set_digest:
+ * @self: (in): This #ModulemdModuleStream object.
+ * @digest: (in): The content digest of @self in its current state.
+ *
+ * Remembers @digest until @self or an object stored in it is modified.
+ * Unlike other caches of a stream, this may be filled in on the streams of a
+ * frozen #ModulemdModuleIndex, since it is thread-safe.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_set_digest (ModulemdModuleStream *self,
+                                   const gchar *digest);
+
+
+/**
+ * modulemd_module_stream_mark_validated:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Records that @self passed modulemd_module_stream_validate() in its current
+ * state, so that it does not need to be validated again until it is modified.
+ * This must not be called on the streams of a frozen #ModulemdModuleIndex,
+ * which may be read by several threads at once.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_mark_validated (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_is_validated:
+ * @self: (in): This #ModulemdModuleStream object.
+ *
+ * Returns: TRUE if modulemd_module_stream_mark_validated() was called on
+ * @self and neither its setters nor those of the objects stored in it have
+ * been called since.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_module_stream_is_validated (ModulemdModuleStream *self);
+
+
+/**
+ * modulemd_module_stream_add_memory_usage:
+ * @self: (in): This #ModulemdModuleStream object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by the #ModulemdModuleStream part of @self,
+ * including its private data. Subclasses call this from their own
+ * add_memory_usage() function. The translation associated with @self is
+ * owned by its #ModulemdModule and is not included.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_add_memory_usage (ModulemdModuleStream *self,
+                                         ModulemdMemoryUsage *usage);
+
 G_END_DECLS
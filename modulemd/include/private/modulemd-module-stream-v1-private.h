@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-module-stream-v1.h"
 #include "modulemd-subdocument-info.h"
 #include <glib-object.h>
@@ -122,4 +123,43 @@ modulemd_module_stream_v1_includes_nevra (ModulemdModuleStreamV1 *self,
                                           const gchar *nevra_pattern);
 
 
+/**
+ * modulemd_module_stream_v1_add_memory_usage:
+ * @self: (in): This #ModulemdModuleStreamV1 object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and everything it owns. Its rpm artifacts
+ * are recorded in %MD_MEMORY_CATEGORY_ARTIFACTS.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_v1_add_memory_usage (ModulemdModuleStreamV1 *self,
+                                            ModulemdMemoryUsage *usage);
+
+/**
+ * modulemd_module_stream_v1_get_objects_generation:
+ * @self: (in): This #ModulemdModuleStreamV1 object.
+ *
+ * Returns: The highest generation recorded by the buildopts, components,
+ * profiles and service levels of @self, or 0 if none of them was modified.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_module_stream_v1_get_objects_generation (ModulemdModuleStreamV1 *self);
+
+
+/**
+ * modulemd_module_stream_v1_freeze_objects:
+ * @self: (in): This #ModulemdModuleStreamV1 object.
+ *
+ * Freezes the buildopts, components, profiles and service levels of @self.
+ * Called by modulemd_module_stream_freeze().
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_v1_freeze_objects (ModulemdModuleStreamV1 *self);
+
 G_END_DECLS
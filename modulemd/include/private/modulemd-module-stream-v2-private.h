@@ -13,9 +13,11 @@
 
 #pragma once
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-module-stream.h"
 #include "modulemd-module-stream-v2.h"
 #include "modulemd-subdocument-info.h"
+#include "private/modulemd-compactor.h"
 #include <glib-object.h>
 #include <yaml.h>
 
@@ -276,4 +278,64 @@ ModulemdObsoletes *
 modulemd_module_stream_v2_get_obsoletes (ModulemdModuleStreamV2 *self);
 
 
+/**
+ * modulemd_module_stream_v2_add_memory_usage:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and everything it owns. Its rpm artifacts
+ * and rpm map are recorded in %MD_MEMORY_CATEGORY_ARTIFACTS. The obsoletes
+ * associated with @self are owned by its #ModulemdModule and are not
+ * included.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_v2_add_memory_usage (ModulemdModuleStreamV2 *self,
+                                            ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_module_stream_v2_get_objects_generation:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ *
+ * Returns: The highest generation recorded by the buildopts, components,
+ * profiles, service levels, dependencies and rpm map entries of @self, or 0
+ * if none of them was modified.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_module_stream_v2_get_objects_generation (ModulemdModuleStreamV2 *self);
+
+
+/**
+ * modulemd_module_stream_v2_compact:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @compactor: (in): The #ModulemdCompactor holding the canonical sets.
+ *
+ * Replaces the sets and tables of the buildopts, components, dependencies
+ * and profiles of @self with the canonical ones of @compactor that are equal
+ * to them. Each object copies them again before it is first modified, so
+ * @self may still be changed.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_v2_compact (ModulemdModuleStreamV2 *self,
+                                   ModulemdCompactor *compactor);
+
+
+/**
+ * modulemd_module_stream_v2_freeze_objects:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ *
+ * Freezes the buildopts, components, profiles, service levels, dependencies
+ * and rpm map entries of @self. Called by modulemd_module_stream_freeze().
+ *
+ * Since: 2.16
+ */
+void
+modulemd_module_stream_v2_freeze_objects (ModulemdModuleStreamV2 *self);
+
 G_END_DECLS
@@ -15,6 +15,7 @@
 
 #include <glib-object.h>
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-obsoletes.h"
 #include "modulemd-subdocument-info.h"
 
@@ -135,4 +136,31 @@ modulemd_obsoletes_emit_yaml (ModulemdObsoletes *self,
                               GError **error);
 
 
+/**
+ * modulemd_obsoletes_add_memory_usage:
+ * @self: (in): This #ModulemdObsoletes object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and its strings.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_obsoletes_add_memory_usage (ModulemdObsoletes *self,
+                                     ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_obsoletes_freeze:
+ * @self: (in): This #ModulemdObsoletes object.
+ *
+ * Makes every later setter called on @self emit a critical warning and return
+ * without changing it. Called when the #ModulemdModule that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_obsoletes_freeze (ModulemdObsoletes *self);
+
 G_END_DECLS
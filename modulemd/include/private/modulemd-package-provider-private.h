@@ -0,0 +1,46 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-module-stream.h"
+#include "modulemd-package-provider.h"
+
+/**
+ * SECTION: modulemd-package-provider-private
+ * @title: Modulemd.PackageProvider (Private)
+ * @stability: Private
+ * @short_description: #ModulemdPackageProvider methods that should be used
+ * only by internal consumers.
+ */
+
+
+/**
+ * modulemd_package_provider_new:
+ * @stream: (in): The #ModulemdModuleStream that provides the package.
+ * @source: (in): A single #ModulemdPackageSourceFlags value telling where in
+ * @stream the package was found.
+ * @profile_name: (in) (nullable): The name of the profile that lists the
+ * package. Must be set if and only if @source is %MD_PACKAGE_SOURCE_PROFILE.
+ *
+ * Returns: (transfer full): A newly-allocated #ModulemdPackageProvider
+ * holding a reference to @stream.
+ *
+ * Since: 2.16
+ */
+ModulemdPackageProvider *
+modulemd_package_provider_new (ModulemdModuleStream *stream,
+                               ModulemdPackageSourceFlags source,
+                               const gchar *profile_name);
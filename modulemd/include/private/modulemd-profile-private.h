@@ -16,8 +16,10 @@
 #include <glib-object.h>
 #include <yaml.h>
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-module-stream.h"
 #include "modulemd-profile.h"
+#include "private/modulemd-compactor.h"
 
 /**
  * SECTION: modulemd-profile-private
@@ -84,11 +86,94 @@ modulemd_profile_equals_wrapper (const void *a, const void *b);
 /**
  * modulemd_profile_set_owner:
  * @self: This #ModulemdProfile object.
- * @owner: A #ModulemdModuleStream that will own this profile. Used to look up
- * translations internally.
+ * @owner: (nullable): A #ModulemdModuleStream that will own this profile, or
+ * %NULL. Used to look up translations internally. It is not referenced.
  *
  * Since: 2.6
  */
 void
 modulemd_profile_set_owner (ModulemdProfile *self,
                             ModulemdModuleStream *owner);
+
+
+/**
+ * modulemd_profile_disown:
+ * @self: (in) (transfer full): A #ModulemdProfile object.
+ *
+ * Clears the owner of @self and drops a reference to it. This is the
+ * #GDestroyNotify of the profile tables of streams, so a profile that
+ * outlives its stream never looks up translations through it.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_profile_disown (gpointer self);
+
+
+/**
+ * modulemd_profile_get_rpms_internal:
+ * @self: This #ModulemdProfile object.
+ *
+ * Returns: (transfer none): The internal hash table representing the set of
+ * RPMs in this profile.
+ *
+ * Since: 2.16
+ */
+GHashTable *
+modulemd_profile_get_rpms_internal (ModulemdProfile *self);
+
+
+/**
+ * modulemd_profile_add_memory_usage:
+ * @self: (in): This #ModulemdProfile object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self, its strings and its set of RPMs. The
+ * stream that owns @self is not included.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_profile_add_memory_usage (ModulemdProfile *self,
+                                   ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_profile_compact:
+ * @self: (in): This #ModulemdProfile object.
+ * @compactor: (in): The #ModulemdCompactor holding the canonical sets.
+ *
+ * Replaces the set of RPMs of @self with the canonical set of @compactor that
+ * is equal to it. The set is copied the next time @self is modified.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_profile_compact (ModulemdProfile *self, ModulemdCompactor *compactor);
+
+
+/**
+ * modulemd_profile_get_generation:
+ * @self: (in): This #ModulemdProfile object.
+ *
+ * Returns: The value of modulemd_next_generation() recorded by the last
+ * setter called on @self, or 0 if none was called.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_profile_get_generation (ModulemdProfile *self);
+
+
+/**
+ * modulemd_profile_freeze:
+ * @self: (in): This #ModulemdProfile object.
+ *
+ * Makes every later setter called on @self emit a critical warning and
+ * return without changing it. Called when the stream that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_profile_freeze (ModulemdProfile *self);
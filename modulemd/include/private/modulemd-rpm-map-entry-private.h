@@ -14,6 +14,8 @@
 #include <glib.h>
 #include <yaml.h>
 
+#include "modulemd-memory-usage.h"
+
 /**
  * SECTION: modulemd-rpm-map-entry-private
  * @title: Modulemd.RpmMapEntry (Private)
@@ -87,3 +89,44 @@ modulemd_rpm_map_entry_equals_wrapper (const void *a, const void *b);
  */
 gboolean
 modulemd_RpmMapEntry_hash_table_equals_wrapper (const void *a, const void *b);
+
+
+/**
+ * modulemd_rpm_map_entry_add_memory_usage:
+ * @self: (in): This #ModulemdRpmMapEntry object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and its strings.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_rpm_map_entry_add_memory_usage (ModulemdRpmMapEntry *self,
+                                         ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_rpm_map_entry_get_generation:
+ * @self: (in): This #ModulemdRpmMapEntry object.
+ *
+ * Returns: The value of modulemd_next_generation() recorded by the last
+ * setter called on @self, or 0 if none was called.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_rpm_map_entry_get_generation (ModulemdRpmMapEntry *self);
+
+
+/**
+ * modulemd_rpm_map_entry_freeze:
+ * @self: (in): This #ModulemdRpmMapEntry object.
+ *
+ * Makes every later setter called on @self emit a critical warning and
+ * return without changing it. Called when the stream that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_rpm_map_entry_freeze (ModulemdRpmMapEntry *self);
@@ -16,6 +16,7 @@
 #include <glib-object.h>
 #include <yaml.h>
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-service-level.h"
 
 /**
@@ -78,3 +79,44 @@ modulemd_service_level_emit_yaml (ModulemdServiceLevel *self,
  */
 gboolean
 modulemd_service_level_equals_wrapper (const void *a, const void *b);
+
+
+/**
+ * modulemd_service_level_add_memory_usage:
+ * @self: (in): This #ModulemdServiceLevel object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self, its name and its EOL date.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_service_level_add_memory_usage (ModulemdServiceLevel *self,
+                                         ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_service_level_get_generation:
+ * @self: (in): This #ModulemdServiceLevel object.
+ *
+ * Returns: The value of modulemd_next_generation() recorded by the last
+ * setter called on @self, or 0 if none was called.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_service_level_get_generation (ModulemdServiceLevel *self);
+
+
+/**
+ * modulemd_service_level_freeze:
+ * @self: (in): This #ModulemdServiceLevel object.
+ *
+ * Makes every later setter called on @self emit a critical warning and
+ * return without changing it. Called when the stream that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_service_level_freeze (ModulemdServiceLevel *self);
@@ -0,0 +1,61 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#include "modulemd-stream-query.h"
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-stream-query-private
+ * @title: Modulemd.StreamQuery (Private)
+ * @stability: Private
+ * @short_description: #ModulemdStreamQuery methods that should be used only
+ * by internal consumers.
+ */
+
+
+/**
+ * modulemd_stream_query_get_module_name_literal:
+ * @self: (in): This #ModulemdStreamQuery object.
+ *
+ * Returns: (transfer none) (nullable): The only module name that can possibly
+ * match this query, if the query restricts the module name to a single literal
+ * value. NULL if streams from more than one module may match. Callers can use
+ * this to look the module up directly instead of visiting every module.
+ *
+ * Since: 2.16
+ */
+const gchar *
+modulemd_stream_query_get_module_name_literal (ModulemdStreamQuery *self);
+
+
+/**
+ * modulemd_stream_query_may_match_module:
+ * @self: (in): This #ModulemdStreamQuery object.
+ * @module_name: (in): The name of a module.
+ *
+ * Returns: FALSE if no stream belonging to the module named @module_name can
+ * match this query, so that the module may be skipped entirely. TRUE if some
+ * of its streams may match.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_stream_query_may_match_module (ModulemdStreamQuery *self,
+                                        const gchar *module_name);
+
+G_END_DECLS
@@ -16,6 +16,7 @@
 #include <glib-object.h>
 #include <yaml.h>
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-translation-entry.h"
 
 /**
@@ -65,3 +66,32 @@ gboolean
 modulemd_translation_entry_emit_yaml (ModulemdTranslationEntry *self,
                                       yaml_emitter_t *emitter,
                                       GError **error);
+
+
+/**
+ * modulemd_translation_entry_add_memory_usage:
+ * @self: (in): This #ModulemdTranslationEntry object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self, its strings and its profile
+ * descriptions.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_translation_entry_add_memory_usage (ModulemdTranslationEntry *self,
+                                             ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_translation_entry_freeze:
+ * @self: (in): This #ModulemdTranslationEntry object.
+ *
+ * Makes every later setter called on @self emit a critical warning and return
+ * without changing it. Called when the #ModulemdTranslation that owns @self is
+ * frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_translation_entry_freeze (ModulemdTranslationEntry *self);
@@ -16,6 +16,7 @@
 #include <glib-object.h>
 #include <yaml.h>
 
+#include "modulemd-memory-usage.h"
 #include "modulemd-profile.h"
 #include "modulemd-subdocument-info.h"
 
@@ -111,3 +112,32 @@ gboolean
 modulemd_translation_emit_yaml (ModulemdTranslation *self,
                                 yaml_emitter_t *emitter,
                                 GError **error);
+
+
+/**
+ * modulemd_translation_add_memory_usage:
+ * @self: (in): This #ModulemdTranslation object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory used by @self and its entries, all of it in
+ * %MD_MEMORY_CATEGORY_TRANSLATIONS.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_translation_add_memory_usage (ModulemdTranslation *self,
+                                       ModulemdMemoryUsage *usage);
+
+
+/**
+ * modulemd_translation_freeze:
+ * @self: (in): This #ModulemdTranslation object.
+ *
+ * Makes every later setter called on @self and its translation entries emit a
+ * critical warning and return without changing it. Called when the
+ * #ModulemdModule that owns @self is frozen. Copies of @self are not frozen.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_translation_freeze (ModulemdTranslation *self);
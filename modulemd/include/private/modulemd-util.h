@@ -108,6 +108,99 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (modulemd_tracer, modulemd_trace_free);
 
 G_END_DECLS
 
+/**
+ * modulemd_str_intern:
+ * @str: (in) (nullable): A string.
+ *
+ * Module, stream and dependency names, arches, licenses and RPM names recur
+ * many thousands of times across a large #ModulemdModuleIndex. Interned
+ * strings are reference counted and all interned copies of equal strings
+ * share a single allocation, which is freed when the last copy is released.
+ * Two interned strings are equal if and only if they are the same pointer.
+ *
+ * The strings are interned in the process-wide table of #GRefString rather
+ * than in a pool owned by each #ModulemdModuleIndex. Objects are routinely
+ * copied and merged from one index into another, and with a pool per index
+ * every such copy would have to intern its strings again, or keep the pool
+ * of the source index alive.
+ *
+ * With GLib older than 2.58, which lacks #GRefString, this returns a plain
+ * copy of @str instead, and interned strings are only equal by content.
+ *
+ * Returns: (transfer full) (nullable): An interned copy of @str, or NULL if
+ * @str is NULL. It must be released with modulemd_str_release() and never
+ * with g_free() or modified in place.
+ *
+ * Since: 2.16
+ */
+gchar *
+modulemd_str_intern (const gchar *str);
+
+
+/**
+ * modulemd_str_release:
+ * @str: (in) (nullable): A string returned by modulemd_str_intern().
+ *
+ * Releases a copy of an interned string. This is usable as the
+ * #GDestroyNotify of a #GHashTable.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_str_release (gpointer str);
+
+
+/**
+ * modulemd_str_equal:
+ * @a: (in): A string.
+ * @b: (in): A string.
+ *
+ * Like g_str_equal(), but returns immediately when @a and @b are the same
+ * pointer, which is always the case for equal interned strings.
+ *
+ * Returns: TRUE if @a and @b are equal.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_str_equal (gconstpointer a, gconstpointer b);
+
+
+/**
+ * modulemd_str_set_new:
+ *
+ * All of the sets of strings stored in libmodulemd objects are created with
+ * this function. Every key added to them must come from
+ * modulemd_str_intern().
+ *
+ * Returns: (transfer full): A newly-allocated, empty #GHashTable set of
+ * interned strings.
+ *
+ * Since: 2.16
+ */
+GHashTable *
+modulemd_str_set_new (void);
+
+
+/**
+ * modulemd_next_generation:
+ *
+ * Module streams and the objects stored in them record the value returned by
+ * this function each time they are modified. The values come from a single
+ * counter shared by all objects, so the largest value recorded by a stream
+ * and its sub-objects grows whenever any of them changes, and it can be
+ * compared against an earlier one to tell whether anything changed since.
+ *
+ * This is safe to call from several threads at once.
+ *
+ * Returns: A value larger than any that was returned before.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_next_generation (void);
+
+
 /**
  * modulemd_hash_table_deep_str_copy:
  * @orig: A #GHashTable to copy, containing string keys and string values.
@@ -127,7 +220,8 @@ modulemd_hash_table_deep_str_copy (GHashTable *orig);
  * Returns: (transfer full): A newly-allocated #GHashTable containing a deep
  * copy of the keys from @orig. The values from @orig are ignored, and the
  * values in the copy are set the same as the corresponding keys so the
- * returned #GHashTable can be used as a set.
+ * returned #GHashTable can be used as a set. The keys of the copy are
+ * interned as described in modulemd_str_set_new().
  *
  * Since: 2.0
  */
@@ -272,6 +366,23 @@ modulemd_strcmp_wrapper (gconstpointer a, gconstpointer b);
 GPtrArray *
 modulemd_ordered_str_keys (GHashTable *htable, GCompareFunc compare_func);
 
+/**
+ * modulemd_sorted_str_keys:
+ * @htable: A #GHashTable with string keys.
+ *
+ * Like modulemd_ordered_str_keys() with modulemd_strcmp_sort(), but the
+ * returned array points to the keys owned by @htable instead of copies of
+ * them. It is meant for emitting and comparing tables, and must not be used
+ * after @htable is modified or freed.
+ *
+ * Returns: (transfer container): A #GPtrArray of the keys of @htable in
+ * sorted order.
+ *
+ * Since: 2.16
+ */
+GPtrArray *
+modulemd_sorted_str_keys (GHashTable *htable);
+
 /**
  * modulemd_ordered_str_keys_as_strv:
  * @htable: A #GHashTable.
@@ -449,6 +560,37 @@ modulemd_guint64_to_iso8601date (guint64 date);
   while (0)
 
 
+/**
+ * MODULEMD_TAKE_SET:
+ * @_dest: A reference to a #GHashTable.
+ * @_set: (transfer full) (nullable): A reference to a #GHashTable set of
+ * strings created with modulemd_str_set_new(), such as one returned by
+ * modulemd_yaml_parse_string_set().
+ *
+ * Like MODULEMD_REPLACE_SET(), but @_dest takes ownership of @_set instead of
+ * copying it, and @_set is set to NULL. If @_set is NULL, @_dest is emptied.
+ *
+ * This helper is intended for use by the YAML parsers, which build each set
+ * once and have no further use for it.
+ *
+ * Since: 2.16
+ */
+#define MODULEMD_TAKE_SET(_dest, _set)                                        \
+  do                                                                          \
+    {                                                                         \
+      if (_set)                                                               \
+        {                                                                     \
+          g_clear_pointer (&_dest, g_hash_table_unref);                       \
+          _dest = g_steal_pointer (&_set);                                    \
+        }                                                                     \
+      else                                                                    \
+        {                                                                     \
+          g_hash_table_remove_all (_dest);                                    \
+        }                                                                     \
+    }                                                                         \
+  while (0)
+
+
 /**
  * MODULEMD_SETTER_GETTER_STRING_EXT:
  * @is_static: static for private methods, or empty comment for public.
@@ -529,13 +671,3 @@ modulemd_guint64_to_iso8601date (guint64 date);
   MODULEMD_SETTER_GETTER_STRING_EXT (                                         \
     static, ObjName, obj_name, OBJ_NAME, attr, ATTR)
 
-/**
- * modulemd_str_set_new:
- *
- * A convenience macro to simplify the common operation of setting up a hash
- * table in libmodulemd for containing a set() of unique strings.
- *
- * Since: 2.10
- */
-#define modulemd_str_set_new()                                                \
-  g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL)
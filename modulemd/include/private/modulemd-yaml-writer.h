@@ -0,0 +1,168 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <yaml.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION: modulemd-yaml-writer
+ * @title: Modulemd YAML Writer
+ * @stability: Private
+ * @short_description: Direct YAML output for the emitters.
+ *
+ * The `*_emit_yaml()` functions write their documents as libyaml events.
+ * libyaml copies every scalar into its event, analyzes it again when it is
+ * emitted and writes the output one character at a time through several
+ * layers of checks.
+ *
+ * Attaching a #modulemd_yaml_writer to an emitter makes mmd_emitter_emit()
+ * and the mmd_emitter_scalar() family hand their events to it instead. It
+ * follows the rules of the libyaml 0.2.5 emitter for the subset of YAML
+ * that libmodulemd writes, so its output is byte-for-byte the same, but it
+ * reads scalars in place, analyzes each of them once and writes straight
+ * into its own output buffer. Whatever it writes is passed on to the
+ * output that was set on the emitter before it was attached.
+ *
+ * Anchors, aliases, explicit tags, version and tag directives, canonical
+ * output and encodings other than UTF-8 are not supported. Events using
+ * them fail to emit.
+ */
+
+
+/**
+ * modulemd_yaml_writer:
+ *
+ * The output buffer and emitter state of a YAML stream that is being
+ * written directly.
+ *
+ * Since: 2.16
+ */
+typedef struct _modulemd_yaml_writer modulemd_yaml_writer;
+
+
+/**
+ * modulemd_yaml_writer_new:
+ * @emitter: (inout): A libyaml emitter whose output has been set, but which
+ * has not emitted any events yet.
+ *
+ * Attaches a new #modulemd_yaml_writer to @emitter. Its formatting options,
+ * such as the indentation and line width, are read when the stream is
+ * started.
+ *
+ * Returns: (transfer full): The new #modulemd_yaml_writer. It must be freed
+ * before @emitter is deleted.
+ *
+ * Since: 2.16
+ */
+modulemd_yaml_writer *
+modulemd_yaml_writer_new (yaml_emitter_t *emitter);
+
+
+/**
+ * modulemd_yaml_writer_free:
+ * @self: (in): This #modulemd_yaml_writer.
+ *
+ * Detaches @self from its emitter and restores the output of the emitter.
+ * Output that has not been flushed yet is discarded.
+ *
+ * Since: 2.16
+ */
+void
+modulemd_yaml_writer_free (modulemd_yaml_writer *self);
+
+
+/**
+ * mmd_emitter_is_direct:
+ * @emitter: (in): A libyaml emitter.
+ *
+ * Returns: TRUE if a #modulemd_yaml_writer is attached to @emitter.
+ *
+ * Since: 2.16
+ */
+gboolean
+mmd_emitter_is_direct (yaml_emitter_t *emitter);
+
+
+/**
+ * mmd_direct_check_utf8:
+ * @value: (in) (array length=length): The text of a scalar.
+ * @length: (in): The length of @value in bytes.
+ *
+ * Applies the checks that yaml_scalar_event_initialize() makes before it
+ * accepts a scalar.
+ *
+ * Returns: TRUE if @value is well-formed UTF-8.
+ *
+ * Since: 2.16
+ */
+gboolean
+mmd_direct_check_utf8 (const gchar *value, gsize length);
+
+
+/**
+ * mmd_direct_emit:
+ * @emitter: (inout): A libyaml emitter for which mmd_emitter_is_direct()
+ * returns TRUE.
+ * @event: (in): The libyaml event to write. Unlike with yaml_emitter_emit(),
+ * it is only read and remains owned by the caller, so the value of a scalar
+ * event may point to memory that libyaml did not allocate.
+ *
+ * Returns: 1 if @event was written. 0 if @event uses a feature that is not
+ * supported, does not belong at the current position or could not be
+ * written to the output.
+ *
+ * Since: 2.16
+ */
+int
+mmd_direct_emit (yaml_emitter_t *emitter, const yaml_event_t *event);
+
+
+/**
+ * mmd_emitter_flush:
+ * @emitter: (inout): A libyaml emitter.
+ *
+ * Like yaml_emitter_flush(), but also writes out the buffer of a
+ * #modulemd_yaml_writer attached to @emitter.
+ *
+ * Returns: 1 on success, 0 if the output could not be written.
+ *
+ * Since: 2.16
+ */
+int
+mmd_emitter_flush (yaml_emitter_t *emitter);
+
+
+/**
+ * MMD_INIT_YAML_WRITER:
+ * @_emitter: (inout): A libyaml emitter whose output has been set.
+ * @_writer: (out): The name of the variable holding the new
+ * #modulemd_yaml_writer.
+ *
+ * Attaches a #modulemd_yaml_writer to @_emitter that is freed when it goes
+ * out of scope. It must be declared after @_emitter so that it is freed
+ * before @_emitter is deleted.
+ *
+ * Since: 2.16
+ */
+#define MMD_INIT_YAML_WRITER(_emitter, _writer)                               \
+  g_autoptr (modulemd_yaml_writer) _writer =                                  \
+    modulemd_yaml_writer_new (_emitter)
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (modulemd_yaml_writer,
+                               modulemd_yaml_writer_free);
+
+G_END_DECLS
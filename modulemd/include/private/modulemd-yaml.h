@@ -47,6 +47,9 @@ G_BEGIN_DECLS
  * document type. Since: 2.9
  * @MODULEMD_YAML_DOC_OBSOLETES: Represents a `modulemd-obsoletes` document (see
  * #ModulemdObsoletes) YAML document type. Since: 2.10
+ * @MODULEMD_YAML_DOC_DELTA: Represents a `modulemd-delta` document, the
+ * header of a delta produced by modulemd_module_index_dump_delta_to_string().
+ * Since: 2.16
  *
  * Since: 2.0
  */
@@ -57,13 +60,15 @@ typedef enum
   MODULEMD_YAML_DOC_DEFAULTS,
   MODULEMD_YAML_DOC_TRANSLATIONS,
   MODULEMD_YAML_DOC_PACKAGER,
-  MODULEMD_YAML_DOC_OBSOLETES
+  MODULEMD_YAML_DOC_OBSOLETES,
+  MODULEMD_YAML_DOC_DELTA
 } ModulemdYamlDocumentTypeEnum;
 
 /**
  * modulemd_yaml_string:
  * @str: A pointer to a block of memory containing YAML.
  * @len: The number of bytes currently in use in @str.
+ * @allocated: The number of bytes allocated for @str.
  *
  * #modulemd_yaml_string is an internal representation of an arbitrary length
  * YAML string.
@@ -74,6 +79,7 @@ typedef struct _modulemd_yaml_string
 {
   char *str;
   size_t len;
+  size_t allocated;
 } modulemd_yaml_string;
 
 /**
@@ -82,7 +88,9 @@ typedef struct _modulemd_yaml_string
  * @buffer: (in): YAML text to append to @data.
  * @size: (in): The number of bytes from @buffer to append to @data.
  *
- * Additionally memory for @data is automatically allocated if necessary.
+ * Additionally memory for @data is automatically allocated if necessary. It
+ * grows geometrically, so that a large document is not copied again each
+ * time the emitter flushes its buffer.
  *
  * Since: 2.0
  */
@@ -109,6 +117,37 @@ G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC (yaml_parser_t, yaml_parser_delete);
 
 G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC (yaml_emitter_t, yaml_emitter_delete);
 
+/**
+ * mmd_yaml_debug_enabled:
+ *
+ * The parsers and emitters log every event and scalar at debug level. This
+ * lets them skip formatting those messages when they would be dropped.
+ *
+ * Returns: FALSE if the default GLib log writer would drop debug messages of
+ * this library. Always TRUE with GLib older than 2.68.
+ *
+ * Since: 2.16
+ */
+gboolean
+mmd_yaml_debug_enabled (void);
+
+/**
+ * MMD_YAML_DEBUG:
+ * @...: (in): A format string and its arguments, as for g_debug().
+ *
+ * Calls g_debug() with the arguments, unless mmd_yaml_debug_enabled() returns
+ * FALSE.
+ *
+ * Since: 2.16
+ */
+#define MMD_YAML_DEBUG(...)                                                   \
+  do                                                                          \
+    {                                                                         \
+      if (mmd_yaml_debug_enabled ())                                          \
+        g_debug (__VA_ARGS__);                                                \
+    }                                                                         \
+  while (0)
+
 /**
  * mmd_yaml_get_event_name:
  * @type: (in): A libyaml event type.
@@ -225,6 +264,8 @@ mmd_yaml_get_event_name (yaml_event_type_t type);
                                "Parser error");                               \
           return _returnval;                                                  \
         }                                                                     \
+      if (!mmd_yaml_debug_enabled ())                                         \
+        break;                                                                \
       if ((_event)->type == YAML_SCALAR_EVENT)                                \
         g_debug ("Parser event: %s: %s",                                      \
                  mmd_yaml_get_event_name ((_event)->type),                    \
@@ -309,9 +350,7 @@ mmd_yaml_get_event_name (yaml_event_type_t type);
   do                                                                          \
     {                                                                         \
       int _ret;                                                               \
-      g_debug ("Emitter event: %s",                                           \
-               mmd_yaml_get_event_name ((_event)->type));                     \
-      _ret = yaml_emitter_emit (_emitter, _event);                            \
+      _ret = mmd_emitter_emit (_emitter, _event);                             \
       (_event)->type = 0;                                                     \
       if (!_ret)                                                              \
         {                                                                     \
@@ -473,6 +512,90 @@ mmd_yaml_get_event_name (yaml_event_type_t type);
     }                                                                         \
   while (0)
 
+/**
+ * MMD_TAKE_PARSED_YAML_STRING:
+ * @_parser: (inout): A libyaml parser object positioned at the beginning of an
+ * expected string event.
+ * @_error: (out): A #GError that will return the reason for a parsing or
+ * validation error.
+ * @_fn: (in): A function of object @_obj that takes ownership of the
+ * successfully parsed string.
+ * @_obj: (inout): The object that is to store the parsed string via @_fn.
+ *
+ * Like %MMD_SET_PARSED_YAML_STRING, but hands the parsed string over to @_fn
+ * instead of having it copied by a public setter.
+ *
+ * Returns: Continues on if parsing of the event was successful. Returns
+ * NULL if a parse error occurred and sets @_error appropriately.
+ *
+ * Since: 2.16
+ */
+#define MMD_TAKE_PARSED_YAML_STRING(_parser, _error, _fn, _obj)               \
+  do                                                                          \
+    {                                                                         \
+      GError *_nested_error = NULL;                                           \
+      gchar *_scalar = modulemd_yaml_parse_string (_parser, &_nested_error);  \
+      if (!_scalar)                                                           \
+        {                                                                     \
+          g_propagate_error (_error, _nested_error);                          \
+          return NULL;                                                        \
+        }                                                                     \
+      _fn (_obj, _scalar);                                                    \
+    }                                                                         \
+  while (0)
+
+/**
+ * MMD_STORE_PARSED_YAML_STRING:
+ * @_parser: (inout): A libyaml parser object positioned at the beginning of an
+ * expected string event.
+ * @_error: (out): A #GError that will return the reason for a parsing or
+ * validation error.
+ * @_field: (inout): The `gchar *` structure member that is to own the
+ * successfully parsed string. Its previous value is freed.
+ *
+ * Stores the parsed string directly in a field of an object being parsed,
+ * bypassing the checks and property notifications of its public setter.
+ *
+ * Returns: Continues on if parsing of the event was successful. Returns
+ * NULL if a parse error occurred and sets @_error appropriately.
+ *
+ * Since: 2.16
+ */
+#define MMD_STORE_PARSED_YAML_STRING(_parser, _error, _field)                 \
+  do                                                                          \
+    {                                                                         \
+      GError *_nested_error = NULL;                                           \
+      gchar *_scalar = modulemd_yaml_parse_string (_parser, &_nested_error);  \
+      if (!_scalar)                                                           \
+        {                                                                     \
+          g_propagate_error (_error, _nested_error);                          \
+          return NULL;                                                        \
+        }                                                                     \
+      g_free (_field);                                                        \
+      _field = _scalar;                                                       \
+    }                                                                         \
+  while (0)
+
+/**
+ * mmd_emitter_emit:
+ * @emitter: (inout): A libyaml emitter object positioned where @event belongs
+ * in the output.
+ * @event: (inout): The libyaml event to be emitted. It is consumed whether or
+ * not this succeeds.
+ *
+ * Emits @event with yaml_emitter_emit(), unless the output of @emitter was
+ * set with mmd_emitter_set_output_json(), in which case @event is written as
+ * JSON or CBOR instead, or a #modulemd_yaml_writer is attached to @emitter,
+ * in which case it writes @event. All events must be emitted through this
+ * function, usually with %MMD_EMIT_WITH_EXIT.
+ *
+ * Returns: 1 if @event was emitted, 0 otherwise, like yaml_emitter_emit().
+ *
+ * Since: 2.16
+ */
+int
+mmd_emitter_emit (yaml_emitter_t *emitter, yaml_event_t *event);
+
 /**
  * mmd_emitter_start_stream:
  * @emitter: (inout): A libyaml emitter object that will be positioned at the
@@ -638,6 +761,69 @@ mmd_emitter_scalar_string (yaml_emitter_t *emitter,
                            GError **error);
 
 
+/**
+ * mmd_emitter_scalar_uint64:
+ * @emitter: (inout): A libyaml emitter object that is positioned at the start
+ * of where a scalar will be written.
+ * @value: (in): The unsigned integer to be written.
+ * @error: (out): A #GError that will return the reason for any error.
+ *
+ * Writes @value as a plain scalar tagged as an integer. The tag is implicit,
+ * so the YAML output is the same as for mmd_emitter_scalar(), but it lets a
+ * JSON or CBOR emitter write @value as a number rather than a string.
+ *
+ * Returns: TRUE if the YAML scalar was written successfully. Returns FALSE if
+ * an error occurred and sets @error appropriately.
+ *
+ * Since: 2.16
+ */
+gboolean
+mmd_emitter_scalar_uint64 (yaml_emitter_t *emitter,
+                           guint64 value,
+                           GError **error);
+
+
+/**
+ * mmd_emitter_scalar_int64:
+ * @emitter: (inout): A libyaml emitter object that is positioned at the start
+ * of where a scalar will be written.
+ * @value: (in): The signed integer to be written.
+ * @error: (out): A #GError that will return the reason for any error.
+ *
+ * Like mmd_emitter_scalar_uint64(), but for signed integers.
+ *
+ * Returns: TRUE if the YAML scalar was written successfully. Returns FALSE if
+ * an error occurred and sets @error appropriately.
+ *
+ * Since: 2.16
+ */
+gboolean
+mmd_emitter_scalar_int64 (yaml_emitter_t *emitter,
+                          gint64 value,
+                          GError **error);
+
+
+/**
+ * mmd_emitter_scalar_boolean:
+ * @emitter: (inout): A libyaml emitter object that is positioned at the start
+ * of where a scalar will be written.
+ * @value: (in): The boolean to be written.
+ * @error: (out): A #GError that will return the reason for any error.
+ *
+ * Writes @value as a plain `true` or `false` scalar tagged as a boolean, so
+ * that a JSON or CBOR emitter writes it as a boolean rather than a string.
+ *
+ * Returns: TRUE if the YAML scalar was written successfully. Returns FALSE if
+ * an error occurred and sets @error appropriately.
+ *
+ * Since: 2.16
+ */
+gboolean
+mmd_emitter_scalar_boolean (yaml_emitter_t *emitter,
+                            gboolean value,
+                            GError **error);
+
+
 /**
  * mmd_emitter_strv:
  * @emitter: (inout): A libyaml emitter object positioned at the start of where
@@ -854,6 +1040,121 @@ ModulemdSubdocumentInfo *
 modulemd_yaml_parse_document_type (yaml_parser_t *parser);
 
 
+/**
+ * modulemd_yaml_parse_json_document_type:
+ * @parser: (inout): A libyaml parser object reading a JSON array of
+ * documents, positioned immediately after @mapping_start.
+ * @mapping_start: (inout): The `YAML_MAPPING_START_EVENT` of an element of
+ * the array. It is consumed by this function.
+ *
+ * Reads through an element of a JSON array of documents, as written by
+ * modulemd_module_index_dump_to_json(), to retrieve the document type,
+ * metadata version and the data section, like
+ * modulemd_yaml_parse_document_type() does for a YAML subdocument.
+ *
+ * Returns: (transfer full): A #ModulemdSubdocumentInfo with information on
+ * the parse results.
+ *
+ * Since: 2.16
+ */
+ModulemdSubdocumentInfo *
+modulemd_yaml_parse_json_document_type (yaml_parser_t *parser,
+                                        yaml_event_t *mapping_start);
+
+
+/**
+ * modulemd_yaml_prescan_stream_mdversion_from_string:
+ * @yaml_string: (in): A YAML string containing one or more subdocuments.
+ *
+ * Performs a cheap line-oriented scan of @yaml_string, without running the
+ * YAML parser, to find the highest #ModulemdModuleStream metadata version that
+ * loading it will require. Only top-level `document:` and `version:` keys
+ * written in block style at the start of a line are recognized, so the result
+ * may be lower than the real requirement, but never higher for well-formed
+ * input.
+ *
+ * Returns: The highest stream mdversion found, or zero if no module stream or
+ * obsoletes subdocuments were recognized.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_yaml_prescan_stream_mdversion_from_string (const gchar *yaml_string);
+
+
+/**
+ * modulemd_yaml_prescan_stream_mdversion_from_data:
+ * @data: (in) (array length=len): A YAML document stream, not necessarily
+ * NUL-terminated.
+ * @len: (in): The length of @data in bytes.
+ *
+ * Like modulemd_yaml_prescan_stream_mdversion_from_string() for data of a
+ * known length.
+ *
+ * Returns: The highest stream mdversion required by @data, or zero.
+ *
+ * Since: 2.16
+ */
+guint64
+modulemd_yaml_prescan_stream_mdversion_from_data (const gchar *data,
+                                                  gsize len);
+
+
+/**
+ * modulemd_yaml_prescan_stream_mdversion_from_file:
+ * @stream: (in): A seekable, readable stream positioned at its start.
+ * @mdversion: (out): The highest stream mdversion found, or zero if no module
+ * stream or obsoletes subdocuments were recognized.
+ *
+ * Like modulemd_yaml_prescan_stream_mdversion_from_string(), but reads the
+ * YAML from @stream, which is rewound to its start afterwards.
+ *
+ * Returns: TRUE if @stream was rewound. FALSE if it could not be, in which case
+ * @stream must not be used for parsing.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_yaml_prescan_stream_mdversion_from_file (FILE *stream,
+                                                  guint64 *mdversion);
+
+
+/**
+ * modulemd_yaml_prescan_stream_mdversion_from_read_fn:
+ * @read_fn: (in): A libyaml read handler returning the YAML.
+ * @data: (inout): The data passed to @read_fn.
+ * @mdversion: (out): The highest stream mdversion found, or zero if no module
+ * stream or obsoletes subdocuments were recognized.
+ *
+ * Like modulemd_yaml_prescan_stream_mdversion_from_string(), but reads the
+ * YAML from @read_fn, for input that cannot be rewound such as the output of
+ * a decompressor. Reading stops as soon as a subdocument requiring the newest
+ * stream mdversion has been seen.
+ *
+ * Returns: TRUE if the scan completed. FALSE if @read_fn failed, in which case
+ * @mdversion is zero.
+ *
+ * Since: 2.16
+ */
+gboolean
+modulemd_yaml_prescan_stream_mdversion_from_read_fn (
+  yaml_read_handler_t read_fn, void *data, guint64 *mdversion);
+
+
+/**
+ * modulemd_yaml_get_doctype_string:
+ * @doctype: (in): The document type (see #ModulemdYamlDocumentTypeEnum)
+ * @mdversion: (in): The metadata version of the document
+ *
+ * Returns: (transfer none): The string used for @doctype in the `document:`
+ * key of a YAML document with @mdversion, or NULL if @doctype is unknown.
+ *
+ * Since: 2.16
+ */
+const gchar *
+modulemd_yaml_get_doctype_string (ModulemdYamlDocumentTypeEnum doctype,
+                                  guint64 mdversion);
+
 /**
  * modulemd_yaml_emit_document_headers:
  * @emitter: (inout): A libyaml emitter object that is positioned where the
@@ -1193,6 +1494,62 @@ skip_unknown_yaml (yaml_parser_t *parser, GError **error);
   while (0)
 
 
+/**
+ * EMIT_KEY_VALUE_UINT64:
+ * @emitter: (inout): A libyaml emitter object positioned where a scalar
+ * belongs in the YAML document.
+ * @error: (out): A #GError that will return the reason for an output error.
+ * @key: (in): The key (string) to be written.
+ * @value: (in): The unsigned integer to be written.
+ *
+ * Emits key/value pair (@key: @value) with mmd_emitter_scalar_uint64().
+ *
+ * NOTE: This macro outputs both a key and a value for that key, thus it must
+ * only be used from within a YAML mapping.
+ *
+ * Returns: Continues on if the YAML key/value pair was written successfully.
+ * Returns FALSE if an error occurred and sets @error appropriately.
+ *
+ * Since: 2.16
+ */
+#define EMIT_KEY_VALUE_UINT64(emitter, error, key, value)                     \
+  do                                                                          \
+    {                                                                         \
+      EMIT_SCALAR ((emitter), (error), (key));                                \
+      if (!mmd_emitter_scalar_uint64 ((emitter), (value), (error)))           \
+        return FALSE;                                                         \
+    }                                                                         \
+  while (0)
+
+
+/**
+ * EMIT_KEY_VALUE_BOOLEAN:
+ * @emitter: (inout): A libyaml emitter object positioned where a scalar
+ * belongs in the YAML document.
+ * @error: (out): A #GError that will return the reason for an output error.
+ * @key: (in): The key (string) to be written.
+ * @value: (in): The boolean to be written.
+ *
+ * Emits key/value pair (@key: @value) with mmd_emitter_scalar_boolean().
+ *
+ * NOTE: This macro outputs both a key and a value for that key, thus it must
+ * only be used from within a YAML mapping.
+ *
+ * Returns: Continues on if the YAML key/value pair was written successfully.
+ * Returns FALSE if an error occurred and sets @error appropriately.
+ *
+ * Since: 2.16
+ */
+#define EMIT_KEY_VALUE_BOOLEAN(emitter, error, key, value)                    \
+  do                                                                          \
+    {                                                                         \
+      EMIT_SCALAR ((emitter), (error), (key));                                \
+      if (!mmd_emitter_scalar_boolean ((emitter), (value), (error)))          \
+        return FALSE;                                                         \
+    }                                                                         \
+  while (0)
+
+
 /**
  * EMIT_KEY_VALUE_IF_SET:
  * @emitter: (inout): A libyaml emitter object positioned where a scalar
@@ -1393,8 +1750,7 @@ skip_unknown_yaml (yaml_parser_t *parser, GError **error);
           EMIT_SCALAR (emitter, error, key);                                  \
           EMIT_MAPPING_START (emitter, error);                                \
           gsize i;                                                            \
-          g_autoptr (GPtrArray) keys =                                        \
-            modulemd_ordered_str_keys (table, modulemd_strcmp_sort);          \
+          g_autoptr (GPtrArray) keys = modulemd_sorted_str_keys (table);      \
           for (i = 0; i < keys->len; i++)                                     \
             {                                                                 \
               if (!emitfn (                                                   \
@@ -1436,8 +1792,7 @@ skip_unknown_yaml (yaml_parser_t *parser, GError **error);
           EMIT_SCALAR (emitter, error, key);                                  \
           EMIT_MAPPING_START (emitter, error);                                \
           gsize i;                                                            \
-          g_autoptr (GPtrArray) keys =                                        \
-            modulemd_ordered_str_keys (table, modulemd_strcmp_sort);          \
+          g_autoptr (GPtrArray) keys = modulemd_sorted_str_keys (table);      \
           for (i = 0; i < keys->len; i++)                                     \
             {                                                                 \
               EMIT_SCALAR (emitter, error, g_ptr_array_index (keys, i));      \
@@ -1546,8 +1901,7 @@ skip_unknown_yaml (yaml_parser_t *parser, GError **error);
       EMIT_SCALAR_STRING (emitter, error, key);                               \
       EMIT_SEQUENCE_START_WITH_STYLE (emitter, error, sequence_style);        \
       gsize i;                                                                \
-      g_autoptr (GPtrArray) keys =                                            \
-        modulemd_ordered_str_keys (table, modulemd_strcmp_sort);              \
+      g_autoptr (GPtrArray) keys = modulemd_sorted_str_keys (table);          \
       for (i = 0; i < keys->len; i++)                                         \
         {                                                                     \
           EMIT_SCALAR_STRING (emitter, error, g_ptr_array_index (keys, i));   \
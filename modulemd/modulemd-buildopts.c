@@ -17,6 +17,7 @@
 #include "modulemd-buildopts.h"
 #include "private/glib-extensions.h"
 #include "private/modulemd-buildopts-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
 
@@ -30,6 +31,16 @@ struct _ModulemdBuildopts
 
   GHashTable *allowed_build_names;
   GHashTable *arches;
+
+  /* Set from modulemd_next_generation () by every setter */
+  guint64 generation;
+
+  /* Set by modulemd_buildopts_freeze(); nothing may change afterwards */
+  gboolean frozen;
+  /* Set when the whitelist and the arches may be referenced by other
+   * buildopts, in which case they are copied before either is modified.
+   */
+  gboolean sets_shared;
 };
 
 G_DEFINE_TYPE (ModulemdBuildopts, modulemd_buildopts, G_TYPE_OBJECT)
@@ -147,8 +158,20 @@ modulemd_buildopts_copy (ModulemdBuildopts *self)
   modulemd_buildopts_set_rpm_macros (copy,
                                      modulemd_buildopts_get_rpm_macros (self));
 
-  MODULEMD_REPLACE_SET (copy->allowed_build_names, self->allowed_build_names);
-  MODULEMD_REPLACE_SET (copy->arches, self->arches);
+  if (self->sets_shared)
+    {
+      g_clear_pointer (&copy->allowed_build_names, g_hash_table_unref);
+      copy->allowed_build_names = g_hash_table_ref (self->allowed_build_names);
+      g_clear_pointer (&copy->arches, g_hash_table_unref);
+      copy->arches = g_hash_table_ref (self->arches);
+      copy->sets_shared = TRUE;
+    }
+  else
+    {
+      MODULEMD_REPLACE_SET (copy->allowed_build_names,
+                            self->allowed_build_names);
+      MODULEMD_REPLACE_SET (copy->arches, self->arches);
+    }
 
   return g_steal_pointer (&copy);
 }
@@ -159,7 +182,7 @@ modulemd_buildopts_finalize (GObject *object)
 {
   ModulemdBuildopts *self = (ModulemdBuildopts *)object;
 
-  g_clear_pointer (&self->rpm_macros, g_free);
+  g_clear_pointer (&self->rpm_macros, modulemd_str_release);
   g_clear_pointer (&self->allowed_build_names, g_hash_table_unref);
   g_clear_pointer (&self->arches, g_hash_table_unref);
 
@@ -167,14 +190,74 @@ modulemd_buildopts_finalize (GObject *object)
 }
 
 
+static gboolean
+modulemd_buildopts_will_change (ModulemdBuildopts *self)
+{
+  g_return_val_if_fail (!self->frozen, FALSE);
+
+  self->generation = modulemd_next_generation ();
+
+  return TRUE;
+}
+
+
+static void
+modulemd_buildopts_unshare_sets (ModulemdBuildopts *self)
+{
+  GHashTable *set = NULL;
+
+  if (!self->sets_shared)
+    {
+      return;
+    }
+
+  set = modulemd_hash_table_deep_set_copy (self->allowed_build_names);
+  g_hash_table_unref (self->allowed_build_names);
+  self->allowed_build_names = set;
+
+  set = modulemd_hash_table_deep_set_copy (self->arches);
+  g_hash_table_unref (self->arches);
+  self->arches = set;
+
+  self->sets_shared = FALSE;
+}
+
+
+guint64
+modulemd_buildopts_get_generation (ModulemdBuildopts *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_BUILDOPTS (self), 0);
+
+  return self->generation;
+}
+
+
+void
+modulemd_buildopts_freeze (ModulemdBuildopts *self)
+{
+  g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
+
+  self->frozen = TRUE;
+}
+
+
 void
 modulemd_buildopts_set_rpm_macros (ModulemdBuildopts *self,
                                    const gchar *rpm_macros)
 {
+  gchar *interned = NULL;
+
   g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
 
-  g_clear_pointer (&self->rpm_macros, g_free);
-  self->rpm_macros = g_strdup (rpm_macros);
+  if (!modulemd_buildopts_will_change (self))
+    {
+      return;
+    }
+
+  /* Builds for each architecture set the same macros */
+  interned = modulemd_str_intern (rpm_macros);
+  g_clear_pointer (&self->rpm_macros, modulemd_str_release);
+  self->rpm_macros = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_RPM_MACROS]);
 }
@@ -194,7 +277,14 @@ modulemd_buildopts_add_rpm_to_whitelist (ModulemdBuildopts *self,
                                          const gchar *rpm)
 {
   g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
-  g_hash_table_add (self->allowed_build_names, g_strdup (rpm));
+
+  if (!modulemd_buildopts_will_change (self))
+    {
+      return;
+    }
+
+  modulemd_buildopts_unshare_sets (self);
+  g_hash_table_add (self->allowed_build_names, modulemd_str_intern (rpm));
 }
 
 
@@ -203,6 +293,13 @@ modulemd_buildopts_remove_rpm_from_whitelist (ModulemdBuildopts *self,
                                               const gchar *rpm)
 {
   g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
+
+  if (!modulemd_buildopts_will_change (self))
+    {
+      return;
+    }
+
+  modulemd_buildopts_unshare_sets (self);
   g_hash_table_remove (self->allowed_build_names, rpm);
 }
 
@@ -210,6 +307,13 @@ void
 modulemd_buildopts_clear_rpm_whitelist (ModulemdBuildopts *self)
 {
   g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
+
+  if (!modulemd_buildopts_will_change (self))
+    {
+      return;
+    }
+
+  modulemd_buildopts_unshare_sets (self);
   g_hash_table_remove_all (self->allowed_build_names);
 }
 
@@ -227,7 +331,14 @@ void
 modulemd_buildopts_add_arch (ModulemdBuildopts *self, const gchar *arch)
 {
   g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
-  g_hash_table_add (self->arches, g_strdup (arch));
+
+  if (!modulemd_buildopts_will_change (self))
+    {
+      return;
+    }
+
+  modulemd_buildopts_unshare_sets (self);
+  g_hash_table_add (self->arches, modulemd_str_intern (arch));
 }
 
 
@@ -235,6 +346,13 @@ void
 modulemd_buildopts_remove_arch (ModulemdBuildopts *self, const gchar *arch)
 {
   g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
+
+  if (!modulemd_buildopts_will_change (self))
+    {
+      return;
+    }
+
+  modulemd_buildopts_unshare_sets (self);
   g_hash_table_remove (self->arches, arch);
 }
 
@@ -243,6 +361,13 @@ void
 modulemd_buildopts_clear_arches (ModulemdBuildopts *self)
 {
   g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
+
+  if (!modulemd_buildopts_will_change (self))
+    {
+      return;
+    }
+
+  modulemd_buildopts_unshare_sets (self);
   g_hash_table_remove_all (self->arches);
 }
 
@@ -316,9 +441,8 @@ modulemd_buildopts_class_init (ModulemdBuildoptsClass *klass)
 static void
 modulemd_buildopts_init (ModulemdBuildopts *self)
 {
-  self->allowed_build_names =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-  self->arches = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->allowed_build_names = modulemd_str_set_new ();
+  self->arches = modulemd_str_set_new ();
 }
 
 
@@ -625,3 +749,34 @@ modulemd_buildopts_emit_yaml (ModulemdBuildopts *self,
 
   return TRUE;
 }
+
+
+void
+modulemd_buildopts_add_memory_usage (ModulemdBuildopts *self,
+                                     ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_interned_string (usage, self->rpm_macros);
+  if (modulemd_memory_usage_claim (usage, self->allowed_build_names))
+    {
+      modulemd_memory_usage_add_string_set (usage, self->allowed_build_names);
+    }
+  if (modulemd_memory_usage_claim (usage, self->arches))
+    {
+      modulemd_memory_usage_add_string_set (usage, self->arches);
+    }
+}
+
+
+void
+modulemd_buildopts_compact (ModulemdBuildopts *self,
+                            ModulemdCompactor *compactor)
+{
+  g_return_if_fail (MODULEMD_IS_BUILDOPTS (self));
+
+  modulemd_compactor_share_set (compactor, &self->allowed_build_names);
+  modulemd_compactor_share_set (compactor, &self->arches);
+  self->sets_shared = TRUE;
+}
@@ -0,0 +1,164 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+
+#include "private/modulemd-compactor.h"
+#include "private/modulemd-util.h"
+
+
+struct _ModulemdCompactor
+{
+  /* The canonical string sets, used as a set */
+  GHashTable *sets;
+
+  /* The canonical tables of string sets, used as a set */
+  GHashTable *tables;
+
+  guint n_shared;
+};
+
+
+/* The hash does not depend on the order of the keys, so equal sets have equal
+ * hashes.
+ */
+static guint
+hash_set (gconstpointer set)
+{
+  GHashTableIter iter;
+  gpointer key;
+  guint hash = g_hash_table_size ((GHashTable *)set);
+
+  g_hash_table_iter_init (&iter, (GHashTable *)set);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      hash ^= g_str_hash (key);
+    }
+
+  return hash;
+}
+
+
+/* Like hash_set (), but for a table of sets keyed by string */
+static guint
+hash_table_of_sets (gconstpointer table)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  guint hash = g_hash_table_size ((GHashTable *)table);
+
+  g_hash_table_iter_init (&iter, (GHashTable *)table);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      hash ^= g_str_hash (key) * 31 + hash_set (value);
+    }
+
+  return hash;
+}
+
+
+static gboolean
+equal_tables_of_sets (gconstpointer a, gconstpointer b)
+{
+  return modulemd_hash_table_equals (
+    (GHashTable *)a,
+    (GHashTable *)b,
+    modulemd_hash_table_sets_are_equal_wrapper);
+}
+
+
+ModulemdCompactor *
+modulemd_compactor_new (void)
+{
+  ModulemdCompactor *self = g_new0 (ModulemdCompactor, 1);
+
+  self->sets =
+    g_hash_table_new_full (hash_set,
+                           modulemd_hash_table_sets_are_equal_wrapper,
+                           modulemd_hash_table_unref,
+                           NULL);
+  self->tables = g_hash_table_new_full (hash_table_of_sets,
+                                        equal_tables_of_sets,
+                                        modulemd_hash_table_unref,
+                                        NULL);
+
+  return self;
+}
+
+
+void
+modulemd_compactor_free (ModulemdCompactor *self)
+{
+  if (!self)
+    {
+      return;
+    }
+
+  g_clear_pointer (&self->sets, g_hash_table_unref);
+  g_clear_pointer (&self->tables, g_hash_table_unref);
+  g_free (self);
+}
+
+
+/* Replaces *@value with the canonical instance in @canonicals */
+static void
+share_value (ModulemdCompactor *self,
+             GHashTable *canonicals,
+             GHashTable **value)
+{
+  GHashTable *canonical = NULL;
+
+  canonical = g_hash_table_lookup (canonicals, *value);
+  if (!canonical)
+    {
+      g_hash_table_add (canonicals, g_hash_table_ref (*value));
+      return;
+    }
+
+  if (canonical != *value)
+    {
+      g_hash_table_unref (*value);
+      *value = g_hash_table_ref (canonical);
+      self->n_shared++;
+    }
+}
+
+
+void
+modulemd_compactor_share_set (ModulemdCompactor *self, GHashTable **set)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (set && *set);
+
+  share_value (self, self->sets, set);
+}
+
+
+void
+modulemd_compactor_share_table (ModulemdCompactor *self, GHashTable **table)
+{
+  g_return_if_fail (self);
+  g_return_if_fail (table && *table);
+
+  share_value (self, self->tables, table);
+}
+
+
+guint
+modulemd_compactor_get_n_shared (ModulemdCompactor *self)
+{
+  g_return_val_if_fail (self, 0);
+
+  return self->n_shared;
+}
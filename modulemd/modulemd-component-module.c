@@ -14,6 +14,7 @@
 #include "modulemd-component-module.h"
 #include "private/modulemd-component-module-private.h"
 #include "private/modulemd-component-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
 
@@ -56,8 +57,8 @@ modulemd_component_module_finalize (GObject *object)
 {
   ModulemdComponentModule *self = (ModulemdComponentModule *)object;
 
-  g_clear_pointer (&self->ref, g_free);
-  g_clear_pointer (&self->repository, g_free);
+  g_clear_pointer (&self->ref, modulemd_str_release);
+  g_clear_pointer (&self->repository, modulemd_str_release);
 
   G_OBJECT_CLASS (modulemd_component_module_parent_class)->finalize (object);
 }
@@ -120,10 +121,18 @@ void
 modulemd_component_module_set_ref (ModulemdComponentModule *self,
                                    const gchar *ref)
 {
+  gchar *interned = NULL;
+
   g_return_if_fail (MODULEMD_IS_COMPONENT_MODULE (self));
 
-  g_clear_pointer (&self->ref, g_free);
-  self->ref = g_strdup (ref);
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  interned = modulemd_str_intern (ref);
+  g_clear_pointer (&self->ref, modulemd_str_release);
+  self->ref = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_REF]);
 }
@@ -142,10 +151,18 @@ void
 modulemd_component_module_set_repository (ModulemdComponentModule *self,
                                           const gchar *repository)
 {
+  gchar *interned = NULL;
+
   g_return_if_fail (MODULEMD_IS_COMPONENT_MODULE (self));
 
-  g_clear_pointer (&self->repository, g_free);
-  self->repository = g_strdup (repository);
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  interned = modulemd_str_intern (repository);
+  g_clear_pointer (&self->repository, modulemd_str_release);
+  self->repository = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_REPOSITORY]);
 }
@@ -435,3 +452,15 @@ modulemd_component_module_parse_yaml (yaml_parser_t *parser,
 
   return g_steal_pointer (&m);
 }
+
+
+void
+modulemd_component_module_add_memory_usage (ModulemdComponentModule *self,
+                                            ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_COMPONENT_MODULE (self));
+
+  modulemd_component_add_memory_usage (MODULEMD_COMPONENT (self), usage);
+  modulemd_memory_usage_add_interned_string (usage, self->ref);
+  modulemd_memory_usage_add_interned_string (usage, self->repository);
+}
@@ -14,6 +14,7 @@
 #include "modulemd-component-rpm.h"
 #include "private/modulemd-component-private.h"
 #include "private/modulemd-component-rpm-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
 
@@ -32,6 +33,11 @@ struct _ModulemdComponentRpm
 
   GHashTable *arches;
   GHashTable *multilib;
+
+  /* Set when arches and multilib may be referenced by another component, in
+   * which case they are copied before either is modified.
+   */
+  gboolean sets_shared;
 };
 
 G_DEFINE_TYPE (ModulemdComponentRpm,
@@ -67,9 +73,9 @@ modulemd_component_rpm_finalize (GObject *object)
   ModulemdComponentRpm *self = (ModulemdComponentRpm *)object;
 
   g_clear_pointer (&self->override_name, g_free);
-  g_clear_pointer (&self->ref, g_free);
-  g_clear_pointer (&self->repository, g_free);
-  g_clear_pointer (&self->cache, g_free);
+  g_clear_pointer (&self->ref, modulemd_str_release);
+  g_clear_pointer (&self->repository, modulemd_str_release);
+  g_clear_pointer (&self->cache, modulemd_str_release);
   g_clear_pointer (&self->arches, g_hash_table_unref);
   g_clear_pointer (&self->multilib, g_hash_table_unref);
 
@@ -151,12 +157,12 @@ hash_table_str_set_copy (GHashTable *orig)
 
   g_return_val_if_fail (orig, NULL);
 
-  new = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  new = modulemd_str_set_new ();
 
   g_hash_table_iter_init (&iter, orig);
   while (g_hash_table_iter_next (&iter, &key, NULL))
     {
-      g_hash_table_add (new, g_strdup ((const gchar *)key));
+      g_hash_table_add (new, modulemd_str_intern ((const gchar *)key));
     }
 
   return new;
@@ -192,9 +198,18 @@ modulemd_component_rpm_copy (ModulemdComponent *self, const gchar *key)
   modulemd_component_rpm_set_srpm_buildroot (copy, rpm_self->srpm_buildroot);
 
   g_clear_pointer (&copy->arches, g_hash_table_unref);
-  copy->arches = hash_table_str_set_copy (rpm_self->arches);
   g_clear_pointer (&copy->multilib, g_hash_table_unref);
-  copy->multilib = hash_table_str_set_copy (rpm_self->multilib);
+  if (rpm_self->sets_shared)
+    {
+      copy->arches = g_hash_table_ref (rpm_self->arches);
+      copy->multilib = g_hash_table_ref (rpm_self->multilib);
+      copy->sets_shared = TRUE;
+    }
+  else
+    {
+      copy->arches = hash_table_str_set_copy (rpm_self->arches);
+      copy->multilib = hash_table_str_set_copy (rpm_self->multilib);
+    }
 
   return MODULEMD_COMPONENT (g_steal_pointer (&copy));
 }
@@ -255,10 +270,18 @@ modulemd_component_rpm_get_name (ModulemdComponent *self)
 void
 modulemd_component_rpm_set_ref (ModulemdComponentRpm *self, const gchar *ref)
 {
+  gchar *interned = NULL;
+
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
-  g_clear_pointer (&self->ref, g_free);
-  self->ref = g_strdup (ref);
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  interned = modulemd_str_intern (ref);
+  g_clear_pointer (&self->ref, modulemd_str_release);
+  self->ref = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_REF]);
 }
@@ -277,10 +300,18 @@ void
 modulemd_component_rpm_set_cache (ModulemdComponentRpm *self,
                                   const gchar *cache)
 {
+  gchar *interned = NULL;
+
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
-  g_clear_pointer (&self->cache, g_free);
-  self->cache = g_strdup (cache);
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  interned = modulemd_str_intern (cache);
+  g_clear_pointer (&self->cache, modulemd_str_release);
+  self->cache = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CACHE]);
 }
@@ -299,10 +330,18 @@ void
 modulemd_component_rpm_set_repository (ModulemdComponentRpm *self,
                                        const gchar *repository)
 {
+  gchar *interned = NULL;
+
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
-  g_clear_pointer (&self->repository, g_free);
-  self->repository = g_strdup (repository);
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  interned = modulemd_str_intern (repository);
+  g_clear_pointer (&self->repository, modulemd_str_release);
+  self->repository = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_REPOSITORY]);
 }
@@ -323,6 +362,11 @@ modulemd_component_rpm_set_buildroot (ModulemdComponentRpm *self,
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
   self->buildroot = buildroot;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BUILDROOT]);
@@ -344,6 +388,11 @@ modulemd_component_rpm_set_srpm_buildroot (ModulemdComponentRpm *self,
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
   self->srpm_buildroot = srpm_buildroot;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SRPM_BUILDROOT]);
@@ -359,13 +408,41 @@ modulemd_component_rpm_get_srpm_buildroot (ModulemdComponentRpm *self)
 }
 
 
+static void
+modulemd_component_rpm_unshare_sets (ModulemdComponentRpm *self)
+{
+  GHashTable *set = NULL;
+
+  if (!self->sets_shared)
+    {
+      return;
+    }
+
+  set = hash_table_str_set_copy (self->arches);
+  g_hash_table_unref (self->arches);
+  self->arches = set;
+
+  set = hash_table_str_set_copy (self->multilib);
+  g_hash_table_unref (self->multilib);
+  self->multilib = set;
+
+  self->sets_shared = FALSE;
+}
+
+
 void
 modulemd_component_rpm_add_restricted_arch (ModulemdComponentRpm *self,
                                             const gchar *arch)
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
-  g_hash_table_add (self->arches, g_strdup (arch));
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  modulemd_component_rpm_unshare_sets (self);
+  g_hash_table_add (self->arches, modulemd_str_intern (arch));
 }
 
 
@@ -382,6 +459,12 @@ modulemd_component_rpm_clear_arches (ModulemdComponentRpm *self)
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  modulemd_component_rpm_unshare_sets (self);
   g_hash_table_remove_all (self->arches);
 }
 
@@ -402,7 +485,13 @@ modulemd_component_rpm_add_multilib_arch (ModulemdComponentRpm *self,
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
-  g_hash_table_add (self->multilib, g_strdup (arch));
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  modulemd_component_rpm_unshare_sets (self);
+  g_hash_table_add (self->multilib, modulemd_str_intern (arch));
 }
 
 /* Deprecated in favor of modulemd_component_rpm_clear_multilib_arches() */
@@ -418,6 +507,12 @@ modulemd_component_rpm_clear_multilib_arches (ModulemdComponentRpm *self)
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
 
+  if (!modulemd_component_will_change (MODULEMD_COMPONENT (self)))
+    {
+      return;
+    }
+
+  modulemd_component_rpm_unshare_sets (self);
   g_hash_table_remove_all (self->multilib);
 }
 
@@ -553,9 +648,8 @@ modulemd_component_rpm_class_init (ModulemdComponentRpmClass *klass)
 static void
 modulemd_component_rpm_init (ModulemdComponentRpm *self)
 {
-  self->arches = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-  self->multilib =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->arches = modulemd_str_set_new ();
+  self->multilib = modulemd_str_set_new ();
 }
 
 
@@ -586,13 +680,13 @@ modulemd_component_rpm_emit_yaml (ModulemdComponentRpm *self,
   /* Only output buildroot if it's TRUE */
   if (modulemd_component_rpm_get_buildroot (self))
     {
-      EMIT_KEY_VALUE (emitter, error, "buildroot", "true");
+      EMIT_KEY_VALUE_BOOLEAN (emitter, error, "buildroot", TRUE);
     }
 
   /* Only output srpm-buildroot if it's TRUE */
   if (modulemd_component_rpm_get_srpm_buildroot (self))
     {
-      EMIT_KEY_VALUE (emitter, error, "srpm-buildroot", "true");
+      EMIT_KEY_VALUE_BOOLEAN (emitter, error, "srpm-buildroot", TRUE);
     }
 
   if (!modulemd_component_emit_yaml_build_common (
@@ -892,3 +986,38 @@ modulemd_component_rpm_parse_yaml (yaml_parser_t *parser,
 
   return g_steal_pointer (&r);
 }
+
+
+void
+modulemd_component_rpm_add_memory_usage (ModulemdComponentRpm *self,
+                                         ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
+
+  modulemd_component_add_memory_usage (MODULEMD_COMPONENT (self), usage);
+  modulemd_memory_usage_add_string (usage, self->override_name);
+  modulemd_memory_usage_add_interned_string (usage, self->ref);
+  modulemd_memory_usage_add_interned_string (usage, self->repository);
+  modulemd_memory_usage_add_interned_string (usage, self->cache);
+  if (modulemd_memory_usage_claim (usage, self->arches))
+    {
+      modulemd_memory_usage_add_string_set (usage, self->arches);
+    }
+  if (modulemd_memory_usage_claim (usage, self->multilib))
+    {
+      modulemd_memory_usage_add_string_set (usage, self->multilib);
+    }
+}
+
+
+void
+modulemd_component_rpm_compact (ModulemdComponentRpm *self,
+                                ModulemdCompactor *compactor)
+{
+  g_return_if_fail (MODULEMD_IS_COMPONENT_RPM (self));
+
+  modulemd_component_compact (MODULEMD_COMPONENT (self), compactor);
+  modulemd_compactor_share_set (compactor, &self->arches);
+  modulemd_compactor_share_set (compactor, &self->multilib);
+  self->sets_shared = TRUE;
+}
@@ -16,6 +16,7 @@
 #include "modulemd-component.h"
 #include "modulemd-errors.h"
 #include "private/modulemd-component-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
 
@@ -28,6 +29,17 @@ typedef struct
   gboolean buildonly;
   gchar *name;
   gchar *rationale;
+
+  /* Set from modulemd_next_generation () by every setter */
+  guint64 generation;
+
+  /* Set by modulemd_component_freeze(); nothing may change afterwards */
+  gboolean frozen;
+
+  /* Set when buildafter may be referenced by another component, in which case
+   * it is copied before it is modified.
+   */
+  gboolean buildafter_shared;
 } ModulemdComponentPrivate;
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ModulemdComponent,
@@ -93,8 +105,8 @@ modulemd_component_finalize (GObject *object)
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
 
-  g_clear_pointer (&priv->name, g_free);
-  g_clear_pointer (&priv->rationale, g_free);
+  g_clear_pointer (&priv->name, modulemd_str_release);
+  g_clear_pointer (&priv->rationale, modulemd_str_release);
   g_clear_pointer (&priv->buildafter, g_hash_table_unref);
 
   G_OBJECT_CLASS (modulemd_component_parent_class)->finalize (object);
@@ -188,7 +200,16 @@ modulemd_component_copy_component (ModulemdComponent *self, const gchar *key)
 
   m_priv = modulemd_component_get_instance_private (m);
   g_clear_pointer (&m_priv->buildafter, g_hash_table_unref);
-  m_priv->buildafter = modulemd_hash_table_deep_set_copy (priv->buildafter);
+  if (priv->buildafter_shared)
+    {
+      m_priv->buildafter = g_hash_table_ref (priv->buildafter);
+      m_priv->buildafter_shared = TRUE;
+    }
+  else
+    {
+      m_priv->buildafter =
+        modulemd_hash_table_deep_set_copy (priv->buildafter);
+    }
 
   return g_steal_pointer (&m);
 }
@@ -233,15 +254,40 @@ modulemd_component_default_equals (ModulemdComponent *self_1,
 }
 
 
+static void
+modulemd_component_unshare_buildafter (ModulemdComponent *self)
+{
+  ModulemdComponentPrivate *priv =
+    modulemd_component_get_instance_private (self);
+  GHashTable *buildafter = NULL;
+
+  if (!priv->buildafter_shared)
+    {
+      return;
+    }
+
+  buildafter = modulemd_hash_table_deep_set_copy (priv->buildafter);
+  g_hash_table_unref (priv->buildafter);
+  priv->buildafter = buildafter;
+  priv->buildafter_shared = FALSE;
+}
+
+
 void
 modulemd_component_add_buildafter (ModulemdComponent *self, const gchar *key)
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT (self));
 
+  if (!modulemd_component_will_change (self))
+    {
+      return;
+    }
+
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
 
-  g_hash_table_add (priv->buildafter, g_strdup (key));
+  modulemd_component_unshare_buildafter (self);
+  g_hash_table_add (priv->buildafter, modulemd_str_intern (key));
 }
 
 void
@@ -249,9 +295,15 @@ modulemd_component_clear_buildafter (ModulemdComponent *self)
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT (self));
 
+  if (!modulemd_component_will_change (self))
+    {
+      return;
+    }
+
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
 
+  modulemd_component_unshare_buildafter (self);
   g_hash_table_remove_all (priv->buildafter);
 }
 
@@ -297,6 +349,11 @@ modulemd_component_set_buildonly (ModulemdComponent *self, gboolean buildonly)
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT (self));
 
+  if (!modulemd_component_will_change (self))
+    {
+      return;
+    }
+
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
 
@@ -323,6 +380,11 @@ modulemd_component_set_buildorder (ModulemdComponent *self, gint64 buildorder)
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT (self));
 
+  if (!modulemd_component_will_change (self))
+    {
+      return;
+    }
+
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
 
@@ -353,8 +415,12 @@ modulemd_component_set_key (ModulemdComponent *self, const gchar *name)
 
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
-  g_clear_pointer (&priv->name, g_free);
-  priv->name = g_strdup (name);
+  gchar *interned = NULL;
+
+  /* The same components are listed by every version of a module stream */
+  interned = modulemd_str_intern (name);
+  g_clear_pointer (&priv->name, modulemd_str_release);
+  priv->name = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_NAME]);
 }
@@ -372,6 +438,11 @@ modulemd_component_set_name (ModulemdComponent *self, const gchar *name)
       return;
     }
 
+  if (!modulemd_component_will_change (self))
+    {
+      return;
+    }
+
   klass->set_name (self, name);
 }
 
@@ -405,10 +476,19 @@ modulemd_component_set_rationale (ModulemdComponent *self,
 {
   g_return_if_fail (MODULEMD_IS_COMPONENT (self));
 
+  if (!modulemd_component_will_change (self))
+    {
+      return;
+    }
+
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
-  g_clear_pointer (&priv->rationale, g_free);
-  priv->rationale = g_strdup (rationale);
+  gchar *interned = NULL;
+
+  /* Builds for each architecture list the same components */
+  interned = modulemd_str_intern (rationale);
+  g_clear_pointer (&priv->rationale, modulemd_str_release);
+  priv->rationale = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_RATIONALE]);
 }
@@ -426,6 +506,44 @@ modulemd_component_get_rationale (ModulemdComponent *self)
 }
 
 
+gboolean
+modulemd_component_will_change (ModulemdComponent *self)
+{
+  ModulemdComponentPrivate *priv =
+    modulemd_component_get_instance_private (self);
+
+  g_return_val_if_fail (!priv->frozen, FALSE);
+
+  priv->generation = modulemd_next_generation ();
+
+  return TRUE;
+}
+
+
+guint64
+modulemd_component_get_generation (ModulemdComponent *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_COMPONENT (self), 0);
+
+  ModulemdComponentPrivate *priv =
+    modulemd_component_get_instance_private (self);
+
+  return priv->generation;
+}
+
+
+void
+modulemd_component_freeze (ModulemdComponent *self)
+{
+  g_return_if_fail (MODULEMD_IS_COMPONENT (self));
+
+  ModulemdComponentPrivate *priv =
+    modulemd_component_get_instance_private (self);
+
+  priv->frozen = TRUE;
+}
+
+
 static void
 modulemd_component_get_property (GObject *object,
                                  guint prop_id,
@@ -547,8 +665,7 @@ modulemd_component_init (ModulemdComponent *self)
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
 
-  priv->buildafter =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  priv->buildafter = modulemd_str_set_new ();
 }
 
 
@@ -659,24 +776,20 @@ modulemd_component_emit_yaml_build_common (ModulemdComponent *self,
   ModulemdComponentPrivate *priv =
     modulemd_component_get_instance_private (self);
 
-  g_autofree gchar *buildorder = NULL;
   g_autoptr (GPtrArray) buildafter = NULL;
 
   MODULEMD_INIT_TRACE ();
 
   if (modulemd_component_get_buildorder (self) != 0)
     {
-      buildorder =
-        g_strdup_printf ("%" PRId64, modulemd_component_get_buildorder (self));
-      ;
       if (!mmd_emitter_scalar (
             emitter, "buildorder", YAML_PLAIN_SCALAR_STYLE, error))
         {
           return FALSE;
         }
 
-      if (!mmd_emitter_scalar (
-            emitter, buildorder, YAML_PLAIN_SCALAR_STYLE, error))
+      if (!mmd_emitter_scalar_int64 (
+            emitter, modulemd_component_get_buildorder (self), error))
         {
           return FALSE;
         }
@@ -684,8 +797,7 @@ modulemd_component_emit_yaml_build_common (ModulemdComponent *self,
 
   else if (g_hash_table_size (priv->buildafter))
     {
-      buildafter =
-        modulemd_ordered_str_keys (priv->buildafter, modulemd_strcmp_sort);
+      buildafter = modulemd_sorted_str_keys (priv->buildafter);
 
       EMIT_SCALAR (emitter, error, "buildafter");
 
@@ -702,9 +814,43 @@ modulemd_component_emit_yaml_build_common (ModulemdComponent *self,
   /* Only output buildonly if it's TRUE */
   if (modulemd_component_get_buildonly (self))
     {
-      EMIT_SCALAR (emitter, error, "buildonly");
-      EMIT_SCALAR (emitter, error, "true");
+      EMIT_KEY_VALUE_BOOLEAN (emitter, error, "buildonly", TRUE);
     }
 
   return TRUE;
 }
+
+
+void
+modulemd_component_add_memory_usage (ModulemdComponent *self,
+                                     ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_COMPONENT (self));
+
+  ModulemdComponentPrivate *priv =
+    modulemd_component_get_instance_private (self);
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add (
+    usage, MD_MEMORY_CATEGORY_OBJECTS, sizeof (ModulemdComponentPrivate));
+  modulemd_memory_usage_add_interned_string (usage, priv->name);
+  modulemd_memory_usage_add_interned_string (usage, priv->rationale);
+  if (modulemd_memory_usage_claim (usage, priv->buildafter))
+    {
+      modulemd_memory_usage_add_string_set (usage, priv->buildafter);
+    }
+}
+
+
+void
+modulemd_component_compact (ModulemdComponent *self,
+                            ModulemdCompactor *compactor)
+{
+  g_return_if_fail (MODULEMD_IS_COMPONENT (self));
+
+  ModulemdComponentPrivate *priv =
+    modulemd_component_get_instance_private (self);
+
+  modulemd_compactor_share_set (compactor, &priv->buildafter);
+  priv->buildafter_shared = TRUE;
+}
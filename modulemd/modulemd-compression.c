@@ -11,10 +11,12 @@
  * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
  */
 
+#include "config.h"
 #include <errno.h>
 #include <fcntl.h>
 #include <glib.h>
 #include <inttypes.h>
+#include <string.h>
 #include <unistd.h>
 
 
@@ -22,6 +24,22 @@
 #include <rpm/rpmio.h>
 #endif
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_BZIP2
+#include <bzlib.h>
+#endif
+
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "modulemd-compression.h"
 #include "modulemd-errors.h"
 
@@ -120,6 +138,22 @@ modulemd_detect_compression (const gchar *filename, int fd, GError **error)
       return MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION;
     }
 
+  return modulemd_detect_compression_from_data (buffer, filled);
+}
+
+
+ModulemdCompressionTypeEnum
+modulemd_detect_compression_from_data (const guint8 *buffer, gsize len)
+{
+  g_return_val_if_fail (buffer || len == 0,
+                        MODULEMD_COMPRESSION_TYPE_DETECTION_FAILED);
+
+  /* gzip, bzip2, zstd have a 4-byte header. xz has a 6-byte header. */
+  if (len < 6)
+    {
+      return MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION;
+    }
+
   /* Now inspect the file content */
   if (buffer[0] == 0x1f && buffer[1] == 0x8b)
     /* RFC 1952. */
@@ -285,3 +319,695 @@ mmd_Fclose (FD_t fd)
 }
 
 #endif
+
+
+/* The decompression thread fills buffers of this size... */
+#define MMD_DECOMPRESS_CHUNK_SIZE (256 * 1024)
+/* ...and gets at most this many of them ahead of the reader. */
+#define MMD_DECOMPRESS_CHUNKS 4
+/* Compressed data is read from file descriptors in blocks of this size */
+#define MMD_DECOMPRESS_INPUT_SIZE (128 * 1024)
+
+typedef struct
+{
+  gsize len;
+  gsize pos;
+  gboolean eof;
+  guint8 data[];
+} mmd_decompress_chunk;
+
+struct _ModulemdDecompressor
+{
+  ModulemdCompressionTypeEnum comtype;
+
+  /* Compressed input, either read from fd or all of bytes */
+  int fd;
+  GBytes *bytes;
+  guint8 *in_buf;
+  const guint8 *in;
+  gsize in_len;
+  gsize in_pos;
+  gboolean in_eof;
+
+#ifdef HAVE_ZLIB
+  z_stream zs;
+  gboolean zs_initialized;
+#endif
+#ifdef HAVE_BZIP2
+  bz_stream bzs;
+  gboolean bzs_initialized;
+#endif
+#ifdef HAVE_LZMA
+  lzma_stream xzs;
+#endif
+#ifdef HAVE_ZSTD
+  ZSTD_DStream *zds;
+#endif
+
+  /* Chunks move from free_chunks to the decompression thread, then through
+   * filled_chunks to the reader and back to free_chunks.
+   */
+  GThread *thread;
+  GAsyncQueue *free_chunks;
+  GAsyncQueue *filled_chunks;
+  mmd_decompress_chunk *current;
+  gint cancelled;
+
+  /* Set by the decompression thread before it queues the final chunk */
+  GError *error;
+};
+
+
+gboolean
+modulemd_decompressor_supported (ModulemdCompressionTypeEnum comtype)
+{
+  switch (comtype)
+    {
+#ifdef HAVE_ZLIB
+    case MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION: return TRUE;
+#endif
+#ifdef HAVE_BZIP2
+    case MODULEMD_COMPRESSION_TYPE_BZ2_COMPRESSION: return TRUE;
+#endif
+#ifdef HAVE_LZMA
+    case MODULEMD_COMPRESSION_TYPE_XZ_COMPRESSION: return TRUE;
+#endif
+#ifdef HAVE_ZSTD
+    case MODULEMD_COMPRESSION_TYPE_ZSTD_COMPRESSION: return TRUE;
+#endif
+    default: return FALSE;
+    }
+}
+
+
+static gboolean
+decoder_init (ModulemdDecompressor *self, GError **error)
+{
+  switch (self->comtype)
+    {
+#ifdef HAVE_ZLIB
+    case MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION:
+      /* Accept both gzip and zlib headers */
+      if (inflateInit2 (&self->zs, 15 + 32) != Z_OK)
+        {
+          break;
+        }
+      self->zs_initialized = TRUE;
+      return TRUE;
+#endif
+
+#ifdef HAVE_BZIP2
+    case MODULEMD_COMPRESSION_TYPE_BZ2_COMPRESSION:
+      if (BZ2_bzDecompressInit (&self->bzs, 0, 0) != BZ_OK)
+        {
+          break;
+        }
+      self->bzs_initialized = TRUE;
+      return TRUE;
+#endif
+
+#ifdef HAVE_LZMA
+    case MODULEMD_COMPRESSION_TYPE_XZ_COMPRESSION:
+      {
+#if LZMA_VERSION >= 50040002U
+        /* Blocks of multi-block files are decoded on several threads. The
+         * memory limit for that matches the xz(1) default.
+         */
+        lzma_mt mt = { 0 };
+
+        mt.flags = LZMA_CONCATENATED;
+        mt.threads = g_get_num_processors ();
+        mt.memlimit_threading = MAX (lzma_physmem () / 4, 1);
+        mt.memlimit_stop = UINT64_MAX;
+
+        if (lzma_stream_decoder_mt (&self->xzs, &mt) != LZMA_OK)
+          {
+            break;
+          }
+#else
+        if (lzma_stream_decoder (&self->xzs, UINT64_MAX, LZMA_CONCATENATED) !=
+            LZMA_OK)
+          {
+            break;
+          }
+#endif
+        return TRUE;
+      }
+#endif
+
+#ifdef HAVE_ZSTD
+    case MODULEMD_COMPRESSION_TYPE_ZSTD_COMPRESSION:
+      self->zds = ZSTD_createDStream ();
+      if (!self->zds || ZSTD_isError (ZSTD_initDStream (self->zds)))
+        {
+          break;
+        }
+      return TRUE;
+#endif
+
+    default:
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_NOT_IMPLEMENTED,
+                   "No native decompression support for compression type %d",
+                   self->comtype);
+      return FALSE;
+    }
+
+  g_set_error (error,
+               MODULEMD_ERROR,
+               MMD_ERROR_FILE_ACCESS,
+               "Could not initialize the %s decompressor",
+               modulemd_compression_suffix (self->comtype));
+  return FALSE;
+}
+
+
+/* Prepares the decoder for another compressed stream concatenated to the
+ * previous one. xz and zstd handle that by themselves.
+ */
+static gboolean
+decoder_reset (ModulemdDecompressor *self, GError **error)
+{
+  switch (self->comtype)
+    {
+#ifdef HAVE_ZLIB
+    case MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION:
+      if (inflateReset (&self->zs) != Z_OK)
+        {
+          break;
+        }
+      return TRUE;
+#endif
+
+#ifdef HAVE_BZIP2
+    case MODULEMD_COMPRESSION_TYPE_BZ2_COMPRESSION:
+      BZ2_bzDecompressEnd (&self->bzs);
+      if (BZ2_bzDecompressInit (&self->bzs, 0, 0) != BZ_OK)
+        {
+          self->bzs_initialized = FALSE;
+          break;
+        }
+      return TRUE;
+#endif
+
+    default: return TRUE;
+    }
+
+  g_set_error (error,
+               MODULEMD_ERROR,
+               MMD_ERROR_FILE_ACCESS,
+               "Could not reset the %s decompressor",
+               modulemd_compression_suffix (self->comtype));
+  return FALSE;
+}
+
+
+/*
+ * decoder_step:
+ * @self: (in): This #ModulemdDecompressor.
+ * @out: (out): The buffer to decompress into.
+ * @out_len: (in): The size of @out.
+ * @produced: (out): The number of bytes written to @out.
+ * @stream_end: (out): Whether the end of a compressed stream was reached.
+ * @error: (out): A #GError containing the reason this function failed.
+ *
+ * Decompresses as much of the pending input as fits into @out and advances
+ * the input position accordingly.
+ *
+ * Returns: TRUE if the data could be decompressed.
+ */
+static gboolean
+decoder_step (ModulemdDecompressor *self,
+              guint8 *out,
+              gsize out_len,
+              gsize *produced,
+              gboolean *stream_end,
+              GError **error)
+{
+  const guint8 *in = self->in + self->in_pos;
+  gsize in_len = self->in_len - self->in_pos;
+  gsize consumed = 0;
+  const gchar *reason = NULL;
+
+  *produced = 0;
+  *stream_end = FALSE;
+
+  switch (self->comtype)
+    {
+#ifdef HAVE_ZLIB
+    case MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION:
+      {
+        int ret;
+
+        self->zs.next_in = (Bytef *)in;
+        self->zs.avail_in = (uInt)MIN (in_len, G_MAXUINT);
+        self->zs.next_out = out;
+        self->zs.avail_out = (uInt)MIN (out_len, G_MAXUINT);
+
+        ret = inflate (&self->zs, Z_NO_FLUSH);
+        consumed = (gsize)(self->zs.next_in - in);
+        *produced = (gsize)(self->zs.next_out - out);
+
+        if (ret == Z_STREAM_END)
+          {
+            *stream_end = TRUE;
+          }
+        else if (ret != Z_OK && ret != Z_BUF_ERROR)
+          {
+            reason = self->zs.msg ? self->zs.msg : "corrupted data";
+          }
+        break;
+      }
+#endif
+
+#ifdef HAVE_BZIP2
+    case MODULEMD_COMPRESSION_TYPE_BZ2_COMPRESSION:
+      {
+        int ret;
+
+        self->bzs.next_in = (char *)in;
+        self->bzs.avail_in = (unsigned int)MIN (in_len, G_MAXUINT);
+        self->bzs.next_out = (char *)out;
+        self->bzs.avail_out = (unsigned int)MIN (out_len, G_MAXUINT);
+
+        ret = BZ2_bzDecompress (&self->bzs);
+        consumed = (gsize)((const guint8 *)self->bzs.next_in - in);
+        *produced = (gsize)((guint8 *)self->bzs.next_out - out);
+
+        if (ret == BZ_STREAM_END)
+          {
+            *stream_end = TRUE;
+          }
+        else if (ret != BZ_OK)
+          {
+            reason = "corrupted data";
+          }
+        break;
+      }
+#endif
+
+#ifdef HAVE_LZMA
+    case MODULEMD_COMPRESSION_TYPE_XZ_COMPRESSION:
+      {
+        lzma_ret ret;
+
+        self->xzs.next_in = in;
+        self->xzs.avail_in = in_len;
+        self->xzs.next_out = out;
+        self->xzs.avail_out = out_len;
+
+        /* With LZMA_CONCATENATED, the end of the input must be announced */
+        ret = lzma_code (&self->xzs, self->in_eof ? LZMA_FINISH : LZMA_RUN);
+        consumed = (gsize)(self->xzs.next_in - in);
+        *produced = (gsize)(self->xzs.next_out - out);
+
+        if (ret == LZMA_STREAM_END)
+          {
+            *stream_end = TRUE;
+          }
+        else if (ret != LZMA_OK && ret != LZMA_BUF_ERROR)
+          {
+            reason =
+              ret == LZMA_MEM_ERROR ? "out of memory" : "corrupted data";
+          }
+        break;
+      }
+#endif
+
+#ifdef HAVE_ZSTD
+    case MODULEMD_COMPRESSION_TYPE_ZSTD_COMPRESSION:
+      {
+        ZSTD_inBuffer input = { in, in_len, 0 };
+        ZSTD_outBuffer output = { out, out_len, 0 };
+        size_t ret;
+
+        ret = ZSTD_decompressStream (self->zds, &output, &input);
+        consumed = input.pos;
+        *produced = output.pos;
+
+        if (ZSTD_isError (ret))
+          {
+            reason = ZSTD_getErrorName (ret);
+          }
+        else if (ret == 0)
+          {
+            /* A frame was completely decoded and flushed */
+            *stream_end = TRUE;
+          }
+        break;
+      }
+#endif
+
+    default: g_return_val_if_reached (FALSE);
+    }
+
+  self->in_pos += consumed;
+
+  if (reason)
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_FILE_ACCESS,
+                   "Could not decompress %s data: %s",
+                   modulemd_compression_suffix (self->comtype),
+                   reason);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+static void
+decoder_end (ModulemdDecompressor *self)
+{
+#ifdef HAVE_ZLIB
+  if (self->zs_initialized)
+    {
+      inflateEnd (&self->zs);
+      self->zs_initialized = FALSE;
+    }
+#endif
+#ifdef HAVE_BZIP2
+  if (self->bzs_initialized)
+    {
+      BZ2_bzDecompressEnd (&self->bzs);
+      self->bzs_initialized = FALSE;
+    }
+#endif
+#ifdef HAVE_LZMA
+  lzma_end (&self->xzs);
+#endif
+#ifdef HAVE_ZSTD
+  g_clear_pointer (&self->zds, ZSTD_freeDStream);
+#endif
+}
+
+
+/* Reads the next block of compressed data. Sets in_eof at the end of the
+ * input.
+ */
+static gboolean
+refill_input (ModulemdDecompressor *self, GError **error)
+{
+  ssize_t ret;
+
+  if (self->fd < 0)
+    {
+      self->in_eof = TRUE;
+      return TRUE;
+    }
+
+  do
+    {
+      ret = read (self->fd, self->in_buf, MMD_DECOMPRESS_INPUT_SIZE);
+    }
+  while (ret < 0 && errno == EINTR);
+
+  if (ret < 0)
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_FILE_ACCESS,
+                   "Could not read compressed data: %s",
+                   g_strerror (errno));
+      return FALSE;
+    }
+
+  self->in = self->in_buf;
+  self->in_len = (gsize)ret;
+  self->in_pos = 0;
+  self->in_eof = ret == 0;
+
+  return TRUE;
+}
+
+
+static gpointer
+decompress_thread (gpointer data)
+{
+  ModulemdDecompressor *self = (ModulemdDecompressor *)data;
+  mmd_decompress_chunk *chunk = g_async_queue_pop (self->free_chunks);
+  gboolean stream_end = FALSE;
+  gsize produced;
+  g_autoptr (GError) error = NULL;
+
+  while (!g_atomic_int_get (&self->cancelled))
+    {
+      if (self->in_pos == self->in_len && !self->in_eof)
+        {
+          if (!refill_input (self, &error))
+            {
+              break;
+            }
+          continue;
+        }
+
+      if (stream_end)
+        {
+          if (self->in_pos == self->in_len)
+            {
+              /* All input was consumed at a stream boundary */
+              break;
+            }
+
+          if (!decoder_reset (self, &error))
+            {
+              break;
+            }
+        }
+
+      if (!decoder_step (self,
+                         chunk->data + chunk->len,
+                         MMD_DECOMPRESS_CHUNK_SIZE - chunk->len,
+                         &produced,
+                         &stream_end,
+                         &error))
+        {
+          break;
+        }
+      chunk->len += produced;
+
+      if (chunk->len == MMD_DECOMPRESS_CHUNK_SIZE)
+        {
+          g_async_queue_push (self->filled_chunks, chunk);
+          chunk = g_async_queue_pop (self->free_chunks);
+        }
+      else if (!stream_end && produced == 0 && self->in_eof &&
+               self->in_pos == self->in_len)
+        {
+          /* The decoder needs more input, but there is none left */
+          g_set_error (&error,
+                       MODULEMD_ERROR,
+                       MMD_ERROR_FILE_ACCESS,
+                       "Could not decompress %s data: unexpected end of input",
+                       modulemd_compression_suffix (self->comtype));
+          break;
+        }
+    }
+
+  self->error = g_steal_pointer (&error);
+
+  chunk->eof = TRUE;
+  g_async_queue_push (self->filled_chunks, chunk);
+
+  return NULL;
+}
+
+
+static ModulemdDecompressor *
+decompressor_new (ModulemdCompressionTypeEnum comtype,
+                  int fd,
+                  GBytes *bytes,
+                  GError **error)
+{
+  g_autoptr (ModulemdDecompressor) self = NULL;
+
+  self = g_new0 (ModulemdDecompressor, 1);
+  self->comtype = comtype;
+  self->fd = fd;
+#ifdef HAVE_LZMA
+  self->xzs = (lzma_stream)LZMA_STREAM_INIT;
+#endif
+  self->free_chunks = g_async_queue_new ();
+  self->filled_chunks = g_async_queue_new ();
+
+  if (!decoder_init (self, error))
+    {
+      return NULL;
+    }
+
+  if (bytes)
+    {
+      /* The whole input is available up front */
+      self->bytes = g_bytes_ref (bytes);
+      self->in = g_bytes_get_data (bytes, &self->in_len);
+      self->in_eof = TRUE;
+    }
+  else
+    {
+      self->in_buf = g_malloc (MMD_DECOMPRESS_INPUT_SIZE);
+      self->in = self->in_buf;
+    }
+
+  for (gsize i = 0; i < MMD_DECOMPRESS_CHUNKS; i++)
+    {
+      g_async_queue_push (
+        self->free_chunks,
+        g_malloc0 (sizeof (mmd_decompress_chunk) + MMD_DECOMPRESS_CHUNK_SIZE));
+    }
+
+  self->thread = g_thread_try_new (
+    "modulemd-decompress", decompress_thread, self, error);
+  if (!self->thread)
+    {
+      return NULL;
+    }
+
+  return g_steal_pointer (&self);
+}
+
+
+ModulemdDecompressor *
+modulemd_decompressor_new_for_fd (ModulemdCompressionTypeEnum comtype,
+                                  int fd,
+                                  GError **error)
+{
+  g_return_val_if_fail (fd >= 0, NULL);
+
+  return decompressor_new (comtype, fd, NULL, error);
+}
+
+
+ModulemdDecompressor *
+modulemd_decompressor_new_for_bytes (ModulemdCompressionTypeEnum comtype,
+                                     GBytes *bytes,
+                                     GError **error)
+{
+  g_return_val_if_fail (bytes, NULL);
+
+  return decompressor_new (comtype, -1, bytes, error);
+}
+
+
+/* Returns the chunk to read from next, waiting for the decompression thread
+ * if necessary. Returns the final chunk once all data has been read.
+ */
+static mmd_decompress_chunk *
+next_chunk (ModulemdDecompressor *self)
+{
+  mmd_decompress_chunk *chunk = self->current;
+
+  while (!chunk || (chunk->pos == chunk->len && !chunk->eof))
+    {
+      if (chunk)
+        {
+          chunk->len = 0;
+          chunk->pos = 0;
+          g_async_queue_push (self->free_chunks, chunk);
+        }
+      chunk = self->current = g_async_queue_pop (self->filled_chunks);
+    }
+
+  return chunk;
+}
+
+
+gint
+modulemd_decompressor_read_fn (void *data,
+                               unsigned char *buffer,
+                               size_t size,
+                               size_t *size_read)
+{
+  ModulemdDecompressor *self = (ModulemdDecompressor *)data;
+  mmd_decompress_chunk *chunk = NULL;
+  gsize len;
+
+  if (!self->thread)
+    {
+      /* Already closed */
+      return 0;
+    }
+
+  chunk = next_chunk (self);
+  if (chunk->pos == chunk->len)
+    {
+      *size_read = 0;
+      return self->error ? 0 : 1;
+    }
+
+  len = MIN (size, chunk->len - chunk->pos);
+  memcpy (buffer, chunk->data + chunk->pos, len);
+  chunk->pos += len;
+  *size_read = len;
+
+  return 1;
+}
+
+
+gboolean
+modulemd_decompressor_close (ModulemdDecompressor *self, GError **error)
+{
+  g_return_val_if_fail (self, FALSE);
+
+  if (self->thread)
+    {
+      /* Stop the decompression thread early if the reader gave up, and
+       * recycle chunks until it has queued the final one.
+       */
+      g_atomic_int_set (&self->cancelled, 1);
+      while (!self->current || !self->current->eof)
+        {
+          if (self->current)
+            {
+              self->current->len = 0;
+              self->current->pos = 0;
+              g_async_queue_push (self->free_chunks, self->current);
+            }
+          self->current = g_async_queue_pop (self->filled_chunks);
+        }
+
+      g_thread_join (self->thread);
+      self->thread = NULL;
+    }
+
+  if (self->error)
+    {
+      g_propagate_error (error, g_steal_pointer (&self->error));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+void
+modulemd_decompressor_free (ModulemdDecompressor *self)
+{
+  gpointer chunk;
+
+  if (!self)
+    {
+      return;
+    }
+
+  modulemd_decompressor_close (self, NULL);
+
+  g_clear_pointer (&self->current, g_free);
+  while ((chunk = g_async_queue_try_pop (self->free_chunks)))
+    {
+      g_free (chunk);
+    }
+  while ((chunk = g_async_queue_try_pop (self->filled_chunks)))
+    {
+      g_free (chunk);
+    }
+  g_async_queue_unref (self->free_chunks);
+  g_async_queue_unref (self->filled_chunks);
+
+  decoder_end (self);
+  g_free (self->in_buf);
+  g_clear_pointer (&self->bytes, g_bytes_unref);
+  g_free (self);
+}
@@ -15,6 +15,7 @@
 #include "modulemd-errors.h"
 #include "private/modulemd-defaults-private.h"
 #include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-subdocument-info-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
@@ -191,6 +192,11 @@ modulemd_defaults_v1_set_default_stream (ModulemdDefaultsV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_DEFAULTS_V1 (self));
 
+  if (!modulemd_defaults_will_change (MODULEMD_DEFAULTS (self)))
+    {
+      return;
+    }
+
   if (default_stream)
     {
       if (intent)
@@ -264,6 +270,23 @@ modulemd_defaults_v1_get_default_stream (ModulemdDefaultsV1 *self,
 }
 
 
+void
+modulemd_defaults_v1_collect_intents (ModulemdDefaultsV1 *self,
+                                      GHashTable *intents)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  g_return_if_fail (MODULEMD_IS_DEFAULTS_V1 (self));
+
+  g_hash_table_iter_init (&iter, self->intent_default_streams);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      g_hash_table_add (intents, key);
+    }
+}
+
+
 GStrv
 modulemd_defaults_v1_get_streams_with_default_profiles_as_strv (
   ModulemdDefaultsV1 *self, const gchar *intent)
@@ -333,6 +356,11 @@ modulemd_defaults_v1_add_or_clear_default_profile_for_stream (
   g_return_if_fail (MODULEMD_IS_DEFAULTS_V1 (self));
   g_return_if_fail (stream_name);
 
+  if (!modulemd_defaults_will_change (MODULEMD_DEFAULTS (self)))
+    {
+      return;
+    }
+
 
   profile_table = g_hash_table_ref (
     modulemd_defaults_v1_get_or_create_profile_table (self, intent));
@@ -347,7 +375,7 @@ modulemd_defaults_v1_add_or_clear_default_profile_for_stream (
   else
     {
       /* A profile set for this stream doesn't exist yet. Create it. */
-      profiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      profiles = modulemd_str_set_new ();
 
       /* Add the new profile set back to the profile table */
       g_hash_table_replace (
@@ -360,7 +388,7 @@ modulemd_defaults_v1_add_or_clear_default_profile_for_stream (
        * reference to the internal value, we don't need to explicitly save this
        * back
        */
-      g_hash_table_add (profiles, g_strdup (profile_name));
+      g_hash_table_add (profiles, modulemd_str_intern (profile_name));
     }
   else
     {
@@ -406,6 +434,11 @@ modulemd_defaults_v1_remove_default_profiles_for_stream (
   g_return_if_fail (MODULEMD_IS_DEFAULTS_V1 (self));
   g_return_if_fail (stream_name);
 
+  if (!modulemd_defaults_will_change (MODULEMD_DEFAULTS (self)))
+    {
+      return;
+    }
+
   profile_table = g_hash_table_ref (
     modulemd_defaults_v1_get_or_create_profile_table (self, intent));
 
@@ -980,7 +1013,6 @@ modulemd_defaults_v1_emit_yaml (ModulemdDefaultsV1 *self,
   MODULEMD_INIT_TRACE ();
   g_autoptr (GError) nested_error = NULL;
   guint64 modified;
-  g_autofree gchar *modified_string = NULL;
 
   if (!modulemd_defaults_validate (MODULEMD_DEFAULTS (self), &nested_error))
     {
@@ -1027,8 +1059,7 @@ modulemd_defaults_v1_emit_yaml (ModulemdDefaultsV1 *self,
   modified = modulemd_defaults_get_modified (MODULEMD_DEFAULTS (self));
   if (modified)
     {
-      modified_string = g_strdup_printf ("%" PRIu64, modified);
-      EMIT_KEY_VALUE (emitter, error, "modified", modified_string);
+      EMIT_KEY_VALUE_UINT64 (emitter, error, "modified", modified);
     }
 
   /* The default stream is optional
@@ -1109,8 +1140,7 @@ modulemd_defaults_v1_emit_profiles (GHashTable *profile_table,
     }
 
 
-  stream_names =
-    modulemd_ordered_str_keys (profile_table, modulemd_strcmp_sort);
+  stream_names = modulemd_sorted_str_keys (profile_table);
   for (guint i = 0; i < stream_names->len; i++)
     {
       stream_name = g_ptr_array_index (stream_names, i);
@@ -1191,7 +1221,7 @@ modulemd_defaults_v1_emit_intents (ModulemdDefaultsV1 *self,
       g_hash_table_add (intent_names, key);
     }
 
-  intents = modulemd_ordered_str_keys (intent_names, modulemd_strcmp_sort);
+  intents = modulemd_sorted_str_keys (intent_names);
   g_clear_pointer (&intent_names, g_hash_table_unref);
 
   for (guint i = 0; i < intents->len; i++)
@@ -1559,3 +1589,29 @@ modulemd_defaults_v1_merge_default_profiles (
 
   return TRUE;
 }
+
+
+void
+modulemd_defaults_v1_add_memory_usage (ModulemdDefaultsV1 *self,
+                                       ModulemdMemoryUsage *usage)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_DEFAULTS_V1 (self));
+
+  modulemd_defaults_add_memory_usage (MODULEMD_DEFAULTS (self), usage);
+  modulemd_memory_usage_add_string (usage, self->default_stream);
+  modulemd_memory_usage_add_nested_set (usage, self->profile_defaults);
+  modulemd_memory_usage_add_string_map (usage, self->intent_default_streams);
+
+  /* Maps each intent to a table of the default profiles of each stream */
+  modulemd_memory_usage_add_hash_table (usage, self->intent_default_profiles);
+  g_hash_table_iter_init (&iter, self->intent_default_profiles);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_memory_usage_add_nested_set (usage, value);
+    }
+}
@@ -17,6 +17,7 @@
 #include "modulemd-errors.h"
 #include "private/modulemd-defaults-private.h"
 #include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-util.h"
 #include <inttypes.h>
 
@@ -26,6 +27,9 @@ typedef struct
 {
   gchar *module_name;
   guint64 modified;
+
+  /* Set by modulemd_defaults_freeze(); nothing may change afterwards */
+  gboolean frozen;
 } ModulemdDefaultsPrivate;
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ModulemdDefaults,
@@ -269,11 +273,40 @@ modulemd_defaults_get_mdversion (ModulemdDefaults *self)
   return klass->get_mdversion (self);
 }
 
+gboolean
+modulemd_defaults_will_change (ModulemdDefaults *self)
+{
+  ModulemdDefaultsPrivate *priv =
+    modulemd_defaults_get_instance_private (self);
+
+  g_return_val_if_fail (!priv->frozen, FALSE);
+
+  return TRUE;
+}
+
+
+void
+modulemd_defaults_freeze (ModulemdDefaults *self)
+{
+  g_return_if_fail (MODULEMD_IS_DEFAULTS (self));
+
+  ModulemdDefaultsPrivate *priv =
+    modulemd_defaults_get_instance_private (self);
+
+  priv->frozen = TRUE;
+}
+
+
 void
 modulemd_defaults_set_modified (ModulemdDefaults *self, guint64 modified)
 {
   g_return_if_fail (MODULEMD_IS_DEFAULTS (self));
 
+  if (!modulemd_defaults_will_change (self))
+    {
+      return;
+    }
+
   ModulemdDefaultsPrivate *priv =
     modulemd_defaults_get_instance_private (self);
   priv->modified = modified;
@@ -304,6 +337,11 @@ modulemd_defaults_set_module_name (ModulemdDefaults *self,
   /* It is a coding error if we ever get the default name here */
   g_return_if_fail (g_strcmp0 (module_name, DEF_DEFAULT_NAME_STRING));
 
+  if (!modulemd_defaults_will_change (self))
+    {
+      return;
+    }
+
   ModulemdDefaultsPrivate *priv =
     modulemd_defaults_get_instance_private (self);
 
@@ -452,3 +490,19 @@ modulemd_defaults_merge (ModulemdDefaults *from,
 
   return g_steal_pointer (&merged_defaults);
 }
+
+
+void
+modulemd_defaults_add_memory_usage (ModulemdDefaults *self,
+                                    ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_DEFAULTS (self));
+
+  ModulemdDefaultsPrivate *priv =
+    modulemd_defaults_get_instance_private (self);
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add (
+    usage, MD_MEMORY_CATEGORY_OBJECTS, sizeof (ModulemdDefaultsPrivate));
+  modulemd_memory_usage_add_string (usage, priv->module_name);
+}
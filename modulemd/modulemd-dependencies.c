@@ -18,6 +18,7 @@
 #include "modulemd-errors.h"
 #include "private/glib-extensions.h"
 #include "private/modulemd-dependencies-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
 
@@ -34,6 +35,16 @@ struct _ModulemdDependencies
    * @value: #GHashTable set of compatible streams
    */
   GHashTable *runtime_deps;
+
+  /* Set from modulemd_next_generation () by every setter */
+  guint64 generation;
+
+  /* Set by modulemd_dependencies_freeze(); nothing may change afterwards */
+  gboolean frozen;
+  /* Set when both tables may be referenced by other dependencies, in which
+   * case they are copied before either is modified.
+   */
+  gboolean tables_shared;
 };
 
 G_DEFINE_TYPE (ModulemdDependencies, modulemd_dependencies, G_TYPE_OBJECT)
@@ -80,6 +91,31 @@ modulemd_dependencies_equals (ModulemdDependencies *self_1,
 }
 
 
+static GHashTable *
+modulemd_dependencies_nested_table_copy (GHashTable *table)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  GHashTable *copy = NULL;
+
+  copy = g_hash_table_new_full (g_str_hash,
+                                modulemd_str_equal,
+                                modulemd_str_release,
+                                (GDestroyNotify)g_hash_table_destroy);
+
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      g_hash_table_insert (copy,
+                           modulemd_str_intern ((const gchar *)key),
+                           modulemd_hash_table_deep_set_copy (value));
+    }
+
+  return copy;
+}
+
+
 ModulemdDependencies *
 modulemd_dependencies_copy (ModulemdDependencies *self)
 {
@@ -89,9 +125,20 @@ modulemd_dependencies_copy (ModulemdDependencies *self)
   d = modulemd_dependencies_new ();
 
   g_hash_table_unref (d->buildtime_deps);
-  d->buildtime_deps = g_hash_table_ref (self->buildtime_deps);
   g_hash_table_unref (d->runtime_deps);
-  d->runtime_deps = g_hash_table_ref (self->runtime_deps);
+  if (self->tables_shared)
+    {
+      d->buildtime_deps = g_hash_table_ref (self->buildtime_deps);
+      d->runtime_deps = g_hash_table_ref (self->runtime_deps);
+      d->tables_shared = TRUE;
+    }
+  else
+    {
+      d->buildtime_deps =
+        modulemd_dependencies_nested_table_copy (self->buildtime_deps);
+      d->runtime_deps =
+        modulemd_dependencies_nested_table_copy (self->runtime_deps);
+    }
 
   return g_steal_pointer (&d);
 }
@@ -113,8 +160,6 @@ static GHashTable *
 modulemd_dependencies_nested_table_get_or_create (GHashTable *table,
                                                   const gchar *key)
 {
-  g_autofree gchar *keyi = NULL;
-
   GHashTable *inner = NULL;
   inner = g_hash_table_lookup (table, key);
   if (inner != NULL)
@@ -122,12 +167,8 @@ modulemd_dependencies_nested_table_get_or_create (GHashTable *table,
       return inner;
     }
 
-  // We know that the hash table will end up holding on to it for us.
-  keyi = g_strdup (key);
-
-  inner = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-  g_hash_table_insert (table, keyi, inner);
-  keyi = NULL;
+  inner = modulemd_str_set_new ();
+  g_hash_table_insert (table, modulemd_str_intern (key), inner);
   return inner;
 }
 
@@ -142,7 +183,7 @@ modulemd_dependencies_nested_table_add (GHashTable *table,
   g_return_if_fail (inner);
   if (value != NULL)
     {
-      g_hash_table_add (inner, g_strdup (value));
+      g_hash_table_add (inner, modulemd_str_intern (value));
     }
 }
 
@@ -161,6 +202,50 @@ modulemd_dependencies_nested_table_values_as_strv (GHashTable *table,
 }
 
 
+static gboolean
+modulemd_dependencies_will_change (ModulemdDependencies *self)
+{
+  GHashTable *table = NULL;
+
+  g_return_val_if_fail (!self->frozen, FALSE);
+
+  self->generation = modulemd_next_generation ();
+
+  if (self->tables_shared)
+    {
+      table = modulemd_dependencies_nested_table_copy (self->buildtime_deps);
+      g_hash_table_unref (self->buildtime_deps);
+      self->buildtime_deps = table;
+
+      table = modulemd_dependencies_nested_table_copy (self->runtime_deps);
+      g_hash_table_unref (self->runtime_deps);
+      self->runtime_deps = table;
+
+      self->tables_shared = FALSE;
+    }
+
+  return TRUE;
+}
+
+
+guint64
+modulemd_dependencies_get_generation (ModulemdDependencies *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_DEPENDENCIES (self), 0);
+
+  return self->generation;
+}
+
+
+void
+modulemd_dependencies_freeze (ModulemdDependencies *self)
+{
+  g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
+
+  self->frozen = TRUE;
+}
+
+
 void
 modulemd_dependencies_add_buildtime_stream (ModulemdDependencies *self,
                                             const gchar *module_name,
@@ -169,6 +254,12 @@ modulemd_dependencies_add_buildtime_stream (ModulemdDependencies *self,
   g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
   g_return_if_fail (module_name);
   g_return_if_fail (module_stream);
+
+  if (!modulemd_dependencies_will_change (self))
+    {
+      return;
+    }
+
   modulemd_dependencies_nested_table_add (
     self->buildtime_deps, module_name, module_stream);
 }
@@ -180,6 +271,12 @@ modulemd_dependencies_set_empty_buildtime_dependencies_for_module (
 {
   g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
   g_return_if_fail (module_name);
+
+  if (!modulemd_dependencies_will_change (self))
+    {
+      return;
+    }
+
   modulemd_dependencies_nested_table_add (
     self->buildtime_deps, module_name, NULL);
 }
@@ -189,6 +286,12 @@ void
 modulemd_dependencies_clear_buildtime_dependencies (ModulemdDependencies *self)
 {
   g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
+
+  if (!modulemd_dependencies_will_change (self))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->buildtime_deps);
 }
 
@@ -220,6 +323,12 @@ modulemd_dependencies_add_runtime_stream (ModulemdDependencies *self,
   g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
   g_return_if_fail (module_name);
   g_return_if_fail (module_stream);
+
+  if (!modulemd_dependencies_will_change (self))
+    {
+      return;
+    }
+
   modulemd_dependencies_nested_table_add (
     self->runtime_deps, module_name, module_stream);
 }
@@ -231,6 +340,12 @@ modulemd_dependencies_set_empty_runtime_dependencies_for_module (
 {
   g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
   g_return_if_fail (module_name);
+
+  if (!modulemd_dependencies_will_change (self))
+    {
+      return;
+    }
+
   modulemd_dependencies_nested_table_add (
     self->runtime_deps, module_name, NULL);
 }
@@ -240,6 +355,12 @@ void
 modulemd_dependencies_clear_runtime_dependencies (ModulemdDependencies *self)
 {
   g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
+
+  if (!modulemd_dependencies_will_change (self))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->runtime_deps);
 }
 
@@ -278,7 +399,7 @@ modulemd_dependencies_validate_deps (GHashTable *deps, GError **error)
     {
       module_name = (gchar *)key;
       /* The value is a set of strings. Get it and check them all */
-      set = modulemd_ordered_str_keys (value, modulemd_strcmp_sort);
+      set = modulemd_sorted_str_keys (value);
 
       /* An empty set is always valid */
       if (set->len == 0)
@@ -380,10 +501,19 @@ modulemd_dependencies_class_init (ModulemdDependenciesClass *klass)
 static void
 modulemd_dependencies_init (ModulemdDependencies *self)
 {
-  self->buildtime_deps = g_hash_table_new_full (
-    g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_hash_table_destroy);
-  self->runtime_deps = g_hash_table_new_full (
-    g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_hash_table_destroy);
+  /* The module names are interned like the stream names in the sets, to
+   * match the tables built by modulemd_yaml_parse_nested_set()
+   */
+  self->buildtime_deps =
+    g_hash_table_new_full (g_str_hash,
+                           modulemd_str_equal,
+                           modulemd_str_release,
+                           (GDestroyNotify)g_hash_table_destroy);
+  self->runtime_deps =
+    g_hash_table_new_full (g_str_hash,
+                           modulemd_str_equal,
+                           modulemd_str_release,
+                           (GDestroyNotify)g_hash_table_destroy);
 }
 
 /* === YAML Functions === */
@@ -622,3 +752,51 @@ modulemd_dependencies_buildrequires_module_and_stream (
   return requires_module_and_stream (
     self->buildtime_deps, module_name, stream_name);
 }
+
+
+static void
+add_deps_memory_usage (GHashTable *deps, ModulemdMemoryUsage *usage)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  if (!modulemd_memory_usage_claim (usage, deps))
+    {
+      return;
+    }
+
+  /* Unlike other nested sets, the module names are interned */
+  modulemd_memory_usage_add_hash_table (usage, deps);
+
+  g_hash_table_iter_init (&iter, deps);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_interned_string (usage, key);
+      modulemd_memory_usage_add_string_set (usage, value);
+    }
+}
+
+
+void
+modulemd_dependencies_add_memory_usage (ModulemdDependencies *self,
+                                        ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  add_deps_memory_usage (self->buildtime_deps, usage);
+  add_deps_memory_usage (self->runtime_deps, usage);
+}
+
+
+void
+modulemd_dependencies_compact (ModulemdDependencies *self,
+                               ModulemdCompactor *compactor)
+{
+  g_return_if_fail (MODULEMD_IS_DEPENDENCIES (self));
+
+  modulemd_compactor_share_table (compactor, &self->buildtime_deps);
+  modulemd_compactor_share_table (compactor, &self->runtime_deps);
+  self->tables_shared = TRUE;
+}
@@ -0,0 +1,492 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include <yaml.h>
+
+#include "modulemd-compression.h"
+#include "modulemd-defaults.h"
+#include "modulemd-document-reader.h"
+#include "modulemd-errors.h"
+#include "modulemd-module-stream.h"
+#include "modulemd-obsoletes.h"
+#include "modulemd-subdocument-info.h"
+#include "modulemd-translation.h"
+#include "private/modulemd-compression-private.h"
+#include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-document-reader-private.h"
+#include "private/modulemd-module-stream-private.h"
+#include "private/modulemd-module-stream-v1-private.h"
+#include "private/modulemd-module-stream-v2-private.h"
+#include "private/modulemd-obsoletes-private.h"
+#include "private/modulemd-subdocument-info-private.h"
+#include "private/modulemd-translation-private.h"
+#include "private/modulemd-util.h"
+#include "private/modulemd-yaml.h"
+
+
+struct _ModulemdDocumentReader
+{
+  GObject parent_instance;
+
+  yaml_parser_t parser;
+  gboolean strict;
+
+  /* Input sources; at most one of these is set */
+  gchar *yaml_string;
+  FILE *yaml_stream;
+  ModulemdDecompressor *decompressor;
+
+  gboolean started;
+  gboolean finished;
+  guint64 documents_read;
+};
+
+G_DEFINE_TYPE (ModulemdDocumentReader,
+               modulemd_document_reader,
+               G_TYPE_OBJECT)
+
+
+static void
+modulemd_document_reader_finalize (GObject *object)
+{
+  ModulemdDocumentReader *self = (ModulemdDocumentReader *)object;
+
+  yaml_parser_delete (&self->parser);
+
+  /* The decompressor reads from the file, so it must be stopped first */
+  g_clear_pointer (&self->decompressor, modulemd_decompressor_free);
+  g_clear_pointer (&self->yaml_stream, fclose);
+  g_clear_pointer (&self->yaml_string, g_free);
+
+  G_OBJECT_CLASS (modulemd_document_reader_parent_class)->finalize (object);
+}
+
+
+static void
+modulemd_document_reader_class_init (ModulemdDocumentReaderClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = modulemd_document_reader_finalize;
+}
+
+
+static void
+modulemd_document_reader_init (ModulemdDocumentReader *self)
+{
+  yaml_parser_initialize (&self->parser);
+}
+
+
+ModulemdDocumentReader *
+modulemd_document_reader_new_for_file (const gchar *yaml_file,
+                                       gboolean strict,
+                                       GError **error)
+{
+  g_autoptr (ModulemdDocumentReader) self = NULL;
+  g_autoptr (GError) nested_error = NULL;
+  ModulemdCompressionTypeEnum comtype;
+  int saved_errno;
+  int fd;
+
+  g_return_val_if_fail (yaml_file, NULL);
+
+  self = g_object_new (MODULEMD_TYPE_DOCUMENT_READER, NULL);
+  self->strict = strict;
+
+  self->yaml_stream = g_fopen (yaml_file, "rbe");
+  saved_errno = errno;
+  if (self->yaml_stream == NULL)
+    {
+      g_set_error (error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_OPEN,
+                   "Failed to open file: %s",
+                   g_strerror (saved_errno));
+      return NULL;
+    }
+
+  fd = fileno (self->yaml_stream);
+
+  comtype = modulemd_detect_compression (yaml_file, fd, &nested_error);
+  switch (comtype)
+    {
+    case MODULEMD_COMPRESSION_TYPE_DETECTION_FAILED:
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return NULL;
+
+    case MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION:
+    case MODULEMD_COMPRESSION_TYPE_UNKNOWN_COMPRESSION:
+      yaml_parser_set_input_file (&self->parser, self->yaml_stream);
+      break;
+
+    default:
+      /* Only the native decompressors are used here, rpmio cannot be driven
+       * one subdocument at a time from a separate object.
+       */
+      self->decompressor =
+        modulemd_decompressor_new_for_fd (comtype, fd, error);
+      if (!self->decompressor)
+        {
+          return NULL;
+        }
+      yaml_parser_set_input (
+        &self->parser, modulemd_decompressor_read_fn, self->decompressor);
+      break;
+    }
+
+  return g_steal_pointer (&self);
+}
+
+
+ModulemdDocumentReader *
+modulemd_document_reader_new_for_string (const gchar *yaml_string,
+                                         gboolean strict)
+{
+  ModulemdDocumentReader *self = NULL;
+
+  g_return_val_if_fail (yaml_string, NULL);
+
+  self = g_object_new (MODULEMD_TYPE_DOCUMENT_READER, NULL);
+  self->strict = strict;
+
+  /* libyaml does not copy its input */
+  self->yaml_string = g_strdup (yaml_string);
+  yaml_parser_set_input_string (&self->parser,
+                                (const unsigned char *)self->yaml_string,
+                                strlen (self->yaml_string));
+
+  return self;
+}
+
+
+/* Where the calling thread adds up the time spent validating, if anywhere.
+ * See modulemd_document_reader_time_validation().
+ */
+static GPrivate validation_time = G_PRIVATE_INIT (NULL);
+
+
+void
+modulemd_document_reader_time_validation (gint64 *elapsed)
+{
+  g_private_set (&validation_time, elapsed);
+}
+
+
+static gint64
+validation_start (void)
+{
+  return g_private_get (&validation_time) ? g_get_monotonic_time () : 0;
+}
+
+
+static void
+validation_stop (gint64 start)
+{
+  gint64 *elapsed = g_private_get (&validation_time);
+
+  if (elapsed)
+    {
+      *elapsed += g_get_monotonic_time () - start;
+    }
+}
+
+
+GObject *
+modulemd_document_reader_parse_subdoc (ModulemdSubdocumentInfo *subdoc,
+                                       gboolean strict,
+                                       guint autogen_id,
+                                       GError **error)
+{
+  g_autoptr (GError) nested_error = NULL;
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (ModulemdTranslation) translation = NULL;
+  g_autoptr (ModulemdObsoletes) obsoletes = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  ModulemdYamlDocumentTypeEnum doctype =
+    modulemd_subdocument_info_get_doctype (subdoc);
+  gint64 start;
+  gboolean valid;
+
+  switch (doctype)
+    {
+    case MODULEMD_YAML_DOC_PACKAGER:
+      g_set_error (error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_PARSE,
+                   "modulemd-packager document ignored while reading into a "
+                   "module index");
+      return NULL;
+
+    case MODULEMD_YAML_DOC_DELTA:
+      g_set_error (error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_PARSE,
+                   "modulemd-delta documents can only be read with "
+                   "modulemd_module_index_apply_delta()");
+      return NULL;
+
+    case MODULEMD_YAML_DOC_MODULESTREAM:
+      switch (modulemd_subdocument_info_get_mdversion (subdoc))
+        {
+        case MD_MODULESTREAM_VERSION_ONE:
+          stream = MODULEMD_MODULE_STREAM (
+            modulemd_module_stream_v1_parse_yaml (subdoc, strict, error));
+          break;
+
+        case MD_MODULESTREAM_VERSION_TWO:
+          stream =
+            MODULEMD_MODULE_STREAM (modulemd_module_stream_v2_parse_yaml (
+              subdoc, strict, FALSE, error));
+          break;
+
+        default:
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_PARSE,
+                       "Invalid mdversion for a stream object");
+          return NULL;
+        }
+
+      if (stream == NULL)
+        {
+          return NULL;
+        }
+
+      if (autogen_id)
+        {
+          modulemd_module_stream_set_autogen_module_name (stream, autogen_id);
+          modulemd_module_stream_set_autogen_stream_name (stream, autogen_id);
+        }
+
+      start = validation_start ();
+      valid = modulemd_module_stream_validate (stream, &nested_error);
+      validation_stop (start);
+      if (!valid)
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return NULL;
+        }
+      modulemd_module_stream_mark_validated (stream);
+
+      return G_OBJECT (g_steal_pointer (&stream));
+
+    case MODULEMD_YAML_DOC_DEFAULTS:
+      switch (modulemd_subdocument_info_get_mdversion (subdoc))
+        {
+        case MD_DEFAULTS_VERSION_ONE:
+          defaults = (ModulemdDefaults *)modulemd_defaults_v1_parse_yaml (
+            subdoc, strict, error);
+          if (defaults == NULL)
+            {
+              return NULL;
+            }
+
+          start = validation_start ();
+          valid = modulemd_defaults_validate (defaults, &nested_error);
+          validation_stop (start);
+          if (!valid)
+            {
+              g_propagate_error (error, g_steal_pointer (&nested_error));
+              return NULL;
+            }
+
+          return G_OBJECT (g_steal_pointer (&defaults));
+
+        default:
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_PARSE,
+                       "Invalid mdversion for a defaults object");
+          return NULL;
+        }
+
+    case MODULEMD_YAML_DOC_TRANSLATIONS:
+      translation = modulemd_translation_parse_yaml (subdoc, strict, error);
+      if (translation == NULL)
+        {
+          return NULL;
+        }
+
+      start = validation_start ();
+      valid = modulemd_translation_validate (translation, &nested_error);
+      validation_stop (start);
+      if (!valid)
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return NULL;
+        }
+
+      return G_OBJECT (g_steal_pointer (&translation));
+
+    case MODULEMD_YAML_DOC_OBSOLETES:
+      obsoletes = modulemd_obsoletes_parse_yaml (subdoc, strict, error);
+      if (obsoletes == NULL)
+        {
+          return NULL;
+        }
+
+      start = validation_start ();
+      valid = modulemd_obsoletes_validate (obsoletes, &nested_error);
+      validation_stop (start);
+      if (!valid)
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return NULL;
+        }
+
+      return G_OBJECT (g_steal_pointer (&obsoletes));
+
+    default:
+      g_set_error (error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_PARSE,
+                   "Invalid doctype encountered");
+      return NULL;
+    }
+}
+
+
+/*
+ * reader_fail:
+ * @self: (in): This #ModulemdDocumentReader object.
+ * @nested_error: (in) (transfer full): The error that stopped the parser.
+ * @error: (out): The error to report.
+ *
+ * Stops @self for good. If the input was being decompressed, a
+ * decompression error is reported instead of the parse error it caused.
+ *
+ * Returns: NULL.
+ */
+static GObject *
+reader_fail (ModulemdDocumentReader *self,
+             GError *nested_error,
+             GError **error)
+{
+  self->finished = TRUE;
+
+  if (self->decompressor &&
+      !modulemd_decompressor_close (self->decompressor, error))
+    {
+      g_clear_error (&nested_error);
+      return NULL;
+    }
+
+  g_propagate_error (error, nested_error);
+  return NULL;
+}
+
+
+GObject *
+modulemd_document_reader_next (ModulemdDocumentReader *self, GError **error)
+{
+  GObject *object = NULL;
+  g_autoptr (ModulemdSubdocumentInfo) subdoc = NULL;
+  g_autoptr (GError) subdoc_error = NULL;
+  MMD_INIT_YAML_EVENT (event);
+
+  g_return_val_if_fail (MODULEMD_IS_DOCUMENT_READER (self), NULL);
+
+  if (self->finished)
+    {
+      return NULL;
+    }
+
+  if (!self->started)
+    {
+      if (!yaml_parser_parse (&self->parser, &event))
+        {
+          return reader_fail (
+            self,
+            g_error_new_literal (
+              MODULEMD_YAML_ERROR, MMD_YAML_ERROR_UNPARSEABLE, "Parser error"),
+            error);
+        }
+
+      if (event.type != YAML_STREAM_START_EVENT)
+        {
+          return reader_fail (self,
+                              g_error_new (MODULEMD_YAML_ERROR,
+                                           MMD_YAML_ERROR_PARSE,
+                                           "Did not encounter stream start"),
+                              error);
+        }
+
+      yaml_event_delete (&event);
+      self->started = TRUE;
+    }
+
+  if (!yaml_parser_parse (&self->parser, &event))
+    {
+      return reader_fail (
+        self,
+        g_error_new_literal (
+          MODULEMD_YAML_ERROR, MMD_YAML_ERROR_UNPARSEABLE, "Parser error"),
+        error);
+    }
+
+  switch (event.type)
+    {
+    case YAML_DOCUMENT_START_EVENT: break;
+
+    case YAML_STREAM_END_EVENT:
+      self->finished = TRUE;
+      if (self->decompressor &&
+          !modulemd_decompressor_close (self->decompressor, error))
+        {
+          return NULL;
+        }
+      return NULL;
+
+    default:
+      return reader_fail (
+        self,
+        g_error_new (MODULEMD_YAML_ERROR,
+                     MMD_YAML_ERROR_PARSE,
+                     "Unexpected YAML event in document stream: %s",
+                     mmd_yaml_get_event_name (event.type)),
+        error);
+    }
+
+  self->documents_read++;
+
+  subdoc = modulemd_yaml_parse_document_type (&self->parser);
+  if (modulemd_subdocument_info_get_gerror (subdoc) != NULL)
+    {
+      return G_OBJECT (g_steal_pointer (&subdoc));
+    }
+
+  object = modulemd_document_reader_parse_subdoc (
+    subdoc, self->strict, 0, &subdoc_error);
+  if (object == NULL)
+    {
+      modulemd_subdocument_info_set_gerror (subdoc, subdoc_error);
+      return G_OBJECT (g_steal_pointer (&subdoc));
+    }
+
+  return object;
+}
+
+
+guint64
+modulemd_document_reader_get_documents_read (ModulemdDocumentReader *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_DOCUMENT_READER (self), 0);
+
+  return self->documents_read;
+}
@@ -0,0 +1,381 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <yaml.h>
+
+#include "modulemd-defaults.h"
+#include "modulemd-document-writer.h"
+#include "modulemd-errors.h"
+#include "modulemd-module-stream.h"
+#include "modulemd-obsoletes.h"
+#include "modulemd-translation.h"
+#include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-module-stream-v1-private.h"
+#include "private/modulemd-module-stream-v2-private.h"
+#include "private/modulemd-obsoletes-private.h"
+#include "private/modulemd-translation-private.h"
+#include "private/modulemd-util.h"
+#include "private/modulemd-yaml-writer.h"
+#include "private/modulemd-yaml.h"
+
+
+struct _ModulemdDocumentWriter
+{
+  GObject parent_instance;
+
+  yaml_emitter_t emitter;
+  modulemd_yaml_writer *writer;
+
+  /* Output targets; at most one of these is set */
+  FILE *yaml_stream;
+  modulemd_yaml_string *yaml_string;
+
+  gboolean started;
+  gboolean closed;
+  gboolean failed;
+  guint64 documents_written;
+};
+
+G_DEFINE_TYPE (ModulemdDocumentWriter,
+               modulemd_document_writer,
+               G_TYPE_OBJECT)
+
+
+static void
+modulemd_document_writer_finalize (GObject *object)
+{
+  ModulemdDocumentWriter *self = (ModulemdDocumentWriter *)object;
+
+  g_clear_pointer (&self->writer, modulemd_yaml_writer_free);
+  yaml_emitter_delete (&self->emitter);
+  g_clear_pointer (&self->yaml_stream, fclose);
+  g_clear_pointer (&self->yaml_string, modulemd_yaml_string_free);
+
+  G_OBJECT_CLASS (modulemd_document_writer_parent_class)->finalize (object);
+}
+
+
+static void
+modulemd_document_writer_class_init (ModulemdDocumentWriterClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = modulemd_document_writer_finalize;
+}
+
+
+static void
+modulemd_document_writer_init (ModulemdDocumentWriter *self)
+{
+  yaml_emitter_initialize (&self->emitter);
+}
+
+
+ModulemdDocumentWriter *
+modulemd_document_writer_new_for_file (const gchar *yaml_file, GError **error)
+{
+  g_autoptr (ModulemdDocumentWriter) self = NULL;
+  int saved_errno;
+
+  g_return_val_if_fail (yaml_file, NULL);
+
+  self = g_object_new (MODULEMD_TYPE_DOCUMENT_WRITER, NULL);
+
+  self->yaml_stream = g_fopen (yaml_file, "wbe");
+  saved_errno = errno;
+  if (self->yaml_stream == NULL)
+    {
+      g_set_error (error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_OPEN,
+                   "Failed to open file: %s",
+                   g_strerror (saved_errno));
+      return NULL;
+    }
+
+  yaml_emitter_set_output_file (&self->emitter, self->yaml_stream);
+  self->writer = modulemd_yaml_writer_new (&self->emitter);
+
+  return g_steal_pointer (&self);
+}
+
+
+ModulemdDocumentWriter *
+modulemd_document_writer_new_for_string (void)
+{
+  ModulemdDocumentWriter *self = NULL;
+
+  self = g_object_new (MODULEMD_TYPE_DOCUMENT_WRITER, NULL);
+  self->yaml_string = g_malloc0_n (1, sizeof (modulemd_yaml_string));
+  yaml_emitter_set_output (
+    &self->emitter, write_yaml_string, (void *)self->yaml_string);
+  self->writer = modulemd_yaml_writer_new (&self->emitter);
+
+  return self;
+}
+
+
+ModulemdDocumentWriter *
+modulemd_document_writer_new_for_custom (ModulemdWriteHandler custom_write_fn,
+                                         void *custom_pvt_data)
+{
+  ModulemdDocumentWriter *self = NULL;
+
+  g_return_val_if_fail (custom_write_fn, NULL);
+
+  self = g_object_new (MODULEMD_TYPE_DOCUMENT_WRITER, NULL);
+  yaml_emitter_set_output (&self->emitter, custom_write_fn, custom_pvt_data);
+  self->writer = modulemd_yaml_writer_new (&self->emitter);
+
+  return self;
+}
+
+
+/*
+ * validate_object:
+ * @object: (in): The object about to be written.
+ * @error: (out): A #GError containing the reason @object cannot be written.
+ *
+ * Performs the same checks that modulemd_module_index_dump_to_string() does
+ * before writing an object, so that a failure leaves the output untouched.
+ *
+ * Returns: TRUE if @object can be emitted.
+ */
+static gboolean
+validate_object (GObject *object, GError **error)
+{
+  g_autoptr (GError) nested_error = NULL;
+
+  if (MODULEMD_IS_MODULE_STREAM (object))
+    {
+      if (!modulemd_module_stream_validate (MODULEMD_MODULE_STREAM (object),
+                                            &nested_error))
+        {
+          g_propagate_prefixed_error (error,
+                                      g_steal_pointer (&nested_error),
+                                      "Could not validate stream to emit: ");
+          return FALSE;
+        }
+
+      switch (
+        modulemd_module_stream_get_mdversion (MODULEMD_MODULE_STREAM (object)))
+        {
+        case MD_MODULESTREAM_VERSION_ONE:
+        case MD_MODULESTREAM_VERSION_TWO: return TRUE;
+
+        default:
+          g_set_error_literal (error,
+                               MODULEMD_ERROR,
+                               MMD_ERROR_VALIDATE,
+                               "Provided stream is not a recognized version");
+          return FALSE;
+        }
+    }
+
+  if (MODULEMD_IS_DEFAULTS (object))
+    {
+      if (!modulemd_defaults_validate (MODULEMD_DEFAULTS (object),
+                                       &nested_error))
+        {
+          g_propagate_prefixed_error (error,
+                                      g_steal_pointer (&nested_error),
+                                      "Could not validate defaults to emit: ");
+          return FALSE;
+        }
+
+      if (modulemd_defaults_get_mdversion (MODULEMD_DEFAULTS (object)) !=
+          MD_DEFAULTS_VERSION_ONE)
+        {
+          g_set_error_literal (error,
+                               MODULEMD_ERROR,
+                               MMD_ERROR_VALIDATE,
+                               "Provided defaults is not a recognized version");
+          return FALSE;
+        }
+
+      return TRUE;
+    }
+
+  if (MODULEMD_IS_TRANSLATION (object) || MODULEMD_IS_OBSOLETES (object))
+    {
+      return TRUE;
+    }
+
+  g_set_error (error,
+               MODULEMD_ERROR,
+               MMD_ERROR_VALIDATE,
+               "Objects of type %s cannot be written as a YAML subdocument",
+               G_OBJECT_TYPE_NAME (object));
+  return FALSE;
+}
+
+
+static gboolean
+emit_object (ModulemdDocumentWriter *self, GObject *object, GError **error)
+{
+  if (MODULEMD_IS_MODULE_STREAM_V1 (object))
+    {
+      return modulemd_module_stream_v1_emit_yaml (
+        MODULEMD_MODULE_STREAM_V1 (object), &self->emitter, error);
+    }
+
+  if (MODULEMD_IS_MODULE_STREAM_V2 (object))
+    {
+      return modulemd_module_stream_v2_emit_yaml (
+        MODULEMD_MODULE_STREAM_V2 (object), &self->emitter, error);
+    }
+
+  if (MODULEMD_IS_DEFAULTS (object))
+    {
+      return modulemd_defaults_v1_emit_yaml (
+        (ModulemdDefaultsV1 *)object, &self->emitter, error);
+    }
+
+  if (MODULEMD_IS_TRANSLATION (object))
+    {
+      return modulemd_translation_emit_yaml (
+        MODULEMD_TRANSLATION (object), &self->emitter, error);
+    }
+
+  return modulemd_obsoletes_emit_yaml (
+    MODULEMD_OBSOLETES (object), &self->emitter, error);
+}
+
+
+gboolean
+modulemd_document_writer_write (ModulemdDocumentWriter *self,
+                                GObject *object,
+                                GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_DOCUMENT_WRITER (self), FALSE);
+  g_return_val_if_fail (G_IS_OBJECT (object), FALSE);
+
+  if (self->closed || self->failed)
+    {
+      g_set_error_literal (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_EMIT,
+                           self->closed ? "The writer has been closed" :
+                                          "The writer has failed");
+      return FALSE;
+    }
+
+  if (!validate_object (object, error))
+    {
+      return FALSE;
+    }
+
+  if (!self->started)
+    {
+      if (!mmd_emitter_start_stream (&self->emitter, error))
+        {
+          self->failed = TRUE;
+          return FALSE;
+        }
+      self->started = TRUE;
+    }
+
+  /* libyaml flushes its buffer at the end of every document */
+  if (!emit_object (self, object, error))
+    {
+      self->failed = TRUE;
+      return FALSE;
+    }
+
+  self->documents_written++;
+  return TRUE;
+}
+
+
+gboolean
+modulemd_document_writer_close (ModulemdDocumentWriter *self, GError **error)
+{
+  gboolean ret = TRUE;
+  int saved_errno;
+
+  g_return_val_if_fail (MODULEMD_IS_DOCUMENT_WRITER (self), FALSE);
+
+  if (self->closed)
+    {
+      return TRUE;
+    }
+  self->closed = TRUE;
+
+  if (self->failed)
+    {
+      g_set_error_literal (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_EMIT,
+                           "The writer has failed");
+      ret = FALSE;
+    }
+  else if (self->started && !mmd_emitter_end_stream (&self->emitter, error))
+    {
+      self->failed = TRUE;
+      ret = FALSE;
+    }
+  else if (!mmd_emitter_flush (&self->emitter))
+    {
+      g_set_error_literal (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_EMIT,
+                           "Could not flush the YAML output");
+      self->failed = TRUE;
+      ret = FALSE;
+    }
+
+  if (self->yaml_stream)
+    {
+      if (fclose (g_steal_pointer (&self->yaml_stream)) != 0 && ret)
+        {
+          saved_errno = errno;
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_EMIT,
+                       "Could not close the YAML output: %s",
+                       g_strerror (saved_errno));
+          self->failed = TRUE;
+          ret = FALSE;
+        }
+    }
+
+  return ret;
+}
+
+
+const gchar *
+modulemd_document_writer_get_string (ModulemdDocumentWriter *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_DOCUMENT_WRITER (self), NULL);
+
+  if (!self->yaml_string || !self->closed || self->failed)
+    {
+      return NULL;
+    }
+
+  /* Nothing at all is emitted for an empty stream */
+  return self->yaml_string->str ? self->yaml_string->str : "";
+}
+
+
+guint64
+modulemd_document_writer_get_documents_written (ModulemdDocumentWriter *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_DOCUMENT_WRITER (self), 0);
+
+  return self->documents_written;
+}
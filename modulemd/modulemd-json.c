@@ -0,0 +1,1003 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+#include <math.h>
+#include <string.h>
+#include <yaml.h>
+
+#include "modulemd-errors.h"
+#include "private/modulemd-json.h"
+#include "private/modulemd-util.h"
+
+
+/* CBOR major types, RFC 8949 section 3.1 */
+#define CBOR_MAJOR_UINT 0
+#define CBOR_MAJOR_NEGINT 1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAJOR_ARRAY 4
+#define CBOR_MAJOR_MAP 5
+#define CBOR_MAJOR_TAG 6
+#define CBOR_MAJOR_SIMPLE 7
+
+/* Additional information values, RFC 8949 sections 3 and 3.3 */
+#define CBOR_INFO_UINT8 24
+#define CBOR_INFO_FLOAT16 25
+#define CBOR_INFO_FLOAT32 26
+#define CBOR_INFO_FLOAT64 27
+#define CBOR_INFO_INDEFINITE 31
+
+#define CBOR_SIMPLE_FALSE 20
+#define CBOR_SIMPLE_TRUE 21
+#define CBOR_SIMPLE_NULL 22
+
+#define CBOR_BREAK 0xff
+
+/* Deeper CBOR input is rejected rather than risking the stack */
+#define CBOR_MAX_DEPTH 512
+
+
+/* A container being written, including the array of documents */
+typedef struct
+{
+  gboolean mapping;
+  guint64 n_nodes;
+} json_container;
+
+
+struct _modulemd_json_writer
+{
+  ModulemdJsonFormatEnum format;
+  GByteArray *output;
+
+  /* The open containers, innermost last */
+  GArray *containers;
+};
+
+
+/* Installed as the write handler of emitters that write JSON, which is how
+ * mmd_emitter_is_json() recognises them. All events of such an emitter are
+ * consumed by mmd_json_emit(), so libyaml never has any output to write.
+ */
+static int
+json_write_handler (void *UNUSED (data),
+                    unsigned char *UNUSED (buffer),
+                    size_t UNUSED (size))
+{
+  return 0;
+}
+
+
+modulemd_json_writer *
+modulemd_json_writer_new (ModulemdJsonFormatEnum format)
+{
+  modulemd_json_writer *self = g_new0 (modulemd_json_writer, 1);
+
+  self->format = format;
+  self->output = g_byte_array_sized_new (4096);
+  self->containers = g_array_new (FALSE, FALSE, sizeof (json_container));
+
+  return self;
+}
+
+
+void
+modulemd_json_writer_free (modulemd_json_writer *self)
+{
+  if (!self)
+    {
+      return;
+    }
+
+  g_clear_pointer (&self->output, g_byte_array_unref);
+  g_clear_pointer (&self->containers, g_array_unref);
+  g_free (self);
+}
+
+
+gchar *
+modulemd_json_writer_steal_string (modulemd_json_writer *self)
+{
+  g_return_val_if_fail (self->format == MODULEMD_JSON_FORMAT_TEXT, NULL);
+  g_return_val_if_fail (self->output, NULL);
+
+  g_byte_array_append (self->output, (const guint8 *)"", 1);
+
+  return (gchar *)g_byte_array_free (g_steal_pointer (&self->output), FALSE);
+}
+
+
+GBytes *
+modulemd_json_writer_steal_bytes (modulemd_json_writer *self)
+{
+  g_return_val_if_fail (self->output, NULL);
+
+  return g_byte_array_free_to_bytes (g_steal_pointer (&self->output));
+}
+
+
+void
+mmd_emitter_set_output_json (yaml_emitter_t *emitter,
+                             modulemd_json_writer *writer)
+{
+  yaml_emitter_set_output (emitter, json_write_handler, writer);
+}
+
+
+gboolean
+mmd_emitter_is_json (yaml_emitter_t *emitter)
+{
+  return emitter->write_handler == json_write_handler;
+}
+
+
+static inline void
+append_literal (GByteArray *out, const gchar *str)
+{
+  g_byte_array_append (out, (const guint8 *)str, strlen (str));
+}
+
+
+/* Appends @len bytes of @str with the characters that JSON strings cannot
+ * contain escaped, but without the surrounding quotes.
+ */
+static void
+append_json_escaped (GByteArray *out, const gchar *str, gsize len)
+{
+  static const gchar hex[] = "0123456789abcdef";
+  guint8 escape[6] = { '\\', 'u', '0', '0', '0', '0' };
+  const gchar *short_escape = NULL;
+  gsize start = 0;
+  guchar c;
+
+  for (gsize i = 0; i < len; i++)
+    {
+      c = (guchar)str[i];
+      if (c >= 0x20 && c != '"' && c != '\\')
+        {
+          continue;
+        }
+
+      g_byte_array_append (out, (const guint8 *)str + start, i - start);
+      start = i + 1;
+
+      switch (c)
+        {
+        case '"': short_escape = "\\\""; break;
+        case '\\': short_escape = "\\\\"; break;
+        case '\b': short_escape = "\\b"; break;
+        case '\f': short_escape = "\\f"; break;
+        case '\n': short_escape = "\\n"; break;
+        case '\r': short_escape = "\\r"; break;
+        case '\t': short_escape = "\\t"; break;
+
+        default:
+          escape[4] = hex[c >> 4];
+          escape[5] = hex[c & 0xf];
+          g_byte_array_append (out, escape, sizeof (escape));
+          continue;
+        }
+
+      g_byte_array_append (out, (const guint8 *)short_escape, 2);
+    }
+
+  g_byte_array_append (out, (const guint8 *)str + start, len - start);
+}
+
+
+static void
+append_json_string (GByteArray *out, const gchar *str, gsize len)
+{
+  g_byte_array_append (out, (const guint8 *)"\"", 1);
+  append_json_escaped (out, str, len);
+  g_byte_array_append (out, (const guint8 *)"\"", 1);
+}
+
+
+/* Appends the initial byte of a CBOR data item and its argument, using the
+ * shortest encoding of @value.
+ */
+static void
+append_cbor_head (GByteArray *out, guint8 major, guint64 value)
+{
+  guint8 head[9];
+  guint8 info;
+  guint n_bytes;
+
+  if (value < CBOR_INFO_UINT8)
+    {
+      head[0] = (guint8)(major << 5 | value);
+      g_byte_array_append (out, head, 1);
+      return;
+    }
+
+  /* The additional information is 24 + log2 (n_bytes) */
+  if (value <= G_MAXUINT8)
+    {
+      info = CBOR_INFO_UINT8;
+      n_bytes = 1;
+    }
+  else if (value <= G_MAXUINT16)
+    {
+      info = CBOR_INFO_UINT8 + 1;
+      n_bytes = 2;
+    }
+  else if (value <= G_MAXUINT32)
+    {
+      info = CBOR_INFO_UINT8 + 2;
+      n_bytes = 4;
+    }
+  else
+    {
+      info = CBOR_INFO_UINT8 + 3;
+      n_bytes = 8;
+    }
+
+  head[0] = (guint8)(major << 5 | info);
+  for (guint i = 0; i < n_bytes; i++)
+    {
+      head[1 + i] = (guint8)(value >> (8 * (n_bytes - 1 - i)));
+    }
+
+  g_byte_array_append (out, head, 1 + n_bytes);
+}
+
+
+/* Appends the decimal integer @str, as written by mmd_emitter_scalar_uint64()
+ * or mmd_emitter_scalar_int64(). Returns FALSE if @str is not such an
+ * integer.
+ */
+static gboolean
+append_cbor_integer (GByteArray *out, const gchar *str)
+{
+  guint64 value;
+
+  if (str[0] != '-')
+    {
+      if (!g_ascii_string_to_unsigned (str, 10, 0, G_MAXUINT64, &value, NULL))
+        {
+          return FALSE;
+        }
+      append_cbor_head (out, CBOR_MAJOR_UINT, value);
+      return TRUE;
+    }
+
+  if (!g_ascii_string_to_unsigned (str + 1, 10, 1, G_MAXUINT64, &value, NULL))
+    {
+      return FALSE;
+    }
+  append_cbor_head (out, CBOR_MAJOR_NEGINT, value - 1);
+  return TRUE;
+}
+
+
+/*
+ * append_scalar:
+ * @self: (in): This #modulemd_json_writer.
+ * @value: (in): The nul-terminated value of the scalar.
+ * @length: (in): The length of @value in bytes.
+ * @tag: (in) (nullable): The tag of the scalar event. Only scalars that
+ * mmd_emitter_scalar_boolean(), mmd_emitter_scalar_uint64() or
+ * mmd_emitter_scalar_int64() tagged are written as booleans or numbers. Any
+ * other scalar is a string, whatever it looks like.
+ */
+static void
+append_scalar (modulemd_json_writer *self,
+               const gchar *value,
+               gsize length,
+               const gchar *tag)
+{
+  guint8 simple;
+
+  if (g_strcmp0 (tag, YAML_BOOL_TAG) == 0)
+    {
+      if (self->format == MODULEMD_JSON_FORMAT_TEXT)
+        {
+          append_literal (self->output, value);
+        }
+      else
+        {
+          simple = CBOR_MAJOR_SIMPLE << 5 | (g_str_equal (value, "true") ?
+                                               CBOR_SIMPLE_TRUE :
+                                               CBOR_SIMPLE_FALSE);
+          g_byte_array_append (self->output, &simple, 1);
+        }
+      return;
+    }
+
+  if (g_strcmp0 (tag, YAML_INT_TAG) == 0)
+    {
+      if (self->format == MODULEMD_JSON_FORMAT_TEXT)
+        {
+          g_byte_array_append (self->output, (const guint8 *)value, length);
+          return;
+        }
+
+      if (append_cbor_integer (self->output, value))
+        {
+          return;
+        }
+    }
+
+  if (self->format == MODULEMD_JSON_FORMAT_TEXT)
+    {
+      append_json_string (self->output, value, length);
+    }
+  else
+    {
+      append_cbor_head (self->output, CBOR_MAJOR_TEXT, length);
+      g_byte_array_append (self->output, (const guint8 *)value, length);
+    }
+}
+
+
+/*
+ * begin_node:
+ * @self: (in): This #modulemd_json_writer.
+ * @scalar: (in): Whether the node is a scalar.
+ * @is_key: (out): Whether the node is a mapping key.
+ *
+ * Writes the separators that precede the next node of the innermost
+ * container and counts the node.
+ *
+ * Returns: FALSE if no container is open, or if the node is a mapping key
+ * that is not a scalar.
+ */
+static gboolean
+begin_node (modulemd_json_writer *self, gboolean scalar, gboolean *is_key)
+{
+  json_container *parent = NULL;
+
+  if (self->containers->len == 0)
+    {
+      return FALSE;
+    }
+
+  parent = &g_array_index (
+    self->containers, json_container, self->containers->len - 1);
+  *is_key = parent->mapping && parent->n_nodes % 2 == 0;
+  if (*is_key && !scalar)
+    {
+      return FALSE;
+    }
+
+  if (self->format == MODULEMD_JSON_FORMAT_TEXT)
+    {
+      /* One document per line */
+      if (self->containers->len == 1)
+        {
+          append_literal (self->output, parent->n_nodes ? ",\n" : "\n");
+        }
+      else if (parent->mapping && !*is_key)
+        {
+          append_literal (self->output, ":");
+        }
+      else if (parent->n_nodes > 0)
+        {
+          append_literal (self->output, ",");
+        }
+    }
+
+  parent->n_nodes++;
+  return TRUE;
+}
+
+
+static void
+open_container (modulemd_json_writer *self, gboolean mapping)
+{
+  json_container container = { mapping, 0 };
+  guint8 initial;
+
+  g_array_append_val (self->containers, container);
+
+  if (self->format == MODULEMD_JSON_FORMAT_TEXT)
+    {
+      append_literal (self->output, mapping ? "{" : "[");
+    }
+  else
+    {
+      initial = (mapping ? CBOR_MAJOR_MAP : CBOR_MAJOR_ARRAY) << 5 |
+                CBOR_INFO_INDEFINITE;
+      g_byte_array_append (self->output, &initial, 1);
+    }
+}
+
+
+static gboolean
+close_container (modulemd_json_writer *self, gboolean mapping)
+{
+  json_container *container = NULL;
+  guint8 initial = CBOR_BREAK;
+
+  if (self->containers->len == 0)
+    {
+      return FALSE;
+    }
+
+  container = &g_array_index (
+    self->containers, json_container, self->containers->len - 1);
+  if (container->mapping != mapping ||
+      (mapping && container->n_nodes % 2 != 0))
+    {
+      return FALSE;
+    }
+
+  if (self->format == MODULEMD_JSON_FORMAT_TEXT)
+    {
+      if (self->containers->len == 1)
+        {
+          append_literal (self->output, container->n_nodes ? "\n]\n" : "]\n");
+        }
+      else
+        {
+          append_literal (self->output, mapping ? "}" : "]");
+        }
+    }
+  else
+    {
+      g_byte_array_append (self->output, &initial, 1);
+    }
+
+  g_array_set_size (self->containers, self->containers->len - 1);
+  return TRUE;
+}
+
+
+static gboolean
+write_event (modulemd_json_writer *self, yaml_event_t *event)
+{
+  gboolean is_key = FALSE;
+
+  switch (event->type)
+    {
+    case YAML_STREAM_START_EVENT:
+      /* The stream is the array of documents */
+      if (self->containers->len != 0)
+        {
+          return FALSE;
+        }
+      open_container (self, FALSE);
+      return TRUE;
+
+    case YAML_STREAM_END_EVENT:
+      if (self->containers->len != 1)
+        {
+          return FALSE;
+        }
+      return close_container (self, FALSE);
+
+    case YAML_DOCUMENT_START_EVENT:
+    case YAML_DOCUMENT_END_EVENT:
+      /* A document is represented by its root node alone */
+      return self->containers->len == 1;
+
+    case YAML_MAPPING_START_EVENT:
+    case YAML_SEQUENCE_START_EVENT:
+      if (!begin_node (self, FALSE, &is_key))
+        {
+          return FALSE;
+        }
+      open_container (self, event->type == YAML_MAPPING_START_EVENT);
+      return TRUE;
+
+    case YAML_MAPPING_END_EVENT:
+    case YAML_SEQUENCE_END_EVENT:
+      /* The array of documents is only closed by the stream end */
+      if (self->containers->len < 2)
+        {
+          return FALSE;
+        }
+      return close_container (self, event->type == YAML_MAPPING_END_EVENT);
+
+    case YAML_SCALAR_EVENT:
+      if (!begin_node (self, TRUE, &is_key))
+        {
+          return FALSE;
+        }
+      append_scalar (self,
+                     (const gchar *)event->data.scalar.value,
+                     event->data.scalar.length,
+                     is_key ? NULL : (const gchar *)event->data.scalar.tag);
+      return TRUE;
+
+    default:
+      /* Aliases have no equivalent */
+      return FALSE;
+    }
+}
+
+
+int
+mmd_json_emit (yaml_emitter_t *emitter, yaml_event_t *event)
+{
+  modulemd_json_writer *self =
+    (modulemd_json_writer *)emitter->write_handler_data;
+  gboolean ret = write_event (self, event);
+
+  yaml_event_delete (event);
+
+  return ret ? 1 : 0;
+}
+
+
+typedef struct
+{
+  const guint8 *data;
+  gsize len;
+  gsize pos;
+  GByteArray *json;
+} cbor_reader;
+
+
+static gboolean
+cbor_error (cbor_reader *reader, GError **error, const gchar *message)
+{
+  g_set_error (error,
+               MODULEMD_YAML_ERROR,
+               MMD_YAML_ERROR_UNPARSEABLE,
+               "Invalid CBOR data at offset %" G_GSIZE_FORMAT ": %s",
+               reader->pos,
+               message);
+  return FALSE;
+}
+
+
+/*
+ * cbor_read_head:
+ * @reader: (inout): The #cbor_reader, positioned at the start of a data item.
+ * @major: (out): The major type of the item.
+ * @info: (out): The additional information of the item.
+ * @value: (out): The argument of the item, 0 if it is indefinite.
+ * @error: (out): A #GError containing the reason the item is malformed.
+ *
+ * Returns: TRUE if the initial byte and argument of an item were read.
+ */
+static gboolean
+cbor_read_head (cbor_reader *reader,
+                guint8 *major,
+                guint8 *info,
+                guint64 *value,
+                GError **error)
+{
+  guint n_bytes;
+
+  if (reader->pos >= reader->len)
+    {
+      return cbor_error (reader, error, "unexpected end of data");
+    }
+
+  *major = reader->data[reader->pos] >> 5;
+  *info = reader->data[reader->pos] & 0x1f;
+  reader->pos++;
+  *value = 0;
+
+  if (*info < CBOR_INFO_UINT8)
+    {
+      *value = *info;
+      return TRUE;
+    }
+
+  if (*info == CBOR_INFO_INDEFINITE)
+    {
+      if (*major == CBOR_MAJOR_UINT || *major == CBOR_MAJOR_NEGINT ||
+          *major == CBOR_MAJOR_TAG)
+        {
+          return cbor_error (reader, error, "invalid indefinite length");
+        }
+      return TRUE;
+    }
+
+  if (*info > CBOR_INFO_FLOAT64)
+    {
+      return cbor_error (reader, error, "reserved additional information");
+    }
+
+  n_bytes = 1 << (*info - CBOR_INFO_UINT8);
+  if (reader->len - reader->pos < n_bytes)
+    {
+      return cbor_error (reader, error, "unexpected end of data");
+    }
+
+  for (guint i = 0; i < n_bytes; i++)
+    {
+      *value = *value << 8 | reader->data[reader->pos++];
+    }
+
+  return TRUE;
+}
+
+
+/* Consumes the break that ends an indefinite-length item, if it is next */
+static gboolean
+cbor_at_break (cbor_reader *reader)
+{
+  if (reader->pos < reader->len && reader->data[reader->pos] == CBOR_BREAK)
+    {
+      reader->pos++;
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+
+static gboolean
+cbor_append_text_chunk (cbor_reader *reader, guint64 length, GError **error)
+{
+  const gchar *chunk = (const gchar *)reader->data + reader->pos;
+
+  if (reader->len - reader->pos < length)
+    {
+      return cbor_error (reader, error, "unexpected end of data");
+    }
+
+  /* This also rejects embedded nul characters */
+  if (!g_utf8_validate (chunk, (gssize)length, NULL))
+    {
+      return cbor_error (reader, error, "text string is not valid UTF-8");
+    }
+
+  append_json_escaped (reader->json, chunk, length);
+  reader->pos += length;
+  return TRUE;
+}
+
+
+static gboolean
+cbor_append_text (cbor_reader *reader,
+                  guint8 info,
+                  guint64 length,
+                  GError **error)
+{
+  guint8 major;
+  guint8 chunk_info;
+
+  g_byte_array_append (reader->json, (const guint8 *)"\"", 1);
+
+  if (info != CBOR_INFO_INDEFINITE)
+    {
+      if (!cbor_append_text_chunk (reader, length, error))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      /* Indefinite-length strings are a sequence of definite-length
+       * chunks of the same type.
+       */
+      while (!cbor_at_break (reader))
+        {
+          if (!cbor_read_head (reader, &major, &chunk_info, &length, error))
+            {
+              return FALSE;
+            }
+          if (major != CBOR_MAJOR_TEXT || chunk_info == CBOR_INFO_INDEFINITE)
+            {
+              return cbor_error (reader, error, "invalid text string chunk");
+            }
+          if (!cbor_append_text_chunk (reader, length, error))
+            {
+              return FALSE;
+            }
+        }
+    }
+
+  g_byte_array_append (reader->json, (const guint8 *)"\"", 1);
+  return TRUE;
+}
+
+
+static gdouble
+half_to_double (guint16 half)
+{
+  gint exponent = (half >> 10) & 0x1f;
+  gint mantissa = half & 0x3ff;
+  gdouble value;
+
+  if (exponent == 0)
+    {
+      /* Subnormal: mantissa * 2^-24 */
+      value = mantissa / 16777216.0;
+    }
+  else if (exponent != 0x1f)
+    {
+      /* (1024 + mantissa) * 2^(exponent - 25) */
+      value = mantissa + 1024;
+      value = exponent >= 25 ? value * (1 << (exponent - 25)) :
+                               value / (1 << (25 - exponent));
+    }
+  else
+    {
+      value = mantissa == 0 ? INFINITY : NAN;
+    }
+
+  return half & 0x8000 ? -value : value;
+}
+
+
+static gboolean
+cbor_append_simple (cbor_reader *reader,
+                    guint8 info,
+                    guint64 value,
+                    GError **error)
+{
+  union
+  {
+    guint32 u;
+    gfloat f;
+  } bits32;
+  union
+  {
+    guint64 u;
+    gdouble d;
+  } bits64;
+  gdouble number;
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  switch (info)
+    {
+    case CBOR_SIMPLE_FALSE:
+      append_literal (reader->json, "false");
+      return TRUE;
+
+    case CBOR_SIMPLE_TRUE:
+      append_literal (reader->json, "true");
+      return TRUE;
+
+    case CBOR_SIMPLE_NULL:
+      append_literal (reader->json, "null");
+      return TRUE;
+
+    case CBOR_INFO_FLOAT16: number = half_to_double ((guint16)value); break;
+
+    case CBOR_INFO_FLOAT32:
+      bits32.u = (guint32)value;
+      number = bits32.f;
+      break;
+
+    case CBOR_INFO_FLOAT64:
+      bits64.u = value;
+      number = bits64.d;
+      break;
+
+    case CBOR_INFO_INDEFINITE:
+      return cbor_error (reader, error, "unexpected break");
+
+    default: return cbor_error (reader, error, "unsupported simple value");
+    }
+
+  if (!isfinite (number))
+    {
+      return cbor_error (
+        reader, error, "NaN and infinity cannot be represented in JSON");
+    }
+
+  append_literal (reader->json, g_ascii_dtostr (buf, sizeof (buf), number));
+  return TRUE;
+}
+
+
+static gboolean
+cbor_append_item (cbor_reader *reader,
+                  guint depth,
+                  gboolean key,
+                  GError **error)
+{
+  guint8 major;
+  guint8 info;
+  guint64 value;
+  gchar buf[32];
+
+  if (depth > CBOR_MAX_DEPTH)
+    {
+      return cbor_error (reader, error, "data is nested too deeply");
+    }
+
+  if (!cbor_read_head (reader, &major, &info, &value, error))
+    {
+      return FALSE;
+    }
+
+  /* Tags only annotate the item that follows them */
+  if (major == CBOR_MAJOR_TAG)
+    {
+      return cbor_append_item (reader, depth + 1, key, error);
+    }
+
+  if (key && major != CBOR_MAJOR_TEXT)
+    {
+      return cbor_error (reader, error, "map key is not a text string");
+    }
+
+  switch (major)
+    {
+    case CBOR_MAJOR_UINT:
+      g_snprintf (buf, sizeof (buf), "%" G_GUINT64_FORMAT, value);
+      append_literal (reader->json, buf);
+      return TRUE;
+
+    case CBOR_MAJOR_NEGINT:
+      /* The value is -1 - value, which does not fit in a gint64 for all
+       * arguments.
+       */
+      if (value == G_MAXUINT64)
+        {
+          append_literal (reader->json, "-18446744073709551616");
+        }
+      else
+        {
+          g_snprintf (buf, sizeof (buf), "-%" G_GUINT64_FORMAT, value + 1);
+          append_literal (reader->json, buf);
+        }
+      return TRUE;
+
+    case CBOR_MAJOR_BYTES:
+      return cbor_error (
+        reader, error, "byte strings cannot be represented in JSON");
+
+    case CBOR_MAJOR_TEXT: return cbor_append_text (reader, info, value, error);
+
+    case CBOR_MAJOR_ARRAY:
+    case CBOR_MAJOR_MAP:
+      append_literal (reader->json, major == CBOR_MAJOR_MAP ? "{" : "[");
+      for (guint64 i = 0;
+           info == CBOR_INFO_INDEFINITE ? !cbor_at_break (reader) : i < value;
+           i++)
+        {
+          if (i > 0)
+            {
+              append_literal (reader->json, ",");
+            }
+
+          if (major == CBOR_MAJOR_MAP)
+            {
+              if (!cbor_append_item (reader, depth + 1, TRUE, error))
+                {
+                  return FALSE;
+                }
+              append_literal (reader->json, ":");
+            }
+
+          if (!cbor_append_item (reader, depth + 1, FALSE, error))
+            {
+              return FALSE;
+            }
+        }
+      append_literal (reader->json, major == CBOR_MAJOR_MAP ? "}" : "]");
+      return TRUE;
+
+    default: return cbor_append_simple (reader, info, value, error);
+    }
+}
+
+
+gchar *
+modulemd_cbor_to_json (const guint8 *data, gsize len, GError **error)
+{
+  g_autoptr (GByteArray) json = g_byte_array_new ();
+  cbor_reader reader = { data, len, 0, json };
+
+  if (!cbor_append_item (&reader, 0, FALSE, error))
+    {
+      return NULL;
+    }
+
+  if (reader.pos != len)
+    {
+      cbor_error (&reader, error, "trailing data after the first item");
+      return NULL;
+    }
+
+  g_byte_array_append (json, (const guint8 *)"", 1);
+
+  return (gchar *)g_byte_array_free (g_steal_pointer (&json), FALSE);
+}
+
+
+/* Reads the four hexadecimal digits of a `\u` escape. */
+static gboolean
+read_hex4 (const gchar *str, gunichar *value)
+{
+  gint digit;
+
+  *value = 0;
+  for (guint i = 0; i < 4; i++)
+    {
+      digit = g_ascii_xdigit_value (str[i]);
+      if (digit < 0)
+        {
+          return FALSE;
+        }
+      *value = *value << 4 | (gunichar)digit;
+    }
+
+  return TRUE;
+}
+
+
+gboolean
+modulemd_json_decode_surrogates (const gchar *json,
+                                 gchar **decoded,
+                                 GError **error)
+{
+  g_autoptr (GString) out = NULL;
+  const gchar *copied = json;
+  gboolean in_string = FALSE;
+  gunichar high;
+  gunichar low;
+
+  *decoded = NULL;
+
+  for (const gchar *p = json; *p != '\0'; p++)
+    {
+      if (*p == '"')
+        {
+          in_string = !in_string;
+          continue;
+        }
+
+      if (!in_string || *p != '\\')
+        {
+          continue;
+        }
+
+      /* Skip the escaped character, which may be a quote */
+      p++;
+      if (*p == '\0')
+        {
+          break;
+        }
+
+      if (*p != 'u' || !read_hex4 (p + 1, &high) || high < 0xd800 ||
+          high > 0xdfff)
+        {
+          continue;
+        }
+
+      if (high > 0xdbff || p[5] != '\\' || p[6] != 'u' ||
+          !read_hex4 (p + 7, &low) || low < 0xdc00 || low > 0xdfff)
+        {
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_PARSE,
+                       "Unpaired UTF-16 surrogate \\u%04X in JSON string",
+                       high);
+          return FALSE;
+        }
+
+      if (!out)
+        {
+          out = g_string_sized_new (strlen (json));
+        }
+
+      /* Everything up to the backslash of the high surrogate */
+      g_string_append_len (out, copied, p - 1 - copied);
+      g_string_append_unichar (
+        out, 0x10000 + ((high - 0xd800) << 10) + (low - 0xdc00));
+
+      /* Continue after the last digit of the low surrogate */
+      p += 10;
+      copied = p + 1;
+    }
+
+  if (out)
+    {
+      g_string_append (out, copied);
+      *decoded = g_string_free (g_steal_pointer (&out), FALSE);
+    }
+
+  return TRUE;
+}
@@ -0,0 +1,500 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include "config.h"
+#include <glib.h>
+#include <string.h>
+
+#include "modulemd-memory-usage.h"
+#include "private/modulemd-memory-usage-private.h"
+#include "private/modulemd-util.h"
+
+#define MMD_MEMORY_CATEGORY_COUNT (MD_MEMORY_CATEGORY_TRANSLATIONS + 1)
+
+/* Approximate sizes of the GLib structures whose definitions are private.
+ * These match the 64-bit layouts of GHashTable, GRealPtrArray and the tree
+ * form of GVariant.
+ */
+#define MMD_HASH_TABLE_STRUCT_SIZE 88
+#define MMD_HASH_TABLE_MIN_SIZE 8
+#define MMD_PTR_ARRAY_STRUCT_SIZE 32
+#define MMD_PTR_ARRAY_MIN_SIZE 16
+#define MMD_VARIANT_STRUCT_SIZE 64
+#define MMD_REF_STRING_HEADER_SIZE 16
+
+
+struct _ModulemdMemoryUsage
+{
+  GObject parent_instance;
+
+  /* The usage of each module by category, keyed by module name */
+  GHashTable *modules;
+
+  /* The usage of the index itself by category */
+  guint64 index_usage[MMD_MEMORY_CATEGORY_COUNT];
+
+  /* The usage array that memory is currently recorded in. Either
+   * index_usage or a value of modules.
+   */
+  guint64 *current;
+
+  /* The categories of the active sections, innermost last */
+  GArray *sections;
+
+  /* The shared objects, tables and interned strings that have already been
+   * recorded
+   */
+  GHashTable *seen;
+};
+
+G_DEFINE_TYPE (ModulemdMemoryUsage, modulemd_memory_usage, G_TYPE_OBJECT)
+
+
+ModulemdMemoryUsage *
+modulemd_memory_usage_new (void)
+{
+  return g_object_new (MODULEMD_TYPE_MEMORY_USAGE, NULL);
+}
+
+
+static void
+modulemd_memory_usage_finalize (GObject *object)
+{
+  ModulemdMemoryUsage *self = (ModulemdMemoryUsage *)object;
+
+  g_clear_pointer (&self->modules, g_hash_table_unref);
+  g_clear_pointer (&self->sections, g_array_unref);
+  g_clear_pointer (&self->seen, g_hash_table_unref);
+
+  G_OBJECT_CLASS (modulemd_memory_usage_parent_class)->finalize (object);
+}
+
+
+static void
+modulemd_memory_usage_class_init (ModulemdMemoryUsageClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = modulemd_memory_usage_finalize;
+}
+
+
+static void
+modulemd_memory_usage_init (ModulemdMemoryUsage *self)
+{
+  self->modules =
+    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->current = self->index_usage;
+  self->sections =
+    g_array_new (FALSE, FALSE, sizeof (ModulemdMemoryCategoryEnum));
+  self->seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+
+static const guint64 *
+get_module_usage (ModulemdMemoryUsage *self, const gchar *module_name)
+{
+  if (module_name == NULL)
+    {
+      return self->index_usage;
+    }
+
+  return g_hash_table_lookup (self->modules, module_name);
+}
+
+
+static guint64
+sum_usage (const guint64 *usage)
+{
+  guint64 total = 0;
+
+  for (guint i = 0; i < MMD_MEMORY_CATEGORY_COUNT; i++)
+    {
+      total += usage[i];
+    }
+
+  return total;
+}
+
+
+guint64
+modulemd_memory_usage_get_total (ModulemdMemoryUsage *self)
+{
+  guint64 total = 0;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_val_if_fail (MODULEMD_IS_MEMORY_USAGE (self), 0);
+
+  total = sum_usage (self->index_usage);
+
+  g_hash_table_iter_init (&iter, self->modules);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      total += sum_usage (value);
+    }
+
+  return total;
+}
+
+
+guint64
+modulemd_memory_usage_get_category (ModulemdMemoryUsage *self,
+                                    ModulemdMemoryCategoryEnum category)
+{
+  guint64 total = 0;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_val_if_fail (MODULEMD_IS_MEMORY_USAGE (self), 0);
+  g_return_val_if_fail (category < MMD_MEMORY_CATEGORY_COUNT, 0);
+
+  total = self->index_usage[category];
+
+  g_hash_table_iter_init (&iter, self->modules);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      total += ((guint64 *)value)[category];
+    }
+
+  return total;
+}
+
+
+GStrv
+modulemd_memory_usage_get_module_names_as_strv (ModulemdMemoryUsage *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_MEMORY_USAGE (self), NULL);
+
+  return modulemd_ordered_str_keys_as_strv (self->modules);
+}
+
+
+guint64
+modulemd_memory_usage_get_module_total (ModulemdMemoryUsage *self,
+                                        const gchar *module_name)
+{
+  const guint64 *usage = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MEMORY_USAGE (self), 0);
+
+  usage = get_module_usage (self, module_name);
+  if (!usage)
+    {
+      return 0;
+    }
+
+  return sum_usage (usage);
+}
+
+
+guint64
+modulemd_memory_usage_get_module_category (
+  ModulemdMemoryUsage *self,
+  const gchar *module_name,
+  ModulemdMemoryCategoryEnum category)
+{
+  const guint64 *usage = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MEMORY_USAGE (self), 0);
+  g_return_val_if_fail (category < MMD_MEMORY_CATEGORY_COUNT, 0);
+
+  usage = get_module_usage (self, module_name);
+  if (!usage)
+    {
+      return 0;
+    }
+
+  return usage[category];
+}
+
+
+void
+modulemd_memory_usage_set_module (ModulemdMemoryUsage *self,
+                                  const gchar *module_name)
+{
+  g_return_if_fail (MODULEMD_IS_MEMORY_USAGE (self));
+
+  if (module_name == NULL)
+    {
+      self->current = self->index_usage;
+      return;
+    }
+
+  self->current = g_hash_table_lookup (self->modules, module_name);
+  if (!self->current)
+    {
+      self->current = g_new0 (guint64, MMD_MEMORY_CATEGORY_COUNT);
+      g_hash_table_insert (
+        self->modules, g_strdup (module_name), self->current);
+    }
+}
+
+
+void
+modulemd_memory_usage_push_section (ModulemdMemoryUsage *self,
+                                    ModulemdMemoryCategoryEnum category)
+{
+  g_return_if_fail (MODULEMD_IS_MEMORY_USAGE (self));
+  g_return_if_fail (category < MMD_MEMORY_CATEGORY_COUNT);
+
+  g_array_append_val (self->sections, category);
+}
+
+
+void
+modulemd_memory_usage_pop_section (ModulemdMemoryUsage *self)
+{
+  g_return_if_fail (MODULEMD_IS_MEMORY_USAGE (self));
+  g_return_if_fail (self->sections->len > 0);
+
+  g_array_set_size (self->sections, self->sections->len - 1);
+}
+
+
+void
+modulemd_memory_usage_add (ModulemdMemoryUsage *self,
+                           ModulemdMemoryCategoryEnum category,
+                           gsize size)
+{
+  g_return_if_fail (MODULEMD_IS_MEMORY_USAGE (self));
+  g_return_if_fail (category < MMD_MEMORY_CATEGORY_COUNT);
+
+  if (self->sections->len > 0)
+    {
+      category = g_array_index (
+        self->sections, ModulemdMemoryCategoryEnum, self->sections->len - 1);
+    }
+
+  self->current[category] += size;
+}
+
+
+void
+modulemd_memory_usage_add_string (ModulemdMemoryUsage *self, const gchar *str)
+{
+  if (str)
+    {
+      modulemd_memory_usage_add (
+        self, MD_MEMORY_CATEGORY_STRINGS, strlen (str) + 1);
+    }
+}
+
+
+gboolean
+modulemd_memory_usage_claim (ModulemdMemoryUsage *self, gconstpointer data)
+{
+  g_return_val_if_fail (MODULEMD_IS_MEMORY_USAGE (self), FALSE);
+
+  if (!data)
+    {
+      return FALSE;
+    }
+
+  /* g_hash_table_add() returns FALSE if data was already claimed */
+  return g_hash_table_add (self->seen, (gpointer)data);
+}
+
+
+void
+modulemd_memory_usage_add_interned_string (ModulemdMemoryUsage *self,
+                                           const gchar *str)
+{
+  if (!modulemd_memory_usage_claim (self, str))
+    {
+      return;
+    }
+
+#ifdef HAVE_G_REF_STRING
+  modulemd_memory_usage_add (self,
+                             MD_MEMORY_CATEGORY_STRINGS,
+                             MMD_REF_STRING_HEADER_SIZE + strlen (str) + 1);
+#else
+  modulemd_memory_usage_add_string (self, str);
+#endif
+}
+
+
+void
+modulemd_memory_usage_add_object (ModulemdMemoryUsage *self, gpointer object)
+{
+  GTypeQuery query;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+
+  g_type_query (G_OBJECT_TYPE (object), &query);
+  modulemd_memory_usage_add (
+    self, MD_MEMORY_CATEGORY_OBJECTS, query.instance_size);
+}
+
+
+/*
+ * get_hash_table_size:
+ * @n_entries: The number of entries in a #GHashTable.
+ *
+ * GLib keeps the number of slots of a hash table a power of two and grows it
+ * once it is three quarters full, so a table that was filled by inserting
+ * entries has between 4/3 and 8/3 slots per entry.
+ *
+ * Returns: The estimated number of slots of a #GHashTable.
+ */
+static gsize
+get_hash_table_size (guint n_entries)
+{
+  gsize size = MMD_HASH_TABLE_MIN_SIZE;
+
+  while (size * 3 <= (gsize)n_entries * 4)
+    {
+      size <<= 1;
+    }
+
+  return size;
+}
+
+
+void
+modulemd_memory_usage_add_hash_table (ModulemdMemoryUsage *self,
+                                      GHashTable *table)
+{
+  gsize slots;
+
+  if (!table)
+    {
+      return;
+    }
+
+  /* Each slot holds a hash, a key and a value */
+  slots = get_hash_table_size (g_hash_table_size (table));
+  modulemd_memory_usage_add (
+    self,
+    MD_MEMORY_CATEGORY_CONTAINERS,
+    MMD_HASH_TABLE_STRUCT_SIZE +
+      slots * (sizeof (guint) + 2 * sizeof (gpointer)));
+}
+
+
+void
+modulemd_memory_usage_add_string_set (ModulemdMemoryUsage *self,
+                                      GHashTable *set)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  if (!set)
+    {
+      return;
+    }
+
+  modulemd_memory_usage_add_hash_table (self, set);
+
+  g_hash_table_iter_init (&iter, set);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      modulemd_memory_usage_add_interned_string (self, key);
+    }
+}
+
+
+void
+modulemd_memory_usage_add_string_map (ModulemdMemoryUsage *self,
+                                      GHashTable *map)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  if (!map)
+    {
+      return;
+    }
+
+  modulemd_memory_usage_add_hash_table (self, map);
+
+  g_hash_table_iter_init (&iter, map);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (self, key);
+      modulemd_memory_usage_add_string (self, value);
+    }
+}
+
+
+void
+modulemd_memory_usage_add_nested_set (ModulemdMemoryUsage *self,
+                                      GHashTable *table)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  if (!table)
+    {
+      return;
+    }
+
+  modulemd_memory_usage_add_hash_table (self, table);
+
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (self, key);
+      modulemd_memory_usage_add_string_set (self, value);
+    }
+}
+
+
+void
+modulemd_memory_usage_add_ptr_array (ModulemdMemoryUsage *self,
+                                     GPtrArray *array)
+{
+  gsize slots = 0;
+
+  if (!array)
+    {
+      return;
+    }
+
+  /* GLib grows pointer arrays to the next power of two */
+  if (array->len > 0)
+    {
+      slots = MMD_PTR_ARRAY_MIN_SIZE;
+      while (slots < array->len)
+        {
+          slots <<= 1;
+        }
+    }
+
+  modulemd_memory_usage_add (self,
+                             MD_MEMORY_CATEGORY_CONTAINERS,
+                             MMD_PTR_ARRAY_STRUCT_SIZE +
+                               slots * sizeof (gpointer));
+}
+
+
+void
+modulemd_memory_usage_add_variant (ModulemdMemoryUsage *self,
+                                   GVariant *variant)
+{
+  if (!variant)
+    {
+      return;
+    }
+
+  /* This is the size of the serialized form, which the tree form of a
+   * container is comparable to. Computing it does not serialize the value.
+   */
+  modulemd_memory_usage_add (self,
+                             MD_MEMORY_CATEGORY_XMD,
+                             MMD_VARIANT_STRUCT_SIZE +
+                               g_variant_get_size (variant));
+}
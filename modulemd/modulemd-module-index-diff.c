@@ -0,0 +1,612 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+#include <inttypes.h>
+
+#include "modulemd-defaults.h"
+#include "modulemd-module-index-diff.h"
+#include "modulemd-module-index.h"
+#include "modulemd-module-stream.h"
+#include "modulemd-module.h"
+#include "modulemd-obsoletes.h"
+#include "modulemd-translation.h"
+#include "private/modulemd-module-index-private.h"
+#include "private/modulemd-module-private.h"
+#include "private/modulemd-obsoletes-private.h"
+
+
+typedef enum
+{
+  DIFF_STREAMS,
+  DIFF_DEFAULTS,
+  DIFF_OBSOLETES,
+  DIFF_TRANSLATIONS,
+  DIFF_N_KINDS
+} diff_kind;
+
+typedef enum
+{
+  DIFF_ADDED,
+  DIFF_REMOVED,
+  DIFF_CHANGED,
+  DIFF_N_CHANGES
+} diff_change;
+
+struct _ModulemdModuleIndexDiff
+{
+  GObject parent_instance;
+
+  /* Arrays of referenced objects, indexed by diff_kind and diff_change */
+  GPtrArray *changes[DIFF_N_KINDS][DIFF_N_CHANGES];
+};
+
+G_DEFINE_TYPE (ModulemdModuleIndexDiff,
+               modulemd_module_index_diff,
+               G_TYPE_OBJECT)
+
+
+static void
+modulemd_module_index_diff_finalize (GObject *object)
+{
+  ModulemdModuleIndexDiff *self = (ModulemdModuleIndexDiff *)object;
+
+  for (guint kind = 0; kind < DIFF_N_KINDS; kind++)
+    {
+      for (guint change = 0; change < DIFF_N_CHANGES; change++)
+        {
+          g_clear_pointer (&self->changes[kind][change], g_ptr_array_unref);
+        }
+    }
+
+  G_OBJECT_CLASS (modulemd_module_index_diff_parent_class)->finalize (object);
+}
+
+
+static void
+modulemd_module_index_diff_class_init (ModulemdModuleIndexDiffClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = modulemd_module_index_diff_finalize;
+}
+
+
+static void
+modulemd_module_index_diff_init (ModulemdModuleIndexDiff *self)
+{
+  for (guint kind = 0; kind < DIFF_N_KINDS; kind++)
+    {
+      for (guint change = 0; change < DIFF_N_CHANGES; change++)
+        {
+          self->changes[kind][change] =
+            g_ptr_array_new_with_free_func (g_object_unref);
+        }
+    }
+}
+
+
+static void
+add_change (ModulemdModuleIndexDiff *self,
+            diff_kind kind,
+            diff_change change,
+            gpointer object)
+{
+  g_ptr_array_add (self->changes[kind][change], g_object_ref (object));
+}
+
+
+/* A pair of objects with the same identity in the old and the new index,
+ * whose content still has to be compared.
+ */
+typedef struct
+{
+  diff_kind kind;
+  GObject *old_object;
+  GObject *new_object;
+} diff_candidate;
+
+
+static void
+add_candidate (GArray *candidates,
+               diff_kind kind,
+               gpointer old_object,
+               gpointer new_object)
+{
+  diff_candidate candidate = { 0 };
+
+  /* The same object is always equal to itself */
+  if (old_object == new_object)
+    {
+      return;
+    }
+
+  candidate.kind = kind;
+  candidate.old_object = old_object;
+  candidate.new_object = new_object;
+  g_array_append_val (candidates, candidate);
+}
+
+
+static void
+diff_streams (ModulemdModuleIndexDiff *self,
+              ModulemdModule *old_module,
+              ModulemdModule *new_module,
+              GArray *candidates)
+{
+  GPtrArray *old_streams = modulemd_module_get_all_streams (old_module);
+  GPtrArray *new_streams = modulemd_module_get_all_streams (new_module);
+  g_autoptr (GHashTable) by_nsvca = NULL;
+  g_autoptr (GHashTable) matched = NULL;
+  ModulemdModuleStream *old_stream = NULL;
+  ModulemdModuleStream *new_stream = NULL;
+  gchar *nsvca = NULL;
+
+  by_nsvca = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  matched = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (guint i = 0; i < old_streams->len; i++)
+    {
+      old_stream = g_ptr_array_index (old_streams, i);
+      nsvca = modulemd_module_stream_get_NSVCA_as_string (old_stream);
+      g_hash_table_replace (by_nsvca, nsvca, old_stream);
+    }
+
+  for (guint i = 0; i < new_streams->len; i++)
+    {
+      g_autofree gchar *new_nsvca = NULL;
+
+      new_stream = g_ptr_array_index (new_streams, i);
+      new_nsvca = modulemd_module_stream_get_NSVCA_as_string (new_stream);
+      old_stream = g_hash_table_lookup (by_nsvca, new_nsvca);
+
+      if (!old_stream)
+        {
+          add_change (self, DIFF_STREAMS, DIFF_ADDED, new_stream);
+          continue;
+        }
+
+      g_hash_table_add (matched, old_stream);
+      add_candidate (candidates, DIFF_STREAMS, old_stream, new_stream);
+    }
+
+  for (guint i = 0; i < old_streams->len; i++)
+    {
+      old_stream = g_ptr_array_index (old_streams, i);
+      if (!g_hash_table_contains (matched, old_stream))
+        {
+          add_change (self, DIFF_STREAMS, DIFF_REMOVED, old_stream);
+        }
+    }
+}
+
+
+static void
+diff_defaults (ModulemdModuleIndexDiff *self,
+               ModulemdModule *old_module,
+               ModulemdModule *new_module,
+               GArray *candidates)
+{
+  ModulemdDefaults *old_defaults = modulemd_module_get_defaults (old_module);
+  ModulemdDefaults *new_defaults = modulemd_module_get_defaults (new_module);
+
+  if (old_defaults && new_defaults)
+    {
+      add_candidate (candidates, DIFF_DEFAULTS, old_defaults, new_defaults);
+    }
+  else if (new_defaults)
+    {
+      add_change (self, DIFF_DEFAULTS, DIFF_ADDED, new_defaults);
+    }
+  else if (old_defaults)
+    {
+      add_change (self, DIFF_DEFAULTS, DIFF_REMOVED, old_defaults);
+    }
+}
+
+
+static gchar *
+get_obsoletes_key (ModulemdObsoletes *obsoletes)
+{
+  const gchar *context = modulemd_obsoletes_get_module_context (obsoletes);
+
+  return g_strdup_printf ("%s:%s:%" PRIu64,
+                          modulemd_obsoletes_get_module_stream (obsoletes),
+                          context ? context : "",
+                          modulemd_obsoletes_get_modified (obsoletes));
+}
+
+
+static void
+diff_obsoletes (ModulemdModuleIndexDiff *self,
+                ModulemdModule *old_module,
+                ModulemdModule *new_module,
+                GArray *candidates)
+{
+  GPtrArray *old_obsoletes = modulemd_module_get_obsoletes (old_module);
+  GPtrArray *new_obsoletes = modulemd_module_get_obsoletes (new_module);
+  g_autoptr (GHashTable) by_key = NULL;
+  g_autoptr (GHashTable) matched = NULL;
+  ModulemdObsoletes *old_entry = NULL;
+  ModulemdObsoletes *new_entry = NULL;
+
+  by_key = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  matched = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (guint i = 0; i < old_obsoletes->len; i++)
+    {
+      old_entry = g_ptr_array_index (old_obsoletes, i);
+      g_hash_table_replace (by_key, get_obsoletes_key (old_entry), old_entry);
+    }
+
+  for (guint i = 0; i < new_obsoletes->len; i++)
+    {
+      g_autofree gchar *key = NULL;
+
+      new_entry = g_ptr_array_index (new_obsoletes, i);
+      key = get_obsoletes_key (new_entry);
+      old_entry = g_hash_table_lookup (by_key, key);
+
+      if (!old_entry)
+        {
+          add_change (self, DIFF_OBSOLETES, DIFF_ADDED, new_entry);
+          continue;
+        }
+
+      g_hash_table_add (matched, old_entry);
+      add_candidate (candidates, DIFF_OBSOLETES, old_entry, new_entry);
+    }
+
+  for (guint i = 0; i < old_obsoletes->len; i++)
+    {
+      old_entry = g_ptr_array_index (old_obsoletes, i);
+      if (!g_hash_table_contains (matched, old_entry))
+        {
+          add_change (self, DIFF_OBSOLETES, DIFF_REMOVED, old_entry);
+        }
+    }
+}
+
+
+static void
+diff_translations (ModulemdModuleIndexDiff *self,
+                   ModulemdModule *old_module,
+                   ModulemdModule *new_module,
+                   GArray *candidates)
+{
+  g_autoptr (GPtrArray) old_streams = NULL;
+  g_autoptr (GPtrArray) new_streams = NULL;
+  ModulemdTranslation *old_translation = NULL;
+  ModulemdTranslation *new_translation = NULL;
+  const gchar *stream = NULL;
+
+  old_streams = modulemd_module_get_translated_streams (old_module);
+  new_streams = modulemd_module_get_translated_streams (new_module);
+
+  for (guint i = 0; i < new_streams->len; i++)
+    {
+      stream = g_ptr_array_index (new_streams, i);
+      new_translation = modulemd_module_get_translation (new_module, stream);
+      old_translation = modulemd_module_get_translation (old_module, stream);
+
+      if (old_translation)
+        {
+          add_candidate (
+            candidates, DIFF_TRANSLATIONS, old_translation, new_translation);
+        }
+      else
+        {
+          add_change (self, DIFF_TRANSLATIONS, DIFF_ADDED, new_translation);
+        }
+    }
+
+  for (guint i = 0; i < old_streams->len; i++)
+    {
+      stream = g_ptr_array_index (old_streams, i);
+      if (!modulemd_module_get_translation (new_module, stream))
+        {
+          add_change (self,
+                      DIFF_TRANSLATIONS,
+                      DIFF_REMOVED,
+                      modulemd_module_get_translation (old_module, stream));
+        }
+    }
+}
+
+
+/*
+ * diff_modules:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ * @old_module: (in) (nullable): The module of the old index.
+ * @new_module: (in) (nullable): The module of the same name in the new index.
+ * @candidates: (inout): An array of #diff_candidate.
+ *
+ * Records everything that was added or removed between @old_module and
+ * @new_module, and appends the pairs of objects that exist in both to
+ * @candidates. A missing module is treated as an empty one.
+ */
+static void
+diff_modules (ModulemdModuleIndexDiff *self,
+              ModulemdModule *old_module,
+              ModulemdModule *new_module,
+              GArray *candidates)
+{
+  g_autoptr (ModulemdModule) empty = NULL;
+
+  if (!old_module || !new_module)
+    {
+      empty = modulemd_module_new (modulemd_module_get_module_name (
+        old_module ? old_module : new_module));
+      old_module = old_module ? old_module : empty;
+      new_module = new_module ? new_module : empty;
+    }
+
+  diff_defaults (self, old_module, new_module, candidates);
+  diff_obsoletes (self, old_module, new_module, candidates);
+  diff_translations (self, old_module, new_module, candidates);
+  diff_streams (self, old_module, new_module, candidates);
+}
+
+
+/*
+ * resolve_candidates:
+ * @self: (in): This #ModulemdModuleIndexDiff object.
+ * @old_index: (in): The old #ModulemdModuleIndex.
+ * @new_index: (in): The new #ModulemdModuleIndex.
+ * @candidates: (in): The pairs of objects found by diff_modules().
+ * @error: (out): A #GError containing the reason a digest could not be
+ * computed.
+ *
+ * Compares the content digests of all @candidates and records the ones that
+ * differ as changed.
+ *
+ * Returns: TRUE if all candidates could be compared.
+ */
+static gboolean
+resolve_candidates (ModulemdModuleIndexDiff *self,
+                    ModulemdModuleIndex *old_index,
+                    ModulemdModuleIndex *new_index,
+                    GArray *candidates,
+                    GError **error)
+{
+  g_autoptr (GPtrArray) old_objects = NULL;
+  g_autoptr (GPtrArray) new_objects = NULL;
+  g_autoptr (GPtrArray) old_digests = NULL;
+  g_autoptr (GPtrArray) new_digests = NULL;
+  diff_candidate *candidate = NULL;
+
+  old_objects = g_ptr_array_sized_new (candidates->len);
+  new_objects = g_ptr_array_sized_new (candidates->len);
+
+  for (guint i = 0; i < candidates->len; i++)
+    {
+      candidate = &g_array_index (candidates, diff_candidate, i);
+      g_ptr_array_add (old_objects, candidate->old_object);
+      g_ptr_array_add (new_objects, candidate->new_object);
+    }
+
+  old_digests =
+    modulemd_module_index_get_object_digests (old_index, old_objects, error);
+  if (!old_digests)
+    {
+      return FALSE;
+    }
+
+  new_digests =
+    modulemd_module_index_get_object_digests (new_index, new_objects, error);
+  if (!new_digests)
+    {
+      return FALSE;
+    }
+
+  for (guint i = 0; i < candidates->len; i++)
+    {
+      candidate = &g_array_index (candidates, diff_candidate, i);
+
+      if (!g_str_equal (g_ptr_array_index (old_digests, i),
+                        g_ptr_array_index (new_digests, i)))
+        {
+          add_change (
+            self, candidate->kind, DIFF_CHANGED, candidate->new_object);
+        }
+    }
+
+  return TRUE;
+}
+
+
+ModulemdModuleIndexDiff *
+modulemd_module_index_diff (ModulemdModuleIndex *old_index,
+                            ModulemdModuleIndex *new_index,
+                            GError **error)
+{
+  g_autoptr (ModulemdModuleIndexDiff) self = NULL;
+  g_autoptr (GArray) candidates = NULL;
+  g_auto (GStrv) old_names = NULL;
+  g_auto (GStrv) new_names = NULL;
+  ModulemdModule *old_module = NULL;
+  ModulemdModule *new_module = NULL;
+  gint cmp;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (old_index), NULL);
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (new_index), NULL);
+
+  self = g_object_new (MODULEMD_TYPE_MODULE_INDEX_DIFF, NULL);
+
+  candidates = g_array_new (FALSE, FALSE, sizeof (diff_candidate));
+
+  /* Both lists of names are sorted, so walk them side by side */
+  old_names = modulemd_module_index_get_module_names_as_strv (old_index);
+  new_names = modulemd_module_index_get_module_names_as_strv (new_index);
+
+  for (gsize i = 0, j = 0; old_names[i] || new_names[j];)
+    {
+      if (!old_names[i])
+        {
+          cmp = 1;
+        }
+      else if (!new_names[j])
+        {
+          cmp = -1;
+        }
+      else
+        {
+          cmp = g_strcmp0 (old_names[i], new_names[j]);
+        }
+
+      old_module = NULL;
+      if (cmp <= 0)
+        {
+          old_module =
+            modulemd_module_index_get_module (old_index, old_names[i++]);
+        }
+
+      new_module = NULL;
+      if (cmp >= 0)
+        {
+          new_module =
+            modulemd_module_index_get_module (new_index, new_names[j++]);
+        }
+
+      diff_modules (self, old_module, new_module, candidates);
+    }
+
+  if (!resolve_candidates (self, old_index, new_index, candidates, error))
+    {
+      return NULL;
+    }
+
+  return g_steal_pointer (&self);
+}
+
+
+gboolean
+modulemd_module_index_diff_is_empty (ModulemdModuleIndexDiff *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX_DIFF (self), FALSE);
+
+  for (guint kind = 0; kind < DIFF_N_KINDS; kind++)
+    {
+      for (guint change = 0; change < DIFF_N_CHANGES; change++)
+        {
+          if (self->changes[kind][change]->len > 0)
+            {
+              return FALSE;
+            }
+        }
+    }
+
+  return TRUE;
+}
+
+
+static GPtrArray *
+get_changes (ModulemdModuleIndexDiff *self,
+             diff_kind kind,
+             diff_change change)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX_DIFF (self), NULL);
+
+  return self->changes[kind][change];
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_added_streams (ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_STREAMS, DIFF_ADDED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_removed_streams (ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_STREAMS, DIFF_REMOVED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_changed_streams (ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_STREAMS, DIFF_CHANGED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_added_defaults (ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_DEFAULTS, DIFF_ADDED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_removed_defaults (
+  ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_DEFAULTS, DIFF_REMOVED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_changed_defaults (
+  ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_DEFAULTS, DIFF_CHANGED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_added_obsoletes (ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_OBSOLETES, DIFF_ADDED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_removed_obsoletes (
+  ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_OBSOLETES, DIFF_REMOVED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_changed_obsoletes (
+  ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_OBSOLETES, DIFF_CHANGED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_added_translations (
+  ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_TRANSLATIONS, DIFF_ADDED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_removed_translations (
+  ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_TRANSLATIONS, DIFF_REMOVED);
+}
+
+
+GPtrArray *
+modulemd_module_index_diff_get_changed_translations (
+  ModulemdModuleIndexDiff *self)
+{
+  return get_changes (self, DIFF_TRANSLATIONS, DIFF_CHANGED);
+}
@@ -12,9 +12,15 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
+#include <gio/gio.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <yaml.h>
 
 #ifdef HAVE_RPMIO
@@ -27,19 +33,27 @@
 #include "modulemd-module-index.h"
 #include "modulemd-subdocument-info.h"
 #include "private/glib-extensions.h"
+#include "private/modulemd-compactor.h"
 #include "private/modulemd-compression-private.h"
 #include "private/modulemd-defaults-private.h"
 #include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-document-reader-private.h"
+#include "private/modulemd-json.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-module-index-private.h"
 #include "private/modulemd-module-private.h"
 #include "private/modulemd-module-stream-private.h"
 #include "private/modulemd-module-stream-v1-private.h"
 #include "private/modulemd-module-stream-v2-private.h"
+#include "private/modulemd-package-provider-private.h"
 #include "private/modulemd-packager-v3-private.h"
+#include "private/modulemd-profile-private.h"
+#include "private/modulemd-stream-query-private.h"
 #include "private/modulemd-subdocument-info-private.h"
 #include "private/modulemd-translation-private.h"
 #include "private/modulemd-obsoletes-private.h"
 #include "private/modulemd-util.h"
+#include "private/modulemd-yaml-writer.h"
 #include "private/modulemd-yaml.h"
 
 
@@ -54,6 +68,60 @@ struct _ModulemdModuleIndex
 
   ModulemdDefaultsVersionEnum defaults_mdversion;
   ModulemdModuleStreamVersionEnum stream_mdversion;
+
+  /* Lazily-built maps of module name to default stream name. The map for the
+   * generic (NULL) intent is kept in default_streams, maps for named intents
+   * are kept in intent_default_streams keyed by the intent name. They are
+   * dropped whenever the set of defaults in the index changes.
+   */
+  GHashTable *default_streams;
+  GHashTable *intent_default_streams;
+
+  /* The keys of modules in sorted order. Built on demand and dropped
+   * whenever a module is added or removed.
+   */
+  GPtrArray *sorted_module_names;
+
+  /* Set by modulemd_module_index_freeze(). All of the caches above have been
+   * built and nothing may change afterwards.
+   */
+  gboolean frozen;
+
+  /* Set by modulemd_module_index_set_force_validate(). */
+  gboolean force_validate;
+
+  /* Set while modulemd_module_index_set_compact_on_load() is on. Holds the
+   * canonical sets of every stream loaded since, so that streams read from
+   * separate files for each architecture share them too.
+   */
+  ModulemdCompactor *compactor;
+
+  /* Lazily-built map of package name to a #GPtrArray of the
+   * #ModulemdPackageProvider objects for it, in the order returned by
+   * modulemd_module_index_search_package_providers(). Dropped whenever a
+   * module stream is added or removed. Freezing does not build it, so it is
+   * built under providers_lock on first use.
+   */
+  GHashTable *package_providers;
+  GMutex providers_lock;
+
+  /* Content digests of the defaults, translations and obsoletes of a frozen
+   * index, keyed by the object, which cannot change. Streams keep their own
+   * digests along with the generation they were computed at. Filled in by
+   * modulemd_module_index_get_object_digests().
+   */
+  GHashTable *digests;
+
+  /* The digest of the whole index returned by
+   * modulemd_module_index_get_digest(). Only remembered once the index is
+   * frozen, since the objects of a mutable index may change at any time.
+   */
+  gchar *index_digest;
+
+  /* Protects digests and index_digest, since a frozen index may be used from
+   * several threads at once.
+   */
+  GMutex digest_lock;
 };
 
 G_DEFINE_TYPE (ModulemdModuleIndex, modulemd_module_index, G_TYPE_OBJECT)
@@ -72,6 +140,15 @@ modulemd_module_index_finalize (GObject *object)
   ModulemdModuleIndex *self = (ModulemdModuleIndex *)object;
 
   g_clear_pointer (&self->modules, g_hash_table_unref);
+  g_clear_pointer (&self->default_streams, g_hash_table_unref);
+  g_clear_pointer (&self->intent_default_streams, g_hash_table_unref);
+  g_clear_pointer (&self->sorted_module_names, g_ptr_array_unref);
+  g_clear_pointer (&self->package_providers, g_hash_table_unref);
+  g_mutex_clear (&self->providers_lock);
+  g_clear_pointer (&self->digests, g_hash_table_unref);
+  g_clear_pointer (&self->index_digest, g_free);
+  g_mutex_clear (&self->digest_lock);
+  g_clear_pointer (&self->compactor, modulemd_compactor_free);
 
   G_OBJECT_CLASS (modulemd_module_index_parent_class)->finalize (object);
 }
@@ -118,6 +195,60 @@ modulemd_module_index_init (ModulemdModuleIndex *self)
 {
   self->modules =
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  self->intent_default_streams = g_hash_table_new_full (
+    g_str_hash, g_str_equal, g_free, modulemd_hash_table_unref);
+  g_mutex_init (&self->providers_lock);
+  g_mutex_init (&self->digest_lock);
+
+  self->force_validate = FALSE;
+}
+
+
+/*
+ * check_not_frozen:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @error: (out): A #GError that is set if @self is frozen.
+ *
+ * Returns: FALSE and sets @error if @self has been frozen with
+ * modulemd_module_index_freeze() and must not be modified.
+ */
+static gboolean
+check_not_frozen (ModulemdModuleIndex *self, GError **error)
+{
+  if (G_UNLIKELY (self->frozen))
+    {
+      g_set_error_literal (error,
+                           MODULEMD_ERROR,
+                           MMD_ERROR_FROZEN,
+                           "The ModuleIndex is frozen and cannot be modified");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+static void
+invalidate_default_streams (ModulemdModuleIndex *self)
+{
+  g_clear_pointer (&self->default_streams, g_hash_table_unref);
+  g_hash_table_remove_all (self->intent_default_streams);
+}
+
+
+static void
+invalidate_package_providers (ModulemdModuleIndex *self)
+{
+  g_clear_pointer (&self->package_providers, g_hash_table_unref);
+}
+
+
+static void
+invalidate_index_digest (ModulemdModuleIndex *self)
+{
+  g_mutex_lock (&self->digest_lock);
+  g_clear_pointer (&self->index_digest, g_free);
+  g_mutex_unlock (&self->digest_lock);
 }
 
 
@@ -129,231 +260,163 @@ get_or_create_module (ModulemdModuleIndex *self, const gchar *module_name)
     {
       module = modulemd_module_new (module_name);
       g_hash_table_insert (self->modules, g_strdup (module_name), module);
+      g_clear_pointer (&self->sorted_module_names, g_ptr_array_unref);
     }
   return module;
 }
 
 
-static gboolean
-add_subdoc (ModulemdModuleIndex *self,
-            ModulemdSubdocumentInfo *subdoc,
-            gboolean strict,
-            gboolean autogen_module_name,
-            GError **error)
+/*
+ * get_sorted_module_names:
+ * @self: (in): This #ModulemdModuleIndex object.
+ *
+ * Returns: (transfer none) (element-type utf8): The names of all modules in
+ * @self in sorted order. The array is cached and is only valid until the next
+ * time a module is added to or removed from @self.
+ */
+static GPtrArray *
+get_sorted_module_names (ModulemdModuleIndex *self)
 {
-  g_autoptr (GError) nested_error = NULL;
-  g_autoptr (ModulemdModuleStream) stream = NULL;
-  g_autoptr (ModulemdTranslation) translation = NULL;
-  g_autoptr (ModulemdObsoletes) obsoletes = NULL;
-  g_autoptr (ModulemdDefaults) defaults = NULL;
-  ModulemdYamlDocumentTypeEnum doctype =
-    modulemd_subdocument_info_get_doctype (subdoc);
-
-  switch (doctype)
+  if (!self->sorted_module_names)
     {
-    case MODULEMD_YAML_DOC_PACKAGER:
-      g_set_error (error,
-                   MODULEMD_YAML_ERROR,
-                   MMD_YAML_ERROR_PARSE,
-                   "modulemd-packager document ignored while reading into a "
-                   "module index");
-      return FALSE;
-
-    case MODULEMD_YAML_DOC_MODULESTREAM:
-      switch (modulemd_subdocument_info_get_mdversion (subdoc))
-        {
-        case MD_MODULESTREAM_VERSION_ONE:
-          stream = MODULEMD_MODULE_STREAM (
-            modulemd_module_stream_v1_parse_yaml (subdoc, strict, error));
-          break;
-
-        case MD_MODULESTREAM_VERSION_TWO:
-          stream =
-            MODULEMD_MODULE_STREAM (modulemd_module_stream_v2_parse_yaml (
-              subdoc, strict, FALSE, error));
-          break;
-
-        default:
-          g_set_error (error,
-                       MODULEMD_YAML_ERROR,
-                       MMD_YAML_ERROR_PARSE,
-                       "Invalid mdversion for a stream object");
-          return FALSE;
-        }
-
-      if (stream == NULL)
-        {
-          return FALSE;
-        }
-
-      if (autogen_module_name)
-        {
-          modulemd_module_stream_set_autogen_module_name (
-            stream, g_hash_table_size (self->modules) + 1);
-          modulemd_module_stream_set_autogen_stream_name (
-            stream, g_hash_table_size (self->modules) + 1);
-        }
-
-      if (!modulemd_module_stream_validate (stream, &nested_error))
-        {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
-          return FALSE;
-        }
+      self->sorted_module_names =
+        modulemd_ordered_str_keys (self->modules, modulemd_strcmp_sort);
+    }
 
-      if (!modulemd_module_index_add_module_stream (self, stream, error))
-        {
-          return FALSE;
-        }
+  return self->sorted_module_names;
+}
 
-      break;
 
-    case MODULEMD_YAML_DOC_DEFAULTS:
-      switch (modulemd_subdocument_info_get_mdversion (subdoc))
-        {
-        case MD_DEFAULTS_VERSION_ONE:
-          defaults = (ModulemdDefaults *)modulemd_defaults_v1_parse_yaml (
-            subdoc, strict, error);
-          if (defaults == NULL)
-            {
-              return FALSE;
-            }
+/*
+ * deferred_streams:
+ *
+ * The streams of a load that are older than the stream mdversion its input
+ * was prescanned to need. Adding them after the rest of the input upgrades
+ * each of them at most once: to that mdversion if a document needing it was
+ * really added to the index, and not at all if it failed to load.
+ */
+typedef struct
+{
+  guint64 mdversion;
+  GPtrArray *streams;
+  GPtrArray *subdocs;
+} deferred_streams;
 
-          if (!modulemd_defaults_validate (defaults, &nested_error))
-            {
-              g_propagate_error (error, g_steal_pointer (&nested_error));
-              return FALSE;
-            }
 
-          if (!modulemd_module_index_add_defaults (self, defaults, error))
-            {
-              return FALSE;
-            }
-          break;
+/*
+ * deferred_streams_init:
+ * @deferred: (out): The #deferred_streams to initialize.
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @mdversion: (in): The stream mdversion that the documents about to be loaded
+ * were prescanned to require, or zero if unknown.
+ *
+ * Leaves @deferred empty, so that nothing is deferred, unless @mdversion is
+ * newer than the streams of @self.
+ */
+static void
+deferred_streams_init (deferred_streams *deferred,
+                       ModulemdModuleIndex *self,
+                       guint64 mdversion)
+{
+  deferred->mdversion = 0;
+  deferred->streams = NULL;
+  deferred->subdocs = NULL;
 
-        default:
-          g_set_error (error,
-                       MODULEMD_YAML_ERROR,
-                       MMD_YAML_ERROR_PARSE,
-                       "Invalid mdversion for a defaults object");
-          return FALSE;
-        }
-      break;
+  if (mdversion <= (guint64)self->stream_mdversion ||
+      mdversion > MD_MODULESTREAM_VERSION_LATEST)
+    {
+      return;
+    }
 
-    case MODULEMD_YAML_DOC_TRANSLATIONS:
-      translation = modulemd_translation_parse_yaml (subdoc, strict, error);
-      if (translation == NULL)
-        {
-          return FALSE;
-        }
+  deferred->mdversion = mdversion;
+  deferred->streams = g_ptr_array_new_with_free_func (g_object_unref);
+  deferred->subdocs = g_ptr_array_new_with_free_func (g_object_unref);
+}
 
-      if (!modulemd_translation_validate (translation, &nested_error))
-        {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
-          return FALSE;
-        }
 
-      if (!modulemd_module_index_add_translation (self, translation, error))
-        {
-          return FALSE;
-        }
-      break;
+static void
+deferred_streams_clear (deferred_streams *deferred)
+{
+  g_clear_pointer (&deferred->streams, g_ptr_array_unref);
+  g_clear_pointer (&deferred->subdocs, g_ptr_array_unref);
+}
 
-    case MODULEMD_YAML_DOC_OBSOLETES:
-      obsoletes = modulemd_obsoletes_parse_yaml (subdoc, strict, error);
-      if (obsoletes == NULL)
-        {
-          return FALSE;
-        }
 
-      if (!modulemd_obsoletes_validate (obsoletes, &nested_error))
-        {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
-          return FALSE;
-        }
+/*
+ * defer_stream:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @deferred: (in) (nullable): The streams deferred by the current load.
+ * @stream: (in): A stream that was just parsed from @subdoc.
+ * @subdoc: (in): The #ModulemdSubdocumentInfo @stream was parsed from.
+ *
+ * Returns: TRUE if @stream was added to @deferred instead of @self.
+ */
+static gboolean
+defer_stream (ModulemdModuleIndex *self,
+              deferred_streams *deferred,
+              ModulemdModuleStream *stream,
+              ModulemdSubdocumentInfo *subdoc)
+{
+  if (deferred == NULL || deferred->streams == NULL)
+    {
+      return FALSE;
+    }
 
-      if (!modulemd_module_index_add_obsoletes (self, obsoletes, error))
-        {
-          return FALSE;
-        }
-      break;
+  /* Once the index has been upgraded, streams are upgraded as they are added
+   */
+  if ((guint64)self->stream_mdversion >= deferred->mdversion ||
+      modulemd_module_stream_get_mdversion (stream) >= deferred->mdversion)
+    {
+      return FALSE;
+    }
 
-    default:
-      g_set_error (error,
-                   MODULEMD_YAML_ERROR,
-                   MMD_YAML_ERROR_PARSE,
-                   "Invalid doctype encountered");
+  /* Generated module names are numbered after the modules already added */
+  if (modulemd_module_stream_is_autogen_module_name (stream))
+    {
       return FALSE;
     }
 
+  g_ptr_array_add (deferred->streams, g_object_ref (stream));
+  g_ptr_array_add (deferred->subdocs, g_object_ref (subdoc));
+
   return TRUE;
 }
 
 
-gboolean
-modulemd_module_index_update_from_parser (ModulemdModuleIndex *self,
-                                          yaml_parser_t *parser,
-                                          gboolean strict,
-                                          gboolean autogen_module_name,
-                                          GPtrArray **failures,
-                                          GError **error)
+/*
+ * add_deferred_streams:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @deferred: (in): The streams deferred by the current load.
+ * @failures: (in): The array that the subdocuments of the streams that cannot
+ * be added are added to.
+ *
+ * Returns: FALSE if any of the streams was added to @failures.
+ */
+static gboolean
+add_deferred_streams (ModulemdModuleIndex *self,
+                      deferred_streams *deferred,
+                      GPtrArray *failures)
 {
-  gboolean done = FALSE;
   gboolean all_passed = TRUE;
-  g_autoptr (ModulemdSubdocumentInfo) subdoc = NULL;
-  MMD_INIT_YAML_EVENT (event);
-
-  if (*failures == NULL)
-    {
-      *failures = g_ptr_array_new_with_free_func (g_object_unref);
-    }
+  ModulemdSubdocumentInfo *subdoc = NULL;
 
-  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
-  if (event.type != YAML_STREAM_START_EVENT)
+  if (deferred->streams == NULL)
     {
-      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
-        error, event, "Did not encounter stream start");
+      return TRUE;
     }
 
-  while (!done)
+  for (guint i = 0; i < deferred->streams->len; i++)
     {
-      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+      g_autoptr (GError) nested_error = NULL;
 
-      switch (event.type)
+      if (!modulemd_module_index_add_module_stream (
+            self, g_ptr_array_index (deferred->streams, i), &nested_error))
         {
-        case YAML_DOCUMENT_START_EVENT:
-          /* One more subdocument to parse */
-          subdoc = modulemd_yaml_parse_document_type (parser);
-          if (modulemd_subdocument_info_get_gerror (subdoc) != NULL)
-            {
-              /* Add to failures and ignore */
-              g_ptr_array_add (*failures, g_steal_pointer (&subdoc));
-              all_passed = FALSE;
-            }
-          else
-            {
-              /* Initial parsing worked, parse further */
-              g_autoptr (GError) subdoc_error = NULL;
-              if (!add_subdoc (
-                    self, subdoc, strict, autogen_module_name, &subdoc_error))
-                {
-                  modulemd_subdocument_info_set_gerror (subdoc, subdoc_error);
-                  /* Add to failures and ignore */
-                  g_ptr_array_add (*failures, g_steal_pointer (&subdoc));
-                  all_passed = FALSE;
-                }
-            }
-          g_clear_pointer (&subdoc, g_object_unref);
-          break;
-
-        case YAML_STREAM_END_EVENT: done = TRUE; break;
-
-        default:
-          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
-            error, event, "Unexpected YAML event in document stream");
-          break;
+          subdoc = g_ptr_array_index (deferred->subdocs, i);
+          modulemd_subdocument_info_set_gerror (subdoc, nested_error);
+          g_ptr_array_add (failures, g_object_ref (subdoc));
+          all_passed = FALSE;
         }
-
-      yaml_event_delete (&event);
     }
 
   return all_passed;
@@ -361,1329 +424,5846 @@ modulemd_module_index_update_from_parser (ModulemdModuleIndex *self,
 
 
 static gboolean
-dump_defaults (ModulemdModule *module, yaml_emitter_t *emitter, GError **error)
+add_subdoc (ModulemdModuleIndex *self,
+            ModulemdSubdocumentInfo *subdoc,
+            gboolean strict,
+            gboolean autogen_module_name,
+            deferred_streams *deferred,
+            GError **error)
 {
-  ModulemdDefaults *defaults = modulemd_module_get_defaults (module);
-  g_autoptr (GError) nested_error = NULL;
-
-  if (defaults == NULL)
-    {
-      return TRUE; /* Nothing to dump -> all a success */
-    }
-
-  if (!modulemd_defaults_validate (defaults, &nested_error))
+  g_autoptr (GObject) object = NULL;
+
+  object = modulemd_document_reader_parse_subdoc (
+    subdoc,
+    strict,
+    autogen_module_name ? g_hash_table_size (self->modules) + 1 : 0,
+    error);
+  if (object == NULL)
     {
-      g_propagate_prefixed_error (error,
-                                  g_steal_pointer (&nested_error),
-                                  "Could not validate defaults to emit: ");
       return FALSE;
     }
 
-  if (modulemd_defaults_get_mdversion (defaults) == MD_DEFAULTS_VERSION_ONE)
+  if (MODULEMD_IS_MODULE_STREAM (object))
     {
-      if (!modulemd_defaults_v1_emit_yaml (
-            (ModulemdDefaultsV1 *)defaults, emitter, error))
+      /* Sharing the sets before the next document is parsed lets the
+       * parser reuse the memory of the duplicates.
+       */
+      if (self->compactor && MODULEMD_IS_MODULE_STREAM_V2 (object))
         {
-          return FALSE;
+          modulemd_module_stream_v2_compact (
+            MODULEMD_MODULE_STREAM_V2 (object), self->compactor);
+        }
+
+      if (defer_stream (
+            self, deferred, MODULEMD_MODULE_STREAM (object), subdoc))
+        {
+          return TRUE;
         }
+
+      return modulemd_module_index_add_module_stream (
+        self, MODULEMD_MODULE_STREAM (object), error);
     }
-  else
+
+  if (MODULEMD_IS_DEFAULTS (object))
     {
-      g_set_error_literal (error,
-                           MODULEMD_ERROR,
-                           MMD_ERROR_VALIDATE,
-                           "Provided defaults is not a recognized version");
-      return FALSE;
+      return modulemd_module_index_add_defaults (
+        self, MODULEMD_DEFAULTS (object), error);
     }
 
-  return TRUE;
-}
+  if (MODULEMD_IS_TRANSLATION (object))
+    {
+      return modulemd_module_index_add_translation (
+        self, MODULEMD_TRANSLATION (object), error);
+    }
 
+  g_assert (MODULEMD_IS_OBSOLETES (object));
+  return modulemd_module_index_add_obsoletes (
+    self, MODULEMD_OBSOLETES (object), error);
+}
 
-static gboolean
-dump_translations (ModulemdModule *module,
-                   yaml_emitter_t *emitter,
-                   GError **error)
+
+/*
+ * progress_reporter:
+ *
+ * Carries progress reports of an asynchronous operation from its worker
+ * thread to the main context of the thread that started it. While a report
+ * is waiting to be dispatched, further updates only replace the counters, so
+ * a slow main loop receives fewer but always up-to-date reports.
+ */
+typedef struct
 {
-  ModulemdTranslation *translation = NULL;
-  gsize i = 0;
-  g_autoptr (GPtrArray) streams =
-    modulemd_module_get_translated_streams (module);
+  gint ref_count;
+  GMutex lock;
+  GMainContext *context;
+  gint priority;
+  ModulemdModuleIndexProgressFunc func;
+  gpointer data;
+  GDestroyNotify data_free;
+  guint64 bytes;
+  guint64 documents;
+  gboolean pending;
+} progress_reporter;
+
+
+static progress_reporter *
+progress_reporter_new (ModulemdModuleIndexProgressFunc func,
+                       gpointer data,
+                       GDestroyNotify data_free,
+                       gint priority)
+{
+  progress_reporter *self = NULL;
 
-  for (i = 0; i < streams->len; i++)
+  if (func == NULL)
     {
-      translation = modulemd_module_get_translation (
-        module, g_ptr_array_index (streams, i));
-
-      if (!modulemd_translation_emit_yaml (translation, emitter, error))
+      if (data_free)
         {
-          return FALSE;
+          data_free (data);
         }
+      return NULL;
     }
 
-  return TRUE;
+  self = g_new0 (progress_reporter, 1);
+  self->ref_count = 1;
+  g_mutex_init (&self->lock);
+  self->context = g_main_context_ref_thread_default ();
+  self->priority = priority;
+  self->func = func;
+  self->data = data;
+  self->data_free = data_free;
+
+  return self;
 }
 
-static gboolean
-dump_obsoletes (ModulemdModule *module,
-                yaml_emitter_t *emitter,
-                GError **error)
+
+static progress_reporter *
+progress_reporter_ref (progress_reporter *self)
 {
-  ModulemdObsoletes *o = NULL;
-  gsize i = 0;
-  GPtrArray *obsoletes = modulemd_module_get_obsoletes (module);
+  g_atomic_int_inc (&self->ref_count);
+  return self;
+}
 
-  for (i = 0; i < obsoletes->len; i++)
+
+static void
+progress_reporter_unref (progress_reporter *self)
+{
+  if (!g_atomic_int_dec_and_test (&self->ref_count))
     {
-      o = g_ptr_array_index (obsoletes, i);
+      return;
+    }
 
-      if (!modulemd_obsoletes_emit_yaml (o, emitter, error))
-        {
-          return FALSE;
-        }
+  if (self->data_free)
+    {
+      self->data_free (self->data);
     }
+  g_main_context_unref (self->context);
+  g_mutex_clear (&self->lock);
+  g_free (self);
+}
 
-  return TRUE;
+
+static gboolean
+progress_reporter_dispatch (gpointer user_data)
+{
+  progress_reporter *self = (progress_reporter *)user_data;
+  guint64 bytes;
+  guint64 documents;
+
+  g_mutex_lock (&self->lock);
+  bytes = self->bytes;
+  documents = self->documents;
+  self->pending = FALSE;
+  g_mutex_unlock (&self->lock);
+
+  self->func (bytes, documents, self->data);
+
+  return G_SOURCE_REMOVE;
 }
 
 
-static gint
-compare_stream_SVCA (gconstpointer a, gconstpointer b)
+static void
+progress_reporter_update (progress_reporter *self,
+                          guint64 bytes,
+                          guint64 documents)
 {
-  ModulemdModuleStream *a_ = *(ModulemdModuleStream **)a;
-  ModulemdModuleStream *b_ = *(ModulemdModuleStream **)b;
-  g_autofree gchar *a_nsvca = modulemd_module_stream_get_NSVCA_as_string (a_);
-  g_autofree gchar *b_nsvca = modulemd_module_stream_get_NSVCA_as_string (b_);
-  return g_strcmp0 (a_nsvca, b_nsvca);
+  GSource *source = NULL;
+
+  g_mutex_lock (&self->lock);
+  self->bytes = bytes;
+  self->documents = documents;
+
+  if (!self->pending)
+    {
+      self->pending = TRUE;
+
+      /* Attached in order with the completion of the GTask, which uses the
+       * same context and priority, so the last report always arrives before
+       * the operation's callback is called.
+       */
+      source = g_idle_source_new ();
+      g_source_set_priority (source, self->priority);
+      g_source_set_callback (source,
+                             progress_reporter_dispatch,
+                             progress_reporter_ref (self),
+                             (GDestroyNotify)progress_reporter_unref);
+      g_source_attach (source, self->context);
+      g_source_unref (source);
+    }
+  g_mutex_unlock (&self->lock);
 }
 
 
-static gboolean
-dump_streams (ModulemdModule *module, yaml_emitter_t *emitter, GError **error)
+/*
+ * io_monitor:
+ *
+ * The cancellation and progress state of a load or dump. A NULL monitor
+ * disables both, which is what all of the synchronous functions use.
+ */
+typedef struct
 {
-  ModulemdModuleStream *stream = NULL;
-  gsize i = 0;
-  GPtrArray *streams = modulemd_module_get_all_streams (module);
-  g_autoptr (GError) nested_error = NULL;
+  GCancellable *cancellable;
+  progress_reporter *progress;
+  guint64 bytes;
+  guint64 documents;
+} io_monitor;
 
-  /*
-   * Make sure we get a stable sorting by sorting just before dumping.
-   */
-  g_ptr_array_sort (streams, compare_stream_SVCA);
 
-  for (i = 0; i < streams->len; i++)
+static void
+io_monitor_report (io_monitor *monitor)
+{
+  if (monitor && monitor->progress)
     {
-      stream = (ModulemdModuleStream *)g_ptr_array_index (streams, i);
+      progress_reporter_update (
+        monitor->progress, monitor->bytes, monitor->documents);
+    }
+}
 
-      if (!modulemd_module_stream_validate (stream, &nested_error))
-        {
-          g_propagate_prefixed_error (error,
-                                      g_steal_pointer (&nested_error),
-                                      "Could not validate stream to emit: ");
-          return FALSE;
-        }
 
-      if (modulemd_module_stream_get_mdversion (stream) ==
-          MD_MODULESTREAM_VERSION_ONE)
-        {
-          if (!modulemd_module_stream_v1_emit_yaml (
-                MODULEMD_MODULE_STREAM_V1 (stream), emitter, error))
-            {
-              return FALSE;
-            }
-        }
-      else if (modulemd_module_stream_get_mdversion (stream) ==
-               MD_MODULESTREAM_VERSION_TWO)
-        {
-          if (!modulemd_module_stream_v2_emit_yaml (
-                MODULEMD_MODULE_STREAM_V2 (stream), emitter, error))
-            {
-              return FALSE;
-            }
-        }
-      else
-        {
-          g_set_error_literal (error,
-                               MODULEMD_ERROR,
-                               MMD_ERROR_VALIDATE,
-                               "Provided stream is not a recognized version");
-          return FALSE;
-        }
+/*
+ * io_monitor_documents_done:
+ * @monitor: (in) (nullable): The #io_monitor of the operation.
+ * @n_documents: (in): The number of subdocuments just processed.
+ * @error: (out): A #GError that is set if the operation was cancelled.
+ *
+ * Records the progress made and checks for cancellation. This must only be
+ * called at subdocument boundaries.
+ *
+ * Returns: FALSE if the operation was cancelled.
+ */
+static gboolean
+io_monitor_documents_done (io_monitor *monitor,
+                           guint64 n_documents,
+                           GError **error)
+{
+  if (monitor == NULL)
+    {
+      return TRUE;
     }
 
-  return TRUE;
+  monitor->documents += n_documents;
+  io_monitor_report (monitor);
+
+  return !g_cancellable_set_error_if_cancelled (monitor->cancellable, error);
 }
 
 
+/*
+ * add_parsed_subdoc:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @subdoc: (in) (transfer full): A subdocument returned by
+ * modulemd_yaml_parse_document_type() or
+ * modulemd_yaml_parse_json_document_type().
+ * @deferred: (in) (nullable): The streams deferred by the current load.
+ * @failures: (in): The array that @subdoc is added to if it is not valid.
+ *
+ * Returns: FALSE if @subdoc was added to @failures.
+ */
 static gboolean
-modulemd_module_index_dump_to_emitter (ModulemdModuleIndex *self,
-                                       yaml_emitter_t *emitter,
-                                       GError **error)
+add_parsed_subdoc (ModulemdModuleIndex *self,
+                   ModulemdSubdocumentInfo *subdoc,
+                   gboolean strict,
+                   gboolean autogen_module_name,
+                   deferred_streams *deferred,
+                   GPtrArray *failures)
 {
-  ModulemdModule *module = NULL;
-  gsize i;
-  g_autoptr (GPtrArray) modules =
-    modulemd_ordered_str_keys (self->modules, modulemd_strcmp_sort);
+  g_autoptr (ModulemdSubdocumentInfo) owned = subdoc;
+  g_autoptr (GError) subdoc_error = NULL;
 
-  if (modules->len == 0)
+  if (modulemd_subdocument_info_get_gerror (subdoc) != NULL)
     {
-      g_set_error_literal (error,
-                           MODULEMD_ERROR,
-                           MMD_ERROR_VALIDATE,
-                           "Index contains no modules.");
+      /* Add to failures and ignore */
+      g_ptr_array_add (failures, g_steal_pointer (&owned));
       return FALSE;
     }
 
-  if (!mmd_emitter_start_stream (emitter, error))
+  /* Initial parsing worked, parse further */
+  if (!add_subdoc (
+        self, subdoc, strict, autogen_module_name, deferred, &subdoc_error))
     {
+      modulemd_subdocument_info_set_gerror (subdoc, subdoc_error);
+      /* Add to failures and ignore */
+      g_ptr_array_add (failures, g_steal_pointer (&owned));
       return FALSE;
     }
 
-  for (i = 0; i < modules->len; i++)
+  return TRUE;
+}
+
+
+/*
+ * update_from_parser_deferred:
+ * @deferred: (in): The streams deferred by this load.
+ *
+ * Parses and adds the documents of @parser, except for the streams that
+ * defer_stream() takes.
+ */
+static gboolean
+update_from_parser_deferred (ModulemdModuleIndex *self,
+                             yaml_parser_t *parser,
+                             gboolean strict,
+                             gboolean autogen_module_name,
+                             GPtrArray *failures,
+                             io_monitor *monitor,
+                             deferred_streams *deferred,
+                             GError **error)
+{
+  gboolean done = FALSE;
+  gboolean all_passed = TRUE;
+  MMD_INIT_YAML_EVENT (event);
+
+  if (!check_not_frozen (self, error))
     {
-      module = modulemd_module_index_get_module (
-        self, g_ptr_array_index (modules, i));
+      return FALSE;
+    }
 
-      if (!dump_defaults (module, emitter, error))
-        {
-          return FALSE;
-        }
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_STREAM_START_EVENT)
+    {
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "Did not encounter stream start");
+    }
 
-      if (!dump_obsoletes (module, emitter, error))
-        {
-          return FALSE;
-        }
+  while (!done)
+    {
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
 
-      if (!dump_translations (module, emitter, error))
+      switch (event.type)
         {
-          return FALSE;
-        }
+        case YAML_DOCUMENT_START_EVENT:
+          /* One more subdocument to parse */
+          if (!add_parsed_subdoc (self,
+                                  modulemd_yaml_parse_document_type (parser),
+                                  strict,
+                                  autogen_module_name,
+                                  deferred,
+                                  failures))
+            {
+              all_passed = FALSE;
+            }
 
-      if (!dump_streams (module, emitter, error))
-        {
-          return FALSE;
+          if (monitor)
+            {
+              monitor->bytes = parser->offset;
+              if (!io_monitor_documents_done (monitor, 1, error))
+                {
+                  return FALSE;
+                }
+            }
+          break;
+
+        case YAML_STREAM_END_EVENT:
+          if (monitor)
+            {
+              monitor->bytes = parser->offset;
+              io_monitor_report (monitor);
+            }
+          done = TRUE;
+          break;
+
+        default:
+          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+            error, event, "Unexpected YAML event in document stream");
+          break;
         }
-    }
 
-  if (!mmd_emitter_end_stream (emitter, error))
-    {
-      return FALSE;
+      yaml_event_delete (&event);
     }
 
-  return TRUE;
+  return all_passed;
 }
 
 
-gboolean
-modulemd_module_index_update_from_file_ext (ModulemdModuleIndex *self,
-                                            const gchar *yaml_file,
-                                            gboolean strict,
-                                            gboolean autogen_module_name,
-                                            GPtrArray **failures,
-                                            GError **error)
+/*
+ * update_from_parser_monitored:
+ * @monitor: (in) (nullable): The #io_monitor to report progress to and check
+ * for cancellation after each subdocument.
+ * @stream_mdversion_hint: (in): The stream mdversion that the documents of
+ * @parser were prescanned to require, or zero if unknown.
+ *
+ * Otherwise identical to modulemd_module_index_update_from_parser().
+ */
+static gboolean
+update_from_parser_monitored (ModulemdModuleIndex *self,
+                              yaml_parser_t *parser,
+                              gboolean strict,
+                              gboolean autogen_module_name,
+                              GPtrArray **failures,
+                              io_monitor *monitor,
+                              guint64 stream_mdversion_hint,
+                              GError **error)
 {
+  deferred_streams deferred;
+  gboolean ret;
+
   if (*failures == NULL)
     {
-      *failures = g_ptr_array_new_full (0, g_object_unref);
+      *failures = g_ptr_array_new_with_free_func (g_object_unref);
     }
 
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
-
-  MMD_INIT_YAML_PARSER (parser);
-  int saved_errno;
-  g_autoptr (FILE) yaml_stream = NULL;
-  g_autoptr (GError) nested_error = NULL;
-  int fd;
-  ModulemdCompressionTypeEnum comtype;
-  g_autofree gchar *fmode = NULL;
-
-  yaml_stream = g_fopen (yaml_file, "rbe");
-  saved_errno = errno;
+  deferred_streams_init (&deferred, self, stream_mdversion_hint);
 
-  if (yaml_stream == NULL)
-    {
-      g_set_error (error,
-                   MODULEMD_YAML_ERROR,
-                   MMD_YAML_ERROR_OPEN,
-                   "Failed to open file: %s",
-                   g_strerror (saved_errno));
-      return FALSE;
-    }
+  ret = update_from_parser_deferred (self,
+                                     parser,
+                                     strict,
+                                     autogen_module_name,
+                                     *failures,
+                                     monitor,
+                                     &deferred,
+                                     error);
 
-  /* To avoid TOCTOU race conditions, do everything from the same opened
-   * file
+  /* Streams parsed before an error are kept, as they would have been without
+   * deferring them.
    */
-  fd = fileno (yaml_stream);
-
-  /* Determine if the file is compressed */
-  comtype = modulemd_detect_compression (yaml_file, fd, &nested_error);
-  if (comtype == MODULEMD_COMPRESSION_TYPE_DETECTION_FAILED)
+  if (!add_deferred_streams (self, &deferred, *failures))
     {
-      g_propagate_error (error, g_steal_pointer (&nested_error));
-      return FALSE;
+      ret = FALSE;
     }
-  if (comtype == MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION ||
-      comtype == MODULEMD_COMPRESSION_TYPE_UNKNOWN_COMPRESSION)
-    {
-      /* If it's not compressed (or we can't figure out what compression is in
-       * use), just use the libyaml function. It's fast and will fail quickly
-       * if the file is unreadable.
-       */
 
-      yaml_parser_set_input_file (&parser, yaml_stream);
+  deferred_streams_clear (&deferred);
 
-      return modulemd_module_index_update_from_parser (
-        self, &parser, strict, autogen_module_name, failures, error);
-    }
+  return ret;
+}
 
-#ifdef HAVE_RPMIO
-  /* We're handling a compressed input file, so we'll use librpm's "rpmio"
-   * suite of tools to deal with it. We need to construct a special "mode"
+
+gboolean
+modulemd_module_index_update_from_parser (ModulemdModuleIndex *self,
+                                          yaml_parser_t *parser,
+                                          gboolean strict,
+                                          gboolean autogen_module_name,
+                                          GPtrArray **failures,
+                                          GError **error)
+{
+  return update_from_parser_monitored (
+    self, parser, strict, autogen_module_name, failures, NULL, 0, error);
+}
+
+
+/*
+ * update_from_json_parser:
+ * @parser: (inout): A libyaml parser reading a JSON array of documents, as
+ * written by modulemd_module_index_dump_to_json().
+ *
+ * JSON is a subset of the YAML flow syntax, so libyaml reads it as a single
+ * YAML document holding a sequence, each element of which is handled like a
+ * subdocument of a YAML stream.
+ *
+ * Otherwise identical to modulemd_module_index_update_from_parser().
+ */
+static gboolean
+update_from_json_parser (ModulemdModuleIndex *self,
+                         yaml_parser_t *parser,
+                         gboolean strict,
+                         GPtrArray **failures,
+                         GError **error)
+{
+  gboolean done = FALSE;
+  gboolean all_passed = TRUE;
+  MMD_INIT_YAML_EVENT (event);
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_STREAM_START_EVENT)
+    {
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "Did not encounter stream start");
+    }
+  yaml_event_delete (&event);
+
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_DOCUMENT_START_EVENT)
+    {
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (error, event, "JSON input is empty");
+    }
+  yaml_event_delete (&event);
+
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_SEQUENCE_START_EVENT)
+    {
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "JSON input must be an array of documents");
+    }
+  yaml_event_delete (&event);
+
+  while (!done)
+    {
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+
+      switch (event.type)
+        {
+        case YAML_MAPPING_START_EVENT:
+          /* One more document to parse. It takes over the event. */
+          if (!add_parsed_subdoc (
+                self,
+                modulemd_yaml_parse_json_document_type (parser, &event),
+                strict,
+                FALSE,
+                NULL,
+                *failures))
+            {
+              all_passed = FALSE;
+            }
+          break;
+
+        case YAML_SEQUENCE_END_EVENT: done = TRUE; break;
+
+        default:
+          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+            error, event, "JSON documents must be objects");
+          break;
+        }
+
+      yaml_event_delete (&event);
+    }
+
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_DOCUMENT_END_EVENT)
+    {
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "Unexpected data after the array of documents");
+    }
+  yaml_event_delete (&event);
+
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_STREAM_END_EVENT)
+    {
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "Unexpected data after the array of documents");
+    }
+
+  return all_passed;
+}
+
+
+static gboolean
+dump_defaults (ModulemdModule *module, yaml_emitter_t *emitter, GError **error)
+{
+  ModulemdDefaults *defaults = modulemd_module_get_defaults (module);
+  g_autoptr (GError) nested_error = NULL;
+
+  if (defaults == NULL)
+    {
+      return TRUE; /* Nothing to dump -> all a success */
+    }
+
+  if (!modulemd_defaults_validate (defaults, &nested_error))
+    {
+      g_propagate_prefixed_error (error,
+                                  g_steal_pointer (&nested_error),
+                                  "Could not validate defaults to emit: ");
+      return FALSE;
+    }
+
+  if (modulemd_defaults_get_mdversion (defaults) == MD_DEFAULTS_VERSION_ONE)
+    {
+      if (!modulemd_defaults_v1_emit_yaml (
+            (ModulemdDefaultsV1 *)defaults, emitter, error))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      g_set_error_literal (error,
+                           MODULEMD_ERROR,
+                           MMD_ERROR_VALIDATE,
+                           "Provided defaults is not a recognized version");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+dump_translations (ModulemdModule *module,
+                   yaml_emitter_t *emitter,
+                   GError **error)
+{
+  ModulemdTranslation *translation = NULL;
+  gsize i = 0;
+  g_autoptr (GPtrArray) streams =
+    modulemd_module_get_translated_streams (module);
+
+  for (i = 0; i < streams->len; i++)
+    {
+      translation = modulemd_module_get_translation (
+        module, g_ptr_array_index (streams, i));
+
+      if (!modulemd_translation_emit_yaml (translation, emitter, error))
+        {
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static gboolean
+dump_obsoletes (ModulemdModule *module,
+                yaml_emitter_t *emitter,
+                GError **error)
+{
+  ModulemdObsoletes *o = NULL;
+  gsize i = 0;
+  GPtrArray *obsoletes = modulemd_module_get_obsoletes (module);
+
+  for (i = 0; i < obsoletes->len; i++)
+    {
+      o = g_ptr_array_index (obsoletes, i);
+
+      if (!modulemd_obsoletes_emit_yaml (o, emitter, error))
+        {
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+static gint
+compare_stream_SVCA (gconstpointer a, gconstpointer b)
+{
+  ModulemdModuleStream *a_ = *(ModulemdModuleStream **)a;
+  ModulemdModuleStream *b_ = *(ModulemdModuleStream **)b;
+  g_autofree gchar *a_nsvca = modulemd_module_stream_get_NSVCA_as_string (a_);
+  g_autofree gchar *b_nsvca = modulemd_module_stream_get_NSVCA_as_string (b_);
+  return g_strcmp0 (a_nsvca, b_nsvca);
+}
+
+
+static gboolean
+dump_streams (ModulemdModule *module,
+              gboolean force_validate,
+              yaml_emitter_t *emitter,
+              GError **error)
+{
+  ModulemdModuleStream *stream = NULL;
+  gsize i = 0;
+  GPtrArray *streams = modulemd_module_get_all_streams (module);
+  g_autoptr (GError) nested_error = NULL;
+
+  /*
+   * Make sure we get a stable sorting by sorting just before dumping. The
+   * streams of a frozen module were sorted when it was frozen.
+   */
+  if (!modulemd_module_is_frozen (module))
+    {
+      g_ptr_array_sort (streams, compare_stream_SVCA);
+    }
+
+  for (i = 0; i < streams->len; i++)
+    {
+      stream = (ModulemdModuleStream *)g_ptr_array_index (streams, i);
+
+      /* Streams that were validated when they were loaded or last dumped
+       * and have not been modified since are not validated again.
+       */
+      if (force_validate || !modulemd_module_stream_is_validated (stream))
+        {
+          if (!modulemd_module_stream_validate (stream, &nested_error))
+            {
+              g_propagate_prefixed_error (
+                error,
+                g_steal_pointer (&nested_error),
+                "Could not validate stream to emit: ");
+              return FALSE;
+            }
+
+          /* The streams of a frozen module may be dumped by several threads
+           * at once, so they are left untouched.
+           */
+          if (!modulemd_module_is_frozen (module))
+            {
+              modulemd_module_stream_mark_validated (stream);
+            }
+        }
+
+      if (modulemd_module_stream_get_mdversion (stream) ==
+          MD_MODULESTREAM_VERSION_ONE)
+        {
+          if (!modulemd_module_stream_v1_emit_yaml (
+                MODULEMD_MODULE_STREAM_V1 (stream), emitter, error))
+            {
+              return FALSE;
+            }
+        }
+      else if (modulemd_module_stream_get_mdversion (stream) ==
+               MD_MODULESTREAM_VERSION_TWO)
+        {
+          if (!modulemd_module_stream_v2_emit_yaml (
+                MODULEMD_MODULE_STREAM_V2 (stream), emitter, error))
+            {
+              return FALSE;
+            }
+        }
+      else
+        {
+          g_set_error_literal (error,
+                               MODULEMD_ERROR,
+                               MMD_ERROR_VALIDATE,
+                               "Provided stream is not a recognized version");
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+dump_module (ModulemdModule *module,
+             gboolean force_validate,
+             yaml_emitter_t *emitter,
+             GError **error)
+{
+  if (!dump_defaults (module, emitter, error))
+    {
+      return FALSE;
+    }
+
+  if (!dump_obsoletes (module, emitter, error))
+    {
+      return FALSE;
+    }
+
+  if (!dump_translations (module, emitter, error))
+    {
+      return FALSE;
+    }
+
+  if (!dump_streams (module, force_validate, emitter, error))
+    {
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+/*
+ * io_monitor_module_done:
+ * @monitor: (in) (nullable): The #io_monitor of the dump.
+ * @module: (in): The #ModulemdModule that was just written.
+ * @error: (out): A #GError that is set if the dump was cancelled.
+ *
+ * Returns: FALSE if the dump was cancelled.
+ */
+static gboolean
+io_monitor_module_done (io_monitor *monitor,
+                        ModulemdModule *module,
+                        GError **error)
+{
+  guint64 n_documents;
+  g_autoptr (GPtrArray) translations = NULL;
+
+  if (monitor == NULL)
+    {
+      return TRUE;
+    }
+
+  /* One subdocument per object written by dump_module() */
+  translations = modulemd_module_get_translated_streams (module);
+  n_documents = translations->len;
+  n_documents += modulemd_module_get_obsoletes (module)->len;
+  n_documents += modulemd_module_get_all_streams (module)->len;
+  if (modulemd_module_get_defaults (module))
+    {
+      n_documents++;
+    }
+
+  return io_monitor_documents_done (monitor, n_documents, error);
+}
+
+
+/* Indexes with fewer modules than this are always dumped serially; the
+ * thread startup cost outweighs the gain for small indexes.
+ */
+#define MMD_PARALLEL_DUMP_MIN_MODULES 64
+
+typedef struct
+{
+  ModulemdModule *module;
+  gboolean force_validate;
+  gboolean direct;
+  modulemd_yaml_string *yaml;
+  int open_ended;
+  GError *error;
+} dump_module_task;
+
+
+/* Renders all of the subdocuments of a module into a private buffer. Every
+ * subdocument is emitted with explicit start and end markers, so the
+ * emitter returns to its initial state after each one and the buffers of
+ * consecutive modules can be concatenated to produce the same output as a
+ * single emitter would.
+ */
+static void
+dump_module_worker (gpointer data, gpointer user_data)
+{
+  dump_module_task *task = (dump_module_task *)data;
+  GCancellable *cancellable = (GCancellable *)user_data;
+
+  /* Don't render the remaining modules once the dump has been cancelled */
+  if (g_cancellable_set_error_if_cancelled (cancellable, &task->error))
+    {
+      return;
+    }
+
+  MMD_INIT_YAML_EMITTER (emitter);
+  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+  g_autoptr (modulemd_yaml_writer) writer = NULL;
+
+  /* Render the module the same way as the caller's emitter would */
+  if (task->direct)
+    {
+      writer = modulemd_yaml_writer_new (&emitter);
+    }
+
+  if (!mmd_emitter_start_stream (&emitter, &task->error))
+    {
+      return;
+    }
+
+  if (!dump_module (
+        task->module, task->force_validate, &emitter, &task->error))
+    {
+      return;
+    }
+
+  /* Don't end the stream here, that is left to the caller's emitter */
+  if (!mmd_emitter_flush (&emitter))
+    {
+      g_set_error (&task->error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_EMIT,
+                   "Could not flush the YAML output of module %s",
+                   modulemd_module_get_module_name (task->module));
+      return;
+    }
+
+  task->open_ended = emitter.open_ended;
+  task->yaml = g_steal_pointer (&yaml_string);
+}
+
+
+/*
+ * dump_modules_parallel:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @modules: (in): The sorted names of all modules in @self.
+ * @emitter: (inout): A libyaml emitter whose stream has been started.
+ * @monitor: (in) (nullable): The #io_monitor to report progress to and check
+ * for cancellation after each module is written.
+ * @error: (out): A #GError containing the reason for a failure.
+ *
+ * Validates and renders the subdocuments of each module on a thread pool,
+ * then writes them to @emitter in the order of @modules. The output is
+ * identical to that of emitting the modules one after another.
+ *
+ * Returns: TRUE if all modules were written. FALSE and sets @error to the
+ * error of the first failing module in @modules order otherwise.
+ */
+static gboolean
+dump_modules_parallel (ModulemdModuleIndex *self,
+                       GPtrArray *modules,
+                       yaml_emitter_t *emitter,
+                       io_monitor *monitor,
+                       GError **error)
+{
+  GThreadPool *pool = NULL;
+  g_autofree dump_module_task *tasks = NULL;
+  gboolean ret = TRUE;
+  gsize i;
+
+  tasks = g_new0 (dump_module_task, modules->len);
+
+  pool = g_thread_pool_new (dump_module_worker,
+                            monitor ? monitor->cancellable : NULL,
+                            (gint)g_get_num_processors (),
+                            FALSE,
+                            error);
+  if (!pool)
+    {
+      return FALSE;
+    }
+
+  for (i = 0; i < modules->len; i++)
+    {
+      tasks[i].module = modulemd_module_index_get_module (
+        self, g_ptr_array_index (modules, i));
+      tasks[i].force_validate = self->force_validate;
+      tasks[i].direct = mmd_emitter_is_direct (emitter);
+      g_thread_pool_push (pool, &tasks[i], NULL);
+    }
+
+  /* Wait for all queued modules to be rendered */
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  if (!mmd_emitter_flush (emitter))
+    {
+      g_set_error_literal (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_EMIT,
+                           "Could not flush the YAML output");
+      ret = FALSE;
+    }
+
+  for (i = 0; i < modules->len; i++)
+    {
+      if (!ret)
+        {
+          g_clear_error (&tasks[i].error);
+        }
+      else if (tasks[i].error)
+        {
+          g_propagate_error (error, g_steal_pointer (&tasks[i].error));
+          ret = FALSE;
+        }
+      else if (!emitter->write_handler (emitter->write_handler_data,
+                                        (unsigned char *)tasks[i].yaml->str,
+                                        tasks[i].yaml->len))
+        {
+          g_set_error_literal (error,
+                               MODULEMD_YAML_ERROR,
+                               MMD_YAML_ERROR_EMIT,
+                               "Could not write the YAML output");
+          ret = FALSE;
+        }
+      else if (!io_monitor_module_done (monitor, tasks[i].module, error))
+        {
+          ret = FALSE;
+        }
+
+      g_clear_pointer (&tasks[i].yaml, modulemd_yaml_string_free);
+    }
+
+  /* Carry over the state that decides how the stream is ended */
+  if (ret)
+    {
+      emitter->open_ended = tasks[modules->len - 1].open_ended;
+    }
+
+  return ret;
+}
+
+
+static gboolean
+modulemd_module_index_dump_to_emitter (ModulemdModuleIndex *self,
+                                       yaml_emitter_t *emitter,
+                                       io_monitor *monitor,
+                                       GError **error)
+{
+  ModulemdModule *module = NULL;
+  gsize i;
+  GPtrArray *modules = get_sorted_module_names (self);
+  g_autoptr (modulemd_yaml_writer) writer = NULL;
+
+  if (modules->len == 0)
+    {
+      g_set_error_literal (error,
+                           MODULEMD_ERROR,
+                           MMD_ERROR_VALIDATE,
+                           "Index contains no modules.");
+      return FALSE;
+    }
+
+  /* YAML is written directly rather than by libyaml */
+  if (!mmd_emitter_is_json (emitter))
+    {
+      writer = modulemd_yaml_writer_new (emitter);
+    }
+
+  if (!mmd_emitter_start_stream (emitter, error))
+    {
+      return FALSE;
+    }
+
+  /* The parallel dump writes the YAML of each module verbatim, which
+   * cannot be done for JSON output.
+   */
+  if (modules->len >= MMD_PARALLEL_DUMP_MIN_MODULES &&
+      g_get_num_processors () > 1 && !mmd_emitter_is_json (emitter))
+    {
+      if (!dump_modules_parallel (self, modules, emitter, monitor, error))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      for (i = 0; i < modules->len; i++)
+        {
+          module = modulemd_module_index_get_module (
+            self, g_ptr_array_index (modules, i));
+
+          if (!dump_module (module, self->force_validate, emitter, error))
+            {
+              return FALSE;
+            }
+
+          if (!io_monitor_module_done (monitor, module, error))
+            {
+              return FALSE;
+            }
+        }
+    }
+
+  if (!mmd_emitter_end_stream (emitter, error))
+    {
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+/*
+ * prescan_decompressor:
+ * @decompressor: (in) (transfer full): A #ModulemdDecompressor of the input
+ * about to be loaded, which is only used for the prescan.
+ *
+ * Decompressed input cannot be rewound, so it is decompressed one more time,
+ * without being parsed, to prescan it. The prescan stops at the first
+ * subdocument requiring the newest stream mdversion, which in metadata of
+ * only v2 streams is the first stream, so only input holding nothing but
+ * older streams is decompressed in full twice. Callers skip the prescan once
+ * @self holds streams of the newest mdversion, as nothing is deferred then.
+ *
+ * Returns: The stream mdversion that the input requires, or zero if unknown.
+ */
+static guint64
+prescan_decompressor (ModulemdDecompressor *decompressor)
+{
+  g_autoptr (ModulemdDecompressor) owned = decompressor;
+  guint64 mdversion = 0;
+
+  /* Decompression errors are reported by the pass that parses the input */
+  if (!modulemd_yaml_prescan_stream_mdversion_from_read_fn (
+        modulemd_decompressor_read_fn, decompressor, &mdversion) ||
+      !modulemd_decompressor_close (decompressor, NULL))
+    {
+      return 0;
+    }
+
+  return mdversion;
+}
+
+
+/*
+ * update_from_decompressor:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @decompressor: (in): A #ModulemdDecompressor providing the YAML input.
+ * @strict: (in): Whether the parser should return failure if it encounters an
+ * unknown mapping key or if it should ignore it.
+ * @autogen_module_name: (in): Whether to autogenerate missing module and
+ * stream names.
+ * @failures: (out): An array of subdocuments that failed to parse.
+ * @monitor: (in) (nullable): The #io_monitor of the operation.
+ * @stream_mdversion_hint: (in): The stream mdversion that the output of
+ * @decompressor was prescanned to require, or zero if unknown.
+ * @error: (out): A #GError containing the reason this function failed.
+ *
+ * Parses the output of @decompressor while it is being decompressed. A
+ * decompression error takes precedence over the parse error it causes.
+ *
+ * Returns: TRUE if the update was successful.
+ */
+static gboolean
+update_from_decompressor (ModulemdModuleIndex *self,
+                          ModulemdDecompressor *decompressor,
+                          gboolean strict,
+                          gboolean autogen_module_name,
+                          GPtrArray **failures,
+                          io_monitor *monitor,
+                          guint64 stream_mdversion_hint,
+                          GError **error)
+{
+  g_autoptr (GError) nested_error = NULL;
+  gboolean ret;
+
+  MMD_INIT_YAML_PARSER (parser);
+  yaml_parser_set_input (&parser, modulemd_decompressor_read_fn, decompressor);
+
+  ret = update_from_parser_monitored (self,
+                                      &parser,
+                                      strict,
+                                      autogen_module_name,
+                                      failures,
+                                      monitor,
+                                      stream_mdversion_hint,
+                                      &nested_error);
+
+  if (!modulemd_decompressor_close (decompressor, error))
+    {
+      return FALSE;
+    }
+
+  if (nested_error)
+    {
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+    }
+
+  return ret;
+}
+
+
+/*
+ * update_from_file_monitored:
+ * @monitor: (in) (nullable): The #io_monitor to report progress to and check
+ * for cancellation after each subdocument.
+ *
+ * Otherwise identical to modulemd_module_index_update_from_file_ext().
+ */
+static gboolean
+update_from_file_monitored (ModulemdModuleIndex *self,
+                            const gchar *yaml_file,
+                            gboolean strict,
+                            gboolean autogen_module_name,
+                            GPtrArray **failures,
+                            io_monitor *monitor,
+                            GError **error)
+{
+  MMD_INIT_YAML_PARSER (parser);
+  int saved_errno;
+  g_autoptr (FILE) yaml_stream = NULL;
+  /* Declared after yaml_stream so that it is freed before the file is closed
+   */
+  g_autoptr (ModulemdDecompressor) decompressor = NULL;
+  g_autoptr (GError) nested_error = NULL;
+  int fd;
+  ModulemdCompressionTypeEnum comtype;
+  g_autofree gchar *fmode = NULL;
+  struct stat statbuf;
+  guint64 prescan_mdversion = 0;
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  yaml_stream = g_fopen (yaml_file, "rbe");
+  saved_errno = errno;
+
+  if (yaml_stream == NULL)
+    {
+      g_set_error (error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_OPEN,
+                   "Failed to open file: %s",
+                   g_strerror (saved_errno));
+      return FALSE;
+    }
+
+  /* To avoid TOCTOU race conditions, do everything from the same opened
+   * file
+   */
+  fd = fileno (yaml_stream);
+
+  /* Determine if the file is compressed */
+  comtype = modulemd_detect_compression (yaml_file, fd, &nested_error);
+  if (comtype == MODULEMD_COMPRESSION_TYPE_DETECTION_FAILED)
+    {
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return FALSE;
+    }
+  if (comtype == MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION ||
+      comtype == MODULEMD_COMPRESSION_TYPE_UNKNOWN_COMPRESSION)
+    {
+      /* If it's not compressed (or we can't figure out what compression is in
+       * use), just use the libyaml function. It's fast and will fail quickly
+       * if the file is unreadable.
+       */
+
+      /* Regular files are cheap to read twice, so look ahead for the stream
+       * mdversion that the index will end up at.
+       */
+      if (fstat (fd, &statbuf) == 0 && S_ISREG (statbuf.st_mode))
+        {
+          if (!modulemd_yaml_prescan_stream_mdversion_from_file (
+                yaml_stream, &prescan_mdversion))
+            {
+              saved_errno = errno;
+              g_set_error (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_OPEN,
+                           "Failed to rewind file: %s",
+                           g_strerror (saved_errno));
+              return FALSE;
+            }
+        }
+
+      yaml_parser_set_input_file (&parser, yaml_stream);
+
+      return update_from_parser_monitored (self,
+                                           &parser,
+                                           strict,
+                                           autogen_module_name,
+                                           failures,
+                                           monitor,
+                                           prescan_mdversion,
+                                           error);
+    }
+
+  if (modulemd_decompressor_supported (comtype))
+    {
+      if (self->stream_mdversion < MD_MODULESTREAM_VERSION_LATEST &&
+          fstat (fd, &statbuf) == 0 && S_ISREG (statbuf.st_mode))
+        {
+          decompressor = modulemd_decompressor_new_for_fd (comtype, fd, error);
+          if (!decompressor)
+            {
+              return FALSE;
+            }
+          prescan_mdversion =
+            prescan_decompressor (g_steal_pointer (&decompressor));
+
+          if (lseek (fd, 0, SEEK_SET) == (off_t)-1)
+            {
+              saved_errno = errno;
+              g_set_error (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_OPEN,
+                           "Failed to rewind file: %s",
+                           g_strerror (saved_errno));
+              return FALSE;
+            }
+        }
+
+      decompressor = modulemd_decompressor_new_for_fd (comtype, fd, error);
+      if (!decompressor)
+        {
+          return FALSE;
+        }
+
+      return update_from_decompressor (self,
+                                       decompressor,
+                                       strict,
+                                       autogen_module_name,
+                                       failures,
+                                       monitor,
+                                       prescan_mdversion,
+                                       error);
+    }
+
+#ifdef HAVE_RPMIO
+  /* We're handling a compressed input file for which there is no native
+   * decompressor, so we'll use librpm's "rpmio"
+   * suite of tools to deal with it. We need to construct a special "mode"
    * argument to pass to Fdopen().
    */
-  FD_t rpmio_fd = NULL;
-  g_auto (FD_t) fd_dup = NULL;
+  FD_t rpmio_fd = NULL;
+  g_auto (FD_t) fd_dup = NULL;
+
+  fmode = modulemd_get_rpmio_fmode ("r", comtype);
+  if (!fmode)
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_FILE_ACCESS,
+                   "Unable to construct rpmio fmode from comtype [%d]",
+                   comtype);
+      return FALSE;
+    }
+
+  /* Create an rpmio file descriptor object from the current file descriptor,
+   * setting the appropriate "mode" so that librpm will read it with the
+   * correct handlers.
+   */
+  fd_dup = fdDup (fd);
+  saved_errno = errno;
+  if (!fd_dup)
+    {
+      g_set_error (
+        error,
+        MODULEMD_ERROR,
+        MMD_ERROR_NOT_IMPLEMENTED,
+        "Cannot open compressed file. Error in rpmio::fdDup(%d): %s",
+        fd,
+        strerror (saved_errno));
+      return FALSE;
+    }
+
+  g_debug ("Calling rpmio::Fdopen (%p, %s)", fd_dup, fmode);
+  rpmio_fd = Fdopen (fd_dup, fmode);
+
+  if (!rpmio_fd)
+    {
+      g_set_error_literal (
+        error,
+        MODULEMD_ERROR,
+        MMD_ERROR_NOT_IMPLEMENTED,
+        "Cannot open compressed file. Error in rpmio::Fdopen().");
+      return FALSE;
+    }
+
+  g_debug ("rpmio::Fdopen (%p, %s) succeeded", fd_dup, fmode);
+
+  yaml_parser_set_input (&parser, compressed_stream_read_fn, rpmio_fd);
+
+  return update_from_parser_monitored (self,
+                                       &parser,
+                                       strict,
+                                       autogen_module_name,
+                                       failures,
+                                       monitor,
+                                       0,
+                                       error);
+
+#else /* HAVE_RPMIO */
+  g_set_error_literal (
+    error,
+    MODULEMD_ERROR,
+    MMD_ERROR_NOT_IMPLEMENTED,
+    "Cannot open compressed file. libmodulemd was not compiled "
+    "with rpmio support.");
+  return FALSE;
+#endif /* HAVE_RPMIO */
+}
+
+
+gboolean
+modulemd_module_index_update_from_file_ext (ModulemdModuleIndex *self,
+                                            const gchar *yaml_file,
+                                            gboolean strict,
+                                            gboolean autogen_module_name,
+                                            GPtrArray **failures,
+                                            GError **error)
+{
+  if (*failures == NULL)
+    {
+      *failures = g_ptr_array_new_full (0, g_object_unref);
+    }
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  return update_from_file_monitored (
+    self, yaml_file, strict, autogen_module_name, failures, NULL, error);
+}
+
+
+gboolean
+modulemd_module_index_update_from_file (ModulemdModuleIndex *self,
+                                        const gchar *yaml_file,
+                                        gboolean strict,
+                                        GPtrArray **failures,
+                                        GError **error)
+{
+  return modulemd_module_index_update_from_file_ext (
+    self, yaml_file, strict, FALSE, failures, error);
+}
+
+
+typedef struct
+{
+  gchar *yaml_file;
+  gboolean strict;
+  progress_reporter *progress;
+  GPtrArray *failures;
+
+  /* The file is read into this index on the worker thread, and only merged
+   * into the index of the operation once it has been read completely.
+   */
+  ModulemdModuleIndex *scratch;
+} load_file_data;
+
+
+static void
+load_file_data_free (load_file_data *data)
+{
+  g_free (data->yaml_file);
+  g_clear_pointer (&data->progress, progress_reporter_unref);
+  g_clear_pointer (&data->failures, g_ptr_array_unref);
+  g_clear_object (&data->scratch);
+  g_free (data);
+}
+
+
+static void
+update_from_file_thread (GTask *task,
+                         gpointer UNUSED (source_object),
+                         gpointer task_data,
+                         GCancellable *cancellable)
+{
+  load_file_data *data = (load_file_data *)task_data;
+  io_monitor monitor = { cancellable, data->progress, 0, 0 };
+  GError *error = NULL;
+  gboolean ret;
+
+  ret = update_from_file_monitored (data->scratch,
+                                    data->yaml_file,
+                                    data->strict,
+                                    FALSE,
+                                    &data->failures,
+                                    &monitor,
+                                    &error);
+  if (error)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_boolean (task, ret);
+}
+
+
+void
+modulemd_module_index_update_from_file_async (
+  ModulemdModuleIndex *self,
+  const gchar *yaml_file,
+  gboolean strict,
+  int io_priority,
+  GCancellable *cancellable,
+  ModulemdModuleIndexProgressFunc progress_callback,
+  gpointer progress_data,
+  GDestroyNotify progress_data_free,
+  GAsyncReadyCallback callback,
+  gpointer user_data)
+{
+  g_autoptr (GTask) task = NULL;
+  load_file_data *data = NULL;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_INDEX (self));
+  g_return_if_fail (yaml_file != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  data = g_new0 (load_file_data, 1);
+  data->yaml_file = g_strdup (yaml_file);
+  data->strict = strict;
+  data->progress = progress_reporter_new (
+    progress_callback, progress_data, progress_data_free, io_priority);
+  data->failures = g_ptr_array_new_with_free_func (g_object_unref);
+
+  /* The documents are read the way @self would read them */
+  data->scratch = modulemd_module_index_new ();
+  modulemd_module_index_set_force_validate (data->scratch,
+                                            self->force_validate);
+  modulemd_module_index_set_compact_on_load (data->scratch,
+                                             self->compactor != NULL);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, modulemd_module_index_update_from_file_async);
+  g_task_set_priority (task, io_priority);
+  g_task_set_task_data (task, data, (GDestroyNotify)load_file_data_free);
+
+  g_task_run_in_thread (task, update_from_file_thread);
+}
+
+
+gboolean
+modulemd_module_index_update_from_file_finish (ModulemdModuleIndex *self,
+                                               GAsyncResult *result,
+                                               GPtrArray **failures,
+                                               GError **error)
+{
+  load_file_data *data = NULL;
+  g_autoptr (GError) nested_error = NULL;
+  gboolean ret;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+  g_return_val_if_fail (
+    g_task_get_source_tag (G_TASK (result)) ==
+      modulemd_module_index_update_from_file_async,
+    FALSE);
+
+  data = g_task_get_task_data (G_TASK (result));
+  if (failures)
+    {
+      *failures = g_ptr_array_ref (data->failures);
+    }
+
+  ret = g_task_propagate_boolean (G_TASK (result), &nested_error);
+  if (nested_error)
+    {
+      /* Nothing that was read before the error is kept */
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return FALSE;
+    }
+
+  /* Later documents replace the defaults that @self already has, as they
+   * would when reading the file into @self directly.
+   */
+  if (!modulemd_module_index_merge (data->scratch, self, TRUE, FALSE, error))
+    {
+      return FALSE;
+    }
+  g_clear_object (&data->scratch);
+
+  return ret;
+}
+
+
+gboolean
+modulemd_module_index_update_from_string (ModulemdModuleIndex *self,
+                                          const gchar *yaml_string,
+                                          gboolean strict,
+                                          GPtrArray **failures,
+                                          GError **error)
+{
+  if (*failures == NULL)
+    {
+      *failures = g_ptr_array_new_full (0, g_object_unref);
+    }
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  if (!yaml_string)
+    {
+      g_set_error (
+        error, MODULEMD_ERROR, MMD_YAML_ERROR_OPEN, "No string provided");
+      return FALSE;
+    }
+
+  MMD_INIT_YAML_PARSER (parser);
+
+  yaml_parser_set_input_string (
+    &parser, (const unsigned char *)yaml_string, strlen (yaml_string));
+
+  return update_from_parser_monitored (
+    self,
+    &parser,
+    strict,
+    FALSE,
+    failures,
+    NULL,
+    modulemd_yaml_prescan_stream_mdversion_from_string (yaml_string),
+    error);
+}
+
+
+gboolean
+modulemd_module_index_update_from_bytes (ModulemdModuleIndex *self,
+                                         GBytes *yaml_bytes,
+                                         gboolean strict,
+                                         GPtrArray **failures,
+                                         GError **error)
+{
+  const guint8 *data;
+  gsize len;
+  ModulemdCompressionTypeEnum comtype;
+  g_autoptr (ModulemdDecompressor) decompressor = NULL;
+  guint64 prescan_mdversion = 0;
+
+  if (*failures == NULL)
+    {
+      *failures = g_ptr_array_new_full (0, g_object_unref);
+    }
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  if (!yaml_bytes)
+    {
+      g_set_error (
+        error, MODULEMD_ERROR, MMD_YAML_ERROR_OPEN, "No bytes provided");
+      return FALSE;
+    }
+
+  data = g_bytes_get_data (yaml_bytes, &len);
+  comtype = modulemd_detect_compression_from_data (data, len);
+
+  if (comtype == MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION)
+    {
+      MMD_INIT_YAML_PARSER (parser);
+
+      /* libyaml reads straight from the buffer without copying it. Empty
+       * GBytes may have no buffer at all.
+       */
+      yaml_parser_set_input_string (
+        &parser, data ? data : (const guint8 *)"", len);
+
+      return update_from_parser_monitored (
+        self,
+        &parser,
+        strict,
+        FALSE,
+        failures,
+        NULL,
+        modulemd_yaml_prescan_stream_mdversion_from_data ((const gchar *)data,
+                                                          len),
+        error);
+    }
+
+  if (self->stream_mdversion < MD_MODULESTREAM_VERSION_LATEST)
+    {
+      decompressor =
+        modulemd_decompressor_new_for_bytes (comtype, yaml_bytes, error);
+      if (!decompressor)
+        {
+          return FALSE;
+        }
+      prescan_mdversion =
+        prescan_decompressor (g_steal_pointer (&decompressor));
+    }
+
+  decompressor =
+    modulemd_decompressor_new_for_bytes (comtype, yaml_bytes, error);
+  if (!decompressor)
+    {
+      return FALSE;
+    }
+
+  return update_from_decompressor (self,
+                                   decompressor,
+                                   strict,
+                                   FALSE,
+                                   failures,
+                                   NULL,
+                                   prescan_mdversion,
+                                   error);
+}
+
+
+gboolean
+modulemd_module_index_update_from_stream (ModulemdModuleIndex *self,
+                                          FILE *yaml_stream,
+                                          gboolean strict,
+                                          GPtrArray **failures,
+                                          GError **error)
+{
+  if (*failures == NULL)
+    {
+      *failures = g_ptr_array_new_full (0, g_object_unref);
+    }
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  if (!yaml_stream)
+    {
+      g_set_error (
+        error, MODULEMD_ERROR, MMD_YAML_ERROR_OPEN, "No stream provided");
+      return FALSE;
+    }
+
+  MMD_INIT_YAML_PARSER (parser);
+
+  yaml_parser_set_input_file (&parser, yaml_stream);
+
+  return modulemd_module_index_update_from_parser (
+    self, &parser, strict, FALSE, failures, error);
+}
+
+
+gboolean
+modulemd_module_index_update_from_custom (ModulemdModuleIndex *self,
+                                          ModulemdReadHandler custom_read_fn,
+                                          void *custom_pvt_data,
+                                          gboolean strict,
+                                          GPtrArray **failures,
+                                          GError **error)
+{
+  if (*failures == NULL)
+    {
+      *failures = g_ptr_array_new_full (0, g_object_unref);
+    }
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (custom_read_fn, FALSE);
+
+  MMD_INIT_YAML_PARSER (parser);
+
+  yaml_parser_set_input (&parser, custom_read_fn, custom_pvt_data);
+
+  return modulemd_module_index_update_from_parser (
+    self, &parser, strict, FALSE, failures, error);
+}
+
+
+gboolean
+modulemd_module_index_update_from_json (ModulemdModuleIndex *self,
+                                        const gchar *json_string,
+                                        gboolean strict,
+                                        GPtrArray **failures,
+                                        GError **error)
+{
+  g_autofree gchar *decoded = NULL;
+
+  if (*failures == NULL)
+    {
+      *failures = g_ptr_array_new_full (0, g_object_unref);
+    }
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  if (!json_string)
+    {
+      g_set_error (
+        error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_OPEN, "No string provided");
+      return FALSE;
+    }
+
+  if (!modulemd_json_decode_surrogates (json_string, &decoded, error))
+    {
+      return FALSE;
+    }
+  if (decoded)
+    {
+      json_string = decoded;
+    }
+
+  MMD_INIT_YAML_PARSER (parser);
+
+  yaml_parser_set_input_string (
+    &parser, (const unsigned char *)json_string, strlen (json_string));
+
+  return update_from_json_parser (self, &parser, strict, failures, error);
+}
+
+
+gboolean
+modulemd_module_index_update_from_cbor (ModulemdModuleIndex *self,
+                                        GBytes *cbor,
+                                        gboolean strict,
+                                        GPtrArray **failures,
+                                        GError **error)
+{
+  const guint8 *data;
+  gsize len;
+  g_autofree gchar *json_string = NULL;
+
+  if (*failures == NULL)
+    {
+      *failures = g_ptr_array_new_full (0, g_object_unref);
+    }
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  if (!cbor)
+    {
+      g_set_error (
+        error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_OPEN, "No bytes provided");
+      return FALSE;
+    }
+
+  /* The CBOR data model matches that of JSON, so the input is read by
+   * converting it to JSON first.
+   */
+  data = g_bytes_get_data (cbor, &len);
+  json_string = modulemd_cbor_to_json (data, len, error);
+  if (!json_string)
+    {
+      return FALSE;
+    }
+
+  return modulemd_module_index_update_from_json (
+    self, json_string, strict, failures, error);
+}
+
+
+/*
+ * modules_from_directory:
+ * @path: A directory containing one or more modulemd YAML documents
+ * @file_suffix: A file suffix to limit the files to be read. Pass "" if you
+ * need to read all files.
+ * @strict: Whether to fail on unknown fields
+ * @strict_default_streams: Whether to fail on default stream merges.
+ * @error: Error return value
+ */
+static ModulemdModuleIndex *
+modules_from_directory (const gchar *path,
+                        const gchar *file_suffix,
+                        gboolean strict,
+                        gboolean strict_default_streams,
+                        GError **error)
+{
+  const gchar *filename = NULL;
+  g_autoptr (GDir) dir = NULL;
+  g_autofree gchar *filepath = NULL;
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (ModulemdModuleIndex) intermediate = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) nested_error = NULL;
+
+  index = modulemd_module_index_new ();
+
+  /* Open the directory */
+  dir = g_dir_open (path, 0, &nested_error);
+  if (!dir)
+    {
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return FALSE;
+    }
+
+  while ((filename = g_dir_read_name (dir)) != NULL)
+    {
+      if (g_str_has_suffix (filename, file_suffix))
+        {
+          intermediate = modulemd_module_index_new ();
+
+          filepath = g_build_path ("/", path, filename, NULL);
+          g_debug ("Reading modulemd from %s", filepath);
+          if (!modulemd_module_index_update_from_file (
+                intermediate, filepath, strict, &failures, error))
+            {
+              return FALSE;
+            }
+
+          if (!modulemd_module_index_merge (intermediate,
+                                            index,
+                                            FALSE,
+                                            strict_default_streams,
+                                            &nested_error))
+            {
+              g_propagate_error (error, g_steal_pointer (&nested_error));
+              return FALSE;
+            }
+
+          g_clear_pointer (&failures, g_ptr_array_unref);
+          g_clear_pointer (&filepath, g_free);
+          g_clear_object (&intermediate);
+        }
+    }
+
+  return g_steal_pointer (&index);
+}
+
+
+gboolean
+modulemd_module_index_update_from_defaults_directory (
+  ModulemdModuleIndex *self,
+  const gchar *path,
+  gboolean strict,
+  const gchar *overrides_path,
+  GError **error)
+{
+  g_autoptr (ModulemdModuleIndex) defaults_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) override_idx = NULL;
+  g_autoptr (GError) nested_error = NULL;
+
+  /* Read the regular path first */
+  defaults_idx = modules_from_directory (
+    path, MMD_YAML_SUFFIX, strict, strict, &nested_error);
+  if (!defaults_idx)
+    {
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return FALSE;
+    }
+
+  /* If an override path was provided, use that too */
+  if (overrides_path)
+    {
+      override_idx = modules_from_directory (
+        overrides_path, MMD_YAML_SUFFIX, strict, strict, &nested_error);
+      if (!override_idx)
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return FALSE;
+        }
+
+      if (!modulemd_module_index_merge (
+            override_idx, defaults_idx, TRUE, strict, &nested_error))
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return FALSE;
+        }
+    }
+
+  /* Now that we've verified that the content in the two paths is compatible,
+   * attempt to merge it into the existing index.
+   */
+  if (!modulemd_module_index_merge (
+        defaults_idx, self, TRUE, strict, &nested_error))
+    {
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return FALSE;
+    }
+
+
+  return TRUE;
+}
+
+
+gchar *
+modulemd_module_index_dump_to_string (ModulemdModuleIndex *self,
+                                      GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  MMD_INIT_YAML_EMITTER (emitter);
+  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+
+  if (!modulemd_module_index_dump_to_emitter (self, &emitter, NULL, error))
+    {
+      return NULL;
+    }
+
+  return g_steal_pointer (&yaml_string->str);
+}
+
+
+gboolean
+modulemd_module_index_dump_to_stream (ModulemdModuleIndex *self,
+                                      FILE *yaml_stream,
+                                      GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  MMD_INIT_YAML_EMITTER (emitter);
+  yaml_emitter_set_output_file (&emitter, yaml_stream);
+
+  return modulemd_module_index_dump_to_emitter (self, &emitter, NULL, error);
+}
+
+
+gboolean
+modulemd_module_index_dump_to_custom (ModulemdModuleIndex *self,
+                                      ModulemdWriteHandler custom_write_fn,
+                                      void *custom_pvt_data,
+                                      GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  MMD_INIT_YAML_EMITTER (emitter);
+  yaml_emitter_set_output (&emitter, custom_write_fn, custom_pvt_data);
+
+  return modulemd_module_index_dump_to_emitter (self, &emitter, NULL, error);
+}
+
+
+gchar *
+modulemd_module_index_dump_to_json (ModulemdModuleIndex *self,
+                                    GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  /* The writer must outlive the emitter */
+  g_autoptr (modulemd_json_writer) writer =
+    modulemd_json_writer_new (MODULEMD_JSON_FORMAT_TEXT);
+  MMD_INIT_YAML_EMITTER (emitter);
+  mmd_emitter_set_output_json (&emitter, writer);
+
+  if (!modulemd_module_index_dump_to_emitter (self, &emitter, NULL, error))
+    {
+      return NULL;
+    }
+
+  return modulemd_json_writer_steal_string (writer);
+}
+
+
+GBytes *
+modulemd_module_index_dump_to_cbor (ModulemdModuleIndex *self,
+                                    GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  /* The writer must outlive the emitter */
+  g_autoptr (modulemd_json_writer) writer =
+    modulemd_json_writer_new (MODULEMD_JSON_FORMAT_CBOR);
+  MMD_INIT_YAML_EMITTER (emitter);
+  mmd_emitter_set_output_json (&emitter, writer);
+
+  if (!modulemd_module_index_dump_to_emitter (self, &emitter, NULL, error))
+    {
+      return NULL;
+    }
+
+  return modulemd_json_writer_steal_bytes (writer);
+}
+
+
+typedef struct
+{
+  FILE *stream;
+  io_monitor *monitor;
+} monitored_writer;
+
+
+static int
+monitored_write_handler (void *data, unsigned char *buffer, size_t size)
+{
+  monitored_writer *writer = (monitored_writer *)data;
+
+  if (fwrite (buffer, 1, size, writer->stream) != size)
+    {
+      return 0;
+    }
+
+  writer->monitor->bytes += size;
+  return 1;
+}
+
+
+/*
+ * dump_to_file_monitored:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @yaml_file: (in): The name of the file to write.
+ * @monitor: (in): The #io_monitor to report progress to and check for
+ * cancellation after each module.
+ * @error: (out): A #GError containing the reason this function failed.
+ *
+ * Writes @self to a temporary file next to @yaml_file and renames it into
+ * place once it is complete. The temporary file is removed on failure. If
+ * @yaml_file already exists, its permissions are copied to the temporary
+ * file, and so is its owner if the process is allowed to set it.
+ *
+ * Returns: TRUE if @yaml_file was written.
+ */
+static gboolean
+dump_to_file_monitored (ModulemdModuleIndex *self,
+                        const gchar *yaml_file,
+                        io_monitor *monitor,
+                        GError **error)
+{
+  g_autofree gchar *dirname = g_path_get_dirname (yaml_file);
+  g_autofree gchar *basename = g_path_get_basename (yaml_file);
+  g_autofree gchar *tmp_name = NULL;
+  g_autofree gchar *tmp_file = NULL;
+  monitored_writer writer = { NULL, monitor };
+  GStatBuf statbuf;
+  gboolean ret;
+  int saved_errno;
+  int fd;
+
+  tmp_name = g_strdup_printf (".%s.XXXXXX", basename);
+  tmp_file = g_build_filename (dirname, tmp_name, NULL);
+
+  fd = g_mkstemp_full (tmp_file, O_WRONLY, 0666);
+  if (fd < 0)
+    {
+      saved_errno = errno;
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_FILE_ACCESS,
+                   "Failed to create a temporary file for %s: %s",
+                   yaml_file,
+                   g_strerror (saved_errno));
+      return FALSE;
+    }
+
+  if (g_stat (yaml_file, &statbuf) == 0)
+    {
+      /* Only privileged processes may give a file to another user or to a
+       * group they are not a member of, so keep whatever they can set.
+       */
+      if (fchown (fd, statbuf.st_uid, (gid_t)-1) != 0)
+        {
+          g_debug ("Could not keep the owner of %s: %s",
+                   yaml_file,
+                   g_strerror (errno));
+        }
+      if (fchown (fd, (uid_t)-1, statbuf.st_gid) != 0)
+        {
+          g_debug ("Could not keep the group of %s: %s",
+                   yaml_file,
+                   g_strerror (errno));
+        }
+
+      /* Changing the owner may have cleared the setuid and setgid bits */
+      if (fchmod (fd, statbuf.st_mode & 07777) != 0)
+        {
+          saved_errno = errno;
+          close (fd);
+          g_unlink (tmp_file);
+          g_set_error (error,
+                       MODULEMD_ERROR,
+                       MMD_ERROR_FILE_ACCESS,
+                       "Failed to copy the permissions of %s: %s",
+                       yaml_file,
+                       g_strerror (saved_errno));
+          return FALSE;
+        }
+    }
+
+  writer.stream = fdopen (fd, "wb");
+  if (writer.stream == NULL)
+    {
+      saved_errno = errno;
+      close (fd);
+      g_unlink (tmp_file);
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_FILE_ACCESS,
+                   "Failed to open %s for writing: %s",
+                   tmp_file,
+                   g_strerror (saved_errno));
+      return FALSE;
+    }
+
+  MMD_INIT_YAML_EMITTER (emitter);
+  yaml_emitter_set_output (&emitter, monitored_write_handler, &writer);
+
+  ret = modulemd_module_index_dump_to_emitter (self, &emitter, monitor, error);
+
+  if (fclose (writer.stream) != 0 && ret)
+    {
+      saved_errno = errno;
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_FILE_ACCESS,
+                   "Failed to write %s: %s",
+                   tmp_file,
+                   g_strerror (saved_errno));
+      ret = FALSE;
+    }
+
+  if (ret && g_rename (tmp_file, yaml_file) != 0)
+    {
+      saved_errno = errno;
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_FILE_ACCESS,
+                   "Failed to rename %s to %s: %s",
+                   tmp_file,
+                   yaml_file,
+                   g_strerror (saved_errno));
+      ret = FALSE;
+    }
+
+  if (!ret)
+    {
+      g_unlink (tmp_file);
+      return FALSE;
+    }
+
+  io_monitor_report (monitor);
+  return TRUE;
+}
+
+
+typedef struct
+{
+  gchar *yaml_file;
+  progress_reporter *progress;
+} dump_file_data;
+
+
+static void
+dump_file_data_free (dump_file_data *data)
+{
+  g_free (data->yaml_file);
+  g_clear_pointer (&data->progress, progress_reporter_unref);
+  g_free (data);
+}
+
+
+static void
+dump_to_file_thread (GTask *task,
+                     gpointer source_object,
+                     gpointer task_data,
+                     GCancellable *cancellable)
+{
+  ModulemdModuleIndex *self = MODULEMD_MODULE_INDEX (source_object);
+  dump_file_data *data = (dump_file_data *)task_data;
+  io_monitor monitor = { cancellable, data->progress, 0, 0 };
+  GError *error = NULL;
+
+  if (!dump_to_file_monitored (self, data->yaml_file, &monitor, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+
+void
+modulemd_module_index_dump_to_file_async (
+  ModulemdModuleIndex *self,
+  const gchar *yaml_file,
+  int io_priority,
+  GCancellable *cancellable,
+  ModulemdModuleIndexProgressFunc progress_callback,
+  gpointer progress_data,
+  GDestroyNotify progress_data_free,
+  GAsyncReadyCallback callback,
+  gpointer user_data)
+{
+  g_autoptr (GTask) task = NULL;
+  dump_file_data *data = NULL;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_INDEX (self));
+  g_return_if_fail (yaml_file != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  data = g_new0 (dump_file_data, 1);
+  data->yaml_file = g_strdup (yaml_file);
+  data->progress = progress_reporter_new (
+    progress_callback, progress_data, progress_data_free, io_priority);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, modulemd_module_index_dump_to_file_async);
+  g_task_set_priority (task, io_priority);
+  g_task_set_task_data (task, data, (GDestroyNotify)dump_file_data_free);
+
+  g_task_run_in_thread (task, dump_to_file_thread);
+}
+
+
+gboolean
+modulemd_module_index_dump_to_file_finish (ModulemdModuleIndex *self,
+                                           GAsyncResult *result,
+                                           GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                          modulemd_module_index_dump_to_file_async,
+                        FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+
+GStrv
+modulemd_module_index_get_module_names_as_strv (ModulemdModuleIndex *self)
+{
+  GPtrArray *module_names = NULL;
+  GStrv names = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  module_names = get_sorted_module_names (self);
+
+  names = g_new0 (gchar *, module_names->len + 1);
+  for (guint i = 0; i < module_names->len; i++)
+    {
+      names[i] = g_strdup (g_ptr_array_index (module_names, i));
+    }
+
+  return names;
+}
+
+
+ModulemdModule *
+modulemd_module_index_get_module (ModulemdModuleIndex *self,
+                                  const gchar *module_name)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  return g_hash_table_lookup (self->modules, module_name);
+}
+
+
+/*
+ * count_query_modules:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @query: (in) (nullable): The #ModulemdStreamQuery to match.
+ *
+ * Returns: The number of module slots that get_query_module() should be
+ * called for. If @query names a single module literally, that is the only
+ * one visited; otherwise all modules are visited in sorted order.
+ */
+static guint
+count_query_modules (ModulemdModuleIndex *self, ModulemdStreamQuery *query)
+{
+  if (query && modulemd_stream_query_get_module_name_literal (query))
+    {
+      return 1;
+    }
+
+  return get_sorted_module_names (self)->len;
+}
+
+
+/*
+ * get_query_module:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @query: (in) (nullable): The #ModulemdStreamQuery to match.
+ * @i: (in): A slot number below count_query_modules().
+ *
+ * Returns: (transfer none) (nullable): The module in slot @i, or NULL if it
+ * cannot contain streams matching @query.
+ */
+static ModulemdModule *
+get_query_module (ModulemdModuleIndex *self,
+                  ModulemdStreamQuery *query,
+                  guint i)
+{
+  const gchar *mname = NULL;
+
+  if (query && modulemd_stream_query_get_module_name_literal (query))
+    {
+      /* Only one module can possibly match, so look it up directly */
+      return g_hash_table_lookup (
+        self->modules, modulemd_stream_query_get_module_name_literal (query));
+    }
+
+  mname = g_ptr_array_index (get_sorted_module_names (self), i);
+  g_debug ("Searching through %s", mname);
+
+  if (query && !modulemd_stream_query_may_match_module (query, mname))
+    {
+      g_debug ("%s did not match the query", mname);
+      return NULL;
+    }
+
+  return g_hash_table_lookup (self->modules, mname);
+}
+
+
+/*
+ * search_streams_by_query:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @query: (in): The #ModulemdStreamQuery to match.
+ * @sort_streams: (in): Whether the matches from each module should be sorted.
+ *
+ * Returns: (transfer container): The matching streams, grouped by module in
+ * module name order.
+ */
+static GPtrArray *
+search_streams_by_query (ModulemdModuleIndex *self,
+                         ModulemdStreamQuery *query,
+                         gboolean sort_streams)
+{
+  g_autoptr (GPtrArray) module_streams = NULL;
+  ModulemdModule *module = NULL;
+  guint start;
+  guint n_modules;
+
+  module_streams = g_ptr_array_new ();
+
+  n_modules = count_query_modules (self, query);
+  for (guint i = 0; i < n_modules; i++)
+    {
+      module = get_query_module (self, query, i);
+      if (!module)
+        {
+          continue;
+        }
+
+      start = module_streams->len;
+      modulemd_module_collect_streams_by_query (module, query, module_streams);
+
+      if (sort_streams && module_streams->len - start > 1)
+        {
+          qsort (module_streams->pdata + start,
+                 module_streams->len - start,
+                 sizeof (gpointer),
+                 compare_streams);
+        }
+    }
+
+  g_debug ("Module stream count: %d", module_streams->len);
+
+  return g_steal_pointer (&module_streams);
+}
+
+
+GPtrArray *
+modulemd_module_index_search_streams_by_query (ModulemdModuleIndex *self,
+                                               ModulemdStreamQuery *query)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+  g_return_val_if_fail (MODULEMD_IS_STREAM_QUERY (query), NULL);
+
+  return search_streams_by_query (self, query, TRUE);
+}
+
+
+GPtrArray *
+modulemd_module_index_search_streams (ModulemdModuleIndex *self,
+                                      const gchar *module_name,
+                                      const gchar *stream_name,
+                                      const gchar *version,
+                                      const gchar *context,
+                                      const gchar *arch)
+{
+  g_autoptr (ModulemdStreamQuery) query = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  query = modulemd_stream_query_new (
+    module_name, stream_name, version, context, arch);
+
+  return search_streams_by_query (self, query, TRUE);
+}
+
+
+GPtrArray *
+modulemd_module_index_search_streams_by_nsvca_glob (ModulemdModuleIndex *self,
+                                                    const gchar *nsvca_pattern)
+{
+  g_autoptr (ModulemdStreamQuery) query = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  query = modulemd_stream_query_new_from_nsvca_glob (nsvca_pattern);
+
+  return search_streams_by_query (self, query, FALSE);
+}
+
+
+GPtrArray *
+modulemd_module_index_search_rpms (ModulemdModuleIndex *self,
+                                   const gchar *nevra_pattern)
+{
+  GPtrArray *module_names = NULL;
+  g_autoptr (GPtrArray) found_streams = NULL;
+  GPtrArray *module_streams = NULL;
+  const gchar *mname = NULL;
+  ModulemdModule *module = NULL;
+  ModulemdModuleStream *stream = NULL;
+
+  module_names = get_sorted_module_names (self);
+
+  found_streams = g_ptr_array_new ();
+  for (guint i = 0; i < module_names->len; i++)
+    {
+      mname = g_ptr_array_index (module_names, i);
+      g_debug ("Searching through %s", mname);
+
+      module = modulemd_module_index_get_module (self, mname);
+      if (!module)
+        {
+          /* Since we're iterating through keys we just retrieved, this should
+           * be impossible. If we get here, it must be a bug.
+           */
+          g_assert_not_reached ();
+          continue;
+        }
+
+      module_streams = modulemd_module_get_sorted_streams (module);
+      for (guint j = 0; j < module_streams->len; j++)
+        {
+          stream = g_ptr_array_index (module_streams, j);
+          if (modulemd_module_stream_includes_nevra (stream, nevra_pattern))
+            {
+              g_ptr_array_add (found_streams, stream);
+            }
+        }
+    }
+
+  g_debug ("Module stream count: %d", found_streams->len);
+
+  return g_steal_pointer (&found_streams);
+}
+
+
+gboolean
+modulemd_module_index_foreach_stream (ModulemdModuleIndex *self,
+                                      ModulemdStreamQuery *query,
+                                      ModulemdModuleStreamFunc func,
+                                      gpointer user_data)
+{
+  ModulemdModule *module = NULL;
+  guint n_modules;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (query == NULL || MODULEMD_IS_STREAM_QUERY (query),
+                        FALSE);
+  g_return_val_if_fail (func, FALSE);
+
+  n_modules = count_query_modules (self, query);
+  for (guint i = 0; i < n_modules; i++)
+    {
+      module = get_query_module (self, query, i);
+      if (!module)
+        {
+          continue;
+        }
+
+      if (!modulemd_module_foreach_stream (module, query, func, user_data))
+        {
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+gboolean
+modulemd_module_index_foreach_stream_by_rpm (ModulemdModuleIndex *self,
+                                             const gchar *nevra_pattern,
+                                             ModulemdModuleStreamFunc func,
+                                             gpointer user_data)
+{
+  GPtrArray *module_names = NULL;
+  GPtrArray *module_streams = NULL;
+  ModulemdModule *module = NULL;
+  ModulemdModuleStream *stream = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (func, FALSE);
+
+  module_names = get_sorted_module_names (self);
+  for (guint i = 0; i < module_names->len; i++)
+    {
+      module = g_hash_table_lookup (self->modules,
+                                    g_ptr_array_index (module_names, i));
+
+      module_streams = modulemd_module_get_sorted_streams (module);
+      for (guint j = 0; j < module_streams->len; j++)
+        {
+          stream = g_ptr_array_index (module_streams, j);
+          if (modulemd_module_stream_includes_nevra (stream, nevra_pattern) &&
+              !func (stream, user_data))
+            {
+              return FALSE;
+            }
+        }
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+add_stream_row (ModulemdModuleStream *stream, gpointer user_data)
+{
+  const gchar *context = modulemd_module_stream_get_context (stream);
+  const gchar *arch = modulemd_module_stream_get_arch (stream);
+
+  g_variant_builder_add ((GVariantBuilder *)user_data,
+                         "(sstss)",
+                         modulemd_module_stream_get_module_name (stream),
+                         modulemd_module_stream_get_stream_name (stream),
+                         modulemd_module_stream_get_version (stream),
+                         context ? context : "",
+                         arch ? arch : "");
+
+  return TRUE;
+}
+
+
+GVariant *
+modulemd_module_index_get_stream_table (ModulemdModuleIndex *self,
+                                        ModulemdStreamQuery *query)
+{
+  g_auto (GVariantBuilder) builder;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sstss)"));
+  modulemd_module_index_foreach_stream (self, query, add_stream_row, &builder);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+
+static GHashTable *
+get_rpm_artifact_set (ModulemdModuleStream *stream)
+{
+  if (MODULEMD_IS_MODULE_STREAM_V2 (stream))
+    {
+      return MODULEMD_MODULE_STREAM_V2 (stream)->rpm_artifacts;
+    }
+
+  if (MODULEMD_IS_MODULE_STREAM_V1 (stream))
+    {
+      return MODULEMD_MODULE_STREAM_V1 (stream)->rpm_artifacts;
+    }
+
+  g_return_val_if_reached (NULL);
+}
+
+
+static gboolean
+add_rpm_artifacts_row (ModulemdModuleStream *stream, gpointer user_data)
+{
+  GVariantBuilder *builder = user_data;
+  g_autofree gchar *nsvca = NULL;
+  g_autoptr (GPtrArray) nevras = NULL;
+
+  nsvca = modulemd_module_stream_get_NSVCA_as_string (stream);
+  nevras = modulemd_sorted_str_keys (get_rpm_artifact_set (stream));
+
+  g_variant_builder_open (builder, G_VARIANT_TYPE ("(sas)"));
+  g_variant_builder_add (builder, "s", nsvca);
+  g_variant_builder_open (builder, G_VARIANT_TYPE_STRING_ARRAY);
+  for (guint i = 0; i < nevras->len; i++)
+    {
+      g_variant_builder_add (builder, "s", g_ptr_array_index (nevras, i));
+    }
+  g_variant_builder_close (builder);
+  g_variant_builder_close (builder);
+
+  return TRUE;
+}
+
+
+GVariant *
+modulemd_module_index_get_rpm_artifacts_table (ModulemdModuleIndex *self,
+                                               ModulemdStreamQuery *query)
+{
+  g_auto (GVariantBuilder) builder;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sas)"));
+  modulemd_module_index_foreach_stream (
+    self, query, add_rpm_artifacts_row, &builder);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+
+typedef struct
+{
+  /* @key: (transfer none): A NEVRA owned by a stream.
+   * @value: #GPtrArray of the NSVCAs of the streams listing it, owned by
+   * nsvcas.
+   */
+  GHashTable *map;
+
+  GPtrArray *nsvcas;
+} rpm_artifact_map;
+
+
+static gboolean
+add_rpm_artifacts_to_map (ModulemdModuleStream *stream, gpointer user_data)
+{
+  rpm_artifact_map *artifact_map = user_data;
+  gchar *nsvca = modulemd_module_stream_get_NSVCA_as_string (stream);
+  GPtrArray *streams = NULL;
+  GHashTableIter iter;
+  gpointer nevra;
+
+  g_ptr_array_add (artifact_map->nsvcas, nsvca);
+
+  g_hash_table_iter_init (&iter, get_rpm_artifact_set (stream));
+  while (g_hash_table_iter_next (&iter, &nevra, NULL))
+    {
+      streams = g_hash_table_lookup (artifact_map->map, nevra);
+      if (!streams)
+        {
+          streams = g_ptr_array_new ();
+          g_hash_table_insert (artifact_map->map, nevra, streams);
+        }
+      g_ptr_array_add (streams, nsvca);
+    }
+
+  return TRUE;
+}
+
+
+GVariant *
+modulemd_module_index_get_rpm_artifact_map (ModulemdModuleIndex *self,
+                                            ModulemdStreamQuery *query)
+{
+  g_auto (GVariantBuilder) builder;
+  g_autoptr (GHashTable) map = NULL;
+  g_autoptr (GPtrArray) nsvcas = NULL;
+  g_autoptr (GPtrArray) nevras = NULL;
+  rpm_artifact_map artifact_map;
+  GPtrArray *streams = NULL;
+  const gchar *nevra = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  map = g_hash_table_new_full (
+    g_str_hash, g_str_equal, NULL, (GDestroyNotify)g_ptr_array_unref);
+  nsvcas = g_ptr_array_new_with_free_func (g_free);
+  artifact_map.map = map;
+  artifact_map.nsvcas = nsvcas;
+  modulemd_module_index_foreach_stream (
+    self, query, add_rpm_artifacts_to_map, &artifact_map);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sas}"));
+  nevras = modulemd_sorted_str_keys (map);
+  for (guint i = 0; i < nevras->len; i++)
+    {
+      nevra = g_ptr_array_index (nevras, i);
+      streams = g_hash_table_lookup (map, nevra);
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("{sas}"));
+      g_variant_builder_add (&builder, "s", nevra);
+      g_variant_builder_open (&builder, G_VARIANT_TYPE_STRING_ARRAY);
+      for (guint j = 0; j < streams->len; j++)
+        {
+          g_variant_builder_add (
+            &builder, "s", g_ptr_array_index (streams, j));
+        }
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+    }
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+
+static void
+add_dependencies_rows (GVariantBuilder *builder,
+                       const gchar *nsvca,
+                       guint32 index,
+                       ModulemdDependencies *deps,
+                       gboolean runtime)
+{
+  g_auto (GStrv) modules = NULL;
+  g_auto (GStrv) streams = NULL;
+
+  if (runtime)
+    {
+      modules = modulemd_dependencies_get_runtime_modules_as_strv (deps);
+    }
+  else
+    {
+      modules = modulemd_dependencies_get_buildtime_modules_as_strv (deps);
+    }
+
+  for (guint i = 0; modules[i]; i++)
+    {
+      if (runtime)
+        {
+          streams = modulemd_dependencies_get_runtime_streams_as_strv (
+            deps, modules[i]);
+        }
+      else
+        {
+          streams = modulemd_dependencies_get_buildtime_streams_as_strv (
+            deps, modules[i]);
+        }
+
+      g_variant_builder_add (builder,
+                             "(subs^as)",
+                             nsvca,
+                             index,
+                             runtime,
+                             modules[i],
+                             streams);
+      g_clear_pointer (&streams, g_strfreev);
+    }
+}
+
+
+static void
+add_v1_dependencies_rows (GVariantBuilder *builder,
+                          const gchar *nsvca,
+                          GHashTable *deps,
+                          gboolean runtime)
+{
+  g_autoptr (GPtrArray) modules = modulemd_sorted_str_keys (deps);
+  const gchar *streams[] = { NULL, NULL };
+
+  for (guint i = 0; i < modules->len; i++)
+    {
+      streams[0] = g_hash_table_lookup (deps, g_ptr_array_index (modules, i));
+      g_variant_builder_add (builder,
+                             "(subs^as)",
+                             nsvca,
+                             0,
+                             runtime,
+                             g_ptr_array_index (modules, i),
+                             streams);
+    }
+}
+
+
+static gboolean
+add_stream_dependencies_rows (ModulemdModuleStream *stream, gpointer user_data)
+{
+  GVariantBuilder *builder = user_data;
+  g_autofree gchar *nsvca = NULL;
+  ModulemdModuleStreamV1 *v1_stream = NULL;
+  GPtrArray *dependencies = NULL;
+
+  nsvca = modulemd_module_stream_get_NSVCA_as_string (stream);
+
+  if (MODULEMD_IS_MODULE_STREAM_V2 (stream))
+    {
+      dependencies = MODULEMD_MODULE_STREAM_V2 (stream)->dependencies;
+      for (guint i = 0; i < dependencies->len; i++)
+        {
+          add_dependencies_rows (
+            builder, nsvca, i, g_ptr_array_index (dependencies, i), FALSE);
+          add_dependencies_rows (
+            builder, nsvca, i, g_ptr_array_index (dependencies, i), TRUE);
+        }
+    }
+  else if (MODULEMD_IS_MODULE_STREAM_V1 (stream))
+    {
+      v1_stream = MODULEMD_MODULE_STREAM_V1 (stream);
+      add_v1_dependencies_rows (
+        builder, nsvca, v1_stream->buildtime_deps, FALSE);
+      add_v1_dependencies_rows (builder, nsvca, v1_stream->runtime_deps, TRUE);
+    }
+
+  return TRUE;
+}
+
+
+GVariant *
+modulemd_module_index_get_dependencies_table (ModulemdModuleIndex *self,
+                                              ModulemdStreamQuery *query)
+{
+  g_auto (GVariantBuilder) builder;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(subsas)"));
+  modulemd_module_index_foreach_stream (
+    self, query, add_stream_dependencies_rows, &builder);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+
+static void
+add_package_provider (GHashTable *providers,
+                      const gchar *package_name,
+                      ModulemdModuleStream *stream,
+                      ModulemdPackageSourceFlags source,
+                      const gchar *profile_name)
+{
+  GPtrArray *package_providers = NULL;
+
+  package_providers = g_hash_table_lookup (providers, package_name);
+  if (!package_providers)
+    {
+      package_providers = g_ptr_array_new_with_free_func (g_object_unref);
+      g_hash_table_insert (
+        providers, g_strdup (package_name), package_providers);
+    }
+
+  g_ptr_array_add (
+    package_providers,
+    modulemd_package_provider_new (stream, source, profile_name));
+}
+
+
+/*
+ * add_stream_package_providers:
+ * @providers: (inout): The map of package names to providers being built.
+ * @stream: (in): The #ModulemdModuleStream to add the packages of.
+ * @rpm_api: (in): The set of RPM API names of @stream.
+ * @profiles: (in): The profiles of @stream keyed by name.
+ * @rpm_components: (in): The RPM components of @stream keyed by name.
+ *
+ * The tables are read directly from the stream objects, so that building the
+ * map does not copy and sort every set.
+ */
+static void
+add_stream_package_providers (GHashTable *providers,
+                              ModulemdModuleStream *stream,
+                              GHashTable *rpm_api,
+                              GHashTable *profiles,
+                              GHashTable *rpm_components)
+{
+  g_autoptr (GPtrArray) profile_names = NULL;
+  ModulemdProfile *profile = NULL;
+  const gchar *profile_name = NULL;
+  GHashTableIter iter;
+  gpointer key;
+
+  g_hash_table_iter_init (&iter, rpm_api);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      add_package_provider (
+        providers, key, stream, MD_PACKAGE_SOURCE_RPM_API, NULL);
+    }
+
+  /* A package may be listed in several profiles of the same stream; sort
+   * them so that the providers come out in a predictable order.
+   */
+  profile_names = modulemd_sorted_str_keys (profiles);
+  for (guint i = 0; i < profile_names->len; i++)
+    {
+      profile_name = g_ptr_array_index (profile_names, i);
+      profile = g_hash_table_lookup (profiles, profile_name);
+
+      g_hash_table_iter_init (&iter,
+                              modulemd_profile_get_rpms_internal (profile));
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          add_package_provider (
+            providers, key, stream, MD_PACKAGE_SOURCE_PROFILE, profile_name);
+        }
+    }
+
+  g_hash_table_iter_init (&iter, rpm_components);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      add_package_provider (
+        providers, key, stream, MD_PACKAGE_SOURCE_COMPONENT, NULL);
+    }
+}
+
+
+/*
+ * get_package_providers:
+ * @self: (in): This #ModulemdModuleIndex object.
+ *
+ * Must be called with providers_lock held.
+ *
+ * Returns: (transfer none): The cached map of package names to the
+ * #ModulemdPackageProvider objects for them, building it first if no module
+ * stream has been added to or removed from @self since it was last built.
+ * Building it visits every entry of every stream once.
+ */
+static GHashTable *
+get_package_providers (ModulemdModuleIndex *self)
+{
+  GPtrArray *module_names = NULL;
+  GPtrArray *module_streams = NULL;
+  ModulemdModule *module = NULL;
+  ModulemdModuleStream *stream = NULL;
+  ModulemdModuleStreamV1 *v1_stream = NULL;
+  ModulemdModuleStreamV2 *v2_stream = NULL;
+
+  if (self->package_providers)
+    {
+      return self->package_providers;
+    }
+
+  self->package_providers = g_hash_table_new_full (
+    g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_ptr_array_unref);
+
+  /* Visit the streams in the order that search_rpms () returns them in, so
+   * that the providers of each package end up in that order too.
+   */
+  module_names = get_sorted_module_names (self);
+  for (guint i = 0; i < module_names->len; i++)
+    {
+      module = g_hash_table_lookup (self->modules,
+                                    g_ptr_array_index (module_names, i));
+
+      module_streams = modulemd_module_get_sorted_streams (module);
+      for (guint j = 0; j < module_streams->len; j++)
+        {
+          stream = g_ptr_array_index (module_streams, j);
+
+          if (MODULEMD_IS_MODULE_STREAM_V2 (stream))
+            {
+              v2_stream = MODULEMD_MODULE_STREAM_V2 (stream);
+              add_stream_package_providers (self->package_providers,
+                                            stream,
+                                            v2_stream->rpm_api,
+                                            v2_stream->profiles,
+                                            v2_stream->rpm_components);
+            }
+          else if (MODULEMD_IS_MODULE_STREAM_V1 (stream))
+            {
+              v1_stream = MODULEMD_MODULE_STREAM_V1 (stream);
+              add_stream_package_providers (self->package_providers,
+                                            stream,
+                                            v1_stream->rpm_api,
+                                            v1_stream->profiles,
+                                            v1_stream->rpm_components);
+            }
+        }
+    }
+
+  return self->package_providers;
+}
+
+
+GPtrArray *
+modulemd_module_index_search_package_providers (
+  ModulemdModuleIndex *self,
+  const gchar *package_name,
+  ModulemdPackageSourceFlags sources)
+{
+  GPtrArray *package_providers = NULL;
+  g_autoptr (GPtrArray) found = NULL;
+  ModulemdPackageProvider *provider = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+  g_return_val_if_fail (package_name, NULL);
+
+  found = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_mutex_lock (&self->providers_lock);
+  package_providers =
+    g_hash_table_lookup (get_package_providers (self), package_name);
+  if (package_providers)
+    {
+      for (guint i = 0; i < package_providers->len; i++)
+        {
+          provider = g_ptr_array_index (package_providers, i);
+          if (modulemd_package_provider_get_source (provider) & sources)
+            {
+              g_ptr_array_add (found, g_object_ref (provider));
+            }
+        }
+    }
+  g_mutex_unlock (&self->providers_lock);
+
+  return g_steal_pointer (&found);
+}
+
+
+/*
+ * add_cache_memory_usage:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @usage: (inout): The #ModulemdMemoryUsage to record the memory in.
+ *
+ * Records the memory of the lookup tables and caches of @self, which belong
+ * to the index rather than to any of its modules.
+ */
+static void
+add_cache_memory_usage (ModulemdModuleIndex *self, ModulemdMemoryUsage *usage)
+{
+  GPtrArray *providers = NULL;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  modulemd_memory_usage_add_string_map (usage, self->default_streams);
+
+  modulemd_memory_usage_add_hash_table (usage, self->intent_default_streams);
+  g_hash_table_iter_init (&iter, self->intent_default_streams);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_memory_usage_add_string_map (usage, value);
+    }
+
+  /* The names are borrowed from the keys of modules */
+  modulemd_memory_usage_add_ptr_array (usage, self->sorted_module_names);
+
+  g_mutex_lock (&self->providers_lock);
+  if (self->package_providers)
+    {
+      modulemd_memory_usage_add_hash_table (usage, self->package_providers);
+      g_hash_table_iter_init (&iter, self->package_providers);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          providers = value;
+          modulemd_memory_usage_add_string (usage, key);
+          modulemd_memory_usage_add_ptr_array (usage, providers);
+          for (guint i = 0; i < providers->len; i++)
+            {
+              modulemd_memory_usage_add_object (
+                usage, g_ptr_array_index (providers, i));
+              modulemd_memory_usage_add_string (
+                usage,
+                modulemd_package_provider_get_profile_name (
+                  g_ptr_array_index (providers, i)));
+            }
+        }
+    }
+  g_mutex_unlock (&self->providers_lock);
+
+  g_mutex_lock (&self->digest_lock);
+  if (self->digests)
+    {
+      modulemd_memory_usage_add_hash_table (usage, self->digests);
+      g_hash_table_iter_init (&iter, self->digests);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        {
+          modulemd_memory_usage_add_string (usage, value);
+        }
+    }
+  modulemd_memory_usage_add_string (usage, self->index_digest);
+  g_mutex_unlock (&self->digest_lock);
+}
+
+
+ModulemdMemoryUsage *
+modulemd_module_index_get_memory_usage (ModulemdModuleIndex *self)
+{
+  g_autoptr (ModulemdMemoryUsage) usage = NULL;
+  GPtrArray *module_names = NULL;
+  const gchar *module_name = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  usage = modulemd_memory_usage_new ();
+  module_names = get_sorted_module_names (self);
+
+  modulemd_memory_usage_set_module (usage, NULL);
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_hash_table (usage, self->modules);
+  add_cache_memory_usage (self, usage);
+
+  for (guint i = 0; i < module_names->len; i++)
+    {
+      module_name = g_ptr_array_index (module_names, i);
+
+      /* The key of modules is a copy of the module name */
+      modulemd_memory_usage_set_module (usage, module_name);
+      modulemd_memory_usage_add_string (usage, module_name);
+      modulemd_module_add_memory_usage (
+        g_hash_table_lookup (self->modules, module_name), usage);
+    }
+  modulemd_memory_usage_set_module (usage, NULL);
+
+  return g_steal_pointer (&usage);
+}
+
+
+gboolean
+modulemd_module_index_remove_module (ModulemdModuleIndex *self,
+                                     const gchar *module_name)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (!self->frozen, FALSE);
+
+  invalidate_default_streams (self);
+  invalidate_index_digest (self);
+  invalidate_package_providers (self);
+  g_clear_pointer (&self->sorted_module_names, g_ptr_array_unref);
+
+  return g_hash_table_remove (self->modules, module_name);
+}
+
+
+gboolean
+modulemd_module_index_add_module_stream (ModulemdModuleIndex *self,
+                                         ModulemdModuleStream *stream,
+                                         GError **error)
+{
+  g_autoptr (GError) nested_error = NULL;
+  ModulemdModuleStreamVersionEnum mdversion = MD_MODULESTREAM_VERSION_UNSET;
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  invalidate_index_digest (self);
+  invalidate_package_providers (self);
+
+  if (!modulemd_module_stream_get_module_name (stream) ||
+      !modulemd_module_stream_get_stream_name (stream))
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_MISSING_REQUIRED,
+                   "The module and stream names are required when adding to "
+                   "ModuleIndex.");
+      return FALSE;
+    }
+
+  mdversion = modulemd_module_add_stream (
+    get_or_create_module (self,
+                          modulemd_module_stream_get_module_name (stream)),
+    stream,
+    self->stream_mdversion,
+    &nested_error);
+
+  if (mdversion == MD_MODULESTREAM_VERSION_ERROR)
+    {
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return FALSE;
+    }
+
+  if (mdversion > self->stream_mdversion)
+    {
+      /* Upgrade any streams we've already seen to this version */
+      g_debug ("Upgrading all streams to version %i", mdversion);
+      if (!modulemd_module_index_upgrade_streams (
+            self, mdversion, &nested_error))
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+/* Indexes with fewer modules than this are upgraded on the calling thread,
+ * since the cost of starting worker threads would outweigh the gain.
+ */
+#define MMD_PARALLEL_UPGRADE_MIN_MODULES 64
+
+typedef struct
+{
+  ModulemdModule *module;
+  ModulemdModuleStreamVersionEnum mdversion;
+  GError *error;
+} upgrade_module_task;
+
+
+static gboolean
+upgrade_module_streams (ModulemdModule *module,
+                        ModulemdModuleStreamVersionEnum mdversion,
+                        GError **error)
+{
+  g_autoptr (GError) nested_error = NULL;
+
+  /* Skip any module without streams */
+  if (modulemd_module_get_all_streams (module)->len == 0)
+    {
+      return TRUE;
+    }
+
+  if (!modulemd_module_upgrade_streams (module, mdversion, &nested_error))
+    {
+      g_propagate_prefixed_error (error,
+                                  g_steal_pointer (&nested_error),
+                                  "Error upgrading streams for module %s",
+                                  modulemd_module_get_module_name (module));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+static void
+upgrade_module_streams_worker (gpointer data, gpointer user_data)
+{
+  upgrade_module_task *task = (upgrade_module_task *)data;
+
+  upgrade_module_streams (task->module, task->mdversion, &task->error);
+}
+
+
+/*
+ * upgrade_streams_parallel:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @modules: (in): The sorted names of all modules in @self.
+ * @mdversion: (in): The metadata version to upgrade to.
+ * @error: (out): A #GError containing the reason a stream failed to upgrade.
+ *
+ * Upgrades the modules of @self concurrently on a pool of worker threads.
+ * Modules share no mutable state, so each one can be upgraded independently.
+ *
+ * Returns: TRUE if all modules were upgraded. FALSE and sets @error if the
+ * worker threads could not be started or any module failed to upgrade. The
+ * error is that of the first failing module in @modules order, no matter
+ * which worker finished first.
+ */
+static gboolean
+upgrade_streams_parallel (ModulemdModuleIndex *self,
+                          GPtrArray *modules,
+                          ModulemdModuleStreamVersionEnum mdversion,
+                          GError **error)
+{
+  GThreadPool *pool = NULL;
+  g_autofree upgrade_module_task *tasks = NULL;
+  gboolean ret = TRUE;
+  gsize i;
+
+  tasks = g_new0 (upgrade_module_task, modules->len);
+
+  pool = g_thread_pool_new (upgrade_module_streams_worker,
+                            NULL,
+                            (gint)g_get_num_processors (),
+                            FALSE,
+                            error);
+  if (!pool)
+    {
+      return FALSE;
+    }
+
+  for (i = 0; i < modules->len; i++)
+    {
+      tasks[i].module = modulemd_module_index_get_module (
+        self, g_ptr_array_index (modules, i));
+      tasks[i].mdversion = mdversion;
+      g_thread_pool_push (pool, &tasks[i], NULL);
+    }
+
+  /* Wait for all queued modules to be processed */
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  for (i = 0; i < modules->len; i++)
+    {
+      if (!ret)
+        {
+          g_clear_error (&tasks[i].error);
+        }
+      else if (tasks[i].error)
+        {
+          g_propagate_error (error, g_steal_pointer (&tasks[i].error));
+          ret = FALSE;
+        }
+    }
+
+  return ret;
+}
+
+
+gboolean
+modulemd_module_index_upgrade_streams (
+  ModulemdModuleIndex *self,
+  ModulemdModuleStreamVersionEnum mdversion,
+  GError **error)
+{
+  GPtrArray *modules = NULL;
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  invalidate_index_digest (self);
+  invalidate_package_providers (self);
+
+  if (mdversion < self->stream_mdversion)
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_UPGRADE,
+                   "Downgrades not permitted. mdversion %i < current %i",
+                   mdversion,
+                   self->stream_mdversion);
+      return FALSE;
+    }
+
+  /* Both ways go through the modules in sorted order, so that a failure is
+   * reported for the same module regardless of the number of processors.
+   */
+  modules = get_sorted_module_names (self);
+
+  if (modules->len >= MMD_PARALLEL_UPGRADE_MIN_MODULES &&
+      g_get_num_processors () > 1)
+    {
+      if (!upgrade_streams_parallel (self, modules, mdversion, error))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      for (guint i = 0; i < modules->len; i++)
+        {
+          if (!upgrade_module_streams (
+                modulemd_module_index_get_module (
+                  self, g_ptr_array_index (modules, i)),
+                mdversion,
+                error))
+            {
+              return FALSE;
+            }
+        }
+    }
+
+  self->stream_mdversion = mdversion;
+
+  return TRUE;
+}
+
+
+gboolean
+modulemd_module_index_add_defaults (ModulemdModuleIndex *self,
+                                    ModulemdDefaults *defaults,
+                                    GError **error)
+{
+  g_autoptr (GError) nested_error = NULL;
+  ModulemdDefaultsVersionEnum mdversion = MD_DEFAULTS_VERSION_UNSET;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  invalidate_index_digest (self);
+  invalidate_default_streams (self);
+
+  mdversion = modulemd_module_set_defaults (
+    get_or_create_module (self, modulemd_defaults_get_module_name (defaults)),
+    defaults,
+    self->defaults_mdversion,
+    &nested_error);
+  if (mdversion == MD_DEFAULTS_VERSION_ERROR)
+    {
+      g_propagate_error (error, g_steal_pointer (&nested_error));
+      return FALSE;
+    }
+
+  if (mdversion > self->defaults_mdversion)
+    {
+      /* Upgrade any defaults we've already seen to this version */
+      g_debug ("Upgrading all defaults to version %i", mdversion);
+      if (!modulemd_module_index_upgrade_defaults (
+            self, mdversion, &nested_error))
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+gboolean
+modulemd_module_index_add_obsoletes (ModulemdModuleIndex *self,
+                                     ModulemdObsoletes *obsoletes,
+                                     GError **error)
+{
+  g_autoptr (GError) nested_error = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (MODULEMD_IS_OBSOLETES (obsoletes), FALSE);
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  invalidate_index_digest (self);
+
+  if (!modulemd_obsoletes_get_module_name (obsoletes))
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_MISSING_REQUIRED,
+                   "The obsoletes requries a module name when adding to "
+                   "ModuleIndex.");
+      return FALSE;
+    }
+
+  modulemd_module_add_obsoletes (
+    get_or_create_module (self,
+                          modulemd_obsoletes_get_module_name (obsoletes)),
+    obsoletes);
+
+  /* Obsoletes need at least MD_MODULESTREAM_VERSION_TWO */
+  if (self->stream_mdversion < MD_MODULESTREAM_VERSION_TWO)
+    {
+      if (!modulemd_module_index_upgrade_streams (
+            self, MD_MODULESTREAM_VERSION_TWO, &nested_error))
+        {
+          g_propagate_error (error, g_steal_pointer (&nested_error));
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+static const gchar *
+get_module_default_stream (ModulemdModule *module, const gchar *intent)
+{
+  ModulemdDefaults *defs = modulemd_module_get_defaults (module);
+
+  if (!defs)
+    {
+      return NULL;
+    }
+
+  switch (modulemd_defaults_get_mdversion (defs))
+    {
+    case MD_DEFAULTS_VERSION_ONE:
+      return modulemd_defaults_v1_get_default_stream (
+        MODULEMD_DEFAULTS_V1 (defs), intent);
+
+    default:
+      /* This should be impossible and suggests that we somehow added
+       * a corrupt defaults object. We will ignore it and continue to
+       * return valid entries.
+       */
+      g_warning ("Encountered an unknown defaults mdversion: %" PRIu64,
+                 modulemd_defaults_get_mdversion (defs));
+      return NULL;
+    }
+}
+
+
+static GHashTable *
+build_default_streams (ModulemdModuleIndex *self, const gchar *intent)
+{
+  GHashTable *defaults = NULL;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  const gchar *def_stream_name = NULL;
+
+  defaults = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  g_hash_table_iter_init (&iter, self->modules);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      def_stream_name =
+        get_module_default_stream (MODULEMD_MODULE (value), intent);
+      if (def_stream_name)
+        {
+          /* This module has a default stream. Add it to the table */
+          g_hash_table_replace (
+            defaults, g_strdup (key), g_strdup (def_stream_name));
+        }
+    }
+
+  return defaults;
+}
+
+
+/*
+ * get_cached_default_streams:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @intent: (in) (nullable): The system intent to look up.
+ *
+ * Returns: (transfer none) (nullable): The cached map of module names to
+ * default stream names for @intent, building it first if this is the first
+ * request for @intent since the defaults in @self last changed. NULL if @self
+ * is frozen and no map was built for @intent when it was frozen; the caller
+ * must then look up the defaults without caching them.
+ */
+static GHashTable *
+get_cached_default_streams (ModulemdModuleIndex *self, const gchar *intent)
+{
+  GHashTable *defaults = NULL;
+
+  if (!intent)
+    {
+      if (!self->default_streams)
+        {
+          self->default_streams = build_default_streams (self, NULL);
+        }
+      return self->default_streams;
+    }
+
+  defaults = g_hash_table_lookup (self->intent_default_streams, intent);
+  if (!defaults && !self->frozen)
+    {
+      defaults = build_default_streams (self, intent);
+      g_hash_table_insert (
+        self->intent_default_streams, g_strdup (intent), defaults);
+    }
+
+  return defaults;
+}
+
+
+GHashTable *
+modulemd_module_index_get_default_streams_as_hash_table (
+  ModulemdModuleIndex *self, const gchar *intent)
+{
+  GHashTable *defaults = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  defaults = get_cached_default_streams (self, intent);
+  if (!defaults)
+    {
+      return build_default_streams (self, intent);
+    }
+
+  return modulemd_hash_table_deep_str_copy (defaults);
+}
+
+
+const gchar *
+modulemd_module_index_get_default_stream (ModulemdModuleIndex *self,
+                                          const gchar *module_name,
+                                          const gchar *intent)
+{
+  GHashTable *defaults = NULL;
+  ModulemdModule *module = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+  g_return_val_if_fail (module_name, NULL);
+
+  defaults = get_cached_default_streams (self, intent);
+  if (defaults)
+    {
+      return g_hash_table_lookup (defaults, module_name);
+    }
+
+  module = g_hash_table_lookup (self->modules, module_name);
+  return module ? get_module_default_stream (module, intent) : NULL;
+}
+
+
+gboolean
+modulemd_module_index_upgrade_defaults (ModulemdModuleIndex *self,
+                                        ModulemdDefaultsVersionEnum mdversion,
+                                        GError **error)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  g_autoptr (ModulemdModule) module = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  g_autoptr (GError) nested_error = NULL;
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  invalidate_index_digest (self);
+
+  if (mdversion < self->defaults_mdversion)
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_UPGRADE,
+                   "Downgrades not permitted. mdversion %i < current %i",
+                   mdversion,
+                   self->defaults_mdversion);
+      return FALSE;
+    }
+
+  if (mdversion > MD_DEFAULTS_VERSION_LATEST)
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_UPGRADE,
+                   "Unknown Defaults metadata version %i",
+                   mdversion);
+      return FALSE;
+    }
+
+  invalidate_default_streams (self);
+
+  g_hash_table_iter_init (&iter, self->modules);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      module = g_object_ref (MODULEMD_MODULE (value));
+      defaults = modulemd_module_get_defaults (module);
+
+      /* Skip any module without defaults */
+      if (!defaults)
+        {
+          g_clear_object (&module);
+          continue;
+        }
+
+      g_object_ref (defaults);
+
+      if (mdversion != modulemd_module_set_defaults (
+                         module, defaults, mdversion, &nested_error))
+        {
+          g_propagate_prefixed_error (
+            error,
+            g_steal_pointer (&nested_error),
+            "Error upgrading previously-added defaults: ");
+          return FALSE;
+        }
+      g_clear_object (&defaults);
+      g_clear_object (&module);
+    }
+
+  self->defaults_mdversion = mdversion;
+
+  return TRUE;
+}
+
+
+gboolean
+modulemd_module_index_add_translation (ModulemdModuleIndex *self,
+                                       ModulemdTranslation *translation,
+                                       GError **error)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (MODULEMD_IS_TRANSLATION (translation), FALSE);
+
+  if (!check_not_frozen (self, error))
+    {
+      return FALSE;
+    }
+
+  invalidate_index_digest (self);
+
+  if (!modulemd_translation_get_module_name (translation))
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_MISSING_REQUIRED,
+                   "The translation requries a module name when adding to "
+                   "ModuleIndex.");
+      return FALSE;
+    }
+
+  if (!modulemd_translation_get_module_stream (translation))
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_MISSING_REQUIRED,
+                   "The translation requries a module stream when adding to "
+                   "ModuleIndex.");
+      return FALSE;
+    }
+
+  modulemd_module_add_translation (
+    get_or_create_module (self,
+                          modulemd_translation_get_module_name (translation)),
+    translation);
+  return TRUE;
+}
+
+
+static void
+clear_xmds (gpointer key, gpointer value, gpointer user_data)
+{
+  MODULEMD_INIT_TRACE ();
+
+  g_return_if_fail (MODULEMD_IS_MODULE (value));
+
+  modulemd_module_clear_xmds (MODULEMD_MODULE (value));
+}
+
+
+void
+modulemd_module_index_clear_xmds (ModulemdModuleIndex *self)
+{
+  MODULEMD_INIT_TRACE ();
+
+  g_return_if_fail (MODULEMD_IS_MODULE_INDEX (self));
+  g_return_if_fail (!self->frozen);
+
+  invalidate_index_digest (self);
+  g_hash_table_foreach (self->modules, clear_xmds, NULL);
+}
+
+
+gboolean
+modulemd_module_index_merge (ModulemdModuleIndex *from,
+                             ModulemdModuleIndex *into,
+                             gboolean override,
+                             gboolean strict_default_streams,
+                             GError **error)
+{
+  MODULEMD_INIT_TRACE ();
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  const gchar *module_name = NULL;
+  const gchar *trans_stream = NULL;
+  ModulemdModule *module = NULL;
+  ModulemdModule *into_module = NULL;
+  GPtrArray *streams = NULL;
+  ModulemdModuleStream *stream = NULL;
+  g_autoptr (ModulemdModuleStream) stream_copy = NULL;
+  g_autoptr (GPtrArray) translations = NULL;
+  ModulemdTranslation *translation = NULL;
+  ModulemdTranslation *current_translation = NULL;
+  ModulemdObsoletes *obsoletes = NULL;
+  ModulemdDefaults *defaults = NULL;
+  ModulemdDefaults *into_defaults = NULL;
+  g_autoptr (ModulemdDefaults) merged_defaults = NULL;
+  g_autoptr (GError) nested_error = NULL;
+  guint i;
+  g_autoptr (GPtrArray) translated_stream_names = NULL;
+  GPtrArray *obsoletes_array = NULL;
+  gchar *translated_stream_name = NULL;
+  g_autofree gchar *nsvca = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (from), FALSE);
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (into), FALSE);
+
+  if (!check_not_frozen (into, error))
+    {
+      return FALSE;
+    }
+
+  invalidate_index_digest (into);
+  invalidate_package_providers (into);
+
+  /* The defaults in @into are about to change */
+  invalidate_default_streams (into);
+
+  /* Loop through each module in the Index */
+  g_hash_table_iter_init (&iter, from->modules);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      module_name = (const gchar *)key;
+      g_debug ("Merging module %s", module_name);
+
+      module = MODULEMD_MODULE (value);
+      into_module = get_or_create_module (into, module_name);
+
+      /* Copy all module streams for this module
+       * The module streams have "version" and "context" to disambiguate them,
+       * so we have documented that if there are two modules with differing
+       * content and the same NSVC, the operation is undefined.
+       * As such, we'll just assume it's safe to add every stream. If there are
+       * duplicates, they'll be deduplicated by replacing the previously-
+       * existing entry.
+       */
+      g_debug ("Prioritizer: merging streams for %s", module_name);
+      streams = modulemd_module_get_all_streams (module);
+      for (i = 0; i < streams->len; i++)
+        {
+          stream = g_ptr_array_index (streams, i);
+          nsvca = modulemd_module_stream_get_NSVCA_as_string (stream);
+
+          /* The stream objects are shared with @into, which associates its
+           * own translations and obsoletes with them. The streams of a
+           * frozen index may be read concurrently, so copy them instead.
+           */
+          if (from->frozen)
+            {
+              stream_copy = modulemd_module_stream_copy (stream, NULL, NULL);
+              stream = stream_copy;
+            }
+
+          if (!modulemd_module_index_add_module_stream (
+                into, stream, &nested_error))
+            {
+              if (nested_error)
+                {
+                  g_info ("Could not add stream %s due to %s",
+                          nsvca,
+                          nested_error->message);
+                  g_clear_error (&nested_error);
+                }
+              else
+                {
+                  g_info ("Could not add stream %s", nsvca);
+                }
+            }
+          g_clear_pointer (&nsvca, g_free);
+          g_clear_object (&stream_copy);
+        }
+
+
+      /* Merge any defaults entry for this module */
+      g_debug ("Prioritizer: merging defaults for %s", module_name);
+      defaults = modulemd_module_get_defaults (module);
+      into_defaults = modulemd_module_get_defaults (into_module);
+      if (override && defaults)
+        {
+          /* If we've been told to override (we're at a higher priority level),
+           * then just replace the current defaults with the new one
+           */
+          if (!modulemd_module_index_add_defaults (
+                into, defaults, &nested_error))
+            {
+              g_propagate_error (error, g_steal_pointer (&nested_error));
+              return FALSE;
+            }
+        }
+      else if (!defaults)
+        {
+          /* No defaults to merge in right now, just continue */
+        }
+      else if (defaults && !into_defaults)
+        {
+          /* There are no defaults on the target module yet. Copy these */
+          if (!modulemd_module_index_add_defaults (
+                into, defaults, &nested_error))
+            {
+              g_propagate_error (error, g_steal_pointer (&nested_error));
+              return FALSE;
+            }
+        }
+      else
+        {
+          merged_defaults = modulemd_defaults_merge (
+            defaults, into_defaults, strict_default_streams, &nested_error);
+          if (!merged_defaults)
+            {
+              g_propagate_error (error, g_steal_pointer (&nested_error));
+              return FALSE;
+            }
+
+          /* Add the new, merged defaults to the index */
+          if (!modulemd_module_index_add_defaults (
+                into, merged_defaults, &nested_error))
+            {
+              g_propagate_error (error, g_steal_pointer (&nested_error));
+              return FALSE;
+            }
+          g_clear_object (&merged_defaults);
+        }
+
+      /* Merge translations for this module */
+      g_debug ("Prioritizer: merging translations for %s", module_name);
+      translated_stream_names =
+        modulemd_module_get_translated_streams (module);
+      for (i = 0; i < translated_stream_names->len; i++)
+        {
+          translated_stream_name =
+            g_ptr_array_index (translated_stream_names, i);
+          translation =
+            modulemd_module_get_translation (module, translated_stream_name);
+          trans_stream = modulemd_translation_get_module_stream (translation);
+          current_translation =
+            modulemd_module_get_translation (into_module, trans_stream);
+
+          if (!current_translation ||
+              modulemd_translation_get_modified (translation) >
+                modulemd_translation_get_modified (current_translation))
+            {
+              /* There was no translation for this stream name or we just found
+               * a newer version of it, so set it on the index.
+               */
+              if (!modulemd_module_index_add_translation (
+                    into, translation, &nested_error))
+                {
+                  g_propagate_error (error, g_steal_pointer (&nested_error));
+                  return FALSE;
+                }
+            }
+        }
+      g_clear_pointer (&translated_stream_names, g_ptr_array_unref);
+
+      /* Merge obsoletes for this module */
+      g_debug ("Prioritizer: merging obsoletes for %s", module_name);
+      obsoletes_array = modulemd_module_get_obsoletes (module);
+      for (i = 0; i < obsoletes_array->len; i++)
+        {
+          obsoletes = g_ptr_array_index (obsoletes_array, i);
+
+          if (obsoletes)
+            {
+              /* Add obsoletes, overriding if we encounter one with
+               * identical module, stream, context and modified time.
+               */
+              if (!modulemd_module_index_add_obsoletes (
+                    into, obsoletes, &nested_error))
+                {
+                  g_propagate_error (error, g_steal_pointer (&nested_error));
+                  return FALSE;
+                }
+            }
+        }
+
+      g_debug ("Prioritizer: all documents merged for %s", module_name);
+      g_clear_pointer (&translations, g_ptr_array_unref);
+    }
+  return TRUE;
+}
+
+
+ModulemdDefaultsVersionEnum
+modulemd_module_index_get_defaults_mdversion (ModulemdModuleIndex *self)
+{
+  return self->defaults_mdversion;
+}
+
+
+ModulemdModuleStreamVersionEnum
+modulemd_module_index_get_stream_mdversion (ModulemdModuleIndex *self)
+{
+  return self->stream_mdversion;
+}
+
+
+void
+modulemd_module_index_freeze (ModulemdModuleIndex *self)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  ModulemdModule *module = NULL;
+  ModulemdModuleStream *stream = NULL;
+  ModulemdDefaults *defaults = NULL;
+  GPtrArray *streams = NULL;
+  g_autoptr (GHashTable) intents = NULL;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_INDEX (self));
+
+  if (self->frozen)
+    {
+      return;
+    }
+
+  intents = g_hash_table_new (g_str_hash, g_str_equal);
+
+  g_hash_table_iter_init (&iter, self->modules);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      module = MODULEMD_MODULE (value);
+
+      /* Put the streams in the order that dump_streams () would sort them
+       * into, so that dumping does not have to.
+       */
+      streams = modulemd_module_get_all_streams (module);
+      g_ptr_array_sort (streams, compare_stream_SVCA);
+
+      /* Dumping a frozen module does not record validation results, so the
+       * streams that can be skipped are marked now. Invalid ones are left
+       * for the dump to report.
+       */
+      for (guint i = 0; i < streams->len; i++)
+        {
+          stream = g_ptr_array_index (streams, i);
+          if (!modulemd_module_stream_is_validated (stream) &&
+              modulemd_module_stream_validate (stream, NULL))
+            {
+              modulemd_module_stream_mark_validated (stream);
+            }
+        }
+
+      modulemd_module_freeze (module);
+
+      defaults = modulemd_module_get_defaults (module);
+      if (defaults && MODULEMD_IS_DEFAULTS_V1 (defaults))
+        {
+          modulemd_defaults_v1_collect_intents (
+            MODULEMD_DEFAULTS_V1 (defaults), intents);
+        }
+    }
+
+  get_sorted_module_names (self);
+
+  /* Lookups for intents that none of the defaults mention are not cached;
+   * they are answered without modifying the index.
+   */
+  get_cached_default_streams (self, NULL);
+  g_hash_table_iter_init (&iter, intents);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      get_cached_default_streams (self, key);
+    }
+
+  self->frozen = TRUE;
+}
+
+
+gboolean
+modulemd_module_index_is_frozen (ModulemdModuleIndex *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  return self->frozen;
+}
+
+
+void
+modulemd_module_index_set_force_validate (ModulemdModuleIndex *self,
+                                          gboolean force_validate)
+{
+  g_return_if_fail (MODULEMD_IS_MODULE_INDEX (self));
+  g_return_if_fail (!self->frozen);
+
+  self->force_validate = force_validate;
+}
+
+
+gboolean
+modulemd_module_index_get_force_validate (ModulemdModuleIndex *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  return self->force_validate;
+}
+
+
+void
+modulemd_module_index_set_compact_on_load (ModulemdModuleIndex *self,
+                                           gboolean compact_on_load)
+{
+  g_return_if_fail (MODULEMD_IS_MODULE_INDEX (self));
+  g_return_if_fail (!self->frozen);
+
+  if (!compact_on_load)
+    {
+      g_clear_pointer (&self->compactor, modulemd_compactor_free);
+    }
+  else if (self->compactor == NULL)
+    {
+      self->compactor = modulemd_compactor_new ();
+    }
+}
+
+
+gboolean
+modulemd_module_index_get_compact_on_load (ModulemdModuleIndex *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+
+  return self->compactor != NULL;
+}
+
+
+guint
+modulemd_module_index_compact (ModulemdModuleIndex *self)
+{
+  g_autoptr (ModulemdCompactor) compactor = NULL;
+  GPtrArray *module_names = NULL;
+  GPtrArray *streams = NULL;
+  ModulemdModule *module = NULL;
+  ModulemdModuleStream *stream = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), 0);
+
+  compactor = modulemd_compactor_new ();
+
+  /* Walk the modules and streams in a fixed order, so that the same streams
+   * end up holding the canonical sets every time.
+   */
+  module_names = get_sorted_module_names (self);
+  for (guint i = 0; i < module_names->len; i++)
+    {
+      module = g_hash_table_lookup (self->modules,
+                                    g_ptr_array_index (module_names, i));
+      streams = modulemd_module_get_all_streams (module);
 
-  fmode = modulemd_get_rpmio_fmode ("r", comtype);
-  if (!fmode)
+      for (guint j = 0; j < streams->len; j++)
+        {
+          stream = g_ptr_array_index (streams, j);
+          if (MODULEMD_IS_MODULE_STREAM_V2 (stream))
+            {
+              modulemd_module_stream_v2_compact (
+                MODULEMD_MODULE_STREAM_V2 (stream), compactor);
+            }
+        }
+    }
+
+  return modulemd_compactor_get_n_shared (compactor);
+}
+
+
+gchar *
+modulemd_module_index_dup_digest (ModulemdModuleIndex *self,
+                                  gpointer object)
+{
+  gchar *digest = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+
+  if (MODULEMD_IS_MODULE_STREAM (object))
     {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_FILE_ACCESS,
-                   "Unable to construct rpmio fmode from comtype [%d]",
-                   comtype);
-      return FALSE;
+      return modulemd_module_stream_dup_digest (
+        MODULEMD_MODULE_STREAM (object));
     }
 
-  /* Create an rpmio file descriptor object from the current file descriptor,
-   * setting the appropriate "mode" so that librpm will read it with the
-   * correct handlers.
+  /* Other objects do not record when they change, but those of a frozen
+   * index cannot.
    */
-  fd_dup = fdDup (fd);
-  saved_errno = errno;
-  if (!fd_dup)
+  if (!self->frozen)
     {
-      g_set_error (
-        error,
-        MODULEMD_ERROR,
-        MMD_ERROR_NOT_IMPLEMENTED,
-        "Cannot open compressed file. Error in rpmio::fdDup(%d): %s",
-        fd,
-        strerror (saved_errno));
-      return FALSE;
+      return NULL;
     }
 
-  g_debug ("Calling rpmio::Fdopen (%p, %s)", fd_dup, fmode);
-  rpmio_fd = Fdopen (fd_dup, fmode);
+  g_mutex_lock (&self->digest_lock);
+  if (self->digests)
+    {
+      digest = g_strdup (g_hash_table_lookup (self->digests, object));
+    }
+  g_mutex_unlock (&self->digest_lock);
 
-  if (!rpmio_fd)
+  return digest;
+}
+
+
+/* Fewer digests than this are always computed serially; the thread startup
+ * cost outweighs the gain.
+ */
+#define MMD_PARALLEL_DIGEST_MIN_OBJECTS 256
+
+/* The length in bytes of a SHA-256 digest */
+#define MMD_DIGEST_LENGTH 32
+
+/* The version of the modulemd-delta documents written and read here */
+#define MD_DELTA_VERSION_ONE 1
+
+
+static gint
+update_checksum (void *data, unsigned char *buffer, size_t size)
+{
+  g_checksum_update ((GChecksum *)data, buffer, size);
+  return 1;
+}
+
+
+static gboolean
+emit_object (GObject *object, yaml_emitter_t *emitter, GError **error)
+{
+  if (MODULEMD_IS_MODULE_STREAM_V1 (object))
     {
-      g_set_error_literal (
-        error,
-        MODULEMD_ERROR,
-        MMD_ERROR_NOT_IMPLEMENTED,
-        "Cannot open compressed file. Error in rpmio::Fdopen().");
-      return FALSE;
+      return modulemd_module_stream_v1_emit_yaml (
+        MODULEMD_MODULE_STREAM_V1 (object), emitter, error);
     }
 
-  g_debug ("rpmio::Fdopen (%p, %s) succeeded", fd_dup, fmode);
+  if (MODULEMD_IS_MODULE_STREAM_V2 (object))
+    {
+      return modulemd_module_stream_v2_emit_yaml (
+        MODULEMD_MODULE_STREAM_V2 (object), emitter, error);
+    }
 
-  return modulemd_module_index_update_from_custom (
-    self, compressed_stream_read_fn, rpmio_fd, strict, failures, error);
+  if (MODULEMD_IS_DEFAULTS_V1 (object))
+    {
+      return modulemd_defaults_v1_emit_yaml (
+        MODULEMD_DEFAULTS_V1 (object), emitter, error);
+    }
 
-#else /* HAVE_RPMIO */
-  g_set_error_literal (
-    error,
-    MODULEMD_ERROR,
-    MMD_ERROR_NOT_IMPLEMENTED,
-    "Cannot open compressed file. libmodulemd was not compiled "
-    "with rpmio support.");
+  if (MODULEMD_IS_TRANSLATION (object))
+    {
+      return modulemd_translation_emit_yaml (
+        MODULEMD_TRANSLATION (object), emitter, error);
+    }
+
+  if (MODULEMD_IS_OBSOLETES (object))
+    {
+      return modulemd_obsoletes_emit_yaml (
+        MODULEMD_OBSOLETES (object), emitter, error);
+    }
+
+  g_set_error (error,
+               MODULEMD_ERROR,
+               MMD_ERROR_VALIDATE,
+               "Objects of type %s cannot be serialized",
+               G_OBJECT_TYPE_NAME (object));
   return FALSE;
-#endif /* HAVE_RPMIO */
 }
 
 
-gboolean
-modulemd_module_index_update_from_file (ModulemdModuleIndex *self,
-                                        const gchar *yaml_file,
-                                        gboolean strict,
-                                        GPtrArray **failures,
-                                        GError **error)
+static gchar *
+compute_digest (GObject *object, GError **error)
 {
-  return modulemd_module_index_update_from_file_ext (
-    self, yaml_file, strict, FALSE, failures, error);
+  g_autoptr (GChecksum) checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  MMD_INIT_YAML_EMITTER (emitter);
+
+  yaml_emitter_set_output (&emitter, update_checksum, checksum);
+  MMD_INIT_YAML_WRITER (&emitter, writer);
+
+  if (!mmd_emitter_start_stream (&emitter, error))
+    {
+      return NULL;
+    }
+
+  if (!emit_object (object, &emitter, error))
+    {
+      return NULL;
+    }
+
+  if (!mmd_emitter_end_stream (&emitter, error))
+    {
+      return NULL;
+    }
+
+  return g_strdup (g_checksum_get_string (checksum));
 }
 
 
-gboolean
-modulemd_module_index_update_from_string (ModulemdModuleIndex *self,
-                                          const gchar *yaml_string,
-                                          gboolean strict,
-                                          GPtrArray **failures,
-                                          GError **error)
+typedef struct
 {
-  if (*failures == NULL)
+  GObject *object;
+  gchar **digest;
+  GError *error;
+} digest_task;
+
+
+static void
+digest_worker (gpointer data, gpointer UNUSED (user_data))
+{
+  digest_task *task = (digest_task *)data;
+
+  *task->digest = compute_digest (task->object, &task->error);
+}
+
+
+/*
+ * compute_digests:
+ * @tasks: (inout): An array of #digest_task.
+ * @error: (out): A #GError containing the reason a digest could not be
+ * computed.
+ *
+ * Fills in the digest of every task, using a thread pool when there are
+ * many of them.
+ *
+ * Returns: TRUE if all digests were computed. FALSE and sets @error to the
+ * error of the first failing task otherwise.
+ */
+static gboolean
+compute_digests (GArray *tasks, GError **error)
+{
+  GThreadPool *pool = NULL;
+  digest_task *task = NULL;
+  gboolean ret = TRUE;
+
+  if (tasks->len >= MMD_PARALLEL_DIGEST_MIN_OBJECTS &&
+      g_get_num_processors () > 1)
     {
-      *failures = g_ptr_array_new_full (0, g_object_unref);
+      pool = g_thread_pool_new (
+        digest_worker, NULL, (gint)g_get_num_processors (), FALSE, error);
+      if (!pool)
+        {
+          return FALSE;
+        }
+
+      for (guint i = 0; i < tasks->len; i++)
+        {
+          g_thread_pool_push (
+            pool, &g_array_index (tasks, digest_task, i), NULL);
+        }
+
+      /* Wait for all queued digests to be computed */
+      g_thread_pool_free (pool, FALSE, TRUE);
+    }
+  else
+    {
+      for (guint i = 0; i < tasks->len; i++)
+        {
+          digest_worker (&g_array_index (tasks, digest_task, i), NULL);
+        }
     }
 
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  for (guint i = 0; i < tasks->len; i++)
+    {
+      task = &g_array_index (tasks, digest_task, i);
+      if (task->error && ret)
+        {
+          g_propagate_error (error, g_steal_pointer (&task->error));
+          ret = FALSE;
+        }
+      g_clear_error (&task->error);
+    }
 
-  if (!yaml_string)
+  return ret;
+}
+
+
+GPtrArray *
+modulemd_module_index_get_object_digests (ModulemdModuleIndex *self,
+                                          GPtrArray *objects,
+                                          GError **error)
+{
+  g_autoptr (GPtrArray) digests = NULL;
+  g_autoptr (GArray) tasks = NULL;
+  digest_task task = { 0 };
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+  g_return_val_if_fail (objects, NULL);
+
+  digests = g_ptr_array_new_full (objects->len, g_free);
+  g_ptr_array_set_size (digests, objects->len);
+  tasks = g_array_new (FALSE, FALSE, sizeof (digest_task));
+
+  for (guint i = 0; i < objects->len; i++)
     {
-      g_set_error (
-        error, MODULEMD_ERROR, MMD_YAML_ERROR_OPEN, "No string provided");
-      return FALSE;
+      digests->pdata[i] = modulemd_module_index_dup_digest (
+        self, g_ptr_array_index (objects, i));
+      if (digests->pdata[i] == NULL)
+        {
+          task.object = g_ptr_array_index (objects, i);
+          task.digest = (gchar **)&digests->pdata[i];
+          g_array_append_val (tasks, task);
+        }
     }
 
-  MMD_INIT_YAML_PARSER (parser);
+  if (!compute_digests (tasks, error))
+    {
+      return NULL;
+    }
 
-  yaml_parser_set_input_string (
-    &parser, (const unsigned char *)yaml_string, strlen (yaml_string));
+  for (guint i = 0; i < tasks->len; i++)
+    {
+      task = g_array_index (tasks, digest_task, i);
+      if (MODULEMD_IS_MODULE_STREAM (task.object))
+        {
+          modulemd_module_stream_set_digest (
+            MODULEMD_MODULE_STREAM (task.object), *task.digest);
+          continue;
+        }
 
-  return modulemd_module_index_update_from_parser (
-    self, &parser, strict, FALSE, failures, error);
+      /* The other objects of a mutable index may change at any time */
+      if (!self->frozen)
+        {
+          continue;
+        }
+
+      g_mutex_lock (&self->digest_lock);
+      if (!self->digests)
+        {
+          self->digests = g_hash_table_new_full (
+            g_direct_hash, g_direct_equal, NULL, g_free);
+        }
+      g_hash_table_replace (
+        self->digests, task.object, g_strdup (*task.digest));
+      g_mutex_unlock (&self->digest_lock);
+    }
+
+  return g_steal_pointer (&digests);
 }
 
 
-gboolean
-modulemd_module_index_update_from_stream (ModulemdModuleIndex *self,
-                                          FILE *yaml_stream,
-                                          gboolean strict,
-                                          GPtrArray **failures,
-                                          GError **error)
+static ModulemdYamlDocumentTypeEnum
+get_object_doctype (GObject *object)
 {
-  if (*failures == NULL)
+  if (MODULEMD_IS_MODULE_STREAM (object))
     {
-      *failures = g_ptr_array_new_full (0, g_object_unref);
+      return MODULEMD_YAML_DOC_MODULESTREAM;
     }
 
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  if (MODULEMD_IS_DEFAULTS (object))
+    {
+      return MODULEMD_YAML_DOC_DEFAULTS;
+    }
 
-  if (!yaml_stream)
+  if (MODULEMD_IS_TRANSLATION (object))
     {
-      g_set_error (
-        error, MODULEMD_ERROR, MMD_YAML_ERROR_OPEN, "No stream provided");
-      return FALSE;
+      return MODULEMD_YAML_DOC_TRANSLATIONS;
     }
 
-  MMD_INIT_YAML_PARSER (parser);
+  if (MODULEMD_IS_OBSOLETES (object))
+    {
+      return MODULEMD_YAML_DOC_OBSOLETES;
+    }
 
-  yaml_parser_set_input_file (&parser, yaml_stream);
+  return MODULEMD_YAML_DOC_UNKNOWN;
+}
 
-  return modulemd_module_index_update_from_parser (
-    self, &parser, strict, FALSE, failures, error);
+
+static const gchar *
+get_object_module_name (GObject *object)
+{
+  switch (get_object_doctype (object))
+    {
+    case MODULEMD_YAML_DOC_MODULESTREAM:
+      return modulemd_module_stream_get_module_name (
+        MODULEMD_MODULE_STREAM (object));
+
+    case MODULEMD_YAML_DOC_DEFAULTS:
+      return modulemd_defaults_get_module_name (MODULEMD_DEFAULTS (object));
+
+    case MODULEMD_YAML_DOC_TRANSLATIONS:
+      return modulemd_translation_get_module_name (
+        MODULEMD_TRANSLATION (object));
+
+    case MODULEMD_YAML_DOC_OBSOLETES:
+      return modulemd_obsoletes_get_module_name (MODULEMD_OBSOLETES (object));
+
+    default: g_return_val_if_reached (NULL);
+    }
+}
+
+
+static gchar *
+make_object_key (ModulemdYamlDocumentTypeEnum doctype,
+                 const gchar *module_name,
+                 const gchar *stream_name,
+                 const gchar *version,
+                 const gchar *context,
+                 const gchar *extra)
+{
+  return g_strdup_printf ("%s\n%s\n%s\n%s\n%s\n%s",
+                          modulemd_yaml_get_doctype_string (doctype, 1),
+                          module_name,
+                          stream_name ? stream_name : "",
+                          version ? version : "",
+                          context ? context : "",
+                          extra ? extra : "");
 }
 
 
-gboolean
-modulemd_module_index_update_from_custom (ModulemdModuleIndex *self,
-                                          ModulemdReadHandler custom_read_fn,
-                                          void *custom_pvt_data,
-                                          gboolean strict,
-                                          GPtrArray **failures,
-                                          GError **error)
+/*
+ * get_object_key:
+ * @object: (in): A stream, defaults, translation or obsoletes object.
+ *
+ * Returns: (transfer full): A string that identifies @object within an index.
+ * Objects are identified the same way as by modulemd_module_index_diff(), so
+ * an index never holds two objects with the same key.
+ */
+static gchar *
+get_object_key (GObject *object)
 {
-  if (*failures == NULL)
-    {
-      *failures = g_ptr_array_new_full (0, g_object_unref);
-    }
+  ModulemdModuleStream *stream = NULL;
+  ModulemdObsoletes *obsoletes = NULL;
+  ModulemdYamlDocumentTypeEnum doctype = get_object_doctype (object);
+  g_autofree gchar *number = NULL;
 
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
-  g_return_val_if_fail (custom_read_fn, FALSE);
+  switch (doctype)
+    {
+    case MODULEMD_YAML_DOC_MODULESTREAM:
+      stream = MODULEMD_MODULE_STREAM (object);
+      number = g_strdup_printf ("%" PRIu64,
+                                modulemd_module_stream_get_version (stream));
+      return make_object_key (doctype,
+                              modulemd_module_stream_get_module_name (stream),
+                              modulemd_module_stream_get_stream_name (stream),
+                              number,
+                              modulemd_module_stream_get_context (stream),
+                              modulemd_module_stream_get_arch (stream));
 
-  MMD_INIT_YAML_PARSER (parser);
+    case MODULEMD_YAML_DOC_DEFAULTS:
+      return make_object_key (
+        doctype, get_object_module_name (object), NULL, NULL, NULL, NULL);
 
-  yaml_parser_set_input (&parser, custom_read_fn, custom_pvt_data);
+    case MODULEMD_YAML_DOC_TRANSLATIONS:
+      return make_object_key (doctype,
+                              get_object_module_name (object),
+                              modulemd_translation_get_module_stream (
+                                MODULEMD_TRANSLATION (object)),
+                              NULL,
+                              NULL,
+                              NULL);
 
-  return modulemd_module_index_update_from_parser (
-    self, &parser, strict, FALSE, failures, error);
+    case MODULEMD_YAML_DOC_OBSOLETES:
+      obsoletes = MODULEMD_OBSOLETES (object);
+      number = g_strdup_printf ("%" PRIu64,
+                                modulemd_obsoletes_get_modified (obsoletes));
+      return make_object_key (
+        doctype,
+        modulemd_obsoletes_get_module_name (obsoletes),
+        modulemd_obsoletes_get_module_stream (obsoletes),
+        NULL,
+        modulemd_obsoletes_get_module_context (obsoletes),
+        number);
+
+    default: g_return_val_if_reached (NULL);
+    }
 }
 
 
 /*
- * modules_from_directory:
- * @path: A directory containing one or more modulemd YAML documents
- * @file_suffix: A file suffix to limit the files to be read. Pass "" if you
- * need to read all files.
- * @strict: Whether to fail on unknown fields
- * @strict_default_streams: Whether to fail on default stream merges.
- * @error: Error return value
+ * collect_module_objects:
+ * @module: (in): A #ModulemdModule.
+ * @objects: (inout): The array to append the objects of @module to.
+ *
+ * Appends the defaults, obsoletes, translations and streams of @module to
+ * @objects, in that order. The objects are not referenced.
  */
-static ModulemdModuleIndex *
-modules_from_directory (const gchar *path,
-                        const gchar *file_suffix,
-                        gboolean strict,
-                        gboolean strict_default_streams,
-                        GError **error)
+static void
+collect_module_objects (ModulemdModule *module, GPtrArray *objects)
 {
-  const gchar *filename = NULL;
-  g_autoptr (GDir) dir = NULL;
-  g_autofree gchar *filepath = NULL;
-  g_autoptr (ModulemdModuleIndex) index = NULL;
-  g_autoptr (ModulemdModuleIndex) intermediate = NULL;
-  g_autoptr (GPtrArray) failures = NULL;
-  g_autoptr (GError) nested_error = NULL;
+  ModulemdDefaults *defaults = modulemd_module_get_defaults (module);
+  GPtrArray *obsoletes = modulemd_module_get_obsoletes (module);
+  GPtrArray *streams = modulemd_module_get_all_streams (module);
+  g_autoptr (GPtrArray) translated = NULL;
 
-  index = modulemd_module_index_new ();
+  if (defaults)
+    {
+      g_ptr_array_add (objects, defaults);
+    }
 
-  /* Open the directory */
-  dir = g_dir_open (path, 0, &nested_error);
-  if (!dir)
+  for (guint i = 0; i < obsoletes->len; i++)
     {
-      g_propagate_error (error, g_steal_pointer (&nested_error));
-      return FALSE;
+      g_ptr_array_add (objects, g_ptr_array_index (obsoletes, i));
     }
 
-  while ((filename = g_dir_read_name (dir)) != NULL)
+  translated = modulemd_module_get_translated_streams (module);
+  for (guint i = 0; i < translated->len; i++)
     {
-      if (g_str_has_suffix (filename, file_suffix))
-        {
-          intermediate = modulemd_module_index_new ();
+      g_ptr_array_add (objects,
+                       modulemd_module_get_translation (
+                         module, g_ptr_array_index (translated, i)));
+    }
 
-          filepath = g_build_path ("/", path, filename, NULL);
-          g_debug ("Reading modulemd from %s", filepath);
-          if (!modulemd_module_index_update_from_file (
-                intermediate, filepath, strict, &failures, error))
-            {
-              return FALSE;
-            }
+  for (guint i = 0; i < streams->len; i++)
+    {
+      g_ptr_array_add (objects, g_ptr_array_index (streams, i));
+    }
+}
 
-          if (!modulemd_module_index_merge (intermediate,
-                                            index,
-                                            FALSE,
-                                            strict_default_streams,
-                                            &nested_error))
-            {
-              g_propagate_error (error, g_steal_pointer (&nested_error));
-              return FALSE;
-            }
 
-          g_clear_pointer (&failures, g_ptr_array_unref);
-          g_clear_pointer (&filepath, g_free);
-          g_clear_object (&intermediate);
-        }
+static gchar *
+digest_to_hex (const guint8 *digest)
+{
+  GString *hex = g_string_sized_new (2 * MMD_DIGEST_LENGTH);
+
+  for (guint i = 0; i < MMD_DIGEST_LENGTH; i++)
+    {
+      g_string_append_printf (hex, "%02x", digest[i]);
     }
 
-  return g_steal_pointer (&index);
+  return g_string_free (hex, FALSE);
 }
 
 
-gboolean
-modulemd_module_index_update_from_defaults_directory (
-  ModulemdModuleIndex *self,
-  const gchar *path,
-  gboolean strict,
-  const gchar *overrides_path,
-  GError **error)
+static gboolean
+digest_from_hex (const gchar *hex, guint8 *digest)
 {
-  g_autoptr (ModulemdModuleIndex) defaults_idx = NULL;
-  g_autoptr (ModulemdModuleIndex) override_idx = NULL;
-  g_autoptr (GError) nested_error = NULL;
+  gint high;
+  gint low;
 
-  /* Read the regular path first */
-  defaults_idx = modules_from_directory (
-    path, MMD_YAML_SUFFIX, strict, strict, &nested_error);
-  if (!defaults_idx)
+  if (strlen (hex) != 2 * MMD_DIGEST_LENGTH)
     {
-      g_propagate_error (error, g_steal_pointer (&nested_error));
       return FALSE;
     }
 
-  /* If an override path was provided, use that too */
-  if (overrides_path)
+  for (guint i = 0; i < MMD_DIGEST_LENGTH; i++)
     {
-      override_idx = modules_from_directory (
-        overrides_path, MMD_YAML_SUFFIX, strict, strict, &nested_error);
-      if (!override_idx)
-        {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
-          return FALSE;
-        }
-
-      if (!modulemd_module_index_merge (
-            override_idx, defaults_idx, TRUE, strict, &nested_error))
+      high = g_ascii_xdigit_value (hex[2 * i]);
+      low = g_ascii_xdigit_value (hex[2 * i + 1]);
+      if (high < 0 || low < 0)
         {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
           return FALSE;
         }
+      digest[i] = (guint8)((high << 4) | low);
     }
 
-  /* Now that we've verified that the content in the two paths is compatible,
-   * attempt to merge it into the existing index.
-   */
-  if (!modulemd_module_index_merge (
-        defaults_idx, self, TRUE, strict, &nested_error))
+  return TRUE;
+}
+
+
+/*
+ * xor_object_digests:
+ * @self: (in): The #ModulemdModuleIndex that @objects are part of.
+ * @objects: (in): Stream, defaults, translation or obsoletes objects.
+ * @digest: (inout): An index digest of %MMD_DIGEST_LENGTH bytes.
+ * @error: (out): A #GError containing the reason a digest could not be
+ * computed.
+ *
+ * The digest of an index is the XOR of one term per object, which is the
+ * SHA-256 of the key and the content digest of the object. Since XOR is its
+ * own inverse, this function both adds @objects to and removes them from
+ * @digest.
+ *
+ * Returns: TRUE if the terms of all @objects were folded into @digest.
+ */
+static gboolean
+xor_object_digests (ModulemdModuleIndex *self,
+                    GPtrArray *objects,
+                    guint8 *digest,
+                    GError **error)
+{
+  g_autoptr (GPtrArray) content_digests = NULL;
+  guint8 term[MMD_DIGEST_LENGTH];
+  gsize term_len;
+
+  content_digests =
+    modulemd_module_index_get_object_digests (self, objects, error);
+  if (!content_digests)
     {
-      g_propagate_error (error, g_steal_pointer (&nested_error));
       return FALSE;
     }
 
+  for (guint i = 0; i < objects->len; i++)
+    {
+      g_autoptr (GChecksum) checksum = g_checksum_new (G_CHECKSUM_SHA256);
+      g_autofree gchar *key = get_object_key (g_ptr_array_index (objects, i));
+
+      g_checksum_update (checksum, (const guchar *)key, -1);
+      g_checksum_update (checksum, (const guchar *)"\n", 1);
+      g_checksum_update (
+        checksum, g_ptr_array_index (content_digests, i), -1);
+
+      term_len = sizeof (term);
+      g_checksum_get_digest (checksum, term, &term_len);
+      for (guint j = 0; j < MMD_DIGEST_LENGTH; j++)
+        {
+          digest[j] ^= term[j];
+        }
+    }
 
   return TRUE;
 }
 
 
 gchar *
-modulemd_module_index_dump_to_string (ModulemdModuleIndex *self,
-                                      GError **error)
+modulemd_module_index_get_digest (ModulemdModuleIndex *self, GError **error)
 {
+  g_autoptr (GPtrArray) objects = NULL;
+  guint8 digest[MMD_DIGEST_LENGTH] = { 0 };
+  gchar *hex = NULL;
+  GHashTableIter iter;
+  gpointer value;
+
   g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
 
-  MMD_INIT_YAML_EMITTER (emitter);
-  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+  if (self->frozen)
+    {
+      g_mutex_lock (&self->digest_lock);
+      hex = g_strdup (self->index_digest);
+      g_mutex_unlock (&self->digest_lock);
+      if (hex)
+        {
+          return hex;
+        }
+    }
+
+  objects = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, self->modules);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      collect_module_objects (MODULEMD_MODULE (value), objects);
+    }
 
-  if (!modulemd_module_index_dump_to_emitter (self, &emitter, error))
+  if (!xor_object_digests (self, objects, digest, error))
     {
       return NULL;
     }
 
-  return g_steal_pointer (&yaml_string->str);
+  hex = digest_to_hex (digest);
+
+  /* The objects of a mutable index may change at any time */
+  if (self->frozen)
+    {
+      g_mutex_lock (&self->digest_lock);
+      if (!self->index_digest)
+        {
+          self->index_digest = g_strdup (hex);
+        }
+      g_mutex_unlock (&self->digest_lock);
+    }
+
+  return hex;
 }
 
 
-gboolean
-modulemd_module_index_dump_to_stream (ModulemdModuleIndex *self,
-                                      FILE *yaml_stream,
-                                      GError **error)
+/* How removals of each kind of object are written in a modulemd-delta
+ * document, in the order they are written.
+ */
+typedef struct
 {
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  const gchar *section;
+  ModulemdYamlDocumentTypeEnum doctype;
+  /* The first n_required fields must always be present */
+  const gchar *fields[6];
+  guint n_required;
+} delta_removal_kind;
+
+static const delta_removal_kind delta_removal_kinds[] = {
+  { "defaults", MODULEMD_YAML_DOC_DEFAULTS, { "module", NULL }, 1 },
+  { "obsoletes",
+    MODULEMD_YAML_DOC_OBSOLETES,
+    { "module", "stream", "modified", "context", NULL },
+    3 },
+  { "translations",
+    MODULEMD_YAML_DOC_TRANSLATIONS,
+    { "module", "stream", NULL },
+    2 },
+  { "streams",
+    MODULEMD_YAML_DOC_MODULESTREAM,
+    { "module", "stream", "version", "context", "arch", NULL },
+    3 },
+};
+
+
+typedef struct
+{
+  gchar *module_name;
+  gchar *key;
+} index_delta_removal;
 
-  MMD_INIT_YAML_EMITTER (emitter);
-  yaml_emitter_set_output_file (&emitter, yaml_stream);
 
-  return modulemd_module_index_dump_to_emitter (self, &emitter, error);
+static void
+index_delta_removal_free (index_delta_removal *removal)
+{
+  g_free (removal->module_name);
+  g_free (removal->key);
+  g_free (removal);
 }
 
 
-gboolean
-modulemd_module_index_dump_to_custom (ModulemdModuleIndex *self,
-                                      ModulemdWriteHandler custom_write_fn,
-                                      void *custom_pvt_data,
-                                      GError **error)
+typedef struct
 {
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  gchar *base;
+  gchar *result;
+  GPtrArray *removals;
+  GPtrArray *objects;
+} index_delta;
 
-  MMD_INIT_YAML_EMITTER (emitter);
-  yaml_emitter_set_output (&emitter, custom_write_fn, custom_pvt_data);
 
-  return modulemd_module_index_dump_to_emitter (self, &emitter, error);
+static index_delta *
+index_delta_new (void)
+{
+  index_delta *delta = g_new0 (index_delta, 1);
+
+  delta->removals = g_ptr_array_new_with_free_func (
+    (GDestroyNotify)index_delta_removal_free);
+  delta->objects = g_ptr_array_new_with_free_func (g_object_unref);
+
+  return delta;
 }
 
 
-GStrv
-modulemd_module_index_get_module_names_as_strv (ModulemdModuleIndex *self)
+static void
+index_delta_free (index_delta *delta)
 {
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
-
-  return modulemd_ordered_str_keys_as_strv (self->modules);
+  g_free (delta->base);
+  g_free (delta->result);
+  g_ptr_array_unref (delta->removals);
+  g_ptr_array_unref (delta->objects);
+  g_free (delta);
 }
 
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (index_delta, index_delta_free);
 
-ModulemdModule *
-modulemd_module_index_get_module (ModulemdModuleIndex *self,
-                                  const gchar *module_name)
+
+static gboolean
+emit_delta_removal (yaml_emitter_t *emitter, GObject *object, GError **error)
 {
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), NULL);
+  ModulemdModuleStream *stream = NULL;
+  ModulemdObsoletes *obsoletes = NULL;
+  g_autofree gchar *modified = NULL;
 
-  return g_hash_table_lookup (self->modules, module_name);
+  EMIT_MAPPING_START (emitter, error);
+  EMIT_KEY_VALUE_STRING (
+    emitter, error, "module", get_object_module_name (object));
+
+  switch (get_object_doctype (object))
+    {
+    case MODULEMD_YAML_DOC_MODULESTREAM:
+      stream = MODULEMD_MODULE_STREAM (object);
+      EMIT_KEY_VALUE_STRING (emitter,
+                             error,
+                             "stream",
+                             modulemd_module_stream_get_stream_name (stream));
+      EMIT_KEY_VALUE_UINT64 (emitter,
+                             error,
+                             "version",
+                             modulemd_module_stream_get_version (stream));
+      EMIT_KEY_VALUE_STRING_IF_SET (
+        emitter,
+        error,
+        "context",
+        modulemd_module_stream_get_context (stream));
+      EMIT_KEY_VALUE_STRING_IF_SET (
+        emitter, error, "arch", modulemd_module_stream_get_arch (stream));
+      break;
+
+    case MODULEMD_YAML_DOC_OBSOLETES:
+      obsoletes = MODULEMD_OBSOLETES (object);
+      modified = modulemd_guint64_to_iso8601date (
+        modulemd_obsoletes_get_modified (obsoletes));
+      EMIT_KEY_VALUE_STRING (emitter,
+                             error,
+                             "stream",
+                             modulemd_obsoletes_get_module_stream (obsoletes));
+      EMIT_KEY_VALUE (emitter, error, "modified", modified);
+      EMIT_KEY_VALUE_STRING_IF_SET (
+        emitter,
+        error,
+        "context",
+        modulemd_obsoletes_get_module_context (obsoletes));
+      break;
+
+    case MODULEMD_YAML_DOC_TRANSLATIONS:
+      EMIT_KEY_VALUE_STRING (emitter,
+                             error,
+                             "stream",
+                             modulemd_translation_get_module_stream (
+                               MODULEMD_TRANSLATION (object)));
+      break;
+
+    default: break;
+    }
+
+  EMIT_MAPPING_END (emitter, error);
+  return TRUE;
 }
 
 
-GPtrArray *
-modulemd_module_index_search_streams (ModulemdModuleIndex *self,
-                                      const gchar *module_name,
-                                      const gchar *stream_name,
-                                      const gchar *version,
-                                      const gchar *context,
-                                      const gchar *arch)
+static GPtrArray *
+get_removed_objects (ModulemdModuleIndexDiff *diff,
+                     ModulemdYamlDocumentTypeEnum doctype)
 {
-  g_autoptr (GPtrArray) module_names = NULL;
-  g_autoptr (GPtrArray) module_streams = NULL;
-  const gchar *mname = NULL;
-  ModulemdModule *module = NULL;
+  switch (doctype)
+    {
+    case MODULEMD_YAML_DOC_MODULESTREAM:
+      return modulemd_module_index_diff_get_removed_streams (diff);
 
-  module_names =
-    modulemd_ordered_str_keys (self->modules, modulemd_strcmp_sort);
+    case MODULEMD_YAML_DOC_DEFAULTS:
+      return modulemd_module_index_diff_get_removed_defaults (diff);
 
-  module_streams = g_ptr_array_new ();
-  for (guint i = 0; i < module_names->len; i++)
+    case MODULEMD_YAML_DOC_TRANSLATIONS:
+      return modulemd_module_index_diff_get_removed_translations (diff);
+
+    case MODULEMD_YAML_DOC_OBSOLETES:
+      return modulemd_module_index_diff_get_removed_obsoletes (diff);
+
+    default: g_return_val_if_reached (NULL);
+    }
+}
+
+
+static gboolean
+emit_delta_header (yaml_emitter_t *emitter,
+                   const gchar *base,
+                   const gchar *result,
+                   ModulemdModuleIndexDiff *diff,
+                   GError **error)
+{
+  const delta_removal_kind *kind = NULL;
+  GPtrArray *removed = NULL;
+  gboolean have_removals = FALSE;
+
+  if (!modulemd_yaml_emit_document_headers (
+        emitter, MODULEMD_YAML_DOC_DELTA, MD_DELTA_VERSION_ONE, error))
     {
-      mname = g_ptr_array_index (module_names, i);
-      g_debug ("Searching through %s", mname);
+      return FALSE;
+    }
 
-      module = modulemd_module_index_get_module (self, mname);
-      if (!module)
+  EMIT_MAPPING_START (emitter, error);
+  EMIT_KEY_VALUE_STRING (emitter, error, "base", base);
+  EMIT_KEY_VALUE_STRING (emitter, error, "result", result);
+
+  for (guint i = 0; i < G_N_ELEMENTS (delta_removal_kinds); i++)
+    {
+      kind = &delta_removal_kinds[i];
+      removed = get_removed_objects (diff, kind->doctype);
+      if (removed->len == 0)
         {
-          /* Since we're iterating through keys we just retrieved, this should
-           * be impossible. If we get here, it must be a bug.
-           */
-          g_assert_not_reached ();
           continue;
         }
 
-      if (!modulemd_fnmatch (module_name,
-                             modulemd_module_get_module_name (module)))
+      if (!have_removals)
         {
-          g_debug ("%s did not match %s",
-                   modulemd_module_get_module_name (module),
-                   module_name);
-          continue;
+          EMIT_SCALAR (emitter, error, "remove");
+          EMIT_MAPPING_START (emitter, error);
+          have_removals = TRUE;
         }
 
-      g_ptr_array_extend_and_steal (
-        module_streams,
-        modulemd_module_search_streams_by_glob (
-          module, stream_name, version, context, arch));
+      EMIT_SCALAR (emitter, error, kind->section);
+      EMIT_SEQUENCE_START (emitter, error);
+      for (guint j = 0; j < removed->len; j++)
+        {
+          if (!emit_delta_removal (
+                emitter, g_ptr_array_index (removed, j), error))
+            {
+              return FALSE;
+            }
+        }
+      EMIT_SEQUENCE_END (emitter, error);
     }
 
-  g_debug ("Module stream count: %d", module_streams->len);
+  if (have_removals)
+    {
+      EMIT_MAPPING_END (emitter, error);
+    }
 
-  return g_steal_pointer (&module_streams);
+  /* Close the data: and the top-level mappings */
+  EMIT_MAPPING_END (emitter, error);
+  EMIT_MAPPING_END (emitter, error);
+
+  return mmd_emitter_end_document (emitter, error);
 }
 
 
-GPtrArray *
-modulemd_module_index_search_streams_by_nsvca_glob (ModulemdModuleIndex *self,
-                                                    const gchar *nsvca_pattern)
+/* The objects of a diff that a delta adds or replaces, in the order they are
+ * written: obsoletes and translations before the streams they apply to.
+ */
+static GPtrArray *(*const delta_upserts[]) (ModulemdModuleIndexDiff *) = {
+  modulemd_module_index_diff_get_added_defaults,
+  modulemd_module_index_diff_get_changed_defaults,
+  modulemd_module_index_diff_get_added_obsoletes,
+  modulemd_module_index_diff_get_changed_obsoletes,
+  modulemd_module_index_diff_get_added_translations,
+  modulemd_module_index_diff_get_changed_translations,
+  modulemd_module_index_diff_get_added_streams,
+  modulemd_module_index_diff_get_changed_streams,
+};
+
+
+gchar *
+modulemd_module_index_dump_delta_to_string (ModulemdModuleIndex *old_index,
+                                            ModulemdModuleIndex *new_index,
+                                            GError **error)
 {
-  g_autoptr (GPtrArray) module_names = NULL;
-  g_autoptr (GPtrArray) module_streams = NULL;
-  const gchar *mname = NULL;
-  ModulemdModule *module = NULL;
+  g_autoptr (ModulemdModuleIndexDiff) diff = NULL;
+  g_autofree gchar *base = NULL;
+  g_autofree gchar *result = NULL;
+  GPtrArray *objects = NULL;
 
-  module_names =
-    modulemd_ordered_str_keys (self->modules, modulemd_strcmp_sort);
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (old_index), NULL);
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (new_index), NULL);
 
-  module_streams = g_ptr_array_new ();
-  for (guint i = 0; i < module_names->len; i++)
+  MMD_INIT_YAML_EMITTER (emitter);
+  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+  MMD_INIT_YAML_WRITER (&emitter, writer);
+
+  diff = modulemd_module_index_diff (old_index, new_index, error);
+  if (!diff)
     {
-      mname = g_ptr_array_index (module_names, i);
-      g_debug ("Searching through %s", mname);
+      return NULL;
+    }
 
-      module = modulemd_module_index_get_module (self, mname);
-      if (!module)
+  base = modulemd_module_index_get_digest (old_index, error);
+  if (!base)
+    {
+      return NULL;
+    }
+
+  result = modulemd_module_index_get_digest (new_index, error);
+  if (!result)
+    {
+      return NULL;
+    }
+
+  if (!mmd_emitter_start_stream (&emitter, error))
+    {
+      return NULL;
+    }
+
+  if (!emit_delta_header (&emitter, base, result, diff, error))
+    {
+      return NULL;
+    }
+
+  for (guint i = 0; i < G_N_ELEMENTS (delta_upserts); i++)
+    {
+      objects = delta_upserts[i](diff);
+      for (guint j = 0; j < objects->len; j++)
         {
-          /* Since we're iterating through keys we just retrieved, this should
-           * be impossible. If we get here, it must be a bug.
-           */
-          g_assert_not_reached ();
-          continue;
+          if (!emit_object (g_ptr_array_index (objects, j), &emitter, error))
+            {
+              return NULL;
+            }
         }
-
-      g_ptr_array_extend_and_steal (
-        module_streams,
-        modulemd_module_search_streams_by_nsvca_glob (module, nsvca_pattern));
     }
 
-  g_debug ("Module stream count: %d", module_streams->len);
+  if (!mmd_emitter_end_stream (&emitter, error))
+    {
+      return NULL;
+    }
 
-  return g_steal_pointer (&module_streams);
+  return g_steal_pointer (&yaml_string->str);
 }
 
 
-GPtrArray *
-modulemd_module_index_search_rpms (ModulemdModuleIndex *self,
-                                   const gchar *nevra_pattern)
+static gboolean
+parse_delta_removal (yaml_parser_t *parser,
+                     const delta_removal_kind *kind,
+                     GPtrArray *removals,
+                     GError **error)
 {
-  g_autoptr (GPtrArray) module_names = NULL;
-  g_autoptr (GPtrArray) found_streams = NULL;
-  GPtrArray *module_streams = NULL;
-  const gchar *mname = NULL;
-  ModulemdModule *module = NULL;
-  ModulemdModuleStream *stream = NULL;
+  MMD_INIT_YAML_EVENT (event);
+  g_autoptr (GError) nested_error = NULL;
+  g_autoptr (GHashTable) fields = NULL;
+  g_autofree gchar *number = NULL;
+  index_delta_removal *removal = NULL;
+  const gchar *field = NULL;
+  gchar *value = NULL;
+  gboolean done = FALSE;
+  guint64 parsed;
 
-  module_names =
-    modulemd_ordered_str_keys (self->modules, modulemd_strcmp_sort);
+  fields = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-  found_streams = g_ptr_array_new ();
-  for (guint i = 0; i < module_names->len; i++)
+  while (!done)
     {
-      mname = g_ptr_array_index (module_names, i);
-      g_debug ("Searching through %s", mname);
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
 
-      module = modulemd_module_index_get_module (self, mname);
-      if (!module)
+      switch (event.type)
         {
-          /* Since we're iterating through keys we just retrieved, this should
-           * be impossible. If we get here, it must be a bug.
-           */
-          g_assert_not_reached ();
-          continue;
-        }
+        case YAML_MAPPING_END_EVENT: done = TRUE; break;
 
-      module_streams = modulemd_module_get_all_streams (module);
-      for (guint j = 0; j < module_streams->len; j++)
-        {
-          stream = g_ptr_array_index (module_streams, j);
-          if (modulemd_module_stream_includes_nevra (stream, nevra_pattern))
+        case YAML_SCALAR_EVENT:
+          field = (const gchar *)event.data.scalar.value;
+          if (!g_strv_contains (kind->fields, field))
             {
-              g_ptr_array_add (found_streams, stream);
+              MMD_YAML_ERROR_EVENT_EXIT_BOOL (error,
+                                              event,
+                                              "Unknown key in %s removal: %s",
+                                              kind->section,
+                                              field);
+            }
+
+          if (g_hash_table_contains (fields, field))
+            {
+              MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+                error, event, "Key %s encountered twice", field);
+            }
+
+          value = modulemd_yaml_parse_string (parser, &nested_error);
+          if (!value)
+            {
+              MMD_YAML_ERROR_EVENT_EXIT_BOOL (error,
+                                              event,
+                                              "Failed to parse %s in %s "
+                                              "removal: %s",
+                                              field,
+                                              kind->section,
+                                              nested_error->message);
             }
+          g_hash_table_replace (fields, g_strdup (field), value);
+          break;
+
+        default:
+          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+            error,
+            event,
+            "Unexpected YAML event in %s removal",
+            kind->section);
+          break;
         }
-    }
 
-  g_debug ("Module stream count: %d", found_streams->len);
+      yaml_event_delete (&event);
+    }
 
-  return g_steal_pointer (&found_streams);
-}
+  for (guint i = 0; i < kind->n_required; i++)
+    {
+      if (!g_hash_table_contains (fields, kind->fields[i]))
+        {
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_MISSING_REQUIRED,
+                       "Entry in %s removals is missing %s",
+                       kind->section,
+                       kind->fields[i]);
+          return FALSE;
+        }
+    }
 
+  /* Numbers are compared in their canonical form */
+  if (kind->doctype == MODULEMD_YAML_DOC_MODULESTREAM)
+    {
+      if (!g_ascii_string_to_unsigned (g_hash_table_lookup (fields, "version"),
+                                       10,
+                                       0,
+                                       G_MAXUINT64,
+                                       &parsed,
+                                       &nested_error))
+        {
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_PARSE,
+                       "Invalid version in streams removal: %s",
+                       nested_error->message);
+          return FALSE;
+        }
+      number = g_strdup_printf ("%" PRIu64, parsed);
+    }
+  else if (kind->doctype == MODULEMD_YAML_DOC_OBSOLETES)
+    {
+      parsed = modulemd_iso8601date_to_guint64 (
+        g_hash_table_lookup (fields, "modified"));
+      if (parsed == 0)
+        {
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_PARSE,
+                       "Invalid modified date in obsoletes removal: %s",
+                       (gchar *)g_hash_table_lookup (fields, "modified"));
+          return FALSE;
+        }
+      number = g_strdup_printf ("%" PRIu64, parsed);
+    }
 
-gboolean
-modulemd_module_index_remove_module (ModulemdModuleIndex *self,
-                                     const gchar *module_name)
-{
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  removal = g_new0 (index_delta_removal, 1);
+  removal->module_name = g_strdup (g_hash_table_lookup (fields, "module"));
+  removal->key = make_object_key (
+    kind->doctype,
+    removal->module_name,
+    g_hash_table_lookup (fields, "stream"),
+    kind->doctype == MODULEMD_YAML_DOC_MODULESTREAM ? number : NULL,
+    g_hash_table_lookup (fields, "context"),
+    kind->doctype == MODULEMD_YAML_DOC_MODULESTREAM ?
+      g_hash_table_lookup (fields, "arch") :
+      number);
+  g_ptr_array_add (removals, removal);
 
-  return g_hash_table_remove (self->modules, module_name);
+  return TRUE;
 }
 
 
-gboolean
-modulemd_module_index_add_module_stream (ModulemdModuleIndex *self,
-                                         ModulemdModuleStream *stream,
-                                         GError **error)
+static gboolean
+parse_delta_removal_list (yaml_parser_t *parser,
+                          const delta_removal_kind *kind,
+                          GPtrArray *removals,
+                          GError **error)
 {
-  g_autoptr (GError) nested_error = NULL;
-  ModulemdModuleStreamVersionEnum mdversion = MD_MODULESTREAM_VERSION_UNSET;
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  MMD_INIT_YAML_EVENT (event);
+  gboolean done = FALSE;
 
-  if (!modulemd_module_stream_get_module_name (stream) ||
-      !modulemd_module_stream_get_stream_name (stream))
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_SEQUENCE_START_EVENT)
     {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_MISSING_REQUIRED,
-                   "The module and stream names are required when adding to "
-                   "ModuleIndex.");
-      return FALSE;
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "Missing sequence of %s removals", kind->section);
     }
+  yaml_event_delete (&event);
 
-  mdversion = modulemd_module_add_stream (
-    get_or_create_module (self,
-                          modulemd_module_stream_get_module_name (stream)),
-    stream,
-    self->stream_mdversion,
-    &nested_error);
-
-  if (mdversion == MD_MODULESTREAM_VERSION_ERROR)
+  while (!done)
     {
-      g_propagate_error (error, g_steal_pointer (&nested_error));
-      return FALSE;
-    }
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
 
-  if (mdversion > self->stream_mdversion)
-    {
-      /* Upgrade any streams we've already seen to this version */
-      g_debug ("Upgrading all streams to version %i", mdversion);
-      if (!modulemd_module_index_upgrade_streams (
-            self, mdversion, &nested_error))
+      switch (event.type)
         {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
-          return FALSE;
+        case YAML_SEQUENCE_END_EVENT: done = TRUE; break;
+
+        case YAML_MAPPING_START_EVENT:
+          if (!parse_delta_removal (parser, kind, removals, error))
+            {
+              return FALSE;
+            }
+          break;
+
+        default:
+          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+            error,
+            event,
+            "Unexpected YAML event in %s removals",
+            kind->section);
+          break;
         }
+
+      yaml_event_delete (&event);
     }
 
   return TRUE;
 }
 
 
-gboolean
-modulemd_module_index_upgrade_streams (
-  ModulemdModuleIndex *self,
-  ModulemdModuleStreamVersionEnum mdversion,
-  GError **error)
+static gboolean
+parse_delta_removals (yaml_parser_t *parser,
+                      GPtrArray *removals,
+                      GError **error)
 {
-  GHashTableIter iter;
-  gpointer key;
-  gpointer value;
-  g_autoptr (ModulemdModule) module = NULL;
-  g_autoptr (GError) nested_error = NULL;
+  MMD_INIT_YAML_EVENT (event);
+  const delta_removal_kind *kind = NULL;
+  gboolean done = FALSE;
 
-  if (mdversion < self->stream_mdversion)
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (event.type != YAML_MAPPING_START_EVENT)
     {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_UPGRADE,
-                   "Downgrades not permitted. mdversion %i < current %i",
-                   mdversion,
-                   self->stream_mdversion);
-      return FALSE;
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "Missing mapping in delta removals");
     }
+  yaml_event_delete (&event);
 
-  g_hash_table_iter_init (&iter, self->modules);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  while (!done)
     {
-      module = g_object_ref (MODULEMD_MODULE (value));
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
 
-      /* Skip any module without streams */
-      if (modulemd_module_get_all_streams (module)->len == 0)
+      switch (event.type)
         {
-          g_clear_object (&module);
-          continue;
-        }
+        case YAML_MAPPING_END_EVENT: done = TRUE; break;
 
-      if (!modulemd_module_upgrade_streams (module, mdversion, &nested_error))
-        {
-          g_propagate_prefixed_error (
-            error,
-            g_steal_pointer (&nested_error),
-            "Error upgrading streams for module %s",
-            modulemd_module_get_module_name (module));
-          return FALSE;
+        case YAML_SCALAR_EVENT:
+          kind = NULL;
+          for (guint i = 0; i < G_N_ELEMENTS (delta_removal_kinds); i++)
+            {
+              if (g_str_equal ((const gchar *)event.data.scalar.value,
+                               delta_removal_kinds[i].section))
+                {
+                  kind = &delta_removal_kinds[i];
+                }
+            }
+
+          if (!kind)
+            {
+              MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+                error,
+                event,
+                "Unknown key in delta removals: %s",
+                (const gchar *)event.data.scalar.value);
+            }
+
+          if (!parse_delta_removal_list (parser, kind, removals, error))
+            {
+              return FALSE;
+            }
+          break;
+
+        default:
+          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+            error, event, "Unexpected YAML event in delta removals");
+          break;
         }
 
-      g_clear_object (&module);
+      yaml_event_delete (&event);
     }
 
-  self->stream_mdversion = mdversion;
-
   return TRUE;
 }
 
 
-gboolean
-modulemd_module_index_add_defaults (ModulemdModuleIndex *self,
-                                    ModulemdDefaults *defaults,
-                                    GError **error)
+static gboolean
+parse_delta_header (ModulemdSubdocumentInfo *subdoc,
+                    index_delta *delta,
+                    GError **error)
 {
+  MMD_INIT_YAML_PARSER (parser);
+  MMD_INIT_YAML_EVENT (event);
   g_autoptr (GError) nested_error = NULL;
-  ModulemdDefaultsVersionEnum mdversion = MD_DEFAULTS_VERSION_UNSET;
+  guint8 digest[MMD_DIGEST_LENGTH];
+  gchar **target = NULL;
+  gboolean done = FALSE;
 
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  if (modulemd_subdocument_info_get_mdversion (subdoc) !=
+      MD_DELTA_VERSION_ONE)
+    {
+      g_set_error (error,
+                   MODULEMD_YAML_ERROR,
+                   MMD_YAML_ERROR_PARSE,
+                   "Unsupported modulemd-delta version %" PRIu64,
+                   modulemd_subdocument_info_get_mdversion (subdoc));
+      return FALSE;
+    }
 
-  mdversion = modulemd_module_set_defaults (
-    get_or_create_module (self, modulemd_defaults_get_module_name (defaults)),
-    defaults,
-    self->defaults_mdversion,
-    &nested_error);
-  if (mdversion == MD_DEFAULTS_VERSION_ERROR)
+  if (!modulemd_subdocument_info_get_data_parser (
+        subdoc, &parser, TRUE, error))
     {
-      g_propagate_error (error, g_steal_pointer (&nested_error));
       return FALSE;
     }
 
-  if (mdversion > self->defaults_mdversion)
+  YAML_PARSER_PARSE_WITH_EXIT_BOOL (&parser, &event, error);
+  if (event.type != YAML_MAPPING_START_EVENT)
     {
-      /* Upgrade any defaults we've already seen to this version */
-      g_debug ("Upgrading all defaults to version %i", mdversion);
-      if (!modulemd_module_index_upgrade_defaults (
-            self, mdversion, &nested_error))
-        {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
-          return FALSE;
-        }
+      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+        error, event, "Missing mapping in modulemd-delta data");
     }
+  yaml_event_delete (&event);
 
-  return TRUE;
-}
+  while (!done)
+    {
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (&parser, &event, error);
 
+      switch (event.type)
+        {
+        case YAML_MAPPING_END_EVENT: done = TRUE; break;
 
-gboolean
-modulemd_module_index_add_obsoletes (ModulemdModuleIndex *self,
-                                     ModulemdObsoletes *obsoletes,
-                                     GError **error)
-{
-  g_autoptr (GError) nested_error = NULL;
+        case YAML_SCALAR_EVENT:
+          if (g_str_equal ((const gchar *)event.data.scalar.value, "remove"))
+            {
+              if (!parse_delta_removals (&parser, delta->removals, error))
+                {
+                  return FALSE;
+                }
+              break;
+            }
 
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
-  g_return_val_if_fail (MODULEMD_IS_OBSOLETES (obsoletes), FALSE);
+          if (g_str_equal ((const gchar *)event.data.scalar.value, "base"))
+            {
+              target = &delta->base;
+            }
+          else if (g_str_equal ((const gchar *)event.data.scalar.value,
+                                "result"))
+            {
+              target = &delta->result;
+            }
+          else
+            {
+              MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+                error,
+                event,
+                "Unknown key in modulemd-delta data: %s",
+                (const gchar *)event.data.scalar.value);
+            }
 
-  if (!modulemd_obsoletes_get_module_name (obsoletes))
-    {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_MISSING_REQUIRED,
-                   "The obsoletes requries a module name when adding to "
-                   "ModuleIndex.");
-      return FALSE;
-    }
+          if (*target)
+            {
+              MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+                error,
+                event,
+                "Key %s encountered twice",
+                (const gchar *)event.data.scalar.value);
+            }
 
-  modulemd_module_add_obsoletes (
-    get_or_create_module (self,
-                          modulemd_obsoletes_get_module_name (obsoletes)),
-    obsoletes);
+          *target = modulemd_yaml_parse_string (&parser, &nested_error);
+          if (!*target || !digest_from_hex (*target, digest))
+            {
+              MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+                error,
+                event,
+                "Invalid %s digest in modulemd-delta data",
+                (const gchar *)event.data.scalar.value);
+            }
+          break;
 
-  /* Obsoletes need at least MD_MODULESTREAM_VERSION_TWO */
-  if (self->stream_mdversion < MD_MODULESTREAM_VERSION_TWO)
-    {
-      if (!modulemd_module_index_upgrade_streams (
-            self, MD_MODULESTREAM_VERSION_TWO, &nested_error))
-        {
-          g_propagate_error (error, g_steal_pointer (&nested_error));
-          return FALSE;
+        default:
+          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+            error, event, "Unexpected YAML event in modulemd-delta data");
+          break;
         }
+
+      yaml_event_delete (&event);
+    }
+
+  if (!delta->base || !delta->result)
+    {
+      g_set_error_literal (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_MISSING_REQUIRED,
+                           "The modulemd-delta document must specify both "
+                           "the base and the result digest");
+      return FALSE;
     }
 
   return TRUE;
 }
 
 
-GHashTable *
-modulemd_module_index_get_default_streams_as_hash_table (
-  ModulemdModuleIndex *self, const gchar *intent)
+static index_delta *
+parse_delta (const gchar *yaml_string, GError **error)
 {
-  GHashTable *defaults = NULL;
-  GHashTableIter iter;
-  gpointer key;
-  gpointer value;
-  ModulemdDefaults *defs = NULL;
-  const gchar *def_stream_name = NULL;
+  MMD_INIT_YAML_PARSER (parser);
+  MMD_INIT_YAML_EVENT (event);
+  g_autoptr (index_delta) delta = NULL;
+  g_autoptr (ModulemdSubdocumentInfo) subdoc = NULL;
+  g_autoptr (GObject) object = NULL;
+  gboolean done = FALSE;
 
-  defaults = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  delta = index_delta_new ();
 
-  g_hash_table_iter_init (&iter, self->modules);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  yaml_parser_set_input_string (
+    &parser, (const unsigned char *)yaml_string, strlen (yaml_string));
+
+  YAML_PARSER_PARSE_WITH_EXIT (&parser, &event, error);
+  if (event.type != YAML_STREAM_START_EVENT)
+    {
+      MMD_YAML_ERROR_EVENT_EXIT (
+        error, event, "Did not encounter stream start");
+    }
+  yaml_event_delete (&event);
+
+  while (!done)
     {
-      defs = modulemd_module_get_defaults (MODULEMD_MODULE (value));
-      if (defs)
+      YAML_PARSER_PARSE_WITH_EXIT (&parser, &event, error);
+
+      switch (event.type)
         {
-          switch (modulemd_defaults_get_mdversion (defs))
+        case YAML_DOCUMENT_START_EVENT:
+          subdoc = modulemd_yaml_parse_document_type (&parser);
+          if (modulemd_subdocument_info_get_gerror (subdoc) != NULL)
+            {
+              g_propagate_error (
+                error,
+                g_error_copy (modulemd_subdocument_info_get_gerror (subdoc)));
+              return NULL;
+            }
+
+          if (modulemd_subdocument_info_get_doctype (subdoc) ==
+              MODULEMD_YAML_DOC_DELTA)
             {
-            case MD_DEFAULTS_VERSION_ONE:
-              def_stream_name = modulemd_defaults_v1_get_default_stream (
-                MODULEMD_DEFAULTS_V1 (defs), intent);
-              if (def_stream_name)
+              if (delta->base)
                 {
-                  /* This module has a default stream. Add it to the table */
-                  g_hash_table_replace (
-                    defaults, g_strdup (key), g_strdup (def_stream_name));
+                  g_set_error_literal (error,
+                                       MODULEMD_YAML_ERROR,
+                                       MMD_YAML_ERROR_PARSE,
+                                       "A delta can only contain one "
+                                       "modulemd-delta document");
+                  return NULL;
                 }
-              break;
 
-            default:
-              /* This should be impossible and suggests that we somehow added
-               * a corrupt defaults object. We will ignore it and continue to
-               * return valid entries.
-               */
-              g_warning ("Encountered an unknown defaults mdversion: %" PRIu64,
-                         modulemd_defaults_get_mdversion (defs));
-              break;
+              if (!parse_delta_header (subdoc, delta, error))
+                {
+                  return NULL;
+                }
+            }
+          else if (!delta->base)
+            {
+              g_set_error_literal (error,
+                                   MODULEMD_YAML_ERROR,
+                                   MMD_YAML_ERROR_PARSE,
+                                   "A delta must start with a modulemd-delta "
+                                   "document");
+              return NULL;
+            }
+          else
+            {
+              object =
+                modulemd_document_reader_parse_subdoc (subdoc, TRUE, 0, error);
+              if (!object)
+                {
+                  return NULL;
+                }
+              g_ptr_array_add (delta->objects, g_steal_pointer (&object));
             }
+
+          g_clear_object (&subdoc);
+          break;
+
+        case YAML_STREAM_END_EVENT: done = TRUE; break;
+
+        default:
+          MMD_YAML_ERROR_EVENT_EXIT (
+            error, event, "Unexpected YAML event in document stream");
+          break;
         }
+
+      yaml_event_delete (&event);
     }
 
-  return defaults;
+  if (!delta->base)
+    {
+      g_set_error_literal (error,
+                           MODULEMD_YAML_ERROR,
+                           MMD_YAML_ERROR_MISSING_REQUIRED,
+                           "No modulemd-delta document found");
+      return NULL;
+    }
+
+  return g_steal_pointer (&delta);
 }
 
 
-gboolean
-modulemd_module_index_upgrade_defaults (ModulemdModuleIndex *self,
-                                        ModulemdDefaultsVersionEnum mdversion,
-                                        GError **error)
+static gboolean
+add_delta_object (ModulemdModule *module,
+                  GObject *object,
+                  ModulemdModuleStreamVersionEnum stream_mdversion,
+                  ModulemdDefaultsVersionEnum defaults_mdversion,
+                  GError **error)
 {
-  GHashTableIter iter;
-  gpointer key;
-  gpointer value;
-  g_autoptr (ModulemdModule) module = NULL;
-  g_autoptr (ModulemdDefaults) defaults = NULL;
-  g_autoptr (GError) nested_error = NULL;
-
-  if (mdversion < self->defaults_mdversion)
+  switch (get_object_doctype (object))
     {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_UPGRADE,
-                   "Downgrades not permitted. mdversion %i < current %i",
-                   mdversion,
-                   self->defaults_mdversion);
-      return FALSE;
+    case MODULEMD_YAML_DOC_MODULESTREAM:
+      return modulemd_module_add_stream (module,
+                                         MODULEMD_MODULE_STREAM (object),
+                                         stream_mdversion,
+                                         error) !=
+             MD_MODULESTREAM_VERSION_ERROR;
+
+    case MODULEMD_YAML_DOC_DEFAULTS:
+      return modulemd_module_set_defaults (module,
+                                           MODULEMD_DEFAULTS (object),
+                                           defaults_mdversion,
+                                           error) != MD_DEFAULTS_VERSION_ERROR;
+
+    case MODULEMD_YAML_DOC_TRANSLATIONS:
+      modulemd_module_add_translation (module, MODULEMD_TRANSLATION (object));
+      return TRUE;
+
+    case MODULEMD_YAML_DOC_OBSOLETES:
+      modulemd_module_add_obsoletes (module, MODULEMD_OBSOLETES (object));
+      return TRUE;
+
+    default: g_return_val_if_reached (FALSE);
     }
+}
 
-  if (mdversion > MD_DEFAULTS_VERSION_LATEST)
+
+/*
+ * build_delta_module:
+ * @self: (in): This #ModulemdModuleIndex object.
+ * @module_name: (in): The name of a module that the delta changes.
+ * @module_updates: (in): The objects that the delta adds to or replaces in
+ * @module_name.
+ * @removals: (inout): The removals of the delta that have not been matched
+ * yet, keyed by object key. Matched removals are dropped from it.
+ * @update_keys: (in): The object keys of all objects that the delta adds or
+ * replaces.
+ * @stream_mdversion: (in): The stream mdversion of the index after applying.
+ * @defaults_mdversion: (in): The defaults mdversion of the index after
+ * applying.
+ * @old_objects: (inout): The objects of @self that are removed or replaced
+ * are appended to this array.
+ * @new_objects: (inout): The objects that are added or replace others are
+ * appended to this array, as stored in the new module.
+ * @error: (out): A #GError containing the reason the module could not be
+ * built.
+ *
+ * Builds the replacement for @module_name without modifying @self. The
+ * streams that are kept are copies, since adding a stream to a module
+ * associates it with the obsoletes and translations of that module.
+ *
+ * Returns: (transfer full): The new #ModulemdModule.
+ */
+static ModulemdModule *
+build_delta_module (ModulemdModuleIndex *self,
+                    const gchar *module_name,
+                    GPtrArray *module_updates,
+                    GHashTable *removals,
+                    GHashTable *update_keys,
+                    ModulemdModuleStreamVersionEnum stream_mdversion,
+                    ModulemdDefaultsVersionEnum defaults_mdversion,
+                    GPtrArray *old_objects,
+                    GPtrArray *new_objects,
+                    GError **error)
+{
+  static const ModulemdYamlDocumentTypeEnum order[] = {
+    MODULEMD_YAML_DOC_DEFAULTS,
+    MODULEMD_YAML_DOC_OBSOLETES,
+    MODULEMD_YAML_DOC_TRANSLATIONS,
+    MODULEMD_YAML_DOC_MODULESTREAM,
+  };
+  ModulemdModule *old_module = NULL;
+  g_autoptr (ModulemdModule) new_module = NULL;
+  g_autoptr (GPtrArray) current = NULL;
+  g_autoptr (GPtrArray) objects = NULL;
+  GObject *object = NULL;
+
+  new_module = modulemd_module_new (module_name);
+  current = g_ptr_array_new ();
+  objects = g_ptr_array_new_with_free_func (g_object_unref);
+
+  old_module = g_hash_table_lookup (self->modules, module_name);
+  if (old_module)
     {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_UPGRADE,
-                   "Unknown Defaults metadata version %i",
-                   mdversion);
-      return FALSE;
+      collect_module_objects (old_module, current);
     }
 
-  g_hash_table_iter_init (&iter, self->modules);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  for (guint i = 0; i < current->len; i++)
     {
-      module = g_object_ref (MODULEMD_MODULE (value));
-      defaults = modulemd_module_get_defaults (module);
+      g_autofree gchar *key = NULL;
 
-      /* Skip any module without defaults */
-      if (!defaults)
+      object = g_ptr_array_index (current, i);
+      key = get_object_key (object);
+
+      if (g_hash_table_remove (removals, key) ||
+          g_hash_table_contains (update_keys, key))
         {
-          g_clear_object (&module);
-          continue;
+          g_ptr_array_add (old_objects, object);
         }
-
-      g_object_ref (defaults);
-
-      if (mdversion != modulemd_module_set_defaults (
-                         module, defaults, mdversion, &nested_error))
+      else if (MODULEMD_IS_MODULE_STREAM (object))
         {
-          g_propagate_prefixed_error (
-            error,
-            g_steal_pointer (&nested_error),
-            "Error upgrading previously-added defaults: ");
-          return FALSE;
+          g_ptr_array_add (objects,
+                           modulemd_module_stream_copy (
+                             MODULEMD_MODULE_STREAM (object), NULL, NULL));
+        }
+      else
+        {
+          g_ptr_array_add (objects, g_object_ref (object));
         }
-      g_clear_object (&defaults);
-      g_clear_object (&module);
     }
 
-  self->defaults_mdversion = mdversion;
-
-  return TRUE;
-}
-
-
-gboolean
-modulemd_module_index_add_translation (ModulemdModuleIndex *self,
-                                       ModulemdTranslation *translation,
-                                       GError **error)
-{
-  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
-  g_return_val_if_fail (MODULEMD_IS_TRANSLATION (translation), FALSE);
+  for (guint i = 0; i < module_updates->len; i++)
+    {
+      g_ptr_array_add (objects,
+                       g_object_ref (g_ptr_array_index (module_updates, i)));
+    }
 
-  if (!modulemd_translation_get_module_name (translation))
+  /* Obsoletes and translations have to be in place before the streams they
+   * are associated with are added.
+   */
+  for (guint i = 0; i < G_N_ELEMENTS (order); i++)
     {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_MISSING_REQUIRED,
-                   "The translation requries a module name when adding to "
-                   "ModuleIndex.");
-      return FALSE;
+      for (guint j = 0; j < objects->len; j++)
+        {
+          object = g_ptr_array_index (objects, j);
+          if (get_object_doctype (object) == order[i] &&
+              !add_delta_object (new_module,
+                                 object,
+                                 stream_mdversion,
+                                 defaults_mdversion,
+                                 error))
+            {
+              return NULL;
+            }
+        }
     }
 
-  if (!modulemd_translation_get_module_stream (translation))
+  g_ptr_array_set_size (current, 0);
+  collect_module_objects (new_module, current);
+  for (guint i = 0; i < current->len; i++)
     {
-      g_set_error (error,
-                   MODULEMD_ERROR,
-                   MMD_ERROR_MISSING_REQUIRED,
-                   "The translation requries a module stream when adding to "
-                   "ModuleIndex.");
-      return FALSE;
+      g_autofree gchar *key = get_object_key (g_ptr_array_index (current, i));
+
+      if (g_hash_table_contains (update_keys, key))
+        {
+          g_ptr_array_add (new_objects, g_ptr_array_index (current, i));
+        }
     }
 
-  modulemd_module_add_translation (
-    get_or_create_module (self,
-                          modulemd_translation_get_module_name (translation)),
-    translation);
-  return TRUE;
+  return g_steal_pointer (&new_module);
 }
 
 
-static void
-clear_xmds (gpointer key, gpointer value, gpointer user_data)
+static gboolean
+module_is_empty (ModulemdModule *module)
 {
-  MODULEMD_INIT_TRACE ();
+  g_autoptr (GPtrArray) translated = NULL;
 
-  g_return_if_fail (MODULEMD_IS_MODULE (value));
+  translated = modulemd_module_get_translated_streams (module);
 
-  modulemd_module_clear_xmds (MODULEMD_MODULE (value));
+  return modulemd_module_get_defaults (module) == NULL &&
+         modulemd_module_get_obsoletes (module)->len == 0 &&
+         modulemd_module_get_all_streams (module)->len == 0 &&
+         translated->len == 0;
 }
 
 
-void
-modulemd_module_index_clear_xmds (ModulemdModuleIndex *self)
+static GPtrArray *
+get_module_updates (GHashTable *updates, const gchar *module_name)
 {
-  MODULEMD_INIT_TRACE ();
+  GPtrArray *module_updates = g_hash_table_lookup (updates, module_name);
 
-  g_hash_table_foreach (self->modules, clear_xmds, NULL);
+  if (!module_updates)
+    {
+      module_updates = g_ptr_array_new ();
+      g_hash_table_insert (updates, (gpointer)module_name, module_updates);
+    }
+
+  return module_updates;
 }
 
 
 gboolean
-modulemd_module_index_merge (ModulemdModuleIndex *from,
-                             ModulemdModuleIndex *into,
-                             gboolean override,
-                             gboolean strict_default_streams,
-                             GError **error)
+modulemd_module_index_apply_delta (ModulemdModuleIndex *self,
+                                   const gchar *yaml_string,
+                                   GError **error)
 {
-  MODULEMD_INIT_TRACE ();
+  g_autoptr (index_delta) delta = NULL;
+  g_autofree gchar *base = NULL;
+  g_autofree gchar *result = NULL;
+  g_autoptr (GHashTable) removals = NULL;
+  g_autoptr (GHashTable) update_keys = NULL;
+  g_autoptr (GHashTable) updates = NULL;
+  g_autoptr (GHashTable) new_modules = NULL;
+  g_autoptr (GPtrArray) old_objects = NULL;
+  g_autoptr (GPtrArray) new_objects = NULL;
+  ModulemdModuleStreamVersionEnum stream_mdversion;
+  ModulemdDefaultsVersionEnum defaults_mdversion;
+  index_delta_removal *removal = NULL;
+  ModulemdModule *module = NULL;
+  GObject *object = NULL;
+  guint8 digest[MMD_DIGEST_LENGTH];
   GHashTableIter iter;
   gpointer key;
   gpointer value;
-  const gchar *module_name = NULL;
-  const gchar *trans_stream = NULL;
-  ModulemdModule *module = NULL;
-  ModulemdModule *into_module = NULL;
-  GPtrArray *streams = NULL;
-  ModulemdModuleStream *stream = NULL;
-  g_autoptr (GPtrArray) translations = NULL;
-  ModulemdTranslation *translation = NULL;
-  ModulemdTranslation *current_translation = NULL;
-  ModulemdObsoletes *obsoletes = NULL;
-  ModulemdDefaults *defaults = NULL;
-  ModulemdDefaults *into_defaults = NULL;
-  g_autoptr (ModulemdDefaults) merged_defaults = NULL;
-  g_autoptr (GError) nested_error = NULL;
-  guint i;
-  g_autoptr (GPtrArray) translated_stream_names = NULL;
-  GPtrArray *obsoletes_array = NULL;
-  gchar *translated_stream_name = NULL;
-  g_autofree gchar *nsvca = NULL;
 
+  g_return_val_if_fail (MODULEMD_IS_MODULE_INDEX (self), FALSE);
+  g_return_val_if_fail (yaml_string, FALSE);
 
-  /* Loop through each module in the Index */
-  g_hash_table_iter_init (&iter, from->modules);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  if (!check_not_frozen (self, error))
     {
-      module_name = (const gchar *)key;
-      g_debug ("Merging module %s", module_name);
+      return FALSE;
+    }
 
-      module = MODULEMD_MODULE (value);
-      into_module = get_or_create_module (into, module_name);
+  delta = parse_delta (yaml_string, error);
+  if (!delta)
+    {
+      return FALSE;
+    }
 
-      /* Copy all module streams for this module
-       * The module streams have "version" and "context" to disambiguate them,
-       * so we have documented that if there are two modules with differing
-       * content and the same NSVC, the operation is undefined.
-       * As such, we'll just assume it's safe to add every stream. If there are
-       * duplicates, they'll be deduplicated by replacing the previously-
-       * existing entry.
-       */
-      g_debug ("Prioritizer: merging streams for %s", module_name);
-      streams = modulemd_module_get_all_streams (module);
-      for (i = 0; i < streams->len; i++)
-        {
-          stream = g_ptr_array_index (streams, i);
-          nsvca = modulemd_module_stream_get_NSVCA_as_string (stream);
+  base = modulemd_module_index_get_digest (self, error);
+  if (!base)
+    {
+      return FALSE;
+    }
 
-          if (!modulemd_module_index_add_module_stream (
-                into, stream, &nested_error))
-            {
-              if (nested_error)
-                {
-                  g_info ("Could not add stream %s due to %s",
-                          nsvca,
-                          nested_error->message);
-                  g_clear_error (&nested_error);
-                }
-              else
-                {
-                  g_info ("Could not add stream %s", nsvca);
-                }
-            }
-          g_clear_pointer (&nsvca, g_free);
-        }
+  if (!g_str_equal (base, delta->base))
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_VALIDATE,
+                   "The delta applies to an index with digest %s, but this "
+                   "index has digest %s",
+                   delta->base,
+                   base);
+      return FALSE;
+    }
 
+  /* Index the delta by object key and group it by module */
+  stream_mdversion = self->stream_mdversion;
+  defaults_mdversion = self->defaults_mdversion;
+  removals = g_hash_table_new (g_str_hash, g_str_equal);
+  update_keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  updates = g_hash_table_new_full (
+    g_str_hash, g_str_equal, NULL, (GDestroyNotify)g_ptr_array_unref);
 
-      /* Merge any defaults entry for this module */
-      g_debug ("Prioritizer: merging defaults for %s", module_name);
-      defaults = modulemd_module_get_defaults (module);
-      into_defaults = modulemd_module_get_defaults (into_module);
-      if (override && defaults)
+  for (guint i = 0; i < delta->removals->len; i++)
+    {
+      removal = g_ptr_array_index (delta->removals, i);
+      if (!g_hash_table_insert (removals, removal->key, removal))
         {
-          /* If we've been told to override (we're at a higher priority level),
-           * then just replace the current defaults with the new one
-           */
-          if (!modulemd_module_index_add_defaults (
-                into, defaults, &nested_error))
-            {
-              g_propagate_error (error, g_steal_pointer (&nested_error));
-              return FALSE;
-            }
+          g_set_error (error,
+                       MODULEMD_ERROR,
+                       MMD_ERROR_VALIDATE,
+                       "The delta removes an object of module %s twice",
+                       removal->module_name);
+          return FALSE;
         }
-      else if (!defaults)
+      get_module_updates (updates, removal->module_name);
+    }
+
+  for (guint i = 0; i < delta->objects->len; i++)
+    {
+      g_autofree gchar *object_key = NULL;
+
+      object = g_ptr_array_index (delta->objects, i);
+      object_key = get_object_key (object);
+      if (g_hash_table_contains (removals, object_key) ||
+          g_hash_table_contains (update_keys, object_key))
         {
-          /* No defaults to merge in right now, just continue */
+          g_set_error (error,
+                       MODULEMD_ERROR,
+                       MMD_ERROR_VALIDATE,
+                       "The delta changes the same %s of module %s twice",
+                       modulemd_yaml_get_doctype_string (
+                         get_object_doctype (object), 1),
+                       get_object_module_name (object));
+          return FALSE;
         }
-      else if (defaults && !into_defaults)
+      g_hash_table_add (update_keys, g_steal_pointer (&object_key));
+
+      if (MODULEMD_IS_MODULE_STREAM (object))
         {
-          /* There are no defaults on the target module yet. Copy these */
-          if (!modulemd_module_index_add_defaults (
-                into, defaults, &nested_error))
-            {
-              g_propagate_error (error, g_steal_pointer (&nested_error));
-              return FALSE;
-            }
+          stream_mdversion =
+            MAX (stream_mdversion,
+                 modulemd_module_stream_get_mdversion (
+                   MODULEMD_MODULE_STREAM (object)));
         }
-      else
+      else if (MODULEMD_IS_DEFAULTS (object))
         {
-          merged_defaults = modulemd_defaults_merge (
-            defaults, into_defaults, strict_default_streams, &nested_error);
-          if (!merged_defaults)
-            {
-              g_propagate_error (error, g_steal_pointer (&nested_error));
-              return FALSE;
-            }
-
-          /* Add the new, merged defaults to the index */
-          if (!modulemd_module_index_add_defaults (
-                into, merged_defaults, &nested_error))
-            {
-              g_propagate_error (error, g_steal_pointer (&nested_error));
-              return FALSE;
-            }
-          g_clear_object (&merged_defaults);
+          defaults_mdversion = MAX (
+            defaults_mdversion,
+            modulemd_defaults_get_mdversion (MODULEMD_DEFAULTS (object)));
         }
 
-      /* Merge translations for this module */
-      g_debug ("Prioritizer: merging translations for %s", module_name);
-      translated_stream_names =
-        modulemd_module_get_translated_streams (module);
-      for (i = 0; i < translated_stream_names->len; i++)
-        {
-          translated_stream_name =
-            g_ptr_array_index (translated_stream_names, i);
-          translation =
-            modulemd_module_get_translation (module, translated_stream_name);
-          trans_stream = modulemd_translation_get_module_stream (translation);
-          current_translation =
-            modulemd_module_get_translation (into_module, trans_stream);
+      g_ptr_array_add (get_module_updates (updates,
+                                           get_object_module_name (object)),
+                       object);
+    }
 
-          if (!current_translation ||
-              modulemd_translation_get_modified (translation) >
-                modulemd_translation_get_modified (current_translation))
-            {
-              /* There was no translation for this stream name or we just found
-               * a newer version of it, so set it on the index.
-               */
-              if (!modulemd_module_index_add_translation (
-                    into, translation, &nested_error))
-                {
-                  g_propagate_error (error, g_steal_pointer (&nested_error));
-                  return FALSE;
-                }
-            }
-        }
-      g_clear_pointer (&translated_stream_names, g_ptr_array_unref);
+  /* Upgrading the index would change objects outside of the delta */
+  if ((self->stream_mdversion != MD_MODULESTREAM_VERSION_UNSET &&
+       stream_mdversion > self->stream_mdversion) ||
+      (self->defaults_mdversion != MD_DEFAULTS_VERSION_UNSET &&
+       defaults_mdversion > self->defaults_mdversion))
+    {
+      g_set_error_literal (error,
+                           MODULEMD_ERROR,
+                           MMD_ERROR_UPGRADE,
+                           "The delta contains documents of a higher "
+                           "mdversion than the index; upgrade the index "
+                           "first");
+      return FALSE;
+    }
 
-      /* Merge obsoletes for this module */
-      g_debug ("Prioritizer: merging obsoletes for %s", module_name);
-      obsoletes_array = modulemd_module_get_obsoletes (module);
-      for (i = 0; i < obsoletes_array->len; i++)
-        {
-          obsoletes = g_ptr_array_index (obsoletes_array, i);
+  /* Build all of the new modules before touching the index, so that a
+   * failure leaves it unchanged.
+   */
+  new_modules =
+    g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+  old_objects = g_ptr_array_new ();
+  new_objects = g_ptr_array_new ();
 
-          if (obsoletes)
-            {
-              /* Add obsoletes, overriding if we encounter one with
-               * identical module, stream, context and modified time.
-               */
-              if (!modulemd_module_index_add_obsoletes (
-                    into, obsoletes, &nested_error))
-                {
-                  g_propagate_error (error, g_steal_pointer (&nested_error));
-                  return FALSE;
-                }
-            }
+  g_hash_table_iter_init (&iter, updates);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      module = build_delta_module (self,
+                                   key,
+                                   value,
+                                   removals,
+                                   update_keys,
+                                   stream_mdversion,
+                                   defaults_mdversion,
+                                   old_objects,
+                                   new_objects,
+                                   error);
+      if (!module)
+        {
+          return FALSE;
         }
+      g_hash_table_insert (new_modules, key, module);
+    }
 
-      g_debug ("Prioritizer: all documents merged for %s", module_name);
-      g_clear_pointer (&translations, g_ptr_array_unref);
+  g_hash_table_iter_init (&iter, removals);
+  if (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      removal = value;
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_VALIDATE,
+                   "The delta removes an object of module %s that is not in "
+                   "the index",
+                   removal->module_name);
+      return FALSE;
     }
-  return TRUE;
-}
 
+  /* Only the terms of the objects that change need to be recomputed */
+  digest_from_hex (base, digest);
+  if (!xor_object_digests (self, old_objects, digest, error) ||
+      !xor_object_digests (self, new_objects, digest, error))
+    {
+      return FALSE;
+    }
 
-ModulemdDefaultsVersionEnum
-modulemd_module_index_get_defaults_mdversion (ModulemdModuleIndex *self)
-{
-  return self->defaults_mdversion;
-}
+  result = digest_to_hex (digest);
+  if (!g_str_equal (result, delta->result))
+    {
+      g_set_error (error,
+                   MODULEMD_ERROR,
+                   MMD_ERROR_VALIDATE,
+                   "Applying the delta would produce an index with digest "
+                   "%s instead of %s",
+                   result,
+                   delta->result);
+      return FALSE;
+    }
+
+  g_hash_table_iter_init (&iter, new_modules);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      if (module_is_empty (MODULEMD_MODULE (value)))
+        {
+          g_hash_table_remove (self->modules, key);
+        }
+      else
+        {
+          g_hash_table_replace (
+            self->modules, g_strdup (key), g_object_ref (value));
+        }
+    }
 
+  self->stream_mdversion = stream_mdversion;
+  self->defaults_mdversion = defaults_mdversion;
+  invalidate_default_streams (self);
+  g_clear_pointer (&self->sorted_module_names, g_ptr_array_unref);
+  invalidate_package_providers (self);
+  invalidate_index_digest (self);
 
-ModulemdModuleStreamVersionEnum
-modulemd_module_index_get_stream_mdversion (ModulemdModuleIndex *self)
-{
-  return self->stream_mdversion;
+  return TRUE;
 }
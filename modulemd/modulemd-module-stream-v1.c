@@ -26,6 +26,7 @@
 #include "private/modulemd-component-module-private.h"
 #include "private/modulemd-component-private.h"
 #include "private/modulemd-component-rpm-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-module-stream-private.h"
 #include "private/modulemd-module-stream-v1-private.h"
 #include "private/modulemd-profile-private.h"
@@ -119,6 +120,11 @@ modulemd_module_stream_v1_set_arch (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   modulemd_module_stream_set_arch (MODULEMD_MODULE_STREAM (self), arch);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ARCH]);
@@ -134,16 +140,37 @@ modulemd_module_stream_v1_get_arch (ModulemdModuleStreamV1 *self)
 }
 
 
+/*
+ * modulemd_module_stream_v1_take_buildopts:
+ * @self: (in): This #ModulemdModuleStreamV1 object.
+ * @buildopts: (in) (transfer full) (nullable): The #ModulemdBuildopts to
+ * store in @self without copying them.
+ */
+static void
+modulemd_module_stream_v1_take_buildopts (ModulemdModuleStreamV1 *self,
+                                          ModulemdBuildopts *buildopts)
+{
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_clear_object (&buildopts);
+      return;
+    }
+
+  g_clear_object (&self->buildopts);
+  self->buildopts = buildopts;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BUILDOPTS]);
+}
+
+
 void
 modulemd_module_stream_v1_set_buildopts (ModulemdModuleStreamV1 *self,
                                          ModulemdBuildopts *buildopts)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
-  g_clear_object (&self->buildopts);
-  self->buildopts = modulemd_buildopts_copy (buildopts);
-
-  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BUILDOPTS]);
+  modulemd_module_stream_v1_take_buildopts (
+    self, modulemd_buildopts_copy (buildopts));
 }
 
 
@@ -162,6 +189,11 @@ modulemd_module_stream_v1_set_community (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->community, g_free);
   self->community = g_strdup (community);
 
@@ -184,6 +216,11 @@ modulemd_module_stream_v1_set_description (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->description, g_free);
   self->description = g_strdup (description);
 }
@@ -214,6 +251,11 @@ modulemd_module_stream_v1_set_documentation (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->documentation, g_free);
   self->documentation = g_strdup (documentation);
 
@@ -236,6 +278,11 @@ modulemd_module_stream_v1_set_summary (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->summary, g_free);
   self->summary = g_strdup (summary);
 }
@@ -265,6 +312,11 @@ modulemd_module_stream_v1_set_tracker (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->tracker, g_free);
   self->tracker = g_strdup (tracker);
 
@@ -284,21 +336,24 @@ modulemd_module_stream_v1_get_tracker (ModulemdModuleStreamV1 *self)
 /* ===== Non-property Methods ===== */
 
 
-void
-modulemd_module_stream_v1_add_component (ModulemdModuleStreamV1 *self,
-                                         ModulemdComponent *component)
+/*
+ * modulemd_module_stream_v1_take_component:
+ * @self: (in): This #ModulemdModuleStreamV1 object.
+ * @component: (in) (transfer full): A #ModulemdComponent to store in @self
+ * without copying it.
+ */
+static void
+modulemd_module_stream_v1_take_component (ModulemdModuleStreamV1 *self,
+                                          ModulemdComponent *component)
 {
   GHashTable *table = NULL;
 
-  /* Do nothing if we were passed a NULL component */
-  if (!component)
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
     {
+      g_clear_object (&component);
       return;
     }
 
-  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
-  g_return_if_fail (MODULEMD_IS_COMPONENT (component));
-
   if (MODULEMD_IS_COMPONENT_RPM (component))
     {
       table = self->rpm_components;
@@ -310,15 +365,33 @@ modulemd_module_stream_v1_add_component (ModulemdModuleStreamV1 *self,
   else
     {
       /* Unknown component. Raise a warning and return */
+      g_object_unref (component);
       g_return_if_reached ();
     }
 
   /* Add the component to the table. This will replace an existing component
    * with the same name
    */
-  g_hash_table_replace (table,
-                        g_strdup (modulemd_component_get_key (component)),
-                        modulemd_component_copy (component, NULL));
+  g_hash_table_replace (
+    table, g_strdup (modulemd_component_get_key (component)), component);
+}
+
+
+void
+modulemd_module_stream_v1_add_component (ModulemdModuleStreamV1 *self,
+                                         ModulemdComponent *component)
+{
+  /* Do nothing if we were passed a NULL component */
+  if (!component)
+    {
+      return;
+    }
+
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
+  g_return_if_fail (MODULEMD_IS_COMPONENT (component));
+
+  modulemd_module_stream_v1_take_component (
+    self, modulemd_component_copy (component, NULL));
 }
 
 
@@ -334,6 +407,11 @@ modulemd_module_stream_v1_remove_module_component (
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->module_components, component_name);
 }
 
@@ -344,6 +422,11 @@ modulemd_module_stream_v1_clear_module_components (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->module_components);
 }
 
@@ -360,6 +443,11 @@ modulemd_module_stream_v1_remove_rpm_component (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_components, component_name);
 }
 
@@ -369,6 +457,11 @@ modulemd_module_stream_v1_clear_rpm_components (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_components);
 }
 
@@ -424,7 +517,12 @@ modulemd_module_stream_v1_add_content_license (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
-  g_hash_table_add (self->content_licenses, g_strdup (license));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->content_licenses, modulemd_str_intern (license));
 }
 
 
@@ -434,6 +532,11 @@ modulemd_module_stream_v1_replace_content_licenses (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->content_licenses, set);
 }
 
@@ -443,6 +546,11 @@ modulemd_module_stream_v1_clear_content_licenses (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->content_licenses);
 }
 
@@ -458,7 +566,12 @@ modulemd_module_stream_v1_add_module_license (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
-  g_hash_table_add (self->module_licenses, g_strdup (license));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->module_licenses, modulemd_str_intern (license));
 }
 
 
@@ -468,6 +581,11 @@ modulemd_module_stream_v1_replace_module_licenses (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->module_licenses, set);
 }
 
@@ -477,6 +595,11 @@ modulemd_module_stream_v1_clear_module_licenses (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->module_licenses);
 }
 
@@ -492,6 +615,11 @@ modulemd_module_stream_v1_remove_content_license (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->content_licenses, license);
 }
 
@@ -507,6 +635,11 @@ modulemd_module_stream_v1_remove_module_license (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->module_licenses, license);
 }
 
@@ -531,6 +664,29 @@ modulemd_module_stream_v1_get_module_licenses_as_strv (
 }
 
 
+/*
+ * modulemd_module_stream_v1_take_profile:
+ * @self: (in): This #ModulemdModuleStreamV1 object.
+ * @profile: (in) (transfer full): A #ModulemdProfile to store in @self
+ * without copying it.
+ */
+static void
+modulemd_module_stream_v1_take_profile (ModulemdModuleStreamV1 *self,
+                                        ModulemdProfile *profile)
+{
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_clear_object (&profile);
+      return;
+    }
+
+  modulemd_profile_set_owner (profile, MODULEMD_MODULE_STREAM (self));
+
+  g_hash_table_replace (
+    self->profiles, g_strdup (modulemd_profile_get_name (profile)), profile);
+}
+
+
 void
 modulemd_module_stream_v1_add_profile (ModulemdModuleStreamV1 *self,
                                        ModulemdProfile *profile)
@@ -542,12 +698,8 @@ modulemd_module_stream_v1_add_profile (ModulemdModuleStreamV1 *self,
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
   g_return_if_fail (MODULEMD_IS_PROFILE (profile));
 
-  ModulemdProfile *copied_profile = modulemd_profile_copy (profile);
-  modulemd_profile_set_owner (copied_profile, MODULEMD_MODULE_STREAM (self));
-
-  g_hash_table_replace (self->profiles,
-                        g_strdup (modulemd_profile_get_name (profile)),
-                        copied_profile);
+  modulemd_module_stream_v1_take_profile (self,
+                                          modulemd_profile_copy (profile));
 }
 
 
@@ -556,6 +708,11 @@ modulemd_module_stream_v1_clear_profiles (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->profiles);
 }
 
@@ -591,7 +748,12 @@ modulemd_module_stream_v1_add_rpm_api (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
-  g_hash_table_add (self->rpm_api, g_strdup (rpm));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->rpm_api, modulemd_str_intern (rpm));
 }
 
 
@@ -601,6 +763,11 @@ modulemd_module_stream_v1_replace_rpm_api (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->rpm_api, set);
 }
 
@@ -616,6 +783,11 @@ modulemd_module_stream_v1_remove_rpm_api (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_api, rpm);
 }
 
@@ -625,6 +797,11 @@ modulemd_module_stream_v1_clear_rpm_api (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_api);
 }
 
@@ -649,7 +826,12 @@ modulemd_module_stream_v1_add_rpm_artifact (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
-  g_hash_table_add (self->rpm_artifacts, g_strdup (nevr));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->rpm_artifacts, modulemd_str_intern (nevr));
 }
 
 
@@ -659,6 +841,11 @@ modulemd_module_stream_v1_replace_rpm_artifacts (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->rpm_artifacts, set);
 }
 
@@ -674,6 +861,11 @@ modulemd_module_stream_v1_remove_rpm_artifact (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_artifacts, nevr);
 }
 
@@ -683,6 +875,11 @@ modulemd_module_stream_v1_clear_rpm_artifacts (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_artifacts);
 }
 
@@ -708,7 +905,12 @@ modulemd_module_stream_v1_add_rpm_filter (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
-  g_hash_table_add (self->rpm_filters, g_strdup (rpm));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->rpm_filters, modulemd_str_intern (rpm));
 }
 
 
@@ -718,6 +920,11 @@ modulemd_module_stream_v1_replace_rpm_filters (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->rpm_filters, set);
 }
 
@@ -733,6 +940,11 @@ modulemd_module_stream_v1_remove_rpm_filter (ModulemdModuleStreamV1 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_filters, rpm);
 }
 
@@ -742,6 +954,11 @@ modulemd_module_stream_v1_clear_rpm_filters (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_filters);
 }
 
@@ -756,6 +973,29 @@ modulemd_module_stream_v1_get_rpm_filters_as_strv (
 }
 
 
+/*
+ * modulemd_module_stream_v1_take_servicelevel:
+ * @self: (in): This #ModulemdModuleStreamV1 object.
+ * @servicelevel: (in) (transfer full): A #ModulemdServiceLevel to store in
+ * @self without copying it.
+ */
+static void
+modulemd_module_stream_v1_take_servicelevel (
+  ModulemdModuleStreamV1 *self, ModulemdServiceLevel *servicelevel)
+{
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_clear_object (&servicelevel);
+      return;
+    }
+
+  g_hash_table_replace (
+    self->servicelevels,
+    g_strdup (modulemd_service_level_get_name (servicelevel)),
+    servicelevel);
+}
+
+
 void
 modulemd_module_stream_v1_add_servicelevel (ModulemdModuleStreamV1 *self,
                                             ModulemdServiceLevel *servicelevel)
@@ -767,10 +1007,8 @@ modulemd_module_stream_v1_add_servicelevel (ModulemdModuleStreamV1 *self,
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
   g_return_if_fail (MODULEMD_IS_SERVICE_LEVEL (servicelevel));
 
-  g_hash_table_replace (
-    self->servicelevels,
-    g_strdup (modulemd_service_level_get_name (servicelevel)),
-    modulemd_service_level_copy (servicelevel));
+  modulemd_module_stream_v1_take_servicelevel (
+    self, modulemd_service_level_copy (servicelevel));
 }
 
 
@@ -779,6 +1017,11 @@ modulemd_module_stream_v1_clear_servicelevels (ModulemdModuleStreamV1 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->servicelevels);
 }
 
@@ -808,6 +1051,11 @@ modulemd_module_stream_v1_set_eol (ModulemdModuleStreamV1 *self, GDate *eol)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   /* The "eol" field in the YAML is a relic of an early iteration and has been
    * entirely replaced by the ServiceLevel concept. If we encounter it, we just
    * treat it as if it was the EOL value for a service level named "rawhide".
@@ -840,6 +1088,11 @@ modulemd_module_stream_v1_add_buildtime_requirement (
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
   g_return_if_fail (module_name && module_stream);
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_replace (
     self->buildtime_deps, g_strdup (module_name), g_strdup (module_stream));
 }
@@ -851,6 +1104,11 @@ modulemd_module_stream_v1_replace_buildtime_deps (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   if (deps)
     {
       g_hash_table_unref (self->buildtime_deps);
@@ -872,6 +1130,11 @@ modulemd_module_stream_v1_add_runtime_requirement (
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
   g_return_if_fail (module_name && module_stream);
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_replace (
     self->runtime_deps, g_strdup (module_name), g_strdup (module_stream));
 }
@@ -883,6 +1146,11 @@ modulemd_module_stream_v1_replace_runtime_deps (ModulemdModuleStreamV1 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   if (deps)
     {
       g_hash_table_unref (self->runtime_deps);
@@ -902,6 +1170,11 @@ modulemd_module_stream_v1_remove_buildtime_requirement (
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
   g_return_if_fail (module_name);
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->buildtime_deps, module_name);
 }
 
@@ -913,6 +1186,11 @@ modulemd_module_stream_v1_remove_runtime_requirement (
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
   g_return_if_fail (module_name);
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->runtime_deps, module_name);
 }
 
@@ -923,6 +1201,11 @@ modulemd_module_stream_v1_clear_buildtime_requirements (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->buildtime_deps);
 }
 
@@ -933,6 +1216,11 @@ modulemd_module_stream_v1_clear_runtime_requirements (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->runtime_deps);
 }
 
@@ -982,6 +1270,11 @@ modulemd_module_stream_v1_set_xmd (ModulemdModuleStreamV1 *self, GVariant *xmd)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   /* Do nothing if we were passed the same pointer */
   if (self->xmd == xmd)
     {
@@ -1467,22 +1760,17 @@ modulemd_module_stream_v1_init (ModulemdModuleStreamV1 *self)
   self->rpm_components =
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
-  self->content_licenses =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-  self->module_licenses =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->content_licenses = modulemd_str_set_new ();
+  self->module_licenses = modulemd_str_set_new ();
 
-  self->profiles =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  self->profiles = g_hash_table_new_full (
+    g_str_hash, g_str_equal, g_free, modulemd_profile_disown);
 
-  self->rpm_api =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_api = modulemd_str_set_new ();
 
-  self->rpm_artifacts =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_artifacts = modulemd_str_set_new ();
 
-  self->rpm_filters =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_filters = modulemd_str_set_new ();
 
   self->servicelevels =
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
@@ -1585,10 +1873,10 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
           /* Module Name */
           if (g_str_equal ((const gchar *)event.data.scalar.value, "name"))
             {
-              MMD_SET_PARSED_YAML_STRING (
+              MMD_TAKE_PARSED_YAML_STRING (
                 &parser,
                 error,
-                modulemd_module_stream_set_module_name,
+                modulemd_module_stream_take_module_name,
                 MODULEMD_MODULE_STREAM (modulestream));
             }
 
@@ -1596,10 +1884,10 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "stream"))
             {
-              MMD_SET_PARSED_YAML_STRING (
+              MMD_TAKE_PARSED_YAML_STRING (
                 &parser,
                 error,
-                modulemd_module_stream_set_stream_name,
+                modulemd_module_stream_take_stream_name,
                 MODULEMD_MODULE_STREAM (modulestream));
             }
 
@@ -1622,10 +1910,10 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "context"))
             {
-              MMD_SET_PARSED_YAML_STRING (
+              MMD_TAKE_PARSED_YAML_STRING (
                 &parser,
                 error,
-                modulemd_module_stream_set_context,
+                modulemd_module_stream_take_context,
                 MODULEMD_MODULE_STREAM (modulestream));
             }
 
@@ -1633,32 +1921,27 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "arch"))
             {
-              MMD_SET_PARSED_YAML_STRING (&parser,
-                                          error,
-                                          modulemd_module_stream_v1_set_arch,
-                                          modulestream);
+              MMD_TAKE_PARSED_YAML_STRING (
+                &parser,
+                error,
+                modulemd_module_stream_take_arch,
+                MODULEMD_MODULE_STREAM (modulestream));
             }
 
           /* Module Summary */
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "summary"))
             {
-              MMD_SET_PARSED_YAML_STRING (
-                &parser,
-                error,
-                modulemd_module_stream_v1_set_summary,
-                modulestream);
+              MMD_STORE_PARSED_YAML_STRING (
+                &parser, error, modulestream->summary);
             }
 
           /* Module Description */
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "description"))
             {
-              MMD_SET_PARSED_YAML_STRING (
-                &parser,
-                error,
-                modulemd_module_stream_v1_set_description,
-                modulestream);
+              MMD_STORE_PARSED_YAML_STRING (
+                &parser, error, modulestream->description);
             }
 
           /* Service Levels */
@@ -1739,8 +2022,7 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_module_stream_v1_replace_rpm_api (modulestream, set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->rpm_api, set);
             }
 
           /* Filter */
@@ -1749,9 +2031,7 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_module_stream_v1_replace_rpm_filters (modulestream,
-                                                             set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->rpm_filters, set);
             }
 
           /* Build Options */
@@ -1766,9 +2046,8 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                   return NULL;
                 }
 
-              modulemd_module_stream_v1_set_buildopts (modulestream,
-                                                       buildopts);
-              g_clear_object (&buildopts);
+              modulemd_module_stream_v1_take_buildopts (
+                modulestream, g_steal_pointer (&buildopts));
             }
 
           /* Components */
@@ -1794,9 +2073,7 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                   g_propagate_error (error, g_steal_pointer (&nested_error));
                   return NULL;
                 }
-              modulemd_module_stream_v1_replace_rpm_artifacts (modulestream,
-                                                               set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->rpm_artifacts, set);
             }
 
           /* EOL (Deprecated) */
@@ -1817,9 +2094,9 @@ modulemd_module_stream_v1_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                */
               sl = modulemd_service_level_new ("rawhide");
               modulemd_service_level_set_eol (sl, eol);
-              modulemd_module_stream_v1_add_servicelevel (modulestream, sl);
+              modulemd_module_stream_v1_take_servicelevel (
+                modulestream, g_steal_pointer (&sl));
 
-              g_clear_object (&sl);
               g_clear_pointer (&eol, g_date_free);
             }
 
@@ -1908,17 +2185,13 @@ modulemd_module_stream_v1_parse_licenses (yaml_parser_t *parser,
                   g_propagate_error (error, g_steal_pointer (&nested_error));
                   return FALSE;
                 }
-              modulemd_module_stream_v1_replace_module_licenses (modulestream,
-                                                                 set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->module_licenses, set);
             }
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "content"))
             {
               set = modulemd_yaml_parse_string_set (parser, &nested_error);
-              modulemd_module_stream_v1_replace_content_licenses (modulestream,
-                                                                  set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->content_licenses, set);
             }
           else
             {
@@ -2007,8 +2280,8 @@ modulemd_module_stream_v1_parse_servicelevels (
               return FALSE;
             }
 
-          modulemd_module_stream_v1_add_servicelevel (modulestream, sl);
-          g_clear_object (&sl);
+          modulemd_module_stream_v1_take_servicelevel (modulestream,
+                                                       g_steal_pointer (&sl));
 
           break;
 
@@ -2071,9 +2344,9 @@ modulemd_module_stream_v1_parse_deps (yaml_parser_t *parser,
                   g_propagate_error (error, g_steal_pointer (&nested_error));
                   return FALSE;
                 }
-              modulemd_module_stream_v1_replace_buildtime_deps (modulestream,
-                                                                deptable);
-              g_clear_pointer (&deptable, g_hash_table_unref);
+              g_clear_pointer (&modulestream->buildtime_deps,
+                               g_hash_table_unref);
+              modulestream->buildtime_deps = g_steal_pointer (&deptable);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
@@ -2086,9 +2359,9 @@ modulemd_module_stream_v1_parse_deps (yaml_parser_t *parser,
                   g_propagate_error (error, g_steal_pointer (&nested_error));
                   return FALSE;
                 }
-              modulemd_module_stream_v1_replace_runtime_deps (modulestream,
-                                                              deptable);
-              g_clear_pointer (&deptable, g_hash_table_unref);
+              g_clear_pointer (&modulestream->runtime_deps,
+                               g_hash_table_unref);
+              modulestream->runtime_deps = g_steal_pointer (&deptable);
             }
 
           else
@@ -2266,8 +2539,8 @@ modulemd_module_stream_v1_parse_profiles (yaml_parser_t *parser,
               return FALSE;
             }
 
-          modulemd_module_stream_v1_add_profile (modulestream, profile);
-          g_clear_pointer (&profile, g_object_unref);
+          modulemd_module_stream_v1_take_profile (modulestream,
+                                                  g_steal_pointer (&profile));
           break;
 
         default:
@@ -2426,9 +2699,8 @@ modulemd_module_stream_v1_parse_rpm_components (
               g_propagate_error (error, g_steal_pointer (&nested_error));
               return FALSE;
             }
-          modulemd_module_stream_v1_add_component (
-            modulestream, (ModulemdComponent *)component);
-          g_clear_pointer (&component, g_object_unref);
+          modulemd_module_stream_v1_take_component (
+            modulestream, (ModulemdComponent *)g_steal_pointer (&component));
           break;
 
         default:
@@ -2491,9 +2763,8 @@ modulemd_module_stream_v1_parse_module_components (
               g_propagate_error (error, g_steal_pointer (&nested_error));
               return FALSE;
             }
-          modulemd_module_stream_v1_add_component (
-            modulestream, (ModulemdComponent *)component);
-          g_clear_pointer (&component, g_object_unref);
+          modulemd_module_stream_v1_take_component (
+            modulestream, (ModulemdComponent *)g_steal_pointer (&component));
           break;
 
         default:
@@ -2654,3 +2925,168 @@ modulemd_module_stream_v1_emit_yaml (ModulemdModuleStreamV1 *self,
 
   return TRUE;
 }
+
+
+void
+modulemd_module_stream_v1_add_memory_usage (ModulemdModuleStreamV1 *self,
+                                            ModulemdMemoryUsage *usage)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
+
+  modulemd_module_stream_add_memory_usage (MODULEMD_MODULE_STREAM (self),
+                                           usage);
+  if (self->buildopts)
+    {
+      modulemd_buildopts_add_memory_usage (self->buildopts, usage);
+    }
+  modulemd_memory_usage_add_string (usage, self->community);
+  modulemd_memory_usage_add_string (usage, self->description);
+  modulemd_memory_usage_add_string (usage, self->documentation);
+  modulemd_memory_usage_add_string (usage, self->summary);
+  modulemd_memory_usage_add_string (usage, self->tracker);
+
+  modulemd_memory_usage_add_hash_table (usage, self->rpm_components);
+  g_hash_table_iter_init (&iter, self->rpm_components);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_component_rpm_add_memory_usage (MODULEMD_COMPONENT_RPM (value),
+                                               usage);
+    }
+
+  modulemd_memory_usage_add_hash_table (usage, self->module_components);
+  g_hash_table_iter_init (&iter, self->module_components);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_component_module_add_memory_usage (
+        MODULEMD_COMPONENT_MODULE (value), usage);
+    }
+
+  modulemd_memory_usage_add_string_set (usage, self->content_licenses);
+  modulemd_memory_usage_add_string_set (usage, self->module_licenses);
+
+  modulemd_memory_usage_add_hash_table (usage, self->profiles);
+  g_hash_table_iter_init (&iter, self->profiles);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_profile_add_memory_usage (MODULEMD_PROFILE (value), usage);
+    }
+
+  modulemd_memory_usage_add_string_set (usage, self->rpm_api);
+  modulemd_memory_usage_add_string_set (usage, self->rpm_filters);
+
+  modulemd_memory_usage_add_hash_table (usage, self->servicelevels);
+  g_hash_table_iter_init (&iter, self->servicelevels);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_service_level_add_memory_usage (
+        MODULEMD_SERVICE_LEVEL (value), usage);
+    }
+
+  modulemd_memory_usage_add_variant (usage, self->xmd);
+
+  modulemd_memory_usage_add_string_map (usage, self->buildtime_deps);
+  modulemd_memory_usage_add_string_map (usage, self->runtime_deps);
+
+  /* The empty set of a stream without artifacts is a plain container */
+  if (g_hash_table_size (self->rpm_artifacts) == 0)
+    {
+      modulemd_memory_usage_add_string_set (usage, self->rpm_artifacts);
+      return;
+    }
+
+  modulemd_memory_usage_push_section (usage, MD_MEMORY_CATEGORY_ARTIFACTS);
+  modulemd_memory_usage_add_string_set (usage, self->rpm_artifacts);
+  modulemd_memory_usage_pop_section (usage);
+}
+
+
+guint64
+modulemd_module_stream_v1_get_objects_generation (ModulemdModuleStreamV1 *self)
+{
+  GHashTableIter iter;
+  gpointer value;
+  guint64 generation = 0;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self), 0);
+
+  if (self->buildopts)
+    {
+      generation = modulemd_buildopts_get_generation (self->buildopts);
+    }
+
+  g_hash_table_iter_init (&iter, self->rpm_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation =
+        MAX (generation, modulemd_component_get_generation (value));
+    }
+
+  g_hash_table_iter_init (&iter, self->module_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation =
+        MAX (generation, modulemd_component_get_generation (value));
+    }
+
+  g_hash_table_iter_init (&iter, self->profiles);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation = MAX (generation, modulemd_profile_get_generation (value));
+    }
+
+  g_hash_table_iter_init (&iter, self->servicelevels);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation =
+        MAX (generation, modulemd_service_level_get_generation (value));
+    }
+
+  return generation;
+}
+
+
+void
+modulemd_module_stream_v1_freeze_objects (ModulemdModuleStreamV1 *self)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V1 (self));
+
+  if (self->buildopts)
+    {
+      modulemd_buildopts_freeze (self->buildopts);
+    }
+
+  g_hash_table_iter_init (&iter, self->rpm_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_component_freeze (value);
+    }
+
+  g_hash_table_iter_init (&iter, self->module_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_component_freeze (value);
+    }
+
+  g_hash_table_iter_init (&iter, self->profiles);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_profile_freeze (value);
+    }
+
+  g_hash_table_iter_init (&iter, self->servicelevels);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_service_level_freeze (value);
+    }
+}
@@ -27,6 +27,7 @@
 #include "private/modulemd-component-private.h"
 #include "private/modulemd-component-rpm-private.h"
 #include "private/modulemd-dependencies-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-module-stream-private.h"
 #include "private/modulemd-module-stream-v2-private.h"
 #include "private/modulemd-profile-private.h"
@@ -293,6 +294,11 @@ modulemd_module_stream_v2_set_arch (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   modulemd_module_stream_set_arch (MODULEMD_MODULE_STREAM (self), arch);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ARCH]);
@@ -308,19 +314,37 @@ modulemd_module_stream_v2_get_arch (ModulemdModuleStreamV2 *self)
 }
 
 
+/*
+ * modulemd_module_stream_v2_take_buildopts:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @buildopts: (in) (transfer full) (nullable): The #ModulemdBuildopts to
+ * store in @self without copying them.
+ */
+static void
+modulemd_module_stream_v2_take_buildopts (ModulemdModuleStreamV2 *self,
+                                          ModulemdBuildopts *buildopts)
+{
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_clear_object (&buildopts);
+      return;
+    }
+
+  g_clear_object (&self->buildopts);
+  self->buildopts = buildopts;
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BUILDOPTS]);
+}
+
+
 void
 modulemd_module_stream_v2_set_buildopts (ModulemdModuleStreamV2 *self,
                                          ModulemdBuildopts *buildopts)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_clear_object (&self->buildopts);
-  if (buildopts)
-    {
-      self->buildopts = modulemd_buildopts_copy (buildopts);
-    }
-
-  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BUILDOPTS]);
+  modulemd_module_stream_v2_take_buildopts (
+    self, buildopts ? modulemd_buildopts_copy (buildopts) : NULL);
 }
 
 
@@ -339,6 +363,11 @@ modulemd_module_stream_v2_set_community (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->community, g_free);
   self->community = g_strdup (community);
 
@@ -361,6 +390,11 @@ modulemd_module_stream_v2_set_description (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->description, g_free);
   self->description = g_strdup (description);
 }
@@ -391,6 +425,11 @@ modulemd_module_stream_v2_set_documentation (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->documentation, g_free);
   self->documentation = g_strdup (documentation);
 
@@ -413,6 +452,11 @@ modulemd_module_stream_v2_set_summary (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->summary, g_free);
   self->summary = g_strdup (summary);
 }
@@ -442,6 +486,11 @@ modulemd_module_stream_v2_set_tracker (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->tracker, g_free);
   self->tracker = g_strdup (tracker);
 
@@ -477,6 +526,8 @@ modulemd_module_stream_v2_associate_obsoletes (ModulemdModuleStreamV2 *self,
                                                ModulemdObsoletes *obsoletes)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
+  g_return_if_fail (
+    !modulemd_module_stream_is_frozen (MODULEMD_MODULE_STREAM (self)));
 
   g_clear_pointer (&self->obsoletes, g_object_unref);
   if (obsoletes != NULL)
@@ -496,21 +547,24 @@ modulemd_module_stream_v2_get_obsoletes (ModulemdModuleStreamV2 *self)
 
 /* ===== Non-property Methods ===== */
 
-void
-modulemd_module_stream_v2_add_component (ModulemdModuleStreamV2 *self,
-                                         ModulemdComponent *component)
+/*
+ * modulemd_module_stream_v2_take_component:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @component: (in) (transfer full): A #ModulemdComponent to store in @self
+ * without copying it.
+ */
+static void
+modulemd_module_stream_v2_take_component (ModulemdModuleStreamV2 *self,
+                                          ModulemdComponent *component)
 {
   GHashTable *table = NULL;
 
-  /* Do nothing if we were passed a NULL component */
-  if (!component)
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
     {
+      g_clear_object (&component);
       return;
     }
 
-  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
-  g_return_if_fail (MODULEMD_IS_COMPONENT (component));
-
   if (MODULEMD_IS_COMPONENT_RPM (component))
     {
       table = self->rpm_components;
@@ -522,15 +576,33 @@ modulemd_module_stream_v2_add_component (ModulemdModuleStreamV2 *self,
   else
     {
       /* Unknown component. Raise a warning and return */
+      g_object_unref (component);
       g_return_if_reached ();
     }
 
   /* Add the component to the table. This will replace an existing component
    * with the same name
    */
-  g_hash_table_replace (table,
-                        g_strdup (modulemd_component_get_key (component)),
-                        modulemd_component_copy (component, NULL));
+  g_hash_table_replace (
+    table, g_strdup (modulemd_component_get_key (component)), component);
+}
+
+
+void
+modulemd_module_stream_v2_add_component (ModulemdModuleStreamV2 *self,
+                                         ModulemdComponent *component)
+{
+  /* Do nothing if we were passed a NULL component */
+  if (!component)
+    {
+      return;
+    }
+
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
+  g_return_if_fail (MODULEMD_IS_COMPONENT (component));
+
+  modulemd_module_stream_v2_take_component (
+    self, modulemd_component_copy (component, NULL));
 }
 
 
@@ -546,6 +618,11 @@ modulemd_module_stream_v2_remove_module_component (
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->module_components, component_name);
 }
 
@@ -556,6 +633,11 @@ modulemd_module_stream_v2_clear_module_components (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->module_components);
 }
 
@@ -572,6 +654,11 @@ modulemd_module_stream_v2_remove_rpm_component (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_components, component_name);
 }
 
@@ -581,6 +668,11 @@ modulemd_module_stream_v2_clear_rpm_components (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_components);
 }
 
@@ -636,7 +728,12 @@ modulemd_module_stream_v2_add_content_license (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_hash_table_add (self->content_licenses, g_strdup (license));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->content_licenses, modulemd_str_intern (license));
 }
 
 
@@ -646,6 +743,11 @@ modulemd_module_stream_v2_replace_content_licenses (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->content_licenses, set);
 }
 
@@ -661,7 +763,12 @@ modulemd_module_stream_v2_add_module_license (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_hash_table_add (self->module_licenses, g_strdup (license));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->module_licenses, modulemd_str_intern (license));
 }
 
 
@@ -671,6 +778,11 @@ modulemd_module_stream_v2_replace_module_licenses (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->module_licenses, set);
 }
 
@@ -686,6 +798,11 @@ modulemd_module_stream_v2_remove_content_license (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->content_licenses, license);
 }
 
@@ -701,6 +818,11 @@ modulemd_module_stream_v2_remove_module_license (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->module_licenses, license);
 }
 
@@ -710,6 +832,11 @@ modulemd_module_stream_v2_clear_content_licenses (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->content_licenses);
 }
 
@@ -719,6 +846,11 @@ modulemd_module_stream_v2_clear_module_licenses (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->module_licenses);
 }
 
@@ -743,6 +875,29 @@ modulemd_module_stream_v2_get_module_licenses_as_strv (
 }
 
 
+/*
+ * modulemd_module_stream_v2_take_profile:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @profile: (in) (transfer full): A #ModulemdProfile to store in @self
+ * without copying it.
+ */
+static void
+modulemd_module_stream_v2_take_profile (ModulemdModuleStreamV2 *self,
+                                        ModulemdProfile *profile)
+{
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_clear_object (&profile);
+      return;
+    }
+
+  modulemd_profile_set_owner (profile, MODULEMD_MODULE_STREAM (self));
+
+  g_hash_table_replace (
+    self->profiles, g_strdup (modulemd_profile_get_name (profile)), profile);
+}
+
+
 void
 modulemd_module_stream_v2_add_profile (ModulemdModuleStreamV2 *self,
                                        ModulemdProfile *profile)
@@ -754,12 +909,8 @@ modulemd_module_stream_v2_add_profile (ModulemdModuleStreamV2 *self,
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
   g_return_if_fail (MODULEMD_IS_PROFILE (profile));
 
-  ModulemdProfile *copied_profile = modulemd_profile_copy (profile);
-  modulemd_profile_set_owner (copied_profile, MODULEMD_MODULE_STREAM (self));
-
-  g_hash_table_replace (self->profiles,
-                        g_strdup (modulemd_profile_get_name (profile)),
-                        copied_profile);
+  modulemd_module_stream_v2_take_profile (self,
+                                          modulemd_profile_copy (profile));
 }
 
 
@@ -768,6 +919,11 @@ modulemd_module_stream_v2_clear_profiles (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->profiles);
 }
 
@@ -826,7 +982,7 @@ modulemd_module_stream_v2_search_profiles (ModulemdModuleStreamV2 *self,
   g_return_val_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self), found);
 
   g_autoptr (GPtrArray) profile_names =
-    modulemd_ordered_str_keys (self->profiles, modulemd_strcmp_sort);
+    modulemd_sorted_str_keys (self->profiles);
 
   struct profile_match_ctx match_ctx = { .profiles = self->profiles,
                                          .found = found,
@@ -849,7 +1005,12 @@ modulemd_module_stream_v2_add_rpm_api (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_hash_table_add (self->rpm_api, g_strdup (rpm));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->rpm_api, modulemd_str_intern (rpm));
 }
 
 
@@ -859,6 +1020,11 @@ modulemd_module_stream_v2_replace_rpm_api (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->rpm_api, set);
 }
 
@@ -874,6 +1040,11 @@ modulemd_module_stream_v2_remove_rpm_api (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_api, rpm);
 }
 
@@ -883,6 +1054,11 @@ modulemd_module_stream_v2_clear_rpm_api (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_api);
 }
 
@@ -907,7 +1083,12 @@ modulemd_module_stream_v2_add_rpm_artifact (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_hash_table_add (self->rpm_artifacts, g_strdup (nevr));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->rpm_artifacts, modulemd_str_intern (nevr));
 }
 
 
@@ -917,6 +1098,11 @@ modulemd_module_stream_v2_replace_rpm_artifacts (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->rpm_artifacts, set);
 }
 
@@ -932,6 +1118,11 @@ modulemd_module_stream_v2_remove_rpm_artifact (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_artifacts, nevr);
 }
 
@@ -941,6 +1132,11 @@ modulemd_module_stream_v2_clear_rpm_artifacts (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_artifacts);
 }
 
@@ -972,8 +1168,16 @@ get_or_create_digest_table (ModulemdModuleStreamV2 *self, const gchar *digest)
 }
 
 
-void
-modulemd_module_stream_v2_set_rpm_artifact_map_entry (
+/*
+ * modulemd_module_stream_v2_take_rpm_artifact_map_entry:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @entry: (in) (transfer full): A #ModulemdRpmMapEntry to store in @self
+ * without copying it.
+ * @digest: (in): The digest algorithm of @checksum.
+ * @checksum: (in): The checksum of the RPM described by @entry.
+ */
+static void
+modulemd_module_stream_v2_take_rpm_artifact_map_entry (
   ModulemdModuleStreamV2 *self,
   ModulemdRpmMapEntry *entry,
   const gchar *digest,
@@ -981,13 +1185,30 @@ modulemd_module_stream_v2_set_rpm_artifact_map_entry (
 {
   GHashTable *digest_table = NULL;
 
-  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
-  g_return_if_fail (entry && digest && checksum);
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_object_unref (entry);
+      return;
+    }
 
   digest_table = get_or_create_digest_table (self, digest);
 
-  g_hash_table_insert (
-    digest_table, g_strdup (checksum), modulemd_rpm_map_entry_copy (entry));
+  g_hash_table_insert (digest_table, g_strdup (checksum), entry);
+}
+
+
+void
+modulemd_module_stream_v2_set_rpm_artifact_map_entry (
+  ModulemdModuleStreamV2 *self,
+  ModulemdRpmMapEntry *entry,
+  const gchar *digest,
+  const gchar *checksum)
+{
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
+  g_return_if_fail (entry && digest && checksum);
+
+  modulemd_module_stream_v2_take_rpm_artifact_map_entry (
+    self, modulemd_rpm_map_entry_copy (entry), digest, checksum);
 }
 
 
@@ -1020,7 +1241,12 @@ modulemd_module_stream_v2_add_rpm_filter (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_hash_table_add (self->rpm_filters, g_strdup (rpm));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->rpm_filters, modulemd_str_intern (rpm));
 }
 
 
@@ -1030,6 +1256,11 @@ modulemd_module_stream_v2_replace_rpm_filters (ModulemdModuleStreamV2 *self,
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->rpm_filters, set);
 }
 
@@ -1045,6 +1276,11 @@ modulemd_module_stream_v2_remove_rpm_filter (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->rpm_filters, rpm);
 }
 
@@ -1054,6 +1290,11 @@ modulemd_module_stream_v2_clear_rpm_filters (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->rpm_filters);
 }
 
@@ -1079,7 +1320,12 @@ modulemd_module_stream_v2_add_demodularized_rpm (ModulemdModuleStreamV2 *self,
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_hash_table_add (self->demodularized_rpms, g_strdup (rpm));
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
+  g_hash_table_add (self->demodularized_rpms, modulemd_str_intern (rpm));
 }
 
 
@@ -1089,6 +1335,11 @@ modulemd_module_stream_v2_replace_demodularized_rpms (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   MODULEMD_REPLACE_SET (self->demodularized_rpms, set);
 }
 
@@ -1104,6 +1355,11 @@ modulemd_module_stream_v2_remove_demodularized_rpm (
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove (self->demodularized_rpms, rpm);
 }
 
@@ -1114,6 +1370,11 @@ modulemd_module_stream_v2_clear_demodularized_rpms (
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->demodularized_rpms);
 }
 
@@ -1127,6 +1388,29 @@ modulemd_module_stream_v2_get_demodularized_rpms (ModulemdModuleStreamV2 *self)
 }
 
 
+/*
+ * modulemd_module_stream_v2_take_servicelevel:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @servicelevel: (in) (transfer full): A #ModulemdServiceLevel to store in
+ * @self without copying it.
+ */
+static void
+modulemd_module_stream_v2_take_servicelevel (
+  ModulemdModuleStreamV2 *self, ModulemdServiceLevel *servicelevel)
+{
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_clear_object (&servicelevel);
+      return;
+    }
+
+  g_hash_table_replace (
+    self->servicelevels,
+    g_strdup (modulemd_service_level_get_name (servicelevel)),
+    servicelevel);
+}
+
+
 void
 modulemd_module_stream_v2_add_servicelevel (ModulemdModuleStreamV2 *self,
                                             ModulemdServiceLevel *servicelevel)
@@ -1138,10 +1422,8 @@ modulemd_module_stream_v2_add_servicelevel (ModulemdModuleStreamV2 *self,
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
   g_return_if_fail (MODULEMD_IS_SERVICE_LEVEL (servicelevel));
 
-  g_hash_table_replace (
-    self->servicelevels,
-    g_strdup (modulemd_service_level_get_name (servicelevel)),
-    modulemd_service_level_copy (servicelevel));
+  modulemd_module_stream_v2_take_servicelevel (
+    self, modulemd_service_level_copy (servicelevel));
 }
 
 
@@ -1150,6 +1432,11 @@ modulemd_module_stream_v2_clear_servicelevels (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_hash_table_remove_all (self->servicelevels);
 }
 
@@ -1174,13 +1461,34 @@ modulemd_module_stream_v2_get_servicelevel (ModulemdModuleStreamV2 *self,
 }
 
 
+/*
+ * modulemd_module_stream_v2_take_dependencies:
+ * @self: (in): This #ModulemdModuleStreamV2 object.
+ * @deps: (in) (transfer full): A #ModulemdDependencies object to append to
+ * @self without copying it.
+ */
+static void
+modulemd_module_stream_v2_take_dependencies (ModulemdModuleStreamV2 *self,
+                                             ModulemdDependencies *deps)
+{
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      g_clear_object (&deps);
+      return;
+    }
+
+  g_ptr_array_add (self->dependencies, deps);
+}
+
+
 void
 modulemd_module_stream_v2_add_dependencies (ModulemdModuleStreamV2 *self,
                                             ModulemdDependencies *deps)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
-  g_ptr_array_add (self->dependencies, modulemd_dependencies_copy (deps));
+  modulemd_module_stream_v2_take_dependencies (
+    self, modulemd_dependencies_copy (deps));
 }
 
 
@@ -1191,6 +1499,11 @@ modulemd_module_stream_v2_replace_dependencies (ModulemdModuleStreamV2 *self,
   gsize i;
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   for (i = 0; i < array->len; i++)
     {
       modulemd_module_stream_v2_add_dependencies (
@@ -1204,6 +1517,11 @@ modulemd_module_stream_v2_clear_dependencies (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_ptr_array_set_size (self->dependencies, 0);
 }
 
@@ -1223,6 +1541,11 @@ modulemd_module_stream_v2_remove_dependencies (ModulemdModuleStreamV2 *self,
   guint index;
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   while (g_ptr_array_find_with_equal_func (
     self->dependencies, deps, dep_equal_wrapper, &index))
     {
@@ -1245,6 +1568,11 @@ modulemd_module_stream_v2_set_xmd (ModulemdModuleStreamV2 *self, GVariant *xmd)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   /* Do nothing if we were passed the same pointer */
   if (self->xmd == xmd)
     {
@@ -1268,6 +1596,11 @@ modulemd_module_stream_v2_clear_xmd (ModulemdModuleStreamV2 *self)
 {
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
 
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->xmd, g_variant_unref);
 }
 
@@ -1287,6 +1620,11 @@ modulemd_module_stream_v2_includes_nevra (ModulemdModuleStreamV2 *self,
 void
 modulemd_module_stream_v2_set_static_context (ModulemdModuleStreamV2 *self)
 {
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   self->static_context = TRUE;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_STATIC_CONTEXT]);
@@ -1296,6 +1634,11 @@ modulemd_module_stream_v2_set_static_context (ModulemdModuleStreamV2 *self)
 void
 modulemd_module_stream_v2_unset_static_context (ModulemdModuleStreamV2 *self)
 {
+  if (!modulemd_module_stream_will_change (MODULEMD_MODULE_STREAM (self)))
+    {
+      return;
+    }
+
   self->static_context = FALSE;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_STATIC_CONTEXT]);
@@ -1577,7 +1920,6 @@ copy_rpm_artifact_map (ModulemdModuleStreamV2 *from,
   gpointer outer_value;
   gpointer inner_key;
   gpointer inner_value;
-  GHashTable *to_digest_table = NULL;
 
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (from));
   g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (to));
@@ -1585,14 +1927,14 @@ copy_rpm_artifact_map (ModulemdModuleStreamV2 *from,
   g_hash_table_iter_init (&outer, from->rpm_artifact_map);
   while (g_hash_table_iter_next (&outer, &outer_key, &outer_value))
     {
-      to_digest_table = get_or_create_digest_table (to, outer_key);
-
       g_hash_table_iter_init (&inner, (GHashTable *)outer_value);
       while (g_hash_table_iter_next (&inner, &inner_key, &inner_value))
         {
-          g_hash_table_insert (to_digest_table,
-                               g_strdup (inner_key),
-                               modulemd_rpm_map_entry_copy (inner_value));
+          modulemd_module_stream_v2_take_rpm_artifact_map_entry (
+            to,
+            modulemd_rpm_map_entry_copy (inner_value),
+            outer_key,
+            inner_key);
         }
     }
 }
@@ -1614,11 +1956,15 @@ modulemd_module_stream_v2_copy (ModulemdModuleStream *self,
   /* Properties */
   STREAM_COPY_IF_SET (v2, copy, v2_self, arch);
   STREAM_COPY_IF_SET (v2, copy, v2_self, buildopts);
-  STREAM_COPY_IF_SET (v2, copy, v2_self, community);
-  STREAM_COPY_IF_SET_WITH_LOCALE (v2, copy, v2_self, description);
-  STREAM_COPY_IF_SET (v2, copy, v2_self, documentation);
-  STREAM_COPY_IF_SET_WITH_LOCALE (v2, copy, v2_self, summary);
-  STREAM_COPY_IF_SET (v2, copy, v2_self, tracker);
+
+  /* The copy is not visible to anyone yet, so there is no need to go through
+   * the setters and their property notifications.
+   */
+  copy->community = g_strdup (v2_self->community);
+  copy->description = g_strdup (v2_self->description);
+  copy->documentation = g_strdup (v2_self->documentation);
+  copy->summary = g_strdup (v2_self->summary);
+  copy->tracker = g_strdup (v2_self->tracker);
   copy->static_context = v2_self->static_context;
 
   /* Internal Data Structures: With replace function */
@@ -1789,28 +2135,22 @@ modulemd_module_stream_v2_init (ModulemdModuleStreamV2 *self)
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
 
-  self->content_licenses =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-  self->module_licenses =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->content_licenses = modulemd_str_set_new ();
+  self->module_licenses = modulemd_str_set_new ();
 
-  self->profiles =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  self->profiles = g_hash_table_new_full (
+    g_str_hash, g_str_equal, g_free, modulemd_profile_disown);
 
-  self->rpm_api =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_api = modulemd_str_set_new ();
 
-  self->rpm_artifacts =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_artifacts = modulemd_str_set_new ();
 
   self->rpm_artifact_map = g_hash_table_new_full (
     g_str_hash, g_str_equal, g_free, modulemd_hash_table_unref);
 
-  self->rpm_filters =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_filters = modulemd_str_set_new ();
 
-  self->demodularized_rpms =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->demodularized_rpms = modulemd_str_set_new ();
 
   self->servicelevels =
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
@@ -1921,10 +2261,10 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
           if (g_str_equal ((const gchar *)event.data.scalar.value, "name") &&
               !only_packager)
             {
-              MMD_SET_PARSED_YAML_STRING (
+              MMD_TAKE_PARSED_YAML_STRING (
                 &parser,
                 error,
-                modulemd_module_stream_set_module_name,
+                modulemd_module_stream_take_module_name,
                 MODULEMD_MODULE_STREAM (modulestream));
             }
 
@@ -1933,10 +2273,10 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                                 "stream") &&
                    !only_packager)
             {
-              MMD_SET_PARSED_YAML_STRING (
+              MMD_TAKE_PARSED_YAML_STRING (
                 &parser,
                 error,
-                modulemd_module_stream_set_stream_name,
+                modulemd_module_stream_take_stream_name,
                 MODULEMD_MODULE_STREAM (modulestream));
             }
 
@@ -1961,10 +2301,10 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                                 "context") &&
                    !only_packager)
             {
-              MMD_SET_PARSED_YAML_STRING (
+              MMD_TAKE_PARSED_YAML_STRING (
                 &parser,
                 error,
-                modulemd_module_stream_set_context,
+                modulemd_module_stream_take_context,
                 MODULEMD_MODULE_STREAM (modulestream));
             }
 
@@ -1979,15 +2319,7 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                   return NULL;
                 }
 
-              if (static_context)
-                {
-                  modulemd_module_stream_v2_set_static_context (modulestream);
-                }
-              else
-                {
-                  modulemd_module_stream_v2_unset_static_context (
-                    modulestream);
-                }
+              modulestream->static_context = static_context;
             }
 
           /* Module Artifact Architecture */
@@ -1995,32 +2327,27 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                                 "arch") &&
                    !only_packager)
             {
-              MMD_SET_PARSED_YAML_STRING (&parser,
-                                          error,
-                                          modulemd_module_stream_v2_set_arch,
-                                          modulestream);
+              MMD_TAKE_PARSED_YAML_STRING (
+                &parser,
+                error,
+                modulemd_module_stream_take_arch,
+                MODULEMD_MODULE_STREAM (modulestream));
             }
 
           /* Module Summary */
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "summary"))
             {
-              MMD_SET_PARSED_YAML_STRING (
-                &parser,
-                error,
-                modulemd_module_stream_v2_set_summary,
-                modulestream);
+              MMD_STORE_PARSED_YAML_STRING (
+                &parser, error, modulestream->summary);
             }
 
           /* Module Description */
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "description"))
             {
-              MMD_SET_PARSED_YAML_STRING (
-                &parser,
-                error,
-                modulemd_module_stream_v2_set_description,
-                modulestream);
+              MMD_STORE_PARSED_YAML_STRING (
+                &parser, error, modulestream->description);
             }
 
           /* Service Levels */
@@ -2107,8 +2434,7 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_module_stream_v2_replace_rpm_api (modulestream, set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->rpm_api, set);
             }
 
           /* Filter */
@@ -2117,9 +2443,7 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_module_stream_v2_replace_rpm_filters (modulestream,
-                                                             set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->rpm_filters, set);
             }
 
           /* Demodularized Packages */
@@ -2128,9 +2452,7 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_module_stream_v2_replace_demodularized_rpms (
-                modulestream, set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->demodularized_rpms, set);
             }
 
           /* Build Options */
@@ -2146,9 +2468,8 @@ modulemd_module_stream_v2_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                   return NULL;
                 }
 
-              modulemd_module_stream_v2_set_buildopts (modulestream,
-                                                       buildopts);
-              g_clear_object (&buildopts);
+              modulemd_module_stream_v2_take_buildopts (
+                modulestream, g_steal_pointer (&buildopts));
             }
 
           /* Components */
@@ -2261,18 +2582,14 @@ modulemd_module_stream_v2_parse_licenses (yaml_parser_t *parser,
                   g_propagate_error (error, g_steal_pointer (&nested_error));
                   return FALSE;
                 }
-              modulemd_module_stream_v2_replace_module_licenses (modulestream,
-                                                                 set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->module_licenses, set);
             }
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
                                 "content") &&
                    !only_packager)
             {
               set = modulemd_yaml_parse_string_set (parser, &nested_error);
-              modulemd_module_stream_v2_replace_content_licenses (modulestream,
-                                                                  set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->content_licenses, set);
             }
           else
             {
@@ -2361,8 +2678,8 @@ modulemd_module_stream_v2_parse_servicelevels (
               return FALSE;
             }
 
-          modulemd_module_stream_v2_add_servicelevel (modulestream, sl);
-          g_clear_object (&sl);
+          modulemd_module_stream_v2_take_servicelevel (modulestream,
+                                                       g_steal_pointer (&sl));
 
           break;
 
@@ -2423,8 +2740,8 @@ modulemd_module_stream_v2_parse_deps (yaml_parser_t *parser,
               return FALSE;
             }
 
-          modulemd_module_stream_v2_add_dependencies (modulestream, deps);
-          g_clear_object (&deps);
+          modulemd_module_stream_v2_take_dependencies (
+            modulestream, g_steal_pointer (&deps));
           break;
 
         default:
@@ -2487,8 +2804,8 @@ modulemd_module_stream_v2_parse_refs (yaml_parser_t *parser,
                   return FALSE;
                 }
 
-              modulemd_module_stream_v2_set_community (modulestream, scalar);
-              g_clear_pointer (&scalar, g_free);
+              g_free (modulestream->community);
+              modulestream->community = g_steal_pointer (&scalar);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
@@ -2501,9 +2818,8 @@ modulemd_module_stream_v2_parse_refs (yaml_parser_t *parser,
                   return FALSE;
                 }
 
-              modulemd_module_stream_v2_set_documentation (modulestream,
-                                                           scalar);
-              g_clear_pointer (&scalar, g_free);
+              g_free (modulestream->documentation);
+              modulestream->documentation = g_steal_pointer (&scalar);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
@@ -2516,8 +2832,8 @@ modulemd_module_stream_v2_parse_refs (yaml_parser_t *parser,
                   return FALSE;
                 }
 
-              modulemd_module_stream_v2_set_tracker (modulestream, scalar);
-              g_clear_pointer (&scalar, g_free);
+              g_free (modulestream->tracker);
+              modulestream->tracker = g_steal_pointer (&scalar);
             }
 
           else
@@ -2591,8 +2907,8 @@ modulemd_module_stream_v2_parse_profiles (yaml_parser_t *parser,
               return FALSE;
             }
 
-          modulemd_module_stream_v2_add_profile (modulestream, profile);
-          g_clear_pointer (&profile, g_object_unref);
+          modulemd_module_stream_v2_take_profile (modulestream,
+                                                  g_steal_pointer (&profile));
           break;
 
         default:
@@ -2751,9 +3067,8 @@ modulemd_module_stream_v2_parse_rpm_components (
               g_propagate_error (error, g_steal_pointer (&nested_error));
               return FALSE;
             }
-          modulemd_module_stream_v2_add_component (
-            modulestream, (ModulemdComponent *)component);
-          g_clear_pointer (&component, g_object_unref);
+          modulemd_module_stream_v2_take_component (
+            modulestream, (ModulemdComponent *)g_steal_pointer (&component));
           break;
 
         default:
@@ -2816,9 +3131,8 @@ modulemd_module_stream_v2_parse_module_components (
               g_propagate_error (error, g_steal_pointer (&nested_error));
               return FALSE;
             }
-          modulemd_module_stream_v2_add_component (
-            modulestream, (ModulemdComponent *)component);
-          g_clear_pointer (&component, g_object_unref);
+          modulemd_module_stream_v2_take_component (
+            modulestream, (ModulemdComponent *)g_steal_pointer (&component));
           break;
 
         default:
@@ -2887,9 +3201,7 @@ modulemd_module_stream_v2_parse_artifacts (
                   return FALSE;
                 }
 
-              modulemd_module_stream_v2_replace_rpm_artifacts (modulestream,
-                                                               set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (modulestream->rpm_artifacts, set);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
@@ -3042,10 +3354,8 @@ modulemd_module_stream_v2_parse_rpm_map_digest (
               return FALSE;
             }
 
-          modulemd_module_stream_v2_set_rpm_artifact_map_entry (
-            modulestream, entry, digest, checksum);
-
-          g_clear_object (&entry);
+          modulemd_module_stream_v2_take_rpm_artifact_map_entry (
+            modulestream, g_steal_pointer (&entry), digest, checksum);
           break;
 
         default:
@@ -3080,7 +3390,7 @@ modulemd_module_stream_v2_emit_yaml (ModulemdModuleStreamV2 *self,
 
   if (modulemd_module_stream_v2_is_static_context (self))
     {
-      EMIT_KEY_VALUE (emitter, error, "static_context", "true");
+      EMIT_KEY_VALUE_BOOLEAN (emitter, error, "static_context", TRUE);
     }
 
   EMIT_KEY_VALUE_STRING_IF_SET (
@@ -3247,8 +3557,7 @@ modulemd_module_stream_v2_emit_rpm_map (ModulemdModuleStreamV2 *self,
       return TRUE;
     }
 
-  digests =
-    modulemd_ordered_str_keys (self->rpm_artifact_map, modulemd_strcmp_sort);
+  digests = modulemd_sorted_str_keys (self->rpm_artifact_map);
 
   EMIT_SCALAR (emitter, error, "rpm-map");
   EMIT_MAPPING_START (emitter, error);
@@ -3262,10 +3571,9 @@ modulemd_module_stream_v2_emit_rpm_map (ModulemdModuleStreamV2 *self,
 
       EMIT_MAPPING_START (emitter, error);
 
-      checksums =
-        modulemd_ordered_str_keys (digest_table, modulemd_strcmp_sort);
+      checksums = modulemd_sorted_str_keys (digest_table);
 
-      for (guint j = 0; j < digests->len; j++)
+      for (guint j = 0; j < checksums->len; j++)
         {
           checksum = g_ptr_array_index (checksums, j);
           EMIT_SCALAR (emitter, error, checksum);
@@ -3287,3 +3595,276 @@ modulemd_module_stream_v2_emit_rpm_map (ModulemdModuleStreamV2 *self,
 
   return TRUE;
 }
+
+
+void
+modulemd_module_stream_v2_add_memory_usage (ModulemdModuleStreamV2 *self,
+                                            ModulemdMemoryUsage *usage)
+{
+  GHashTableIter iter;
+  GHashTableIter entry_iter;
+  gpointer key;
+  gpointer value;
+  gpointer entry_key;
+  gpointer entry_value;
+  gboolean has_artifacts;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
+
+  modulemd_module_stream_add_memory_usage (MODULEMD_MODULE_STREAM (self),
+                                           usage);
+  if (self->buildopts)
+    {
+      modulemd_buildopts_add_memory_usage (self->buildopts, usage);
+    }
+  modulemd_memory_usage_add_string (usage, self->community);
+  modulemd_memory_usage_add_string (usage, self->description);
+  modulemd_memory_usage_add_string (usage, self->documentation);
+  modulemd_memory_usage_add_string (usage, self->summary);
+  modulemd_memory_usage_add_string (usage, self->tracker);
+
+  modulemd_memory_usage_add_hash_table (usage, self->rpm_components);
+  g_hash_table_iter_init (&iter, self->rpm_components);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_component_rpm_add_memory_usage (MODULEMD_COMPONENT_RPM (value),
+                                               usage);
+    }
+
+  modulemd_memory_usage_add_hash_table (usage, self->module_components);
+  g_hash_table_iter_init (&iter, self->module_components);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_component_module_add_memory_usage (
+        MODULEMD_COMPONENT_MODULE (value), usage);
+    }
+
+  modulemd_memory_usage_add_string_set (usage, self->content_licenses);
+  modulemd_memory_usage_add_string_set (usage, self->module_licenses);
+
+  modulemd_memory_usage_add_hash_table (usage, self->profiles);
+  g_hash_table_iter_init (&iter, self->profiles);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_profile_add_memory_usage (MODULEMD_PROFILE (value), usage);
+    }
+
+  modulemd_memory_usage_add_string_set (usage, self->rpm_api);
+  modulemd_memory_usage_add_string_set (usage, self->rpm_filters);
+
+  modulemd_memory_usage_add_hash_table (usage, self->servicelevels);
+  g_hash_table_iter_init (&iter, self->servicelevels);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_service_level_add_memory_usage (
+        MODULEMD_SERVICE_LEVEL (value), usage);
+    }
+
+  modulemd_memory_usage_add_variant (usage, self->xmd);
+
+  modulemd_memory_usage_add_string_set (usage, self->demodularized_rpms);
+
+  modulemd_memory_usage_add_ptr_array (usage, self->dependencies);
+  for (guint i = 0; i < self->dependencies->len; i++)
+    {
+      modulemd_dependencies_add_memory_usage (
+        g_ptr_array_index (self->dependencies, i), usage);
+    }
+
+  /* The empty tables of a stream without artifacts are plain containers */
+  has_artifacts = g_hash_table_size (self->rpm_artifacts) > 0 ||
+                  g_hash_table_size (self->rpm_artifact_map) > 0;
+  if (has_artifacts)
+    {
+      modulemd_memory_usage_push_section (usage,
+                                          MD_MEMORY_CATEGORY_ARTIFACTS);
+    }
+  modulemd_memory_usage_add_string_set (usage, self->rpm_artifacts);
+
+  /* Maps each digest type to a table of checksums to entries */
+  modulemd_memory_usage_add_hash_table (usage, self->rpm_artifact_map);
+  g_hash_table_iter_init (&iter, self->rpm_artifact_map);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_memory_usage_add_hash_table (usage, value);
+
+      g_hash_table_iter_init (&entry_iter, value);
+      while (g_hash_table_iter_next (&entry_iter, &entry_key, &entry_value))
+        {
+          modulemd_memory_usage_add_string (usage, entry_key);
+          modulemd_rpm_map_entry_add_memory_usage (
+            MODULEMD_RPM_MAP_ENTRY (entry_value), usage);
+        }
+    }
+  if (has_artifacts)
+    {
+      modulemd_memory_usage_pop_section (usage);
+    }
+}
+
+
+guint64
+modulemd_module_stream_v2_get_objects_generation (ModulemdModuleStreamV2 *self)
+{
+  GHashTableIter iter;
+  GHashTableIter entry_iter;
+  gpointer value;
+  gpointer entry_value;
+  guint64 generation = 0;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self), 0);
+
+  if (self->buildopts)
+    {
+      generation = modulemd_buildopts_get_generation (self->buildopts);
+    }
+
+  g_hash_table_iter_init (&iter, self->rpm_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation =
+        MAX (generation, modulemd_component_get_generation (value));
+    }
+
+  g_hash_table_iter_init (&iter, self->module_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation =
+        MAX (generation, modulemd_component_get_generation (value));
+    }
+
+  g_hash_table_iter_init (&iter, self->profiles);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation = MAX (generation, modulemd_profile_get_generation (value));
+    }
+
+  g_hash_table_iter_init (&iter, self->servicelevels);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      generation =
+        MAX (generation, modulemd_service_level_get_generation (value));
+    }
+
+  for (guint i = 0; i < self->dependencies->len; i++)
+    {
+      value = g_ptr_array_index (self->dependencies, i);
+      generation =
+        MAX (generation, modulemd_dependencies_get_generation (value));
+    }
+
+  g_hash_table_iter_init (&iter, self->rpm_artifact_map);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      g_hash_table_iter_init (&entry_iter, value);
+      while (g_hash_table_iter_next (&entry_iter, NULL, &entry_value))
+        {
+          generation = MAX (
+            generation, modulemd_rpm_map_entry_get_generation (entry_value));
+        }
+    }
+
+  return generation;
+}
+
+
+void
+modulemd_module_stream_v2_compact (ModulemdModuleStreamV2 *self,
+                                   ModulemdCompactor *compactor)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
+
+  if (self->buildopts)
+    {
+      modulemd_buildopts_compact (self->buildopts, compactor);
+    }
+
+  g_hash_table_iter_init (&iter, self->rpm_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_component_rpm_compact (MODULEMD_COMPONENT_RPM (value),
+                                      compactor);
+    }
+
+  g_hash_table_iter_init (&iter, self->module_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_component_compact (MODULEMD_COMPONENT (value), compactor);
+    }
+
+  for (guint i = 0; i < self->dependencies->len; i++)
+    {
+      modulemd_dependencies_compact (
+        g_ptr_array_index (self->dependencies, i), compactor);
+    }
+
+  g_hash_table_iter_init (&iter, self->profiles);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_profile_compact (MODULEMD_PROFILE (value), compactor);
+    }
+}
+
+
+void
+modulemd_module_stream_v2_freeze_objects (ModulemdModuleStreamV2 *self)
+{
+  GHashTableIter iter;
+  GHashTableIter entry_iter;
+  gpointer value;
+  gpointer entry_value;
+
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM_V2 (self));
+
+  if (self->buildopts)
+    {
+      modulemd_buildopts_freeze (self->buildopts);
+    }
+
+  g_hash_table_iter_init (&iter, self->rpm_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_component_freeze (value);
+    }
+
+  g_hash_table_iter_init (&iter, self->module_components);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_component_freeze (value);
+    }
+
+  g_hash_table_iter_init (&iter, self->profiles);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_profile_freeze (value);
+    }
+
+  g_hash_table_iter_init (&iter, self->servicelevels);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_service_level_freeze (value);
+    }
+
+  for (guint i = 0; i < self->dependencies->len; i++)
+    {
+      modulemd_dependencies_freeze (g_ptr_array_index (self->dependencies, i));
+    }
+
+  g_hash_table_iter_init (&iter, self->rpm_artifact_map);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      g_hash_table_iter_init (&entry_iter, value);
+      while (g_hash_table_iter_next (&entry_iter, NULL, &entry_value))
+        {
+          modulemd_rpm_map_entry_freeze (entry_value);
+        }
+    }
+}
@@ -20,6 +20,7 @@
 #include "modulemd-packager-v3.h"
 #include "private/glib-extensions.h"
 #include "private/modulemd-component-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-module-private.h"
 #include "private/modulemd-module-stream-private.h"
 #include "private/modulemd-module-stream-v1-private.h"
@@ -39,8 +40,31 @@ typedef struct
   gchar *context;
   gchar *arch;
   ModulemdTranslation *translation;
+
+  /* Set from modulemd_next_generation () by
+   * modulemd_module_stream_will_change(). The stream is known to be valid
+   * while validated_generation is what modulemd_module_stream_get_generation
+   * () returns, which also covers the objects stored in the stream.
+   */
+  guint64 generation;
+  guint64 validated_generation;
+
+  /* Set by modulemd_module_stream_freeze(); nothing may change afterwards */
+  gboolean frozen;
+
+  /* The content digest stored by modulemd_module_stream_set_digest (), valid
+   * while digest_generation is what modulemd_module_stream_get_generation ()
+   * returns. Protected by digest_lock.
+   */
+  gchar *digest;
+  guint64 digest_generation;
 } ModulemdModuleStreamPrivate;
 
+/* The digests of the streams of a frozen index may be computed and stored by
+ * several threads at once.
+ */
+static GMutex digest_lock;
+
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ModulemdModuleStream,
                                      modulemd_module_stream,
                                      G_TYPE_OBJECT)
@@ -348,11 +372,12 @@ modulemd_module_stream_finalize (GObject *object)
   ModulemdModuleStreamPrivate *priv =
     modulemd_module_stream_get_instance_private (self);
 
-  g_clear_pointer (&priv->module_name, g_free);
-  g_clear_pointer (&priv->stream_name, g_free);
+  g_clear_pointer (&priv->module_name, modulemd_str_release);
+  g_clear_pointer (&priv->stream_name, modulemd_str_release);
   g_clear_pointer (&priv->context, g_free);
-  g_clear_pointer (&priv->arch, g_free);
+  g_clear_pointer (&priv->arch, modulemd_str_release);
   g_clear_object (&priv->translation);
+  g_clear_pointer (&priv->digest, g_free);
 
   G_OBJECT_CLASS (modulemd_module_stream_parent_class)->finalize (object);
 }
@@ -464,8 +489,8 @@ modulemd_module_stream_default_copy (ModulemdModuleStream *self,
 
   modulemd_module_stream_set_version (
     copy, modulemd_module_stream_get_version (self));
-  modulemd_module_stream_set_context (
-    copy, modulemd_module_stream_get_context (self));
+  modulemd_module_stream_take_context (
+    copy, g_strdup (modulemd_module_stream_get_context (self)));
   modulemd_module_stream_associate_translation (
     copy, modulemd_module_stream_get_translation (self));
 
@@ -990,9 +1015,17 @@ modulemd_module_stream_set_module_name (ModulemdModuleStream *self,
 
   ModulemdModuleStreamPrivate *priv =
     modulemd_module_stream_get_instance_private (self);
+  gchar *interned = NULL;
+
+  if (!modulemd_module_stream_will_change (self))
+    {
+      return;
+    }
 
-  g_clear_pointer (&priv->module_name, g_free);
-  priv->module_name = g_strdup (module_name);
+  /* Equal names are shared by all streams instead of copied into each */
+  interned = modulemd_str_intern (module_name);
+  g_clear_pointer (&priv->module_name, modulemd_str_release);
+  priv->module_name = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODULE_NAME]);
 }
@@ -1018,9 +1051,16 @@ modulemd_module_stream_set_stream_name (ModulemdModuleStream *self,
 
   ModulemdModuleStreamPrivate *priv =
     modulemd_module_stream_get_instance_private (self);
+  gchar *interned = NULL;
 
-  g_clear_pointer (&priv->stream_name, g_free);
-  priv->stream_name = g_strdup (stream_name);
+  if (!modulemd_module_stream_will_change (self))
+    {
+      return;
+    }
+
+  interned = modulemd_str_intern (stream_name);
+  g_clear_pointer (&priv->stream_name, modulemd_str_release);
+  priv->stream_name = interned;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODULE_NAME]);
 }
@@ -1047,6 +1087,11 @@ modulemd_module_stream_set_version (ModulemdModuleStream *self,
   ModulemdModuleStreamPrivate *priv =
     modulemd_module_stream_get_instance_private (self);
 
+  if (!modulemd_module_stream_will_change (self))
+    {
+      return;
+    }
+
   priv->version = version;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_VERSION]);
@@ -1074,6 +1119,11 @@ modulemd_module_stream_set_context (ModulemdModuleStream *self,
   ModulemdModuleStreamPrivate *priv =
     modulemd_module_stream_get_instance_private (self);
 
+  if (!modulemd_module_stream_will_change (self))
+    {
+      return;
+    }
+
   g_clear_pointer (&priv->context, g_free);
   priv->context = g_strdup (context);
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CONTEXT]);
@@ -1099,13 +1149,74 @@ modulemd_module_stream_set_arch (ModulemdModuleStream *self, const gchar *arch)
 
   ModulemdModuleStreamPrivate *priv =
     modulemd_module_stream_get_instance_private (self);
+  gchar *interned = NULL;
+
+  if (!modulemd_module_stream_will_change (self))
+    {
+      return;
+    }
 
-  g_clear_pointer (&priv->arch, g_free);
-  priv->arch = g_strdup (arch);
+  interned = modulemd_str_intern (arch);
+  g_clear_pointer (&priv->arch, modulemd_str_release);
+  priv->arch = interned;
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_CONTEXT]);
 }
 
 
+/* Parsers fill in streams that have not been handed out yet, so nothing can
+ * be connected to their notify signal. These skip the type checks and
+ * notifications of the public setters and take the parsed strings as-is.
+ */
+void
+modulemd_module_stream_take_module_name (ModulemdModuleStream *self,
+                                         gchar *module_name)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  g_clear_pointer (&priv->module_name, modulemd_str_release);
+  priv->module_name = modulemd_str_intern (module_name);
+  g_free (module_name);
+}
+
+
+void
+modulemd_module_stream_take_stream_name (ModulemdModuleStream *self,
+                                         gchar *stream_name)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  g_clear_pointer (&priv->stream_name, modulemd_str_release);
+  priv->stream_name = modulemd_str_intern (stream_name);
+  g_free (stream_name);
+}
+
+
+void
+modulemd_module_stream_take_context (ModulemdModuleStream *self,
+                                     gchar *context)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  g_free (priv->context);
+  priv->context = context;
+}
+
+
+void
+modulemd_module_stream_take_arch (ModulemdModuleStream *self, gchar *arch)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  g_clear_pointer (&priv->arch, modulemd_str_release);
+  priv->arch = modulemd_str_intern (arch);
+  g_free (arch);
+}
+
+
 const gchar *
 modulemd_module_stream_get_arch (ModulemdModuleStream *self)
 {
@@ -1373,8 +1484,13 @@ modulemd_module_stream_class_init (ModulemdModuleStreamClass *klass)
 
 
 static void
-modulemd_module_stream_init (ModulemdModuleStream *UNUSED (self))
+modulemd_module_stream_init (ModulemdModuleStream *self)
 {
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  /* Not validated yet */
+  priv->generation = 1;
 }
 
 
@@ -1387,6 +1503,8 @@ modulemd_module_stream_associate_translation (ModulemdModuleStream *self,
   ModulemdModuleStreamPrivate *priv =
     modulemd_module_stream_get_instance_private (self);
 
+  g_return_if_fail (!priv->frozen);
+
   g_clear_pointer (&priv->translation, g_object_unref);
   if (translation != NULL)
     {
@@ -1442,13 +1560,6 @@ modulemd_module_stream_emit_yaml_base (ModulemdModuleStream *self,
                                        GError **error)
 {
   MODULEMD_INIT_TRACE ();
-  g_autofree gchar *version_string = NULL;
-
-  if (modulemd_module_stream_get_version (self) != 0)
-    {
-      version_string = g_strdup_printf (
-        "%" PRIu64, modulemd_module_stream_get_version (self));
-    }
 
   /* Emit document headers */
   if (!modulemd_yaml_emit_document_headers (
@@ -1484,7 +1595,11 @@ modulemd_module_stream_emit_yaml_base (ModulemdModuleStream *self,
                            YAML_DOUBLE_QUOTED_SCALAR_STYLE);
     }
 
-  EMIT_KEY_VALUE_IF_SET (emitter, error, "version", version_string);
+  if (modulemd_module_stream_get_version (self) != 0)
+    {
+      EMIT_KEY_VALUE_UINT64 (
+        emitter, error, "version", modulemd_module_stream_get_version (self));
+    }
   EMIT_KEY_VALUE_STRING_IF_SET (
     emitter, error, "context", modulemd_module_stream_get_context (self));
 
@@ -1627,3 +1742,180 @@ modulemd_module_stream_clear_autogen_stream_name (ModulemdModuleStream *self)
       modulemd_module_stream_set_stream_name (self, NULL);
     }
 }
+
+
+gboolean
+modulemd_module_stream_will_change (ModulemdModuleStream *self)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  /* Other threads may be reading the streams of a frozen index */
+  g_return_val_if_fail (!priv->frozen, FALSE);
+
+  priv->generation = modulemd_next_generation ();
+
+  return TRUE;
+}
+
+
+void
+modulemd_module_stream_freeze (ModulemdModuleStream *self)
+{
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM (self));
+
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  if (MODULEMD_IS_MODULE_STREAM_V2 (self))
+    {
+      modulemd_module_stream_v2_freeze_objects (
+        MODULEMD_MODULE_STREAM_V2 (self));
+    }
+  else if (MODULEMD_IS_MODULE_STREAM_V1 (self))
+    {
+      modulemd_module_stream_v1_freeze_objects (
+        MODULEMD_MODULE_STREAM_V1 (self));
+    }
+
+  if (priv->digest_generation != modulemd_module_stream_get_generation (self))
+    {
+      g_clear_pointer (&priv->digest, g_free);
+    }
+
+  priv->frozen = TRUE;
+}
+
+
+gboolean
+modulemd_module_stream_is_frozen (ModulemdModuleStream *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE_STREAM (self), FALSE);
+
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  return priv->frozen;
+}
+
+
+guint64
+modulemd_module_stream_get_own_generation (ModulemdModuleStream *self)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  return priv->generation;
+}
+
+
+guint64
+modulemd_module_stream_get_generation (ModulemdModuleStream *self)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+  guint64 objects = 0;
+
+  /* Changing an object stored in the stream does not mark the stream itself
+   * as modified, since objects do not know which streams hold them.
+   */
+  if (MODULEMD_IS_MODULE_STREAM_V2 (self))
+    {
+      objects = modulemd_module_stream_v2_get_objects_generation (
+        MODULEMD_MODULE_STREAM_V2 (self));
+    }
+  else if (MODULEMD_IS_MODULE_STREAM_V1 (self))
+    {
+      objects = modulemd_module_stream_v1_get_objects_generation (
+        MODULEMD_MODULE_STREAM_V1 (self));
+    }
+
+  return MAX (priv->generation, objects);
+}
+
+
+void
+modulemd_module_stream_mark_validated (ModulemdModuleStream *self)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  priv->validated_generation = modulemd_module_stream_get_generation (self);
+}
+
+
+gboolean
+modulemd_module_stream_is_validated (ModulemdModuleStream *self)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  return priv->validated_generation ==
+         modulemd_module_stream_get_generation (self);
+}
+
+
+gchar *
+modulemd_module_stream_dup_digest (ModulemdModuleStream *self)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+  guint64 generation = 0;
+  gchar *digest = NULL;
+
+  /* modulemd_module_stream_freeze () dropped any digest that was outdated,
+   * and nothing can change afterwards.
+   */
+  if (!priv->frozen)
+    {
+      generation = modulemd_module_stream_get_generation (self);
+    }
+
+  g_mutex_lock (&digest_lock);
+  if (priv->digest && (priv->frozen || priv->digest_generation == generation))
+    {
+      digest = g_strdup (priv->digest);
+    }
+  g_mutex_unlock (&digest_lock);
+
+  return digest;
+}
+
+
+void
+modulemd_module_stream_set_digest (ModulemdModuleStream *self,
+                                   const gchar *digest)
+{
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+  guint64 generation = modulemd_module_stream_get_generation (self);
+
+  g_mutex_lock (&digest_lock);
+  g_clear_pointer (&priv->digest, g_free);
+  priv->digest = g_strdup (digest);
+  priv->digest_generation = generation;
+  g_mutex_unlock (&digest_lock);
+}
+
+
+void
+modulemd_module_stream_add_memory_usage (ModulemdModuleStream *self,
+                                         ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_MODULE_STREAM (self));
+
+  ModulemdModuleStreamPrivate *priv =
+    modulemd_module_stream_get_instance_private (self);
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add (
+    usage, MD_MEMORY_CATEGORY_OBJECTS, sizeof (ModulemdModuleStreamPrivate));
+  modulemd_memory_usage_add_interned_string (usage, priv->module_name);
+  modulemd_memory_usage_add_interned_string (usage, priv->stream_name);
+  modulemd_memory_usage_add_string (usage, priv->context);
+  modulemd_memory_usage_add_interned_string (usage, priv->arch);
+
+  g_mutex_lock (&digest_lock);
+  modulemd_memory_usage_add_string (usage, priv->digest);
+  g_mutex_unlock (&digest_lock);
+}
@@ -18,8 +18,13 @@
 #include "modulemd-errors.h"
 #include "modulemd-module.h"
 #include "private/glib-extensions.h"
+#include "private/modulemd-defaults-private.h"
+#include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-module-private.h"
 #include "private/modulemd-module-stream-private.h"
+#include "private/modulemd-module-stream-v1-private.h"
+#include "private/modulemd-module-stream-v2-private.h"
 #include "private/modulemd-translation-private.h"
 #include "private/modulemd-obsoletes-private.h"
 #include "private/modulemd-util.h"
@@ -33,8 +38,21 @@ struct _ModulemdModule
 
   GPtrArray *streams;
   ModulemdDefaults *defaults;
+
+  /* Borrowed pointers to the entries of streams, sorted with
+   * compare_streams(). Built on demand and dropped whenever streams changes.
+   */
+  GPtrArray *sorted_streams;
+  /* The sum of the stream generations when sorted_streams was built. Stream
+   * generations only increase, so a different sum means that one of the
+   * streams was modified and may sort differently.
+   */
+  guint64 sorted_generations;
   GHashTable *translations;
   GPtrArray *obsoletes;
+
+  /* Set by modulemd_module_freeze(); nothing may change afterwards */
+  gboolean frozen;
 };
 
 G_DEFINE_TYPE (ModulemdModule, modulemd_module, G_TYPE_OBJECT)
@@ -101,6 +119,7 @@ modulemd_module_finalize (GObject *object)
   g_clear_pointer (&self->module_name, g_free);
   g_clear_object (&self->defaults);
   g_clear_pointer (&self->streams, g_ptr_array_unref);
+  g_clear_pointer (&self->sorted_streams, g_ptr_array_unref);
   g_clear_pointer (&self->translations, g_hash_table_unref);
   g_clear_pointer (&self->obsoletes, g_ptr_array_unref);
 
@@ -197,6 +216,28 @@ modulemd_module_init (ModulemdModule *self)
 }
 
 
+static void
+invalidate_sorted_streams (ModulemdModule *self)
+{
+  g_clear_pointer (&self->sorted_streams, g_ptr_array_unref);
+}
+
+
+static guint64
+sum_stream_generations (ModulemdModule *self)
+{
+  guint64 sum = 0;
+
+  for (guint i = 0; i < self->streams->len; i++)
+    {
+      sum += modulemd_module_stream_get_own_generation (
+        g_ptr_array_index (self->streams, i));
+    }
+
+  return sum;
+}
+
+
 ModulemdDefaultsVersionEnum
 modulemd_module_set_defaults (ModulemdModule *self,
                               ModulemdDefaults *defaults,
@@ -206,6 +247,7 @@ modulemd_module_set_defaults (ModulemdModule *self,
   g_autoptr (ModulemdDefaults) upgraded_defaults = NULL;
   g_autoptr (GError) nested_error = NULL;
   g_return_val_if_fail (MODULEMD_IS_MODULE (self), MD_DEFAULTS_VERSION_ERROR);
+  g_return_val_if_fail (!self->frozen, MD_DEFAULTS_VERSION_ERROR);
 
   if (defaults == NULL)
     {
@@ -293,6 +335,7 @@ modulemd_module_add_stream (ModulemdModule *self,
 
   g_return_val_if_fail (MODULEMD_IS_MODULE (self),
                         MD_MODULESTREAM_VERSION_ERROR);
+  g_return_val_if_fail (!self->frozen, MD_MODULESTREAM_VERSION_ERROR);
   g_return_val_if_fail (MODULEMD_IS_MODULE_STREAM (stream),
                         MD_MODULESTREAM_VERSION_ERROR);
 
@@ -364,6 +407,7 @@ modulemd_module_add_stream (ModulemdModule *self,
         }
 
       /* First, drop the existing stream */
+      invalidate_sorted_streams (self);
       g_ptr_array_remove (self->streams, old);
       old = NULL;
     }
@@ -423,6 +467,7 @@ modulemd_module_add_stream (ModulemdModule *self,
     {
       newstream = g_ptr_array_index (allstreams, i);
 
+      invalidate_sorted_streams (self);
       g_ptr_array_add (self->streams, g_object_ref (newstream));
 
       translation = g_hash_table_lookup (
@@ -506,73 +551,138 @@ modulemd_module_get_stream_by_NSVC (ModulemdModule *self,
 }
 
 
+void
+modulemd_module_collect_streams_by_query (ModulemdModule *self,
+                                          ModulemdStreamQuery *query,
+                                          GPtrArray *matches)
+{
+  ModulemdModuleStream *under_consideration = NULL;
+
+  g_return_if_fail (MODULEMD_IS_MODULE (self));
+  g_return_if_fail (MODULEMD_IS_STREAM_QUERY (query));
+
+  for (guint i = 0; i < self->streams->len; i++)
+    {
+      under_consideration =
+        (ModulemdModuleStream *)g_ptr_array_index (self->streams, i);
+
+      if (modulemd_stream_query_matches (query, under_consideration))
+        {
+          g_ptr_array_add (matches, under_consideration);
+        }
+    }
+}
+
+
 GPtrArray *
-modulemd_module_search_streams_by_glob (ModulemdModule *self,
-                                        const gchar *stream_name,
-                                        const gchar *version,
-                                        const gchar *context,
-                                        const gchar *arch)
+modulemd_module_search_streams_by_query (ModulemdModule *self,
+                                         ModulemdStreamQuery *query)
 {
-  gsize i = 0;
   g_autoptr (GPtrArray) matching_streams = NULL;
-  ModulemdModuleStream *under_consideration = NULL;
-  g_autofree gchar *version_str = NULL;
 
   g_return_val_if_fail (MODULEMD_IS_MODULE (self), NULL);
+  g_return_val_if_fail (MODULEMD_IS_STREAM_QUERY (query), NULL);
 
   /* Assume the worst-case scenario that all streams match to spare us extra
    * mallocs.
    */
   matching_streams = g_ptr_array_sized_new (self->streams->len);
 
-  for (i = 0; i < self->streams->len; i++)
+  modulemd_module_collect_streams_by_query (self, query, matching_streams);
+
+  g_ptr_array_sort (matching_streams, compare_streams);
+
+  return g_steal_pointer (&matching_streams);
+}
+
+
+GPtrArray *
+modulemd_module_get_sorted_streams (ModulemdModule *self)
+{
+  guint64 generations = 0;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE (self), NULL);
+
+  /* The streams of a frozen module are frozen too, so their generations
+   * cannot have changed since the list was sorted by modulemd_module_freeze().
+   */
+  if (self->frozen)
     {
-      g_clear_pointer (&version_str, g_free);
-      under_consideration =
-        (ModulemdModuleStream *)g_ptr_array_index (self->streams, i);
+      return self->sorted_streams;
+    }
+
+  /* Setting the version or context of a stream changes its position */
+  generations = sum_stream_generations (self);
+  if (self->sorted_streams && self->sorted_generations != generations)
+    {
+      invalidate_sorted_streams (self);
+    }
 
-      /* Skip this one unless the stream name matches */
-      if (!modulemd_fnmatch (
-            stream_name,
-            modulemd_module_stream_get_stream_name (under_consideration)))
+  if (!self->sorted_streams)
+    {
+      self->sorted_streams = g_ptr_array_sized_new (self->streams->len);
+      for (guint i = 0; i < self->streams->len; i++)
         {
-          continue;
+          g_ptr_array_add (self->sorted_streams,
+                           g_ptr_array_index (self->streams, i));
         }
+      g_ptr_array_sort (self->sorted_streams, compare_streams);
+      self->sorted_generations = generations;
+    }
 
-      /* Skip this one unless the stream version matches OR the version is zero
-       * which indicates that it shouldn't prevent the other cases from
-       * matching.
-       */
-      if (version)
-        {
-          version_str = g_strdup_printf (
-            "%" PRIu64,
-            modulemd_module_stream_get_version (under_consideration));
+  return self->sorted_streams;
+}
 
-          if (!modulemd_fnmatch (version, version_str))
-            {
-              continue;
-            }
-        }
 
-      if (!modulemd_fnmatch (
-            context, modulemd_module_stream_get_context (under_consideration)))
+gboolean
+modulemd_module_foreach_stream (ModulemdModule *self,
+                                ModulemdStreamQuery *query,
+                                ModulemdModuleStreamFunc func,
+                                gpointer user_data)
+{
+  GPtrArray *sorted = NULL;
+  ModulemdModuleStream *stream = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE (self), FALSE);
+  g_return_val_if_fail (query == NULL || MODULEMD_IS_STREAM_QUERY (query),
+                        FALSE);
+  g_return_val_if_fail (func, FALSE);
+
+  sorted = modulemd_module_get_sorted_streams (self);
+  for (guint i = 0; i < sorted->len; i++)
+    {
+      stream = g_ptr_array_index (sorted, i);
+
+      if (query && !modulemd_stream_query_matches (query, stream))
         {
           continue;
         }
 
-      if (!modulemd_fnmatch (
-            arch, modulemd_module_stream_get_arch (under_consideration)))
+      if (!func (stream, user_data))
         {
-          continue;
+          return FALSE;
         }
-
-      g_ptr_array_add (matching_streams, under_consideration);
     }
 
-  g_ptr_array_sort (matching_streams, compare_streams);
+  return TRUE;
+}
 
-  return g_steal_pointer (&matching_streams);
+
+GPtrArray *
+modulemd_module_search_streams_by_glob (ModulemdModule *self,
+                                        const gchar *stream_name,
+                                        const gchar *version,
+                                        const gchar *context,
+                                        const gchar *arch)
+{
+  g_autoptr (ModulemdStreamQuery) query = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE (self), NULL);
+
+  query =
+    modulemd_stream_query_new (NULL, stream_name, version, context, arch);
+
+  return modulemd_module_search_streams_by_query (self, query);
 }
 
 
@@ -580,10 +690,8 @@ GPtrArray *
 modulemd_module_search_streams_by_nsvca_glob (ModulemdModule *self,
                                               const gchar *nsvca_pattern)
 {
-  gsize i = 0;
   g_autoptr (GPtrArray) matching_streams = NULL;
-  ModulemdModuleStream *under_consideration = NULL;
-  g_autofree gchar *nsvca = NULL;
+  g_autoptr (ModulemdStreamQuery) query = NULL;
 
   g_return_val_if_fail (MODULEMD_IS_MODULE (self), NULL);
 
@@ -592,18 +700,8 @@ modulemd_module_search_streams_by_nsvca_glob (ModulemdModule *self,
    */
   matching_streams = g_ptr_array_sized_new (self->streams->len);
 
-  for (i = 0; i < self->streams->len; i++)
-    {
-      under_consideration =
-        (ModulemdModuleStream *)g_ptr_array_index (self->streams, i);
-
-      nsvca = modulemd_module_stream_get_NSVCA_as_string (under_consideration);
-      if (nsvca_pattern == NULL || modulemd_fnmatch (nsvca_pattern, nsvca))
-        {
-          g_ptr_array_add (matching_streams, under_consideration);
-        }
-      g_clear_pointer (&nsvca, g_free);
-    }
+  query = modulemd_stream_query_new_from_nsvca_glob (nsvca_pattern);
+  modulemd_module_collect_streams_by_query (self, query, matching_streams);
 
   return g_steal_pointer (&matching_streams);
 }
@@ -737,8 +835,12 @@ modulemd_module_remove_streams_by_NSVCA (ModulemdModule *self,
 {
   gboolean found = FALSE;
   guint index;
-  g_autoptr (modulemd_nsvca) nsvca = g_malloc0_n (1, sizeof (modulemd_nsvca));
+  g_autoptr (modulemd_nsvca) nsvca = NULL;
 
+  g_return_if_fail (MODULEMD_IS_MODULE (self));
+  g_return_if_fail (!self->frozen);
+
+  nsvca = g_malloc0_n (1, sizeof (modulemd_nsvca));
   nsvca->stream_name = stream_name;
   nsvca->version = version;
   nsvca->context = context;
@@ -753,6 +855,7 @@ modulemd_module_remove_streams_by_NSVCA (ModulemdModule *self,
         self->streams, nsvca, match_nsvca, &index);
       if (found)
         {
+          invalidate_sorted_streams (self);
           g_ptr_array_remove_index (self->streams, index);
         }
     }
@@ -768,6 +871,8 @@ modulemd_module_add_translation (ModulemdModule *self,
   ModulemdModuleStream *stream = NULL;
   ModulemdTranslation *newtrans = NULL;
 
+  g_return_if_fail (MODULEMD_IS_MODULE (self));
+  g_return_if_fail (!self->frozen);
   g_return_if_fail (
     g_str_equal (modulemd_translation_get_module_name (translation),
                  modulemd_module_get_module_name (self)));
@@ -817,6 +922,8 @@ modulemd_module_add_obsoletes (ModulemdModule *self,
   ModulemdObsoletes *new_obsoletes = NULL;
   ModulemdObsoletes *current_obsoletes = NULL;
 
+  g_return_if_fail (MODULEMD_IS_MODULE (self));
+  g_return_if_fail (!self->frozen);
   g_return_if_fail (
     g_str_equal (modulemd_obsoletes_get_module_name (obsoletes),
                  modulemd_module_get_module_name (self)));
@@ -981,6 +1088,7 @@ modulemd_module_upgrade_streams (ModulemdModule *self,
   g_autoptr (GError) nested_error = NULL;
 
   g_return_val_if_fail (MODULEMD_IS_MODULE (self), FALSE);
+  g_return_val_if_fail (!self->frozen, FALSE);
 
   new_streams = g_ptr_array_new_full (self->streams->len, g_object_unref);
 
@@ -1038,6 +1146,7 @@ modulemd_module_upgrade_streams (ModulemdModule *self,
     }
 
   /* Replace the old stream list with the new one */
+  invalidate_sorted_streams (self);
   g_ptr_array_unref (self->streams);
   self->streams = g_steal_pointer (&new_streams);
 
@@ -1105,6 +1214,124 @@ modulemd_module_clear_xmds (ModulemdModule *self)
   MODULEMD_INIT_TRACE ();
 
   g_return_if_fail (MODULEMD_IS_MODULE (self));
+  g_return_if_fail (!self->frozen);
 
   g_ptr_array_foreach (self->streams, clear_xmds, NULL);
 }
+
+
+void
+modulemd_module_freeze (ModulemdModule *self)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_MODULE (self));
+
+  if (self->frozen)
+    {
+      return;
+    }
+
+  modulemd_module_get_sorted_streams (self);
+
+  for (guint i = 0; i < self->streams->len; i++)
+    {
+      modulemd_module_stream_freeze (g_ptr_array_index (self->streams, i));
+    }
+
+  if (self->defaults)
+    {
+      modulemd_defaults_freeze (self->defaults);
+    }
+
+  g_hash_table_iter_init (&iter, self->translations);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_translation_freeze (value);
+    }
+
+  for (guint i = 0; i < self->obsoletes->len; i++)
+    {
+      modulemd_obsoletes_freeze (g_ptr_array_index (self->obsoletes, i));
+    }
+
+  self->frozen = TRUE;
+}
+
+
+gboolean
+modulemd_module_is_frozen (ModulemdModule *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_MODULE (self), FALSE);
+
+  return self->frozen;
+}
+
+
+void
+modulemd_module_add_memory_usage (ModulemdModule *self,
+                                  ModulemdMemoryUsage *usage)
+{
+  ModulemdModuleStream *stream = NULL;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_MODULE (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_string (usage, self->module_name);
+
+  modulemd_memory_usage_add_ptr_array (usage, self->streams);
+  for (guint i = 0; i < self->streams->len; i++)
+    {
+      stream = g_ptr_array_index (self->streams, i);
+      if (MODULEMD_IS_MODULE_STREAM_V2 (stream))
+        {
+          modulemd_module_stream_v2_add_memory_usage (
+            MODULEMD_MODULE_STREAM_V2 (stream), usage);
+        }
+      else if (MODULEMD_IS_MODULE_STREAM_V1 (stream))
+        {
+          modulemd_module_stream_v1_add_memory_usage (
+            MODULEMD_MODULE_STREAM_V1 (stream), usage);
+        }
+    }
+  modulemd_memory_usage_add_ptr_array (usage, self->sorted_streams);
+
+  if (self->defaults && MODULEMD_IS_DEFAULTS_V1 (self->defaults))
+    {
+      modulemd_defaults_v1_add_memory_usage (
+        MODULEMD_DEFAULTS_V1 (self->defaults), usage);
+    }
+
+  /* The table is keyed by stream name and only exists for the translations,
+   * but a module without any still has the empty table as a plain container.
+   */
+  if (g_hash_table_size (self->translations) == 0)
+    {
+      modulemd_memory_usage_add_hash_table (usage, self->translations);
+    }
+  else
+    {
+      modulemd_memory_usage_push_section (usage,
+                                          MD_MEMORY_CATEGORY_TRANSLATIONS);
+      modulemd_memory_usage_add_hash_table (usage, self->translations);
+      g_hash_table_iter_init (&iter, self->translations);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          modulemd_memory_usage_add_string (usage, key);
+          modulemd_translation_add_memory_usage (MODULEMD_TRANSLATION (value),
+                                                 usage);
+        }
+      modulemd_memory_usage_pop_section (usage);
+    }
+
+  modulemd_memory_usage_add_ptr_array (usage, self->obsoletes);
+  for (guint i = 0; i < self->obsoletes->len; i++)
+    {
+      modulemd_obsoletes_add_memory_usage (
+        g_ptr_array_index (self->obsoletes, i), usage);
+    }
+}
@@ -17,6 +17,7 @@
 
 #include "modulemd-errors.h"
 #include "modulemd-obsoletes.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-obsoletes-private.h"
 #include "private/modulemd-util.h"
 
@@ -43,6 +44,9 @@ struct _ModulemdObsoletes
   /* Stream is obsoleted by exactly one other stream */
   gchar *obsoleted_by_module_name;
   gchar *obsoleted_by_module_stream;
+
+  /* Set by modulemd_obsoletes_freeze(); nothing may change afterwards */
+  gboolean frozen;
 };
 
 G_DEFINE_TYPE (ModulemdObsoletes, modulemd_obsoletes, G_TYPE_OBJECT)
@@ -321,6 +325,7 @@ void
 modulemd_obsoletes_set_modified (ModulemdObsoletes *self, guint64 modified)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
 
   self->modified = modified;
 
@@ -332,6 +337,7 @@ void
 modulemd_obsoletes_set_reset (ModulemdObsoletes *self, gboolean reset)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
 
   self->reset = reset;
 
@@ -374,6 +380,7 @@ modulemd_obsoletes_set_module_context (ModulemdObsoletes *self,
                                        const gchar *module_context)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
 
   g_clear_pointer (&self->module_context, g_free);
   self->module_context = g_strdup (module_context);
@@ -385,6 +392,7 @@ void
 modulemd_obsoletes_set_eol_date (ModulemdObsoletes *self, guint64 eol_date)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
 
   self->eol_date = eol_date;
 
@@ -396,6 +404,7 @@ void
 modulemd_obsoletes_set_message (ModulemdObsoletes *self, const gchar *message)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
   g_return_if_fail (message);
 
   g_clear_pointer (&self->message, g_free);
@@ -409,6 +418,7 @@ modulemd_obsoletes_set_obsoleted_by_module_name (
   ModulemdObsoletes *self, const gchar *obsoleted_by_module_name)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
 
   g_clear_pointer (&self->obsoleted_by_module_name, g_free);
   self->obsoleted_by_module_name = g_strdup (obsoleted_by_module_name);
@@ -422,6 +432,7 @@ modulemd_obsoletes_set_obsoleted_by_module_stream (
   ModulemdObsoletes *self, const gchar *obsoleted_by_module_stream)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
 
   g_clear_pointer (&self->obsoleted_by_module_stream, g_free);
   self->obsoleted_by_module_stream = g_strdup (obsoleted_by_module_stream);
@@ -436,6 +447,7 @@ modulemd_obsoletes_set_obsoleted_by (ModulemdObsoletes *self,
                                      const gchar *obsoleted_by_module_stream)
 {
   g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+  g_return_if_fail (!self->frozen);
 
   modulemd_obsoletes_set_obsoleted_by_module_name (self,
                                                    obsoleted_by_module_name);
@@ -1109,7 +1121,7 @@ modulemd_obsoletes_emit_yaml (ModulemdObsoletes *self,
   /* Only output reset if it's TRUE */
   if (modulemd_obsoletes_get_reset (self))
     {
-      EMIT_KEY_VALUE (emitter, error, "reset", "true");
+      EMIT_KEY_VALUE_BOOLEAN (emitter, error, "reset", TRUE);
     }
 
   /* The module name is mandatory */
@@ -1241,3 +1253,28 @@ modulemd_obsoletes_is_active (ModulemdObsoletes *self)
 
   return FALSE;
 }
+
+
+void
+modulemd_obsoletes_add_memory_usage (ModulemdObsoletes *self,
+                                     ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_string (usage, self->module_name);
+  modulemd_memory_usage_add_string (usage, self->module_stream);
+  modulemd_memory_usage_add_string (usage, self->module_context);
+  modulemd_memory_usage_add_string (usage, self->message);
+  modulemd_memory_usage_add_string (usage, self->obsoleted_by_module_name);
+  modulemd_memory_usage_add_string (usage, self->obsoleted_by_module_stream);
+}
+
+
+void
+modulemd_obsoletes_freeze (ModulemdObsoletes *self)
+{
+  g_return_if_fail (MODULEMD_IS_OBSOLETES (self));
+
+  self->frozen = TRUE;
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+
+#include "modulemd-module-stream.h"
+#include "modulemd-package-provider.h"
+#include "private/modulemd-package-provider-private.h"
+#include "private/modulemd-util.h"
+
+
+struct _ModulemdPackageProvider
+{
+  GObject parent_instance;
+
+  ModulemdModuleStream *stream;
+  ModulemdPackageSourceFlags source;
+  gchar *profile_name;
+};
+
+G_DEFINE_TYPE (ModulemdPackageProvider,
+               modulemd_package_provider,
+               G_TYPE_OBJECT)
+
+
+ModulemdPackageProvider *
+modulemd_package_provider_new (ModulemdModuleStream *stream,
+                               ModulemdPackageSourceFlags source,
+                               const gchar *profile_name)
+{
+  ModulemdPackageProvider *self = NULL;
+
+  g_return_val_if_fail (MODULEMD_IS_MODULE_STREAM (stream), NULL);
+  g_return_val_if_fail ((source == MD_PACKAGE_SOURCE_PROFILE) ==
+                          (profile_name != NULL),
+                        NULL);
+
+  self = g_object_new (MODULEMD_TYPE_PACKAGE_PROVIDER, NULL);
+  self->stream = g_object_ref (stream);
+  self->source = source;
+  self->profile_name = g_strdup (profile_name);
+
+  return self;
+}
+
+
+static void
+modulemd_package_provider_finalize (GObject *object)
+{
+  ModulemdPackageProvider *self = (ModulemdPackageProvider *)object;
+
+  g_clear_object (&self->stream);
+  g_clear_pointer (&self->profile_name, g_free);
+
+  G_OBJECT_CLASS (modulemd_package_provider_parent_class)->finalize (object);
+}
+
+
+static void
+modulemd_package_provider_class_init (ModulemdPackageProviderClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = modulemd_package_provider_finalize;
+}
+
+
+static void
+modulemd_package_provider_init (ModulemdPackageProvider *UNUSED (self))
+{
+}
+
+
+ModulemdModuleStream *
+modulemd_package_provider_get_stream (ModulemdPackageProvider *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_PACKAGE_PROVIDER (self), NULL);
+
+  return self->stream;
+}
+
+
+ModulemdPackageSourceFlags
+modulemd_package_provider_get_source (ModulemdPackageProvider *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_PACKAGE_PROVIDER (self), 0);
+
+  return self->source;
+}
+
+
+const gchar *
+modulemd_package_provider_get_profile_name (ModulemdPackageProvider *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_PACKAGE_PROVIDER (self), NULL);
+
+  return self->profile_name;
+}
@@ -89,8 +89,7 @@ modulemd_packager_v3_class_init (ModulemdPackagerV3Class *klass)
 static void
 modulemd_packager_v3_init (ModulemdPackagerV3 *self)
 {
-  self->module_licenses =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->module_licenses = modulemd_str_set_new ();
 
   self->build_configs =
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
@@ -98,14 +97,11 @@ modulemd_packager_v3_init (ModulemdPackagerV3 *self)
   self->profiles =
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
-  self->rpm_api =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_api = modulemd_str_set_new ();
 
-  self->rpm_filters =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpm_filters = modulemd_str_set_new ();
 
-  self->demodularized_rpms =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->demodularized_rpms = modulemd_str_set_new ();
 
   self->rpm_components =
     g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
@@ -275,7 +271,7 @@ modulemd_packager_v3_add_module_license (ModulemdPackagerV3 *self,
       return;
     }
 
-  g_hash_table_add (self->module_licenses, g_strdup (license));
+  g_hash_table_add (self->module_licenses, modulemd_str_intern (license));
 }
 
 
@@ -342,6 +338,23 @@ modulemd_packager_v3_get_mdversion (ModulemdPackagerV3 *UNUSED (self))
 }
 
 
+/*
+ * modulemd_packager_v3_take_build_config:
+ * @self: (in): This #ModulemdPackagerV3 object.
+ * @buildconfig: (in) (transfer full): A #ModulemdBuildConfig to store in
+ * @self without copying it.
+ */
+static void
+modulemd_packager_v3_take_build_config (ModulemdPackagerV3 *self,
+                                        ModulemdBuildConfig *buildconfig)
+{
+  g_hash_table_replace (
+    self->build_configs,
+    g_strdup (modulemd_build_config_get_context (buildconfig)),
+    buildconfig);
+}
+
+
 void
 modulemd_packager_v3_add_build_config (ModulemdPackagerV3 *self,
                                        ModulemdBuildConfig *buildconfig)
@@ -352,10 +365,8 @@ modulemd_packager_v3_add_build_config (ModulemdPackagerV3 *self,
   g_return_if_fail (MODULEMD_IS_PACKAGER_V3 (self));
   g_return_if_fail (MODULEMD_IS_BUILD_CONFIG (buildconfig));
 
-  g_hash_table_replace (
-    self->build_configs,
-    g_strdup (modulemd_build_config_get_context (buildconfig)),
-    modulemd_build_config_copy (buildconfig));
+  modulemd_packager_v3_take_build_config (
+    self, modulemd_build_config_copy (buildconfig));
 }
 
 
@@ -458,6 +469,21 @@ modulemd_packager_v3_get_tracker (ModulemdPackagerV3 *self)
 }
 
 
+/*
+ * modulemd_packager_v3_take_profile:
+ * @self: (in): This #ModulemdPackagerV3 object.
+ * @profile: (in) (transfer full): A #ModulemdProfile to store in @self
+ * without copying it.
+ */
+static void
+modulemd_packager_v3_take_profile (ModulemdPackagerV3 *self,
+                                   ModulemdProfile *profile)
+{
+  g_hash_table_replace (
+    self->profiles, g_strdup (modulemd_profile_get_name (profile)), profile);
+}
+
+
 void
 modulemd_packager_v3_add_profile (ModulemdPackagerV3 *self,
                                   ModulemdProfile *profile)
@@ -469,11 +495,7 @@ modulemd_packager_v3_add_profile (ModulemdPackagerV3 *self,
   g_return_if_fail (MODULEMD_IS_PACKAGER_V3 (self));
   g_return_if_fail (MODULEMD_IS_PROFILE (profile));
 
-  ModulemdProfile *copied_profile = modulemd_profile_copy (profile);
-
-  g_hash_table_replace (self->profiles,
-                        g_strdup (modulemd_profile_get_name (profile)),
-                        copied_profile);
+  modulemd_packager_v3_take_profile (self, modulemd_profile_copy (profile));
 }
 
 
@@ -515,7 +537,7 @@ modulemd_packager_v3_add_rpm_api (ModulemdPackagerV3 *self, const gchar *rpm)
 
   g_return_if_fail (MODULEMD_IS_PACKAGER_V3 (self));
 
-  g_hash_table_add (self->rpm_api, g_strdup (rpm));
+  g_hash_table_add (self->rpm_api, modulemd_str_intern (rpm));
 }
 
 
@@ -572,7 +594,7 @@ modulemd_packager_v3_add_rpm_filter (ModulemdPackagerV3 *self,
 
   g_return_if_fail (MODULEMD_IS_PACKAGER_V3 (self));
 
-  g_hash_table_add (self->rpm_filters, g_strdup (rpm));
+  g_hash_table_add (self->rpm_filters, modulemd_str_intern (rpm));
 }
 
 
@@ -630,7 +652,7 @@ modulemd_packager_v3_add_demodularized_rpm (ModulemdPackagerV3 *self,
 
   g_return_if_fail (MODULEMD_IS_PACKAGER_V3 (self));
 
-  g_hash_table_add (self->demodularized_rpms, g_strdup (rpm));
+  g_hash_table_add (self->demodularized_rpms, modulemd_str_intern (rpm));
 }
 
 
@@ -677,21 +699,18 @@ modulemd_packager_v3_get_demodularized_rpms (ModulemdPackagerV3 *self)
 }
 
 
-void
-modulemd_packager_v3_add_component (ModulemdPackagerV3 *self,
-                                    ModulemdComponent *component)
+/*
+ * modulemd_packager_v3_take_component:
+ * @self: (in): This #ModulemdPackagerV3 object.
+ * @component: (in) (transfer full): A #ModulemdComponent to store in @self
+ * without copying it.
+ */
+static void
+modulemd_packager_v3_take_component (ModulemdPackagerV3 *self,
+                                     ModulemdComponent *component)
 {
   GHashTable *table = NULL;
 
-  /* Do nothing if we were passed a NULL component */
-  if (!component)
-    {
-      return;
-    }
-
-  g_return_if_fail (MODULEMD_IS_PACKAGER_V3 (self));
-  g_return_if_fail (MODULEMD_IS_COMPONENT (component));
-
   if (MODULEMD_IS_COMPONENT_RPM (component))
     {
       table = self->rpm_components;
@@ -703,15 +722,33 @@ modulemd_packager_v3_add_component (ModulemdPackagerV3 *self,
   else
     {
       /* Unknown component. Raise a warning and return */
+      g_object_unref (component);
       g_return_if_reached ();
     }
 
   /* Add the component to the table. This will replace an existing component
    * with the same name
    */
-  g_hash_table_replace (table,
-                        g_strdup (modulemd_component_get_key (component)),
-                        modulemd_component_copy (component, NULL));
+  g_hash_table_replace (
+    table, g_strdup (modulemd_component_get_key (component)), component);
+}
+
+
+void
+modulemd_packager_v3_add_component (ModulemdPackagerV3 *self,
+                                    ModulemdComponent *component)
+{
+  /* Do nothing if we were passed a NULL component */
+  if (!component)
+    {
+      return;
+    }
+
+  g_return_if_fail (MODULEMD_IS_PACKAGER_V3 (self));
+  g_return_if_fail (MODULEMD_IS_COMPONENT (component));
+
+  modulemd_packager_v3_take_component (
+    self, modulemd_component_copy (component, NULL));
 }
 
 
@@ -1303,8 +1340,7 @@ modulemd_packager_v3_parse_yaml (ModulemdSubdocumentInfo *subdoc,
                                 "license"))
             {
               set = modulemd_yaml_parse_string_set (&parser, &nested_error);
-              MODULEMD_REPLACE_SET (packager->module_licenses, set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (packager->module_licenses, set);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value, "xmd"))
@@ -1356,8 +1392,7 @@ modulemd_packager_v3_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_packager_v3_replace_rpm_api (packager, set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (packager->rpm_api, set);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
@@ -1365,8 +1400,7 @@ modulemd_packager_v3_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_packager_v3_replace_rpm_filters (packager, set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (packager->rpm_filters, set);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
@@ -1374,8 +1408,7 @@ modulemd_packager_v3_parse_yaml (ModulemdSubdocumentInfo *subdoc,
             {
               set = modulemd_yaml_parse_string_set_from_map (
                 &parser, "rpms", strict, &nested_error);
-              modulemd_packager_v3_replace_demodularized_rpms (packager, set);
-              g_clear_pointer (&set, g_hash_table_unref);
+              MODULEMD_TAKE_SET (packager->demodularized_rpms, set);
             }
 
           else if (g_str_equal ((const gchar *)event.data.scalar.value,
@@ -1462,8 +1495,8 @@ modulemd_packager_v3_parse_build_configs (yaml_parser_t *parser,
                            context);
               return FALSE;
             }
-          modulemd_packager_v3_add_build_config (packager, buildconfig);
-          g_clear_object (&buildconfig);
+          modulemd_packager_v3_take_build_config (
+            packager, g_steal_pointer (&buildconfig));
           break;
 
         default:
@@ -1626,8 +1659,8 @@ modulemd_packager_v3_parse_profiles (yaml_parser_t *parser,
               return FALSE;
             }
 
-          modulemd_packager_v3_add_profile (packager, profile);
-          g_clear_pointer (&profile, g_object_unref);
+          modulemd_packager_v3_take_profile (packager,
+                                             g_steal_pointer (&profile));
           break;
 
         default:
@@ -1782,9 +1815,8 @@ modulemd_packager_v3_parse_rpm_components (yaml_parser_t *parser,
               g_propagate_error (error, g_steal_pointer (&nested_error));
               return FALSE;
             }
-          modulemd_packager_v3_add_component (packager,
-                                              (ModulemdComponent *)component);
-          g_clear_pointer (&component, g_object_unref);
+          modulemd_packager_v3_take_component (
+            packager, (ModulemdComponent *)g_steal_pointer (&component));
           break;
 
         default:
@@ -1846,9 +1878,8 @@ modulemd_packager_v3_parse_module_components (yaml_parser_t *parser,
               g_propagate_error (error, g_steal_pointer (&nested_error));
               return FALSE;
             }
-          modulemd_packager_v3_add_component (packager,
-                                              (ModulemdComponent *)component);
-          g_clear_pointer (&component, g_object_unref);
+          modulemd_packager_v3_take_component (
+            packager, (ModulemdComponent *)g_steal_pointer (&component));
           break;
 
         default:
@@ -1927,8 +1958,7 @@ modulemd_packager_v3_emit_yaml (ModulemdPackagerV3 *self,
     {
       EMIT_SCALAR (emitter, error, "configurations");
       EMIT_SEQUENCE_START (emitter, error);
-      keys =
-        modulemd_ordered_str_keys (self->build_configs, modulemd_strcmp_sort);
+      keys = modulemd_sorted_str_keys (self->build_configs);
       for (i = 0; i < keys->len; i++)
         {
           ret = modulemd_build_config_emit_yaml (
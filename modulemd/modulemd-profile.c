@@ -17,6 +17,8 @@
 #include "modulemd-module-stream.h"
 #include "modulemd-profile.h"
 #include "private/glib-extensions.h"
+#include "private/modulemd-compactor.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-module-stream-private.h"
 #include "private/modulemd-profile-private.h"
 #include "private/modulemd-util.h"
@@ -34,7 +36,18 @@ struct _ModulemdProfile
 
   GHashTable *rpms;
 
+  /* Set when rpms may be referenced by another profile, in which case it is
+   * copied before it is modified.
+   */
+  gboolean rpms_shared;
+
   ModulemdModuleStream *owner;
+
+  /* Set from modulemd_next_generation () by every setter */
+  guint64 generation;
+
+  /* Set by modulemd_profile_freeze(); nothing may change afterwards */
+  gboolean frozen;
 };
 
 G_DEFINE_TYPE (ModulemdProfile, modulemd_profile, G_TYPE_OBJECT)
@@ -116,7 +129,15 @@ modulemd_profile_copy (ModulemdProfile *self)
     p, modulemd_profile_get_description (self, NULL));
 
   g_hash_table_unref (p->rpms);
-  p->rpms = g_hash_table_ref (self->rpms);
+  if (self->rpms_shared)
+    {
+      p->rpms = g_hash_table_ref (self->rpms);
+      p->rpms_shared = TRUE;
+    }
+  else
+    {
+      p->rpms = modulemd_hash_table_deep_set_copy (self->rpms);
+    }
 
   if (modulemd_profile_is_default (self))
     {
@@ -163,12 +184,46 @@ modulemd_profile_get_name (ModulemdProfile *self)
 }
 
 
+static gboolean
+modulemd_profile_will_change (ModulemdProfile *self)
+{
+  g_return_val_if_fail (!self->frozen, FALSE);
+
+  self->generation = modulemd_next_generation ();
+
+  return TRUE;
+}
+
+
+guint64
+modulemd_profile_get_generation (ModulemdProfile *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_PROFILE (self), 0);
+
+  return self->generation;
+}
+
+
+void
+modulemd_profile_freeze (ModulemdProfile *self)
+{
+  g_return_if_fail (MODULEMD_IS_PROFILE (self));
+
+  self->frozen = TRUE;
+}
+
+
 void
 modulemd_profile_set_description (ModulemdProfile *self,
                                   const gchar *description)
 {
   g_return_if_fail (MODULEMD_IS_PROFILE (self));
 
+  if (!modulemd_profile_will_change (self))
+    {
+      return;
+    }
+
   g_clear_pointer (&self->description, g_free);
   self->description = g_strdup (description);
 }
@@ -206,6 +261,10 @@ void
 modulemd_profile_set_default (ModulemdProfile *self)
 {
   g_return_if_fail (MODULEMD_IS_PROFILE (self));
+  if (!modulemd_profile_will_change (self))
+    {
+      return;
+    }
   self->is_default = TRUE;
 }
 
@@ -213,6 +272,10 @@ void
 modulemd_profile_unset_default (ModulemdProfile *self)
 {
   g_return_if_fail (MODULEMD_IS_PROFILE (self));
+  if (!modulemd_profile_will_change (self))
+    {
+      return;
+    }
   self->is_default = FALSE;
 }
 
@@ -226,11 +289,33 @@ modulemd_profile_is_default (ModulemdProfile *self)
 }
 
 
+static void
+modulemd_profile_unshare_rpms (ModulemdProfile *self)
+{
+  GHashTable *rpms = NULL;
+
+  if (!self->rpms_shared)
+    {
+      return;
+    }
+
+  rpms = modulemd_hash_table_deep_set_copy (self->rpms);
+  g_hash_table_unref (self->rpms);
+  self->rpms = rpms;
+  self->rpms_shared = FALSE;
+}
+
+
 void
 modulemd_profile_add_rpm (ModulemdProfile *self, const gchar *rpm)
 {
   g_return_if_fail (MODULEMD_IS_PROFILE (self));
-  g_hash_table_add (self->rpms, g_strdup (rpm));
+  if (!modulemd_profile_will_change (self))
+    {
+      return;
+    }
+  modulemd_profile_unshare_rpms (self);
+  g_hash_table_add (self->rpms, modulemd_str_intern (rpm));
 }
 
 
@@ -238,6 +323,11 @@ void
 modulemd_profile_remove_rpm (ModulemdProfile *self, const gchar *rpm)
 {
   g_return_if_fail (MODULEMD_IS_PROFILE (self));
+  if (!modulemd_profile_will_change (self))
+    {
+      return;
+    }
+  modulemd_profile_unshare_rpms (self);
   g_hash_table_remove (self->rpms, rpm);
 }
 
@@ -246,6 +336,11 @@ void
 modulemd_profile_clear_rpms (ModulemdProfile *self)
 {
   g_return_if_fail (MODULEMD_IS_PROFILE (self));
+  if (!modulemd_profile_will_change (self))
+    {
+      return;
+    }
+  modulemd_profile_unshare_rpms (self);
   g_hash_table_remove_all (self->rpms);
 }
 
@@ -259,16 +354,33 @@ modulemd_profile_get_rpms_as_strv (ModulemdProfile *self)
 }
 
 
+GHashTable *
+modulemd_profile_get_rpms_internal (ModulemdProfile *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_PROFILE (self), NULL);
+
+  return self->rpms;
+}
+
+
 void
 modulemd_profile_set_owner (ModulemdProfile *self, ModulemdModuleStream *owner)
 {
   g_return_if_fail (MODULEMD_IS_PROFILE (self));
-  g_return_if_fail (MODULEMD_IS_MODULE_STREAM (owner));
+  g_return_if_fail (!owner || MODULEMD_IS_MODULE_STREAM (owner));
 
   self->owner = owner;
 }
 
 
+void
+modulemd_profile_disown (gpointer self)
+{
+  modulemd_profile_set_owner (MODULEMD_PROFILE (self), NULL);
+  g_object_unref (self);
+}
+
+
 static void
 modulemd_profile_get_property (GObject *object,
                                guint prop_id,
@@ -328,7 +440,7 @@ modulemd_profile_class_init (ModulemdProfileClass *klass)
 static void
 modulemd_profile_init (ModulemdProfile *self)
 {
-  self->rpms = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->rpms = modulemd_str_set_new ();
 }
 
 
@@ -524,7 +636,7 @@ modulemd_profile_emit_yaml (ModulemdProfile *self,
   /* Only output default if it's TRUE */
   if (modulemd_profile_is_default (self))
     {
-      EMIT_KEY_VALUE (emitter, error, "default", "true");
+      EMIT_KEY_VALUE_BOOLEAN (emitter, error, "default", TRUE);
     }
 
   ret = mmd_emitter_end_mapping (emitter, &nested_error);
@@ -537,3 +649,29 @@ modulemd_profile_emit_yaml (ModulemdProfile *self,
     }
   return TRUE;
 }
+
+
+void
+modulemd_profile_add_memory_usage (ModulemdProfile *self,
+                                   ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_PROFILE (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_string (usage, self->name);
+  modulemd_memory_usage_add_string (usage, self->description);
+  if (modulemd_memory_usage_claim (usage, self->rpms))
+    {
+      modulemd_memory_usage_add_string_set (usage, self->rpms);
+    }
+}
+
+
+void
+modulemd_profile_compact (ModulemdProfile *self, ModulemdCompactor *compactor)
+{
+  g_return_if_fail (MODULEMD_IS_PROFILE (self));
+
+  modulemd_compactor_share_set (compactor, &self->rpms);
+  self->rpms_shared = TRUE;
+}
@@ -16,6 +16,7 @@
 
 #include "modulemd-errors.h"
 #include "modulemd-rpm-map-entry.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-rpm-map-entry-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
@@ -30,6 +31,12 @@ struct _ModulemdRpmMapEntry
   gchar *version;
   gchar *release;
   gchar *arch;
+
+  /* Set from modulemd_next_generation () by every setter */
+  guint64 generation;
+
+  /* Set by modulemd_rpm_map_entry_freeze(); nothing may change afterwards */
+  gboolean frozen;
 };
 
 G_DEFINE_TYPE (ModulemdRpmMapEntry, modulemd_rpm_map_entry, G_TYPE_OBJECT)
@@ -169,17 +176,141 @@ modulemd_rpm_map_entry_validate (ModulemdRpmMapEntry *self, GError **error)
 }
 
 
-MODULEMD_SETTER_GETTER_STRING (
-  ModulemdRpmMapEntry, rpm_map_entry, RPM_MAP_ENTRY, name, NAME)
+static gboolean
+modulemd_rpm_map_entry_will_change (ModulemdRpmMapEntry *self)
+{
+  g_return_val_if_fail (!self->frozen, FALSE);
+
+  self->generation = modulemd_next_generation ();
+
+  return TRUE;
+}
+
+
+guint64
+modulemd_rpm_map_entry_get_generation (ModulemdRpmMapEntry *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self), 0);
+
+  return self->generation;
+}
+
+
+void
+modulemd_rpm_map_entry_freeze (ModulemdRpmMapEntry *self)
+{
+  g_return_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self));
+
+  self->frozen = TRUE;
+}
+
+
+void
+modulemd_rpm_map_entry_set_name (ModulemdRpmMapEntry *self,
+                                 const gchar *name)
+{
+  g_return_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self));
+
+  if (!modulemd_rpm_map_entry_will_change (self))
+    {
+      return;
+    }
+
+  g_clear_pointer (&self->name, g_free);
+  self->name = g_strdup (name);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_NAME]);
+}
+
+
+const gchar *
+modulemd_rpm_map_entry_get_name (ModulemdRpmMapEntry *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self), NULL);
+
+  return self->name;
+}
+
+
+void
+modulemd_rpm_map_entry_set_version (ModulemdRpmMapEntry *self,
+                                    const gchar *version)
+{
+  g_return_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self));
+
+  if (!modulemd_rpm_map_entry_will_change (self))
+    {
+      return;
+    }
+
+  g_clear_pointer (&self->version, g_free);
+  self->version = g_strdup (version);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_VERSION]);
+}
+
+
+const gchar *
+modulemd_rpm_map_entry_get_version (ModulemdRpmMapEntry *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self), NULL);
+
+  return self->version;
+}
+
+
+void
+modulemd_rpm_map_entry_set_release (ModulemdRpmMapEntry *self,
+                                    const gchar *release)
+{
+  g_return_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self));
+
+  if (!modulemd_rpm_map_entry_will_change (self))
+    {
+      return;
+    }
+
+  g_clear_pointer (&self->release, g_free);
+  self->release = g_strdup (release);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_RELEASE]);
+}
+
+
+const gchar *
+modulemd_rpm_map_entry_get_release (ModulemdRpmMapEntry *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self), NULL);
+
+  return self->release;
+}
+
+
+void
+modulemd_rpm_map_entry_set_arch (ModulemdRpmMapEntry *self,
+                                 const gchar *arch)
+{
+  g_return_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self));
+
+  if (!modulemd_rpm_map_entry_will_change (self))
+    {
+      return;
+    }
+
+  g_clear_pointer (&self->arch, g_free);
+  self->arch = g_strdup (arch);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_ARCH]);
+}
 
-MODULEMD_SETTER_GETTER_STRING (
-  ModulemdRpmMapEntry, rpm_map_entry, RPM_MAP_ENTRY, version, VERSION)
 
-MODULEMD_SETTER_GETTER_STRING (
-  ModulemdRpmMapEntry, rpm_map_entry, RPM_MAP_ENTRY, release, RELEASE)
+const gchar *
+modulemd_rpm_map_entry_get_arch (ModulemdRpmMapEntry *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self), NULL);
 
-MODULEMD_SETTER_GETTER_STRING (
-  ModulemdRpmMapEntry, rpm_map_entry, RPM_MAP_ENTRY, arch, ARCH)
+  return self->arch;
+}
 
 
 void
@@ -187,6 +318,11 @@ modulemd_rpm_map_entry_set_epoch (ModulemdRpmMapEntry *self, guint64 epoch)
 {
   g_return_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self));
 
+  if (!modulemd_rpm_map_entry_will_change (self))
+    {
+      return;
+    }
+
   self->epoch = epoch;
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_EPOCH]);
@@ -554,7 +690,6 @@ modulemd_rpm_map_entry_emit_yaml (ModulemdRpmMapEntry *self,
 {
   MODULEMD_INIT_TRACE ();
   g_autoptr (GError) nested_error = NULL;
-  g_autofree gchar *epoch = NULL;
   g_autofree gchar *nevra = NULL;
 
   if (!modulemd_rpm_map_entry_validate (self, &nested_error))
@@ -564,13 +699,12 @@ modulemd_rpm_map_entry_emit_yaml (ModulemdRpmMapEntry *self,
                                   "rpm-map entry failed to validate: ");
       return FALSE;
     }
-  epoch = g_strdup_printf ("%" PRIu64, self->epoch);
   nevra = modulemd_rpm_map_entry_get_nevra_as_string (self);
 
   EMIT_MAPPING_START_WITH_STYLE (emitter, error, YAML_BLOCK_MAPPING_STYLE);
 
   EMIT_KEY_VALUE_STRING (emitter, error, "name", self->name);
-  EMIT_KEY_VALUE (emitter, error, "epoch", epoch);
+  EMIT_KEY_VALUE_UINT64 (emitter, error, "epoch", self->epoch);
   EMIT_KEY_VALUE_STRING (emitter, error, "version", self->version);
   EMIT_KEY_VALUE_STRING (emitter, error, "release", self->release);
   EMIT_KEY_VALUE_STRING (emitter, error, "arch", self->arch);
@@ -580,3 +714,17 @@ modulemd_rpm_map_entry_emit_yaml (ModulemdRpmMapEntry *self,
 
   return TRUE;
 }
+
+
+void
+modulemd_rpm_map_entry_add_memory_usage (ModulemdRpmMapEntry *self,
+                                         ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_RPM_MAP_ENTRY (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_string (usage, self->name);
+  modulemd_memory_usage_add_string (usage, self->version);
+  modulemd_memory_usage_add_string (usage, self->release);
+  modulemd_memory_usage_add_string (usage, self->arch);
+}
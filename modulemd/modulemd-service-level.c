@@ -16,6 +16,7 @@
 
 #include "modulemd-service-level.h"
 #include "private/glib-extensions.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-service-level-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
@@ -28,6 +29,12 @@ struct _ModulemdServiceLevel
 
   gchar *name;
   GDate *eol;
+
+  /* Set from modulemd_next_generation () by every setter */
+  guint64 generation;
+
+  /* Set by modulemd_service_level_freeze(); nothing may change afterwards */
+  gboolean frozen;
 };
 
 G_DEFINE_TYPE (ModulemdServiceLevel, modulemd_service_level, G_TYPE_OBJECT)
@@ -164,11 +171,45 @@ modulemd_service_level_get_name (ModulemdServiceLevel *self)
 }
 
 
+static gboolean
+modulemd_service_level_will_change (ModulemdServiceLevel *self)
+{
+  g_return_val_if_fail (!self->frozen, FALSE);
+
+  self->generation = modulemd_next_generation ();
+
+  return TRUE;
+}
+
+
+guint64
+modulemd_service_level_get_generation (ModulemdServiceLevel *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_SERVICE_LEVEL (self), 0);
+
+  return self->generation;
+}
+
+
+void
+modulemd_service_level_freeze (ModulemdServiceLevel *self)
+{
+  g_return_if_fail (MODULEMD_IS_SERVICE_LEVEL (self));
+
+  self->frozen = TRUE;
+}
+
+
 void
 modulemd_service_level_set_eol (ModulemdServiceLevel *self, GDate *date)
 {
   g_return_if_fail (MODULEMD_IS_SERVICE_LEVEL (self));
 
+  if (!modulemd_service_level_will_change (self))
+    {
+      return;
+    }
+
   if (!date || !g_date_valid (date))
     {
       g_date_clear (self->eol, 1);
@@ -470,3 +511,19 @@ modulemd_service_level_emit_yaml (ModulemdServiceLevel *self,
 
   return TRUE;
 }
+
+
+void
+modulemd_service_level_add_memory_usage (ModulemdServiceLevel *self,
+                                         ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_SERVICE_LEVEL (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_string (usage, self->name);
+  if (self->eol)
+    {
+      modulemd_memory_usage_add (
+        usage, MD_MEMORY_CATEGORY_OBJECTS, sizeof (GDate));
+    }
+}
@@ -0,0 +1,535 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <fnmatch.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "modulemd-module-stream.h"
+#include "modulemd-stream-query.h"
+#include "private/modulemd-stream-query-private.h"
+#include "private/modulemd-util.h"
+
+/* Large enough for the decimal representation of any guint64 */
+#define MMD_VERSION_STR_LEN 21
+
+/* NSVCA strings shorter than this are assembled on the stack */
+#define MMD_NSVCA_STACK_LEN 256
+
+
+typedef enum
+{
+  MATCH_ANY,
+  MATCH_LITERAL,
+  MATCH_PREFIX,
+  MATCH_GLOB
+} ModulemdPatternKind;
+
+
+typedef struct
+{
+  ModulemdPatternKind kind;
+  gchar *pattern;
+  gsize prefix_len;
+} ModulemdPattern;
+
+
+typedef enum
+{
+  VERSION_MATCH_ANY,
+  VERSION_MATCH_EQUAL,
+  VERSION_MATCH_PREFIX,
+  VERSION_MATCH_GLOB
+} ModulemdVersionPatternKind;
+
+
+typedef struct
+{
+  ModulemdVersionPatternKind kind;
+  gchar *pattern;
+
+  /* For VERSION_MATCH_EQUAL and VERSION_MATCH_PREFIX */
+  guint64 value;
+  guint digits;
+} ModulemdVersionPattern;
+
+
+struct _ModulemdStreamQuery
+{
+  GObject parent_instance;
+
+  gboolean is_nsvca;
+
+  /* Used when is_nsvca is FALSE */
+  ModulemdPattern module_name;
+  ModulemdPattern stream_name;
+  ModulemdVersionPattern version;
+  ModulemdPattern context;
+  ModulemdPattern arch;
+
+  /* Used when is_nsvca is TRUE */
+  ModulemdPattern nsvca;
+
+  /* The only module name that can match, or NULL */
+  gchar *module_name_literal;
+};
+
+G_DEFINE_TYPE (ModulemdStreamQuery, modulemd_stream_query, G_TYPE_OBJECT)
+
+
+static void
+modulemd_stream_query_finalize (GObject *object)
+{
+  ModulemdStreamQuery *self = (ModulemdStreamQuery *)object;
+
+  g_clear_pointer (&self->module_name.pattern, g_free);
+  g_clear_pointer (&self->stream_name.pattern, g_free);
+  g_clear_pointer (&self->version.pattern, g_free);
+  g_clear_pointer (&self->context.pattern, g_free);
+  g_clear_pointer (&self->arch.pattern, g_free);
+  g_clear_pointer (&self->nsvca.pattern, g_free);
+  g_clear_pointer (&self->module_name_literal, g_free);
+
+  G_OBJECT_CLASS (modulemd_stream_query_parent_class)->finalize (object);
+}
+
+
+static void
+modulemd_stream_query_class_init (ModulemdStreamQueryClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = modulemd_stream_query_finalize;
+}
+
+
+static void
+modulemd_stream_query_init (ModulemdStreamQuery *UNUSED (self))
+{
+}
+
+
+/* Returns TRUE if @pattern contains any character that fnmatch() treats
+ * specially. Backslash escapes are included so that such patterns are always
+ * left to fnmatch().
+ */
+static gboolean
+has_pattern_chars (const gchar *pattern, gsize len)
+{
+  for (gsize i = 0; i < len; i++)
+    {
+      switch (pattern[i])
+        {
+        case '*':
+        case '?':
+        case '[':
+        case '\\': return TRUE;
+
+        default: break;
+        }
+    }
+
+  return FALSE;
+}
+
+
+static void
+compile_pattern (ModulemdPattern *compiled, const gchar *pattern)
+{
+  gsize len;
+
+  if (!pattern)
+    {
+      compiled->kind = MATCH_ANY;
+      return;
+    }
+
+  compiled->pattern = g_strdup (pattern);
+  len = strlen (pattern);
+
+  if (!has_pattern_chars (pattern, len))
+    {
+      compiled->kind = MATCH_LITERAL;
+    }
+  else if (len > 0 && pattern[len - 1] == '*' &&
+           !has_pattern_chars (pattern, len - 1))
+    {
+      compiled->kind = MATCH_PREFIX;
+      compiled->prefix_len = len - 1;
+    }
+  else
+    {
+      compiled->kind = MATCH_GLOB;
+    }
+}
+
+
+static gboolean
+pattern_matches (const ModulemdPattern *compiled, const gchar *string)
+{
+  if (compiled->kind == MATCH_ANY)
+    {
+      return TRUE;
+    }
+
+  if (!string)
+    {
+      return FALSE;
+    }
+
+  switch (compiled->kind)
+    {
+    case MATCH_LITERAL: return g_str_equal (compiled->pattern, string);
+
+    case MATCH_PREFIX:
+      return strncmp (compiled->pattern, string, compiled->prefix_len) == 0;
+
+    case MATCH_GLOB: return fnmatch (compiled->pattern, string, 0) == 0;
+
+    default: g_return_val_if_reached (FALSE);
+    }
+}
+
+
+static guint
+count_digits (guint64 value)
+{
+  guint digits = 1;
+
+  while (value >= 10)
+    {
+      value /= 10;
+      digits++;
+    }
+
+  return digits;
+}
+
+
+/* Returns TRUE and sets @value if the first @len characters of @str are the
+ * canonical decimal representation of a guint64, that is the exact string
+ * that formatting @value with PRIu64 would produce.
+ */
+static gboolean
+parse_canonical_u64 (const gchar *str, gsize len, guint64 *value)
+{
+  guint64 result = 0;
+
+  if (len == 0 || len >= MMD_VERSION_STR_LEN)
+    {
+      return FALSE;
+    }
+
+  if (len > 1 && str[0] == '0')
+    {
+      return FALSE;
+    }
+
+  for (gsize i = 0; i < len; i++)
+    {
+      if (!g_ascii_isdigit (str[i]))
+        {
+          return FALSE;
+        }
+
+      if (result > (G_MAXUINT64 - (str[i] - '0')) / 10)
+        {
+          return FALSE;
+        }
+      result = result * 10 + (str[i] - '0');
+    }
+
+  *value = result;
+  return TRUE;
+}
+
+
+static void
+compile_version_pattern (ModulemdVersionPattern *compiled,
+                         const gchar *pattern)
+{
+  gsize len;
+
+  if (!pattern)
+    {
+      compiled->kind = VERSION_MATCH_ANY;
+      return;
+    }
+
+  compiled->pattern = g_strdup (pattern);
+  len = strlen (pattern);
+
+  if (g_str_equal (pattern, "*"))
+    {
+      /* Every version has a string representation, so this matches all */
+      compiled->kind = VERSION_MATCH_ANY;
+    }
+  else if (parse_canonical_u64 (pattern, len, &compiled->value))
+    {
+      compiled->kind = VERSION_MATCH_EQUAL;
+    }
+  else if (len > 1 && pattern[len - 1] == '*' &&
+           parse_canonical_u64 (pattern, len - 1, &compiled->value))
+    {
+      compiled->kind = VERSION_MATCH_PREFIX;
+      compiled->digits = len - 1;
+    }
+  else
+    {
+      compiled->kind = VERSION_MATCH_GLOB;
+    }
+}
+
+
+static gboolean
+version_pattern_matches (const ModulemdVersionPattern *compiled,
+                         guint64 version)
+{
+  gchar version_str[MMD_VERSION_STR_LEN];
+  guint version_digits;
+
+  switch (compiled->kind)
+    {
+    case VERSION_MATCH_ANY: return TRUE;
+
+    case VERSION_MATCH_EQUAL: return version == compiled->value;
+
+    case VERSION_MATCH_PREFIX:
+      /* The decimal representation of @version starts with the digits of
+       * the pattern if and only if dropping its extra trailing digits leaves
+       * the pattern value.
+       */
+      version_digits = count_digits (version);
+      if (version_digits < compiled->digits)
+        {
+          return FALSE;
+        }
+      for (guint i = compiled->digits; i < version_digits; i++)
+        {
+          version /= 10;
+        }
+      return version == compiled->value;
+
+    case VERSION_MATCH_GLOB:
+      g_snprintf (version_str, sizeof (version_str), "%" PRIu64, version);
+      return fnmatch (compiled->pattern, version_str, 0) == 0;
+
+    default: g_return_val_if_reached (FALSE);
+    }
+}
+
+
+ModulemdStreamQuery *
+modulemd_stream_query_new (const gchar *module_name,
+                           const gchar *stream_name,
+                           const gchar *version,
+                           const gchar *context,
+                           const gchar *arch)
+{
+  ModulemdStreamQuery *self = g_object_new (MODULEMD_TYPE_STREAM_QUERY, NULL);
+
+  compile_pattern (&self->module_name, module_name);
+  compile_pattern (&self->stream_name, stream_name);
+  compile_version_pattern (&self->version, version);
+  compile_pattern (&self->context, context);
+  compile_pattern (&self->arch, arch);
+
+  if (self->module_name.kind == MATCH_LITERAL)
+    {
+      self->module_name_literal = g_strdup (module_name);
+    }
+
+  return self;
+}
+
+
+ModulemdStreamQuery *
+modulemd_stream_query_new_from_nsvca_glob (const gchar *nsvca_pattern)
+{
+  ModulemdStreamQuery *self = g_object_new (MODULEMD_TYPE_STREAM_QUERY, NULL);
+  const gchar *colon = NULL;
+
+  self->is_nsvca = TRUE;
+  compile_pattern (&self->nsvca, nsvca_pattern);
+
+  if (nsvca_pattern == NULL)
+    {
+      return self;
+    }
+
+  /* If everything up to the first colon is free of wildcards, the module
+   * name must be exactly that text. A pattern with no colon at all can only
+   * restrict the module name if it is entirely literal.
+   */
+  colon = strchr (nsvca_pattern, ':');
+  if (colon && !has_pattern_chars (nsvca_pattern, colon - nsvca_pattern))
+    {
+      self->module_name_literal =
+        g_strndup (nsvca_pattern, colon - nsvca_pattern);
+    }
+  else if (!colon && self->nsvca.kind == MATCH_LITERAL)
+    {
+      self->module_name_literal = g_strdup (nsvca_pattern);
+    }
+
+  return self;
+}
+
+
+/* Appends @str to the buffer at @pos if it fits. Returns the new position or
+ * -1 if @str would overflow it.
+ */
+static gssize
+append_to_buf (gchar *buf, gssize pos, gsize buf_len, const gchar *str)
+{
+  gsize len;
+
+  if (pos < 0)
+    {
+      return -1;
+    }
+
+  len = strlen (str);
+  if (pos + len + 1 > buf_len)
+    {
+      return -1;
+    }
+
+  memcpy (buf + pos, str, len);
+  return pos + len;
+}
+
+
+static gboolean
+nsvca_matches (ModulemdStreamQuery *self, ModulemdModuleStream *stream)
+{
+  gchar buf[MMD_NSVCA_STACK_LEN];
+  gchar version_str[MMD_VERSION_STR_LEN] = "";
+  g_autofree gchar *nsvca = NULL;
+  const gchar *module_name = NULL;
+  const gchar *stream_name = NULL;
+  const gchar *context = NULL;
+  const gchar *arch = NULL;
+  guint64 version;
+  gssize pos = 0;
+
+  if (self->nsvca.kind == MATCH_ANY)
+    {
+      return TRUE;
+    }
+
+  module_name = modulemd_module_stream_get_module_name (stream);
+  if (!module_name)
+    {
+      return FALSE;
+    }
+
+  if (self->module_name_literal &&
+      !g_str_equal (self->module_name_literal, module_name))
+    {
+      return FALSE;
+    }
+
+  /* Assemble the same string that modulemd_module_stream_get_NSVCA_as_string()
+   * returns, but on the stack unless it is unusually long.
+   */
+  stream_name = modulemd_module_stream_get_stream_name (stream);
+  version = modulemd_module_stream_get_version (stream);
+  context = modulemd_module_stream_get_context (stream);
+  arch = modulemd_module_stream_get_arch (stream);
+
+  if (version)
+    {
+      g_snprintf (version_str, sizeof (version_str), "%" PRIu64, version);
+    }
+
+  pos = append_to_buf (buf, pos, sizeof (buf), module_name);
+  pos = append_to_buf (buf, pos, sizeof (buf), ":");
+  pos = append_to_buf (buf, pos, sizeof (buf), stream_name ? stream_name : "");
+  pos = append_to_buf (buf, pos, sizeof (buf), ":");
+  pos = append_to_buf (buf, pos, sizeof (buf), version_str);
+  pos = append_to_buf (buf, pos, sizeof (buf), ":");
+  pos = append_to_buf (buf, pos, sizeof (buf), context ? context : "");
+  pos = append_to_buf (buf, pos, sizeof (buf), ":");
+  pos = append_to_buf (buf, pos, sizeof (buf), arch ? arch : "");
+
+  if (pos < 0)
+    {
+      nsvca = modulemd_module_stream_get_NSVCA_as_string (stream);
+      return pattern_matches (&self->nsvca, nsvca);
+    }
+
+  /* Remove any trailing colons */
+  while (pos > 1 && buf[pos - 1] == ':')
+    {
+      pos--;
+    }
+  buf[pos] = '\0';
+
+  return pattern_matches (&self->nsvca, buf);
+}
+
+
+gboolean
+modulemd_stream_query_matches (ModulemdStreamQuery *self,
+                               ModulemdModuleStream *stream)
+{
+  g_return_val_if_fail (MODULEMD_IS_STREAM_QUERY (self), FALSE);
+  g_return_val_if_fail (MODULEMD_IS_MODULE_STREAM (stream), FALSE);
+
+  if (self->is_nsvca)
+    {
+      return nsvca_matches (self, stream);
+    }
+
+  /* Cheapest checks first */
+  return version_pattern_matches (
+           &self->version, modulemd_module_stream_get_version (stream)) &&
+         pattern_matches (&self->module_name,
+                          modulemd_module_stream_get_module_name (stream)) &&
+         pattern_matches (&self->stream_name,
+                          modulemd_module_stream_get_stream_name (stream)) &&
+         pattern_matches (&self->context,
+                          modulemd_module_stream_get_context (stream)) &&
+         pattern_matches (&self->arch,
+                          modulemd_module_stream_get_arch (stream));
+}
+
+
+const gchar *
+modulemd_stream_query_get_module_name_literal (ModulemdStreamQuery *self)
+{
+  g_return_val_if_fail (MODULEMD_IS_STREAM_QUERY (self), NULL);
+
+  return self->module_name_literal;
+}
+
+
+gboolean
+modulemd_stream_query_may_match_module (ModulemdStreamQuery *self,
+                                        const gchar *module_name)
+{
+  g_return_val_if_fail (MODULEMD_IS_STREAM_QUERY (self), FALSE);
+
+  if (self->module_name_literal)
+    {
+      return g_strcmp0 (self->module_name_literal, module_name) == 0;
+    }
+
+  if (self->is_nsvca)
+    {
+      return TRUE;
+    }
+
+  return pattern_matches (&self->module_name, module_name);
+}
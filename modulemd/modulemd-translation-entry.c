@@ -17,6 +17,7 @@
 #include "modulemd-errors.h"
 #include "modulemd-translation-entry.h"
 #include "private/glib-extensions.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-translation-entry-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
@@ -32,6 +33,11 @@ struct _ModulemdTranslationEntry
   gchar *description;
 
   GHashTable *profile_descriptions;
+
+  /* Set by modulemd_translation_entry_freeze(); nothing may change
+   * afterwards
+   */
+  gboolean frozen;
 };
 
 G_DEFINE_TYPE (ModulemdTranslationEntry,
@@ -104,6 +110,7 @@ modulemd_translation_entry_set_summary (ModulemdTranslationEntry *self,
                                         const gchar *summary)
 {
   g_return_if_fail (MODULEMD_IS_TRANSLATION_ENTRY (self));
+  g_return_if_fail (!self->frozen);
 
   g_clear_pointer (&self->summary, g_free);
   self->summary = g_strdup (summary);
@@ -126,6 +133,7 @@ modulemd_translation_entry_set_description (ModulemdTranslationEntry *self,
                                             const gchar *description)
 {
   g_return_if_fail (MODULEMD_IS_TRANSLATION_ENTRY (self));
+  g_return_if_fail (!self->frozen);
 
   g_clear_pointer (&self->description, g_free);
   self->description = g_strdup (description);
@@ -185,6 +193,9 @@ modulemd_translation_entry_set_profile_description (
   const gchar *profile_name,
   const gchar *profile_description)
 {
+  g_return_if_fail (MODULEMD_IS_TRANSLATION_ENTRY (self));
+  g_return_if_fail (!self->frozen);
+
   g_hash_table_replace (self->profile_descriptions,
                         g_strdup (profile_name),
                         g_strdup (profile_description));
@@ -665,3 +676,26 @@ modulemd_translation_entry_emit_yaml (ModulemdTranslationEntry *self,
 
   return TRUE;
 }
+
+
+void
+modulemd_translation_entry_add_memory_usage (ModulemdTranslationEntry *self,
+                                             ModulemdMemoryUsage *usage)
+{
+  g_return_if_fail (MODULEMD_IS_TRANSLATION_ENTRY (self));
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_string (usage, self->locale);
+  modulemd_memory_usage_add_string (usage, self->summary);
+  modulemd_memory_usage_add_string (usage, self->description);
+  modulemd_memory_usage_add_string_map (usage, self->profile_descriptions);
+}
+
+
+void
+modulemd_translation_entry_freeze (ModulemdTranslationEntry *self)
+{
+  g_return_if_fail (MODULEMD_IS_TRANSLATION_ENTRY (self));
+
+  self->frozen = TRUE;
+}
@@ -19,6 +19,7 @@
 #include "modulemd-translation-entry.h"
 #include "modulemd-translation.h"
 #include "private/glib-extensions.h"
+#include "private/modulemd-memory-usage-private.h"
 #include "private/modulemd-subdocument-info-private.h"
 #include "private/modulemd-translation-entry-private.h"
 #include "private/modulemd-translation-private.h"
@@ -38,6 +39,9 @@ struct _ModulemdTranslation
   guint64 modified;
 
   GHashTable *translation_entries;
+
+  /* Set by modulemd_translation_freeze(); nothing may change afterwards */
+  gboolean frozen;
 };
 
 G_DEFINE_TYPE (ModulemdTranslation, modulemd_translation, G_TYPE_OBJECT)
@@ -247,6 +251,7 @@ void
 modulemd_translation_set_modified (ModulemdTranslation *self, guint64 modified)
 {
   g_return_if_fail (MODULEMD_IS_TRANSLATION (self));
+  g_return_if_fail (!self->frozen);
 
   self->modified = modified;
 
@@ -268,6 +273,7 @@ modulemd_translation_set_translation_entry (
   ModulemdTranslation *self, ModulemdTranslationEntry *translation_entry)
 {
   g_return_if_fail (MODULEMD_IS_TRANSLATION (self));
+  g_return_if_fail (!self->frozen);
 
   g_hash_table_insert (
     self->translation_entries,
@@ -674,7 +680,6 @@ modulemd_translation_emit_yaml (ModulemdTranslation *self,
 {
   MODULEMD_INIT_TRACE ();
   g_autoptr (GError) nested_error = NULL;
-  g_autofree gchar *modified_string = NULL;
 
   if (!modulemd_translation_validate (self, &nested_error))
     {
@@ -684,9 +689,6 @@ modulemd_translation_emit_yaml (ModulemdTranslation *self,
       return FALSE;
     }
 
-  modified_string =
-    g_strdup_printf ("%" PRIu64, modulemd_translation_get_modified (self));
-
   /* Emit document headers */
   if (!modulemd_yaml_emit_document_headers (
         emitter,
@@ -733,8 +735,8 @@ modulemd_translation_emit_yaml (ModulemdTranslation *self,
       return FALSE;
     }
 
-  if (!mmd_emitter_scalar (
-        emitter, modified_string, YAML_PLAIN_SCALAR_STYLE, error))
+  if (!mmd_emitter_scalar_uint64 (
+        emitter, modulemd_translation_get_modified (self), error))
     {
       return FALSE;
     }
@@ -773,3 +775,50 @@ modulemd_translation_emit_yaml (ModulemdTranslation *self,
 
   return TRUE;
 }
+
+
+void
+modulemd_translation_add_memory_usage (ModulemdTranslation *self,
+                                       ModulemdMemoryUsage *usage)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_TRANSLATION (self));
+
+  modulemd_memory_usage_push_section (usage, MD_MEMORY_CATEGORY_TRANSLATIONS);
+
+  modulemd_memory_usage_add_object (usage, self);
+  modulemd_memory_usage_add_string (usage, self->module_name);
+  modulemd_memory_usage_add_string (usage, self->module_stream);
+
+  modulemd_memory_usage_add_hash_table (usage, self->translation_entries);
+  g_hash_table_iter_init (&iter, self->translation_entries);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      modulemd_memory_usage_add_string (usage, key);
+      modulemd_translation_entry_add_memory_usage (
+        MODULEMD_TRANSLATION_ENTRY (value), usage);
+    }
+
+  modulemd_memory_usage_pop_section (usage);
+}
+
+
+void
+modulemd_translation_freeze (ModulemdTranslation *self)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_if_fail (MODULEMD_IS_TRANSLATION (self));
+
+  g_hash_table_iter_init (&iter, self->translation_entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      modulemd_translation_entry_freeze (value);
+    }
+
+  self->frozen = TRUE;
+}
@@ -49,6 +49,67 @@ modulemd_trace_free (modulemd_tracer *tracer)
 }
 
 
+gchar *
+modulemd_str_intern (const gchar *str)
+{
+  if (!str)
+    {
+      return NULL;
+    }
+
+#ifdef HAVE_G_REF_STRING
+  return g_ref_string_new_intern (str);
+#else
+  return g_strdup (str);
+#endif
+}
+
+
+void
+modulemd_str_release (gpointer str)
+{
+  if (!str)
+    {
+      return;
+    }
+
+#ifdef HAVE_G_REF_STRING
+  g_ref_string_release (str);
+#else
+  g_free (str);
+#endif
+}
+
+
+gboolean
+modulemd_str_equal (gconstpointer a, gconstpointer b)
+{
+  return a == b || g_str_equal (a, b);
+}
+
+
+GHashTable *
+modulemd_str_set_new (void)
+{
+  return g_hash_table_new_full (
+    g_str_hash, modulemd_str_equal, modulemd_str_release, NULL);
+}
+
+
+/* Only ever increased. A gsize is used because that is the widest type GLib
+ * offers atomic addition for; on 32-bit platforms it wraps after four
+ * billion modifications.
+ */
+static gsize last_generation = 0;
+
+
+guint64
+modulemd_next_generation (void)
+{
+  return (guint64)g_atomic_pointer_add (&last_generation, 1) + 1;
+}
+
+
 GHashTable *
 modulemd_hash_table_deep_str_copy (GHashTable *orig)
 {
@@ -82,12 +143,12 @@ modulemd_hash_table_deep_set_copy (GHashTable *orig)
 
   g_return_val_if_fail (orig, NULL);
 
-  new = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  new = modulemd_str_set_new ();
 
   g_hash_table_iter_init (&iter, orig);
   while (g_hash_table_iter_next (&iter, &key, &value))
     {
-      g_hash_table_add (new, g_strdup ((const gchar *)key));
+      g_hash_table_add (new, modulemd_str_intern ((const gchar *)key));
     }
 
   return new;
@@ -152,9 +213,13 @@ modulemd_hash_table_sets_are_equal_wrapper (const void *a, const void *b)
 gboolean
 modulemd_hash_table_sets_are_equal (GHashTable *a, GHashTable *b)
 {
-  g_autoptr (GPtrArray) set_a = NULL;
-  g_autoptr (GPtrArray) set_b = NULL;
+  GHashTableIter iter;
+  gpointer key;
 
+  if (a == b)
+    {
+      return TRUE;
+    }
 
   if (g_hash_table_size (a) != g_hash_table_size (b))
     {
@@ -164,17 +229,14 @@ modulemd_hash_table_sets_are_equal (GHashTable *a, GHashTable *b)
       return FALSE;
     }
 
-  set_a = modulemd_ordered_str_keys (a, modulemd_strcmp_sort);
-  set_b = modulemd_ordered_str_keys (b, modulemd_strcmp_sort);
-
-  for (guint i = 0; i < set_a->len; i++)
+  /* Sets of the same size are equal if every key of one is in the other.
+   * Equal interned strings are the same pointer, so the lookup does not need
+   * to compare their characters.
+   */
+  g_hash_table_iter_init (&iter, a);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
     {
-      /* These are guaranteed to be returned ordered, so we can
-       * assume that any difference at any index means that the
-       * lists are not identical.
-       */
-      if (!g_str_equal (g_ptr_array_index (set_a, i),
-                        g_ptr_array_index (set_b, i)))
+      if (!g_hash_table_contains (b, key))
         {
           /* No match, so this simpleset is not equal */
           return FALSE;
@@ -185,18 +247,23 @@ modulemd_hash_table_sets_are_equal (GHashTable *a, GHashTable *b)
   return TRUE;
 }
 
-/* Processes the set of keys first, then calls a unique compare function to handle any kind of value*/
+/* Compares the keys by looking each one up in the other table, so that no
+ * sorted copy of either table is needed.
+ */
 gboolean
 modulemd_hash_table_equals (GHashTable *a,
                             GHashTable *b,
                             GEqualFunc compare_func)
 {
-  g_autoptr (GPtrArray) set_a = NULL;
-  g_autoptr (GPtrArray) set_b = NULL;
-  guint i = 0;
-  gchar *key = NULL;
-  gchar *value_a = NULL;
-  gchar *value_b = NULL;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value_a;
+  gpointer value_b;
+
+  if (a == b)
+    {
+      return TRUE;
+    }
 
   /*Check size*/
   if (g_hash_table_size (a) != g_hash_table_size (b))
@@ -204,25 +271,16 @@ modulemd_hash_table_equals (GHashTable *a,
       return FALSE;
     }
 
-  /*Equality check on keys of hashtable*/
-  set_a = modulemd_ordered_str_keys (a, modulemd_strcmp_sort);
-  set_b = modulemd_ordered_str_keys (b, modulemd_strcmp_sort);
-
-  for (i = 0; i < set_a->len; i++)
+  /* Tables of the same size are equal if every key of one is in the other
+   * with an equal value.
+   */
+  g_hash_table_iter_init (&iter, a);
+  while (g_hash_table_iter_next (&iter, &key, &value_a))
     {
-      if (!g_str_equal (g_ptr_array_index (set_a, i),
-                        g_ptr_array_index (set_b, i)))
+      if (!g_hash_table_lookup_extended (b, key, NULL, &value_b))
         {
           return FALSE;
         }
-    }
-
-  /*Equality check for each value of all keys of hashtable*/
-  for (i = 0; i < set_a->len; i++)
-    {
-      key = g_ptr_array_index (set_a, i);
-      value_a = g_hash_table_lookup (a, key);
-      value_b = g_hash_table_lookup (b, key);
 
       if (!compare_func (value_a, value_b))
         {
@@ -248,8 +306,8 @@ modulemd_hash_table_compare (GHashTable *a,
   gint cmp;
 
   /* Get the ordered list of keys from each hashtable. */
-  set_a = modulemd_ordered_str_keys (a, modulemd_strcmp_sort);
-  set_b = modulemd_ordered_str_keys (b, modulemd_strcmp_sort);
+  set_a = modulemd_sorted_str_keys (a);
+  set_b = modulemd_sorted_str_keys (b);
 
   for (i = 0; i < set_a->len; i++)
     {
@@ -326,6 +384,25 @@ modulemd_ordered_str_keys (GHashTable *htable, GCompareFunc compare_func)
   return keys;
 }
 
+GPtrArray *
+modulemd_sorted_str_keys (GHashTable *htable)
+{
+  GPtrArray *keys;
+  GHashTableIter iter;
+  gpointer key;
+
+  keys = g_ptr_array_sized_new (g_hash_table_size (htable));
+
+  g_hash_table_iter_init (&iter, htable);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      g_ptr_array_add (keys, key);
+    }
+  g_ptr_array_sort (keys, modulemd_strcmp_sort);
+
+  return keys;
+}
+
 GStrv
 modulemd_ordered_str_keys_as_strv (GHashTable *htable)
 {
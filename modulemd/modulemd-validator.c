@@ -15,7 +15,9 @@
 #include "modulemd.h"
 #include "modulemd-errors.h"
 #include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-document-reader-private.h"
 #include "private/modulemd-module-index-private.h"
+#include "private/modulemd-module-private.h"
 #include "private/modulemd-module-stream-v1-private.h"
 #include "private/modulemd-module-stream-v2-private.h"
 #include "private/modulemd-obsoletes-private.h"
@@ -25,7 +27,9 @@
 #include "private/modulemd-util.h"
 
 #include <errno.h>
+#include <gio/gio.h>
 #include <glib.h>
+#include <glib/gprintf.h>
 #include <locale.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -62,8 +66,34 @@ struct validator_options
   GType type;
   gchar **filenames;
   gboolean report_version;
+  gint jobs;
+  gboolean stats;
+  gboolean json;
+  gboolean from_list;
 };
 
+/* The number of files listed as the slowest by --stats and --json */
+#define MMD_SLOWEST_FILES 10
+
+/* The outcome of validating one file. Results are filled in by the worker
+ * threads and reported by the main thread in the order of the input, so
+ * that the output does not depend on the number of jobs.
+ */
+struct file_result
+{
+  const gchar *filename;
+  gboolean valid;
+  GError *error;
+  GPtrArray *failures;
+  guint64 documents;
+  gint64 elapsed;       /* microseconds */
+  gint64 validate_time; /* microseconds of elapsed spent validating */
+  gboolean done;
+};
+
+static GMutex results_lock;
+static GCond results_cond;
+
 struct validator_options options = { 0 };
 
 static gboolean
@@ -188,6 +218,10 @@ mmd_type2astring (enum mmd_type type)
 // clang-format off
 static GOptionEntry entries[] = {
   { "debug", 0, G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, set_verbosity, "Output debugging messages", NULL },
+  { "from-list", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &options.from_list, "Also validate the files listed on the standard input, one per line", NULL },
+  { "jobs", 'j', G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &options.jobs, "Validate up to N files concurrently; 0 means one job per processor (default: 1)", "N" },
+  { "json", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &options.json, "Print a JSON report with the results and statistics instead of the usual messages", NULL },
+  { "stats", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &options.stats, "Report the time taken and the documents read for each file and list the slowest files", NULL },
   { "type", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_CALLBACK, set_type, "Constrain a document type (modulemd-v1, modulemd-v2, modulemd-defaults-v1, modulemd-obsoletes-v1, modulemd-packager-v2, modulemd-packager-v3, modulemd-translations-v1); by default any document type loadable into a modulemd index is acceptable; this option only supports single-document files", "TYPE" },
   { "quiet", 'q', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, set_verbosity, "Print no output", NULL },
   { "verbose", 'v', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, set_verbosity, "Be verbose", NULL },
@@ -206,20 +240,39 @@ ModulemdYamlDocumentTypeEnum2string (ModulemdYamlDocumentTypeEnum type)
     case MODULEMD_YAML_DOC_TRANSLATIONS: return "modulemd-translations";
     case MODULEMD_YAML_DOC_PACKAGER: return "modulemd-packager";
     case MODULEMD_YAML_DOC_OBSOLETES: return "modulemd-obsoletes";
+    case MODULEMD_YAML_DOC_DELTA: return "modulemd-delta";
     case MODULEMD_YAML_DOC_UNKNOWN: /* fall through */
     default: return "unknown type";
     }
 }
 
+/* Runs the validate method of a stream and adds the time it took to
+ * @validate_time.
+ */
+static gboolean
+validate_stream_timed (ModulemdModuleStream *stream,
+                       gint64 *validate_time,
+                       GError **error)
+{
+  gint64 start = g_get_monotonic_time ();
+  gboolean ret = modulemd_module_stream_validate (stream, error);
+
+  *validate_time += g_get_monotonic_time () - start;
+  return ret;
+}
+
 /* We cannot load by index as it converts from old versions before
  * a return and as it does not provide enumeration functions for
  * subdocuments. We will use private modulemd_defaults_v1_parse_yaml() etc.
- * parsers. */
+ * parsers. The parsers of the document types that are validated implicitly
+ * validate while parsing, so no separate validation time is recorded for
+ * them. */
 static gboolean
 parse_file_as_subdoc_and_validate (const gchar *filename,
                                    enum mmd_type validation_type,
                                    ModulemdYamlDocumentTypeEnum expected_type,
                                    guint64 expected_version,
+                                   gint64 *validate_time,
                                    GError **error)
 {
   g_autoptr (FILE) file = NULL;
@@ -306,8 +359,8 @@ parse_file_as_subdoc_and_validate (const gchar *filename,
     case MMD_TYPE_MODULEMD_V1:
       object =
         G_OBJECT (modulemd_module_stream_v1_parse_yaml (subdoc, TRUE, error));
-      if (object && !modulemd_module_stream_validate (
-                      MODULEMD_MODULE_STREAM (object), error))
+      if (object && !validate_stream_timed (
+                      MODULEMD_MODULE_STREAM (object), validate_time, error))
         g_clear_object (&object);
       break;
     case MMD_TYPE_MODULEMD_DEFAULTS_V1:
@@ -322,8 +375,8 @@ parse_file_as_subdoc_and_validate (const gchar *filename,
     case MMD_TYPE_MODULEMD_PACKAGER_V2:
       object = G_OBJECT (
         modulemd_module_stream_v2_parse_yaml (subdoc, TRUE, TRUE, error));
-      if (object && !modulemd_module_stream_validate (
-                      MODULEMD_MODULE_STREAM (object), error))
+      if (object && !validate_stream_timed (
+                      MODULEMD_MODULE_STREAM (object), validate_time, error))
         g_clear_object (&object);
       break;
     case MMD_TYPE_MODULEMD_TRANSLATIONS_V1:
@@ -360,26 +413,67 @@ parse_file_as_subdoc_and_validate (const gchar *filename,
   return TRUE;
 }
 
-static gboolean
-parse_file (const gchar *filename, GPtrArray **failures, GError **error)
+/* The index merges some subdocuments, e.g. translations of a stream, so
+ * this counts the documents it holds rather than those that were read.
+ */
+static guint64
+count_index_documents (ModulemdModuleIndex *index)
 {
-  if (options.verbosity >= MMD_VERBOSE)
+  guint64 n_documents = 0;
+  ModulemdModule *module = NULL;
+  g_auto (GStrv) module_names = NULL;
+  g_autoptr (GPtrArray) translations = NULL;
+
+  module_names = modulemd_module_index_get_module_names_as_strv (index);
+  for (gsize i = 0; module_names[i]; i++)
     {
-      g_fprintf (stdout, "Validating %s\n", filename);
+      module = modulemd_module_index_get_module (index, module_names[i]);
+      translations = modulemd_module_get_translated_streams (module);
+      n_documents += translations->len;
+      n_documents += modulemd_module_get_obsoletes (module)->len;
+      n_documents += modulemd_module_get_all_streams (module)->len;
+      if (modulemd_module_get_defaults (module))
+        {
+          n_documents++;
+        }
+      g_clear_pointer (&translations, g_ptr_array_unref);
     }
 
+  return n_documents;
+}
+
+/* Adds the time spent validating to @validate_time, the rest is spent
+ * parsing.
+ */
+static gboolean
+parse_file (const gchar *filename,
+            guint64 *documents,
+            GPtrArray **failures,
+            gint64 *validate_time,
+            GError **error)
+{
   switch (options.type)
     {
     case MMD_TYPE_INDEX:
       {
         g_autoptr (ModulemdModuleIndex) index = NULL;
+        gboolean ret;
         index = modulemd_module_index_new ();
-        return modulemd_module_index_update_from_file_ext (
+        /* The index validates each document as soon as it has been parsed */
+        modulemd_document_reader_time_validation (validate_time);
+        ret = modulemd_module_index_update_from_file_ext (
           index, filename, TRUE, TRUE, failures, error);
+        modulemd_document_reader_time_validation (NULL);
+        *documents = count_index_documents (index);
+        return ret;
       }
     case MMD_TYPE_MODULEMD_V1:
-      return parse_file_as_subdoc_and_validate (
-        filename, options.type, MODULEMD_YAML_DOC_MODULESTREAM, 1u, error);
+      return parse_file_as_subdoc_and_validate (filename,
+                                                options.type,
+                                                MODULEMD_YAML_DOC_MODULESTREAM,
+                                                1u,
+                                                validate_time,
+                                                error);
     case MMD_TYPE_MODULEMD_V2:
       {
         GType type;
@@ -396,18 +490,30 @@ parse_file (const gchar *filename, GPtrArray **failures, GError **error)
                          g_type_name (type));
             return FALSE;
           }
-        return modulemd_module_stream_validate (
-          MODULEMD_MODULE_STREAM (object), error);
+        return validate_stream_timed (
+          MODULEMD_MODULE_STREAM (object), validate_time, error);
       }
     case MMD_TYPE_MODULEMD_DEFAULTS_V1:
-      return parse_file_as_subdoc_and_validate (
-        filename, options.type, MODULEMD_YAML_DOC_DEFAULTS, 1u, error);
+      return parse_file_as_subdoc_and_validate (filename,
+                                                options.type,
+                                                MODULEMD_YAML_DOC_DEFAULTS,
+                                                1u,
+                                                validate_time,
+                                                error);
     case MMD_TYPE_MODULEMD_OBSOLETES_V1:
-      return parse_file_as_subdoc_and_validate (
-        filename, options.type, MODULEMD_YAML_DOC_OBSOLETES, 1u, error);
+      return parse_file_as_subdoc_and_validate (filename,
+                                                options.type,
+                                                MODULEMD_YAML_DOC_OBSOLETES,
+                                                1u,
+                                                validate_time,
+                                                error);
     case MMD_TYPE_MODULEMD_PACKAGER_V2:
-      return parse_file_as_subdoc_and_validate (
-        filename, options.type, MODULEMD_YAML_DOC_PACKAGER, 2u, error);
+      return parse_file_as_subdoc_and_validate (filename,
+                                                options.type,
+                                                MODULEMD_YAML_DOC_PACKAGER,
+                                                2u,
+                                                validate_time,
+                                                error);
     case MMD_TYPE_MODULEMD_PACKAGER_V3:
       {
         GType type;
@@ -429,8 +535,12 @@ parse_file (const gchar *filename, GPtrArray **failures, GError **error)
         return TRUE;
       }
     case MMD_TYPE_MODULEMD_TRANSLATIONS_V1:
-      return parse_file_as_subdoc_and_validate (
-        filename, options.type, MODULEMD_YAML_DOC_TRANSLATIONS, 1u, error);
+      return parse_file_as_subdoc_and_validate (filename,
+                                                options.type,
+                                                MODULEMD_YAML_DOC_TRANSLATIONS,
+                                                1u,
+                                                validate_time,
+                                                error);
     }
   g_fprintf (stderr,
              "Internal error: unsupported document type: %s\n",
@@ -439,20 +549,370 @@ parse_file (const gchar *filename, GPtrArray **failures, GError **error)
 }
 
 
+static void
+validate_file (struct file_result *result)
+{
+  gint64 start = g_get_monotonic_time ();
+
+  result->valid = parse_file (result->filename,
+                              &result->documents,
+                              &result->failures,
+                              &result->validate_time,
+                              &result->error);
+  result->elapsed = g_get_monotonic_time () - start;
+
+  /* Typed validation only accepts single-document files */
+  if (options.type != MMD_TYPE_INDEX && result->valid)
+    {
+      result->documents = 1;
+    }
+}
+
+
+static void
+validate_file_worker (gpointer data, gpointer UNUSED (user_data))
+{
+  struct file_result *result = data;
+
+  validate_file (result);
+
+  g_mutex_lock (&results_lock);
+  result->done = TRUE;
+  g_cond_broadcast (&results_cond);
+  g_mutex_unlock (&results_lock);
+}
+
+
+static void
+wait_for_result (struct file_result *result)
+{
+  g_mutex_lock (&results_lock);
+  while (!result->done)
+    {
+      g_cond_wait (&results_cond, &results_lock);
+    }
+  g_mutex_unlock (&results_lock);
+}
+
+
+static void
+print_validating (const struct file_result *result)
+{
+  if (!options.json && options.verbosity >= MMD_VERBOSE)
+    {
+      g_fprintf (stdout, "Validating %s\n", result->filename);
+    }
+}
+
+
+static void
+print_result (const struct file_result *result)
+{
+  ModulemdSubdocumentInfo *doc = NULL;
+
+  if (options.verbosity < MMD_DEFAULT)
+    {
+      return;
+    }
+
+  if (!result->valid)
+    {
+      g_fprintf (stderr, "%s failed to validate\n", result->filename);
+
+      if (result->error != NULL)
+        {
+          /* Unparseable content */
+          g_fprintf (stderr,
+                     "%s could not be read in its entirety: %s\n",
+                     result->filename,
+                     result->error->message);
+        }
+      if (result->failures)
+        {
+          for (gsize j = 0; j < result->failures->len; j++)
+            {
+              doc = MODULEMD_SUBDOCUMENT_INFO (
+                g_ptr_array_index (result->failures, j));
+              g_printf ("\nFailed subdocument (%s): \n%s\n",
+                        modulemd_subdocument_info_get_gerror (doc)->message,
+                        modulemd_subdocument_info_get_yaml (doc));
+            }
+        }
+    }
+  else
+    {
+      g_printf ("%s validated successfully\n", result->filename);
+    }
+
+  if (options.stats)
+    {
+      g_printf ("%s: %.3f ms (%.3f ms parsing, %.3f ms validating), "
+                "%" G_GUINT64_FORMAT " documents, %u failed\n",
+                result->filename,
+                result->elapsed / 1000.0,
+                (result->elapsed - result->validate_time) / 1000.0,
+                result->validate_time / 1000.0,
+                result->documents,
+                result->failures ? result->failures->len : 0);
+    }
+}
+
+
+/* Writes @str as a JSON string of ASCII characters only, so that the output
+ * does not depend on the encoding of the locale. File names, and error
+ * messages quoting the content of files, need not be UTF-8, but JSON text
+ * must be; invalid bytes are written as U+FFFD.
+ */
+static void
+json_append_string (GString *json, const gchar *str)
+{
+  const gchar *p = str;
+  gunichar c;
+
+  g_string_append_c (json, '"');
+  while (*p)
+    {
+      c = g_utf8_get_char_validated (p, -1);
+      if (c == (gunichar)-1 || c == (gunichar)-2)
+        {
+          g_string_append (json, "\\ufffd");
+          p++;
+          continue;
+        }
+      p = g_utf8_next_char (p);
+
+      switch (c)
+        {
+        case '"': g_string_append (json, "\\\""); break;
+        case '\\': g_string_append (json, "\\\\"); break;
+        case '\n': g_string_append (json, "\\n"); break;
+        case '\r': g_string_append (json, "\\r"); break;
+        case '\t': g_string_append (json, "\\t"); break;
+        default:
+          if (c >= 0x20 && c < 0x7f)
+            {
+              g_string_append_c (json, (gchar)c);
+              break;
+            }
+
+          /* Characters outside of the BMP take a surrogate pair */
+          if (c > 0xffff)
+            {
+              c -= 0x10000;
+              g_string_append_printf (json,
+                                      "\\u%04x\\u%04x",
+                                      0xd800 + (c >> 10),
+                                      0xdc00 + (c & 0x3ff));
+            }
+          else
+            {
+              g_string_append_printf (json, "\\u%04x", c);
+            }
+        }
+    }
+  g_string_append_c (json, '"');
+}
+
+
+/* JSON numbers must not depend on the locale set up in main () */
+static void
+json_append_milliseconds (GString *json, gint64 microseconds)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append (
+    json, g_ascii_formatd (buf, sizeof (buf), "%.3f", microseconds / 1000.0));
+}
+
+
+static void
+print_json_result (const struct file_result *result, gboolean first)
+{
+  g_autoptr (GString) json = g_string_new (first ? "\n    { " : ",\n    { ");
+  ModulemdSubdocumentInfo *doc = NULL;
+  gboolean first_error = TRUE;
+
+  g_string_append (json, "\"file\": ");
+  json_append_string (json, result->filename);
+  g_string_append_printf (
+    json, ", \"valid\": %s", result->valid ? "true" : "false");
+  g_string_append (json, ", \"time_ms\": ");
+  json_append_milliseconds (json, result->elapsed);
+  g_string_append (json, ", \"parse_ms\": ");
+  json_append_milliseconds (json, result->elapsed - result->validate_time);
+  g_string_append (json, ", \"validate_ms\": ");
+  json_append_milliseconds (json, result->validate_time);
+  g_string_append_printf (json,
+                          ", \"documents\": %" G_GUINT64_FORMAT
+                          ", \"failed_documents\": %u, \"errors\": [",
+                          result->documents,
+                          result->failures ? result->failures->len : 0);
+
+  if (result->error != NULL)
+    {
+      json_append_string (json, result->error->message);
+      first_error = FALSE;
+    }
+  if (result->failures)
+    {
+      for (gsize j = 0; j < result->failures->len; j++)
+        {
+          doc = MODULEMD_SUBDOCUMENT_INFO (
+            g_ptr_array_index (result->failures, j));
+          if (!first_error)
+            {
+              g_string_append (json, ", ");
+            }
+          json_append_string (
+            json, modulemd_subdocument_info_get_gerror (doc)->message);
+          first_error = FALSE;
+        }
+    }
+  g_string_append (json, "] }");
+
+  fputs (json->str, stdout);
+}
+
+
+static gint
+compare_elapsed_descending (gconstpointer a, gconstpointer b)
+{
+  const struct file_result *result_a = *(struct file_result **)a;
+  const struct file_result *result_b = *(struct file_result **)b;
+
+  if (result_a->elapsed != result_b->elapsed)
+    {
+      return result_a->elapsed > result_b->elapsed ? -1 : 1;
+    }
+  return 0;
+}
+
+
+static void
+print_summary (struct file_result *results,
+               guint n_files,
+               guint n_jobs,
+               gint64 wall_time)
+{
+  g_autoptr (GPtrArray) slowest = g_ptr_array_sized_new (n_files);
+  g_autoptr (GString) json = NULL;
+  guint n_invalid = 0;
+  guint64 n_documents = 0;
+  guint n_slowest;
+  struct file_result *result = NULL;
+
+  for (guint i = 0; i < n_files; i++)
+    {
+      if (!results[i].valid)
+        {
+          n_invalid++;
+        }
+      n_documents += results[i].documents;
+      g_ptr_array_add (slowest, &results[i]);
+    }
+
+  /* The sort is stable, so ties keep the input order */
+  g_ptr_array_sort (slowest, compare_elapsed_descending);
+  n_slowest = MIN (n_files, MMD_SLOWEST_FILES);
+
+  if (options.json)
+    {
+      json = g_string_new ("\n  ],\n  \"summary\": { ");
+      g_string_append_printf (json,
+                              "\"files\": %u, \"valid\": %u, "
+                              "\"invalid\": %u, "
+                              "\"documents\": %" G_GUINT64_FORMAT ", "
+                              "\"wall_time_ms\": ",
+                              n_files,
+                              n_files - n_invalid,
+                              n_invalid,
+                              n_documents);
+      json_append_milliseconds (json, wall_time);
+      g_string_append (json, ", \"slowest\": [");
+      for (guint i = 0; i < n_slowest; i++)
+        {
+          result = g_ptr_array_index (slowest, i);
+          if (i > 0)
+            {
+              g_string_append (json, ", ");
+            }
+          json_append_string (json, result->filename);
+        }
+      g_string_append (json, "] }\n}\n");
+      fputs (json->str, stdout);
+      return;
+    }
+
+  g_printf ("\nValidated %u files (%u valid, %u invalid) with "
+            "%" G_GUINT64_FORMAT " documents in %.3f s using %u jobs\n",
+            n_files,
+            n_files - n_invalid,
+            n_invalid,
+            n_documents,
+            wall_time / 1000000.0,
+            n_jobs);
+  g_printf ("Slowest files:\n");
+  for (guint i = 0; i < n_slowest; i++)
+    {
+      result = g_ptr_array_index (slowest, i);
+      g_printf ("%12.3f ms  %s\n", result->elapsed / 1000.0, result->filename);
+    }
+}
+
+
+/* Appends the non-empty lines of the standard input to @filenames */
+static gboolean
+read_file_list (GPtrArray *filenames, GError **error)
+{
+  char *line = NULL;
+  size_t line_size = 0;
+  ssize_t len;
+  int saved_errno;
+
+  while ((len = getline (&line, &line_size, stdin)) != -1)
+    {
+      while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+        {
+          line[--len] = '\0';
+        }
+      if (len > 0)
+        {
+          g_ptr_array_add (filenames, g_strdup (line));
+        }
+    }
+  saved_errno = errno;
+  free (line);
+
+  if (ferror (stdin))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   g_io_error_from_errno (saved_errno),
+                   "Could not read the list of files: %s",
+                   g_strerror (saved_errno));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
 int
 main (int argc, char *argv[])
 {
-  const char *filename;
   g_autoptr (GOptionContext) context = NULL;
   g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) filenames = NULL;
+  g_autofree struct file_result *results = NULL;
+  GThreadPool *pool = NULL;
   gsize num_invalid = 0;
-  gboolean ret;
-  g_autoptr (GPtrArray) failures = NULL;
-  ModulemdSubdocumentInfo *doc = NULL;
+  guint n_jobs;
+  gint64 start;
 
   setlocale (LC_ALL, "");
 
   options.type = MMD_TYPE_INDEX;
+  options.jobs = 1;
   context = g_option_context_new ("FILES - Simple modulemd YAML validator");
   g_option_context_add_main_entries (context, entries, "modulemd-validator");
   if (!g_option_context_parse (context, &argc, &argv, &error))
@@ -467,56 +927,110 @@ main (int argc, char *argv[])
       exit (EXIT_SUCCESS);
     }
 
-  if (!(options.filenames && options.filenames[0]))
+  if (options.jobs < 0)
     {
       g_fprintf (stderr,
-                 "At least one file must be specified on the command-line\n");
+                 "The number of jobs must not be negative: %d\n",
+                 options.jobs);
+      exit (EXIT_FAILURE);
+    }
+
+  filenames = g_ptr_array_new_with_free_func (g_free);
+  for (gsize i = 0; options.filenames && options.filenames[i]; i++)
+    {
+      g_ptr_array_add (filenames, g_strdup (options.filenames[i]));
+    }
+
+  if (options.from_list && !read_file_list (filenames, &error))
+    {
+      g_fprintf (stderr, "%s\n", error->message);
       exit (EXIT_FAILURE);
     }
 
-  for (gsize i = 0; options.filenames[i]; i++)
+  if (filenames->len == 0)
     {
-      filename = options.filenames[i];
+      g_fprintf (stderr,
+                 "At least one file must be specified on the command-line%s\n",
+                 options.from_list ? " or the standard input" : "");
+      exit (EXIT_FAILURE);
+    }
 
-      ret = parse_file (filename, &failures, &error);
-      if (!ret)
+  n_jobs = options.jobs ? (guint)options.jobs : g_get_num_processors ();
+  n_jobs = MIN (n_jobs, filenames->len);
+
+  results = g_new0 (struct file_result, filenames->len);
+  for (guint i = 0; i < filenames->len; i++)
+    {
+      results[i].filename = g_ptr_array_index (filenames, i);
+    }
+
+  if (options.json)
+    {
+      g_printf ("{\n  \"jobs\": %u,\n  \"files\": [", n_jobs);
+    }
+
+  start = g_get_monotonic_time ();
+
+  /* Files are queued in the input order, so the results that are reported
+   * first are also the first ones to be validated.
+   */
+  if (n_jobs > 1)
+    {
+      pool = g_thread_pool_new (
+        validate_file_worker, NULL, (gint)n_jobs, TRUE, &error);
+      if (!pool)
+        {
+          g_fprintf (stderr,
+                     "Could not start the validation jobs: %s\n",
+                     error->message);
+          exit (EXIT_FAILURE);
+        }
+      for (guint i = 0; i < filenames->len; i++)
+        {
+          g_thread_pool_push (pool, &results[i], NULL);
+        }
+    }
+
+  for (guint i = 0; i < filenames->len; i++)
+    {
+      print_validating (&results[i]);
+
+      if (pool)
+        {
+          wait_for_result (&results[i]);
+        }
+      else
+        {
+          validate_file (&results[i]);
+        }
+
+      if (!results[i].valid)
         {
           num_invalid++;
-          if (options.verbosity >= MMD_DEFAULT)
-            {
-              g_fprintf (stderr, "%s failed to validate\n", filename);
-
-              if (error != NULL)
-                {
-                  /* Unparseable content */
-                  g_fprintf (stderr,
-                             "%s could not be read in its entirety: %s\n",
-                             filename,
-                             error->message);
-                }
-              if (failures)
-                {
-                  for (gsize j = 0; j < failures->len; j++)
-                    {
-                      doc = MODULEMD_SUBDOCUMENT_INFO (
-                        g_ptr_array_index (failures, j));
-                      g_printf (
-                        "\nFailed subdocument (%s): \n%s\n",
-                        modulemd_subdocument_info_get_gerror (doc)->message,
-                        modulemd_subdocument_info_get_yaml (doc));
-                    }
-                }
-            }
+        }
+
+      if (options.json)
+        {
+          print_json_result (&results[i], i == 0);
         }
       else
         {
-          if (options.verbosity >= MMD_DEFAULT)
-            {
-              g_printf ("%s validated successfully\n", filename);
-            }
+          print_result (&results[i]);
         }
-      g_clear_error (&error);
-      g_clear_pointer (&failures, g_ptr_array_unref);
+
+      g_clear_error (&results[i].error);
+      g_clear_pointer (&results[i].failures, g_ptr_array_unref);
+    }
+
+  if (pool)
+    {
+      g_thread_pool_free (pool, FALSE, TRUE);
+    }
+
+  if (options.stats || options.json)
+    {
+      print_summary (
+        results, filenames->len, n_jobs, g_get_monotonic_time () - start);
     }
 
   return num_invalid;
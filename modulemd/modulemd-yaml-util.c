@@ -13,12 +13,16 @@
 
 #include "config.h"
 #include "modulemd-errors.h"
+#include "modulemd-module-stream.h"
 #include "private/modulemd-subdocument-info-private.h"
+#include "private/modulemd-json.h"
 #include "private/modulemd-util.h"
+#include "private/modulemd-yaml-writer.h"
 #include "private/modulemd-yaml.h"
 #include <errno.h>
 #include <glib.h>
 #include <inttypes.h>
+#include <string.h>
 #include <yaml.h>
 
 
@@ -42,13 +46,24 @@ write_yaml_string (void *data, unsigned char *buffer, size_t size)
 {
   modulemd_yaml_string *yaml_string = (modulemd_yaml_string *)data;
   gsize total;
+  gsize allocated;
 
   if (!g_size_checked_add (&total, yaml_string->len, size + 1))
     {
       return 0;
     }
 
-  yaml_string->str = g_realloc_n (yaml_string->str, total, sizeof (char));
+  if (total > yaml_string->allocated)
+    {
+      allocated = total;
+      if (yaml_string->allocated <= G_MAXSIZE / 2)
+        {
+          allocated = MAX (allocated, yaml_string->allocated * 2);
+        }
+
+      yaml_string->str = g_realloc (yaml_string->str, allocated);
+      yaml_string->allocated = allocated;
+    }
 
   memcpy (yaml_string->str + yaml_string->len, buffer, size);
   yaml_string->len += size;
@@ -58,6 +73,17 @@ write_yaml_string (void *data, unsigned char *buffer, size_t size)
 }
 
 
+gboolean
+mmd_yaml_debug_enabled (void)
+{
+#ifdef HAVE_G_LOG_WRITER_DEFAULT_WOULD_DROP
+  return !g_log_writer_default_would_drop (G_LOG_LEVEL_DEBUG, G_LOG_DOMAIN);
+#else
+  return TRUE;
+#endif
+}
+
+
 const gchar *
 mmd_yaml_get_event_name (yaml_event_type_t type)
 {
@@ -91,6 +117,30 @@ mmd_yaml_get_event_name (yaml_event_type_t type)
 }
 
 
+int
+mmd_emitter_emit (yaml_emitter_t *emitter, yaml_event_t *event)
+{
+  int ret;
+
+  /* The direct writer decides once per stream whether to log */
+  if (mmd_emitter_is_direct (emitter))
+    {
+      ret = mmd_direct_emit (emitter, event);
+      yaml_event_delete (event);
+      return ret;
+    }
+
+  MMD_YAML_DEBUG ("Emitter event: %s", mmd_yaml_get_event_name (event->type));
+
+  if (mmd_emitter_is_json (emitter))
+    {
+      return mmd_json_emit (emitter, event);
+    }
+
+  return yaml_emitter_emit (emitter, event);
+}
+
+
 gboolean
 mmd_emitter_start_stream (yaml_emitter_t *emitter, GError **error)
 {
@@ -276,21 +326,73 @@ mmd_emitter_end_sequence (yaml_emitter_t *emitter, GError **error)
 }
 
 
-gboolean
-mmd_emitter_scalar (yaml_emitter_t *emitter,
-                    const gchar *scalar,
-                    yaml_scalar_style_t style,
-                    GError **error)
+/*
+ * emitter_scalar_event:
+ * @tag: (in) (nullable): A YAML core schema tag such as `YAML_INT_TAG`.
+ *
+ * Emits a scalar with implicit tags. A writer attached to @emitter reads
+ * @scalar in place; libyaml gets a copy of it in a new event.
+ */
+static gboolean
+emitter_scalar_event (yaml_emitter_t *emitter,
+                      const gchar *scalar,
+                      const gchar *tag,
+                      yaml_scalar_style_t style,
+                      GError **error)
 {
   int ret;
+  gsize length = strlen (scalar);
   MMD_INIT_YAML_EVENT (event);
 
-  g_debug ("SCALAR: %s", scalar);
+  if (mmd_emitter_is_direct (emitter))
+    {
+      if (!mmd_direct_check_utf8 (scalar, length))
+        {
+          g_set_error (error,
+                       MODULEMD_YAML_ERROR,
+                       MMD_YAML_ERROR_EVENT_INIT,
+                       "Could not initialize the scalar event");
+          return FALSE;
+        }
+
+      /* The event only borrows the scalar, so it must not be deleted */
+      event.type = YAML_SCALAR_EVENT;
+      event.data.scalar.tag = (yaml_char_t *)tag;
+      event.data.scalar.value = (yaml_char_t *)scalar;
+      event.data.scalar.length = length;
+      event.data.scalar.plain_implicit = 1;
+      event.data.scalar.quoted_implicit = 1;
+      event.data.scalar.style = style;
+
+      ret = mmd_direct_emit (emitter, &event);
+      event.type = YAML_NO_EVENT;
+      if (!ret)
+        {
+          g_debug ("Could not emit scalar value");
+          g_set_error_literal (error,
+                               MODULEMD_YAML_ERROR,
+                               MMD_YAML_ERROR_EMIT,
+                               "Could not emit scalar value");
+          return FALSE;
+        }
+
+      return TRUE;
+    }
+
+  if (tag)
+    {
+      MMD_YAML_DEBUG ("SCALAR: %s (%s)", scalar, tag);
+    }
+  else
+    {
+      MMD_YAML_DEBUG ("SCALAR: %s", scalar);
+    }
+
   ret = yaml_scalar_event_initialize (&event,
                                       NULL,
-                                      NULL,
+                                      (yaml_char_t *)tag,
                                       (yaml_char_t *)scalar,
-                                      (int)strlen (scalar),
+                                      (int)length,
                                       1,
                                       1,
                                       style);
@@ -309,6 +411,70 @@ mmd_emitter_scalar (yaml_emitter_t *emitter,
 }
 
 
+gboolean
+mmd_emitter_scalar (yaml_emitter_t *emitter,
+                    const gchar *scalar,
+                    yaml_scalar_style_t style,
+                    GError **error)
+{
+  return emitter_scalar_event (emitter, scalar, NULL, style, error);
+}
+
+
+/*
+ * emitter_scalar_tagged:
+ * @tag: (in): A YAML core schema tag such as `YAML_INT_TAG`.
+ *
+ * Like mmd_emitter_scalar() with `YAML_PLAIN_SCALAR_STYLE`, but records @tag
+ * on the event. As the tag is implicit, libyaml does not write it out. The
+ * JSON emitter uses it to decide which scalars to write as numbers or
+ * booleans; the text of the scalar alone cannot tell it that.
+ */
+static gboolean
+emitter_scalar_tagged (yaml_emitter_t *emitter,
+                       const gchar *scalar,
+                       const gchar *tag,
+                       GError **error)
+{
+  return emitter_scalar_event (
+    emitter, scalar, tag, YAML_PLAIN_SCALAR_STYLE, error);
+}
+
+
+gboolean
+mmd_emitter_scalar_uint64 (yaml_emitter_t *emitter,
+                           guint64 value,
+                           GError **error)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_snprintf (buf, sizeof (buf), "%" PRIu64, value);
+  return emitter_scalar_tagged (emitter, buf, YAML_INT_TAG, error);
+}
+
+
+gboolean
+mmd_emitter_scalar_int64 (yaml_emitter_t *emitter,
+                          gint64 value,
+                          GError **error)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_snprintf (buf, sizeof (buf), "%" PRId64, value);
+  return emitter_scalar_tagged (emitter, buf, YAML_INT_TAG, error);
+}
+
+
+gboolean
+mmd_emitter_scalar_boolean (yaml_emitter_t *emitter,
+                            gboolean value,
+                            GError **error)
+{
+  return emitter_scalar_tagged (
+    emitter, value ? "true" : "false", YAML_BOOL_TAG, error);
+}
+
+
 /**
  * mmd_string_is_empty_or_a_number
  * @string (in) (nullable)
@@ -481,7 +647,8 @@ modulemd_yaml_parse_date (yaml_parser_t *parser, GError **error)
       MMD_YAML_ERROR_EVENT_EXIT (error, event, "Date was not a scalar");
     }
 
-  g_debug ("Parsing scalar: %s", (const gchar *)event.data.scalar.value);
+  MMD_YAML_DEBUG ("Parsing scalar: %s",
+                  (const gchar *)event.data.scalar.value);
 
   strv = g_strsplit ((const gchar *)event.data.scalar.value, "-", 4);
 
@@ -507,7 +674,8 @@ modulemd_yaml_parse_string (yaml_parser_t *parser, GError **error)
       MMD_YAML_ERROR_EVENT_EXIT (error, event, "String was not a scalar");
     }
 
-  g_debug ("Parsing scalar: %s", (const gchar *)event.data.scalar.value);
+  MMD_YAML_DEBUG ("Parsing scalar: %s",
+                  (const gchar *)event.data.scalar.value);
 
   return g_strdup ((const gchar *)event.data.scalar.value);
 }
@@ -628,7 +796,8 @@ modulemd_yaml_parse_uint64 (yaml_parser_t *parser, GError **error)
       MMD_YAML_ERROR_EVENT_EXIT_INT (error, event, "String was not a scalar");
     }
 
-  g_debug ("Parsing scalar: %s", (const gchar *)event.data.scalar.value);
+  MMD_YAML_DEBUG ("Parsing scalar: %s",
+                  (const gchar *)event.data.scalar.value);
 
   /* g_ascii_strtoull() accepts negative values by definition. */
   if (event.data.scalar.value[0] == '-')
@@ -686,8 +855,7 @@ modulemd_yaml_parse_string_set (yaml_parser_t *parser, GError **error)
   MMD_INIT_YAML_EVENT (event);
   gboolean done = FALSE;
   gboolean in_list = FALSE;
-  g_autoptr (GHashTable) result =
-    g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_autoptr (GHashTable) result = modulemd_str_set_new ();
 
   while (!done)
     {
@@ -714,7 +882,8 @@ modulemd_yaml_parse_string_set (yaml_parser_t *parser, GError **error)
           if (in_list)
             {
               g_hash_table_add (
-                result, g_strdup ((const gchar *)event.data.scalar.value));
+                result,
+                modulemd_str_intern ((const gchar *)event.data.scalar.value));
             }
           else
             {
@@ -724,7 +893,9 @@ modulemd_yaml_parse_string_set (yaml_parser_t *parser, GError **error)
                   /* Treat it as a list with a single entry
                    * if it's nonempty. */
                   g_hash_table_add (
-                    result, g_strdup ((const gchar *)event.data.scalar.value));
+                    result,
+                    modulemd_str_intern (
+                      (const gchar *)event.data.scalar.value));
                   done = TRUE;
                 }
               else
@@ -891,15 +1062,18 @@ modulemd_yaml_parse_nested_set (yaml_parser_t *parser, GError **error)
   MODULEMD_INIT_TRACE ();
   MMD_INIT_YAML_EVENT (event);
   gboolean done = FALSE;
-  g_autofree gchar *key = NULL;
+  gchar *key = NULL;
   g_autoptr (GHashTable) value = NULL;
   g_autoptr (GHashTable) t = NULL;
   g_autoptr (GError) nested_error = NULL;
 
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  t = g_hash_table_new_full (
-    g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_hash_table_unref);
+  /* The module names are interned like the stream names in the sets */
+  t = g_hash_table_new_full (g_str_hash,
+                             modulemd_str_equal,
+                             modulemd_str_release,
+                             (GDestroyNotify)g_hash_table_unref);
 
   /* The first event must be a MAPPING_START */
   YAML_PARSER_PARSE_WITH_EXIT (parser, &event, error);
@@ -918,7 +1092,6 @@ modulemd_yaml_parse_nested_set (yaml_parser_t *parser, GError **error)
         case YAML_MAPPING_END_EVENT: done = TRUE; break;
 
         case YAML_SCALAR_EVENT:
-          key = g_strdup ((const gchar *)event.data.scalar.value);
           if (g_hash_table_contains (t,
                                      (const gchar *)event.data.scalar.value))
             {
@@ -938,8 +1111,8 @@ modulemd_yaml_parse_nested_set (yaml_parser_t *parser, GError **error)
                                          nested_error->message);
             }
 
-          g_hash_table_insert (
-            t, g_steal_pointer (&key), g_steal_pointer (&value));
+          key = modulemd_str_intern ((const gchar *)event.data.scalar.value);
+          g_hash_table_insert (t, key, g_steal_pointer (&value));
           break;
 
         default:
@@ -990,7 +1163,7 @@ modulemd_yaml_emit_nested_set (yaml_emitter_t *emitter,
       return FALSE;
     }
 
-  keys = modulemd_ordered_str_keys (table, modulemd_strcmp_sort);
+  keys = modulemd_sorted_str_keys (table);
   for (guint i = 0; i < keys->len; i++)
     {
       key = g_ptr_array_index (keys, i);
@@ -1013,9 +1186,14 @@ modulemd_yaml_emit_nested_set (yaml_emitter_t *emitter,
 }
 
 
+/* When @mapping_start is set, the document is an element of a JSON array and
+ * @mapping_start is its first event, already read from @parser. Such a
+ * document has no document end event of its own.
+ */
 static gboolean
 modulemd_yaml_parse_document_type_internal (
   yaml_parser_t *parser,
+  yaml_event_t *mapping_start,
   ModulemdYamlDocumentTypeEnum *_doctype,
   guint64 *_mdversion,
   yaml_emitter_t *emitter,
@@ -1028,7 +1206,6 @@ modulemd_yaml_parse_document_type_internal (
   ModulemdYamlDocumentTypeEnum doctype = MODULEMD_YAML_DOC_UNKNOWN;
   guint64 mdversion = 0;
   g_autofree gchar *doctype_scalar = NULL;
-  g_autofree gchar *mdversion_string = NULL;
   g_autoptr (GError) nested_error = NULL;
   int depth = 0;
 
@@ -1049,7 +1226,15 @@ modulemd_yaml_parse_document_type_internal (
     }
 
   /* The second event must be the mapping start */
-  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+  if (mapping_start)
+    {
+      event = *mapping_start;
+      memset (mapping_start, 0, sizeof (yaml_event_t));
+    }
+  else
+    {
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+    }
   if (event.type != YAML_MAPPING_START_EVENT)
     {
       MMD_YAML_ERROR_EVENT_EXIT_BOOL (
@@ -1142,6 +1327,10 @@ modulemd_yaml_parse_document_type_internal (
                 {
                   doctype = MODULEMD_YAML_DOC_OBSOLETES;
                 }
+              else if (g_str_equal (doctype_scalar, "modulemd-delta"))
+                {
+                  doctype = MODULEMD_YAML_DOC_DELTA;
+                }
               else
                 {
                   MMD_YAML_ERROR_EVENT_EXIT_BOOL (
@@ -1169,9 +1358,7 @@ modulemd_yaml_parse_document_type_internal (
                   g_propagate_error (error, g_steal_pointer (&nested_error));
                   return FALSE;
                 }
-              mdversion_string = g_strdup_printf ("%" PRIu64, mdversion);
-              if (!mmd_emitter_scalar (
-                    emitter, mdversion_string, YAML_PLAIN_SCALAR_STYLE, error))
+              if (!mmd_emitter_scalar_uint64 (emitter, mdversion, error))
                 {
                   return FALSE;
                 }
@@ -1197,15 +1384,25 @@ modulemd_yaml_parse_document_type_internal (
     }
 
   /* The final event must be the document end */
-  YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
-  if (event.type != YAML_DOCUMENT_END_EVENT)
+  if (mapping_start)
     {
-      MMD_YAML_ERROR_EVENT_EXIT_BOOL (
-        error, event, "Document did not end. It just goes on forever...");
+      if (!mmd_emitter_end_document (emitter, error))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      YAML_PARSER_PARSE_WITH_EXIT_BOOL (parser, &event, error);
+      if (event.type != YAML_DOCUMENT_END_EVENT)
+        {
+          MMD_YAML_ERROR_EVENT_EXIT_BOOL (
+            error, event, "Document did not end. It just goes on forever...");
+        }
+      MMD_EMIT_WITH_EXIT_FULL (
+        emitter, FALSE, &event, error, "Error ending document");
+      yaml_event_delete (&event);
     }
-  MMD_EMIT_WITH_EXIT_FULL (
-    emitter, FALSE, &event, error, "Error ending document");
-  yaml_event_delete (&event);
 
   if (!mmd_emitter_end_stream (emitter, error))
     {
@@ -1256,8 +1453,8 @@ modulemd_yaml_parse_document_type_internal (
 }
 
 
-ModulemdSubdocumentInfo *
-modulemd_yaml_parse_document_type (yaml_parser_t *parser)
+static ModulemdSubdocumentInfo *
+parse_document_type (yaml_parser_t *parser, yaml_event_t *mapping_start)
 {
   MMD_INIT_YAML_EMITTER (emitter);
   MMD_INIT_YAML_STRING (&emitter, yaml_string);
@@ -1267,7 +1464,7 @@ modulemd_yaml_parse_document_type (yaml_parser_t *parser)
   g_autoptr (GError) error = NULL;
 
   if (!modulemd_yaml_parse_document_type_internal (
-        parser, &doctype, &mdversion, &emitter, &error))
+        parser, mapping_start, &doctype, &mdversion, &emitter, &error))
     {
       modulemd_subdocument_info_set_gerror (s, error);
     }
@@ -1280,7 +1477,290 @@ modulemd_yaml_parse_document_type (yaml_parser_t *parser)
 }
 
 
+ModulemdSubdocumentInfo *
+modulemd_yaml_parse_document_type (yaml_parser_t *parser)
+{
+  return parse_document_type (parser, NULL);
+}
+
+
+ModulemdSubdocumentInfo *
+modulemd_yaml_parse_json_document_type (yaml_parser_t *parser,
+                                        yaml_event_t *mapping_start)
+{
+  g_return_val_if_fail (mapping_start, NULL);
+
+  return parse_document_type (parser, mapping_start);
+}
+
+
+/* Lines are only inspected up to this length by the mdversion pre-scan; the
+ * keys it looks for are much shorter.
+ */
+#define MMD_PRESCAN_LINE_LEN 128
+
+typedef struct
+{
+  gboolean is_modulemd;
+  gboolean is_obsoletes;
+  guint64 version;
+  guint64 max_mdversion;
+} modulemd_prescan_state;
+
+
+/* Returns the value of a top-level "key: value" line, without surrounding
+ * quotes, trailing whitespace or comments.
+ */
 static const gchar *
+prescan_value (const gchar *line, gsize len, gsize key_len, gsize *value_len)
+{
+  gsize start = key_len;
+  gsize end;
+
+  while (start < len && (line[start] == ' ' || line[start] == '\t'))
+    {
+      start++;
+    }
+
+  if (start < len && (line[start] == '"' || line[start] == '\''))
+    {
+      start++;
+    }
+
+  end = start;
+  while (end < len && !strchr (" \t\r\n#\"'", line[end]))
+    {
+      end++;
+    }
+
+  *value_len = end - start;
+  return line + start;
+}
+
+
+static void
+prescan_end_document (modulemd_prescan_state *state)
+{
+  guint64 mdversion = 0;
+
+  if (state->is_modulemd && state->version <= MD_MODULESTREAM_VERSION_LATEST)
+    {
+      mdversion = state->version;
+    }
+  else if (state->is_obsoletes)
+    {
+      /* Obsoletes can only be associated with v2 streams */
+      mdversion = MD_MODULESTREAM_VERSION_TWO;
+    }
+
+  state->max_mdversion = MAX (state->max_mdversion, mdversion);
+
+  state->is_modulemd = FALSE;
+  state->is_obsoletes = FALSE;
+  state->version = 0;
+}
+
+
+static void
+prescan_line (modulemd_prescan_state *state, const gchar *line, gsize len)
+{
+  const gchar *value = NULL;
+  gsize value_len;
+
+  if (len >= 3 &&
+      (strncmp (line, "---", 3) == 0 || strncmp (line, "...", 3) == 0) &&
+      (len == 3 || g_ascii_isspace (line[3])))
+    {
+      prescan_end_document (state);
+    }
+  else if (len > 9 && strncmp (line, "document:", 9) == 0)
+    {
+      value = prescan_value (line, len, 9, &value_len);
+      state->is_modulemd =
+        value_len == 8 && strncmp (value, "modulemd", 8) == 0;
+      state->is_obsoletes =
+        value_len == 18 && strncmp (value, "modulemd-obsoletes", 18) == 0;
+    }
+  else if (len > 8 && strncmp (line, "version:", 8) == 0)
+    {
+      value = prescan_value (line, len, 8, &value_len);
+      state->version = 0;
+      for (gsize i = 0; i < value_len && value_len <= 3; i++)
+        {
+          if (!g_ascii_isdigit (value[i]))
+            {
+              state->version = 0;
+              break;
+            }
+          state->version = state->version * 10 + (value[i] - '0');
+        }
+    }
+}
+
+
+/* Nothing found later can raise the result once the newest stream mdversion
+ * has been seen.
+ */
+static gboolean
+prescan_done (modulemd_prescan_state *state)
+{
+  return state->max_mdversion >= MD_MODULESTREAM_VERSION_LATEST;
+}
+
+
+guint64
+modulemd_yaml_prescan_stream_mdversion_from_string (const gchar *yaml_string)
+{
+  g_return_val_if_fail (yaml_string, 0);
+
+  return modulemd_yaml_prescan_stream_mdversion_from_data (
+    yaml_string, strlen (yaml_string));
+}
+
+
+guint64
+modulemd_yaml_prescan_stream_mdversion_from_data (const gchar *data,
+                                                  gsize len)
+{
+  modulemd_prescan_state state = { 0 };
+  const gchar *line = data;
+  const gchar *end = data + len;
+  const gchar *eol = NULL;
+
+  g_return_val_if_fail (data || len == 0, 0);
+
+  while (line < end && !prescan_done (&state))
+    {
+      eol = memchr (line, '\n', end - line);
+      if (!eol)
+        {
+          prescan_line (&state, line, end - line);
+          break;
+        }
+
+      prescan_line (&state, line, eol - line);
+      line = eol + 1;
+    }
+
+  prescan_end_document (&state);
+
+  return state.max_mdversion;
+}
+
+
+gboolean
+modulemd_yaml_prescan_stream_mdversion_from_file (FILE *stream,
+                                                  guint64 *mdversion)
+{
+  modulemd_prescan_state state = { 0 };
+  gchar buf[MMD_PRESCAN_LINE_LEN];
+  gboolean at_line_start = TRUE;
+  gboolean read_failed;
+  gsize len;
+
+  g_return_val_if_fail (stream, FALSE);
+  g_return_val_if_fail (mdversion, FALSE);
+
+  while (!prescan_done (&state) && fgets (buf, sizeof (buf), stream))
+    {
+      len = strlen (buf);
+
+      /* Only the beginning of each line is of interest. Skip the remainder
+       * of lines longer than the buffer.
+       */
+      if (at_line_start)
+        {
+          prescan_line (&state, buf, len);
+        }
+      at_line_start = len > 0 && buf[len - 1] == '\n';
+    }
+
+  read_failed = ferror (stream);
+  clearerr (stream);
+
+  if (fseek (stream, 0, SEEK_SET) != 0)
+    {
+      return FALSE;
+    }
+
+  prescan_end_document (&state);
+
+  /* A partial scan could miss a later subdocument, so report nothing */
+  *mdversion = read_failed ? 0 : state.max_mdversion;
+
+  return TRUE;
+}
+
+
+gboolean
+modulemd_yaml_prescan_stream_mdversion_from_read_fn (
+  yaml_read_handler_t read_fn, void *data, guint64 *mdversion)
+{
+  modulemd_prescan_state state = { 0 };
+  unsigned char chunk[4096];
+  gchar line[MMD_PRESCAN_LINE_LEN];
+  gsize line_len = 0;
+  gsize copy_len;
+  size_t size_read;
+  const gchar *start = NULL;
+  const gchar *end = NULL;
+  const gchar *eol = NULL;
+
+  g_return_val_if_fail (read_fn, FALSE);
+  g_return_val_if_fail (mdversion, FALSE);
+
+  *mdversion = 0;
+
+  while (!prescan_done (&state))
+    {
+      if (!read_fn (data, chunk, sizeof (chunk), &size_read))
+        {
+          return FALSE;
+        }
+
+      if (size_read == 0)
+        {
+          break;
+        }
+
+      /* Lines may span chunks, so collect the beginning of each line in
+       * @line. The remainder of lines longer than that is skipped.
+       */
+      start = (const gchar *)chunk;
+      end = start + size_read;
+      while (start < end)
+        {
+          eol = memchr (start, '\n', end - start);
+          copy_len = MIN ((gsize)((eol ? eol : end) - start),
+                          sizeof (line) - line_len);
+          memcpy (line + line_len, start, copy_len);
+          line_len += copy_len;
+
+          if (!eol)
+            {
+              break;
+            }
+
+          prescan_line (&state, line, line_len);
+          line_len = 0;
+          start = eol + 1;
+        }
+    }
+
+  if (line_len > 0)
+    {
+      prescan_line (&state, line, line_len);
+    }
+
+  prescan_end_document (&state);
+
+  *mdversion = state.max_mdversion;
+
+  return TRUE;
+}
+
+
+const gchar *
 modulemd_yaml_get_doctype_string (ModulemdYamlDocumentTypeEnum doctype,
                                   guint64 mdversion)
 {
@@ -1299,6 +1779,8 @@ modulemd_yaml_get_doctype_string (ModulemdYamlDocumentTypeEnum doctype,
 
     case MODULEMD_YAML_DOC_OBSOLETES: return "modulemd-obsoletes";
 
+    case MODULEMD_YAML_DOC_DELTA: return "modulemd-delta";
+
     case MODULEMD_YAML_DOC_PACKAGER: return "modulemd-packager";
 
     default: return NULL;
@@ -1315,7 +1797,6 @@ modulemd_yaml_emit_document_headers (yaml_emitter_t *emitter,
   MODULEMD_INIT_TRACE ();
   const gchar *doctype_string =
     modulemd_yaml_get_doctype_string (doctype, mdversion);
-  g_autofree gchar *mdversion_string = g_strdup_printf ("%" PRIu64, mdversion);
 
   if (!mmd_emitter_start_document (emitter, error))
     {
@@ -1344,8 +1825,7 @@ modulemd_yaml_emit_document_headers (yaml_emitter_t *emitter,
       return FALSE;
     }
 
-  if (!mmd_emitter_scalar (
-        emitter, mdversion_string, YAML_PLAIN_SCALAR_STYLE, error))
+  if (!mmd_emitter_scalar_uint64 (emitter, mdversion, error))
     {
       return FALSE;
     }
@@ -0,0 +1,2097 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+#include <limits.h>
+#include <string.h>
+#include <yaml.h>
+
+#include "private/modulemd-yaml-writer.h"
+#include "private/modulemd-yaml.h"
+
+
+/* The output is handed on in chunks of up to this many bytes, and at the
+ * end of each document, like libyaml does with its own output buffer.
+ */
+#define MMD_YAML_WRITER_BUFFER_SIZE 65536
+
+/* Room for the longest sequence written without checking the space left,
+ * which is the escape of a character outside the Basic Multilingual Plane.
+ */
+#define MMD_YAML_WRITER_PUT_MAX 10
+
+/* Keys longer than this are written as complex keys, as in libyaml */
+#define MMD_YAML_WRITER_MAX_SIMPLE_KEY 128
+
+
+/* The result of analyze_scalar(). The fields from @multiline to
+ * @block_allowed are those of the scalar analysis of libyaml. The others
+ * let the scalar writers copy a scalar in one piece when nothing in it needs
+ * to be escaped, folded or doubled.
+ */
+typedef struct
+{
+  const guchar *value;
+  gsize length;
+  gsize n_chars;
+  gboolean multiline;
+  gboolean flow_plain_allowed;
+  gboolean block_plain_allowed;
+  gboolean single_quoted_allowed;
+  gboolean block_allowed;
+  gboolean has_escapes;
+  gboolean has_quotes;
+  yaml_scalar_style_t style;
+  gboolean tagged;
+} scalar_analysis;
+
+
+/* Only the type and style of a collection start are needed once it has
+ * been looked ahead of.
+ */
+typedef struct
+{
+  yaml_event_type_t type;
+  gint style;
+} collection_start;
+
+
+struct _modulemd_yaml_writer
+{
+  yaml_emitter_t *emitter;
+
+  /* The output of the emitter before @self was attached */
+  yaml_write_handler_t *write_handler;
+  void *write_handler_data;
+
+  gboolean debug;
+
+  /* The state of the libyaml emitter, with the same meaning. Whether the
+   * stream would need an explicit end is kept in the open_ended field of
+   * the emitter itself, which its owners may read and set.
+   */
+  yaml_emitter_state_t state;
+  GArray *states;
+  GArray *indents;
+  gint indent;
+  gint flow_level;
+  gint best_indent;
+  gint best_width;
+  yaml_break_t line_break;
+  gboolean unicode;
+  gboolean root_context;
+  gboolean sequence_context;
+  gboolean mapping_context;
+  gboolean simple_key_context;
+  gint column;
+  gboolean whitespace;
+  gboolean indention;
+
+  scalar_analysis scalar;
+
+  /* A collection start is only written once the next event shows whether
+   * the collection is empty, as an empty one is written in flow style.
+   */
+  gboolean have_pending;
+  collection_start pending;
+  gboolean next_is_end;
+
+  gsize len;
+  guchar buffer[MMD_YAML_WRITER_BUFFER_SIZE];
+};
+
+
+/* Passes any output written directly to the emitter, such as that of a
+ * parallel dump, through to the original output. Buffered output goes
+ * first so that the order is kept.
+ */
+static int
+direct_write_handler (void *data, unsigned char *buffer, size_t size);
+
+
+modulemd_yaml_writer *
+modulemd_yaml_writer_new (yaml_emitter_t *emitter)
+{
+  modulemd_yaml_writer *self = g_new0 (modulemd_yaml_writer, 1);
+
+  self->emitter = emitter;
+  self->write_handler = emitter->write_handler;
+  self->write_handler_data = emitter->write_handler_data;
+  self->states = g_array_new (FALSE, FALSE, sizeof (yaml_emitter_state_t));
+  self->indents = g_array_new (FALSE, FALSE, sizeof (gint));
+  self->state = YAML_EMIT_STREAM_START_STATE;
+
+  emitter->write_handler = direct_write_handler;
+  emitter->write_handler_data = self;
+
+  return self;
+}
+
+
+void
+modulemd_yaml_writer_free (modulemd_yaml_writer *self)
+{
+  if (self == NULL)
+    {
+      return;
+    }
+
+  self->emitter->write_handler = self->write_handler;
+  self->emitter->write_handler_data = self->write_handler_data;
+
+  g_array_unref (self->states);
+  g_array_unref (self->indents);
+  g_free (self);
+}
+
+
+gboolean
+mmd_emitter_is_direct (yaml_emitter_t *emitter)
+{
+  return emitter->write_handler == direct_write_handler;
+}
+
+
+static gboolean
+writer_flush (modulemd_yaml_writer *self)
+{
+  gsize len = self->len;
+
+  if (len == 0)
+    {
+      return TRUE;
+    }
+
+  self->len = 0;
+  return self->write_handler (self->write_handler_data, self->buffer, len);
+}
+
+
+static int
+direct_write_handler (void *data, unsigned char *buffer, size_t size)
+{
+  modulemd_yaml_writer *self = (modulemd_yaml_writer *)data;
+
+  if (!writer_flush (self))
+    {
+      return 0;
+    }
+
+  return self->write_handler (self->write_handler_data, buffer, size);
+}
+
+
+int
+mmd_emitter_flush (yaml_emitter_t *emitter)
+{
+  if (mmd_emitter_is_direct (emitter))
+    {
+      return writer_flush (emitter->write_handler_data);
+    }
+
+  return yaml_emitter_flush (emitter);
+}
+
+
+/* Character classes, as defined in the yaml_private.h header of libyaml */
+
+static inline gsize
+char_width (guchar octet)
+{
+  return (octet & 0x80) == 0x00 ? 1 :
+         (octet & 0xE0) == 0xC0 ? 2 :
+         (octet & 0xF0) == 0xE0 ? 3 :
+         (octet & 0xF8) == 0xF0 ? 4 :
+                                  0;
+}
+
+
+static inline gboolean
+is_break_at (const guchar *s, gsize len, gsize i)
+{
+  return i < len &&
+         (s[i] == '\r' || s[i] == '\n' ||
+          (s[i] == 0xC2 && i + 1 < len && s[i + 1] == 0x85) ||
+          (s[i] == 0xE2 && i + 2 < len && s[i + 1] == 0x80 &&
+           (s[i + 2] == 0xA8 || s[i + 2] == 0xA9)));
+}
+
+
+/* The end of the value counts as a break, as the nul terminator that
+ * libyaml looks at there would.
+ */
+static inline gboolean
+is_blankz_at (const guchar *s, gsize len, gsize i)
+{
+  return i >= len || s[i] == ' ' || s[i] == '\t' || is_break_at (s, len, i);
+}
+
+
+static inline gboolean
+is_space_at (const guchar *s, gsize len, gsize i)
+{
+  return i < len && s[i] == ' ';
+}
+
+
+static inline gboolean
+is_printable_at (const guchar *s, gsize len, gsize i)
+{
+  guchar c = s[i];
+  guchar c1 = i + 1 < len ? s[i + 1] : 0;
+  guchar c2 = i + 2 < len ? s[i + 2] : 0;
+
+  return c == 0x0A || (c >= 0x20 && c <= 0x7E) || (c == 0xC2 && c1 >= 0xA0) ||
+         (c > 0xC2 && c < 0xED) || (c == 0xED && c1 < 0xA0) || c == 0xEE ||
+         (c == 0xEF && !(c1 == 0xBB && c2 == 0xBF) &&
+          !(c1 == 0xBF && (c2 == 0xBE || c2 == 0xBF)));
+}
+
+
+static inline gboolean
+is_bom_at (const guchar *s, gsize len, gsize i)
+{
+  return i + 2 < len && s[i] == 0xEF && s[i + 1] == 0xBB && s[i + 2] == 0xBF;
+}
+
+
+gboolean
+mmd_direct_check_utf8 (const gchar *value, gsize length)
+{
+  const guchar *s = (const guchar *)value;
+  gsize i = 0;
+
+  while (i < length)
+    {
+      guchar octet = s[i];
+      gsize width;
+      guint32 c;
+
+      if (octet < 0x80)
+        {
+          i++;
+          continue;
+        }
+
+      width = char_width (octet);
+      if (width == 0 || width > length - i)
+        {
+          return FALSE;
+        }
+
+      c = octet & (width == 2 ? 0x1F : width == 3 ? 0x0F : 0x07);
+      for (gsize k = 1; k < width; k++)
+        {
+          if ((s[i + k] & 0xC0) != 0x80)
+            {
+              return FALSE;
+            }
+          c = (c << 6) + (s[i + k] & 0x3F);
+        }
+
+      /* Overlong encodings */
+      if ((width == 2 && c < 0x80) || (width == 3 && c < 0x800) ||
+          (width == 4 && c < 0x10000))
+        {
+          return FALSE;
+        }
+
+      i += width;
+    }
+
+  return TRUE;
+}
+
+
+/* Output primitives. Like the macros of libyaml, they keep the column in
+ * characters rather than bytes.
+ */
+
+static inline gboolean
+reserve (modulemd_yaml_writer *self, gsize size)
+{
+  if (self->len + size <= sizeof (self->buffer))
+    {
+      return TRUE;
+    }
+
+  return writer_flush (self);
+}
+
+
+static inline gboolean
+put (modulemd_yaml_writer *self, guchar c)
+{
+  if (!reserve (self, MMD_YAML_WRITER_PUT_MAX))
+    {
+      return FALSE;
+    }
+
+  self->buffer[self->len++] = c;
+  self->column++;
+  return TRUE;
+}
+
+
+static inline gboolean
+put_break (modulemd_yaml_writer *self)
+{
+  if (!reserve (self, MMD_YAML_WRITER_PUT_MAX))
+    {
+      return FALSE;
+    }
+
+  if (self->line_break == YAML_CR_BREAK || self->line_break == YAML_CRLN_BREAK)
+    {
+      self->buffer[self->len++] = '\r';
+    }
+  if (self->line_break == YAML_LN_BREAK || self->line_break == YAML_CRLN_BREAK)
+    {
+      self->buffer[self->len++] = '\n';
+    }
+
+  self->column = 0;
+  return TRUE;
+}
+
+
+/* Copies the character at @s[*@i] and advances @i past it */
+static inline gboolean
+write_char (modulemd_yaml_writer *self, const guchar *s, gsize *i)
+{
+  gsize width = char_width (s[*i]);
+
+  if (!reserve (self, MMD_YAML_WRITER_PUT_MAX))
+    {
+      return FALSE;
+    }
+
+  memcpy (self->buffer + self->len, s + *i, width);
+  self->len += width;
+  self->column++;
+  *i += width;
+  return TRUE;
+}
+
+
+static inline gboolean
+write_break (modulemd_yaml_writer *self, const guchar *s, gsize *i)
+{
+  if (s[*i] == '\n')
+    {
+      (*i)++;
+      return put_break (self);
+    }
+
+  if (!write_char (self, s, i))
+    {
+      return FALSE;
+    }
+
+  self->column = 0;
+  return TRUE;
+}
+
+
+/* Copies @length bytes holding @n_chars characters in one piece */
+static gboolean
+write_run (modulemd_yaml_writer *self,
+           const guchar *s,
+           gsize length,
+           gsize n_chars)
+{
+  while (length > sizeof (self->buffer) - self->len)
+    {
+      gsize chunk = sizeof (self->buffer) - self->len;
+
+      memcpy (self->buffer + self->len, s, chunk);
+      self->len += chunk;
+      s += chunk;
+      length -= chunk;
+      if (!writer_flush (self))
+        {
+          return FALSE;
+        }
+    }
+
+  memcpy (self->buffer + self->len, s, length);
+  self->len += length;
+  self->column += n_chars;
+  return TRUE;
+}
+
+
+static gboolean
+write_indent (modulemd_yaml_writer *self)
+{
+  gint indent = self->indent >= 0 ? self->indent : 0;
+
+  if (!self->indention || self->column > indent ||
+      (self->column == indent && !self->whitespace))
+    {
+      if (!put_break (self))
+        {
+          return FALSE;
+        }
+    }
+
+  while (self->column < indent)
+    {
+      if (!put (self, ' '))
+        {
+          return FALSE;
+        }
+    }
+
+  self->whitespace = TRUE;
+  self->indention = TRUE;
+  return TRUE;
+}
+
+
+static gboolean
+write_indicator (modulemd_yaml_writer *self,
+                 const gchar *indicator,
+                 gboolean need_whitespace,
+                 gboolean is_whitespace,
+                 gboolean is_indention)
+{
+  if (need_whitespace && !self->whitespace)
+    {
+      if (!put (self, ' '))
+        {
+          return FALSE;
+        }
+    }
+
+  for (const gchar *c = indicator; *c; c++)
+    {
+      if (!put (self, *c))
+        {
+          return FALSE;
+        }
+    }
+
+  self->whitespace = is_whitespace;
+  self->indention = self->indention && is_indention;
+  return TRUE;
+}
+
+
+static void
+increase_indent (modulemd_yaml_writer *self,
+                 gboolean flow,
+                 gboolean indentless)
+{
+  g_array_append_val (self->indents, self->indent);
+
+  if (self->indent < 0)
+    {
+      self->indent = flow ? self->best_indent : 0;
+    }
+  else if (!indentless)
+    {
+      self->indent += self->best_indent;
+    }
+}
+
+
+static gint
+pop_indent (modulemd_yaml_writer *self)
+{
+  gint indent = g_array_index (self->indents, gint, self->indents->len - 1);
+
+  g_array_set_size (self->indents, self->indents->len - 1);
+  return indent;
+}
+
+
+static void
+push_state (modulemd_yaml_writer *self, yaml_emitter_state_t state)
+{
+  g_array_append_val (self->states, state);
+}
+
+
+static yaml_emitter_state_t
+pop_state (modulemd_yaml_writer *self)
+{
+  yaml_emitter_state_t state = g_array_index (
+    self->states, yaml_emitter_state_t, self->states->len - 1);
+
+  g_array_set_size (self->states, self->states->len - 1);
+  return state;
+}
+
+
+/* Decides which styles can represent @value, following
+ * yaml_emitter_analyze_scalar() of libyaml. It is the only pass over the
+ * scalar before it is written.
+ */
+static void
+analyze_scalar (modulemd_yaml_writer *self, const guchar *s, gsize len)
+{
+  scalar_analysis *a = &self->scalar;
+  gboolean block_indicators = FALSE;
+  gboolean flow_indicators = FALSE;
+  gboolean line_breaks = FALSE;
+  gboolean special_characters = FALSE;
+  gboolean leading_space = FALSE;
+  gboolean leading_break = FALSE;
+  gboolean trailing_space = FALSE;
+  gboolean trailing_break = FALSE;
+  gboolean break_space = FALSE;
+  gboolean space_break = FALSE;
+  gboolean preceded_by_whitespace;
+  gboolean previous_space = FALSE;
+  gboolean previous_break = FALSE;
+  gsize i = 0;
+
+  a->value = s;
+  a->length = len;
+  a->n_chars = 0;
+  a->has_escapes = FALSE;
+  a->has_quotes = FALSE;
+
+  if (len == 0)
+    {
+      a->multiline = FALSE;
+      a->flow_plain_allowed = FALSE;
+      a->block_plain_allowed = TRUE;
+      a->single_quoted_allowed = TRUE;
+      a->block_allowed = FALSE;
+      return;
+    }
+
+  if (len >= 3 && ((s[0] == '-' && s[1] == '-' && s[2] == '-') ||
+                   (s[0] == '.' && s[1] == '.' && s[2] == '.')))
+    {
+      block_indicators = TRUE;
+      flow_indicators = TRUE;
+    }
+
+  preceded_by_whitespace = TRUE;
+
+  while (i < len)
+    {
+      guchar c = s[i];
+      gsize width = char_width (c);
+      gboolean is_space = c == ' ';
+      gboolean is_break = FALSE;
+
+      if (i == 0)
+        {
+          switch (c)
+            {
+            case '#':
+            case ',':
+            case '[':
+            case ']':
+            case '{':
+            case '}':
+            case '&':
+            case '*':
+            case '!':
+            case '|':
+            case '>':
+            case '\'':
+            case '"':
+            case '%':
+            case '@':
+            case '`':
+              flow_indicators = TRUE;
+              block_indicators = TRUE;
+              break;
+
+            case '?':
+            case ':':
+              flow_indicators = TRUE;
+              if (is_blankz_at (s, len, i + width))
+                {
+                  block_indicators = TRUE;
+                }
+              break;
+
+            case '-':
+              if (is_blankz_at (s, len, i + width))
+                {
+                  flow_indicators = TRUE;
+                  block_indicators = TRUE;
+                }
+              break;
+
+            default: break;
+            }
+        }
+      else
+        {
+          switch (c)
+            {
+            case ',':
+            case '?':
+            case '[':
+            case ']':
+            case '{':
+            case '}': flow_indicators = TRUE; break;
+
+            case ':':
+              flow_indicators = TRUE;
+              if (is_blankz_at (s, len, i + width))
+                {
+                  block_indicators = TRUE;
+                }
+              break;
+
+            case '#':
+              if (preceded_by_whitespace)
+                {
+                  flow_indicators = TRUE;
+                  block_indicators = TRUE;
+                }
+              break;
+
+            default: break;
+            }
+        }
+
+      if (c < 0x80)
+        {
+          /* The common case of printable ASCII needs no further checks */
+          if (c < 0x20 || c == 0x7F)
+            {
+              if (c != '\n')
+                {
+                  special_characters = TRUE;
+                }
+              is_break = c == '\n' || c == '\r';
+              a->has_escapes = TRUE;
+            }
+          else if (c == '"' || c == '\\')
+            {
+              a->has_escapes = TRUE;
+            }
+          else if (c == '\'')
+            {
+              a->has_quotes = TRUE;
+            }
+        }
+      else
+        {
+          is_break = is_break_at (s, len, i);
+          if (!is_printable_at (s, len, i) || !self->unicode)
+            {
+              special_characters = TRUE;
+            }
+          if (is_break || !is_printable_at (s, len, i) || !self->unicode ||
+              is_bom_at (s, len, i))
+            {
+              a->has_escapes = TRUE;
+            }
+        }
+
+      if (is_break)
+        {
+          line_breaks = TRUE;
+        }
+
+      if (is_space)
+        {
+          if (i == 0)
+            {
+              leading_space = TRUE;
+            }
+          if (i + width == len)
+            {
+              trailing_space = TRUE;
+            }
+          if (previous_break)
+            {
+              break_space = TRUE;
+            }
+          previous_space = TRUE;
+          previous_break = FALSE;
+        }
+      else if (is_break)
+        {
+          if (i == 0)
+            {
+              leading_break = TRUE;
+            }
+          if (i + width == len)
+            {
+              trailing_break = TRUE;
+            }
+          if (previous_space)
+            {
+              space_break = TRUE;
+            }
+          previous_space = FALSE;
+          previous_break = TRUE;
+        }
+      else
+        {
+          previous_space = FALSE;
+          previous_break = FALSE;
+        }
+
+      preceded_by_whitespace = is_space || c == '\t' || is_break;
+      i += width;
+      a->n_chars++;
+    }
+
+  a->multiline = line_breaks;
+  a->flow_plain_allowed = TRUE;
+  a->block_plain_allowed = TRUE;
+  a->single_quoted_allowed = TRUE;
+  a->block_allowed = TRUE;
+
+  if (leading_space || leading_break || trailing_space || trailing_break)
+    {
+      a->flow_plain_allowed = FALSE;
+      a->block_plain_allowed = FALSE;
+    }
+
+  if (trailing_space)
+    {
+      a->block_allowed = FALSE;
+    }
+
+  if (break_space)
+    {
+      a->flow_plain_allowed = FALSE;
+      a->block_plain_allowed = FALSE;
+      a->single_quoted_allowed = FALSE;
+    }
+
+  if (space_break || special_characters)
+    {
+      a->flow_plain_allowed = FALSE;
+      a->block_plain_allowed = FALSE;
+      a->single_quoted_allowed = FALSE;
+      a->block_allowed = FALSE;
+    }
+
+  if (line_breaks)
+    {
+      a->flow_plain_allowed = FALSE;
+      a->block_plain_allowed = FALSE;
+    }
+
+  if (flow_indicators)
+    {
+      a->flow_plain_allowed = FALSE;
+    }
+
+  if (block_indicators)
+    {
+      a->block_plain_allowed = FALSE;
+    }
+}
+
+
+static gboolean
+select_scalar_style (modulemd_yaml_writer *self, const yaml_event_t *event)
+{
+  scalar_analysis *a = &self->scalar;
+  yaml_scalar_style_t style = event->data.scalar.style;
+
+  if (!event->data.scalar.plain_implicit &&
+      !event->data.scalar.quoted_implicit)
+    {
+      /* Either an explicit tag or an error in libyaml */
+      return FALSE;
+    }
+
+  if (style == YAML_ANY_SCALAR_STYLE)
+    {
+      style = YAML_PLAIN_SCALAR_STYLE;
+    }
+
+  if (self->simple_key_context && a->multiline)
+    {
+      style = YAML_DOUBLE_QUOTED_SCALAR_STYLE;
+    }
+
+  if (style == YAML_PLAIN_SCALAR_STYLE)
+    {
+      if ((self->flow_level && !a->flow_plain_allowed) ||
+          (!self->flow_level && !a->block_plain_allowed))
+        {
+          style = YAML_SINGLE_QUOTED_SCALAR_STYLE;
+        }
+      if (!a->length && (self->flow_level || self->simple_key_context))
+        {
+          style = YAML_SINGLE_QUOTED_SCALAR_STYLE;
+        }
+      if (!event->data.scalar.plain_implicit)
+        {
+          style = YAML_SINGLE_QUOTED_SCALAR_STYLE;
+        }
+    }
+
+  if (style == YAML_SINGLE_QUOTED_SCALAR_STYLE && !a->single_quoted_allowed)
+    {
+      style = YAML_DOUBLE_QUOTED_SCALAR_STYLE;
+    }
+
+  if ((style == YAML_LITERAL_SCALAR_STYLE ||
+       style == YAML_FOLDED_SCALAR_STYLE) &&
+      (!a->block_allowed || self->flow_level || self->simple_key_context))
+    {
+      style = YAML_DOUBLE_QUOTED_SCALAR_STYLE;
+    }
+
+  /* A quoted scalar that may only be resolved as a plain one carries the
+   * non-specific tag.
+   */
+  a->tagged =
+    !event->data.scalar.quoted_implicit && style != YAML_PLAIN_SCALAR_STYLE;
+  a->style = style;
+  return TRUE;
+}
+
+
+static gboolean
+write_plain_scalar (modulemd_yaml_writer *self, gboolean allow_breaks)
+{
+  const scalar_analysis *a = &self->scalar;
+  const guchar *s = a->value;
+  gsize len = a->length;
+  gboolean spaces = FALSE;
+  gboolean breaks = FALSE;
+  gsize i = 0;
+
+  /* Avoid trailing spaces for empty values in block mode */
+  if (!self->whitespace && (len || self->flow_level))
+    {
+      if (!put (self, ' '))
+        {
+          return FALSE;
+        }
+    }
+
+  /* No space can be reached beyond the line width, so there is nothing to
+   * fold.
+   */
+  if (self->column + a->n_chars <= (gsize)self->best_width)
+    {
+      if (!write_run (self, s, len, a->n_chars))
+        {
+          return FALSE;
+        }
+      i = len;
+    }
+
+  while (i < len)
+    {
+      if (s[i] == ' ')
+        {
+          if (allow_breaks && !spaces && self->column > self->best_width &&
+              !is_space_at (s, len, i + 1))
+            {
+              if (!write_indent (self))
+                {
+                  return FALSE;
+                }
+              i++;
+            }
+          else if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          spaces = TRUE;
+        }
+      else if (is_break_at (s, len, i))
+        {
+          if (!breaks && s[i] == '\n')
+            {
+              if (!put_break (self))
+                {
+                  return FALSE;
+                }
+            }
+          if (!write_break (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = TRUE;
+          breaks = TRUE;
+        }
+      else
+        {
+          if (breaks && !write_indent (self))
+            {
+              return FALSE;
+            }
+          if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = FALSE;
+          spaces = FALSE;
+          breaks = FALSE;
+        }
+    }
+
+  self->whitespace = FALSE;
+  self->indention = FALSE;
+  if (self->root_context)
+    {
+      self->emitter->open_ended = 1;
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+write_single_quoted_scalar (modulemd_yaml_writer *self,
+                            gboolean allow_breaks)
+{
+  const scalar_analysis *a = &self->scalar;
+  const guchar *s = a->value;
+  gsize len = a->length;
+  gboolean spaces = FALSE;
+  gboolean breaks = FALSE;
+  gsize i = 0;
+
+  if (!write_indicator (self, "'", TRUE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+
+  if (!a->has_quotes && !a->multiline &&
+      self->column + a->n_chars <= (gsize)self->best_width)
+    {
+      if (!write_run (self, s, len, a->n_chars))
+        {
+          return FALSE;
+        }
+      i = len;
+    }
+
+  while (i < len)
+    {
+      if (s[i] == ' ')
+        {
+          if (allow_breaks && !spaces && self->column > self->best_width &&
+              i != 0 && i != len - 1 && !is_space_at (s, len, i + 1))
+            {
+              if (!write_indent (self))
+                {
+                  return FALSE;
+                }
+              i++;
+            }
+          else if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          spaces = TRUE;
+        }
+      else if (is_break_at (s, len, i))
+        {
+          if (!breaks && s[i] == '\n')
+            {
+              if (!put_break (self))
+                {
+                  return FALSE;
+                }
+            }
+          if (!write_break (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = TRUE;
+          breaks = TRUE;
+        }
+      else
+        {
+          if (breaks && !write_indent (self))
+            {
+              return FALSE;
+            }
+          if (s[i] == '\'' && !put (self, '\''))
+            {
+              return FALSE;
+            }
+          if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = FALSE;
+          spaces = FALSE;
+          breaks = FALSE;
+        }
+    }
+
+  if (breaks && !write_indent (self))
+    {
+      return FALSE;
+    }
+
+  if (!write_indicator (self, "'", FALSE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+
+  self->whitespace = FALSE;
+  self->indention = FALSE;
+  return TRUE;
+}
+
+
+static gboolean
+write_escape (modulemd_yaml_writer *self, const guchar *s, gsize *i)
+{
+  static const gchar hex[] = "0123456789ABCDEF";
+  gsize width = char_width (s[*i]);
+  guint32 c;
+  gint digits;
+
+  c = width == 1 ? s[*i] :
+      s[*i] & (width == 2 ? 0x1F : width == 3 ? 0x0F : 0x07);
+  for (gsize k = 1; k < width; k++)
+    {
+      c = (c << 6) + (s[*i + k] & 0x3F);
+    }
+  *i += width;
+
+  if (!put (self, '\\'))
+    {
+      return FALSE;
+    }
+
+  switch (c)
+    {
+    case 0x00: return put (self, '0');
+    case 0x07: return put (self, 'a');
+    case 0x08: return put (self, 'b');
+    case 0x09: return put (self, 't');
+    case 0x0A: return put (self, 'n');
+    case 0x0B: return put (self, 'v');
+    case 0x0C: return put (self, 'f');
+    case 0x0D: return put (self, 'r');
+    case 0x1B: return put (self, 'e');
+    case 0x22: return put (self, '"');
+    case 0x5C: return put (self, '\\');
+    case 0x85: return put (self, 'N');
+    case 0xA0: return put (self, '_');
+    case 0x2028: return put (self, 'L');
+    case 0x2029: return put (self, 'P');
+    default: break;
+    }
+
+  if (c <= 0xFF)
+    {
+      digits = 2;
+      if (!put (self, 'x'))
+        {
+          return FALSE;
+        }
+    }
+  else if (c <= 0xFFFF)
+    {
+      digits = 4;
+      if (!put (self, 'u'))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      digits = 8;
+      if (!put (self, 'U'))
+        {
+          return FALSE;
+        }
+    }
+
+  for (gint k = (digits - 1) * 4; k >= 0; k -= 4)
+    {
+      if (!put (self, hex[(c >> k) & 0x0F]))
+        {
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+write_double_quoted_scalar (modulemd_yaml_writer *self,
+                            gboolean allow_breaks)
+{
+  const scalar_analysis *a = &self->scalar;
+  const guchar *s = a->value;
+  gsize len = a->length;
+  gboolean spaces = FALSE;
+  gsize i = 0;
+
+  if (!write_indicator (self, "\"", TRUE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+
+  if (!a->has_escapes && self->column + a->n_chars <= (gsize)self->best_width)
+    {
+      if (!write_run (self, s, len, a->n_chars))
+        {
+          return FALSE;
+        }
+      i = len;
+    }
+
+  while (i < len)
+    {
+      guchar c = s[i];
+
+      if ((c < 0x80 && (c < 0x20 || c == 0x7F || c == '"' || c == '\\')) ||
+          (c >= 0x80 &&
+           (!is_printable_at (s, len, i) || !self->unicode ||
+            is_bom_at (s, len, i) || is_break_at (s, len, i))))
+        {
+          /* A line feed is printable, but still escaped as a break */
+          if (!write_escape (self, s, &i))
+            {
+              return FALSE;
+            }
+          spaces = FALSE;
+        }
+      else if (c == ' ')
+        {
+          if (allow_breaks && !spaces && self->column > self->best_width &&
+              i != 0 && i != len - 1)
+            {
+              if (!write_indent (self))
+                {
+                  return FALSE;
+                }
+              if (is_space_at (s, len, i + 1) && !put (self, '\\'))
+                {
+                  return FALSE;
+                }
+              i++;
+            }
+          else if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          spaces = TRUE;
+        }
+      else
+        {
+          if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          spaces = FALSE;
+        }
+    }
+
+  if (!write_indicator (self, "\"", FALSE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+
+  self->whitespace = FALSE;
+  self->indention = FALSE;
+  return TRUE;
+}
+
+
+/* Steps back from @i to the start of the previous character */
+static inline gsize
+previous_char (const guchar *s, gsize i)
+{
+  do
+    {
+      i--;
+    }
+  while ((s[i] & 0xC0) == 0x80);
+
+  return i;
+}
+
+
+static gboolean
+write_block_scalar_hints (modulemd_yaml_writer *self)
+{
+  const scalar_analysis *a = &self->scalar;
+  const guchar *s = a->value;
+  gsize len = a->length;
+  gchar indent_hint[2];
+  const gchar *chomp_hint = NULL;
+  gboolean keep = FALSE;
+  gsize last;
+
+  if (len && (s[0] == ' ' || is_break_at (s, len, 0)))
+    {
+      indent_hint[0] = (gchar)('0' + self->best_indent);
+      indent_hint[1] = '\0';
+      if (!write_indicator (self, indent_hint, FALSE, FALSE, FALSE))
+        {
+          return FALSE;
+        }
+    }
+
+  self->emitter->open_ended = 0;
+
+  if (len == 0)
+    {
+      chomp_hint = "-";
+    }
+  else
+    {
+      last = previous_char (s, len);
+      if (!is_break_at (s, len, last))
+        {
+          chomp_hint = "-";
+        }
+      else if (last == 0 || is_break_at (s, len, previous_char (s, last)))
+        {
+          chomp_hint = "+";
+          keep = TRUE;
+        }
+    }
+
+  /* Kept trailing line breaks must be ended explicitly at the end of the
+   * stream.
+   */
+  if (keep)
+    {
+      self->emitter->open_ended = 2;
+    }
+
+  if (chomp_hint && !write_indicator (self, chomp_hint, FALSE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+write_literal_scalar (modulemd_yaml_writer *self)
+{
+  const scalar_analysis *a = &self->scalar;
+  const guchar *s = a->value;
+  gsize len = a->length;
+  gboolean breaks = TRUE;
+  gsize i = 0;
+
+  if (!write_indicator (self, "|", TRUE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+  if (!write_block_scalar_hints (self))
+    {
+      return FALSE;
+    }
+  if (!put_break (self))
+    {
+      return FALSE;
+    }
+  self->indention = TRUE;
+  self->whitespace = TRUE;
+
+  while (i < len)
+    {
+      if (is_break_at (s, len, i))
+        {
+          if (!write_break (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = TRUE;
+          breaks = TRUE;
+        }
+      else
+        {
+          if (breaks && !write_indent (self))
+            {
+              return FALSE;
+            }
+          if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = FALSE;
+          breaks = FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+write_folded_scalar (modulemd_yaml_writer *self)
+{
+  const scalar_analysis *a = &self->scalar;
+  const guchar *s = a->value;
+  gsize len = a->length;
+  gboolean breaks = TRUE;
+  gboolean leading_spaces = TRUE;
+  gsize i = 0;
+
+  if (!write_indicator (self, ">", TRUE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+  if (!write_block_scalar_hints (self))
+    {
+      return FALSE;
+    }
+  if (!put_break (self))
+    {
+      return FALSE;
+    }
+  self->indention = TRUE;
+  self->whitespace = TRUE;
+
+  while (i < len)
+    {
+      if (is_break_at (s, len, i))
+        {
+          if (!breaks && !leading_spaces && s[i] == '\n')
+            {
+              gsize k = i;
+
+              while (is_break_at (s, len, k))
+                {
+                  k += char_width (s[k]);
+                }
+              if (!is_blankz_at (s, len, k) && !put_break (self))
+                {
+                  return FALSE;
+                }
+            }
+          if (!write_break (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = TRUE;
+          breaks = TRUE;
+        }
+      else
+        {
+          if (breaks)
+            {
+              if (!write_indent (self))
+                {
+                  return FALSE;
+                }
+              leading_spaces = s[i] == ' ' || s[i] == '\t';
+            }
+          if (!breaks && s[i] == ' ' && !is_space_at (s, len, i + 1) &&
+              self->column > self->best_width)
+            {
+              if (!write_indent (self))
+                {
+                  return FALSE;
+                }
+              i++;
+            }
+          else if (!write_char (self, s, &i))
+            {
+              return FALSE;
+            }
+          self->indention = FALSE;
+          breaks = FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+emit_scalar (modulemd_yaml_writer *self, const yaml_event_t *event)
+{
+  gboolean allow_breaks = !self->simple_key_context;
+  gboolean ret = FALSE;
+
+  if (!select_scalar_style (self, event))
+    {
+      return FALSE;
+    }
+
+  if (self->scalar.tagged)
+    {
+      if (!self->whitespace && !put (self, ' '))
+        {
+          return FALSE;
+        }
+      if (!put (self, '!'))
+        {
+          return FALSE;
+        }
+      self->whitespace = FALSE;
+      self->indention = FALSE;
+    }
+
+  increase_indent (self, TRUE, FALSE);
+
+  switch (self->scalar.style)
+    {
+    case YAML_PLAIN_SCALAR_STYLE:
+      ret = write_plain_scalar (self, allow_breaks);
+      break;
+
+    case YAML_SINGLE_QUOTED_SCALAR_STYLE:
+      ret = write_single_quoted_scalar (self, allow_breaks);
+      break;
+
+    case YAML_DOUBLE_QUOTED_SCALAR_STYLE:
+      ret = write_double_quoted_scalar (self, allow_breaks);
+      break;
+
+    case YAML_LITERAL_SCALAR_STYLE: ret = write_literal_scalar (self); break;
+
+    case YAML_FOLDED_SCALAR_STYLE: ret = write_folded_scalar (self); break;
+
+    default: break;
+    }
+
+  if (!ret)
+    {
+      return FALSE;
+    }
+
+  self->indent = pop_indent (self);
+  self->state = pop_state (self);
+  return TRUE;
+}
+
+
+static gboolean
+emit_collection_start (modulemd_yaml_writer *self,
+                       const yaml_event_t *event)
+{
+  if (event->type == YAML_SEQUENCE_START_EVENT)
+    {
+      self->state =
+        (self->flow_level ||
+         event->data.sequence_start.style == YAML_FLOW_SEQUENCE_STYLE ||
+         self->next_is_end) ?
+          YAML_EMIT_FLOW_SEQUENCE_FIRST_ITEM_STATE :
+          YAML_EMIT_BLOCK_SEQUENCE_FIRST_ITEM_STATE;
+    }
+  else
+    {
+      self->state =
+        (self->flow_level ||
+         event->data.mapping_start.style == YAML_FLOW_MAPPING_STYLE ||
+         self->next_is_end) ?
+          YAML_EMIT_FLOW_MAPPING_FIRST_KEY_STATE :
+          YAML_EMIT_BLOCK_MAPPING_FIRST_KEY_STATE;
+    }
+
+  return TRUE;
+}
+
+
+static gboolean
+emit_node (modulemd_yaml_writer *self,
+           const yaml_event_t *event,
+           gboolean root,
+           gboolean sequence,
+           gboolean mapping,
+           gboolean simple_key)
+{
+  self->root_context = root;
+  self->sequence_context = sequence;
+  self->mapping_context = mapping;
+  self->simple_key_context = simple_key;
+
+  switch (event->type)
+    {
+    case YAML_SCALAR_EVENT: return emit_scalar (self, event);
+
+    case YAML_SEQUENCE_START_EVENT:
+    case YAML_MAPPING_START_EVENT: return emit_collection_start (self, event);
+
+    default: return FALSE;
+    }
+}
+
+
+/* Whether the node starting with @event fits on one line as a simple key */
+static gboolean
+check_simple_key (modulemd_yaml_writer *self, const yaml_event_t *event)
+{
+  switch (event->type)
+    {
+    case YAML_SCALAR_EVENT:
+      return !self->scalar.multiline &&
+             self->scalar.length <= MMD_YAML_WRITER_MAX_SIMPLE_KEY;
+
+    case YAML_SEQUENCE_START_EVENT:
+    case YAML_MAPPING_START_EVENT: return self->next_is_end;
+
+    default: return FALSE;
+    }
+}
+
+
+static gboolean
+emit_stream_start (modulemd_yaml_writer *self, const yaml_event_t *event)
+{
+  yaml_emitter_t *emitter = self->emitter;
+  yaml_encoding_t encoding = emitter->encoding;
+
+  emitter->open_ended = 0;
+
+  if (event->type != YAML_STREAM_START_EVENT)
+    {
+      return FALSE;
+    }
+
+  if (encoding == YAML_ANY_ENCODING)
+    {
+      encoding = event->data.stream_start.encoding;
+    }
+  if (encoding != YAML_ANY_ENCODING && encoding != YAML_UTF8_ENCODING)
+    {
+      return FALSE;
+    }
+  if (emitter->canonical)
+    {
+      return FALSE;
+    }
+
+  self->best_indent = emitter->best_indent;
+  if (self->best_indent < 2 || self->best_indent > 9)
+    {
+      self->best_indent = 2;
+    }
+  self->best_width = emitter->best_width;
+  if (self->best_width >= 0 && self->best_width <= self->best_indent * 2)
+    {
+      self->best_width = 80;
+    }
+  if (self->best_width < 0)
+    {
+      self->best_width = INT_MAX;
+    }
+  self->line_break = emitter->line_break;
+  if (self->line_break == YAML_ANY_BREAK)
+    {
+      self->line_break = YAML_LN_BREAK;
+    }
+  self->unicode = emitter->unicode;
+
+  self->indent = -1;
+  self->flow_level = 0;
+  self->column = 0;
+  self->whitespace = TRUE;
+  self->indention = TRUE;
+  self->state = YAML_EMIT_FIRST_DOCUMENT_START_STATE;
+  return TRUE;
+}
+
+
+static gboolean
+emit_document_start (modulemd_yaml_writer *self,
+                     const yaml_event_t *event,
+                     gboolean first)
+{
+  if (event->type == YAML_DOCUMENT_START_EVENT)
+    {
+      if (event->data.document_start.version_directive ||
+          event->data.document_start.tag_directives.start !=
+            event->data.document_start.tag_directives.end)
+        {
+          return FALSE;
+        }
+
+      self->emitter->open_ended = 0;
+
+      if (!first || !event->data.document_start.implicit)
+        {
+          if (!write_indent (self))
+            {
+              return FALSE;
+            }
+          if (!write_indicator (self, "---", TRUE, FALSE, FALSE))
+            {
+              return FALSE;
+            }
+        }
+
+      self->state = YAML_EMIT_DOCUMENT_CONTENT_STATE;
+      self->emitter->open_ended = 0;
+      return TRUE;
+    }
+
+  if (event->type == YAML_STREAM_END_EVENT)
+    {
+      /* A block scalar with trailing empty lines ended the stream */
+      if (self->emitter->open_ended == 2)
+        {
+          if (!write_indicator (self, "...", TRUE, FALSE, FALSE))
+            {
+              return FALSE;
+            }
+          self->emitter->open_ended = 0;
+          if (!write_indent (self))
+            {
+              return FALSE;
+            }
+        }
+
+      self->state = YAML_EMIT_END_STATE;
+      return writer_flush (self);
+    }
+
+  return FALSE;
+}
+
+
+static gboolean
+emit_document_end (modulemd_yaml_writer *self, const yaml_event_t *event)
+{
+  if (event->type != YAML_DOCUMENT_END_EVENT)
+    {
+      return FALSE;
+    }
+
+  if (!write_indent (self))
+    {
+      return FALSE;
+    }
+
+  if (!event->data.document_end.implicit)
+    {
+      if (!write_indent (self))
+        {
+          return FALSE;
+        }
+      if (!write_indicator (self, "...", TRUE, FALSE, FALSE))
+        {
+          return FALSE;
+        }
+      self->emitter->open_ended = 0;
+      if (!write_indent (self))
+        {
+          return FALSE;
+        }
+    }
+  else if (self->emitter->open_ended == 0)
+    {
+      self->emitter->open_ended = 1;
+    }
+
+  self->state = YAML_EMIT_DOCUMENT_START_STATE;
+  return writer_flush (self);
+}
+
+
+static gboolean
+emit_flow_sequence_item (modulemd_yaml_writer *self,
+                         const yaml_event_t *event,
+                         gboolean first)
+{
+  if (first)
+    {
+      if (!write_indicator (self, "[", TRUE, TRUE, FALSE))
+        {
+          return FALSE;
+        }
+      increase_indent (self, TRUE, FALSE);
+      self->flow_level++;
+    }
+
+  if (event->type == YAML_SEQUENCE_END_EVENT)
+    {
+      self->flow_level--;
+      self->indent = pop_indent (self);
+      if (!write_indicator (self, "]", FALSE, FALSE, FALSE))
+        {
+          return FALSE;
+        }
+      self->state = pop_state (self);
+      return TRUE;
+    }
+
+  if (!first && !write_indicator (self, ",", FALSE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+
+  if (self->column > self->best_width && !write_indent (self))
+    {
+      return FALSE;
+    }
+
+  push_state (self, YAML_EMIT_FLOW_SEQUENCE_ITEM_STATE);
+  return emit_node (self, event, FALSE, TRUE, FALSE, FALSE);
+}
+
+
+static gboolean
+emit_flow_mapping_key (modulemd_yaml_writer *self,
+                       const yaml_event_t *event,
+                       gboolean first)
+{
+  if (first)
+    {
+      if (!write_indicator (self, "{", TRUE, TRUE, FALSE))
+        {
+          return FALSE;
+        }
+      increase_indent (self, TRUE, FALSE);
+      self->flow_level++;
+    }
+
+  if (event->type == YAML_MAPPING_END_EVENT)
+    {
+      self->flow_level--;
+      self->indent = pop_indent (self);
+      if (!write_indicator (self, "}", FALSE, FALSE, FALSE))
+        {
+          return FALSE;
+        }
+      self->state = pop_state (self);
+      return TRUE;
+    }
+
+  if (!first && !write_indicator (self, ",", FALSE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+
+  if (self->column > self->best_width && !write_indent (self))
+    {
+      return FALSE;
+    }
+
+  if (check_simple_key (self, event))
+    {
+      push_state (self, YAML_EMIT_FLOW_MAPPING_SIMPLE_VALUE_STATE);
+      return emit_node (self, event, FALSE, FALSE, TRUE, TRUE);
+    }
+
+  if (!write_indicator (self, "?", TRUE, FALSE, FALSE))
+    {
+      return FALSE;
+    }
+  push_state (self, YAML_EMIT_FLOW_MAPPING_VALUE_STATE);
+  return emit_node (self, event, FALSE, FALSE, TRUE, FALSE);
+}
+
+
+static gboolean
+emit_flow_mapping_value (modulemd_yaml_writer *self,
+                         const yaml_event_t *event,
+                         gboolean simple)
+{
+  if (simple)
+    {
+      if (!write_indicator (self, ":", FALSE, FALSE, FALSE))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      if (self->column > self->best_width && !write_indent (self))
+        {
+          return FALSE;
+        }
+      if (!write_indicator (self, ":", TRUE, FALSE, FALSE))
+        {
+          return FALSE;
+        }
+    }
+
+  push_state (self, YAML_EMIT_FLOW_MAPPING_KEY_STATE);
+  return emit_node (self, event, FALSE, FALSE, TRUE, FALSE);
+}
+
+
+static gboolean
+emit_block_sequence_item (modulemd_yaml_writer *self,
+                          const yaml_event_t *event,
+                          gboolean first)
+{
+  if (first)
+    {
+      increase_indent (
+        self, FALSE, self->mapping_context && !self->indention);
+    }
+
+  if (event->type == YAML_SEQUENCE_END_EVENT)
+    {
+      self->indent = pop_indent (self);
+      self->state = pop_state (self);
+      return TRUE;
+    }
+
+  if (!write_indent (self))
+    {
+      return FALSE;
+    }
+  if (!write_indicator (self, "-", TRUE, FALSE, TRUE))
+    {
+      return FALSE;
+    }
+
+  push_state (self, YAML_EMIT_BLOCK_SEQUENCE_ITEM_STATE);
+  return emit_node (self, event, FALSE, TRUE, FALSE, FALSE);
+}
+
+
+static gboolean
+emit_block_mapping_key (modulemd_yaml_writer *self,
+                        const yaml_event_t *event,
+                        gboolean first)
+{
+  if (first)
+    {
+      increase_indent (self, FALSE, FALSE);
+    }
+
+  if (event->type == YAML_MAPPING_END_EVENT)
+    {
+      self->indent = pop_indent (self);
+      self->state = pop_state (self);
+      return TRUE;
+    }
+
+  if (!write_indent (self))
+    {
+      return FALSE;
+    }
+
+  if (check_simple_key (self, event))
+    {
+      push_state (self, YAML_EMIT_BLOCK_MAPPING_SIMPLE_VALUE_STATE);
+      return emit_node (self, event, FALSE, FALSE, TRUE, TRUE);
+    }
+
+  if (!write_indicator (self, "?", TRUE, FALSE, TRUE))
+    {
+      return FALSE;
+    }
+  push_state (self, YAML_EMIT_BLOCK_MAPPING_VALUE_STATE);
+  return emit_node (self, event, FALSE, FALSE, TRUE, FALSE);
+}
+
+
+static gboolean
+emit_block_mapping_value (modulemd_yaml_writer *self,
+                          const yaml_event_t *event,
+                          gboolean simple)
+{
+  if (simple)
+    {
+      if (!write_indicator (self, ":", FALSE, FALSE, FALSE))
+        {
+          return FALSE;
+        }
+    }
+  else
+    {
+      if (!write_indent (self))
+        {
+          return FALSE;
+        }
+      if (!write_indicator (self, ":", TRUE, FALSE, TRUE))
+        {
+          return FALSE;
+        }
+    }
+
+  push_state (self, YAML_EMIT_BLOCK_MAPPING_KEY_STATE);
+  return emit_node (self, event, FALSE, FALSE, TRUE, FALSE);
+}
+
+
+/* The state machine of yaml_emitter_emit(), without the event queue */
+static gboolean
+emit_event (modulemd_yaml_writer *self, const yaml_event_t *event)
+{
+  if (event->type == YAML_SCALAR_EVENT)
+    {
+      analyze_scalar (self,
+                      event->data.scalar.value,
+                      event->data.scalar.length);
+    }
+
+  switch (self->state)
+    {
+    case YAML_EMIT_STREAM_START_STATE: return emit_stream_start (self, event);
+
+    case YAML_EMIT_FIRST_DOCUMENT_START_STATE:
+      return emit_document_start (self, event, TRUE);
+
+    case YAML_EMIT_DOCUMENT_START_STATE:
+      return emit_document_start (self, event, FALSE);
+
+    case YAML_EMIT_DOCUMENT_CONTENT_STATE:
+      push_state (self, YAML_EMIT_DOCUMENT_END_STATE);
+      return emit_node (self, event, TRUE, FALSE, FALSE, FALSE);
+
+    case YAML_EMIT_DOCUMENT_END_STATE: return emit_document_end (self, event);
+
+    case YAML_EMIT_FLOW_SEQUENCE_FIRST_ITEM_STATE:
+      return emit_flow_sequence_item (self, event, TRUE);
+
+    case YAML_EMIT_FLOW_SEQUENCE_ITEM_STATE:
+      return emit_flow_sequence_item (self, event, FALSE);
+
+    case YAML_EMIT_FLOW_MAPPING_FIRST_KEY_STATE:
+      return emit_flow_mapping_key (self, event, TRUE);
+
+    case YAML_EMIT_FLOW_MAPPING_KEY_STATE:
+      return emit_flow_mapping_key (self, event, FALSE);
+
+    case YAML_EMIT_FLOW_MAPPING_SIMPLE_VALUE_STATE:
+      return emit_flow_mapping_value (self, event, TRUE);
+
+    case YAML_EMIT_FLOW_MAPPING_VALUE_STATE:
+      return emit_flow_mapping_value (self, event, FALSE);
+
+    case YAML_EMIT_BLOCK_SEQUENCE_FIRST_ITEM_STATE:
+      return emit_block_sequence_item (self, event, TRUE);
+
+    case YAML_EMIT_BLOCK_SEQUENCE_ITEM_STATE:
+      return emit_block_sequence_item (self, event, FALSE);
+
+    case YAML_EMIT_BLOCK_MAPPING_FIRST_KEY_STATE:
+      return emit_block_mapping_key (self, event, TRUE);
+
+    case YAML_EMIT_BLOCK_MAPPING_KEY_STATE:
+      return emit_block_mapping_key (self, event, FALSE);
+
+    case YAML_EMIT_BLOCK_MAPPING_SIMPLE_VALUE_STATE:
+      return emit_block_mapping_value (self, event, TRUE);
+
+    case YAML_EMIT_BLOCK_MAPPING_VALUE_STATE:
+      return emit_block_mapping_value (self, event, FALSE);
+
+    case YAML_EMIT_END_STATE: return FALSE;
+    }
+
+  return FALSE;
+}
+
+
+int
+mmd_direct_emit (yaml_emitter_t *emitter, const yaml_event_t *event)
+{
+  modulemd_yaml_writer *self =
+    (modulemd_yaml_writer *)emitter->write_handler_data;
+  yaml_event_t pending;
+  gboolean ret;
+
+  if (self->state == YAML_EMIT_STREAM_START_STATE)
+    {
+      self->debug = mmd_yaml_debug_enabled ();
+    }
+
+  if (self->debug)
+    {
+      if (event->type == YAML_SCALAR_EVENT)
+        {
+          g_debug ("Emitter event: %s: %s",
+                   mmd_yaml_get_event_name (event->type),
+                   (const gchar *)event->data.scalar.value);
+        }
+      else
+        {
+          g_debug ("Emitter event: %s", mmd_yaml_get_event_name (event->type));
+        }
+    }
+
+  switch (event->type)
+    {
+    case YAML_SCALAR_EVENT:
+      if (event->data.scalar.anchor)
+        {
+          return 0;
+        }
+      break;
+
+    case YAML_SEQUENCE_START_EVENT:
+      if (event->data.sequence_start.anchor ||
+          (event->data.sequence_start.tag &&
+           !event->data.sequence_start.implicit))
+        {
+          return 0;
+        }
+      break;
+
+    case YAML_MAPPING_START_EVENT:
+      if (event->data.mapping_start.anchor ||
+          (event->data.mapping_start.tag &&
+           !event->data.mapping_start.implicit))
+        {
+          return 0;
+        }
+      break;
+
+    case YAML_ALIAS_EVENT:
+    case YAML_NO_EVENT: return 0;
+
+    default: break;
+    }
+
+  if (self->have_pending)
+    {
+      memset (&pending, 0, sizeof (yaml_event_t));
+      pending.type = self->pending.type;
+      if (pending.type == YAML_SEQUENCE_START_EVENT)
+        {
+          pending.data.sequence_start.style = self->pending.style;
+        }
+      else
+        {
+          pending.data.mapping_start.style = self->pending.style;
+        }
+
+      self->have_pending = FALSE;
+      self->next_is_end = (pending.type == YAML_SEQUENCE_START_EVENT &&
+                           event->type == YAML_SEQUENCE_END_EVENT) ||
+                          (pending.type == YAML_MAPPING_START_EVENT &&
+                           event->type == YAML_MAPPING_END_EVENT);
+      ret = emit_event (self, &pending);
+      self->next_is_end = FALSE;
+      if (!ret)
+        {
+          return 0;
+        }
+    }
+
+  if (event->type == YAML_SEQUENCE_START_EVENT)
+    {
+      self->have_pending = TRUE;
+      self->pending.type = event->type;
+      self->pending.style = event->data.sequence_start.style;
+      return 1;
+    }
+
+  if (event->type == YAML_MAPPING_START_EVENT)
+    {
+      self->have_pending = TRUE;
+      self->pending.type = event->type;
+      self->pending.style = event->data.mapping_start.style;
+      return 1;
+    }
+
+  return emit_event (self, event);
+}
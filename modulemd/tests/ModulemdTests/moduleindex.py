@@ -13,6 +13,8 @@
 # <https://www.gnu.org/philosophy/free-sw.en.html>.
 
 from os import path
+import gzip
+import json
 import sys
 
 try:
@@ -144,6 +146,394 @@ profiles:
 
         self.assertNotIn("nodejs", default_streams.keys())
 
+    def test_get_default_stream(self):
+        idx = Modulemd.ModuleIndex.new()
+        idx.update_from_file(path.join(self.test_data_path, "f29.yaml"), True)
+
+        self.assertEqual("6.1", idx.get_default_stream("dwm", None))
+        self.assertEqual("1", idx.get_default_stream("stratis", None))
+        self.assertIsNone(idx.get_default_stream("nodejs", None))
+
+        self.assertTrue(idx.remove_module("dwm"))
+        self.assertIsNone(idx.get_default_stream("dwm", None))
+
+    def test_freeze(self):
+        idx = Modulemd.ModuleIndex.new()
+        idx.update_from_file(path.join(self.test_data_path, "f29.yaml"), True)
+        expected = idx.dump_to_string()
+
+        self.assertFalse(idx.is_frozen())
+        idx.freeze()
+        self.assertTrue(idx.is_frozen())
+
+        self.assertEqual("6.1", idx.get_default_stream("dwm", None))
+        self.assertEqual(expected, idx.dump_to_string())
+
+        stream = Modulemd.ModuleStreamV2.new("foo", "a")
+        with self.assertRaisesRegex(GLib.Error, "frozen"):
+            idx.add_module_stream(stream)
+
+        with self.assertRaisesRegex(GLib.Error, "frozen"):
+            idx.update_from_file(
+                path.join(self.test_data_path, "f29-updates.yaml"), True
+            )
+
+        self.assertEqual(expected, idx.dump_to_string())
+
+    def test_diff(self):
+        old = Modulemd.ModuleIndex.new()
+        old.update_from_file(path.join(self.test_data_path, "f29.yaml"), True)
+        new = Modulemd.ModuleIndex.new()
+        new.update_from_file(path.join(self.test_data_path, "f29.yaml"), True)
+
+        self.assertTrue(old.diff(new).is_empty())
+
+        self.assertTrue(new.remove_module("dwm"))
+        stream = new.search_streams("stratis", None, None, None, None)[0]
+        stream.set_summary("A changed summary")
+
+        diff = old.diff(new)
+        self.assertFalse(diff.is_empty())
+        self.assertEqual(len(diff.get_added_streams()), 0)
+        for removed in diff.get_removed_streams():
+            self.assertEqual(removed.get_module_name(), "dwm")
+        self.assertEqual(len(diff.get_changed_streams()), 1)
+        self.assertEqual(
+            diff.get_changed_streams()[0].get_NSVCA_as_string(),
+            stream.get_NSVCA_as_string(),
+        )
+        self.assertEqual(len(diff.get_removed_defaults()), 1)
+
+    def test_delta(self):
+        old = Modulemd.ModuleIndex.new()
+        old.update_from_file(path.join(self.test_data_path, "f29.yaml"), True)
+        new = Modulemd.ModuleIndex.new()
+        new.update_from_file(path.join(self.test_data_path, "f29.yaml"), True)
+
+        self.assertTrue(new.remove_module("dwm"))
+        stream = new.search_streams("stratis", None, None, None, None)[0]
+        stream.set_summary("A changed summary")
+        self.assertNotEqual(old.get_digest(), new.get_digest())
+
+        delta = old.dump_delta_to_string(new)
+        self.assertIn("document: modulemd-delta", delta)
+
+        target = Modulemd.ModuleIndex.new()
+        target.update_from_file(
+            path.join(self.test_data_path, "f29.yaml"), True
+        )
+        self.assertTrue(target.apply_delta(delta))
+        self.assertIsNone(target.get_module("dwm"))
+        self.assertEqual(target.get_digest(), new.get_digest())
+        self.assertTrue(target.diff(new).is_empty())
+
+        # The base digest no longer matches
+        with self.assertRaisesRegex(GLib.Error, "digest"):
+            target.apply_delta(delta)
+
+    def test_search_streams_by_query(self):
+        idx = Modulemd.ModuleIndex.new()
+        idx.update_from_file(
+            path.join(
+                self.test_data_path, "search_streams/search_streams.yaml"
+            ),
+            True,
+        )
+
+        query = Modulemd.StreamQuery.new("nodejs", None, "1", None, None)
+        streams = idx.search_streams_by_query(query)
+        self.assertEqual(3, len(streams))
+        self.assertEqual(
+            ["6", "8", "9"], [s.props.stream_name for s in streams]
+        )
+
+        query = Modulemd.StreamQuery.new_from_nsvca_glob("*:2.5*")
+        streams = idx.search_streams_by_query(query)
+        self.assertEqual(1, len(streams))
+        self.assertEqual("reviewboard", streams[0].props.module_name)
+        self.assertTrue(query.matches(streams[0]))
+
+    def test_search_package_providers(self):
+        stream = Modulemd.ModuleStreamV2.new("foo", "1")
+        stream.props.version = 1
+        stream.props.context = "c0ffee42"
+        stream.add_rpm_api("foo-cli")
+        profile = Modulemd.Profile.new("default")
+        profile.add_rpm("foo-cli")
+        stream.add_profile(profile)
+        stream.add_component(Modulemd.ComponentRpm.new("foo"))
+
+        idx = Modulemd.ModuleIndex.new()
+        idx.add_module_stream(stream)
+
+        providers = idx.search_package_providers(
+            "foo-cli", Modulemd.PackageSourceFlags.ALL
+        )
+        self.assertEqual(2, len(providers))
+        self.assertEqual(
+            [
+                Modulemd.PackageSourceFlags.RPM_API,
+                Modulemd.PackageSourceFlags.PROFILE,
+            ],
+            [p.get_source() for p in providers],
+        )
+        self.assertIsNone(providers[0].get_profile_name())
+        self.assertEqual("default", providers[1].get_profile_name())
+        self.assertEqual("foo", providers[0].get_stream().props.module_name)
+
+        providers = idx.search_package_providers(
+            "foo", Modulemd.PackageSourceFlags.COMPONENT
+        )
+        self.assertEqual(1, len(providers))
+
+        providers = idx.search_package_providers(
+            "foo-cli", Modulemd.PackageSourceFlags.COMPONENT
+        )
+        self.assertEqual(0, len(providers))
+
+    def test_get_memory_usage(self):
+        stream = Modulemd.ModuleStreamV2.new("foo", "1")
+        stream.props.version = 1
+        stream.props.context = "c0ffee42"
+        stream.add_rpm_artifact("foo-0:1.0-1.module_f32.x86_64")
+
+        idx = Modulemd.ModuleIndex.new()
+        idx.add_module_stream(stream)
+
+        usage = idx.get_memory_usage()
+        self.assertEqual(["foo"], usage.get_module_names())
+        self.assertGreater(usage.get_module_total("foo"), 0)
+        self.assertGreater(
+            usage.get_module_category(
+                "foo", Modulemd.MemoryCategoryEnum.ARTIFACTS
+            ),
+            0,
+        )
+        self.assertEqual(0, usage.get_module_total("bar"))
+        self.assertEqual(
+            usage.get_total(),
+            usage.get_module_total("foo") + usage.get_module_total(None),
+        )
+
+    def test_compact(self):
+        idx = Modulemd.ModuleIndex.new()
+        for arch in ("x86_64", "ppc64le"):
+            stream = Modulemd.ModuleStreamV2.new("foo", "1")
+            stream.props.version = 1
+            stream.props.context = "c0ffee42"
+            stream.props.arch = arch
+            stream.set_summary("Summary")
+            stream.set_description("Description")
+            stream.add_module_license("MIT")
+            component = Modulemd.ComponentRpm.new("bar")
+            component.props.rationale = "Demonstration"
+            stream.add_component(component)
+            idx.add_module_stream(stream)
+
+        expected = idx.dump_to_string()
+        # The empty buildafter, arches and multilib sets of both components
+        # share one instance
+        self.assertEqual(5, idx.compact())
+        self.assertFalse(idx.is_frozen())
+        self.assertEqual(expected, idx.dump_to_string())
+        self.assertEqual(0, idx.compact())
+
+        # The streams can still be modified independently
+        module = idx.get_module("foo")
+        x86_64 = module.get_stream_by_NSVCA("1", 1, "c0ffee42", "x86_64")
+        ppc64le = module.get_stream_by_NSVCA("1", 1, "c0ffee42", "ppc64le")
+        x86_64.get_rpm_component("bar").add_restricted_arch("x86_64")
+        self.assertEqual(
+            ["x86_64"], x86_64.get_rpm_component("bar").get_arches()
+        )
+        self.assertEqual([], ppc64le.get_rpm_component("bar").get_arches())
+
+        loaded = Modulemd.ModuleIndex.new()
+        self.assertFalse(loaded.get_compact_on_load())
+        loaded.set_compact_on_load(True)
+        self.assertTrue(loaded.get_compact_on_load())
+        ret, failures = loaded.update_from_string(expected, True)
+        self.assertTrue(ret)
+        self.assertEqual(expected, loaded.dump_to_string())
+        self.assertEqual(0, loaded.compact())
+
+    def test_update_from_bytes(self):
+        with open(
+            path.join(self.test_data_path, "compression/uncompressed.yaml"),
+            "rb",
+        ) as f:
+            data = f.read()
+
+        baseline = ModuleIndex.new()
+        ret, failures = baseline.update_from_string(data.decode(), True)
+        self.assertTrue(ret)
+
+        idx = ModuleIndex.new()
+        ret, failures = idx.update_from_bytes(GLib.Bytes.new(data), True)
+        debug_dump_failures(failures)
+        self.assertTrue(ret)
+        self.assertEqual(baseline.dump_to_string(), idx.dump_to_string())
+
+        idx = ModuleIndex.new()
+        try:
+            ret, failures = idx.update_from_bytes(
+                GLib.Bytes.new(gzip.compress(data)), True
+            )
+        except GLib.GError as e:
+            if e.matches(
+                domain=Modulemd.error_quark(),
+                code=Modulemd.Error.NOT_IMPLEMENTED,
+            ):
+                self.skipTest("No native gzip support")
+            raise
+        debug_dump_failures(failures)
+        self.assertTrue(ret)
+        self.assertEqual(baseline.dump_to_string(), idx.dump_to_string())
+
+    def test_json(self):
+        fname = path.join(self.test_data_path, "f29-updates.yaml")
+        baseline = ModuleIndex.new()
+        ret, failures = baseline.update_from_file(fname, True)
+        self.assertTrue(ret)
+
+        # One JSON object per YAML document
+        yaml = baseline.dump_to_string()
+        text = baseline.dump_to_json()
+        documents = json.loads(text)
+        self.assertEqual(yaml.splitlines().count("..."), len(documents))
+        for document in documents:
+            self.assertIn(
+                document["document"], ("modulemd", "modulemd-defaults")
+            )
+            self.assertIsInstance(document["version"], int)
+            self.assertIsInstance(document["data"], dict)
+
+        idx = ModuleIndex.new()
+        ret, failures = idx.update_from_json(text, True)
+        debug_dump_failures(failures)
+        self.assertTrue(ret)
+        self.assertEqual(yaml, idx.dump_to_string())
+
+        idx = ModuleIndex.new()
+        ret, failures = idx.update_from_cbor(baseline.dump_to_cbor(), True)
+        debug_dump_failures(failures)
+        self.assertTrue(ret)
+        self.assertEqual(yaml, idx.dump_to_string())
+
+        # json.dumps() escapes characters outside the BMP as surrogate pairs
+        documents[0]["data"]["summary"] = "Smile \U0001F600"
+        text = json.dumps(documents)
+        self.assertIn("\\ud83d\\ude00", text)
+        idx = ModuleIndex.new()
+        ret, failures = idx.update_from_json(text, True)
+        debug_dump_failures(failures)
+        self.assertTrue(ret)
+        self.assertIn("summary: Smile \U0001F600", idx.dump_to_string())
+
+    def test_bulk_access(self):
+        idx = ModuleIndex.new()
+        ret, failures = idx.update_from_file(
+            path.join(self.test_data_path, "f29-updates.yaml"), True
+        )
+        self.assertTrue(ret)
+        streams = idx.search_streams_by_nsvca_glob(None)
+
+        self.assertEqual(
+            [
+                (
+                    s.props.module_name,
+                    s.props.stream_name,
+                    s.props.version,
+                    s.props.context or "",
+                    s.props.arch or "",
+                )
+                for s in streams
+            ],
+            idx.get_stream_table(),
+        )
+
+        artifacts = [(s.get_NSVCA(), s.get_rpm_artifacts()) for s in streams]
+        self.assertEqual(artifacts, idx.get_rpm_artifacts_table())
+
+        artifact_map = {}
+        for nsvca, nevras in artifacts:
+            for nevra in nevras:
+                artifact_map.setdefault(nevra, []).append(nsvca)
+        self.assertEqual(artifact_map, idx.get_rpm_artifact_map())
+
+        dependencies = []
+        for s in streams:
+            for i, deps in enumerate(s.get_dependencies()):
+                for module in deps.get_buildtime_modules():
+                    dependencies.append(
+                        (
+                            s.get_NSVCA(),
+                            i,
+                            False,
+                            module,
+                            deps.get_buildtime_streams(module),
+                        )
+                    )
+                for module in deps.get_runtime_modules():
+                    dependencies.append(
+                        (
+                            s.get_NSVCA(),
+                            i,
+                            True,
+                            module,
+                            deps.get_runtime_streams(module),
+                        )
+                    )
+        self.assertEqual(dependencies, idx.get_dependencies_table())
+
+        query = Modulemd.StreamQuery.new("nodejs", None, None, None, None)
+        self.assertEqual(
+            [
+                row
+                for row in idx.get_stream_table()
+                if row[0] == "nodejs"
+            ],
+            idx.get_stream_table(query),
+        )
+
+    def test_update_from_file_async(self):
+        fname = path.join(self.test_data_path, "f29-updates.yaml")
+        baseline = ModuleIndex.new()
+        ret, failures = baseline.update_from_file(fname, True)
+        self.assertTrue(ret)
+
+        loop = GLib.MainLoop()
+        progress = []
+        results = []
+
+        def on_progress(bytes_processed, documents_processed, *data):
+            progress.append((bytes_processed, documents_processed))
+
+        def on_ready(idx, result, *data):
+            results.append(idx.update_from_file_finish(result))
+            loop.quit()
+
+        idx = ModuleIndex.new()
+        idx.update_from_file_async(
+            fname,
+            True,
+            GLib.PRIORITY_DEFAULT,
+            None,
+            on_progress,
+            None,
+            on_ready,
+            None,
+        )
+        loop.run()
+
+        ret, failures = results[0]
+        debug_dump_failures(failures)
+        self.assertTrue(ret)
+        self.assertListEqual(failures, [])
+        self.assertNotEqual(progress, [])
+        self.assertEqual(progress, sorted(progress))
+        self.assertEqual(baseline.dump_to_string(), idx.dump_to_string())
+
     def test_dump_empty_index(self):
         idx = Modulemd.ModuleIndex.new()
 
@@ -11,10 +11,13 @@
  * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
  */
 
+#include <fcntl.h>
 #include <glib.h>
 #include <glib/gstdio.h>
+#include <unistd.h>
 
 #include "modulemd-compression.h"
+#include "modulemd-errors.h"
 #include "private/modulemd-compression-private.h"
 #include "private/modulemd-yaml.h"
 #include "private/test-utils.h"
@@ -224,6 +227,129 @@ test_modulemd_get_rpmio_fmode (void)
 }
 
 
+struct expected_decompress_t
+{
+  const char *filename;
+  ModulemdCompressionTypeEnum type;
+};
+
+static gchar *
+decompress_fd (ModulemdCompressionTypeEnum type,
+               int fd,
+               gsize max_len,
+               GError **error)
+{
+  g_autoptr (ModulemdDecompressor) decompressor = NULL;
+  g_autoptr (GString) output = g_string_new (NULL);
+  unsigned char buffer[1000];
+  size_t size_read;
+
+  decompressor = modulemd_decompressor_new_for_fd (type, fd, error);
+  g_assert_nonnull (decompressor);
+
+  while (output->len < max_len &&
+         modulemd_decompressor_read_fn (
+           decompressor, buffer, sizeof (buffer), &size_read) &&
+         size_read > 0)
+    {
+      g_string_append_len (output, (const gchar *)buffer, size_read);
+    }
+
+  if (!modulemd_decompressor_close (decompressor, error))
+    {
+      return NULL;
+    }
+
+  return g_string_free (g_steal_pointer (&output), FALSE);
+}
+
+static void
+test_modulemd_decompressor (void)
+{
+  int fd;
+  g_autofree gchar *filename = NULL;
+  g_autofree gchar *uncompressed = NULL;
+  g_autofree gchar *compressed = NULL;
+  g_autofree gchar *output = NULL;
+  g_autofree gchar *tmp_path = NULL;
+  gsize compressed_len;
+  g_autoptr (GError) error = NULL;
+
+  struct expected_decompress_t expected[] = {
+    { .filename = "bzipped.yaml.bz2",
+      .type = MODULEMD_COMPRESSION_TYPE_BZ2_COMPRESSION },
+    { .filename = "gzipped.yaml.gz",
+      .type = MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION },
+    { .filename = "xzipped.yaml.xz",
+      .type = MODULEMD_COMPRESSION_TYPE_XZ_COMPRESSION },
+    { .filename = "zstded.yaml.zst",
+      .type = MODULEMD_COMPRESSION_TYPE_ZSTD_COMPRESSION },
+    { .filename = NULL }
+  };
+
+  g_assert_false (modulemd_decompressor_supported (
+    MODULEMD_COMPRESSION_TYPE_NO_COMPRESSION));
+  g_assert_null (modulemd_decompressor_new_for_fd (
+    MODULEMD_COMPRESSION_TYPE_ZCK_COMPRESSION, 0, &error));
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_NOT_IMPLEMENTED);
+  g_clear_error (&error);
+
+  filename = g_strdup_printf ("%s/compression/uncompressed.yaml",
+                              g_getenv ("TEST_DATA_PATH"));
+  g_assert_true (g_file_get_contents (filename, &uncompressed, NULL, NULL));
+  g_clear_pointer (&filename, g_free);
+
+  for (size_t i = 0; expected[i].filename; i++)
+    {
+      if (!modulemd_decompressor_supported (expected[i].type))
+        {
+          g_debug ("No native decompression support for %s",
+                   expected[i].filename);
+          continue;
+        }
+
+      filename = g_strdup_printf ("%s/compression/%s",
+                                  g_getenv ("TEST_DATA_PATH"),
+                                  expected[i].filename);
+      g_assert_true (
+        g_file_get_contents (filename, &compressed, &compressed_len, NULL));
+
+      /* The complete file */
+      fd = g_open (filename, O_RDONLY, 0);
+      g_assert_cmpint (fd, >=, 0);
+      output = decompress_fd (expected[i].type, fd, G_MAXSIZE, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (output, ==, uncompressed);
+      g_clear_pointer (&output, g_free);
+
+      /* Stopping early discards the rest of the output */
+      g_assert_cmpint (lseek (fd, 0, SEEK_SET), ==, 0);
+      output = decompress_fd (expected[i].type, fd, 1, &error);
+      g_assert_no_error (error);
+      g_assert_true (g_str_has_prefix (uncompressed, output));
+      g_clear_pointer (&output, g_free);
+      g_close (fd, NULL);
+
+      /* Truncated data is reported as an error */
+      fd = g_file_open_tmp ("modulemd-XXXXXX", &tmp_path, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (
+        write (fd, compressed, compressed_len / 2), ==, compressed_len / 2);
+      g_assert_cmpint (lseek (fd, 0, SEEK_SET), ==, 0);
+      output = decompress_fd (expected[i].type, fd, G_MAXSIZE, &error);
+      g_assert_null (output);
+      g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FILE_ACCESS);
+      g_clear_error (&error);
+      g_close (fd, NULL);
+      g_unlink (tmp_path);
+
+      g_clear_pointer (&tmp_path, g_free);
+      g_clear_pointer (&compressed, g_free);
+      g_clear_pointer (&filename, g_free);
+    }
+}
+
+
 int
 main (int argc, char *argv[])
 {
@@ -244,5 +370,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/modulemd/compression/rmpio/fmode",
                    test_modulemd_get_rpmio_fmode);
 
+  g_test_add_func ("/modulemd/compression/decompressor",
+                   test_modulemd_decompressor);
+
   return g_test_run ();
 }
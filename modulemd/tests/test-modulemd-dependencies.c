@@ -399,6 +399,29 @@ dependencies_test_copy_regular (void)
   g_assert_nonnull (list);
   g_assert_cmpint (g_strv_length (list), ==, 0);
   g_clear_pointer (&list, g_strfreev);
+
+  /* Modifying the copy must not change the original, nor the reverse */
+  modulemd_dependencies_add_buildtime_stream (d_copy, "buildmod1", "stream5");
+  modulemd_dependencies_clear_runtime_dependencies (d);
+
+  list = modulemd_dependencies_get_buildtime_streams_as_strv (d, "buildmod1");
+  g_assert_nonnull (list);
+  g_assert_cmpint (g_strv_length (list), ==, 2);
+  g_clear_pointer (&list, g_strfreev);
+  list =
+    modulemd_dependencies_get_buildtime_streams_as_strv (d_copy, "buildmod1");
+  g_assert_nonnull (list);
+  g_assert_cmpint (g_strv_length (list), ==, 3);
+  g_clear_pointer (&list, g_strfreev);
+
+  list = modulemd_dependencies_get_runtime_modules_as_strv (d);
+  g_assert_nonnull (list);
+  g_assert_cmpint (g_strv_length (list), ==, 0);
+  g_clear_pointer (&list, g_strfreev);
+  list = modulemd_dependencies_get_runtime_modules_as_strv (d_copy);
+  g_assert_nonnull (list);
+  g_assert_cmpint (g_strv_length (list), ==, 2);
+  g_clear_pointer (&list, g_strfreev);
 }
 
 
@@ -0,0 +1,382 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <locale.h>
+
+#include "modulemd.h"
+#include "private/glib-extensions.h"
+#include "private/modulemd-compression-private.h"
+#include "private/test-utils.h"
+
+
+/*
+ * Copies every valid subdocument from @reader to a string writer.
+ *
+ * Returns: The YAML output. Sets @n_failures to the number of invalid
+ * subdocuments that were skipped.
+ */
+static gchar *
+copy_documents (ModulemdDocumentReader *reader, guint *n_failures)
+{
+  g_autoptr (ModulemdDocumentWriter) writer = NULL;
+  g_autoptr (GError) error = NULL;
+  GObject *object = NULL;
+
+  writer = modulemd_document_writer_new_for_string ();
+  *n_failures = 0;
+
+  while ((object = modulemd_document_reader_next (reader, &error)))
+    {
+      if (MODULEMD_IS_SUBDOCUMENT_INFO (object))
+        {
+          g_assert_nonnull (modulemd_subdocument_info_get_gerror (
+            MODULEMD_SUBDOCUMENT_INFO (object)));
+          (*n_failures)++;
+        }
+      else
+        {
+          g_assert_true (
+            modulemd_document_writer_write (writer, object, &error));
+          g_assert_no_error (error);
+        }
+      g_object_unref (object);
+    }
+  g_assert_no_error (error);
+
+  /* The end of the stream is sticky */
+  g_assert_null (modulemd_document_reader_next (reader, &error));
+  g_assert_no_error (error);
+
+  g_assert_true (modulemd_document_writer_close (writer, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (modulemd_document_writer_get_documents_written (writer),
+                    ==,
+                    modulemd_document_reader_get_documents_read (reader) -
+                      *n_failures);
+
+  return g_strdup (modulemd_document_writer_get_string (writer));
+}
+
+
+/*
+ * Asserts that loading @yaml into an index gives the same result as loading
+ * @yaml_path directly.
+ */
+static void
+assert_same_index (const gchar *yaml_path, const gchar *yaml)
+{
+  g_autoptr (ModulemdModuleIndex) expected = NULL;
+  g_autoptr (ModulemdModuleIndex) actual = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *expected_yaml = NULL;
+  g_autofree gchar *actual_yaml = NULL;
+
+  expected = modulemd_module_index_new ();
+  modulemd_module_index_update_from_file (
+    expected, yaml_path, FALSE, &failures, &error);
+  g_assert_no_error (error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+
+  actual = modulemd_module_index_new ();
+  g_assert_true (modulemd_module_index_update_from_string (
+    actual, yaml, FALSE, &failures, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (failures->len, ==, 0);
+
+  expected_yaml = modulemd_module_index_dump_to_string (expected, &error);
+  g_assert_no_error (error);
+  actual_yaml = modulemd_module_index_dump_to_string (actual, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (expected_yaml, ==, actual_yaml);
+}
+
+
+static void
+document_reader_test_read_write (void)
+{
+  g_autoptr (ModulemdDocumentReader) reader = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *yaml_path = NULL;
+  g_autofree gchar *output = NULL;
+  guint n_failures;
+
+  yaml_path =
+    g_strdup_printf ("%s/f29-updates.yaml", g_getenv ("TEST_DATA_PATH"));
+
+  reader = modulemd_document_reader_new_for_file (yaml_path, TRUE, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (reader);
+
+  output = copy_documents (reader, &n_failures);
+  g_assert_cmpuint (n_failures, ==, 0);
+  g_assert_cmpuint (modulemd_document_reader_get_documents_read (reader),
+                    ==,
+                    65);
+
+  assert_same_index (yaml_path, output);
+}
+
+
+static void
+document_reader_test_failures (void)
+{
+  g_autoptr (ModulemdDocumentReader) reader = NULL;
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *yaml_path = NULL;
+  g_autofree gchar *output = NULL;
+  guint n_failures;
+
+  yaml_path =
+    g_strdup_printf ("%s/good_and_bad.yaml", g_getenv ("TEST_DATA_PATH"));
+
+  index = modulemd_module_index_new ();
+  modulemd_module_index_update_from_file (
+    index, yaml_path, FALSE, &failures, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (failures->len, >, 0);
+
+  /* Invalid subdocuments are reported exactly as the index reports them */
+  reader = modulemd_document_reader_new_for_file (yaml_path, FALSE, &error);
+  g_assert_no_error (error);
+
+  output = copy_documents (reader, &n_failures);
+  g_assert_cmpuint (n_failures, ==, failures->len);
+
+  assert_same_index (yaml_path, output);
+}
+
+
+static void
+document_reader_test_compressed (void)
+{
+  g_autoptr (ModulemdDocumentReader) reader = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *yaml_path = NULL;
+  g_autofree gchar *output = NULL;
+  guint n_failures;
+  const gchar *compressed[] = {
+    "bzipped", "gzipped", "xzipped", "zstded", NULL
+  };
+
+  for (gsize i = 0; compressed[i]; i++)
+    {
+      yaml_path = g_strdup_printf ("%s/compression/%s",
+                                   g_getenv ("TEST_DATA_PATH"),
+                                   compressed[i]);
+
+      reader =
+        modulemd_document_reader_new_for_file (yaml_path, TRUE, &error);
+      if (reader == NULL)
+        {
+          /* Only native decompression is supported */
+          g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_NOT_IMPLEMENTED);
+          g_clear_error (&error);
+        }
+      else
+        {
+          output = copy_documents (reader, &n_failures);
+          g_assert_cmpuint (n_failures, ==, 0);
+          assert_same_index (yaml_path, output);
+        }
+
+      g_clear_pointer (&output, g_free);
+      g_clear_pointer (&yaml_path, g_free);
+      g_clear_object (&reader);
+    }
+}
+
+
+static void
+document_reader_test_malformed (void)
+{
+  g_autoptr (ModulemdDocumentReader) reader = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GObject) object = NULL;
+
+  reader = modulemd_document_reader_new_for_string (
+    "---\n"
+    "document: modulemd-defaults\n"
+    "version: 1\n"
+    "data:\n"
+    "  module: foo\n"
+    "  stream: bar\n"
+    "...\n"
+    "---\n"
+    "[ unterminated\n",
+    TRUE);
+
+  object = modulemd_document_reader_next (reader, &error);
+  g_assert_no_error (error);
+  g_assert_true (MODULEMD_IS_DEFAULTS (object));
+  g_assert_cmpstr (
+    modulemd_defaults_get_module_name (MODULEMD_DEFAULTS (object)), ==, "foo");
+  g_clear_object (&object);
+
+  /* A broken YAML stream cannot be resynchronized */
+  object = modulemd_document_reader_next (reader, &error);
+  if (object)
+    {
+      g_assert_true (MODULEMD_IS_SUBDOCUMENT_INFO (object));
+      g_clear_object (&object);
+      object = modulemd_document_reader_next (reader, &error);
+    }
+  g_assert_null (object);
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_PARSE);
+  g_clear_error (&error);
+
+  g_assert_null (modulemd_document_reader_next (reader, &error));
+  g_assert_no_error (error);
+
+  /* Missing files are reported when the reader is created */
+  g_clear_object (&reader);
+  reader = modulemd_document_reader_new_for_file (
+    "/nonexistent/modules.yaml", TRUE, &error);
+  g_assert_null (reader);
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_OPEN);
+}
+
+
+static void
+document_writer_test_errors (void)
+{
+  g_autoptr (ModulemdDocumentWriter) writer = NULL;
+  g_autoptr (ModulemdProfile) profile = NULL;
+  g_autoptr (ModulemdModuleStream) invalid = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  g_autoptr (GError) error = NULL;
+
+  writer = modulemd_document_writer_new_for_string ();
+
+  /* Nothing written yet, so the output is empty */
+  g_assert_null (modulemd_document_writer_get_string (writer));
+
+  /* Only top-level subdocument types can be written */
+  profile = modulemd_profile_new ("default");
+  g_assert_false (
+    modulemd_document_writer_write (writer, G_OBJECT (profile), &error));
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_clear_error (&error);
+
+  /* Invalid objects are rejected without affecting the output */
+  invalid =
+    modulemd_module_stream_new (MD_MODULESTREAM_VERSION_TWO, "foo", "bar");
+  g_assert_false (
+    modulemd_document_writer_write (writer, G_OBJECT (invalid), &error));
+  g_assert_nonnull (error);
+  g_clear_error (&error);
+
+  defaults = modulemd_defaults_new (MD_DEFAULTS_VERSION_ONE, "foo");
+  g_assert_true (
+    modulemd_document_writer_write (writer, G_OBJECT (defaults), &error));
+  g_assert_no_error (error);
+
+  g_assert_true (modulemd_document_writer_close (writer, &error));
+  g_assert_no_error (error);
+  g_assert_true (modulemd_document_writer_close (writer, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (modulemd_document_writer_get_documents_written (writer),
+                    ==,
+                    1);
+  g_assert_cmpstr (modulemd_document_writer_get_string (writer),
+                   ==,
+                   "---\n"
+                   "document: modulemd-defaults\n"
+                   "version: 1\n"
+                   "data:\n"
+                   "  module: foo\n"
+                   "...\n");
+
+  /* Nothing can be written after closing */
+  g_assert_false (
+    modulemd_document_writer_write (writer, G_OBJECT (defaults), &error));
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_EMIT);
+}
+
+
+static void
+document_writer_test_file (void)
+{
+  g_autoptr (ModulemdDocumentWriter) writer = NULL;
+  g_autoptr (ModulemdDocumentReader) reader = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  g_autoptr (GObject) object = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *tmp_dir = NULL;
+  g_autofree gchar *out_path = NULL;
+
+  tmp_dir = g_dir_make_tmp ("modulemd-writer-XXXXXX", &error);
+  g_assert_no_error (error);
+  out_path = g_build_filename (tmp_dir, "out.yaml", NULL);
+
+  writer = modulemd_document_writer_new_for_file (out_path, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (writer);
+
+  defaults = modulemd_defaults_new (MD_DEFAULTS_VERSION_ONE, "foo");
+  g_assert_true (
+    modulemd_document_writer_write (writer, G_OBJECT (defaults), &error));
+  g_assert_no_error (error);
+  g_assert_true (modulemd_document_writer_close (writer, &error));
+  g_assert_no_error (error);
+  g_assert_null (modulemd_document_writer_get_string (writer));
+
+  reader = modulemd_document_reader_new_for_file (out_path, TRUE, &error);
+  g_assert_no_error (error);
+
+  object = modulemd_document_reader_next (reader, &error);
+  g_assert_no_error (error);
+  g_assert_true (MODULEMD_IS_DEFAULTS (object));
+  g_assert_true (
+    modulemd_defaults_equals (defaults, MODULEMD_DEFAULTS (object)));
+  g_clear_object (&object);
+
+  g_assert_null (modulemd_document_reader_next (reader, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpint (g_unlink (out_path), ==, 0);
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+  g_test_bug_base ("https://bugzilla.redhat.com/show_bug.cgi?id=");
+
+  // Define the tests.
+
+  g_test_add_func ("/modulemd/v2/documentreader/read_write",
+                   document_reader_test_read_write);
+  g_test_add_func ("/modulemd/v2/documentreader/failures",
+                   document_reader_test_failures);
+  g_test_add_func ("/modulemd/v2/documentreader/compressed",
+                   document_reader_test_compressed);
+  g_test_add_func ("/modulemd/v2/documentreader/malformed",
+                   document_reader_test_malformed);
+  g_test_add_func ("/modulemd/v2/documentwriter/errors",
+                   document_writer_test_errors);
+  g_test_add_func ("/modulemd/v2/documentwriter/file",
+                   document_writer_test_file);
+
+  return g_test_run ();
+}
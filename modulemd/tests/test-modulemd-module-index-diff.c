@@ -0,0 +1,763 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+#include <locale.h>
+#include <string.h>
+
+#include "modulemd.h"
+#include "private/glib-extensions.h"
+#include "private/modulemd-module-index-private.h"
+#include "private/test-utils.h"
+
+
+static ModulemdModuleIndex *
+load_index (const gchar *filename)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autofree gchar *yaml_path = NULL;
+
+  yaml_path =
+    g_strdup_printf ("%s/%s", g_getenv ("TEST_DATA_PATH"), filename);
+
+  idx = modulemd_module_index_new ();
+  ret = modulemd_module_index_update_from_file (
+    idx, yaml_path, TRUE, &failures, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  return g_steal_pointer (&idx);
+}
+
+
+static void
+assert_diff_counts (ModulemdModuleIndexDiff *diff,
+                    guint added_streams,
+                    guint removed_streams,
+                    guint changed_streams)
+{
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_added_streams (diff)->len,
+    ==,
+    added_streams);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_removed_streams (diff)->len,
+    ==,
+    removed_streams);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_changed_streams (diff)->len,
+    ==,
+    changed_streams);
+}
+
+
+static void
+module_index_diff_test_identical (void)
+{
+  g_autoptr (ModulemdModuleIndex) old_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) new_idx = NULL;
+  g_autoptr (ModulemdModuleIndexDiff) diff = NULL;
+  g_autoptr (GError) error = NULL;
+
+  old_idx = load_index ("f29.yaml");
+  new_idx = load_index ("f29.yaml");
+
+  /* Separately-loaded copies of the same file */
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (diff);
+  g_assert_true (modulemd_module_index_diff_is_empty (diff));
+  assert_diff_counts (diff, 0, 0, 0);
+  g_clear_object (&diff);
+
+  /* An index compared with itself */
+  diff = modulemd_module_index_diff (old_idx, old_idx, &error);
+  g_assert_no_error (error);
+  g_assert_true (modulemd_module_index_diff_is_empty (diff));
+  g_clear_object (&diff);
+
+  /* Two empty indexes */
+  g_clear_object (&old_idx);
+  g_clear_object (&new_idx);
+  old_idx = modulemd_module_index_new ();
+  new_idx = modulemd_module_index_new ();
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+  g_assert_true (modulemd_module_index_diff_is_empty (diff));
+}
+
+
+static void
+add_foo_module (ModulemdModuleIndex *idx)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  g_autoptr (ModulemdObsoletes) obsoletes = NULL;
+  g_autoptr (ModulemdTranslation) translation = NULL;
+  g_autoptr (ModulemdTranslationEntry) entry = NULL;
+  g_autoptr (GError) error = NULL;
+
+  stream =
+    modulemd_module_stream_new (MD_MODULESTREAM_VERSION_TWO, "foo", "a");
+  modulemd_module_stream_set_version (stream, 1);
+  modulemd_module_stream_set_context (stream, "c0ffee42");
+  modulemd_module_stream_set_arch (stream, "x86_64");
+  modulemd_module_stream_v2_set_summary (MODULEMD_MODULE_STREAM_V2 (stream),
+                                         "Summary");
+  modulemd_module_stream_v2_set_description (
+    MODULEMD_MODULE_STREAM_V2 (stream), "Description");
+  modulemd_module_stream_v2_add_module_license (
+    MODULEMD_MODULE_STREAM_V2 (stream), "MIT");
+  ret = modulemd_module_index_add_module_stream (idx, stream, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  defaults = modulemd_defaults_new (MD_DEFAULTS_VERSION_ONE, "foo");
+  modulemd_defaults_v1_set_default_stream (
+    MODULEMD_DEFAULTS_V1 (defaults), "a", NULL);
+  ret = modulemd_module_index_add_defaults (idx, defaults, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  obsoletes = modulemd_obsoletes_new (
+    MD_OBSOLETES_VERSION_ONE, 202001010000, "foo", "a", "Going away");
+  ret = modulemd_module_index_add_obsoletes (idx, obsoletes, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  translation = modulemd_translation_new (1, "foo", "a", 42);
+  entry = modulemd_translation_entry_new ("en_GB");
+  modulemd_translation_entry_set_summary (entry, "Summary");
+  modulemd_translation_set_translation_entry (translation, entry);
+  ret = modulemd_module_index_add_translation (idx, translation, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+}
+
+
+static void
+module_index_diff_test_changes (void)
+{
+  guint n_dwm_streams;
+  g_autoptr (ModulemdModuleIndex) old_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) new_idx = NULL;
+  g_autoptr (ModulemdModuleIndexDiff) diff = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autoptr (GError) error = NULL;
+  ModulemdModuleStream *changed = NULL;
+  GPtrArray *list = NULL;
+
+  old_idx = load_index ("f29.yaml");
+  new_idx = load_index ("f29.yaml");
+
+  /* Removing a module removes its streams and defaults */
+  streams = modulemd_module_index_search_streams (
+    old_idx, "dwm", NULL, NULL, NULL, NULL);
+  n_dwm_streams = streams->len;
+  g_assert_cmpuint (n_dwm_streams, >, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+  g_assert_true (modulemd_module_index_remove_module (new_idx, "dwm"));
+
+  /* A new module with a stream, defaults, obsoletes and a translation */
+  add_foo_module (new_idx);
+
+  /* A modified stream */
+  streams = modulemd_module_index_search_streams (
+    new_idx, "stratis", NULL, NULL, NULL, NULL);
+  g_assert_cmpuint (streams->len, >, 0);
+  changed = g_ptr_array_index (streams, 0);
+  modulemd_module_stream_v2_set_summary (MODULEMD_MODULE_STREAM_V2 (changed),
+                                         "A changed summary");
+
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (diff);
+  g_assert_false (modulemd_module_index_diff_is_empty (diff));
+
+  assert_diff_counts (diff, 1, n_dwm_streams, 1);
+  list = modulemd_module_index_diff_get_added_streams (diff);
+  g_assert_cmpstr (modulemd_module_stream_get_module_name (
+                     g_ptr_array_index (list, 0)),
+                   ==,
+                   "foo");
+  list = modulemd_module_index_diff_get_removed_streams (diff);
+  for (guint i = 0; i < list->len; i++)
+    {
+      g_assert_cmpstr (modulemd_module_stream_get_module_name (
+                         g_ptr_array_index (list, i)),
+                       ==,
+                       "dwm");
+    }
+  list = modulemd_module_index_diff_get_changed_streams (diff);
+  g_assert_true (g_ptr_array_index (list, 0) == (gpointer)changed);
+
+  list = modulemd_module_index_diff_get_added_defaults (diff);
+  g_assert_cmpuint (list->len, ==, 1);
+  g_assert_cmpstr (
+    modulemd_defaults_get_module_name (g_ptr_array_index (list, 0)),
+    ==,
+    "foo");
+  list = modulemd_module_index_diff_get_removed_defaults (diff);
+  g_assert_cmpuint (list->len, ==, 1);
+  g_assert_cmpstr (
+    modulemd_defaults_get_module_name (g_ptr_array_index (list, 0)),
+    ==,
+    "dwm");
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_changed_defaults (diff)->len, ==, 0);
+
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_added_obsoletes (diff)->len, ==, 1);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_removed_obsoletes (diff)->len, ==, 0);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_changed_obsoletes (diff)->len, ==, 0);
+
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_added_translations (diff)->len, ==, 1);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_removed_translations (diff)->len, ==, 0);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_changed_translations (diff)->len, ==, 0);
+  g_clear_object (&diff);
+
+  /* The reverse direction swaps additions and removals */
+  diff = modulemd_module_index_diff (new_idx, old_idx, &error);
+  g_assert_no_error (error);
+  assert_diff_counts (diff, n_dwm_streams, 1, 1);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_removed_defaults (diff)->len, ==, 1);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_removed_obsoletes (diff)->len, ==, 1);
+  g_assert_cmpuint (
+    modulemd_module_index_diff_get_removed_translations (diff)->len, ==, 1);
+}
+
+
+static void
+module_index_diff_test_frozen (void)
+{
+  g_autoptr (ModulemdModuleIndex) old_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) new_idx = NULL;
+  g_autoptr (ModulemdModuleIndexDiff) diff = NULL;
+  g_autoptr (GPtrArray) old_streams = NULL;
+  g_autoptr (GPtrArray) new_streams = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *old_digest = NULL;
+  g_autofree gchar *new_digest = NULL;
+  g_auto (GStrv) component_names = NULL;
+  ModulemdModuleStream *stream = NULL;
+
+  old_idx = load_index ("f29.yaml");
+  new_idx = load_index ("f29.yaml");
+
+  new_streams = modulemd_module_index_search_streams (
+    new_idx, "stratis", NULL, NULL, NULL, NULL);
+  stream = g_ptr_array_index (new_streams, 0);
+
+  /* The digests of the streams of a mutable index are kept until the stream
+   * or one of its objects is modified
+   */
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+  assert_diff_counts (diff, 0, 0, 0);
+  g_clear_object (&diff);
+  new_digest = modulemd_module_index_dup_digest (new_idx, stream);
+  g_assert_nonnull (new_digest);
+  g_clear_pointer (&new_digest, g_free);
+
+  component_names = modulemd_module_stream_v2_get_rpm_component_names_as_strv (
+    MODULEMD_MODULE_STREAM_V2 (stream));
+  g_assert_nonnull (component_names[0]);
+  modulemd_component_set_rationale (
+    MODULEMD_COMPONENT (modulemd_module_stream_v2_get_rpm_component (
+      MODULEMD_MODULE_STREAM_V2 (stream), component_names[0])),
+    "A changed rationale");
+  g_assert_null (modulemd_module_index_dup_digest (new_idx, stream));
+
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+  assert_diff_counts (diff, 0, 0, 1);
+  g_clear_object (&diff);
+  new_digest = modulemd_module_index_dup_digest (new_idx, stream);
+  g_assert_nonnull (new_digest);
+  g_clear_pointer (&new_digest, g_free);
+
+  modulemd_module_stream_v2_set_summary (MODULEMD_MODULE_STREAM_V2 (stream),
+                                         "A changed summary");
+  g_assert_null (modulemd_module_index_dup_digest (new_idx, stream));
+
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+  assert_diff_counts (diff, 0, 0, 1);
+  g_clear_object (&diff);
+
+  modulemd_module_index_freeze (old_idx);
+  modulemd_module_index_freeze (new_idx);
+
+  for (guint i = 0; i < 2; i++)
+    {
+      diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+      g_assert_no_error (error);
+      assert_diff_counts (diff, 0, 0, 1);
+      g_assert_true (
+        g_ptr_array_index (
+          modulemd_module_index_diff_get_changed_streams (diff), 0) ==
+        (gpointer)stream);
+      g_clear_object (&diff);
+    }
+
+  old_streams = modulemd_module_index_search_streams (
+    old_idx,
+    modulemd_module_stream_get_module_name (stream),
+    modulemd_module_stream_get_stream_name (stream),
+    NULL,
+    modulemd_module_stream_get_context (stream),
+    modulemd_module_stream_get_arch (stream));
+  g_assert_cmpuint (old_streams->len, ==, 1);
+
+  old_digest = modulemd_module_index_dup_digest (
+    old_idx, g_ptr_array_index (old_streams, 0));
+  new_digest = modulemd_module_index_dup_digest (new_idx, stream);
+  g_assert_nonnull (old_digest);
+  g_assert_nonnull (new_digest);
+  g_assert_cmpstr (old_digest, !=, new_digest);
+}
+
+
+/* The number of streams in each index of the benchmark mode of
+ * /modulemd/v2/module/index/diff/large. Run it with
+ * "module_index_diff -m perf -p /modulemd/v2/module/index/diff/large".
+ */
+#define DIFF_BENCHMARK_STREAMS 100000
+#define DIFF_BENCHMARK_CHANGES 300
+
+static ModulemdModuleIndex *
+make_large_index (guint n_streams, guint n_changes)
+{
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GError) error = NULL;
+
+  idx = modulemd_module_index_new ();
+
+  for (guint i = 0; i < n_streams; i++)
+    {
+      g_autoptr (ModulemdModuleStream) stream = NULL;
+      g_autoptr (ModulemdComponentRpm) component = NULL;
+      g_autofree gchar *module_name = NULL;
+      g_autofree gchar *stream_name = NULL;
+
+      module_name = g_strdup_printf ("module%u", i / 100);
+      stream_name = g_strdup_printf ("stream%u", i % 100);
+      stream = modulemd_module_stream_new (
+        MD_MODULESTREAM_VERSION_TWO, module_name, stream_name);
+      modulemd_module_stream_set_version (stream, 1);
+      modulemd_module_stream_set_context (stream, "c0ffee42");
+      modulemd_module_stream_set_arch (stream, "x86_64");
+      modulemd_module_stream_v2_set_summary (
+        MODULEMD_MODULE_STREAM_V2 (stream), "Summary");
+      modulemd_module_stream_v2_set_description (
+        MODULEMD_MODULE_STREAM_V2 (stream),
+        i < n_changes ? "Changed description" : "Description");
+      modulemd_module_stream_v2_add_module_license (
+        MODULEMD_MODULE_STREAM_V2 (stream), "MIT");
+      modulemd_module_stream_v2_add_rpm_api (
+        MODULEMD_MODULE_STREAM_V2 (stream), module_name);
+      component = modulemd_component_rpm_new (module_name);
+      modulemd_component_set_rationale (MODULEMD_COMPONENT (component),
+                                        "Provides the API");
+      modulemd_module_stream_v2_add_component (
+        MODULEMD_MODULE_STREAM_V2 (stream), MODULEMD_COMPONENT (component));
+
+      g_assert_true (
+        modulemd_module_index_add_module_stream (idx, stream, &error));
+      g_assert_no_error (error);
+    }
+
+  return g_steal_pointer (&idx);
+}
+
+
+static void
+module_index_diff_test_large (void)
+{
+  guint n_streams = g_test_perf () ? DIFF_BENCHMARK_STREAMS : 2000;
+  g_autoptr (ModulemdModuleIndex) old_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) new_idx = NULL;
+  g_autoptr (ModulemdModuleIndexDiff) diff = NULL;
+  g_autoptr (GError) error = NULL;
+  gdouble elapsed;
+
+  old_idx = make_large_index (n_streams, 0);
+  new_idx = make_large_index (n_streams, DIFF_BENCHMARK_CHANGES);
+
+  /* The first comparison computes every digest */
+  g_test_timer_start ();
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_no_error (error);
+  assert_diff_counts (diff, 0, 0, DIFF_BENCHMARK_CHANGES);
+  g_clear_object (&diff);
+  g_test_message ("First diff of %u streams: %.3f s", n_streams, elapsed);
+
+  /* Later ones only look up the digests of the unmodified streams, whether
+   * or not the indexes are frozen
+   */
+  g_test_timer_start ();
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_no_error (error);
+  assert_diff_counts (diff, 0, 0, DIFF_BENCHMARK_CHANGES);
+  g_clear_object (&diff);
+  g_test_message ("Cached diff of %u mutable streams: %.3f s",
+                  n_streams,
+                  elapsed);
+
+  modulemd_module_index_freeze (old_idx);
+  modulemd_module_index_freeze (new_idx);
+
+  g_test_timer_start ();
+  diff = modulemd_module_index_diff (old_idx, new_idx, &error);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_no_error (error);
+  assert_diff_counts (diff, 0, 0, DIFF_BENCHMARK_CHANGES);
+  g_test_message ("Cached diff of %u frozen streams: %.3f s",
+                  n_streams,
+                  elapsed);
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (
+        elapsed, "Cached diff of %u streams: %.3f s", n_streams, elapsed);
+    }
+}
+
+
+static void
+assert_same_content (ModulemdModuleIndex *a, ModulemdModuleIndex *b)
+{
+  g_autoptr (ModulemdModuleIndexDiff) diff = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *a_digest = NULL;
+  g_autofree gchar *b_digest = NULL;
+
+  diff = modulemd_module_index_diff (a, b, &error);
+  g_assert_no_error (error);
+  g_assert_true (modulemd_module_index_diff_is_empty (diff));
+
+  a_digest = modulemd_module_index_get_digest (a, &error);
+  g_assert_no_error (error);
+  b_digest = modulemd_module_index_get_digest (b, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (a_digest, ==, b_digest);
+}
+
+
+static void
+module_index_delta_test_roundtrip (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) old_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) new_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) target = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *delta = NULL;
+  g_autofree gchar *old_digest = NULL;
+  g_autofree gchar *new_digest = NULL;
+  g_autofree gchar *digest = NULL;
+
+  old_idx = load_index ("f29.yaml");
+  new_idx = load_index ("f29.yaml");
+
+  old_digest = modulemd_module_index_get_digest (old_idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (strlen (old_digest), ==, 64);
+
+  g_assert_true (modulemd_module_index_remove_module (new_idx, "dwm"));
+  add_foo_module (new_idx);
+  streams = modulemd_module_index_search_streams (
+    new_idx, "stratis", NULL, NULL, NULL, NULL);
+  modulemd_module_stream_v2_set_summary (
+    MODULEMD_MODULE_STREAM_V2 (g_ptr_array_index (streams, 0)),
+    "A changed summary");
+
+  new_digest = modulemd_module_index_get_digest (new_idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (old_digest, !=, new_digest);
+
+  delta =
+    modulemd_module_index_dump_delta_to_string (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (delta);
+  g_assert_nonnull (strstr (delta, "document: modulemd-delta"));
+
+  target = load_index ("f29.yaml");
+  ret = modulemd_module_index_apply_delta (target, delta, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_null (modulemd_module_index_get_module (target, "dwm"));
+  g_assert_nonnull (modulemd_module_index_get_module (target, "foo"));
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (target, "foo", NULL), ==, "a");
+  assert_same_content (target, new_idx);
+
+  /* The delta does not apply a second time */
+  ret = modulemd_module_index_apply_delta (target, delta, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_assert_false (ret);
+  g_clear_error (&error);
+  assert_same_content (target, new_idx);
+
+  /* The reverse delta restores the original content */
+  g_clear_pointer (&delta, g_free);
+  delta =
+    modulemd_module_index_dump_delta_to_string (new_idx, old_idx, &error);
+  g_assert_no_error (error);
+  ret = modulemd_module_index_apply_delta (target, delta, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  assert_same_content (target, old_idx);
+
+  /* An empty delta changes nothing */
+  g_clear_pointer (&delta, g_free);
+  delta =
+    modulemd_module_index_dump_delta_to_string (old_idx, old_idx, &error);
+  g_assert_no_error (error);
+  ret = modulemd_module_index_apply_delta (target, delta, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  digest = modulemd_module_index_get_digest (target, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (digest, ==, old_digest);
+}
+
+
+static void
+module_index_delta_test_invalid (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *base = NULL;
+  g_autofree gchar *delta = NULL;
+  g_autofree gchar *digest = NULL;
+  const gchar *zeros =
+    "0000000000000000000000000000000000000000000000000000000000000000";
+
+  idx = load_index ("f29.yaml");
+  base = modulemd_module_index_get_digest (idx, &error);
+  g_assert_no_error (error);
+
+  /* Removing something that is not there */
+  delta = g_strdup_printf (
+    "---\n"
+    "document: modulemd-delta\n"
+    "version: 1\n"
+    "data:\n"
+    "  base: %s\n"
+    "  result: %s\n"
+    "  remove:\n"
+    "    streams:\n"
+    "    - module: nosuch\n"
+    "      stream: x\n"
+    "      version: 1\n"
+    "...\n",
+    base,
+    base);
+  ret = modulemd_module_index_apply_delta (idx, delta, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_assert_false (ret);
+  g_clear_error (&error);
+  g_clear_pointer (&delta, g_free);
+
+  /* A result digest that does not match */
+  delta = g_strdup_printf (
+    "---\n"
+    "document: modulemd-delta\n"
+    "version: 1\n"
+    "data:\n"
+    "  base: %s\n"
+    "  result: %s\n"
+    "...\n",
+    base,
+    zeros);
+  ret = modulemd_module_index_apply_delta (idx, delta, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_assert_false (ret);
+  g_clear_error (&error);
+  g_clear_pointer (&delta, g_free);
+
+  /* Deltas must start with a modulemd-delta document */
+  ret = modulemd_module_index_apply_delta (
+    idx,
+    "---\n"
+    "document: modulemd-defaults\n"
+    "version: 1\n"
+    "data:\n"
+    "  module: foo\n"
+    "...\n",
+    &error);
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_PARSE);
+  g_assert_false (ret);
+  g_clear_error (&error);
+
+  /* Nothing above modified the index */
+  digest = modulemd_module_index_get_digest (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (digest, ==, base);
+
+  /* Delta documents are not loaded into an index */
+  delta = modulemd_module_index_dump_delta_to_string (idx, idx, &error);
+  g_assert_no_error (error);
+  ret = modulemd_module_index_update_from_string (
+    idx, delta, TRUE, &failures, &error);
+  g_assert_false (ret);
+  g_assert_cmpuint (failures->len, ==, 1);
+  g_clear_error (&error);
+
+  /* Frozen indexes cannot be changed */
+  modulemd_module_index_freeze (idx);
+  ret = modulemd_module_index_apply_delta (idx, delta, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FROZEN);
+  g_assert_false (ret);
+}
+
+
+static void
+module_index_delta_test_digest (void)
+{
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *before = NULL;
+  g_autofree gchar *after = NULL;
+  g_autofree gchar *frozen = NULL;
+  g_autofree gchar *delta = NULL;
+
+  idx = load_index ("f29.yaml");
+  before = modulemd_module_index_get_digest (idx, &error);
+  g_assert_no_error (error);
+  delta = modulemd_module_index_dump_delta_to_string (idx, idx, &error);
+  g_assert_no_error (error);
+
+  /* Changes made to a stream retrieved from a mutable index count */
+  streams = modulemd_module_index_search_streams (
+    idx, "stratis", NULL, NULL, NULL, NULL);
+  modulemd_module_stream_v2_set_summary (
+    MODULEMD_MODULE_STREAM_V2 (g_ptr_array_index (streams, 0)),
+    "A changed summary");
+  after = modulemd_module_index_get_digest (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (before, !=, after);
+
+  /* So a delta made for the unchanged index no longer applies */
+  g_assert_false (modulemd_module_index_apply_delta (idx, delta, &error));
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_clear_error (&error);
+
+  /* The digest of a frozen index is computed once */
+  modulemd_module_index_freeze (idx);
+  frozen = modulemd_module_index_get_digest (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (frozen, ==, after);
+  g_clear_pointer (&frozen, g_free);
+  frozen = modulemd_module_index_get_digest (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (frozen, ==, after);
+}
+
+
+static void
+module_index_delta_test_large (void)
+{
+  gboolean ret;
+  guint n_streams = g_test_perf () ? DIFF_BENCHMARK_STREAMS : 2000;
+  g_autoptr (ModulemdModuleIndex) old_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) new_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) target = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *delta = NULL;
+  g_autofree gchar *digest = NULL;
+  gdouble elapsed;
+
+  old_idx = make_large_index (n_streams, 0);
+  new_idx = make_large_index (n_streams, DIFF_BENCHMARK_CHANGES);
+  delta =
+    modulemd_module_index_dump_delta_to_string (old_idx, new_idx, &error);
+  g_assert_no_error (error);
+
+  /* The digest of the base index is computed once, e.g. after loading */
+  target = make_large_index (n_streams, 0);
+  g_test_timer_start ();
+  digest = modulemd_module_index_get_digest (target, &error);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_no_error (error);
+  g_test_message ("Digest of %u streams: %.3f s", n_streams, elapsed);
+
+  g_test_timer_start ();
+  ret = modulemd_module_index_apply_delta (target, delta, &error);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_test_message ("Delta of %u changes applied to %u streams: %.3f s",
+                  DIFF_BENCHMARK_CHANGES,
+                  n_streams,
+                  elapsed);
+
+  assert_same_content (target, new_idx);
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (elapsed,
+                               "Delta applied to %u streams: %.3f s",
+                               n_streams,
+                               elapsed);
+    }
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+  g_test_bug_base ("https://bugzilla.redhat.com/show_bug.cgi?id=");
+
+  // Define the tests.
+
+  g_test_add_func ("/modulemd/v2/module/index/diff/identical",
+                   module_index_diff_test_identical);
+  g_test_add_func ("/modulemd/v2/module/index/diff/changes",
+                   module_index_diff_test_changes);
+  g_test_add_func ("/modulemd/v2/module/index/diff/frozen",
+                   module_index_diff_test_frozen);
+  g_test_add_func ("/modulemd/v2/module/index/diff/large",
+                   module_index_diff_test_large);
+  g_test_add_func ("/modulemd/v2/module/index/delta/roundtrip",
+                   module_index_delta_test_roundtrip);
+  g_test_add_func ("/modulemd/v2/module/index/delta/invalid",
+                   module_index_delta_test_invalid);
+  g_test_add_func ("/modulemd/v2/module/index/delta/digest",
+                   module_index_delta_test_digest);
+  g_test_add_func ("/modulemd/v2/module/index/delta/large",
+                   module_index_delta_test_large);
+
+  return g_test_run ();
+}
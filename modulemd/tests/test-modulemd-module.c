@@ -487,6 +487,57 @@ module_test_get_stream_names (void)
 }
 
 
+static void
+module_test_sorted_streams_modified (void)
+{
+  g_autoptr (ModulemdModule) m = modulemd_module_new ("testmodule");
+  g_autoptr (GError) error = NULL;
+  ModulemdModuleStream *stream = NULL;
+  GPtrArray *sorted = NULL;
+
+  for (guint64 version = 1; version <= 3; version++)
+    {
+      stream = modulemd_module_stream_new (2, "testmodule", "stream1");
+      modulemd_module_stream_set_version (stream, version);
+      modulemd_module_stream_set_context (stream, "context1");
+      modulemd_module_stream_v2_set_summary (
+        MODULEMD_MODULE_STREAM_V2 (stream), "Stream 1");
+      g_assert_cmpint (
+        modulemd_module_add_stream (
+          m, stream, MD_MODULESTREAM_VERSION_TWO, NULL),
+        ==,
+        MD_MODULESTREAM_VERSION_TWO);
+      g_clear_object (&stream);
+    }
+
+  sorted = modulemd_module_get_sorted_streams (m);
+  g_assert_cmpint (sorted->len, ==, 3);
+  g_assert_cmpuint (
+    modulemd_module_stream_get_version (g_ptr_array_index (sorted, 0)), ==, 3);
+
+  /* Changing the version of a stream moves it in the cached order */
+  stream = modulemd_module_get_stream_by_NSVCA (
+    m, "stream1", 1, "context1", NULL, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (stream);
+  modulemd_module_stream_set_version (stream, 4);
+
+  sorted = modulemd_module_get_sorted_streams (m);
+  g_assert_cmpint (sorted->len, ==, 3);
+  g_assert_true (g_ptr_array_index (sorted, 0) == stream);
+  g_assert_cmpuint (
+    modulemd_module_stream_get_version (g_ptr_array_index (sorted, 2)), ==, 2);
+
+  /* So does changing its context */
+  stream = g_ptr_array_index (sorted, 1);
+  modulemd_module_stream_set_version (stream, 4);
+  modulemd_module_stream_set_context (stream, "context0");
+
+  sorted = modulemd_module_get_sorted_streams (m);
+  g_assert_true (g_ptr_array_index (sorted, 0) == stream);
+}
+
+
 static void
 modulemd_test_remove_streams (void)
 {
@@ -840,6 +891,9 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/modulemd/v2/module/streams", module_test_streams);
 
+  g_test_add_func ("/modulemd/v2/module/streams/sorted/modified",
+                   module_test_sorted_streams_modified);
+
   g_test_add_func ("/modulemd/v2/module/streams/remove",
                    modulemd_test_remove_streams);
 
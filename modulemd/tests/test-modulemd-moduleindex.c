@@ -32,7 +32,11 @@
 #include "modulemd-module.h"
 #include "modulemd-subdocument-info.h"
 #include "private/glib-extensions.h"
+#include "private/modulemd-component-private.h"
+#include "private/modulemd-compression-private.h"
 #include "private/modulemd-module-private.h"
+#include "private/modulemd-module-stream-private.h"
+#include "private/modulemd-profile-private.h"
 #include "private/modulemd-subdocument-info-private.h"
 #include "private/modulemd-util.h"
 #include "private/modulemd-yaml.h"
@@ -1006,6 +1010,499 @@ module_index_test_index_upgrade (void)
 }
 
 
+static void
+module_index_test_prescan_mdversion (void)
+{
+  /* Only v1 streams */
+  g_assert_cmpuint (modulemd_yaml_prescan_stream_mdversion_from_string (
+                      "---\n"
+                      "document: modulemd\n"
+                      "version: 1\n"
+                      "data:\n"
+                      "  version: 5\n"
+                      "...\n"),
+                    ==,
+                    MD_MODULESTREAM_VERSION_ONE);
+
+  /* A later v2 stream raises the result */
+  g_assert_cmpuint (modulemd_yaml_prescan_stream_mdversion_from_string (
+                      "---\n"
+                      "document: modulemd\n"
+                      "version: 1\n"
+                      "...\n"
+                      "---\n"
+                      "version: \"2\" # comment\n"
+                      "document: 'modulemd'\n"
+                      "data: {}\n"),
+                    ==,
+                    MD_MODULESTREAM_VERSION_TWO);
+
+  /* Obsoletes require v2 streams */
+  g_assert_cmpuint (modulemd_yaml_prescan_stream_mdversion_from_string (
+                      "---\n"
+                      "document: modulemd-obsoletes\n"
+                      "version: 1\n"
+                      "...\n"),
+                    ==,
+                    MD_MODULESTREAM_VERSION_TWO);
+
+  /* Other documents and packager formats do not count */
+  g_assert_cmpuint (modulemd_yaml_prescan_stream_mdversion_from_string (
+                      "---\n"
+                      "document: modulemd-defaults\n"
+                      "version: 1\n"
+                      "---\n"
+                      "document: modulemd-packager\n"
+                      "version: 3\n"),
+                    ==,
+                    0);
+  g_assert_cmpuint (
+    modulemd_yaml_prescan_stream_mdversion_from_string (""), ==, 0);
+}
+
+
+typedef struct
+{
+  const gchar *data;
+  gsize len;
+  gsize offset;
+  gsize chunk_len;
+} chunked_input;
+
+
+/* Returns at most chunk_len bytes per call and fails at the end of the data
+ * if chunk_len is zero.
+ */
+static int
+chunked_read_fn (void *data,
+                 unsigned char *buffer,
+                 size_t size,
+                 size_t *size_read)
+{
+  chunked_input *input = (chunked_input *)data;
+
+  if (input->chunk_len == 0 && input->offset == input->len)
+    {
+      return 0;
+    }
+
+  *size_read = MIN (MIN (size, MAX (input->chunk_len, 1)),
+                    input->len - input->offset);
+  memcpy (buffer, input->data + input->offset, *size_read);
+  input->offset += *size_read;
+
+  return 1;
+}
+
+
+static void
+module_index_test_prescan_mdversion_read_fn (void)
+{
+  g_autofree gchar *long_line = g_strnfill (300, 'x');
+  g_autofree gchar *v1_yaml = NULL;
+  g_autofree gchar *mixed_yaml = NULL;
+  const gchar *v2_first_yaml = "---\n"
+                               "document: modulemd\n"
+                               "version: 2\n"
+                               "...\n"
+                               "---\n"
+                               "document: modulemd\n"
+                               "version: 1\n"
+                               "...\n";
+  gsize chunk_lens[] = { 1, 3, 127, 128, 129, 4096 };
+  chunked_input input;
+  guint64 mdversion;
+
+  /* Overlong lines, whose remainder must not be mistaken for a new line */
+  v1_yaml = g_strdup_printf ("---\n"
+                             "document: modulemd\n"
+                             "comment: %s version: 2\n"
+                             "version: 1\n"
+                             "...\n",
+                             long_line);
+  mixed_yaml = g_strdup_printf ("%s---\n"
+                                "version: 2\n"
+                                "description: %s\n"
+                                "document: modulemd",
+                                v1_yaml,
+                                long_line);
+
+  /* Lines split across reads are put back together */
+  for (gsize i = 0; i < G_N_ELEMENTS (chunk_lens); i++)
+    {
+      input = (chunked_input){ v1_yaml, strlen (v1_yaml), 0, chunk_lens[i] };
+      g_assert_true (modulemd_yaml_prescan_stream_mdversion_from_read_fn (
+        chunked_read_fn, &input, &mdversion));
+      g_assert_cmpuint (mdversion, ==, MD_MODULESTREAM_VERSION_ONE);
+      g_assert_cmpuint (input.offset, ==, input.len);
+
+      input =
+        (chunked_input){ mixed_yaml, strlen (mixed_yaml), 0, chunk_lens[i] };
+      g_assert_true (modulemd_yaml_prescan_stream_mdversion_from_read_fn (
+        chunked_read_fn, &input, &mdversion));
+      g_assert_cmpuint (mdversion, ==, MD_MODULESTREAM_VERSION_TWO);
+    }
+
+  /* Reading stops once the newest mdversion has been seen */
+  input = (chunked_input){ v2_first_yaml, strlen (v2_first_yaml), 0, 1 };
+  g_assert_true (modulemd_yaml_prescan_stream_mdversion_from_read_fn (
+    chunked_read_fn, &input, &mdversion));
+  g_assert_cmpuint (mdversion, ==, MD_MODULESTREAM_VERSION_TWO);
+  g_assert_cmpuint (input.offset, <, input.len);
+
+  /* A failed read gives no result */
+  input = (chunked_input){ v1_yaml, strlen (v1_yaml), 0, 0 };
+  g_assert_false (modulemd_yaml_prescan_stream_mdversion_from_read_fn (
+    chunked_read_fn, &input, &mdversion));
+  g_assert_cmpuint (mdversion, ==, 0);
+}
+
+
+#define MIXED_STREAM_YAML(mdversion, stream)                                  \
+  "---\n"                                                                     \
+  "document: modulemd\n"                                                      \
+  "version: " mdversion "\n"                                                  \
+  "data:\n"                                                                   \
+  "  name: foo\n"                                                             \
+  "  stream: " stream "\n"                                                    \
+  "  version: 1\n"                                                            \
+  "  context: c0ffee42\n"                                                     \
+  "  summary: A test module\n"                                                \
+  "  description: A test module's description\n"                              \
+  "  license:\n"                                                              \
+  "    module: [MIT]\n"                                                       \
+  "...\n"
+
+
+static void
+module_index_test_read_mixed_upgrade (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  GPtrArray *streams = NULL;
+
+  index = modulemd_module_index_new ();
+
+  ret = modulemd_module_index_update_from_string (
+    index,
+    MIXED_STREAM_YAML ("1", "one") MIXED_STREAM_YAML ("2", "two"),
+    TRUE,
+    &failures,
+    &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_cmpint (failures->len, ==, 0);
+
+  g_assert_cmpint (modulemd_module_index_get_stream_mdversion (index),
+                   ==,
+                   MD_MODULESTREAM_VERSION_TWO);
+
+  streams = modulemd_module_get_all_streams (
+    modulemd_module_index_get_module (index, "foo"));
+  g_assert_cmpint (streams->len, ==, 2);
+  for (guint i = 0; i < streams->len; i++)
+    {
+      g_assert_cmpint (
+        modulemd_module_stream_get_mdversion (g_ptr_array_index (streams, i)),
+        ==,
+        MD_MODULESTREAM_VERSION_TWO);
+    }
+}
+
+
+static void
+module_index_test_read_mixed_compressed (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *file_path = NULL;
+  g_autofree gchar *contents = NULL;
+  gsize length;
+  g_autoptr (GBytes) bytes = NULL;
+  GPtrArray *streams = NULL;
+
+  if (!modulemd_decompressor_supported (
+        MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION))
+    {
+      g_test_skip ("No native gzip decompression");
+      return;
+    }
+
+  /* A v1 stream followed by a v2 stream, as in MIXED_STREAM_YAML */
+  file_path = g_strdup_printf ("%s/compression/mixed-upgrade.yaml.gz",
+                               g_getenv ("TEST_DATA_PATH"));
+  g_assert_true (g_file_get_contents (file_path, &contents, &length, NULL));
+  bytes = g_bytes_new_take (g_steal_pointer (&contents), length);
+
+  for (guint i = 0; i < 2; i++)
+    {
+      index = modulemd_module_index_new ();
+      if (i == 0)
+        {
+          ret = modulemd_module_index_update_from_file (
+            index, file_path, TRUE, &failures, &error);
+        }
+      else
+        {
+          ret = modulemd_module_index_update_from_bytes (
+            index, bytes, TRUE, &failures, &error);
+        }
+      modulemd_subdocument_info_debug_dump_failures (failures);
+      g_assert_no_error (error);
+      g_assert_true (ret);
+      g_assert_cmpint (failures->len, ==, 0);
+
+      g_assert_cmpint (modulemd_module_index_get_stream_mdversion (index),
+                       ==,
+                       MD_MODULESTREAM_VERSION_TWO);
+
+      streams = modulemd_module_get_all_streams (
+        modulemd_module_index_get_module (index, "foo"));
+      g_assert_cmpint (streams->len, ==, 2);
+      for (guint j = 0; j < streams->len; j++)
+        {
+          g_assert_cmpint (modulemd_module_stream_get_mdversion (
+                             g_ptr_array_index (streams, j)),
+                           ==,
+                           MD_MODULESTREAM_VERSION_TWO);
+        }
+
+      g_clear_pointer (&failures, g_ptr_array_unref);
+      g_clear_object (&index);
+    }
+}
+
+
+static void
+module_index_test_read_mixed_failed_upgrade (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  GPtrArray *streams = NULL;
+
+  index = modulemd_module_index_new ();
+
+  /* The v2 document is found by the prescan, but fails to parse */
+  ret = modulemd_module_index_update_from_string (
+    index,
+    MIXED_STREAM_YAML ("1", "one") MIXED_STREAM_YAML ("2", "[two]"),
+    FALSE,
+    &failures,
+    &error);
+  g_assert_no_error (error);
+  g_assert_false (ret);
+  g_assert_cmpint (failures->len, ==, 1);
+
+  /* So the index keeps the version of the streams that were added */
+  g_assert_cmpint (modulemd_module_index_get_stream_mdversion (index),
+                   ==,
+                   MD_MODULESTREAM_VERSION_ONE);
+
+  streams = modulemd_module_get_all_streams (
+    modulemd_module_index_get_module (index, "foo"));
+  g_assert_cmpint (streams->len, ==, 1);
+  g_assert_cmpint (
+    modulemd_module_stream_get_mdversion (g_ptr_array_index (streams, 0)),
+    ==,
+    MD_MODULESTREAM_VERSION_ONE);
+}
+
+
+static void
+module_index_test_parallel_upgrade (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (GError) error = NULL;
+  g_auto (GStrv) module_names = NULL;
+  g_autofree gchar *module_name = NULL;
+  GPtrArray *streams = NULL;
+
+  index = modulemd_module_index_new ();
+
+  /* Enough modules to make the upgrade use worker threads */
+  for (guint i = 0; i < 200; i++)
+    {
+      module_name = g_strdup_printf ("module%u", i);
+      stream = (ModulemdModuleStream *)modulemd_module_stream_v1_new (
+        module_name, "stream");
+      modulemd_module_stream_set_version (stream, i + 1);
+      modulemd_module_stream_set_context (stream, "c0ffee42");
+      modulemd_module_stream_v1_set_summary (
+        MODULEMD_MODULE_STREAM_V1 (stream), "A test stream");
+      modulemd_module_stream_v1_set_description (
+        MODULEMD_MODULE_STREAM_V1 (stream), "A test stream's description");
+      modulemd_module_stream_v1_add_module_license (
+        MODULEMD_MODULE_STREAM_V1 (stream), "MIT");
+      ret = modulemd_module_index_add_module_stream (index, stream, &error);
+      g_assert_no_error (error);
+      g_assert_true (ret);
+      g_clear_object (&stream);
+      g_clear_pointer (&module_name, g_free);
+    }
+
+  /* Every module fails, the first one in sorted order is reported */
+  ret = modulemd_module_index_upgrade_streams (
+    index, MD_MODULESTREAM_VERSION_LATEST + 1, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_UPGRADE);
+  g_assert_false (ret);
+  g_assert_nonnull (strstr (error->message, "module stream module0:"));
+  g_clear_error (&error);
+
+  ret = modulemd_module_index_upgrade_streams (
+    index, MD_MODULESTREAM_VERSION_TWO, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  module_names = modulemd_module_index_get_module_names_as_strv (index);
+  g_assert_cmpint (g_strv_length (module_names), ==, 200);
+  for (guint i = 0; module_names[i]; i++)
+    {
+      streams = modulemd_module_get_all_streams (
+        modulemd_module_index_get_module (index, module_names[i]));
+      g_assert_cmpint (streams->len, ==, 1);
+      g_assert_cmpint (
+        modulemd_module_stream_get_mdversion (g_ptr_array_index (streams, 0)),
+        ==,
+        MD_MODULESTREAM_VERSION_TWO);
+    }
+}
+
+
+static void
+add_dump_test_module (ModulemdModuleIndex *index, guint n)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *module_name = g_strdup_printf ("module%03u", n);
+  const gchar *arches[] = { "x86_64", "aarch64", NULL };
+
+  for (guint i = 0; arches[i]; i++)
+    {
+      stream = modulemd_module_stream_new (
+        MD_MODULESTREAM_VERSION_TWO, module_name, "stable");
+      modulemd_module_stream_set_version (stream, n + 1);
+      modulemd_module_stream_set_context (stream, "c0ffee42");
+      modulemd_module_stream_set_arch (stream, arches[i]);
+      modulemd_module_stream_v2_set_summary (
+        MODULEMD_MODULE_STREAM_V2 (stream), "A test stream");
+      modulemd_module_stream_v2_set_description (
+        MODULEMD_MODULE_STREAM_V2 (stream), "A test stream's description");
+      modulemd_module_stream_v2_add_module_license (
+        MODULEMD_MODULE_STREAM_V2 (stream), "MIT");
+      ret = modulemd_module_index_add_module_stream (index, stream, &error);
+      g_assert_no_error (error);
+      g_assert_true (ret);
+      g_clear_object (&stream);
+    }
+
+  if (n % 2)
+    {
+      defaults = modulemd_defaults_new (MD_DEFAULTS_VERSION_ONE, module_name);
+      modulemd_defaults_v1_set_default_stream (
+        MODULEMD_DEFAULTS_V1 (defaults), "stable", NULL);
+      ret = modulemd_module_index_add_defaults (index, defaults, &error);
+      g_assert_no_error (error);
+      g_assert_true (ret);
+    }
+}
+
+
+static void
+module_index_test_parallel_dump (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (ModulemdModuleIndex) single = NULL;
+  g_autoptr (GString) expected = NULL;
+  g_autofree gchar *yaml_str = NULL;
+  g_autofree gchar *single_str = NULL;
+  g_autoptr (GError) error = NULL;
+
+  /* Enough modules to make the dump use worker threads */
+  index = modulemd_module_index_new ();
+  for (guint n = 0; n < 150; n++)
+    {
+      add_dump_test_module (index, n);
+    }
+
+  yaml_str = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (yaml_str);
+
+  /* Each module dumped on its own is emitted serially. Their concatenation
+   * must be identical to the dump of the whole index.
+   */
+  expected = g_string_new (NULL);
+  for (guint n = 0; n < 150; n++)
+    {
+      single = modulemd_module_index_new ();
+      add_dump_test_module (single, n);
+      single_str = modulemd_module_index_dump_to_string (single, &error);
+      g_assert_no_error (error);
+      g_assert_nonnull (single_str);
+      g_string_append (expected, single_str);
+      g_clear_pointer (&single_str, g_free);
+      g_clear_object (&single);
+    }
+
+  g_assert_cmpstr (yaml_str, ==, expected->str);
+}
+
+
+static void
+module_index_test_parallel_dump_error (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autofree gchar *yaml_str = NULL;
+  g_autoptr (GError) error = NULL;
+  gboolean ret;
+
+  index = modulemd_module_index_new ();
+  for (guint n = 0; n < 150; n++)
+    {
+      add_dump_test_module (index, n);
+    }
+
+  /* A later module fails validation for a different reason */
+  stream = modulemd_module_stream_new (
+    MD_MODULESTREAM_VERSION_TWO, "module130", "broken");
+  modulemd_module_stream_set_version (stream, 1);
+  modulemd_module_stream_set_context (stream, "c0ffee42");
+  modulemd_module_stream_v2_set_summary (MODULEMD_MODULE_STREAM_V2 (stream),
+                                         "A test stream");
+  ret = modulemd_module_index_add_module_stream (index, stream, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_clear_object (&stream);
+
+  stream = modulemd_module_stream_new (
+    MD_MODULESTREAM_VERSION_TWO, "module110", "broken");
+  modulemd_module_stream_set_version (stream, 1);
+  modulemd_module_stream_set_context (stream, "c0ffee42");
+  ret = modulemd_module_index_add_module_stream (index, stream, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_clear_object (&stream);
+
+  /* The error of the first failing module in dump order is reported */
+  yaml_str = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_null (yaml_str);
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_MISSING_REQUIRED);
+  g_assert_true (g_str_has_suffix (error->message, "Summary is missing"));
+}
+
+
 static void
 module_index_test_remove_module (void)
 {
@@ -1363,6 +1860,70 @@ module_index_test_get_default_streams (void)
 }
 
 
+static void
+module_index_test_get_default_stream (void)
+{
+  gboolean ret;
+  g_autofree gchar *yaml_path = NULL;
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+
+  yaml_path =
+    g_strdup_printf ("%s/f29-updates.yaml", g_getenv ("TEST_DATA_PATH"));
+  g_assert_nonnull (yaml_path);
+
+  index = modulemd_module_index_new ();
+  g_assert_nonnull (index);
+
+  ret = modulemd_module_index_update_from_file (
+    index, yaml_path, TRUE, &failures, &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_cmpint (failures->len, ==, 0);
+
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (index, "bat", NULL), ==, "latest");
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (index, "dwm", NULL), ==, "6.1");
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (index, "stratis", NULL), ==, "1");
+  g_assert_null (
+    modulemd_module_index_get_default_stream (index, "nodejs", NULL));
+  g_assert_null (
+    modulemd_module_index_get_default_stream (index, "nosuchmodule", NULL));
+
+  /* An unknown intent falls back to the generic defaults */
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (index, "dwm", "nosuchintent"),
+    ==,
+    "6.1");
+
+  /* Adding new defaults must be reflected in subsequent lookups */
+  defaults = modulemd_defaults_new (MD_DEFAULTS_VERSION_ONE, "nodejs");
+  modulemd_defaults_v1_set_default_stream (
+    MODULEMD_DEFAULTS_V1 (defaults), "12", NULL);
+  ret = modulemd_module_index_add_defaults (index, defaults, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (index, "nodejs", NULL), ==, "12");
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (index, "nodejs", "nosuchintent"),
+    ==,
+    "12");
+
+  /* Removing a module must drop its default stream */
+  g_assert_true (modulemd_module_index_remove_module (index, "dwm"));
+  g_assert_null (modulemd_module_index_get_default_stream (index, "dwm", NULL));
+  g_assert_null (
+    modulemd_module_index_get_default_stream (index, "dwm", "nosuchintent"));
+}
+
+
 static void
 module_index_test_dump_empty_index (void)
 {
@@ -1382,6 +1943,7 @@ module_index_test_dump_empty_index (void)
 struct expected_compressed_read_t
 {
   const gchar *filename;
+  ModulemdCompressionTypeEnum comtype;
 #ifdef HAVE_RPMIO
   /* Determines a compression type */
   const gchar *rpmio_mode;
@@ -1435,57 +1997,40 @@ test_module_index_read_compressed (void)
   g_autofree gchar *compressed_text = NULL;
 
 #ifdef HAVE_RPMIO
-  struct expected_compressed_read_t expected[] = {
-    {
-      .filename = "bzipped",
-      .rpmio_mode = "r.bzdio",
-      .succeeds = TRUE,
-    },
-    {
-      .filename = "bzipped.yaml.bz2",
-      .rpmio_mode = "r.bzdio",
-      .succeeds = TRUE,
-    },
-    { .filename = "gzipped", .rpmio_mode = "r.gzdio", .succeeds = TRUE },
-    { .filename = "gzipped.yaml.gz",
-      .rpmio_mode = "r.gzdio",
-      .succeeds = TRUE },
-    { .filename = "xzipped", .rpmio_mode = "r.xzdio", .succeeds = TRUE },
-    { .filename = "xzipped.yaml.xz",
-      .rpmio_mode = "r.xzdio",
-      .succeeds = TRUE },
-    { .filename = NULL }
-  };
-
+#define EXPECTED_COMPRESSED(_filename, _comtype, _rpmio_mode)                 \
+  {                                                                           \
+    .filename = _filename, .comtype = _comtype, .rpmio_mode = _rpmio_mode     \
+  }
 #else /* HAVE_RPMIO */
+#define EXPECTED_COMPRESSED(_filename, _comtype, _rpmio_mode)                 \
+  {                                                                           \
+    .filename = _filename, .comtype = _comtype                                \
+  }
+#endif /* HAVE_RPMIO */
+
   struct expected_compressed_read_t expected[] = {
-    { .filename = "bzipped",
-      .succeeds = FALSE,
-      .error_domain = MODULEMD_ERROR,
-      .error_code = MMD_ERROR_NOT_IMPLEMENTED },
-    { .filename = "bzipped.yaml.bz2",
-      .succeeds = FALSE,
-      .error_domain = MODULEMD_ERROR,
-      .error_code = MMD_ERROR_NOT_IMPLEMENTED },
-    { .filename = "gzipped",
-      .succeeds = FALSE,
-      .error_domain = MODULEMD_ERROR,
-      .error_code = MMD_ERROR_NOT_IMPLEMENTED },
-    { .filename = "gzipped.yaml.gz",
-      .succeeds = FALSE,
-      .error_domain = MODULEMD_ERROR,
-      .error_code = MMD_ERROR_NOT_IMPLEMENTED },
-    { .filename = "xzipped",
-      .succeeds = FALSE,
-      .error_domain = MODULEMD_ERROR,
-      .error_code = MMD_ERROR_NOT_IMPLEMENTED },
-    { .filename = "xzipped.yaml.xz",
-      .succeeds = FALSE,
-      .error_domain = MODULEMD_ERROR,
-      .error_code = MMD_ERROR_NOT_IMPLEMENTED },
+    EXPECTED_COMPRESSED (
+      "bzipped", MODULEMD_COMPRESSION_TYPE_BZ2_COMPRESSION, "r.bzdio"),
+    EXPECTED_COMPRESSED ("bzipped.yaml.bz2",
+                         MODULEMD_COMPRESSION_TYPE_BZ2_COMPRESSION,
+                         "r.bzdio"),
+    EXPECTED_COMPRESSED (
+      "gzipped", MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION, "r.gzdio"),
+    EXPECTED_COMPRESSED (
+      "gzipped.yaml.gz", MODULEMD_COMPRESSION_TYPE_GZ_COMPRESSION, "r.gzdio"),
+    EXPECTED_COMPRESSED (
+      "xzipped", MODULEMD_COMPRESSION_TYPE_XZ_COMPRESSION, "r.xzdio"),
+    EXPECTED_COMPRESSED (
+      "xzipped.yaml.xz", MODULEMD_COMPRESSION_TYPE_XZ_COMPRESSION, "r.xzdio"),
+    EXPECTED_COMPRESSED (
+      "zstded", MODULEMD_COMPRESSION_TYPE_ZSTD_COMPRESSION, "r.zstdio"),
+    EXPECTED_COMPRESSED ("zstded.yaml.zst",
+                         MODULEMD_COMPRESSION_TYPE_ZSTD_COMPRESSION,
+                         "r.zstdio"),
     { .filename = NULL }
   };
-#endif /* HAVE_RPMIO */
+
+#undef EXPECTED_COMPRESSED
 
   baseline_idx = modulemd_module_index_new ();
   g_assert_nonnull (baseline_idx);
@@ -1517,18 +2062,30 @@ test_module_index_read_compressed (void)
                                    expected[i].filename);
       g_assert_nonnull (file_path);
 
-#ifdef HAVE_RPMIO
-      /* Support for various compression formats in RPMIO is optional. Probe
-       * the support first and set expected success/error accordingly. */
-      if (!rpmio_can_read_compressed_file (file_path, expected[i].rpmio_mode))
+      /* Native decompression backends are preferred. Without one, rpmio is
+       * used if available. */
+      expected[i].succeeds = TRUE;
+      if (!modulemd_decompressor_supported (expected[i].comtype))
         {
-          g_debug ("rpmio library does not support %s compression mode",
-                   expected[i].rpmio_mode);
+#ifdef HAVE_RPMIO
+          /* Support for various compression formats in RPMIO is optional.
+           * Probe the support first and set expected success/error
+           * accordingly. */
+          if (!rpmio_can_read_compressed_file (file_path,
+                                               expected[i].rpmio_mode))
+            {
+              g_debug ("rpmio library does not support %s compression mode",
+                       expected[i].rpmio_mode);
+              expected[i].succeeds = FALSE;
+              expected[i].error_domain = MODULEMD_YAML_ERROR;
+              expected[i].error_code = MMD_YAML_ERROR_UNPARSEABLE;
+            }
+#else /* HAVE_RPMIO */
           expected[i].succeeds = FALSE;
-          expected[i].error_domain = MODULEMD_YAML_ERROR;
-          expected[i].error_code = MMD_YAML_ERROR_UNPARSEABLE;
+          expected[i].error_domain = MODULEMD_ERROR;
+          expected[i].error_code = MMD_ERROR_NOT_IMPLEMENTED;
+#endif /* HAVE_RPMIO */
         }
-#endif
 
       g_debug ("Processing %s, expecting %s",
                file_path,
@@ -1576,407 +2133,2484 @@ test_module_index_read_compressed (void)
 
 
 static void
-test_module_index_read_def_dir (void)
+test_module_index_update_from_bytes (void)
 {
-  gboolean ret;
-  g_autoptr (ModulemdModuleIndex) idx = modulemd_module_index_new ();
+  gboolean bret;
+  g_autoptr (ModulemdModuleIndex) baseline_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autofree gchar *file_path = NULL;
+  g_autofree gchar *contents = NULL;
+  gsize length;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GBytes) truncated = NULL;
   g_autoptr (GError) error = NULL;
-  g_autofree gchar *path =
-    g_build_path ("/", g_getenv ("TEST_DATA_PATH"), "defaults", NULL);
-  g_autofree gchar *bad_path =
-    g_build_path ("/", g_getenv ("TEST_DATA_PATH"), "bad_defaults", NULL);
-  g_autofree gchar *overrides_path =
-    g_build_path ("/", path, "overrides", NULL);
-  g_auto (GStrv) module_names = NULL;
-  g_autoptr (GHashTable) defaultdict = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autofree gchar *baseline_text = NULL;
+  g_autofree gchar *text = NULL;
+  const gchar *compressed[] = {
+    "bzipped", "gzipped", "xzipped", "zstded", NULL
+  };
 
-  g_assert_nonnull (idx);
+  file_path = g_strdup_printf ("%s/compression/uncompressed.yaml",
+                               g_getenv ("TEST_DATA_PATH"));
+  g_assert_true (g_file_get_contents (file_path, &contents, &length, NULL));
 
-  /* First verify that it works without overrides */
-  ret = modulemd_module_index_update_from_defaults_directory (
-    idx, path, TRUE, NULL, &error);
+  baseline_idx = modulemd_module_index_new ();
+  bret = modulemd_module_index_update_from_string (
+    baseline_idx, contents, TRUE, &failures, &error);
   g_assert_no_error (error);
-  g_assert_true (ret);
+  g_assert_true (bret);
+  g_clear_pointer (&failures, g_ptr_array_unref);
 
-  /* There should be three modules in the index now:
-   * - meson
-   * - ninja
-   * - nodejs
-   */
-  module_names = modulemd_module_index_get_module_names_as_strv (idx);
-  g_assert_nonnull (module_names);
+  baseline_text = modulemd_module_index_dump_to_string (baseline_idx, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (baseline_text);
 
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "meson"));
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "ninja"));
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "nodejs"));
+  /* Uncompressed data does not need to be NUL-terminated */
+  contents[length] = 'x';
+  bytes = g_bytes_new_static (contents, length);
+  idx = modulemd_module_index_new ();
+  bret = modulemd_module_index_update_from_bytes (
+    idx, bytes, TRUE, &failures, &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  g_assert_cmpint (failures->len, ==, 0);
 
-  g_assert_cmpint (g_strv_length (module_names), ==, 3);
+  text = modulemd_module_index_dump_to_string (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (baseline_text, ==, text);
 
-  defaultdict =
-    modulemd_module_index_get_default_streams_as_hash_table (idx, NULL);
-  g_assert_nonnull (defaultdict);
+  g_clear_pointer (&text, g_free);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+  g_clear_pointer (&bytes, g_bytes_unref);
+  g_clear_pointer (&contents, g_free);
+  g_clear_pointer (&file_path, g_free);
+  g_clear_object (&idx);
 
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "meson"), ==, "latest");
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "ninja"), ==, "latest");
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "nodejs"), ==, NULL);
+  /* Compressed data is detected by its content */
+  for (gsize i = 0; compressed[i]; i++)
+    {
+      file_path = g_strdup_printf ("%s/compression/%s",
+                                   g_getenv ("TEST_DATA_PATH"),
+                                   compressed[i]);
+      g_assert_true (
+        g_file_get_contents (file_path, &contents, &length, NULL));
+      bytes = g_bytes_new_take (g_steal_pointer (&contents), length);
+
+      idx = modulemd_module_index_new ();
+      bret = modulemd_module_index_update_from_bytes (
+        idx, bytes, TRUE, &failures, &error);
+
+      if (!modulemd_decompressor_supported (
+            modulemd_detect_compression_from_data (
+              g_bytes_get_data (bytes, NULL), length)))
+        {
+          g_debug ("No native decompression support for %s", file_path);
+          g_assert_false (bret);
+          g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_NOT_IMPLEMENTED);
+          g_clear_error (&error);
+        }
+      else
+        {
+          modulemd_subdocument_info_debug_dump_failures (failures);
+          g_assert_no_error (error);
+          g_assert_true (bret);
+          g_assert_cmpint (failures->len, ==, 0);
 
-  g_clear_pointer (&module_names, g_strfreev);
-  g_clear_pointer (&defaultdict, g_hash_table_unref);
+          text = modulemd_module_index_dump_to_string (idx, &error);
+          g_assert_no_error (error);
+          g_assert_cmpstr (baseline_text, ==, text);
+          g_clear_pointer (&text, g_free);
+          g_clear_object (&idx);
+
+          /* Truncated data fails with a decompression error */
+          truncated = g_bytes_new_from_bytes (bytes, 0, length / 2);
+          idx = modulemd_module_index_new ();
+          bret = modulemd_module_index_update_from_bytes (
+            idx, truncated, TRUE, &failures, &error);
+          g_assert_false (bret);
+          g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FILE_ACCESS);
+          g_clear_error (&error);
+          g_clear_pointer (&truncated, g_bytes_unref);
+        }
 
+      g_clear_pointer (&failures, g_ptr_array_unref);
+      g_clear_pointer (&bytes, g_bytes_unref);
+      g_clear_pointer (&file_path, g_free);
+      g_clear_object (&idx);
+    }
+}
 
-  /* Verify with overrides */
-  ret = modulemd_module_index_update_from_defaults_directory (
-    idx, path, TRUE, overrides_path, &error);
-  g_assert_no_error (error);
-  g_assert_true (ret);
 
-  /* There should be four modules in the index now:
-   * - meson
-   * - ninja
-   * - nodejs
-   * - testmodule
-   */
-  module_names = modulemd_module_index_get_module_names_as_strv (idx);
-  g_assert_nonnull (module_names);
+typedef struct
+{
+  GMainLoop *loop;
+  GAsyncResult *result;
+  guint64 bytes;
+  guint64 documents;
+  guint n_reports;
+} async_test_data;
 
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "meson"));
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "ninja"));
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "nodejs"));
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "testmodule"));
 
-  g_assert_cmpint (g_strv_length (module_names), ==, 4);
+static void
+async_test_ready_cb (GObject *UNUSED (source_object),
+                     GAsyncResult *result,
+                     gpointer user_data)
+{
+  async_test_data *data = (async_test_data *)user_data;
 
-  defaultdict =
-    modulemd_module_index_get_default_streams_as_hash_table (idx, NULL);
-  g_assert_nonnull (defaultdict);
+  data->result = g_object_ref (result);
+  g_main_loop_quit (data->loop);
+}
 
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "meson"), ==, "latest");
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "ninja"), ==, "latest");
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "nodejs"), ==, "12");
-  g_assert_cmpstr (
-    g_hash_table_lookup (defaultdict, "testmodule"), ==, "teststream");
 
-  g_clear_pointer (&module_names, g_strfreev);
-  g_clear_pointer (&defaultdict, g_hash_table_unref);
+static void
+async_test_progress_cb (guint64 bytes, guint64 documents, gpointer user_data)
+{
+  async_test_data *data = (async_test_data *)user_data;
 
+  /* Progress never goes backwards and never arrives after completion */
+  g_assert_null (data->result);
+  g_assert_cmpuint (bytes, >=, data->bytes);
+  g_assert_cmpuint (documents, >=, data->documents);
 
-  /* Nonexistent defaults dir */
-  g_assert_false (modulemd_module_index_update_from_defaults_directory (
-    idx, "nonexistent", TRUE, NULL, &error));
-  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
-  g_clear_error (&error);
+  data->bytes = bytes;
+  data->documents = documents;
+  data->n_reports++;
+}
 
-  /* Nonexistent overrides dir */
-  g_assert_false (modulemd_module_index_update_from_defaults_directory (
-    idx, path, TRUE, "nonexistent", &error));
-  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
-  g_clear_error (&error);
 
+static void
+test_module_index_update_from_file_async (void)
+{
+  gboolean bret;
+  g_autoptr (ModulemdModuleIndex) baseline_idx = NULL;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GCancellable) cancellable = NULL;
+  g_autoptr (GMainLoop) loop = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) baseline_failures = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autofree gchar *yaml_path = NULL;
+  g_autofree gchar *contents = NULL;
+  g_autofree gchar *baseline_text = NULL;
+  g_autofree gchar *text = NULL;
+  g_auto (GStrv) module_names = NULL;
+  gsize length;
+  async_test_data data = { NULL, NULL, 0, 0, 0 };
 
-  g_clear_object (&idx);
-  idx = modulemd_module_index_new ();
-  g_assert_nonnull (idx);
+  yaml_path =
+    g_strdup_printf ("%s/f29-updates.yaml", g_getenv ("TEST_DATA_PATH"));
+  g_assert_true (g_file_get_contents (yaml_path, &contents, &length, NULL));
 
-  /* Base directory contains two defaults with conflicting streams for the
-   * same module in separate files. Strict mode.
-   */
-  g_assert_false (modulemd_module_index_update_from_defaults_directory (
-    idx, bad_path, TRUE, NULL, &error));
-  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
-  g_clear_error (&error);
+  baseline_idx = modulemd_module_index_new ();
+  bret = modulemd_module_index_update_from_file (
+    baseline_idx, yaml_path, TRUE, &baseline_failures, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  baseline_text = modulemd_module_index_dump_to_string (baseline_idx, &error);
+  g_assert_no_error (error);
 
-  /* Verify that the index has not been modified as a side-effect */
-  module_names = modulemd_module_index_get_module_names_as_strv (idx);
-  g_assert_cmpint (g_strv_length (module_names), ==, 0);
+  loop = g_main_loop_new (NULL, FALSE);
+  data.loop = loop;
 
-  g_clear_pointer (&module_names, g_strfreev);
-  g_clear_object (&idx);
   idx = modulemd_module_index_new ();
-  g_assert_nonnull (idx);
-
-  /* Base directory contains two defaults with conflicting streams for the
-   * same module in separate files. Non-strict mode.
-   */
-  ret = modulemd_module_index_update_from_defaults_directory (
-    idx, bad_path, FALSE, NULL, &error);
+  modulemd_module_index_update_from_file_async (idx,
+                                                yaml_path,
+                                                TRUE,
+                                                G_PRIORITY_DEFAULT,
+                                                NULL,
+                                                async_test_progress_cb,
+                                                &data,
+                                                NULL,
+                                                async_test_ready_cb,
+                                                &data);
+  g_main_loop_run (loop);
+
+  bret = modulemd_module_index_update_from_file_finish (
+    idx, data.result, &failures, &error);
   g_assert_no_error (error);
-  g_assert_true (ret);
+  g_assert_true (bret);
+  g_assert_nonnull (failures);
+  g_assert_cmpuint (failures->len, ==, baseline_failures->len);
 
+  /* The last report covers the whole file */
+  g_assert_cmpuint (data.n_reports, >, 0);
+  g_assert_cmpuint (data.documents, ==, 65);
+  g_assert_cmpuint (data.bytes, ==, length);
 
-  /* There should be three modules in the index now:
-   * - meson
-   * - ninja
-   * - nodejs
-   */
-  module_names = modulemd_module_index_get_module_names_as_strv (idx);
-  g_assert_nonnull (module_names);
+  text = modulemd_module_index_dump_to_string (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (baseline_text, ==, text);
 
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "meson"));
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "ninja"));
-  g_assert_true (
-    g_strv_contains ((const gchar *const *)module_names, "nodejs"));
+  g_clear_object (&data.result);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+  g_clear_object (&idx);
 
-  g_assert_cmpint (g_strv_length (module_names), ==, 3);
+  /* A cancelled load stops at the first subdocument boundary */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  data.bytes = data.documents = 0;
+  data.n_reports = 0;
 
-  defaultdict =
-    modulemd_module_index_get_default_streams_as_hash_table (idx, NULL);
-  g_assert_nonnull (defaultdict);
+  idx = modulemd_module_index_new ();
+  modulemd_module_index_update_from_file_async (idx,
+                                                yaml_path,
+                                                TRUE,
+                                                G_PRIORITY_DEFAULT,
+                                                cancellable,
+                                                async_test_progress_cb,
+                                                &data,
+                                                NULL,
+                                                async_test_ready_cb,
+                                                &data);
+  g_main_loop_run (loop);
+
+  bret = modulemd_module_index_update_from_file_finish (
+    idx, data.result, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_false (bret);
+  g_assert_cmpuint (data.documents, ==, 1);
+  g_clear_error (&error);
+  g_clear_object (&data.result);
 
-  /* Make sure that in non-strict mode, meson's default is reset to NULL */
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "meson"), ==, NULL);
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "ninja"), ==, "latest");
-  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "nodejs"), ==, NULL);
+  /* The subdocument read before the cancellation is not added */
+  module_names = modulemd_module_index_get_module_names_as_strv (idx);
+  g_assert_cmpuint (g_strv_length (module_names), ==, 0);
 
-  g_clear_pointer (&module_names, g_strfreev);
-  g_clear_pointer (&defaultdict, g_hash_table_unref);
+  /* A missing file is reported through the callback as well */
+  g_clear_pointer (&yaml_path, g_free);
+  yaml_path =
+    g_strdup_printf ("%s/nothinghere.yaml", g_getenv ("TEST_DATA_PATH"));
+  modulemd_module_index_update_from_file_async (idx,
+                                                yaml_path,
+                                                TRUE,
+                                                G_PRIORITY_DEFAULT,
+                                                NULL,
+                                                NULL,
+                                                NULL,
+                                                NULL,
+                                                async_test_ready_cb,
+                                                &data);
+  g_main_loop_run (loop);
+
+  bret = modulemd_module_index_update_from_file_finish (
+    idx, data.result, &failures, &error);
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_OPEN);
+  g_assert_false (bret);
+  g_assert_nonnull (failures);
+  g_assert_cmpuint (failures->len, ==, 0);
+  g_clear_object (&data.result);
 }
 
 
 static void
-test_modulemd_index_search_streams (void)
+test_module_index_dump_to_file_async (void)
 {
-  gboolean ret;
-  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  gboolean bret;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GCancellable) cancellable = NULL;
+  g_autoptr (GMainLoop) loop = NULL;
   g_autoptr (GError) error = NULL;
   g_autoptr (GPtrArray) failures = NULL;
-  g_autoptr (GPtrArray) streams = NULL;
+  g_autoptr (GDir) dir = NULL;
   g_autofree gchar *yaml_path = NULL;
+  g_autofree gchar *tmp_dir = NULL;
+  g_autofree gchar *out_path = NULL;
+  g_autofree gchar *expected = NULL;
+  g_autofree gchar *contents = NULL;
+  GStatBuf statbuf;
+  gsize length;
+  async_test_data data = { NULL, NULL, 0, 0, 0 };
 
-  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
-                               g_getenv ("TEST_DATA_PATH"));
+  yaml_path =
+    g_strdup_printf ("%s/f29-updates.yaml", g_getenv ("TEST_DATA_PATH"));
+  idx = modulemd_module_index_new ();
+  bret = modulemd_module_index_update_from_file (
+    idx, yaml_path, TRUE, &failures, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  expected = modulemd_module_index_dump_to_string (idx, &error);
+  g_assert_no_error (error);
 
-  ret = modulemd_module_index_update_from_file (
-    index, yaml_path, TRUE, &failures, &error);
-  modulemd_subdocument_info_debug_dump_failures (failures);
+  tmp_dir = g_dir_make_tmp ("modulemd-dump-XXXXXX", &error);
   g_assert_no_error (error);
-  g_assert_true (ret);
-  g_assert_cmpint (failures->len, ==, 0);
-  g_clear_pointer (&failures, g_ptr_array_unref);
+  out_path = g_build_filename (tmp_dir, "index.yaml", NULL);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  data.loop = loop;
+
+  modulemd_module_index_dump_to_file_async (idx,
+                                            out_path,
+                                            G_PRIORITY_DEFAULT,
+                                            NULL,
+                                            async_test_progress_cb,
+                                            &data,
+                                            NULL,
+                                            async_test_ready_cb,
+                                            &data);
+  g_main_loop_run (loop);
+
+  bret =
+    modulemd_module_index_dump_to_file_finish (idx, data.result, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  g_clear_object (&data.result);
+
+  g_assert_true (g_file_get_contents (out_path, &contents, &length, NULL));
+  g_assert_cmpstr (expected, ==, contents);
+  g_assert_cmpuint (data.bytes, ==, length);
+  g_assert_cmpuint (data.documents, >, 0);
+
+  /* Replacing the file keeps its permissions */
+  g_assert_cmpint (g_chmod (out_path, 0640), ==, 0);
+  data.bytes = data.documents = 0;
+  data.n_reports = 0;
+
+  modulemd_module_index_dump_to_file_async (idx,
+                                            out_path,
+                                            G_PRIORITY_DEFAULT,
+                                            NULL,
+                                            async_test_progress_cb,
+                                            &data,
+                                            NULL,
+                                            async_test_ready_cb,
+                                            &data);
+  g_main_loop_run (loop);
+
+  bret =
+    modulemd_module_index_dump_to_file_finish (idx, data.result, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  g_clear_object (&data.result);
+
+  g_assert_cmpint (g_stat (out_path, &statbuf), ==, 0);
+  g_assert_cmpint (statbuf.st_mode & 0777, ==, 0640);
+  g_assert_cmpint (g_unlink (out_path), ==, 0);
+
+  /* A cancelled dump leaves nothing behind */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  data.bytes = data.documents = 0;
+  data.n_reports = 0;
+
+  modulemd_module_index_dump_to_file_async (idx,
+                                            out_path,
+                                            G_PRIORITY_DEFAULT,
+                                            cancellable,
+                                            async_test_progress_cb,
+                                            &data,
+                                            NULL,
+                                            async_test_ready_cb,
+                                            &data);
+  g_main_loop_run (loop);
+
+  bret =
+    modulemd_module_index_dump_to_file_finish (idx, data.result, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_false (bret);
+  g_clear_error (&error);
+  g_clear_object (&data.result);
 
-  streams = modulemd_module_index_search_streams (
-    index, "nodejs", NULL, NULL, NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 3);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  dir = g_dir_open (tmp_dir, 0, &error);
+  g_assert_no_error (error);
+  g_assert_null (g_dir_read_name (dir));
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+}
 
-  streams = modulemd_module_index_search_streams (
-    index, "nonexistent", NULL, NULL, NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 0);
-  g_clear_pointer (&streams, g_ptr_array_unref);
 
-  streams =
-    modulemd_module_index_search_streams (index, NULL, NULL, NULL, NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 5);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+static ModulemdModuleIndex *
+load_freeze_test_index (void)
+{
+  gboolean bret;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autofree gchar *yaml_path = NULL;
 
-  streams =
-    modulemd_module_index_search_streams (index, NULL, "8", NULL, NULL, NULL);
+  idx = modulemd_module_index_new ();
+
+  yaml_path =
+    g_strdup_printf ("%s/f29-updates.yaml", g_getenv ("TEST_DATA_PATH"));
+  bret = modulemd_module_index_update_from_file (
+    idx, yaml_path, TRUE, &failures, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+  g_clear_pointer (&yaml_path, g_free);
+
+  /* Adds defaults with a system intent */
+  yaml_path =
+    g_strdup_printf ("%s/merging-base.yaml", g_getenv ("TEST_DATA_PATH"));
+  bret = modulemd_module_index_update_from_file (
+    idx, yaml_path, TRUE, &failures, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+
+  return g_steal_pointer (&idx);
+}
+
+
+static void
+test_module_index_freeze (void)
+{
+  gboolean bret;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (ModulemdModuleIndex) merged = NULL;
+  g_autoptr (ModulemdModuleIndexMerger) merger = NULL;
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (ModulemdDefaults) defaults = NULL;
+  g_autoptr (GHashTable) default_streams = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autofree gchar *yaml_path = NULL;
+  g_autofree gchar *expected = NULL;
+  g_autofree gchar *yaml = NULL;
+
+  idx = load_freeze_test_index ();
+  expected = modulemd_module_index_dump_to_string (idx, &error);
+  g_assert_no_error (error);
+
+  g_assert_false (modulemd_module_index_is_frozen (idx));
+  modulemd_module_index_freeze (idx);
+  g_assert_true (modulemd_module_index_is_frozen (idx));
+
+  /* Freezing again does nothing */
+  modulemd_module_index_freeze (idx);
+  g_assert_true (modulemd_module_index_is_frozen (idx));
+
+  /* Queries return the same results as before */
+  yaml = modulemd_module_index_dump_to_string (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (expected, ==, yaml);
+  g_clear_pointer (&yaml, g_free);
+
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (idx, "dwm", NULL), ==, "6.1");
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (idx, "httpd", NULL), ==, "2.2");
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (idx, "httpd", "workstation"),
+    ==,
+    "2.4");
+  g_assert_cmpstr (
+    modulemd_module_index_get_default_stream (idx, "httpd", "nosuchintent"),
+    ==,
+    "2.2");
+  g_assert_null (modulemd_module_index_get_default_stream (
+    idx, "nosuchmodule", "nosuchintent"));
+
+  default_streams =
+    modulemd_module_index_get_default_streams_as_hash_table (idx, "nointent");
+  g_assert_cmpstr (g_hash_table_lookup (default_streams, "httpd"), ==, "2.2");
+  g_assert_cmpstr (g_hash_table_lookup (default_streams, "dwm"), ==, "6.1");
+
+  /* Every modification fails */
+  stream = MODULEMD_MODULE_STREAM (modulemd_module_stream_v2_new ("foo", "a"));
+  bret = modulemd_module_index_add_module_stream (idx, stream, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FROZEN);
+  g_assert_false (bret);
+  g_clear_error (&error);
+
+  defaults = modulemd_defaults_new (MD_DEFAULTS_VERSION_ONE, "foo");
+  bret = modulemd_module_index_add_defaults (idx, defaults, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FROZEN);
+  g_assert_false (bret);
+  g_clear_error (&error);
+
+  bret = modulemd_module_index_upgrade_streams (
+    idx, MD_MODULESTREAM_VERSION_LATEST, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FROZEN);
+  g_assert_false (bret);
+  g_clear_error (&error);
+
+  yaml_path =
+    g_strdup_printf ("%s/f29-updates.yaml", g_getenv ("TEST_DATA_PATH"));
+  bret = modulemd_module_index_update_from_file (
+    idx, yaml_path, TRUE, &failures, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FROZEN);
+  g_assert_false (bret);
+  g_assert_cmpint (failures->len, ==, 0);
+  g_clear_error (&error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+
+  g_assert_true (g_file_get_contents (yaml_path, &yaml, NULL, NULL));
+  bret = modulemd_module_index_update_from_string (
+    idx, yaml, TRUE, &failures, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_FROZEN);
+  g_assert_false (bret);
+  g_clear_error (&error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+  g_clear_pointer (&yaml, g_free);
+
+  g_test_expect_message (
+    G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*!self->frozen*");
+  g_assert_false (modulemd_module_index_remove_module (idx, "dwm"));
+  g_test_assert_expected_messages ();
+
+  g_test_expect_message (
+    G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*!self->frozen*");
+  modulemd_module_clear_xmds (modulemd_module_index_get_module (idx, "dwm"));
+  g_test_assert_expected_messages ();
+
+  yaml = modulemd_module_index_dump_to_string (idx, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (expected, ==, yaml);
+  g_clear_pointer (&yaml, g_free);
+
+  /* A frozen index can be merged into a new, mutable one */
+  merger = modulemd_module_index_merger_new ();
+  modulemd_module_index_merger_associate_index (merger, idx, 0);
+  merged = modulemd_module_index_merger_resolve (merger, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (merged);
+  g_assert_false (modulemd_module_index_is_frozen (merged));
+
+  bret = modulemd_module_index_add_module_stream (merged, stream, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  g_assert_true (modulemd_module_index_remove_module (merged, "dwm"));
+  g_assert_nonnull (modulemd_module_index_get_module (idx, "dwm"));
+}
+
+
+static void
+test_module_index_freeze_objects (void)
+{
+  gboolean bret;
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (ModulemdModuleStreamV2) new_stream = NULL;
+  g_autoptr (ModulemdComponentRpm) new_component = NULL;
+  g_autoptr (ModulemdProfile) new_profile = NULL;
+  g_autoptr (ModulemdDependencies) new_deps = NULL;
+  g_autoptr (ModulemdDefaultsV1) new_defaults = NULL;
+  g_autoptr (ModulemdTranslation) new_translation = NULL;
+  g_autoptr (ModulemdTranslationEntry) new_entry = NULL;
+  g_autoptr (ModulemdObsoletes) new_obsoletes = NULL;
+  g_autoptr (ModulemdModuleStream) copy = NULL;
+  g_auto (GStrv) list = NULL;
+  g_autoptr (GError) error = NULL;
+  ModulemdModule *module = NULL;
+  ModulemdModuleStreamV2 *stream = NULL;
+  ModulemdComponent *component = NULL;
+  ModulemdProfile *profile = NULL;
+  ModulemdDependencies *deps = NULL;
+  ModulemdDefaultsV1 *defaults = NULL;
+  ModulemdTranslationEntry *entry = NULL;
+  ModulemdObsoletes *obsoletes = NULL;
+
+  new_stream = modulemd_module_stream_v2_new ("foo", "a");
+  modulemd_module_stream_set_version (MODULEMD_MODULE_STREAM (new_stream), 1);
+  modulemd_module_stream_set_context (MODULEMD_MODULE_STREAM (new_stream),
+                                      "c0ffee42");
+  modulemd_module_stream_v2_set_summary (new_stream, "Summary");
+  new_component = modulemd_component_rpm_new ("bar");
+  modulemd_component_set_rationale (MODULEMD_COMPONENT (new_component),
+                                    "Rationale");
+  modulemd_module_stream_v2_add_component (
+    new_stream, MODULEMD_COMPONENT (new_component));
+  new_profile = modulemd_profile_new ("default");
+  modulemd_profile_add_rpm (new_profile, "bar");
+  modulemd_module_stream_v2_add_profile (new_stream, new_profile);
+  new_deps = modulemd_dependencies_new ();
+  modulemd_dependencies_add_runtime_stream (new_deps, "platform", "f33");
+  modulemd_module_stream_v2_add_dependencies (new_stream, new_deps);
+
+  new_defaults = modulemd_defaults_v1_new ("foo");
+  modulemd_defaults_v1_set_default_stream (new_defaults, "a", NULL);
+
+  new_translation = modulemd_translation_new (1, "foo", "a", 42);
+  new_entry = modulemd_translation_entry_new ("fr_FR");
+  modulemd_translation_entry_set_summary (new_entry, "Résumé");
+  modulemd_translation_set_translation_entry (new_translation, new_entry);
+
+  new_obsoletes = modulemd_obsoletes_new (1, 2, "foo", "a", "Message");
+
+  idx = modulemd_module_index_new ();
+  bret = modulemd_module_index_add_module_stream (
+    idx, MODULEMD_MODULE_STREAM (new_stream), &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  bret = modulemd_module_index_add_defaults (
+    idx, MODULEMD_DEFAULTS (new_defaults), &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  bret = modulemd_module_index_add_translation (idx, new_translation, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+  bret = modulemd_module_index_add_obsoletes (idx, new_obsoletes, &error);
+  g_assert_no_error (error);
+  g_assert_true (bret);
+
+  modulemd_module_index_freeze (idx);
+
+  module = modulemd_module_index_get_module (idx, "foo");
+  g_assert_nonnull (module);
+  stream = MODULEMD_MODULE_STREAM_V2 (
+    g_ptr_array_index (modulemd_module_get_all_streams (module), 0));
+  component = MODULEMD_COMPONENT (
+    modulemd_module_stream_v2_get_rpm_component (stream, "bar"));
+  profile = modulemd_module_stream_v2_get_profile (stream, "default");
+  deps =
+    g_ptr_array_index (modulemd_module_stream_v2_get_dependencies (stream), 0);
+  defaults = MODULEMD_DEFAULTS_V1 (modulemd_module_get_defaults (module));
+  entry = modulemd_translation_get_translation_entry (
+    modulemd_module_get_translation (module, "a"), "fr_FR");
+  obsoletes = g_ptr_array_index (modulemd_module_get_obsoletes (module), 0);
+
+  /* The objects held by a frozen index refuse every modification */
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_module_stream_v2_set_summary (stream, "Changed");
+  g_test_assert_expected_messages ();
+  g_assert_cmpstr (
+    modulemd_module_stream_v2_get_summary (stream, "C"), ==, "Summary");
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_module_stream_v2_add_rpm_api (stream, "baz");
+  g_test_assert_expected_messages ();
+  list = modulemd_module_stream_v2_get_rpm_api_as_strv (stream);
+  g_assert_cmpint (g_strv_length (list), ==, 0);
+  g_clear_pointer (&list, g_strfreev);
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_component_set_rationale (component, "Changed");
+  g_test_assert_expected_messages ();
+  g_assert_cmpstr (modulemd_component_get_rationale (component), ==,
+                   "Rationale");
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_profile_add_rpm (profile, "baz");
+  g_test_assert_expected_messages ();
+  list = modulemd_profile_get_rpms_as_strv (profile);
+  g_assert_cmpint (g_strv_length (list), ==, 1);
+  g_clear_pointer (&list, g_strfreev);
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_dependencies_add_runtime_stream (deps, "platform", "f34");
+  g_test_assert_expected_messages ();
+  list = modulemd_dependencies_get_runtime_streams_as_strv (deps, "platform");
+  g_assert_cmpint (g_strv_length (list), ==, 1);
+  g_clear_pointer (&list, g_strfreev);
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_defaults_v1_set_default_stream (defaults, "b", NULL);
+  g_test_assert_expected_messages ();
+  g_assert_cmpstr (
+    modulemd_defaults_v1_get_default_stream (defaults, NULL), ==, "a");
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_translation_entry_set_summary (entry, "Changé");
+  g_test_assert_expected_messages ();
+  g_assert_cmpstr (
+    modulemd_translation_entry_get_summary (entry), ==, "Résumé");
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*frozen*");
+  modulemd_obsoletes_set_obsoleted_by (obsoletes, "foo", "b");
+  g_test_assert_expected_messages ();
+  g_assert_null (
+    modulemd_obsoletes_get_obsoleted_by_module_stream (obsoletes));
+
+  /* Copies are not frozen */
+  copy = modulemd_module_stream_copy (MODULEMD_MODULE_STREAM (stream), NULL,
+                                      NULL);
+  modulemd_module_stream_v2_set_summary (MODULEMD_MODULE_STREAM_V2 (copy),
+                                         "Changed");
+  g_assert_cmpstr (modulemd_module_stream_v2_get_summary (
+                     MODULEMD_MODULE_STREAM_V2 (copy), "C"),
+                   ==,
+                   "Changed");
+  g_assert_cmpstr (
+    modulemd_module_stream_v2_get_summary (stream, "C"), ==, "Summary");
+}
+
+
+/* The number of threads that the benchmark mode of
+ * /modulemd/v2/module/index/freeze/concurrent scales up to. Run it with
+ * "test_moduleindex -m perf -p /modulemd/v2/module/index/freeze/concurrent".
+ */
+#define FREEZE_BENCHMARK_MAX_THREADS 32
+
+typedef struct
+{
+  ModulemdModuleIndex *idx;
+  guint iterations;
+  guint n_modules;
+  guint n_streams;
+  guint n_nodejs_streams;
+  gboolean failed;
+} frozen_query_data;
+
+
+static gpointer
+frozen_query_thread (gpointer user_data)
+{
+  frozen_query_data *data = (frozen_query_data *)user_data;
+
+  for (guint i = 0; i < data->iterations; i++)
+    {
+      g_auto (GStrv) names = NULL;
+      g_autoptr (GPtrArray) streams = NULL;
+      g_autoptr (GPtrArray) nodejs_streams = NULL;
+
+      names = modulemd_module_index_get_module_names_as_strv (data->idx);
+      streams =
+        modulemd_module_index_search_streams_by_nsvca_glob (data->idx, NULL);
+      nodejs_streams = modulemd_module_index_search_streams (
+        data->idx, "nodejs", NULL, NULL, NULL, NULL);
+
+      if (g_strv_length (names) != data->n_modules ||
+          streams->len != data->n_streams ||
+          nodejs_streams->len != data->n_nodejs_streams ||
+          g_strcmp0 (modulemd_module_index_get_default_stream (
+                       data->idx, "httpd", "workstation"),
+                     "2.4") != 0 ||
+          g_strcmp0 (
+            modulemd_module_index_get_default_stream (data->idx, "dwm", NULL),
+            "6.1") != 0)
+        {
+          data->failed = TRUE;
+        }
+    }
+
+  return NULL;
+}
+
+
+/*
+ * run_frozen_queries:
+ *
+ * Runs the queries of frozen_query_thread() from @n_threads threads at once.
+ *
+ * Returns: The number of queries per second.
+ */
+static gdouble
+run_frozen_queries (frozen_query_data *base,
+                    guint n_threads,
+                    guint iterations)
+{
+  frozen_query_data data[FREEZE_BENCHMARK_MAX_THREADS];
+  GThread *threads[FREEZE_BENCHMARK_MAX_THREADS];
+  gint64 start;
+  gint64 elapsed;
+
+  g_assert_cmpuint (n_threads, <=, FREEZE_BENCHMARK_MAX_THREADS);
+
+  start = g_get_monotonic_time ();
+  for (guint i = 0; i < n_threads; i++)
+    {
+      data[i] = *base;
+      data[i].iterations = iterations;
+      threads[i] =
+        g_thread_new ("frozen-query", frozen_query_thread, &data[i]);
+    }
+
+  for (guint i = 0; i < n_threads; i++)
+    {
+      g_thread_join (threads[i]);
+      g_assert_false (data[i].failed);
+    }
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  return (gdouble)n_threads * iterations * G_USEC_PER_SEC / elapsed;
+}
+
+
+static void
+test_module_index_freeze_concurrent (void)
+{
+  g_autoptr (ModulemdModuleIndex) idx = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_auto (GStrv) names = NULL;
+  frozen_query_data base = { 0 };
+  gdouble single_rate = 0;
+  gdouble rate = 0;
+
+  idx = load_freeze_test_index ();
+  modulemd_module_index_freeze (idx);
+
+  base.idx = idx;
+  names = modulemd_module_index_get_module_names_as_strv (idx);
+  base.n_modules = g_strv_length (names);
+  streams = modulemd_module_index_search_streams_by_nsvca_glob (idx, NULL);
+  base.n_streams = streams->len;
+  g_clear_pointer (&streams, g_ptr_array_unref);
+  streams = modulemd_module_index_search_streams (
+    idx, "nodejs", NULL, NULL, NULL, NULL);
+  base.n_nodejs_streams = streams->len;
+  g_assert_cmpuint (base.n_nodejs_streams, >, 0);
+
+  if (!g_test_perf ())
+    {
+      /* Only check that concurrent queries see consistent results */
+      run_frozen_queries (&base, 8, 50);
+      return;
+    }
+
+  for (guint n_threads = 1; n_threads <= FREEZE_BENCHMARK_MAX_THREADS;
+       n_threads *= 2)
+    {
+      rate = run_frozen_queries (&base, n_threads, 2000);
+      if (n_threads == 1)
+        {
+          single_rate = rate;
+        }
+
+      g_test_message ("%2u threads: %10.0f query rounds/s (%.2fx)",
+                      n_threads,
+                      rate,
+                      rate / single_rate);
+    }
+
+  g_test_maximized_result (rate,
+                           "%.0f query rounds/s with %u threads",
+                           rate,
+                           FREEZE_BENCHMARK_MAX_THREADS);
+}
+
+
+static void
+test_module_index_read_def_dir (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) idx = modulemd_module_index_new ();
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *path =
+    g_build_path ("/", g_getenv ("TEST_DATA_PATH"), "defaults", NULL);
+  g_autofree gchar *bad_path =
+    g_build_path ("/", g_getenv ("TEST_DATA_PATH"), "bad_defaults", NULL);
+  g_autofree gchar *overrides_path =
+    g_build_path ("/", path, "overrides", NULL);
+  g_auto (GStrv) module_names = NULL;
+  g_autoptr (GHashTable) defaultdict = NULL;
+
+  g_assert_nonnull (idx);
+
+  /* First verify that it works without overrides */
+  ret = modulemd_module_index_update_from_defaults_directory (
+    idx, path, TRUE, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  /* There should be three modules in the index now:
+   * - meson
+   * - ninja
+   * - nodejs
+   */
+  module_names = modulemd_module_index_get_module_names_as_strv (idx);
+  g_assert_nonnull (module_names);
+
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "meson"));
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "ninja"));
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "nodejs"));
+
+  g_assert_cmpint (g_strv_length (module_names), ==, 3);
+
+  defaultdict =
+    modulemd_module_index_get_default_streams_as_hash_table (idx, NULL);
+  g_assert_nonnull (defaultdict);
+
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "meson"), ==, "latest");
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "ninja"), ==, "latest");
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "nodejs"), ==, NULL);
+
+  g_clear_pointer (&module_names, g_strfreev);
+  g_clear_pointer (&defaultdict, g_hash_table_unref);
+
+
+  /* Verify with overrides */
+  ret = modulemd_module_index_update_from_defaults_directory (
+    idx, path, TRUE, overrides_path, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  /* There should be four modules in the index now:
+   * - meson
+   * - ninja
+   * - nodejs
+   * - testmodule
+   */
+  module_names = modulemd_module_index_get_module_names_as_strv (idx);
+  g_assert_nonnull (module_names);
+
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "meson"));
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "ninja"));
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "nodejs"));
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "testmodule"));
+
+  g_assert_cmpint (g_strv_length (module_names), ==, 4);
+
+  defaultdict =
+    modulemd_module_index_get_default_streams_as_hash_table (idx, NULL);
+  g_assert_nonnull (defaultdict);
+
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "meson"), ==, "latest");
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "ninja"), ==, "latest");
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "nodejs"), ==, "12");
+  g_assert_cmpstr (
+    g_hash_table_lookup (defaultdict, "testmodule"), ==, "teststream");
+
+  g_clear_pointer (&module_names, g_strfreev);
+  g_clear_pointer (&defaultdict, g_hash_table_unref);
+
+
+  /* Nonexistent defaults dir */
+  g_assert_false (modulemd_module_index_update_from_defaults_directory (
+    idx, "nonexistent", TRUE, NULL, &error));
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_clear_error (&error);
+
+  /* Nonexistent overrides dir */
+  g_assert_false (modulemd_module_index_update_from_defaults_directory (
+    idx, path, TRUE, "nonexistent", &error));
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_clear_error (&error);
+
+
+  g_clear_object (&idx);
+  idx = modulemd_module_index_new ();
+  g_assert_nonnull (idx);
+
+  /* Base directory contains two defaults with conflicting streams for the
+   * same module in separate files. Strict mode.
+   */
+  g_assert_false (modulemd_module_index_update_from_defaults_directory (
+    idx, bad_path, TRUE, NULL, &error));
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_clear_error (&error);
+
+  /* Verify that the index has not been modified as a side-effect */
+  module_names = modulemd_module_index_get_module_names_as_strv (idx);
+  g_assert_cmpint (g_strv_length (module_names), ==, 0);
+
+  g_clear_pointer (&module_names, g_strfreev);
+  g_clear_object (&idx);
+  idx = modulemd_module_index_new ();
+  g_assert_nonnull (idx);
+
+  /* Base directory contains two defaults with conflicting streams for the
+   * same module in separate files. Non-strict mode.
+   */
+  ret = modulemd_module_index_update_from_defaults_directory (
+    idx, bad_path, FALSE, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+
+  /* There should be three modules in the index now:
+   * - meson
+   * - ninja
+   * - nodejs
+   */
+  module_names = modulemd_module_index_get_module_names_as_strv (idx);
+  g_assert_nonnull (module_names);
+
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "meson"));
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "ninja"));
+  g_assert_true (
+    g_strv_contains ((const gchar *const *)module_names, "nodejs"));
+
+  g_assert_cmpint (g_strv_length (module_names), ==, 3);
+
+  defaultdict =
+    modulemd_module_index_get_default_streams_as_hash_table (idx, NULL);
+  g_assert_nonnull (defaultdict);
+
+  /* Make sure that in non-strict mode, meson's default is reset to NULL */
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "meson"), ==, NULL);
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "ninja"), ==, "latest");
+  g_assert_cmpstr (g_hash_table_lookup (defaultdict, "nodejs"), ==, NULL);
+
+  g_clear_pointer (&module_names, g_strfreev);
+  g_clear_pointer (&defaultdict, g_hash_table_unref);
+}
+
+
+static void
+test_modulemd_index_search_streams (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autofree gchar *yaml_path = NULL;
+
+  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
+                               g_getenv ("TEST_DATA_PATH"));
+
+  ret = modulemd_module_index_update_from_file (
+    index, yaml_path, TRUE, &failures, &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_cmpint (failures->len, ==, 0);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, "nodejs", NULL, NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 3);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, "nonexistent", NULL, NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams =
+    modulemd_module_index_search_streams (index, NULL, NULL, NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 5);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams =
+    modulemd_module_index_search_streams (index, NULL, "8", NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 1);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, "nosuchstream", NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams =
+    modulemd_module_index_search_streams (index, NULL, NULL, "1", NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 3);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams =
+    modulemd_module_index_search_streams (index, NULL, NULL, "10", NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, NULL, NULL, "e0c83381", NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 1);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, NULL, NULL, "c2c572ec", NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 4);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, NULL, NULL, "deadbeef", NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, NULL, NULL, NULL, "i686");
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, NULL, NULL, NULL, "x86_64");
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 2);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, NULL, NULL, NULL, "ppc64le");
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 1);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams =
+    modulemd_module_index_search_streams (index, NULL, "2*", NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 1);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, "[68]", NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 2);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams (
+    index, NULL, "1.?", NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 1);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams =
+    modulemd_module_index_search_streams (index, NULL, "*", NULL, NULL, NULL);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 5);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+}
+
+
+static void
+test_module_index_search_streams_by_query (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (ModulemdStreamQuery) query = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autofree gchar *yaml_path = NULL;
+
+  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
+                               g_getenv ("TEST_DATA_PATH"));
+
+  ret = modulemd_module_index_update_from_file (
+    index, yaml_path, TRUE, &failures, &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_cmpint (failures->len, ==, 0);
+
+  /* A query can be reused for any number of searches */
+  query = modulemd_stream_query_new ("nodejs", NULL, "1", "c2c572ec", NULL);
+  for (guint i = 0; i < 2; i++)
+    {
+      streams = modulemd_module_index_search_streams_by_query (index, query);
+      g_assert_nonnull (streams);
+      g_assert_cmpint (streams->len, ==, 3);
+      g_assert_cmpstr (modulemd_module_stream_get_stream_name (
+                         g_ptr_array_index (streams, 0)),
+                       ==,
+                       "6");
+      g_assert_cmpstr (modulemd_module_stream_get_stream_name (
+                         g_ptr_array_index (streams, 2)),
+                       ==,
+                       "9");
+      g_clear_pointer (&streams, g_ptr_array_unref);
+    }
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new ("nonexistent", NULL, NULL, NULL, NULL);
+  streams = modulemd_module_index_search_streams_by_query (index, query);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new (NULL, NULL, "2018*", NULL, NULL);
+  streams = modulemd_module_index_search_streams_by_query (index, query);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 2);
+  g_assert_cmpstr (
+    modulemd_module_stream_get_module_name (g_ptr_array_index (streams, 0)),
+    ==,
+    "django");
+  g_assert_cmpstr (
+    modulemd_module_stream_get_module_name (g_ptr_array_index (streams, 1)),
+    ==,
+    "reviewboard");
+  g_clear_pointer (&streams, g_ptr_array_unref);
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new_from_nsvca_glob ("nodejs:*:*:*:x86_64");
+  streams = modulemd_module_index_search_streams_by_query (index, query);
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 2);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+  g_clear_object (&query);
+}
+
+
+static gboolean
+collect_stream (ModulemdModuleStream *stream, gpointer user_data)
+{
+  g_ptr_array_add ((GPtrArray *)user_data, stream);
+  return TRUE;
+}
+
+
+static gboolean
+collect_first_stream (ModulemdModuleStream *stream, gpointer user_data)
+{
+  g_ptr_array_add ((GPtrArray *)user_data, stream);
+  return FALSE;
+}
+
+
+static void
+test_module_index_foreach_stream (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (ModulemdStreamQuery) query = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autoptr (GPtrArray) visited = NULL;
+  g_autofree gchar *yaml_path = NULL;
+
+  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
+                               g_getenv ("TEST_DATA_PATH"));
+
+  ret = modulemd_module_index_update_from_file (
+    index, yaml_path, TRUE, &failures, &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_cmpint (failures->len, ==, 0);
+
+  /* Visiting everything matches the sorted search results */
+  streams =
+    modulemd_module_index_search_streams (index, NULL, NULL, NULL, NULL, NULL);
+  visited = g_ptr_array_new ();
+  g_assert_true (modulemd_module_index_foreach_stream (
+    index, NULL, collect_stream, visited));
+  g_assert_cmpint (visited->len, ==, streams->len);
+  for (guint i = 0; i < streams->len; i++)
+    {
+      g_assert_true (g_ptr_array_index (visited, i) ==
+                     g_ptr_array_index (streams, i));
+    }
+  g_clear_pointer (&streams, g_ptr_array_unref);
+  g_clear_pointer (&visited, g_ptr_array_unref);
+
+  /* Queries restrict the visited streams */
+  query = modulemd_stream_query_new ("nodejs", NULL, NULL, NULL, "x86_64");
+  visited = g_ptr_array_new ();
+  g_assert_true (modulemd_module_index_foreach_stream (
+    index, query, collect_stream, visited));
+  g_assert_cmpint (visited->len, ==, 2);
+  g_clear_pointer (&visited, g_ptr_array_unref);
+  g_clear_object (&query);
+
+  /* Returning FALSE stops the iteration */
+  visited = g_ptr_array_new ();
+  g_assert_false (modulemd_module_index_foreach_stream (
+    index, NULL, collect_first_stream, visited));
+  g_assert_cmpint (visited->len, ==, 1);
+  g_assert_cmpstr (
+    modulemd_module_stream_get_module_name (g_ptr_array_index (visited, 0)),
+    ==,
+    "django");
+  g_clear_pointer (&visited, g_ptr_array_unref);
+
+  /* The cached order follows modules being removed */
+  g_assert_true (modulemd_module_index_remove_module (index, "django"));
+  visited = g_ptr_array_new ();
+  g_assert_true (modulemd_module_index_foreach_stream (
+    index, NULL, collect_stream, visited));
+  g_assert_cmpint (visited->len, ==, 4);
+  g_assert_cmpstr (
+    modulemd_module_stream_get_module_name (g_ptr_array_index (visited, 0)),
+    ==,
+    "nodejs");
+  g_clear_pointer (&visited, g_ptr_array_unref);
+
+  /* RPM searches visit the same streams as modulemd_module_index_search_rpms
+   */
+  streams = modulemd_module_index_search_rpms (index, "nodejs-*");
+  visited = g_ptr_array_new ();
+  g_assert_true (modulemd_module_index_foreach_stream_by_rpm (
+    index, "nodejs-*", collect_stream, visited));
+  g_assert_cmpint (visited->len, ==, streams->len);
+  for (guint i = 0; i < streams->len; i++)
+    {
+      g_assert_true (g_ptr_array_index (visited, i) ==
+                     g_ptr_array_index (streams, i));
+    }
+}
+
+
+static void
+test_module_index_search_streams_by_nsvca_glob (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autofree gchar *yaml_path = NULL;
+
+  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
+                               g_getenv ("TEST_DATA_PATH"));
+
+  ret = modulemd_module_index_update_from_file (
+    index, yaml_path, TRUE, &failures, &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_cmpint (failures->len, ==, 0);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams_by_nsvca_glob (index, "*");
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 5);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams = modulemd_module_index_search_streams_by_nsvca_glob (index, NULL);
   g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 1);
+  g_assert_cmpint (streams->len, ==, 5);
   g_clear_pointer (&streams, g_ptr_array_unref);
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, "nosuchstream", NULL, NULL, NULL);
+  streams =
+    modulemd_module_index_search_streams_by_nsvca_glob (index, "nodejs*");
   g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 0);
+  g_assert_cmpint (streams->len, ==, 3);
   g_clear_pointer (&streams, g_ptr_array_unref);
 
   streams =
-    modulemd_module_index_search_streams (index, NULL, NULL, "1", NULL, NULL);
+    modulemd_module_index_search_streams_by_nsvca_glob (index, "nodejs:?*");
   g_assert_nonnull (streams);
   g_assert_cmpint (streams->len, ==, 3);
   g_clear_pointer (&streams, g_ptr_array_unref);
 
-  streams =
-    modulemd_module_index_search_streams (index, NULL, NULL, "10", NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 0);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  streams = modulemd_module_index_search_streams_by_nsvca_glob (index, "*8*");
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 4);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  streams =
+    modulemd_module_index_search_streams_by_nsvca_glob (index, "nodejs:[68]*");
+  g_assert_nonnull (streams);
+  g_assert_cmpint (streams->len, ==, 2);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+}
+
+
+static void
+test_module_index_search_rpms (void)
+{
+  gboolean ret;
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GPtrArray) streams = NULL;
+  g_autofree gchar *yaml_path = NULL;
+
+  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
+                               g_getenv ("TEST_DATA_PATH"));
+
+  ret = modulemd_module_index_update_from_file (
+    index, yaml_path, TRUE, &failures, &error);
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  g_assert_cmpint (failures->len, ==, 0);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+
+
+  /* Searching for "python*" should give us ReviewBoard and Django */
+  streams = modulemd_module_index_search_rpms (index, "python*");
+  g_assert_cmpint (streams->len, ==, 2);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  /* Searching for "[nR]*" should give us three Node.js streams, plus
+   * ReviewBoard
+   */
+  streams = modulemd_module_index_search_rpms (index, "[nR]*");
+  g_assert_cmpint (streams->len, ==, 4);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  /* Searching for "*1.6*" should give us Django and Node.js 6 (because of
+   * npm-1:3.10.10-1.6.13.1.1.module_1575+55808bea.x86_64)
+   */
+  streams = modulemd_module_index_search_rpms (index, "*1.6*");
+  g_assert_cmpint (streams->len, ==, 2);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  /* Searching for "*" should give us all five streams */
+  streams = modulemd_module_index_search_rpms (index, "*");
+  g_assert_cmpint (streams->len, ==, 5);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  /* Searching for NULL should give us all five streams */
+  streams = modulemd_module_index_search_rpms (index, NULL);
+  g_assert_cmpint (streams->len, ==, 5);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+
+  /* Searching for "perl-*" should give us nothing */
+  streams = modulemd_module_index_search_rpms (index, "perl-*");
+  g_assert_cmpint (streams->len, ==, 0);
+  g_clear_pointer (&streams, g_ptr_array_unref);
+}
+
+
+static void
+add_provider_test_stream (ModulemdModuleIndex *index,
+                          const gchar *stream_name,
+                          guint64 version)
+{
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (ModulemdProfile) profile = NULL;
+  g_autoptr (ModulemdComponentRpm) component = NULL;
+  ModulemdModuleStreamV2 *v2_stream = NULL;
+  g_autoptr (GError) error = NULL;
+
+  stream = modulemd_module_stream_new (2, "foo", stream_name);
+  modulemd_module_stream_set_version (stream, version);
+  modulemd_module_stream_set_context (stream, "c0ffee42");
+  v2_stream = MODULEMD_MODULE_STREAM_V2 (stream);
+
+  modulemd_module_stream_v2_add_rpm_api (v2_stream, "foo-cli");
+
+  profile = modulemd_profile_new ("minimal");
+  modulemd_profile_add_rpm (profile, "foo-cli");
+  modulemd_module_stream_v2_add_profile (v2_stream, profile);
+  g_clear_object (&profile);
+
+  profile = modulemd_profile_new ("default");
+  modulemd_profile_add_rpm (profile, "foo-cli");
+  modulemd_profile_add_rpm (profile, "foo-libs");
+  modulemd_module_stream_v2_add_profile (v2_stream, profile);
+
+  component = modulemd_component_rpm_new ("foo");
+  modulemd_module_stream_v2_add_component (v2_stream,
+                                           MODULEMD_COMPONENT (component));
+
+  g_assert_true (
+    modulemd_module_index_add_module_stream (index, stream, &error));
+  g_assert_no_error (error);
+}
+
+
+static void
+test_module_index_search_package_providers (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (GPtrArray) providers = NULL;
+  ModulemdPackageProvider *provider = NULL;
+
+  add_provider_test_stream (index, "2", 1);
+
+  /* The API, both profiles and the component of the stream are searched */
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo-cli", MD_PACKAGE_SOURCE_ALL);
+  g_assert_cmpint (providers->len, ==, 3);
+  provider = g_ptr_array_index (providers, 0);
+  g_assert_cmpint (modulemd_package_provider_get_source (provider),
+                   ==,
+                   MD_PACKAGE_SOURCE_RPM_API);
+  g_assert_null (modulemd_package_provider_get_profile_name (provider));
+  g_assert_cmpstr (modulemd_module_stream_get_stream_name (
+                     modulemd_package_provider_get_stream (provider)),
+                   ==,
+                   "2");
+  provider = g_ptr_array_index (providers, 1);
+  g_assert_cmpint (modulemd_package_provider_get_source (provider),
+                   ==,
+                   MD_PACKAGE_SOURCE_PROFILE);
+  g_assert_cmpstr (
+    modulemd_package_provider_get_profile_name (provider), ==, "default");
+  provider = g_ptr_array_index (providers, 2);
+  g_assert_cmpstr (
+    modulemd_package_provider_get_profile_name (provider), ==, "minimal");
+  g_clear_pointer (&providers, g_ptr_array_unref);
+
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo", MD_PACKAGE_SOURCE_ALL);
+  g_assert_cmpint (providers->len, ==, 1);
+  g_assert_cmpint (modulemd_package_provider_get_source (
+                     g_ptr_array_index (providers, 0)),
+                   ==,
+                   MD_PACKAGE_SOURCE_COMPONENT);
+  g_clear_pointer (&providers, g_ptr_array_unref);
+
+  /* Names are matched exactly and only in the requested sources */
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo*", MD_PACKAGE_SOURCE_ALL);
+  g_assert_cmpint (providers->len, ==, 0);
+  g_clear_pointer (&providers, g_ptr_array_unref);
+
+  providers = modulemd_module_index_search_package_providers (
+    index,
+    "foo-libs",
+    MD_PACKAGE_SOURCE_RPM_API | MD_PACKAGE_SOURCE_COMPONENT);
+  g_assert_cmpint (providers->len, ==, 0);
+  g_clear_pointer (&providers, g_ptr_array_unref);
+
+  /* Adding a stream drops the cached map */
+  add_provider_test_stream (index, "1", 1);
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo-cli", MD_PACKAGE_SOURCE_RPM_API);
+  g_assert_cmpint (providers->len, ==, 2);
+  g_assert_cmpstr (modulemd_module_stream_get_stream_name (
+                     modulemd_package_provider_get_stream (
+                       g_ptr_array_index (providers, 0))),
+                   ==,
+                   "1");
+  g_clear_pointer (&providers, g_ptr_array_unref);
+
+  /* A frozen index builds the map on first use as well */
+  add_provider_test_stream (index, "1", 2);
+  modulemd_module_index_freeze (index);
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo-libs", MD_PACKAGE_SOURCE_PROFILE);
+  g_assert_cmpint (providers->len, ==, 3);
+  g_assert_cmpuint (modulemd_module_stream_get_version (
+                      modulemd_package_provider_get_stream (
+                        g_ptr_array_index (providers, 0))),
+                    ==,
+                    2);
+  g_clear_pointer (&providers, g_ptr_array_unref);
+
+  /* Removing the module removes its providers */
+  g_clear_object (&index);
+  index = modulemd_module_index_new ();
+  add_provider_test_stream (index, "1", 1);
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo", MD_PACKAGE_SOURCE_ALL);
+  g_assert_cmpint (providers->len, ==, 1);
+  g_clear_pointer (&providers, g_ptr_array_unref);
+  g_assert_true (modulemd_module_index_remove_module (index, "foo"));
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo", MD_PACKAGE_SOURCE_ALL);
+  g_assert_cmpint (providers->len, ==, 0);
+}
+
+
+
+static void
+add_compact_test_stream (ModulemdModuleIndex *index, const gchar *arch)
+{
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (ModulemdBuildopts) buildopts = NULL;
+  g_autoptr (ModulemdComponentRpm) component = NULL;
+  g_autoptr (ModulemdDependencies) deps = NULL;
+  g_autoptr (ModulemdProfile) profile = NULL;
+  g_autoptr (GError) error = NULL;
+  ModulemdModuleStreamV2 *v2_stream = NULL;
+
+  stream = modulemd_module_stream_new (2, "foo", "1");
+  v2_stream = MODULEMD_MODULE_STREAM_V2 (stream);
+  modulemd_module_stream_set_version (stream, 1);
+  modulemd_module_stream_set_context (stream, "c0ffee42");
+  modulemd_module_stream_set_arch (stream, arch);
+  modulemd_module_stream_v2_set_summary (v2_stream, "Summary");
+  modulemd_module_stream_v2_set_description (v2_stream, "Description");
+  modulemd_module_stream_v2_add_module_license (v2_stream, "MIT");
+
+  buildopts = modulemd_buildopts_new ();
+  modulemd_buildopts_set_rpm_macros (buildopts, "%demomacro 1");
+  modulemd_module_stream_v2_set_buildopts (v2_stream, buildopts);
+
+  component = modulemd_component_rpm_new ("bar");
+  modulemd_component_set_rationale (MODULEMD_COMPONENT (component),
+                                    "Demonstration");
+  modulemd_component_rpm_set_ref (component, "main");
+  modulemd_module_stream_v2_add_component (v2_stream,
+                                           MODULEMD_COMPONENT (component));
+
+  deps = modulemd_dependencies_new ();
+  modulemd_dependencies_add_runtime_stream (deps, "platform", "f32");
+  modulemd_module_stream_v2_add_dependencies (v2_stream, deps);
+
+  profile = modulemd_profile_new ("default");
+  modulemd_profile_add_rpm (profile, "bar");
+  modulemd_module_stream_v2_add_profile (v2_stream, profile);
+
+  g_assert_true (
+    modulemd_module_index_add_module_stream (index, stream, &error));
+  g_assert_no_error (error);
+}
+
+
+static ModulemdModuleStreamV2 *
+get_compact_test_stream (ModulemdModuleIndex *index, const gchar *arch)
+{
+  g_autoptr (GError) error = NULL;
+  ModulemdModuleStream *stream = NULL;
+
+  stream = modulemd_module_get_stream_by_NSVCA (
+    modulemd_module_index_get_module (index, "foo"),
+    "1",
+    1,
+    "c0ffee42",
+    arch,
+    &error);
+  g_assert_no_error (error);
+
+  return MODULEMD_MODULE_STREAM_V2 (stream);
+}
+
+
+static GHashTable *
+get_compact_test_rpms (ModulemdModuleStreamV2 *stream)
+{
+  return modulemd_profile_get_rpms_internal (
+    modulemd_module_stream_v2_get_profile (stream, "default"));
+}
+
+
+static GHashTable *
+get_compact_test_buildafter (ModulemdModuleStreamV2 *stream)
+{
+  return modulemd_component_get_buildafter_internal (MODULEMD_COMPONENT (
+    modulemd_module_stream_v2_get_rpm_component (stream, "bar")));
+}
+
+
+static void
+test_module_index_compact (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (ModulemdModuleStream) copy = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *expected = NULL;
+  g_autofree gchar *yaml = NULL;
+  g_auto (GStrv) rpms = NULL;
+  g_auto (GStrv) arches = NULL;
+  ModulemdModuleStreamV2 *x86_64 = NULL;
+  ModulemdModuleStreamV2 *aarch64 = NULL;
+  ModulemdProfile *profile = NULL;
+  ModulemdComponent *component = NULL;
+
+  add_compact_test_stream (index, "x86_64");
+  add_compact_test_stream (index, "aarch64");
+
+  expected = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+
+  /* All of the empty sets share one instance, as do the profile RPMs and
+   * the dependency tables of the second stream with those of the first
+   */
+  g_assert_cmpuint (modulemd_module_index_compact (index), ==, 12);
+  g_assert_false (modulemd_module_index_is_frozen (index));
+
+  x86_64 = get_compact_test_stream (index, "x86_64");
+  aarch64 = get_compact_test_stream (index, "aarch64");
+
+  g_assert_true (get_compact_test_rpms (x86_64) ==
+                 get_compact_test_rpms (aarch64));
+  g_assert_true (get_compact_test_buildafter (x86_64) ==
+                 get_compact_test_buildafter (aarch64));
+
+  /* The objects holding the sets are not shared */
+  g_assert_true (modulemd_module_stream_v2_get_buildopts (x86_64) !=
+                 modulemd_module_stream_v2_get_buildopts (aarch64));
+  g_assert_true (
+    modulemd_module_stream_v2_get_rpm_component (x86_64, "bar") !=
+    modulemd_module_stream_v2_get_rpm_component (aarch64, "bar"));
+
+  /* Sharing does not change the content */
+  yaml = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (expected, ==, yaml);
+
+  /* Everything is shared already */
+  g_assert_cmpuint (modulemd_module_index_compact (index), ==, 0);
+
+  /* Modifying one stream copies its sets first */
+  component = MODULEMD_COMPONENT (
+    modulemd_module_stream_v2_get_rpm_component (x86_64, "bar"));
+  modulemd_component_add_buildafter (component, "baz");
+  g_assert_true (get_compact_test_buildafter (x86_64) !=
+                 get_compact_test_buildafter (aarch64));
+  g_assert_cmpuint (
+    g_hash_table_size (get_compact_test_buildafter (aarch64)), ==, 0);
+
+  modulemd_buildopts_add_arch (
+    modulemd_module_stream_v2_get_buildopts (aarch64), "s390x");
+  arches = modulemd_buildopts_get_arches_as_strv (
+    modulemd_module_stream_v2_get_buildopts (x86_64));
+  g_assert_cmpint (g_strv_length (arches), ==, 0);
+
+  /* A copy shares the sets on the same terms */
+  copy = modulemd_module_stream_copy (MODULEMD_MODULE_STREAM (aarch64), NULL,
+                                      NULL);
+  g_assert_true (get_compact_test_rpms (MODULEMD_MODULE_STREAM_V2 (copy)) ==
+                 get_compact_test_rpms (aarch64));
+  profile = modulemd_module_stream_v2_get_profile (
+    MODULEMD_MODULE_STREAM_V2 (copy), "default");
+  modulemd_profile_add_rpm (profile, "baz");
+
+  profile = modulemd_module_stream_v2_get_profile (aarch64, "default");
+  rpms = modulemd_profile_get_rpms_as_strv (profile);
+  g_assert_cmpint (g_strv_length (rpms), ==, 1);
+  g_assert_cmpstr (rpms[0], ==, "bar");
+}
+
+
+static void
+test_module_index_compact_on_load (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (ModulemdModuleIndex) loaded = modulemd_module_index_new ();
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *x86_64_yaml = NULL;
+  g_autofree gchar *aarch64_yaml = NULL;
+  g_autofree gchar *expected = NULL;
+  g_autofree gchar *yaml = NULL;
+
+  add_compact_test_stream (index, "x86_64");
+  x86_64_yaml = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+  g_clear_object (&index);
+
+  index = modulemd_module_index_new ();
+  add_compact_test_stream (index, "aarch64");
+  aarch64_yaml = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+
+  g_assert_false (modulemd_module_index_get_compact_on_load (loaded));
+  modulemd_module_index_set_compact_on_load (loaded, TRUE);
+  g_assert_true (modulemd_module_index_get_compact_on_load (loaded));
+
+  /* Streams loaded separately share their sets with each other */
+  g_assert_true (modulemd_module_index_update_from_string (
+    loaded, x86_64_yaml, TRUE, &failures, &error));
+  g_assert_no_error (error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+  g_assert_true (modulemd_module_index_update_from_string (
+    loaded, aarch64_yaml, TRUE, &failures, &error));
+  g_assert_no_error (error);
+
+  g_assert_true (
+    get_compact_test_rpms (get_compact_test_stream (loaded, "x86_64")) ==
+    get_compact_test_rpms (get_compact_test_stream (loaded, "aarch64")));
+  g_assert_cmpuint (modulemd_module_index_compact (loaded), ==, 0);
+
+  /* The content is the same as without compaction */
+  g_clear_pointer (&failures, g_ptr_array_unref);
+  g_assert_true (modulemd_module_index_update_from_string (
+    index, x86_64_yaml, TRUE, &failures, &error));
+  g_assert_no_error (error);
+  expected = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+  yaml = modulemd_module_index_dump_to_string (loaded, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (yaml, ==, expected);
+
+  modulemd_module_index_set_compact_on_load (loaded, FALSE);
+  g_assert_false (modulemd_module_index_get_compact_on_load (loaded));
+}
+
+
+static guint64
+sum_memory_categories (ModulemdMemoryUsage *usage, const gchar *module_name)
+{
+  guint64 total = 0;
+
+  for (guint i = MD_MEMORY_CATEGORY_STRINGS;
+       i <= MD_MEMORY_CATEGORY_TRANSLATIONS;
+       i++)
+    {
+      total += modulemd_memory_usage_get_module_category (
+        usage, module_name, (ModulemdMemoryCategoryEnum)i);
+    }
+
+  return total;
+}
+
+
+static void
+test_module_index_memory_usage (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (ModulemdMemoryUsage) usage = NULL;
+  g_autoptr (ModulemdModuleStream) stream = NULL;
+  g_autoptr (ModulemdTranslation) translation = NULL;
+  g_autoptr (ModulemdTranslationEntry) entry = NULL;
+  g_autoptr (GPtrArray) providers = NULL;
+  g_auto (GStrv) module_names = NULL;
+  g_autoptr (GError) error = NULL;
+  guint64 index_total;
+  guint64 total = 0;
+
+  add_provider_test_stream (index, "2", 1);
+
+  stream = modulemd_module_stream_new (2, "bar", "1");
+  modulemd_module_stream_set_version (stream, 1);
+  modulemd_module_stream_set_context (stream, "c0ffee42");
+  modulemd_module_stream_v2_add_rpm_artifact (
+    MODULEMD_MODULE_STREAM_V2 (stream), "bar-0:1.0-1.module_f32.x86_64");
+  g_assert_true (
+    modulemd_module_index_add_module_stream (index, stream, &error));
+  g_assert_no_error (error);
+
+  translation = modulemd_translation_new (1, "bar", "1", 42);
+  entry = modulemd_translation_entry_new ("nl_NL");
+  modulemd_translation_entry_set_summary (entry, "Een samenvatting");
+  modulemd_translation_set_translation_entry (translation, entry);
+  g_assert_true (
+    modulemd_module_index_add_translation (index, translation, &error));
+  g_assert_no_error (error);
+
+  usage = modulemd_module_index_get_memory_usage (index);
+  g_assert_nonnull (usage);
+
+  module_names = modulemd_memory_usage_get_module_names_as_strv (usage);
+  g_assert_cmpint (g_strv_length (module_names), ==, 2);
+  g_assert_cmpstr (module_names[0], ==, "bar");
+  g_assert_cmpstr (module_names[1], ==, "foo");
+
+  /* Every byte is counted in exactly one module and one category */
+  for (guint i = 0; module_names[i]; i++)
+    {
+      g_assert_cmpuint (
+        modulemd_memory_usage_get_module_total (usage, module_names[i]), >, 0);
+      g_assert_cmpuint (
+        modulemd_memory_usage_get_module_total (usage, module_names[i]),
+        ==,
+        sum_memory_categories (usage, module_names[i]));
+      total += modulemd_memory_usage_get_module_total (usage, module_names[i]);
+    }
+  index_total = modulemd_memory_usage_get_module_total (usage, NULL);
+  g_assert_cmpuint (index_total, >, 0);
+  g_assert_cmpuint (index_total, ==, sum_memory_categories (usage, NULL));
+  g_assert_cmpuint (
+    modulemd_memory_usage_get_total (usage), ==, total + index_total);
+
+  /* Artifacts and translations are only in the module that has them */
+  g_assert_cmpuint (modulemd_memory_usage_get_module_category (
+                      usage, "bar", MD_MEMORY_CATEGORY_ARTIFACTS),
+                    >,
+                    0);
+  g_assert_cmpuint (modulemd_memory_usage_get_module_category (
+                      usage, "bar", MD_MEMORY_CATEGORY_TRANSLATIONS),
+                    >,
+                    0);
+  g_assert_cmpuint (modulemd_memory_usage_get_module_category (
+                      usage, "foo", MD_MEMORY_CATEGORY_ARTIFACTS),
+                    ==,
+                    0);
+  g_assert_cmpuint (modulemd_memory_usage_get_module_category (
+                      usage, "foo", MD_MEMORY_CATEGORY_TRANSLATIONS),
+                    ==,
+                    0);
+
+  g_assert_cmpuint (modulemd_memory_usage_get_module_total (usage, "baz"),
+                    ==,
+                    0);
+  g_assert_cmpuint (modulemd_memory_usage_get_module_category (
+                      usage, "baz", MD_MEMORY_CATEGORY_STRINGS),
+                    ==,
+                    0);
+  g_clear_object (&usage);
+
+  /* Caches built by queries are counted as memory of the index itself */
+  providers = modulemd_module_index_search_package_providers (
+    index, "foo-cli", MD_PACKAGE_SOURCE_ALL);
+  g_assert_cmpint (providers->len, ==, 3);
+  usage = modulemd_module_index_get_memory_usage (index);
+  g_assert_cmpuint (
+    modulemd_memory_usage_get_module_total (usage, NULL), >, index_total);
+}
+
+static ModulemdModuleIndex *
+load_index_from_string (const gchar *yaml)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+
+  g_assert_true (modulemd_module_index_update_from_string (
+    index, yaml, TRUE, &failures, &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (failures->len, ==, 0);
+
+  return g_steal_pointer (&index);
+}
+
+
+static ModulemdModuleStream *
+get_provider_test_stream (ModulemdModuleIndex *index,
+                          const gchar *stream_name,
+                          guint64 version)
+{
+  ModulemdModuleStream *stream = NULL;
+  g_autoptr (GError) error = NULL;
+
+  stream = modulemd_module_get_stream_by_NSVCA (
+    modulemd_module_index_get_module (index, "foo"),
+    stream_name,
+    version,
+    "c0ffee42",
+    NULL,
+    &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (stream);
+
+  return stream;
+}
+
+
+/* Adds streams foo:1:1 and foo:2:2 that pass validation */
+static void
+add_valid_provider_test_streams (ModulemdModuleIndex *index)
+{
+  for (guint64 i = 1; i <= 2; i++)
+    {
+      g_autofree gchar *stream_name =
+        g_strdup_printf ("%" G_GUINT64_FORMAT, i);
+      ModulemdModuleStreamV2 *v2_stream = NULL;
+
+      add_provider_test_stream (index, stream_name, i);
+      v2_stream = MODULEMD_MODULE_STREAM_V2 (
+        get_provider_test_stream (index, stream_name, i));
+      modulemd_module_stream_v2_set_summary (v2_stream, "A summary");
+      modulemd_module_stream_v2_set_description (v2_stream, "A description");
+      modulemd_module_stream_v2_add_module_license (v2_stream, "MIT");
+    }
+}
+
+
+static ModulemdModuleStreamV2 *
+get_validated_test_stream (ModulemdModuleIndex *index, const gchar *name)
+{
+  ModulemdModuleStream *stream =
+    get_provider_test_stream (index, name, g_ascii_strtoull (name, NULL, 10));
+
+  g_assert_true (modulemd_module_stream_is_validated (stream));
+
+  return MODULEMD_MODULE_STREAM_V2 (stream);
+}
+
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, NULL, NULL, "e0c83381", NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 1);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+static void
+assert_not_validated (ModulemdModuleStreamV2 *v2_stream)
+{
+  g_assert_false (
+    modulemd_module_stream_is_validated (MODULEMD_MODULE_STREAM (v2_stream)));
+}
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, NULL, NULL, "c2c572ec", NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 4);
-  g_clear_pointer (&streams, g_ptr_array_unref);
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, NULL, NULL, "deadbeef", NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 0);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+static void
+test_module_index_skip_validation_children (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (ModulemdModuleIndex) loaded = NULL;
+  g_autoptr (ModulemdBuildopts) buildopts = modulemd_buildopts_new ();
+  g_autoptr (ModulemdDependencies) deps = modulemd_dependencies_new ();
+  g_autoptr (ModulemdServiceLevel) servicelevel =
+    modulemd_service_level_new ("rawhide");
+  ModulemdModuleStreamV2 *v2_stream = NULL;
+  ModulemdComponent *component = NULL;
+  GPtrArray *stored_deps = NULL;
+  g_autofree gchar *yaml = NULL;
+  g_autofree gchar *dumped = NULL;
+  g_autoptr (GError) error = NULL;
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, NULL, NULL, NULL, "i686");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 0);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  add_valid_provider_test_streams (index);
+  modulemd_buildopts_set_rpm_macros (buildopts, "%demomacro 1");
+  modulemd_dependencies_add_runtime_stream (deps, "platform", "f33");
+  for (guint64 i = 1; i <= 2; i++)
+    {
+      g_autofree gchar *stream_name =
+        g_strdup_printf ("%" G_GUINT64_FORMAT, i);
+
+      v2_stream = MODULEMD_MODULE_STREAM_V2 (
+        get_provider_test_stream (index, stream_name, i));
+      modulemd_module_stream_v2_set_buildopts (v2_stream, buildopts);
+      modulemd_module_stream_v2_add_dependencies (v2_stream, deps);
+      modulemd_module_stream_v2_add_servicelevel (v2_stream, servicelevel);
+    }
+  yaml = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (yaml);
+
+  /* Components and profiles */
+  loaded = load_index_from_string (yaml);
+  v2_stream = get_validated_test_stream (loaded, "1");
+  component = MODULEMD_COMPONENT (
+    modulemd_module_stream_v2_get_rpm_component (v2_stream, "foo"));
+  modulemd_component_set_rationale (component, "A changed rationale");
+  assert_not_validated (v2_stream);
+
+  v2_stream = get_validated_test_stream (loaded, "2");
+  modulemd_profile_add_rpm (
+    modulemd_module_stream_v2_get_profile (v2_stream, "minimal"), "foo-libs");
+  assert_not_validated (v2_stream);
+
+  dumped = modulemd_module_index_dump_to_string (loaded, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (strstr (dumped, "A changed rationale"));
+  g_clear_pointer (&dumped, g_free);
+  g_clear_object (&loaded);
+
+  /* Buildopts and dependencies */
+  loaded = load_index_from_string (yaml);
+  v2_stream = get_validated_test_stream (loaded, "1");
+  modulemd_buildopts_add_arch (
+    modulemd_module_stream_v2_get_buildopts (v2_stream), "x86_64");
+  assert_not_validated (v2_stream);
+
+  v2_stream = get_validated_test_stream (loaded, "2");
+  stored_deps = modulemd_module_stream_v2_get_dependencies (v2_stream);
+  modulemd_dependencies_add_buildtime_stream (
+    g_ptr_array_index (stored_deps, 0), "platform", "f33");
+  assert_not_validated (v2_stream);
+  g_clear_object (&loaded);
+
+  /* Service levels, which leave the other stream alone */
+  loaded = load_index_from_string (yaml);
+  v2_stream = get_validated_test_stream (loaded, "1");
+  modulemd_service_level_set_eol_ymd (
+    modulemd_module_stream_v2_get_servicelevel (v2_stream, "rawhide"),
+    2030,
+    1,
+    1);
+  assert_not_validated (v2_stream);
+  get_validated_test_stream (loaded, "2");
+}
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, NULL, NULL, NULL, "x86_64");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 2);
-  g_clear_pointer (&streams, g_ptr_array_unref);
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, NULL, NULL, NULL, "ppc64le");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 1);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+static void
+test_module_index_skip_validation (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (ModulemdModuleIndex) loaded = NULL;
+  ModulemdModuleStream *stream = NULL;
+  ModulemdComponent *component = NULL;
+  g_autofree gchar *yaml = NULL;
+  g_autofree gchar *dumped = NULL;
+  g_autoptr (GError) error = NULL;
 
-  streams =
-    modulemd_module_index_search_streams (index, NULL, "2*", NULL, NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 1);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  /* Unmodified streams are not validated again unless told otherwise */
+  g_assert_false (modulemd_module_index_get_force_validate (index));
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, "[68]", NULL, NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 2);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  /* Streams built with setters are validated on their first dump */
+  add_valid_provider_test_streams (index);
+  stream = get_provider_test_stream (index, "1", 1);
+  g_assert_false (modulemd_module_stream_is_validated (stream));
+  yaml = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (yaml);
+  g_assert_true (modulemd_module_stream_is_validated (stream));
 
-  streams = modulemd_module_index_search_streams (
-    index, NULL, "1.?", NULL, NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 1);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  /* Loaded streams were validated by the parser */
+  loaded = load_index_from_string (yaml);
+  stream = get_provider_test_stream (loaded, "1", 1);
+  g_assert_true (modulemd_module_stream_is_validated (stream));
 
-  streams =
-    modulemd_module_index_search_streams (index, NULL, "*", NULL, NULL, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 5);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  /* Setters invalidate the result */
+  modulemd_module_stream_v2_set_summary (MODULEMD_MODULE_STREAM_V2 (stream),
+                                         "Another summary");
+  g_assert_false (modulemd_module_stream_is_validated (stream));
+  dumped = modulemd_module_index_dump_to_string (loaded, &error);
+  g_assert_no_error (error);
+  g_assert_true (modulemd_module_stream_is_validated (stream));
+  g_clear_pointer (&dumped, g_free);
+
+  /* So do the setters of objects stored in the stream */
+  component = MODULEMD_COMPONENT (modulemd_module_stream_v2_get_rpm_component (
+    MODULEMD_MODULE_STREAM_V2 (stream), "foo"));
+  g_assert_nonnull (component);
+  modulemd_component_add_buildafter (component, "missing");
+  g_assert_false (modulemd_module_stream_is_validated (stream));
+  dumped = modulemd_module_index_dump_to_string (loaded, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_assert_null (dumped);
+  g_clear_error (&error);
+
+  modulemd_module_index_set_force_validate (loaded, TRUE);
+  g_assert_true (modulemd_module_index_get_force_validate (loaded));
+  dumped = modulemd_module_index_dump_to_string (loaded, &error);
+  g_assert_error (error, MODULEMD_ERROR, MMD_ERROR_VALIDATE);
+  g_assert_null (dumped);
+  g_clear_error (&error);
+
+  /* Freezing validates the streams, since dumping a frozen index cannot */
+  g_clear_object (&index);
+  index = modulemd_module_index_new ();
+  add_valid_provider_test_streams (index);
+  stream = get_provider_test_stream (index, "1", 1);
+  g_assert_false (modulemd_module_stream_is_validated (stream));
+  modulemd_module_index_freeze (index);
+  g_assert_true (modulemd_module_stream_is_validated (stream));
 }
 
 
 static void
-test_module_index_search_streams_by_nsvca_glob (void)
+test_module_index_json (void)
 {
-  gboolean ret;
   g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
-  g_autoptr (GError) error = NULL;
+  g_autoptr (ModulemdModuleIndex) from_json = NULL;
+  g_autoptr (ModulemdModuleIndex) from_cbor = NULL;
+  g_autoptr (ModulemdModuleIndex) invalid = NULL;
   g_autoptr (GPtrArray) failures = NULL;
-  g_autoptr (GPtrArray) streams = NULL;
+  g_autoptr (GError) error = NULL;
   g_autofree gchar *yaml_path = NULL;
+  g_autofree gchar *yaml = NULL;
+  g_autofree gchar *json = NULL;
+  g_autofree gchar *dumped = NULL;
+  g_autoptr (GBytes) cbor = NULL;
+  g_autoptr (GBytes) truncated = NULL;
+  const gchar *specs[] = { "modulemd_stream_v2",
+                           "modulemd_defaults_v1",
+                           "modulemd_translations_v1",
+                           "modulemd_obsoletes_v1",
+                           NULL };
+
+  for (guint i = 0; specs[i]; i++)
+    {
+      yaml_path = g_strdup_printf ("%s/yaml_specs/%s.yaml",
+                                   g_getenv ("MESON_SOURCE_ROOT"),
+                                   specs[i]);
+      g_assert_true (modulemd_module_index_update_from_file (
+        index, yaml_path, TRUE, &failures, &error));
+      modulemd_subdocument_info_debug_dump_failures (failures);
+      g_assert_no_error (error);
+      g_assert_cmpint (failures->len, ==, 0);
+      g_clear_pointer (&yaml_path, g_free);
+      g_clear_pointer (&failures, g_ptr_array_unref);
+    }
 
-  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
-                               g_getenv ("TEST_DATA_PATH"));
+  yaml = modulemd_module_index_dump_to_string (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (yaml);
 
-  ret = modulemd_module_index_update_from_file (
-    index, yaml_path, TRUE, &failures, &error);
+  /* JSON holds the same documents as YAML */
+  json = modulemd_module_index_dump_to_json (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (json);
+  g_assert_true (g_str_has_prefix (json, "[\n{\"document\":"));
+
+  from_json = modulemd_module_index_new ();
+  g_assert_true (modulemd_module_index_update_from_json (
+    from_json, json, TRUE, &failures, &error));
   modulemd_subdocument_info_debug_dump_failures (failures);
   g_assert_no_error (error);
-  g_assert_true (ret);
   g_assert_cmpint (failures->len, ==, 0);
   g_clear_pointer (&failures, g_ptr_array_unref);
 
-  streams = modulemd_module_index_search_streams_by_nsvca_glob (index, "*");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 5);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  dumped = modulemd_module_index_dump_to_string (from_json, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (dumped, ==, yaml);
+  g_clear_pointer (&dumped, g_free);
 
-  streams = modulemd_module_index_search_streams_by_nsvca_glob (index, NULL);
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 5);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  /* And so does CBOR */
+  cbor = modulemd_module_index_dump_to_cbor (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (cbor);
+  g_assert_cmpuint (g_bytes_get_size (cbor), <, strlen (json));
 
-  streams =
-    modulemd_module_index_search_streams_by_nsvca_glob (index, "nodejs*");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 3);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  from_cbor = modulemd_module_index_new ();
+  g_assert_true (modulemd_module_index_update_from_cbor (
+    from_cbor, cbor, TRUE, &failures, &error));
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_cmpint (failures->len, ==, 0);
+  g_clear_pointer (&failures, g_ptr_array_unref);
 
-  streams =
-    modulemd_module_index_search_streams_by_nsvca_glob (index, "nodejs:?*");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 3);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  dumped = modulemd_module_index_dump_to_string (from_cbor, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (dumped, ==, yaml);
+  g_clear_pointer (&dumped, g_free);
+
+  /* Invalid documents are reported as failures */
+  invalid = modulemd_module_index_new ();
+  g_assert_false (modulemd_module_index_update_from_json (
+    invalid,
+    "[{\"document\": \"modulemd-defaults\", \"version\": 1}]",
+    TRUE,
+    &failures,
+    &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (failures->len, ==, 1);
+  g_clear_pointer (&failures, g_ptr_array_unref);
 
-  streams = modulemd_module_index_search_streams_by_nsvca_glob (index, "*8*");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 4);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  /* Anything but an array of objects is an error */
+  g_assert_false (modulemd_module_index_update_from_json (
+    invalid, "{\"document\": \"modulemd\"}", TRUE, &failures, &error));
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_PARSE);
+  g_clear_error (&error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
 
-  streams =
-    modulemd_module_index_search_streams_by_nsvca_glob (index, "nodejs:[68]*");
-  g_assert_nonnull (streams);
-  g_assert_cmpint (streams->len, ==, 2);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  g_assert_false (modulemd_module_index_update_from_json (
+    invalid, "[\"modulemd\"]", TRUE, &failures, &error));
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_PARSE);
+  g_clear_error (&error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+
+  truncated = g_bytes_new_from_bytes (cbor, 0, g_bytes_get_size (cbor) - 1);
+  g_assert_false (modulemd_module_index_update_from_cbor (
+    invalid, truncated, TRUE, &failures, &error));
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_UNPARSEABLE);
+  g_assert_cmpint (failures->len, ==, 0);
 }
 
 
 static void
-test_module_index_search_rpms (void)
+test_module_index_json_typed (void)
 {
-  gboolean ret;
   g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
-  g_autoptr (GError) error = NULL;
+  g_autoptr (ModulemdModuleIndex) from_json = NULL;
+  g_autoptr (ModulemdModuleIndex) from_cbor = NULL;
   g_autoptr (GPtrArray) failures = NULL;
-  g_autoptr (GPtrArray) streams = NULL;
-  g_autofree gchar *yaml_path = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *json = NULL;
+  g_autofree gchar *dumped = NULL;
+  g_autoptr (GBytes) cbor = NULL;
+  ModulemdModuleStream *stream = NULL;
+  /* Contexts that look like numbers in exponent notation */
+  const gchar *yaml =
+    "---\n"
+    "document: modulemd\n"
+    "version: 2\n"
+    "data:\n"
+    "  name: foo\n"
+    "  stream: \"1\"\n"
+    "  version: 5\n"
+    "  context: \"8e000000\"\n"
+    "  summary: A summary\n"
+    "  description: A description\n"
+    "  license:\n"
+    "    module: [MIT]\n"
+    "  components:\n"
+    "    rpms:\n"
+    "      foo:\n"
+    "        rationale: Because\n"
+    "        buildorder: -3\n"
+    "        buildonly: true\n"
+    "...\n"
+    "---\n"
+    "document: modulemd\n"
+    "version: 2\n"
+    "data:\n"
+    "  name: foo\n"
+    "  stream: \"1\"\n"
+    "  version: 5\n"
+    "  context: \"12e34567\"\n"
+    "  summary: A summary\n"
+    "  description: A description\n"
+    "  license:\n"
+    "    module: [MIT]\n"
+    "...\n";
+
+  g_assert_true (modulemd_module_index_update_from_string (
+    index, yaml, TRUE, &failures, &error));
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
 
-  yaml_path = g_strdup_printf ("%s/search_streams/search_streams.yaml",
-                               g_getenv ("TEST_DATA_PATH"));
+  /* Only integer and boolean fields are typed */
+  json = modulemd_module_index_dump_to_json (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (json);
+  g_assert_nonnull (strstr (json, "\"version\":5,"));
+  g_assert_nonnull (strstr (json, "\"context\":\"8e000000\""));
+  g_assert_nonnull (strstr (json, "\"context\":\"12e34567\""));
+  g_assert_nonnull (strstr (json, "\"buildorder\":-3"));
+  g_assert_nonnull (strstr (json, "\"buildonly\":true"));
+
+  from_json = modulemd_module_index_new ();
+  g_assert_true (modulemd_module_index_update_from_json (
+    from_json, json, TRUE, &failures, &error));
+  g_assert_no_error (error);
+  g_clear_pointer (&failures, g_ptr_array_unref);
+  stream = modulemd_module_get_stream_by_NSVCA (
+    modulemd_module_index_get_module (from_json, "foo"),
+    "1",
+    5,
+    "8e000000",
+    NULL,
+    &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (stream);
 
-  ret = modulemd_module_index_update_from_file (
-    index, yaml_path, TRUE, &failures, &error);
+  /* CBOR must not turn the contexts into floating point numbers */
+  cbor = modulemd_module_index_dump_to_cbor (index, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (cbor);
+
+  from_cbor = modulemd_module_index_new ();
+  g_assert_true (modulemd_module_index_update_from_cbor (
+    from_cbor, cbor, TRUE, &failures, &error));
+  modulemd_subdocument_info_debug_dump_failures (failures);
+  g_assert_no_error (error);
+  g_assert_cmpint (failures->len, ==, 0);
+
+  for (guint i = 0; i < 2; i++)
+    {
+      stream = modulemd_module_get_stream_by_NSVCA (
+        modulemd_module_index_get_module (from_cbor, "foo"),
+        "1",
+        5,
+        i ? "12e34567" : "8e000000",
+        NULL,
+        &error);
+      g_assert_no_error (error);
+      g_assert_nonnull (stream);
+    }
+
+  dumped = modulemd_module_index_dump_to_json (from_cbor, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (dumped, ==, json);
+}
+
+
+static void
+test_module_index_json_surrogates (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+  g_autoptr (GPtrArray) failures = NULL;
+  g_autoptr (GError) error = NULL;
+  ModulemdModuleStream *stream = NULL;
+  /* U+1F600 escaped as a surrogate pair, as json.dumps () writes it */
+  const gchar *json =
+    "[{\"document\": \"modulemd\", \"version\": 2, \"data\": {"
+    "\"name\": \"foo\", \"stream\": \"1\", \"version\": 5,"
+    "\"context\": \"c0ffee42\","
+    "\"summary\": \"Smile \\ud83d\\ude00\","
+    "\"description\": \"An escaped backslash: \\\\ud83d\","
+    "\"license\": {\"module\": [\"MIT\"]}}}]";
+
+  g_assert_true (modulemd_module_index_update_from_json (
+    index, json, TRUE, &failures, &error));
   modulemd_subdocument_info_debug_dump_failures (failures);
   g_assert_no_error (error);
-  g_assert_true (ret);
   g_assert_cmpint (failures->len, ==, 0);
   g_clear_pointer (&failures, g_ptr_array_unref);
 
+  stream = modulemd_module_get_stream_by_NSVCA (
+    modulemd_module_index_get_module (index, "foo"),
+    "1",
+    5,
+    "c0ffee42",
+    NULL,
+    &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (stream);
+  g_assert_cmpstr (modulemd_module_stream_v2_get_summary (
+                     MODULEMD_MODULE_STREAM_V2 (stream), "C"),
+                   ==,
+                   "Smile \xf0\x9f\x98\x80");
+  g_assert_cmpstr (modulemd_module_stream_v2_get_description (
+                     MODULEMD_MODULE_STREAM_V2 (stream), "C"),
+                   ==,
+                   "An escaped backslash: \\ud83d");
+
+  /* A surrogate without its pair has no UTF-8 encoding */
+  g_assert_false (modulemd_module_index_update_from_json (
+    index, "[{\"document\": \"\\ud83d\"}]", TRUE, &failures, &error));
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_PARSE);
+}
 
-  /* Searching for "python*" should give us ReviewBoard and Django */
-  streams = modulemd_module_index_search_rpms (index, "python*");
-  g_assert_cmpint (streams->len, ==, 2);
-  g_clear_pointer (&streams, g_ptr_array_unref);
 
-  /* Searching for "[nR]*" should give us three Node.js streams, plus
-   * ReviewBoard
-   */
-  streams = modulemd_module_index_search_rpms (index, "[nR]*");
-  g_assert_cmpint (streams->len, ==, 4);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+static void
+assert_variant_equals (GVariant *variant, const gchar *expected)
+{
+  g_autoptr (GVariant) expected_variant = NULL;
+  g_autofree gchar *printed = NULL;
+  g_autofree gchar *expected_printed = NULL;
 
-  /* Searching for "*1.6*" should give us Django and Node.js 6 (because of
-   * npm-1:3.10.10-1.6.13.1.1.module_1575+55808bea.x86_64)
-   */
-  streams = modulemd_module_index_search_rpms (index, "*1.6*");
-  g_assert_cmpint (streams->len, ==, 2);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  g_assert_nonnull (variant);
+  g_assert_false (g_variant_is_floating (variant));
 
-  /* Searching for "*" should give us all five streams */
-  streams = modulemd_module_index_search_rpms (index, "*");
-  g_assert_cmpint (streams->len, ==, 5);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+  expected_variant = g_variant_ref_sink (g_variant_new_parsed (expected));
+  printed = g_variant_print (variant, TRUE);
+  expected_printed = g_variant_print (expected_variant, TRUE);
+  g_assert_cmpstr (printed, ==, expected_printed);
+}
 
-  /* Searching for NULL should give us all five streams */
-  streams = modulemd_module_index_search_rpms (index, NULL);
-  g_assert_cmpint (streams->len, ==, 5);
-  g_clear_pointer (&streams, g_ptr_array_unref);
 
-  /* Searching for "perl-*" should give us nothing */
-  streams = modulemd_module_index_search_rpms (index, "perl-*");
-  g_assert_cmpint (streams->len, ==, 0);
-  g_clear_pointer (&streams, g_ptr_array_unref);
+static void
+test_module_index_bulk_access (void)
+{
+  g_autoptr (ModulemdModuleIndex) index = NULL;
+  g_autoptr (ModulemdStreamQuery) query = NULL;
+  g_autoptr (GVariant) table = NULL;
+  const gchar *yaml =
+    "---\n"
+    "document: modulemd\n"
+    "version: 2\n"
+    "data:\n"
+    "  name: foo\n"
+    "  stream: \"1\"\n"
+    "  version: 5\n"
+    "  context: c0ffee42\n"
+    "  arch: x86_64\n"
+    "  summary: A summary\n"
+    "  description: A description\n"
+    "  license:\n"
+    "    module: [MIT]\n"
+    "  dependencies:\n"
+    "  - buildrequires:\n"
+    "      platform: [f33]\n"
+    "    requires:\n"
+    "      platform: [f33]\n"
+    "      bar: []\n"
+    "  artifacts:\n"
+    "    rpms:\n"
+    "    - foo-libs-0:1.0-1.x86_64\n"
+    "    - foo-0:1.0-1.x86_64\n"
+    "...\n"
+    "---\n"
+    "document: modulemd\n"
+    "version: 2\n"
+    "data:\n"
+    "  name: foo\n"
+    "  stream: \"2\"\n"
+    "  version: 6\n"
+    "  context: c0ffee42\n"
+    "  summary: A summary\n"
+    "  description: A description\n"
+    "  license:\n"
+    "    module: [MIT]\n"
+    "  artifacts:\n"
+    "    rpms:\n"
+    "    - foo-0:1.0-1.x86_64\n"
+    "...\n";
+
+  index = load_index_from_string (yaml);
+
+  /* Missing fields are empty strings */
+  table = modulemd_module_index_get_stream_table (index, NULL);
+  assert_variant_equals (table,
+                         "@a(sstss) [('foo', '1', 5, 'c0ffee42', 'x86_64'), "
+                         "('foo', '2', 6, 'c0ffee42', '')]");
+  g_clear_pointer (&table, g_variant_unref);
+
+  table = modulemd_module_index_get_rpm_artifacts_table (index, NULL);
+  assert_variant_equals (
+    table,
+    "@a(sas) [('foo:1:5:c0ffee42:x86_64', "
+    "['foo-0:1.0-1.x86_64', 'foo-libs-0:1.0-1.x86_64']), "
+    "('foo:2:6:c0ffee42', ['foo-0:1.0-1.x86_64'])]");
+  g_clear_pointer (&table, g_variant_unref);
+
+  table = modulemd_module_index_get_rpm_artifact_map (index, NULL);
+  assert_variant_equals (
+    table,
+    "@a{sas} {'foo-0:1.0-1.x86_64': "
+    "['foo:1:5:c0ffee42:x86_64', 'foo:2:6:c0ffee42'], "
+    "'foo-libs-0:1.0-1.x86_64': ['foo:1:5:c0ffee42:x86_64']}");
+  g_clear_pointer (&table, g_variant_unref);
+
+  /* An empty list of streams means any stream */
+  table = modulemd_module_index_get_dependencies_table (index, NULL);
+  assert_variant_equals (
+    table,
+    "@a(subsas) [('foo:1:5:c0ffee42:x86_64', 0, false, 'platform', ['f33']), "
+    "('foo:1:5:c0ffee42:x86_64', 0, true, 'bar', @as []), "
+    "('foo:1:5:c0ffee42:x86_64', 0, true, 'platform', ['f33'])]");
+  g_clear_pointer (&table, g_variant_unref);
+
+  /* Queries select the streams */
+  query = modulemd_stream_query_new ("foo", "2", NULL, NULL, NULL);
+  table = modulemd_module_index_get_stream_table (index, query);
+  assert_variant_equals (table,
+                         "@a(sstss) [('foo', '2', 6, 'c0ffee42', '')]");
+  g_clear_pointer (&table, g_variant_unref);
+
+  table = modulemd_module_index_get_rpm_artifact_map (index, query);
+  assert_variant_equals (
+    table, "@a{sas} {'foo-0:1.0-1.x86_64': ['foo:2:6:c0ffee42']}");
+  g_clear_pointer (&table, g_variant_unref);
+
+  table = modulemd_module_index_get_dependencies_table (index, query);
+  assert_variant_equals (table, "@a(subsas) []");
 }
 
 
@@ -2038,15 +4672,60 @@ main (int argc, char *argv[])
   g_test_add_func ("/modulemd/v2/module/index/custom_write",
                    module_index_test_custom_write);
 
+  g_test_add_func ("/modulemd/v2/module/index/prescan_mdversion",
+                   module_index_test_prescan_mdversion);
+
+  g_test_add_func ("/modulemd/v2/module/index/prescan_mdversion_read_fn",
+                   module_index_test_prescan_mdversion_read_fn);
+
+  g_test_add_func ("/modulemd/v2/module/index/read_mixed_upgrade",
+                   module_index_test_read_mixed_upgrade);
+
+  g_test_add_func ("/modulemd/v2/module/index/read_mixed_compressed",
+                   module_index_test_read_mixed_compressed);
+
+  g_test_add_func ("/modulemd/v2/module/index/read_mixed_failed_upgrade",
+                   module_index_test_read_mixed_failed_upgrade);
+
+  g_test_add_func ("/modulemd/v2/module/index/parallel_upgrade",
+                   module_index_test_parallel_upgrade);
+
+  g_test_add_func ("/modulemd/v2/module/index/parallel_dump",
+                   module_index_test_parallel_dump);
+
+  g_test_add_func ("/modulemd/v2/module/index/parallel_dump_error",
+                   module_index_test_parallel_dump_error);
+
   g_test_add_func ("/modulemd/v2/module/index/get_default_streams",
                    module_index_test_get_default_streams);
 
+  g_test_add_func ("/modulemd/v2/module/index/get_default_stream",
+                   module_index_test_get_default_stream);
+
   g_test_add_func ("/modulemd/v2/module/index/empty",
                    module_index_test_dump_empty_index);
 
   g_test_add_func ("/modulemd/v2/module/index/compressed",
                    test_module_index_read_compressed);
 
+  g_test_add_func ("/modulemd/v2/module/index/update_from_bytes",
+                   test_module_index_update_from_bytes);
+
+  g_test_add_func ("/modulemd/v2/module/index/update_from_file_async",
+                   test_module_index_update_from_file_async);
+
+  g_test_add_func ("/modulemd/v2/module/index/dump_to_file_async",
+                   test_module_index_dump_to_file_async);
+
+  g_test_add_func ("/modulemd/v2/module/index/freeze",
+                   test_module_index_freeze);
+
+  g_test_add_func ("/modulemd/v2/module/index/freeze/objects",
+                   test_module_index_freeze_objects);
+
+  g_test_add_func ("/modulemd/v2/module/index/freeze/concurrent",
+                   test_module_index_freeze_concurrent);
+
   g_test_add_func ("/modulemd/v2/module/index/defaultdir",
                    test_module_index_read_def_dir);
 
@@ -2056,9 +4735,42 @@ main (int argc, char *argv[])
   g_test_add_func ("/modulemd/v2/module/index/search_nsvca",
                    test_module_index_search_streams_by_nsvca_glob);
 
+  g_test_add_func ("/modulemd/v2/module/index/search_query",
+                   test_module_index_search_streams_by_query);
+
+  g_test_add_func ("/modulemd/v2/module/index/foreach_stream",
+                   test_module_index_foreach_stream);
+
   g_test_add_func ("/modulemd/v2/module/index/search_rpms",
                    test_module_index_search_rpms);
 
+  g_test_add_func ("/modulemd/v2/module/index/search_package_providers",
+                   test_module_index_search_package_providers);
+
+  g_test_add_func ("/modulemd/v2/module/index/memory_usage",
+                   test_module_index_memory_usage);
+
+  g_test_add_func ("/modulemd/v2/module/index/compact",
+                   test_module_index_compact);
+
+  g_test_add_func ("/modulemd/v2/module/index/compact_on_load",
+                   test_module_index_compact_on_load);
+
+  g_test_add_func ("/modulemd/v2/module/index/skip_validation",
+                   test_module_index_skip_validation);
+
+  g_test_add_func ("/modulemd/v2/module/index/skip_validation/children",
+                   test_module_index_skip_validation_children);
+
+  g_test_add_func ("/modulemd/v2/module/index/json", test_module_index_json);
+  g_test_add_func ("/modulemd/v2/module/index/json/typed",
+                   test_module_index_json_typed);
+  g_test_add_func ("/modulemd/v2/module/index/json/surrogates",
+                   test_module_index_json_surrogates);
+
+  g_test_add_func ("/modulemd/v2/module/index/bulk_access",
+                   test_module_index_bulk_access);
+
   g_test_add_func ("/modulemd/v2/module/index/add_translation/null",
                    test_module_index_add_translation_null);
 
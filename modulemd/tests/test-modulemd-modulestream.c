@@ -3501,6 +3501,59 @@ module_stream_v2_test_quoting (void)
 }
 
 
+static void
+module_stream_test_interned_strings (void)
+{
+  g_autoptr (ModulemdModuleStreamV2) first = NULL;
+  g_autoptr (ModulemdModuleStreamV2) second = NULL;
+  g_autoptr (GHashTable) a = NULL;
+  g_autoptr (GHashTable) b = NULL;
+  g_autoptr (GHashTable) c = NULL;
+
+  first = modulemd_module_stream_v2_new ("foo", "latest");
+  second = modulemd_module_stream_v2_new ("foo", "stable");
+
+  g_assert_cmpstr (
+    modulemd_module_stream_get_module_name (MODULEMD_MODULE_STREAM (first)),
+    ==,
+    modulemd_module_stream_get_module_name (MODULEMD_MODULE_STREAM (second)));
+
+#ifdef HAVE_G_REF_STRING
+  /* Equal names are a single allocation */
+  g_assert_true (
+    modulemd_module_stream_get_module_name (MODULEMD_MODULE_STREAM (first)) ==
+    modulemd_module_stream_get_module_name (MODULEMD_MODULE_STREAM (second)));
+#endif
+
+  /* Renaming one stream does not affect the other */
+  modulemd_module_stream_set_module_name (MODULEMD_MODULE_STREAM (second),
+                                          "bar");
+  g_assert_cmpstr (
+    modulemd_module_stream_get_module_name (MODULEMD_MODULE_STREAM (first)),
+    ==,
+    "foo");
+
+  a = modulemd_str_set_new ();
+  g_hash_table_add (a, modulemd_str_intern ("bash"));
+  g_hash_table_add (a, modulemd_str_intern ("zsh"));
+
+  b = modulemd_hash_table_deep_set_copy (a);
+  g_assert_true (modulemd_hash_table_sets_are_equal (a, b));
+  g_assert_true (modulemd_hash_table_sets_are_equal (a, a));
+
+  c = modulemd_str_set_new ();
+  g_hash_table_add (c, modulemd_str_intern ("zsh"));
+  g_assert_false (modulemd_hash_table_sets_are_equal (a, c));
+
+  g_hash_table_add (c, modulemd_str_intern ("fish"));
+  g_assert_false (modulemd_hash_table_sets_are_equal (a, c));
+
+  g_hash_table_remove (c, "fish");
+  g_hash_table_add (c, modulemd_str_intern ("bash"));
+  g_assert_true (modulemd_hash_table_sets_are_equal (a, c));
+}
+
+
 int
 main (int argc, char *argv[])
 {
@@ -3666,5 +3719,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/modulemd/v2/modulestream/v2/quoting",
                    module_stream_v2_test_quoting);
 
+  g_test_add_func ("/modulemd/v2/modulestream/interned_strings",
+                   module_stream_test_interned_strings);
+
   return g_test_run ();
 }
@@ -0,0 +1,236 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+#include <locale.h>
+
+#include "modulemd-module-stream.h"
+#include "modulemd-stream-query.h"
+#include "private/glib-extensions.h"
+#include "private/modulemd-stream-query-private.h"
+#include "private/test-utils.h"
+
+
+static ModulemdModuleStream *
+make_stream (const gchar *module_name,
+             const gchar *stream_name,
+             guint64 version,
+             const gchar *context,
+             const gchar *arch)
+{
+  ModulemdModuleStream *stream = modulemd_module_stream_new (
+    MD_MODULESTREAM_VERSION_TWO, module_name, stream_name);
+
+  modulemd_module_stream_set_version (stream, version);
+  modulemd_module_stream_set_context (stream, context);
+  modulemd_module_stream_set_arch (stream, arch);
+
+  return stream;
+}
+
+
+static gboolean
+query_matches (const gchar *module_name,
+               const gchar *stream_name,
+               const gchar *version,
+               const gchar *context,
+               const gchar *arch,
+               ModulemdModuleStream *stream)
+{
+  g_autoptr (ModulemdStreamQuery) query = modulemd_stream_query_new (
+    module_name, stream_name, version, context, arch);
+
+  return modulemd_stream_query_matches (query, stream);
+}
+
+
+static gboolean
+nsvca_query_matches (const gchar *pattern, ModulemdModuleStream *stream)
+{
+  g_autoptr (ModulemdStreamQuery) query =
+    modulemd_stream_query_new_from_nsvca_glob (pattern);
+
+  return modulemd_stream_query_matches (query, stream);
+}
+
+
+static void
+stream_query_test_fields (void)
+{
+  g_autoptr (ModulemdModuleStream) stream =
+    make_stream ("nodejs", "12", 3120200101, "c0ffee42", "x86_64");
+  g_autoptr (ModulemdModuleStream) no_context =
+    make_stream ("nodejs", "12", 3120200101, NULL, "x86_64");
+
+  /* NULL patterns match everything */
+  g_assert_true (query_matches (NULL, NULL, NULL, NULL, NULL, stream));
+  g_assert_true (query_matches (NULL, NULL, NULL, NULL, NULL, no_context));
+
+  /* Literals */
+  g_assert_true (query_matches ("nodejs", "12", NULL, NULL, NULL, stream));
+  g_assert_false (query_matches ("nodej", NULL, NULL, NULL, NULL, stream));
+  g_assert_false (query_matches (NULL, "1", NULL, NULL, NULL, stream));
+  g_assert_true (query_matches (NULL, NULL, NULL, "c0ffee42", NULL, stream));
+  g_assert_false (
+    query_matches (NULL, NULL, NULL, "c0ffee42", NULL, no_context));
+
+  /* Prefixes */
+  g_assert_true (query_matches ("node*", "1*", NULL, NULL, "x86*", stream));
+  g_assert_false (query_matches ("nodejs1*", NULL, NULL, NULL, NULL, stream));
+  g_assert_true (query_matches (NULL, NULL, NULL, "*", NULL, stream));
+  g_assert_false (query_matches (NULL, NULL, NULL, "*", NULL, no_context));
+
+  /* General globs */
+  g_assert_true (
+    query_matches ("*js", "1?", NULL, NULL, "x86_[0-9]*", stream));
+  g_assert_false (query_matches ("*jsx", NULL, NULL, NULL, NULL, stream));
+  g_assert_true (query_matches ("node\\js", NULL, NULL, NULL, NULL, stream));
+}
+
+
+static void
+stream_query_test_version (void)
+{
+  g_autoptr (ModulemdModuleStream) stream =
+    make_stream ("nodejs", "12", 3120200101, "c0ffee42", "x86_64");
+  g_autoptr (ModulemdModuleStream) zero =
+    make_stream ("nodejs", "12", 0, "c0ffee42", "x86_64");
+
+  /* Exact numeric match */
+  g_assert_true (query_matches (NULL, NULL, "3120200101", NULL, NULL, stream));
+  g_assert_false (
+    query_matches (NULL, NULL, "3120200102", NULL, NULL, stream));
+  g_assert_true (query_matches (NULL, NULL, "0", NULL, NULL, zero));
+  g_assert_false (query_matches (NULL, NULL, "0", NULL, NULL, stream));
+
+  /* Leading zeros never match the formatted version */
+  g_assert_false (
+    query_matches (NULL, NULL, "03120200101", NULL, NULL, stream));
+  g_assert_false (query_matches (NULL, NULL, "03*", NULL, NULL, stream));
+
+  /* Numeric prefixes */
+  g_assert_true (query_matches (NULL, NULL, "3*", NULL, NULL, stream));
+  g_assert_true (query_matches (NULL, NULL, "312020*", NULL, NULL, stream));
+  g_assert_true (
+    query_matches (NULL, NULL, "3120200101*", NULL, NULL, stream));
+  g_assert_false (
+    query_matches (NULL, NULL, "31202001011*", NULL, NULL, stream));
+  g_assert_false (query_matches (NULL, NULL, "32*", NULL, NULL, stream));
+  g_assert_true (query_matches (NULL, NULL, "0*", NULL, NULL, zero));
+  g_assert_false (query_matches (NULL, NULL, "1*", NULL, NULL, zero));
+
+  /* Anything else falls back to fnmatch() */
+  g_assert_true (query_matches (NULL, NULL, "*", NULL, NULL, zero));
+  g_assert_true (query_matches (NULL, NULL, "*0101", NULL, NULL, stream));
+  g_assert_true (query_matches (NULL, NULL, "3?20*", NULL, NULL, stream));
+  g_assert_false (query_matches (NULL, NULL, "*0102", NULL, NULL, stream));
+  g_assert_false (query_matches (NULL, NULL, "", NULL, NULL, stream));
+  g_assert_false (
+    query_matches (NULL, NULL, "99999999999999999999999", NULL, NULL, stream));
+}
+
+
+static void
+stream_query_test_nsvca (void)
+{
+  g_autoptr (ModulemdModuleStream) stream =
+    make_stream ("nodejs", "12", 3120200101, "c0ffee42", "x86_64");
+  g_autoptr (ModulemdModuleStream) partial =
+    make_stream ("nodejs", "12", 0, NULL, NULL);
+  g_autofree gchar *long_name = g_strnfill (300, 'a');
+  g_autofree gchar *long_pattern = NULL;
+  g_autoptr (ModulemdModuleStream) long_stream =
+    make_stream (long_name, "12", 1, "c0ffee42", "x86_64");
+
+  g_assert_true (nsvca_query_matches (NULL, stream));
+  g_assert_true (
+    nsvca_query_matches ("nodejs:12:3120200101:c0ffee42:x86_64", stream));
+  g_assert_false (
+    nsvca_query_matches ("nodejs:12:3120200101:c0ffee42", stream));
+  g_assert_true (nsvca_query_matches ("nodejs:12*", stream));
+  g_assert_true (nsvca_query_matches ("*:c0ffee42:*", stream));
+  g_assert_false (nsvca_query_matches ("nodejs:13*", stream));
+  g_assert_false (nsvca_query_matches ("python:*", stream));
+
+  /* Trailing empty fields are omitted from the NSVCA string */
+  g_assert_true (nsvca_query_matches ("nodejs:12", partial));
+  g_assert_false (nsvca_query_matches ("nodejs:12:", partial));
+  g_assert_false (nsvca_query_matches ("nodejs", partial));
+
+  /* Very long NSVCA strings do not fit the stack buffer */
+  long_pattern = g_strdup_printf ("%s:12:1:*", long_name);
+  g_assert_true (nsvca_query_matches (long_pattern, long_stream));
+  g_assert_false (nsvca_query_matches ("a:12:1:*", long_stream));
+}
+
+
+static void
+stream_query_test_module_literal (void)
+{
+  g_autoptr (ModulemdStreamQuery) query = NULL;
+
+  query = modulemd_stream_query_new ("nodejs", NULL, NULL, NULL, NULL);
+  g_assert_cmpstr (
+    modulemd_stream_query_get_module_name_literal (query), ==, "nodejs");
+  g_assert_true (modulemd_stream_query_may_match_module (query, "nodejs"));
+  g_assert_false (modulemd_stream_query_may_match_module (query, "python"));
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new ("node*", NULL, NULL, NULL, NULL);
+  g_assert_null (modulemd_stream_query_get_module_name_literal (query));
+  g_assert_true (modulemd_stream_query_may_match_module (query, "nodejs"));
+  g_assert_false (modulemd_stream_query_may_match_module (query, "python"));
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new_from_nsvca_glob ("nodejs:1*");
+  g_assert_cmpstr (
+    modulemd_stream_query_get_module_name_literal (query), ==, "nodejs");
+  g_assert_false (modulemd_stream_query_may_match_module (query, "python"));
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new_from_nsvca_glob ("nodejs");
+  g_assert_cmpstr (
+    modulemd_stream_query_get_module_name_literal (query), ==, "nodejs");
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new_from_nsvca_glob ("node*:12");
+  g_assert_null (modulemd_stream_query_get_module_name_literal (query));
+  g_assert_true (modulemd_stream_query_may_match_module (query, "python"));
+  g_clear_object (&query);
+
+  query = modulemd_stream_query_new_from_nsvca_glob ("nodejs*");
+  g_assert_null (modulemd_stream_query_get_module_name_literal (query));
+  g_clear_object (&query);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+  g_test_bug_base ("https://bugzilla.redhat.com/show_bug.cgi?id=");
+
+  // Define the tests.
+
+  g_test_add_func ("/modulemd/v2/streamquery/fields",
+                   stream_query_test_fields);
+  g_test_add_func ("/modulemd/v2/streamquery/version",
+                   stream_query_test_version);
+  g_test_add_func ("/modulemd/v2/streamquery/nsvca", stream_query_test_nsvca);
+  g_test_add_func ("/modulemd/v2/streamquery/module_literal",
+                   stream_query_test_module_literal);
+
+  return g_test_run ();
+}
@@ -14,8 +14,12 @@
 #include "config.h"
 #include <glib.h>
 #include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <locale.h>
+#include <unistd.h>
 
 gint test_number = 0;
 gint failed = 0;
@@ -27,6 +31,7 @@ gint validator_exit_status = 0;
 gint expected_exit_code = 0;
 gchar *expected_stdout = NULL;
 gchar *expected_stderr = NULL;
+gchar *validator_stdin = NULL;
 
 static void
 ok (gboolean value, const gchar *name)
@@ -64,23 +69,67 @@ skip (const gchar *reason)
   g_fprintf (stdout, "ok %d # SKIP %s\n", test_number, reason);
 }
 
+/* Makes the standard input of this program, which the validator inherits,
+ * read @validator_stdin with C-style escapes such as \377 replaced by the
+ * bytes they stand for.
+ */
+static gboolean
+redirect_stdin (GError **error)
+{
+  g_autofree gchar *contents = g_strcompress (validator_stdin);
+  g_autofree gchar *path = NULL;
+  gsize len = strlen (contents);
+  gboolean ret = TRUE;
+  gint fd;
+
+  fd = g_file_open_tmp ("modulemd-validator-stdin-XXXXXX", &path, error);
+  if (fd < 0)
+    {
+      return FALSE;
+    }
+
+  if (write (fd, contents, len) != (gssize)len ||
+      lseek (fd, 0, SEEK_SET) != 0 || dup2 (fd, STDIN_FILENO) < 0)
+    {
+      g_set_error (error,
+                   G_FILE_ERROR,
+                   g_file_error_from_errno (errno),
+                   "Could not redirect the standard input to %s: %s",
+                   path,
+                   g_strerror (errno));
+      ret = FALSE;
+    }
+
+  close (fd);
+  g_unlink (path);
+  return ret;
+}
+
 static gboolean
 test_execute (void)
 {
-  gboolean executed;
+  gboolean executed = FALSE;
   g_autoptr (GError) error = NULL;
   g_autofree gchar *command = g_strjoinv (" ", validator_argv);
+  GSpawnFlags flags = G_SPAWN_SEARCH_PATH;
   g_fprintf (stdout, "# Executing: %s\n", command);
-  executed = g_spawn_sync (NULL,
-                           validator_argv,
-                           NULL,
-                           G_SPAWN_SEARCH_PATH,
-                           NULL,
-                           NULL,
-                           &validator_stdout,
-                           &validator_stderr,
-                           &validator_exit_status,
-                           &error);
+  if (validator_stdin)
+    {
+      flags |= G_SPAWN_CHILD_INHERITS_STDIN;
+    }
+  if (!validator_stdin || redirect_stdin (&error))
+    {
+      executed = g_spawn_sync (NULL,
+                               validator_argv,
+                               NULL,
+                               flags,
+                               NULL,
+                               NULL,
+                               &validator_stdout,
+                               &validator_stderr,
+                               &validator_exit_status,
+                               &error);
+    }
   ok (executed, "command executed");
   if (error)
     {
@@ -174,6 +223,13 @@ main (int argc, char *argv[])
       &expected_stderr,
       "Check error output for a substring (default is no check)",
       NULL },
+    { "stdin",
+      '\0',
+      G_OPTION_FLAG_NONE,
+      G_OPTION_ARG_STRING,
+      &validator_stdin,
+      "Standard input, with C-style escapes (default is empty)",
+      NULL },
     { 0 }
   };
   GOptionContext *context;
@@ -217,6 +273,7 @@ main (int argc, char *argv[])
     }
   g_free (expected_stdout);
   g_free (expected_stderr);
+  g_free (validator_stdin);
   g_free (validator_stdout);
   g_free (validator_stderr);
   exit (failed ? EXIT_FAILURE : EXIT_SUCCESS);
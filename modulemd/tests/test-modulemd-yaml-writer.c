@@ -0,0 +1,557 @@
+/*
+ * This file is part of libmodulemd
+ * Copyright (C) 2020 Red Hat, Inc.
+ *
+ * Fedora-License-Identifier: MIT
+ * SPDX-2.0-License-Identifier: MIT
+ * SPDX-3.0-License-Identifier: MIT
+ *
+ * This program is free software.
+ * For more information on the license, see COPYING.
+ * For more information on free software, see <https://www.gnu.org/philosophy/free-sw.en.html>.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <locale.h>
+#include <signal.h>
+#include <yaml.h>
+
+#include "modulemd-defaults.h"
+#include "modulemd-module-index.h"
+#include "modulemd-module-stream.h"
+#include "modulemd-module.h"
+#include "private/glib-extensions.h"
+#include "private/modulemd-defaults-v1-private.h"
+#include "private/modulemd-module-stream-v1-private.h"
+#include "private/modulemd-module-stream-v2-private.h"
+#include "private/modulemd-obsoletes-private.h"
+#include "private/modulemd-translation-private.h"
+#include "private/modulemd-yaml-writer.h"
+#include "private/modulemd-yaml.h"
+#include "private/test-utils.h"
+
+
+/* Collects every YAML file below @dir */
+static void
+collect_yaml_files (const gchar *dir, GPtrArray *files)
+{
+  g_autoptr (GDir) gdir = NULL;
+  g_autoptr (GError) error = NULL;
+  const gchar *name = NULL;
+
+  gdir = g_dir_open (dir, 0, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (gdir);
+
+  while ((name = g_dir_read_name (gdir)) != NULL)
+    {
+      g_autofree gchar *path = g_build_filename (dir, name, NULL);
+
+      if (g_file_test (path, G_FILE_TEST_IS_DIR))
+        collect_yaml_files (path, files);
+      else if (g_str_has_suffix (name, ".yaml"))
+        g_ptr_array_add (files, g_steal_pointer (&path));
+    }
+}
+
+
+static gint
+compare_paths (gconstpointer a, gconstpointer b)
+{
+  return g_strcmp0 (*(const gchar **)a, *(const gchar **)b);
+}
+
+
+static GPtrArray *
+get_corpus (void)
+{
+  g_autofree gchar *test_data = NULL;
+  g_autofree gchar *yaml_specs = NULL;
+  GPtrArray *files = g_ptr_array_new_with_free_func (g_free);
+
+  test_data = g_strdup_printf ("%s/modulemd/tests/test_data",
+                               g_getenv ("MESON_SOURCE_ROOT"));
+  yaml_specs =
+    g_strdup_printf ("%s/yaml_specs", g_getenv ("MESON_SOURCE_ROOT"));
+
+  collect_yaml_files (test_data, files);
+  collect_yaml_files (yaml_specs, files);
+  g_ptr_array_sort (files, compare_paths);
+
+  g_assert_cmpuint (files->len, >, 0);
+
+  return files;
+}
+
+
+/* Returns FALSE if @event uses a feature the direct writer rejects */
+static gboolean
+event_is_supported (const yaml_event_t *event)
+{
+  switch (event->type)
+    {
+    case YAML_ALIAS_EVENT: return FALSE;
+
+    case YAML_DOCUMENT_START_EVENT:
+      return event->data.document_start.version_directive == NULL &&
+             event->data.document_start.tag_directives.start ==
+               event->data.document_start.tag_directives.end;
+
+    case YAML_SCALAR_EVENT:
+      return event->data.scalar.anchor == NULL &&
+             event->data.scalar.tag == NULL;
+
+    case YAML_SEQUENCE_START_EVENT:
+      return event->data.sequence_start.anchor == NULL &&
+             event->data.sequence_start.tag == NULL;
+
+    case YAML_MAPPING_START_EVENT:
+      return event->data.mapping_start.anchor == NULL &&
+             event->data.mapping_start.tag == NULL;
+
+    default: return TRUE;
+    }
+}
+
+
+/* Returns FALSE if @path is not valid YAML or uses unsupported features */
+static gboolean
+file_is_supported (const gchar *path)
+{
+  MMD_INIT_YAML_PARSER (parser);
+  g_autoptr (FILE) file = NULL;
+  gboolean done = FALSE;
+
+  file = g_fopen (path, "rbe");
+  g_assert_nonnull (file);
+  yaml_parser_set_input_file (&parser, file);
+
+  while (!done)
+    {
+      MMD_INIT_YAML_EVENT (event);
+
+      if (!yaml_parser_parse (&parser, &event))
+        return FALSE;
+
+      if (!event_is_supported (&event))
+        return FALSE;
+
+      done = event.type == YAML_STREAM_END_EVENT;
+    }
+
+  return TRUE;
+}
+
+
+/*
+ * Parses @path twice in lockstep and passes the events of one parser to
+ * libyaml and those of the other to the direct writer.
+ */
+static void
+yaml_writer_test_corpus_events_file (const gchar *path)
+{
+  MMD_INIT_YAML_PARSER (parser);
+  MMD_INIT_YAML_PARSER (direct_parser);
+  MMD_INIT_YAML_EMITTER (emitter);
+  MMD_INIT_YAML_EMITTER (direct_emitter);
+  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+  MMD_INIT_YAML_STRING (&direct_emitter, direct_string);
+  MMD_INIT_YAML_WRITER (&direct_emitter, writer);
+  g_autoptr (FILE) file = NULL;
+  g_autoptr (FILE) direct_file = NULL;
+  gboolean done = FALSE;
+
+  file = g_fopen (path, "rbe");
+  direct_file = g_fopen (path, "rbe");
+  g_assert_nonnull (file);
+  g_assert_nonnull (direct_file);
+  yaml_parser_set_input_file (&parser, file);
+  yaml_parser_set_input_file (&direct_parser, direct_file);
+
+  g_assert_true (mmd_emitter_is_direct (&direct_emitter));
+  g_assert_false (mmd_emitter_is_direct (&emitter));
+
+  while (!done)
+    {
+      yaml_event_t event;
+      yaml_event_t direct_event;
+
+      g_assert_true (yaml_parser_parse (&parser, &event));
+      g_assert_true (yaml_parser_parse (&direct_parser, &direct_event));
+      g_assert_cmpint (event.type, ==, direct_event.type);
+
+      done = event.type == YAML_STREAM_END_EVENT;
+
+      g_assert_cmpint (mmd_emitter_emit (&emitter, &event), ==, 1);
+      g_assert_cmpint (
+        mmd_emitter_emit (&direct_emitter, &direct_event), ==, 1);
+    }
+
+  g_assert_nonnull (direct_string->str);
+  g_assert_cmpstr (yaml_string->str, ==, direct_string->str);
+}
+
+
+static void
+yaml_writer_test_corpus_events (void)
+{
+  g_autoptr (GPtrArray) files = get_corpus ();
+  guint compared = 0;
+
+  for (guint i = 0; i < files->len; i++)
+    {
+      const gchar *path = g_ptr_array_index (files, i);
+
+      if (!file_is_supported (path))
+        {
+          g_test_message ("Skipping %s", path);
+          continue;
+        }
+
+      g_test_message ("Comparing events of %s", path);
+      yaml_writer_test_corpus_events_file (path);
+      compared++;
+    }
+
+  g_assert_cmpuint (compared, >, 0);
+}
+
+
+typedef gboolean (*emit_fn) (gpointer object,
+                             yaml_emitter_t *emitter,
+                             GError **error);
+
+
+static gboolean
+emit_stream (gpointer object, yaml_emitter_t *emitter, GError **error)
+{
+  ModulemdModuleStream *stream = MODULEMD_MODULE_STREAM (object);
+
+  if (modulemd_module_stream_get_mdversion (stream) ==
+      MD_MODULESTREAM_VERSION_ONE)
+    return modulemd_module_stream_v1_emit_yaml (
+      MODULEMD_MODULE_STREAM_V1 (stream), emitter, error);
+
+  return modulemd_module_stream_v2_emit_yaml (
+    MODULEMD_MODULE_STREAM_V2 (stream), emitter, error);
+}
+
+
+static gboolean
+emit_defaults (gpointer object, yaml_emitter_t *emitter, GError **error)
+{
+  return modulemd_defaults_v1_emit_yaml (
+    MODULEMD_DEFAULTS_V1 (object), emitter, error);
+}
+
+
+static gboolean
+emit_obsoletes (gpointer object, yaml_emitter_t *emitter, GError **error)
+{
+  return modulemd_obsoletes_emit_yaml (
+    MODULEMD_OBSOLETES (object), emitter, error);
+}
+
+
+static gboolean
+emit_translation (gpointer object, yaml_emitter_t *emitter, GError **error)
+{
+  return modulemd_translation_emit_yaml (
+    MODULEMD_TRANSLATION (object), emitter, error);
+}
+
+
+/* Emits @object through libyaml and the direct writer and compares them */
+static void
+compare_object (gpointer object, emit_fn emit)
+{
+  g_autoptr (GError) error = NULL;
+  MMD_INIT_YAML_EMITTER (emitter);
+  MMD_INIT_YAML_EMITTER (direct_emitter);
+  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+  MMD_INIT_YAML_STRING (&direct_emitter, direct_string);
+  MMD_INIT_YAML_WRITER (&direct_emitter, writer);
+
+  g_assert_true (mmd_emitter_start_stream (&emitter, &error));
+  g_assert_no_error (error);
+  g_assert_true (emit (object, &emitter, &error));
+  g_assert_no_error (error);
+  g_assert_true (mmd_emitter_end_stream (&emitter, &error));
+  g_assert_no_error (error);
+
+  g_assert_true (mmd_emitter_start_stream (&direct_emitter, &error));
+  g_assert_no_error (error);
+  g_assert_true (emit (object, &direct_emitter, &error));
+  g_assert_no_error (error);
+  g_assert_true (mmd_emitter_end_stream (&direct_emitter, &error));
+  g_assert_no_error (error);
+
+  g_assert_nonnull (direct_string->str);
+  g_assert_cmpstr (yaml_string->str, ==, direct_string->str);
+}
+
+
+static void
+yaml_writer_test_corpus_objects (void)
+{
+  g_autoptr (GPtrArray) files = get_corpus ();
+  guint compared = 0;
+
+  for (guint i = 0; i < files->len; i++)
+    {
+      const gchar *path = g_ptr_array_index (files, i);
+      g_autoptr (ModulemdModuleIndex) index = modulemd_module_index_new ();
+      g_autoptr (GPtrArray) failures = NULL;
+      g_autoptr (GError) error = NULL;
+      g_auto (GStrv) module_names = NULL;
+
+      if (!modulemd_module_index_update_from_file (
+            index, path, FALSE, &failures, &error))
+        {
+          g_test_message ("Skipping %s", path);
+          continue;
+        }
+
+      g_test_message ("Comparing objects of %s", path);
+      module_names = modulemd_module_index_get_module_names_as_strv (index);
+
+      for (guint j = 0; module_names[j] != NULL; j++)
+        {
+          ModulemdModule *module =
+            modulemd_module_index_get_module (index, module_names[j]);
+          GPtrArray *streams = modulemd_module_get_all_streams (module);
+          GPtrArray *obsoletes = modulemd_module_get_obsoletes (module);
+          ModulemdDefaults *defaults = modulemd_module_get_defaults (module);
+
+          for (guint k = 0; k < streams->len; k++)
+            {
+              ModulemdModuleStream *stream = g_ptr_array_index (streams, k);
+              ModulemdTranslation *translation =
+                modulemd_module_get_translation (
+                  module, modulemd_module_stream_get_stream_name (stream));
+
+              compare_object (stream, emit_stream);
+              compared++;
+
+              if (translation != NULL)
+                compare_object (translation, emit_translation);
+            }
+
+          for (guint k = 0; k < obsoletes->len; k++)
+            compare_object (g_ptr_array_index (obsoletes, k), emit_obsoletes);
+
+          if (defaults != NULL &&
+              modulemd_defaults_get_mdversion (defaults) ==
+                MD_DEFAULTS_VERSION_ONE)
+            compare_object (defaults, emit_defaults);
+        }
+    }
+
+  g_assert_cmpuint (compared, >, 0);
+}
+
+
+/* Scalars that exercise every quoting and folding decision of libyaml */
+static const gchar *tricky_scalars[] = {
+  "",
+  "plain",
+  "two words",
+  " leading space",
+  "trailing space ",
+  "key: value",
+  "#comment",
+  "not # a comment",
+  "- dash",
+  "-",
+  "---",
+  "...",
+  "? question",
+  "[flow]",
+  "{flow}",
+  "a, b",
+  "'single'",
+  "\"double\"",
+  "back\\slash",
+  "!tag",
+  "&anchor",
+  "*alias",
+  "|",
+  ">",
+  "%directive",
+  "@reserved",
+  "`reserved`",
+  "0",
+  "1.5",
+  "true",
+  "null",
+  "~",
+  "line\nbreak",
+  "trailing break\n",
+  "two trailing breaks\n\n",
+  "\nleading break",
+  "  \nspaces then break",
+  "tab\there",
+  "carriage\rreturn",
+  "control\x01char",
+  "escape\x1b",
+  "delete\x7f",
+  "caf\xc3\xa9",
+  "next\xc2\x85line",
+  "line\xe2\x80\xa8separator",
+  "no-break\xc2\xa0space",
+  "\xef\xbb\xbf"
+  "bom",
+  "\xf0\x9f\x98\x80",
+  "a very long value that keeps on going well past the default line width "
+  "of eighty columns so that the emitter has to fold it onto several lines",
+  "a-very-long-value-without-any-spaces-that-cannot-be-folded-anywhere-at-"
+  "all-by-the-emitter",
+  "a very long value with\nline breaks that keeps on going well past the "
+  "default line width\n\nand paragraphs",
+  NULL
+};
+
+
+static const yaml_scalar_style_t tricky_styles[] = {
+  YAML_ANY_SCALAR_STYLE,           YAML_PLAIN_SCALAR_STYLE,
+  YAML_SINGLE_QUOTED_SCALAR_STYLE, YAML_DOUBLE_QUOTED_SCALAR_STYLE,
+  YAML_LITERAL_SCALAR_STYLE,       YAML_FOLDED_SCALAR_STYLE,
+};
+
+
+static void
+emit_tricky_scalars (yaml_emitter_t *emitter)
+{
+  g_autoptr (GError) error = NULL;
+
+  g_assert_true (mmd_emitter_start_stream (emitter, &error));
+  g_assert_true (mmd_emitter_start_document (emitter, &error));
+  g_assert_true (
+    mmd_emitter_start_mapping (emitter, YAML_BLOCK_MAPPING_STYLE, &error));
+
+  for (gsize s = 0; s < G_N_ELEMENTS (tricky_styles); s++)
+    {
+      for (gsize i = 0; tricky_scalars[i] != NULL; i++)
+        {
+          const gchar *value = tricky_scalars[i];
+          yaml_scalar_style_t style = tricky_styles[s];
+
+          /* As a key and as the value of a mapping */
+          g_assert_true (mmd_emitter_scalar (emitter, value, style, &error));
+          g_assert_true (mmd_emitter_scalar (emitter, value, style, &error));
+
+          /* In block and flow sequences */
+          g_assert_true (mmd_emitter_scalar (
+            emitter, "sequences", YAML_PLAIN_SCALAR_STYLE, &error));
+          g_assert_true (mmd_emitter_start_sequence (
+            emitter, YAML_BLOCK_SEQUENCE_STYLE, &error));
+          g_assert_true (mmd_emitter_scalar (emitter, value, style, &error));
+          g_assert_true (mmd_emitter_start_sequence (
+            emitter, YAML_FLOW_SEQUENCE_STYLE, &error));
+          g_assert_true (mmd_emitter_scalar (emitter, value, style, &error));
+          g_assert_true (mmd_emitter_scalar (emitter, value, style, &error));
+          g_assert_true (mmd_emitter_end_sequence (emitter, &error));
+          g_assert_true (mmd_emitter_start_sequence (
+            emitter, YAML_BLOCK_SEQUENCE_STYLE, &error));
+          g_assert_true (mmd_emitter_end_sequence (emitter, &error));
+          g_assert_true (mmd_emitter_end_sequence (emitter, &error));
+
+          /* In a flow mapping */
+          g_assert_true (mmd_emitter_scalar (
+            emitter, "flow", YAML_PLAIN_SCALAR_STYLE, &error));
+          g_assert_true (mmd_emitter_start_mapping (
+            emitter, YAML_FLOW_MAPPING_STYLE, &error));
+          g_assert_true (mmd_emitter_scalar (emitter, value, style, &error));
+          g_assert_true (mmd_emitter_scalar (emitter, value, style, &error));
+          g_assert_true (mmd_emitter_end_mapping (emitter, &error));
+        }
+    }
+
+  g_assert_true (mmd_emitter_end_mapping (emitter, &error));
+  g_assert_true (mmd_emitter_end_document (emitter, &error));
+  g_assert_true (mmd_emitter_end_stream (emitter, &error));
+  g_assert_no_error (error);
+}
+
+
+static void
+yaml_writer_test_scalars (void)
+{
+  MMD_INIT_YAML_EMITTER (emitter);
+  MMD_INIT_YAML_EMITTER (direct_emitter);
+  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+  MMD_INIT_YAML_STRING (&direct_emitter, direct_string);
+  MMD_INIT_YAML_WRITER (&direct_emitter, writer);
+
+  emit_tricky_scalars (&emitter);
+  emit_tricky_scalars (&direct_emitter);
+
+  g_assert_nonnull (direct_string->str);
+  g_assert_cmpstr (yaml_string->str, ==, direct_string->str);
+}
+
+
+static void
+yaml_writer_test_unsupported (void)
+{
+  g_autoptr (GError) error = NULL;
+  MMD_INIT_YAML_EMITTER (emitter);
+  MMD_INIT_YAML_EVENT (event);
+  MMD_INIT_YAML_STRING (&emitter, yaml_string);
+  MMD_INIT_YAML_WRITER (&emitter, writer);
+
+  g_assert_true (mmd_emitter_start_stream (&emitter, &error));
+  g_assert_true (mmd_emitter_start_document (&emitter, &error));
+  g_assert_no_error (error);
+
+  /* Anchors are not supported */
+  g_assert_true (yaml_scalar_event_initialize (&event,
+                                               (yaml_char_t *)"anchor",
+                                               NULL,
+                                               (yaml_char_t *)"value",
+                                               -1,
+                                               1,
+                                               1,
+                                               YAML_ANY_SCALAR_STYLE));
+  g_assert_cmpint (mmd_direct_emit (&emitter, &event), ==, 0);
+  yaml_event_delete (&event);
+
+  /* Neither are aliases */
+  g_assert_true (
+    yaml_alias_event_initialize (&event, (yaml_char_t *)"anchor"));
+  g_assert_cmpint (mmd_direct_emit (&emitter, &event), ==, 0);
+
+  /* Invalid UTF-8 is rejected before it reaches the writer */
+  g_assert_false (mmd_direct_check_utf8 ("bad\xc3", 4));
+  g_assert_true (mmd_direct_check_utf8 ("caf\xc3\xa9", 5));
+  g_assert_false (
+    mmd_emitter_scalar (&emitter, "bad\xff", YAML_ANY_SCALAR_STYLE, &error));
+  g_assert_error (error, MODULEMD_YAML_ERROR, MMD_YAML_ERROR_EVENT_INIT);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+  g_test_set_nonfatal_assertions ();
+
+  // Define the tests.
+
+  g_test_add_func ("/modulemd/v2/yaml/writer/corpus/events",
+                   yaml_writer_test_corpus_events);
+
+  g_test_add_func ("/modulemd/v2/yaml/writer/corpus/objects",
+                   yaml_writer_test_corpus_objects);
+
+  g_test_add_func ("/modulemd/v2/yaml/writer/scalars",
+                   yaml_writer_test_scalars);
+
+  g_test_add_func ("/modulemd/v2/yaml/writer/unsupported",
+                   yaml_writer_test_unsupported);
+
+  return g_test_run ();
+}